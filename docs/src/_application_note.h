@@ -100,6 +100,12 @@
  * \note            In order to start using this port, user must set the appropriate COM port name when opening a virtual file. 
  *                  Please check implementation file for details.
  *
+ * \par             System functions and low-level communication for POSIX
+ *
+ * Linux and other POSIX systems are supported with `pthreads` based system port in `src/system/esp_sys_posix.c` file,
+ * selected with `ESP_CFG_SYS_PORT` set to \ref ESP_SYS_PORT_POSIX.
+ * Low-level part in `src/system/esp_ll_posix.c` file uses `termios` serial device, set with `ESP_LL_POSIX_DEV` define (`/dev/ttyUSB0` by default).
+ *
  * \subsection      sect_project_examples_arm_embedded ARM Cortex-M examples
  *
  * Library is independant from CPU architecture, meaning we can also run it on embedded systems. 
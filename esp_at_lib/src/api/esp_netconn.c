@@ -47,6 +47,24 @@
 #error "ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN must be greater or equal to 2"
 #endif /* ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN < 2 */
 
+#if ESP_CFG_NETCONN_UDP_RECEIVE_QUEUE_LEN < 2
+#error "ESP_CFG_NETCONN_UDP_RECEIVE_QUEUE_LEN must be greater or equal to 2"
+#endif /* ESP_CFG_NETCONN_UDP_RECEIVE_QUEUE_LEN < 2 */
+
+#if ESP_CFG_NETCONN_POLL
+/* Wake-up thread waiting in poll on netconn */
+#define NETCONN_POLL_NOTIFY(nc)         do { if ((nc)->poll_sem != NULL) { esp_sys_sem_release((nc)->poll_sem); } } while (0)
+#else /* ESP_CFG_NETCONN_POLL */
+#define NETCONN_POLL_NOTIFY(nc)
+#endif /* !ESP_CFG_NETCONN_POLL */
+
+#if ESP_CFG_NETCONN_SEND_WINDOW
+/* Write buffer is prefixed with its length for send window accounting */
+#define NETCONN_BUFF_HDR_SIZE           sizeof(size_t)
+#else /* ESP_CFG_NETCONN_SEND_WINDOW */
+#define NETCONN_BUFF_HDR_SIZE           0
+#endif /* !ESP_CFG_NETCONN_SEND_WINDOW */
+
 /**
  * \brief           Sequential API structure
  */
@@ -60,6 +78,7 @@ typedef struct esp_netconn {
     esp_conn_p conn;                            /*!< Pointer to actual connection */
 
     esp_sys_mbox_t mbox_accept;                 /*!< List of active connections waiting to be processed */
+    size_t mbox_accept_entries;                 /*!< Number of entries written to accept mbox */
     esp_sys_mbox_t mbox_receive;                /*!< Message queue for receive mbox */
     size_t mbox_receive_entries;                /*!< Number of entries written to receive mbox */
 
@@ -73,11 +92,57 @@ typedef struct esp_netconn {
 #if ESP_CFG_NETCONN_RECEIVE_TIMEOUT || __DOXYGEN__
     uint32_t rcv_timeout;                       /*!< Receive timeout in unit of milliseconds */
 #endif
+#if ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__
+    size_t send_window;                         /*!< Maximal number of queued bytes not yet sent */
+    size_t send_pending;                        /*!< Number of queued bytes not yet sent */
+    esp_sys_sem_t send_sem;                     /*!< Semaphore released when queued data are sent */
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__ */
+#if ESP_CFG_NETCONN_POLL || __DOXYGEN__
+    esp_sys_sem_t* poll_sem;                    /*!< Semaphore of thread waiting in poll, `NULL` if none */
+#endif /* ESP_CFG_NETCONN_POLL || __DOXYGEN__ */
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__
+    char pool_host[ESP_CFG_NETCONN_CONN_POOL_HOST_LEN]; /*!< Host of client connection, empty when connection cannot be pooled */
+    esp_port_t pool_port;                       /*!< Remote port of client connection */
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__ */
 } esp_netconn_t;
 
-static uint8_t recv_closed = 0xFF, recv_not_present = 0xFF;
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Idle client connection kept open for reuse
+ */
+typedef struct {
+    esp_conn_p conn;                            /*!< Connection handle, `NULL` when entry is free */
+    uint8_t val_id;                             /*!< Connection validation ID when it was put to pool */
+    esp_netconn_type_t type;                    /*!< Connection type */
+    esp_port_t port;                            /*!< Remote port */
+    char host[ESP_CFG_NETCONN_CONN_POOL_HOST_LEN];  /*!< Remote host as used for connect */
+    uint32_t idle_since;                        /*!< System time when connection was put to pool */
+} netconn_pool_entry_t;
+
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__ */
+
+static uint8_t recv_closed = 0xFF, recv_not_present = 0xFF, recv_reset = 0xFF;
 static esp_netconn_t* listen_api;               /*!< Main connection in listening mode */
+static uint8_t listen_woken;                    /*!< Set to `1` when listener was woken with error marker */
 static esp_netconn_t* netconn_list;             /*!< Linked list of netconn entries */
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0
+static netconn_pool_entry_t conn_pool[ESP_CFG_NETCONN_CONN_POOL_SIZE];  /*!< Idle client connections */
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 */
+
+#if ESP_CFG_MEM_STATIC
+ESP_MEM_POOL_DEFINE(netconn_pool, sizeof(esp_netconn_t), ESP_CFG_MEM_STATIC_NETCONNS);
+ESP_MEM_POOL_DEFINE(netconn_buff_pool, NETCONN_BUFF_HDR_SIZE + ESP_CFG_CONN_MAX_DATA_LEN, ESP_CFG_MEM_STATIC_NETCONN_BUFFS);
+#define NETCONN_ALLOC()                 espi_mem_pool_alloc(&netconn_pool)
+#define NETCONN_FREE(nc)                espi_mem_pool_free(&netconn_pool, (nc))
+#define NETCONN_BUFF_ALLOC()            espi_mem_pool_alloc(&netconn_buff_pool)
+#define NETCONN_BUFF_FREE(mem)          espi_mem_pool_free(&netconn_buff_pool, (mem))
+#else /* ESP_CFG_MEM_STATIC */
+#define NETCONN_ALLOC()                 esp_mem_malloc(sizeof(esp_netconn_t))
+#define NETCONN_FREE(nc)                esp_mem_free(nc)
+#define NETCONN_BUFF_ALLOC()            esp_mem_malloc_tag(NETCONN_BUFF_HDR_SIZE + ESP_CFG_CONN_MAX_DATA_LEN, ESP_MEM_TAG_CONN)
+#define NETCONN_BUFF_FREE(mem)          esp_mem_free(mem)
+#endif /* !ESP_CFG_MEM_STATIC */
 
 /**
  * \brief           Flush all mboxes and clear possible used memories
@@ -105,9 +170,13 @@ flush_mboxes(esp_netconn_t* nc, uint8_t protect) {
     }
     if (esp_sys_mbox_isvalid(&nc->mbox_accept)) {
         while (esp_sys_mbox_getnow(&nc->mbox_accept, (void **)&new_nc)) {
+            if (nc->mbox_accept_entries > 0) {
+                --nc->mbox_accept_entries;
+            }
             if (new_nc != NULL
                 && (uint8_t *)new_nc != (uint8_t *)&recv_closed
-                && (uint8_t *)new_nc != (uint8_t *)&recv_not_present) {
+                && (uint8_t *)new_nc != (uint8_t *)&recv_not_present
+                && (uint8_t *)new_nc != (uint8_t *)&recv_reset) {
                 esp_netconn_close(new_nc);      /* Close netconn connection */
             }
         }
@@ -119,6 +188,163 @@ flush_mboxes(esp_netconn_t* nc, uint8_t protect) {
     }
 }
 
+/**
+ * \brief           Wake thread waiting in accept with error marker
+ *
+ *                  Only first marker is written, listener is disabled when it is read
+ *
+ * \param[in]       marker: Marker to write to accept mbox
+ */
+static void
+listen_wake(void* marker) {
+    if (listen_api != NULL && !listen_woken
+        && esp_sys_mbox_putnow(&listen_api->mbox_accept, marker)) {
+        listen_woken = 1;
+        ++listen_api->mbox_accept_entries;
+        NETCONN_POLL_NOTIFY(listen_api);
+    }
+}
+
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+
+/**
+ * \brief           Add receive queue and total receive latency of packet buffer
+ * \note            Core must be locked when calling this function
+ * \param[in]       pbuf: Packet buffer taken from receive queue
+ */
+static void
+netconn_trace_receive(esp_pbuf_p pbuf) {
+    uint32_t now = esp_sys_now();
+
+    espi_trace_add(ESP_TRACE_RX_MBOX, now - pbuf->trace_time);
+    espi_trace_add(ESP_TRACE_RX_TOTAL, now - pbuf->trace_in);
+}
+
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Find pool entry of connection
+ * \note            Core must be locked when calling this function
+ * \param[in]       conn: Connection handle
+ * \return          Pool entry or `NULL` if connection is not in pool
+ */
+static netconn_pool_entry_t*
+netconn_pool_find(esp_conn_p conn) {
+    for (size_t i = 0; i < ESP_ARRAYSIZE(conn_pool); ++i) {
+        if (conn_pool[i].conn == conn && conn_pool[i].val_id == conn->val_id) {
+            return &conn_pool[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Take idle connection from pool and attach it to netconn
+ * \param[in]       nc: Netconn handle to attach connection to
+ * \param[in]       host: Remote host
+ * \param[in]       port: Remote port
+ * \return          `1` if connection was taken from pool, `0` otherwise
+ */
+static uint8_t
+netconn_pool_take(esp_netconn_p nc, const char* host, esp_port_t port) {
+    netconn_pool_entry_t* e;
+    uint8_t taken = 0;
+
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(conn_pool) && !taken; ++i) {
+        e = &conn_pool[i];
+        if (e->conn == NULL || e->type != nc->type || e->port != port
+            || strcmp(e->host, host)) {
+            continue;
+        }
+        if (e->conn->status.f.active && !e->conn->status.f.in_closing
+            && e->conn->val_id == e->val_id) {
+            nc->conn = e->conn;
+            esp_conn_set_arg(nc->conn, nc);     /* Connection events go to netconn again */
+            taken = 1;
+        }
+        e->conn = NULL;                         /* Entry is free, connection was taken or is not valid */
+    }
+    esp_core_unlock();
+    return taken;
+}
+
+/**
+ * \brief           Close connection which is idle for the longest time
+ * \note            Function blocks until connection is closed
+ * \return          `1` if connection was closed, `0` if pool is empty
+ */
+static uint8_t
+netconn_pool_evict_oldest(void) {
+    netconn_pool_entry_t* oldest = NULL;
+    esp_conn_p conn = NULL;
+    uint32_t now;
+
+    esp_core_lock();
+    now = esp_sys_now();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(conn_pool); ++i) {
+        if (conn_pool[i].conn != NULL && (oldest == NULL
+            || now - conn_pool[i].idle_since > now - oldest->idle_since)) {
+            oldest = &conn_pool[i];
+        }
+    }
+    if (oldest != NULL) {
+        conn = oldest->conn;
+        oldest->conn = NULL;
+    }
+    esp_core_unlock();
+
+    if (conn != NULL) {
+        ESP_DEBUGF(ESP_CFG_DBG_NETCONN | ESP_DBG_TYPE_TRACE,
+            "[NETCONN] Closing pooled connection to free connection slot\r\n");
+        esp_conn_close(conn, 1);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * \brief           Process event of idle connection in pool
+ * \note            Called from connection callback with core locked
+ * \param[in]       e: Pool entry of connection
+ * \param[in]       evt: Event information
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+netconn_pool_evt(netconn_pool_entry_t* e, esp_evt_t* evt) {
+    esp_conn_p conn = e->conn;
+
+    switch (esp_evt_get_type(evt)) {
+        case ESP_EVT_CONN_POLL: {               /* Connection is still active, check its age */
+            if (esp_sys_now() - e->idle_since < ESP_CFG_NETCONN_CONN_POOL_IDLE_TIME) {
+                break;
+            }
+            e->conn = NULL;
+            esp_conn_close(conn, 0);            /* Idle for too long */
+            break;
+        }
+        case ESP_EVT_CONN_RECV: {               /* Data on idle connection cannot belong to next request */
+#if !ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+            esp_conn_recved(conn, esp_evt_conn_recv_get_buff(evt));
+#endif /* !ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+            e->conn = NULL;
+            esp_conn_close(conn, 0);
+            return espOKIGNOREMORE;
+        }
+        case ESP_EVT_CONN_CLOSE: {              /* Closed by remote side or by device */
+            e->conn = NULL;
+            break;
+        }
+        default:
+            break;
+    }
+    return espOK;
+}
+
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__ */
+
 /**
  * \brief           Callback function for every server connection
  * \param[in]       evt: Pointer to callback structure
@@ -131,6 +357,15 @@ netconn_evt(esp_evt_t* evt) {
     uint8_t close = 0;
 
     conn = esp_conn_get_from_evt(evt);          /* Get connection from event */
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0
+    if (conn != NULL && esp_conn_get_arg(conn) == NULL) {
+        netconn_pool_entry_t* e;
+
+        if ((e = netconn_pool_find(conn)) != NULL) {
+            return netconn_pool_evt(e, evt);
+        }
+    }
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 */
     switch (esp_evt_get_type(evt)) {
         /*
          * A new connection has been active
@@ -164,6 +399,9 @@ netconn_evt(esp_evt_t* evt) {
                     if (!esp_sys_mbox_isvalid(&listen_api->mbox_accept)
                         || !esp_sys_mbox_putnow(&listen_api->mbox_accept, nc)) {
                         close = 1;
+                    } else {
+                        ++listen_api->mbox_accept_entries;
+                        NETCONN_POLL_NOTIFY(listen_api);
                     }
                 } else {
                     close = 1;
@@ -201,6 +439,9 @@ netconn_evt(esp_evt_t* evt) {
 #endif /* !ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
 
             esp_pbuf_ref(pbuf);                 /* Increase reference counter */
+#if ESP_CFG_LATENCY_TRACE
+            pbuf->trace_time = esp_sys_now();   /* Receive queue wait starts now */
+#endif /* ESP_CFG_LATENCY_TRACE */
             if (nc == NULL || !esp_sys_mbox_isvalid(&nc->mbox_receive)
                 || !esp_sys_mbox_putnow(&nc->mbox_receive, pbuf)) {
                 ESP_DEBUGF(ESP_CFG_DBG_NETCONN,
@@ -209,6 +450,7 @@ netconn_evt(esp_evt_t* evt) {
                 return espOKIGNOREMORE;         /* Return OK to free the memory and ignore further data */
             }
             ++nc->mbox_receive_entries;         /* Increase number of packets in receive mbox */
+            NETCONN_POLL_NOTIFY(nc);
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
             /* Check against 1 less to still allow potential close event to be written to queue */
             if (nc->mbox_receive_entries >= (ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN - 1)) {
@@ -234,6 +476,7 @@ netconn_evt(esp_evt_t* evt) {
             if (nc != NULL && esp_sys_mbox_isvalid(&nc->mbox_receive)) {
                 if (esp_sys_mbox_putnow(&nc->mbox_receive, (void *)&recv_closed)) {
                     ++nc->mbox_receive_entries;
+                    NETCONN_POLL_NOTIFY(nc);
                 }
             }
 
@@ -254,15 +497,18 @@ static espr_t
 esp_evt(esp_evt_t* evt) {
     switch (esp_evt_get_type(evt)) {
         case ESP_EVT_WIFI_DISCONNECTED: {       /* Wifi disconnected event */
-            if (listen_api != NULL) {           /* Check if listen API active */
-                esp_sys_mbox_putnow(&listen_api->mbox_accept, &recv_closed);
-            }
+            listen_wake(&recv_closed);
             break;
         }
         case ESP_EVT_DEVICE_PRESENT: {          /* Device present event */
-            if (listen_api != NULL && !esp_device_is_present()) {   /* Check if device present */
-                esp_sys_mbox_putnow(&listen_api->mbox_accept, &recv_not_present);
+            if (!esp_device_is_present()) {     /* Check if device present */
+                listen_wake(&recv_not_present);
             }
+            break;
+        }
+        case ESP_EVT_RESET_DETECTED: {          /* Device reset, server is not active anymore */
+            listen_wake(&recv_reset);
+            break;
         }
         default: break;
     }
@@ -286,8 +532,9 @@ esp_netconn_new(esp_netconn_type_t type) {
         esp_evt_register(esp_evt);              /* Register global event function */
     }
     esp_core_unlock();
-    a = esp_mem_calloc(1, sizeof(*a));          /* Allocate memory for core object */
+    a = NETCONN_ALLOC();                        /* Allocate memory for core object */
     if (a != NULL) {
+        ESP_MEMSET(a, 0x00, sizeof(*a));
         a->type = type;                         /* Save netconn type */
         a->conn_timeout = 0;                    /* Default connection timeout */
         if (!esp_sys_mbox_create(&a->mbox_accept, ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN)) {  /* Allocate memory for accepting message box */
@@ -295,11 +542,20 @@ esp_netconn_new(esp_netconn_type_t type) {
                 "[NETCONN] Cannot create accept MBOX\r\n");
             goto free_ret;
         }
-        if (!esp_sys_mbox_create(&a->mbox_receive, ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN)) {    /* Allocate memory for receiving message box */
+        if (!esp_sys_mbox_create(&a->mbox_receive, type == ESP_NETCONN_TYPE_UDP ?
+                ESP_CFG_NETCONN_UDP_RECEIVE_QUEUE_LEN : ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN)) {   /* Allocate memory for receiving message box */
             ESP_DEBUGF(ESP_CFG_DBG_NETCONN | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_DANGER,
                 "[NETCONN] Cannot create receive MBOX\r\n");
             goto free_ret;
         }
+#if ESP_CFG_NETCONN_SEND_WINDOW
+        a->send_window = ESP_CFG_NETCONN_SEND_WINDOW;
+        if (!esp_sys_sem_create(&a->send_sem, 0)) {
+            ESP_DEBUGF(ESP_CFG_DBG_NETCONN | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_DANGER,
+                "[NETCONN] Cannot create send semaphore\r\n");
+            goto free_ret;
+        }
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW */
         esp_core_lock();
         if (netconn_list == NULL) {             /* Add new netconn to the existing list */
             netconn_list = a;
@@ -319,8 +575,14 @@ free_ret:
         esp_sys_mbox_delete(&a->mbox_receive);
         esp_sys_mbox_invalid(&a->mbox_receive);
     }
+#if ESP_CFG_NETCONN_SEND_WINDOW
+    if (esp_sys_sem_isvalid(&a->send_sem)) {
+        esp_sys_sem_delete(&a->send_sem);
+        esp_sys_sem_invalid(&a->send_sem);
+    }
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW */
     if (a != NULL) {
-        esp_mem_free_s((void **)&a);
+        NETCONN_FREE(a);
     }
     return NULL;
 }
@@ -361,7 +623,20 @@ esp_netconn_delete(esp_netconn_p nc) {
     }
     esp_core_unlock();
 
-    esp_mem_free_s((void **)&nc);
+#if ESP_CFG_NETCONN_SEND_WINDOW
+    /* Queued write buffers reference netconn until they are sent */
+    esp_core_lock();
+    while (nc->send_pending > 0) {
+        esp_core_unlock();
+        esp_sys_sem_wait(&nc->send_sem, 0);
+        esp_core_lock();
+    }
+    esp_core_unlock();
+    esp_sys_sem_delete(&nc->send_sem);
+    esp_sys_sem_invalid(&nc->send_sem);
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW */
+
+    NETCONN_FREE(nc);
     return espOK;
 }
 
@@ -387,10 +662,78 @@ esp_netconn_connect(esp_netconn_p nc, const char* host, esp_port_t port) {
      *  - Set netconn callback function for connection management
      *  - Start connection in blocking mode
      */
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0
+    nc->pool_host[0] = '\0';
+    if (nc->type != ESP_NETCONN_TYPE_UDP && strlen(host) < sizeof(nc->pool_host)) {
+        strcpy(nc->pool_host, host);            /* Connection may be pooled later */
+        nc->pool_port = port;
+        if (netconn_pool_take(nc, host, port)) {
+            ESP_DEBUGF(ESP_CFG_DBG_NETCONN | ESP_DBG_TYPE_TRACE,
+                "[NETCONN] Reusing pooled connection to %s:%d\r\n", host, (int)port);
+            return espOK;
+        }
+    }
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 */
     res = esp_conn_start(NULL, (esp_conn_type_t)nc->type, host, port, nc, netconn_evt, 1);
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0
+    /* Idle connections give way to new one */
+    while (res == espERRNOFREECONN && netconn_pool_evict_oldest()) {
+        res = esp_conn_start(NULL, (esp_conn_type_t)nc->type, host, port, nc, netconn_evt, 1);
+    }
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 */
     return res;
 }
 
+/**
+ * \brief           Open \e UDP connection on local port, accepting datagrams from any peer
+ *
+ * Connection is started in \ref ESP_CONN_UDP_MODE_ANY_PEER mode, where remote IP and port follow
+ * sender of last received datagram. Single connection can serve any number of peers,
+ * reply to each of them with \ref esp_netconn_sendto, using IP and port of received
+ * buffer, read with \ref esp_pbuf_get_ip.
+ *
+ * \note            Sender information is only available when \ref ESP_CFG_CONN_IPD_INFO is enabled
+ * \param[in]       nc: Netconn handle of \ref ESP_NETCONN_TYPE_UDP type
+ * \param[in]       local_port: Local port to receive datagrams on
+ * \return          \ref espOK if successfully opened, member of \ref espr_t otherwise
+ */
+espr_t
+esp_netconn_connect_udp_any(esp_netconn_p nc, esp_port_t local_port) {
+    esp_conn_start_t cs = { 0 };
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("nc->type must be UDP", nc->type == ESP_NETCONN_TYPE_UDP);
+    ESP_ASSERT("local_port > 0", local_port > 0);
+
+    cs.type = ESP_CONN_TYPE_UDP;
+    cs.remote_host = "0.0.0.0";                 /* Remote is overwritten by first datagram */
+    cs.remote_port = local_port;
+    cs.ext.udp.local_port = local_port;
+    cs.ext.udp.mode = ESP_CONN_UDP_MODE_ANY_PEER;
+    return esp_conn_startex(NULL, &cs, nc, netconn_evt, 1);
+}
+
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+
+/**
+ * \brief           Connect to server as client in transparent (CIPMODE=1) mode
+ * \note            Only one connection can be active in transparent mode
+ * \param[in]       nc: Netconn handle
+ * \param[in]       host: Pointer to host, such as domain name or IP address in string format
+ * \param[in]       port: Target port to use
+ * \return          \ref espOK if successfully connected, member of \ref espr_t otherwise
+ */
+espr_t
+esp_netconn_connect_transparent(esp_netconn_p nc, const char* host, esp_port_t port) {
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("host != NULL", host != NULL);
+    ESP_ASSERT("port > 0", port > 0);
+
+    return esp_conn_start_transparent(NULL, (esp_conn_type_t)nc->type, host, port, nc, netconn_evt, 1);
+}
+
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
+
 /**
  * \brief           Bind a connection to specific port, can be only used for server connections
  * \param[in]       nc: Netconn handle
@@ -441,6 +784,45 @@ esp_netconn_set_listen_conn_timeout(esp_netconn_p nc, uint16_t timeout) {
     return res;
 }
 
+/**
+ * \brief           Set maximal number of new clients waiting in accept queue of server connection
+ *
+ *                  When queue is full, new client connections are closed by stack.
+ *                  Larger backlog keeps clients during connection bursts
+ *                  at the cost of one queue entry per waiting client
+ *
+ * \note            Call this function before you put connection to listen mode with \ref esp_netconn_listen
+ * \param[in]       nc: Netconn handle used for listen mode
+ * \param[in]       backlog: Number of queue entries, including one entry reserved for error notification.
+ *                      Default value is \ref ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_netconn_set_accept_backlog(esp_netconn_p nc, size_t backlog) {
+    esp_sys_mbox_t mbox;
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("nc->type must be TCP", nc->type == ESP_NETCONN_TYPE_TCP);
+    ESP_ASSERT("backlog >= 2", backlog >= 2);
+    ESP_ASSERT("nc != listen_api", nc != listen_api);
+
+    if (!esp_sys_mbox_create(&mbox, backlog)) {
+        ESP_DEBUGF(ESP_CFG_DBG_NETCONN | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_DANGER,
+            "[NETCONN] Cannot create accept MBOX\r\n");
+        return espERRMEM;
+    }
+
+    /* Connection is not listening yet, accept queue is empty */
+    esp_core_lock();
+    if (esp_sys_mbox_isvalid(&nc->mbox_accept)) {
+        esp_sys_mbox_delete(&nc->mbox_accept);
+    }
+    nc->mbox_accept = mbox;
+    nc->mbox_accept_entries = 0;
+    esp_core_unlock();
+    return espOK;
+}
+
 /**
  * \brief           Listen on previously binded connection
  * \param[in]       nc: Netconn handle used to listen for new connections
@@ -471,6 +853,7 @@ esp_netconn_listen_with_max_conn(esp_netconn_p nc, uint16_t max_connections) {
         nc->conn_timeout, netconn_evt, NULL, NULL, 1)) == espOK) {
         esp_core_lock();
         listen_api = nc;                        /* Set current main API in listening state */
+        listen_woken = 0;
         esp_core_unlock();
     }
     return res;
@@ -481,6 +864,8 @@ esp_netconn_listen_with_max_conn(esp_netconn_p nc, uint16_t max_connections) {
  * \param[in]       nc: Netconn handle used as base connection to accept new clients
  * \param[out]      client: Pointer to netconn handle to save new connection to
  * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ * \return          \ref espCLOSED when device was reset and server is not active anymore.
+ *                      Connection has to be listened again to accept new clients
  */
 espr_t
 esp_netconn_accept(esp_netconn_p nc, esp_netconn_p* client) {
@@ -497,6 +882,11 @@ esp_netconn_accept(esp_netconn_p nc, esp_netconn_p* client) {
     if (time == ESP_SYS_TIMEOUT) {
         return espTIMEOUT;
     }
+    esp_core_lock();
+    if (nc->mbox_accept_entries > 0) {
+        --nc->mbox_accept_entries;
+    }
+    esp_core_unlock();
     if ((uint8_t *)tmp == (uint8_t *)&recv_closed) {
         esp_core_lock();
         listen_api = NULL;                      /* Disable listening at this point */
@@ -507,14 +897,174 @@ esp_netconn_accept(esp_netconn_p nc, esp_netconn_p* client) {
         listen_api = NULL;                      /* Disable listening at this point */
         esp_core_unlock();
         return espERRNODEVICE;                  /* Device not present */
+    } else if ((uint8_t *)tmp == (uint8_t *)&recv_reset) {
+        esp_core_lock();
+        listen_api = NULL;                      /* Disable listening at this point */
+        esp_core_unlock();
+        return espCLOSED;                       /* Device reset, server closed */
     }
     *client = tmp;                              /* Set new pointer */
     return espOK;                               /* We have a new connection */
 }
 
+/**
+ * \brief           Accept multiple new connections with single call
+ *
+ *                  Function waits for first client the same way as \ref esp_netconn_accept,
+ *                  then takes other clients already waiting in accept queue without blocking.
+ *                  This drains connection bursts with single thread wakeup
+ *
+ * \param[in]       nc: Netconn handle used as base connection to accept new clients
+ * \param[out]      clients: Array to save new connections to
+ * \param[in]       max_cnt: Number of entries in `clients` array
+ * \param[out]      cnt: Output variable to save number of written entries to
+ * \return          \ref espOK when at least one client is accepted
+ * \return          Member of \ref espr_t enumeration as returned by \ref esp_netconn_accept otherwise
+ */
+espr_t
+esp_netconn_accept_many(esp_netconn_p nc, esp_netconn_p* clients, size_t max_cnt, size_t* cnt) {
+    esp_netconn_t* tmp;
+    uint8_t stop;
+    espr_t res;
+    size_t i;
+
+    ESP_ASSERT("clients != NULL", clients != NULL);
+    ESP_ASSERT("max_cnt > 0", max_cnt > 0);
+    ESP_ASSERT("cnt != NULL", cnt != NULL);
+
+    *cnt = 0;
+    if ((res = esp_netconn_accept(nc, &clients[0])) != espOK) {
+        return res;
+    }
+
+    /*
+     * Take clients already in queue without waiting.
+     * Stop when error marker is queued, it is reported by next accept call
+     * after remaining clients
+     */
+    for (i = 1; i < max_cnt; ++i) {
+        esp_core_lock();
+        stop = listen_woken || nc->mbox_accept_entries == 0;
+        esp_core_unlock();
+        if (stop || !esp_sys_mbox_getnow(&nc->mbox_accept, (void **)&tmp)) {
+            break;
+        }
+        esp_core_lock();
+        if (nc->mbox_accept_entries > 0) {
+            --nc->mbox_accept_entries;
+        }
+        esp_core_unlock();
+        clients[i] = tmp;
+    }
+    *cnt = i;
+    return espOK;
+}
+
+/**
+ * \brief           Free netconn write buffer
+ * \param[in]       nc: Netconn handle with write buffer
+ */
+static void
+netconn_buff_free(esp_netconn_p nc) {
+    if (nc->buff.buff != NULL) {
+        NETCONN_BUFF_FREE(nc->buff.buff - NETCONN_BUFF_HDR_SIZE);
+        nc->buff.buff = NULL;
+    }
+}
+
+/**
+ * \brief           Free netconn write buffer once stack sent its data
+ * \param[in]       data: Write buffer to free
+ * \param[in]       arg: Netconn handle which queued the buffer
+ */
+static void
+netconn_buff_release(const void* data, void* arg) {
+    uint8_t* mem = (uint8_t *)data - NETCONN_BUFF_HDR_SIZE;
+#if ESP_CFG_NETCONN_SEND_WINDOW
+    esp_netconn_p nc = arg;
+    size_t len;
+
+    ESP_MEMCPY(&len, mem, sizeof(len));
+    esp_core_lock();
+    nc->send_pending -= ESP_MIN(len, nc->send_pending);
+    esp_core_unlock();
+    esp_sys_sem_release(&nc->send_sem);         /* Wake-up potential writer */
+#else /* ESP_CFG_NETCONN_SEND_WINDOW */
+    ESP_UNUSED(arg);
+#endif /* !ESP_CFG_NETCONN_SEND_WINDOW */
+    NETCONN_BUFF_FREE(mem);
+}
+
+#if ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__
+
+/**
+ * \brief           Reserve space in send window, block until enough data are sent
+ * \note            Buffer is always accepted when nothing is pending, even if larger than window
+ * \param[in]       nc: Netconn handle
+ * \param[in]       len: Number of bytes to queue
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+netconn_send_window_wait(esp_netconn_p nc, size_t len) {
+    while (1) {
+        esp_core_lock();
+        if (nc->conn == NULL || !esp_conn_is_active(nc->conn)) {
+            esp_core_unlock();
+            return espCLOSED;
+        }
+        if (nc->send_window == 0 || nc->send_pending == 0
+            || nc->send_pending + len <= nc->send_window) {
+            nc->send_pending += len;
+            esp_core_unlock();
+            return espOK;
+        }
+        esp_core_unlock();
+        esp_sys_sem_wait(&nc->send_sem, 0);     /* Wait for stack to send some data */
+    }
+}
+
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__ */
+
+/**
+ * \brief           Pass write buffer to stack without copy and without waiting for data to be sent
+ *
+ * Buffer ownership is transferred to stack, which frees it after data are sent.
+ * Buffer is freed immediately when it cannot be queued
+ *
+ * \param[in]       nc: Netconn handle with write buffer
+ * \param[in]       len: Number of bytes in write buffer to send
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+netconn_send_buff(esp_netconn_p nc, size_t len) {
+    espr_t res;
+
+#if ESP_CFG_NETCONN_SEND_WINDOW
+    if ((res = netconn_send_window_wait(nc, len)) != espOK) {
+        netconn_buff_free(nc);
+        return res;
+    }
+    ESP_MEMCPY(nc->buff.buff - NETCONN_BUFF_HDR_SIZE, &len, sizeof(len));
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW */
+    res = esp_conn_send_ref(nc->conn, nc->buff.buff, len, netconn_buff_release, nc, 0);
+    if (res == espOK) {
+        nc->buff.buff = NULL;                   /* Stack owns the memory now */
+    } else {
+#if ESP_CFG_NETCONN_SEND_WINDOW
+        esp_core_lock();
+        nc->send_pending -= ESP_MIN(len, nc->send_pending);
+        esp_core_unlock();
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW */
+        netconn_buff_free(nc);
+    }
+    return res;
+}
+
 /**
  * \brief           Write data to connection output buffers
  * \note            This function may only be used on TCP or SSL connections
+ * \note            Full write buffers are queued to stack without waiting for `SEND OK`.
+ *                  Error while sending queued buffer is therefore not reported by this function
  * \param[in]       nc: Netconn handle used to write data to
  * \param[in]       data: Pointer to data to write
  * \param[in]       btw: Number of bytes to write
@@ -534,7 +1084,7 @@ esp_netconn_write(esp_netconn_p nc, const void* data, size_t btw) {
      * Several steps are done in write process
      *
      * 1. Check if buffer is set and check if there is something to write to it.
-     *    1. In case buffer will be full after copy, send it and free memory.
+     *    1. In case buffer will be full after copy, pass it to stack, which frees it after send.
      * 2. Check how many bytes we can write directly without needed to copy
      * 3. Try to allocate a new buffer and copy remaining input data to it
      * 4. In case buffer allocation fails, send data directly (may affect on speed and effectivenes)
@@ -552,9 +1102,7 @@ esp_netconn_write(esp_netconn_p nc, const void* data, size_t btw) {
 
         /* Step 1.1 */
         if (nc->buff.ptr == nc->buff.len) {
-            res = esp_conn_send(nc->conn, nc->buff.buff, nc->buff.len, &sent, 1);
-
-            esp_mem_free_s((void **)&nc->buff.buff);
+            res = netconn_send_buff(nc, nc->buff.len);
             if (res != espOK) {
                 return res;
             }
@@ -581,7 +1129,10 @@ esp_netconn_write(esp_netconn_p nc, const void* data, size_t btw) {
 
     /* Step 3 */
     if (nc->buff.buff == NULL) {                /* Check if we should allocate a new buffer */
-        nc->buff.buff = esp_mem_malloc(sizeof(*nc->buff.buff) * ESP_CFG_CONN_MAX_DATA_LEN);
+        uint8_t* mem;
+
+        mem = NETCONN_BUFF_ALLOC();
+        nc->buff.buff = mem != NULL ? mem + NETCONN_BUFF_HDR_SIZE : NULL;
         nc->buff.len = ESP_CFG_CONN_MAX_DATA_LEN;   /* Save buffer length */
         nc->buff.ptr = 0;                       /* Save buffer pointer */
     }
@@ -591,11 +1142,36 @@ esp_netconn_write(esp_netconn_p nc, const void* data, size_t btw) {
         ESP_MEMCPY(&nc->buff.buff[nc->buff.ptr], d, btw);   /* Copy data to buffer */
         nc->buff.ptr += btw;
     } else {                                    /* Still no memory available? */
-        return esp_conn_send(nc->conn, data, btw, NULL, 1); /* Simply send directly blocking */
+        return esp_conn_send(nc->conn, d, btw, NULL, 1);    /* Simply send directly blocking */
     }
     return espOK;
 }
 
+/**
+ * \brief           Write multiple data fragments to connection output buffers
+ * \note            This function may only be used on TCP or SSL connections
+ * \note            Fragments are coalesced into single write buffer,
+ *                  there is no need to concatenate them on user side first
+ * \param[in]       nc: Netconn handle used to write data to
+ * \param[in]       iov: Array of data fragments to write
+ * \param[in]       iovcnt: Number of entries in `iov` array
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_netconn_writev(esp_netconn_p nc, const esp_iovec_t* iov, size_t iovcnt) {
+    espr_t res = espOK;
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("iov != NULL", iov != NULL);
+
+    for (size_t i = 0; i < iovcnt && res == espOK; ++i) {
+        if (iov[i].len > 0) {
+            res = esp_netconn_write(nc, iov[i].data, iov[i].len);
+        }
+    }
+    return res;
+}
+
 /**
  * \brief           Flush buffered data on netconn \e TCP/SSL connection
  * \note            This function may only be used on \e TCP/SSL connection
@@ -614,9 +1190,10 @@ esp_netconn_flush(esp_netconn_p nc) {
      */
     if (nc->buff.buff != NULL) {                /* Check remaining data */
         if (nc->buff.ptr > 0) {                 /* Do we have data in current buffer? */
-            esp_conn_send(nc->conn, nc->buff.buff, nc->buff.ptr, NULL, 1);  /* Send data */
+            netconn_send_buff(nc, nc->buff.ptr);/* Send data, stack frees buffer */
+        } else {
+            netconn_buff_free(nc);
         }
-        esp_mem_free_s((void **)&nc->buff.buff);
     }
     return espOK;
 }
@@ -640,6 +1217,8 @@ esp_netconn_send(esp_netconn_p nc, const void* data, size_t btw) {
 /**
  * \brief           Send data on \e UDP connection to specific IP and port
  * \note            Use this function in case of UDP type netconn
+ * \note            To reply to sender of received datagram, use IP and port
+ *                  from \ref esp_pbuf_get_ip on received buffer
  * \param[in]       nc: Netconn handle used to send
  * \param[in]       ip: Pointer to IP address
  * \param[in]       port: Port number used to send data
@@ -689,6 +1268,11 @@ esp_netconn_receive(esp_netconn_p nc, esp_pbuf_p* pbuf) {
     if (nc->mbox_receive_entries > 0) {
         --nc->mbox_receive_entries;
     }
+#if ESP_CFG_LATENCY_TRACE
+    if ((uint8_t *)(*pbuf) != (uint8_t *)&recv_closed) {
+        netconn_trace_receive(*pbuf);
+    }
+#endif /* ESP_CFG_LATENCY_TRACE */
     esp_core_unlock();
 
     /* Check if connection closed */
@@ -707,6 +1291,123 @@ esp_netconn_receive(esp_netconn_p nc, esp_pbuf_p* pbuf) {
     return espOK;                               /* We have data available */
 }
 
+/**
+ * \brief           Receive all data waiting on connection as single pbuf chain
+ *
+ *                  Function waits for first packet the same way as \ref esp_netconn_receive,
+ *                  then takes other packets already waiting in receive queue without blocking
+ *                  and concatenates them to first one, until at least `max_len` bytes are collected.
+ *                  This reduces number of receive calls and thread switches for bulk transfers
+ *
+ * \note            Packets are always taken as a whole, total length may exceed `max_len` with last packet
+ * \note            Function is available for TCP and SSL connections only
+ * \param[in]       nc: Netconn handle used to receive from
+ * \param[in]       pbuf: Pointer to pointer to save new receive buffer chain to.
+ *                     When function returns, user must check for valid pbuf value `pbuf != NULL`
+ * \param[in]       max_len: Number of bytes after which no more packets are taken from queue.
+ *                     Set to `0` to take all waiting packets
+ * \return          \ref espOK when new data ready
+ * \return          \ref espCLOSED when connection closed by remote side
+ * \return          \ref espTIMEOUT when receive timeout occurs
+ * \return          Any other member of \ref espr_t otherwise
+ */
+espr_t
+esp_netconn_receive_bulk(esp_netconn_p nc, esp_pbuf_p* pbuf, size_t max_len) {
+    esp_pbuf_p p;
+    size_t len;
+    espr_t res;
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("nc->type must be TCP or SSL", nc->type != ESP_NETCONN_TYPE_UDP);
+
+    if ((res = esp_netconn_receive(nc, pbuf)) != espOK) {
+        return res;
+    }
+
+    /* Take packets already in queue without waiting */
+    len = esp_pbuf_length(*pbuf, 1);
+    while ((max_len == 0 || len < max_len) && esp_sys_mbox_getnow(&nc->mbox_receive, (void **)&p)) {
+        if ((uint8_t *)p == (uint8_t *)&recv_closed) {
+            /* Close is last entry, keep it for next receive call */
+            esp_sys_mbox_putnow(&nc->mbox_receive, (void *)&recv_closed);
+            break;
+        }
+
+        esp_core_lock();
+        if (nc->mbox_receive_entries > 0) {
+            --nc->mbox_receive_entries;
+        }
+#if ESP_CFG_LATENCY_TRACE
+        netconn_trace_receive(p);
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+        nc->conn->status.f.receive_blocked = 0; /* Resume reading more data */
+        esp_conn_recved(nc->conn, p);           /* Notify stack about received data */
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+        esp_core_unlock();
+
+        len += esp_pbuf_length(p, 1);
+        esp_pbuf_cat(*pbuf, p);                 /* Reference is moved to chain */
+    }
+    return espOK;
+}
+
+/**
+ * \brief           Receive multiple datagrams on \e UDP connection with single call
+ *
+ *                  Function waits for first datagram the same way as \ref esp_netconn_receive,
+ *                  then takes other datagrams already waiting in receive queue without blocking.
+ *                  Every datagram is its own pbuf with sender address,
+ *                  available with \ref esp_pbuf_get_ip function
+ *
+ * \note            Function is available for UDP connections only
+ * \param[in]       nc: Netconn handle used to receive from
+ * \param[out]      pbufs: Array to save received datagrams to. User must free every entry
+ * \param[in]       max_cnt: Number of entries in `pbufs` array
+ * \param[out]      cnt: Output variable to save number of written entries to
+ * \return          \ref espOK when at least one datagram is received
+ * \return          \ref espCLOSED when connection closed
+ * \return          \ref espTIMEOUT when receive timeout occurs
+ * \return          Any other member of \ref espr_t otherwise
+ */
+espr_t
+esp_netconn_receive_batch(esp_netconn_p nc, esp_pbuf_p* pbufs, size_t max_cnt, size_t* cnt) {
+    esp_pbuf_p p;
+    espr_t res;
+    size_t i;
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("nc->type must be UDP", nc->type == ESP_NETCONN_TYPE_UDP);
+    ESP_ASSERT("pbufs != NULL", pbufs != NULL);
+    ESP_ASSERT("max_cnt > 0", max_cnt > 0);
+    ESP_ASSERT("cnt != NULL", cnt != NULL);
+
+    *cnt = 0;
+    if ((res = esp_netconn_receive(nc, &pbufs[0])) != espOK) {
+        return res;
+    }
+
+    /* Take datagrams already in queue without waiting */
+    for (i = 1; i < max_cnt && esp_sys_mbox_getnow(&nc->mbox_receive, (void **)&p); ++i) {
+        if ((uint8_t *)p == (uint8_t *)&recv_closed) {
+            /* Close is last entry, keep it for next receive call */
+            esp_sys_mbox_putnow(&nc->mbox_receive, (void *)&recv_closed);
+            break;
+        }
+        esp_core_lock();
+        if (nc->mbox_receive_entries > 0) {
+            --nc->mbox_receive_entries;
+        }
+#if ESP_CFG_LATENCY_TRACE
+        netconn_trace_receive(p);
+#endif /* ESP_CFG_LATENCY_TRACE */
+        esp_core_unlock();
+        pbufs[i] = p;
+    }
+    *cnt = i;
+    return espOK;
+}
+
 /**
  * \brief           Close a netconn connection
  * \param[in]       nc: Netconn handle to close
@@ -730,6 +1431,77 @@ esp_netconn_close(esp_netconn_p nc) {
     return espOK;
 }
 
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Release client connection to pool instead of closing it
+ *
+ * Connection stays open and next \ref esp_netconn_connect with the same host,
+ * port and type uses it without starting new connection.
+ * When pool is full, connection idle for the longest time is closed.
+ * Connections which cannot be pooled are closed as with \ref esp_netconn_close
+ *
+ * \note            Application must read complete response before releasing connection,
+ *                  data received on idle connection close it
+ * \param[in]       nc: Netconn handle to release connection from
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_netconn_release(esp_netconn_p nc) {
+    netconn_pool_entry_t* e = NULL;
+    esp_conn_p conn, evict = NULL;
+    uint32_t now;
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("nc->conn != NULL", nc->conn != NULL);
+
+    if (nc->type == ESP_NETCONN_TYPE_UDP || nc->pool_host[0] == '\0'
+        || !esp_conn_is_active(nc->conn) || !esp_conn_is_client(nc->conn)) {
+        return esp_netconn_close(nc);
+    }
+
+    esp_netconn_flush(nc);                      /* Flush data and ignore result */
+    conn = nc->conn;
+
+    esp_core_lock();
+    if (!conn->status.f.active || conn->status.f.in_closing) {
+        esp_core_unlock();
+        return esp_netconn_close(nc);
+    }
+
+    /* Take free entry or entry with connection idle for the longest time */
+    now = esp_sys_now();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(conn_pool); ++i) {
+        if (conn_pool[i].conn == NULL) {
+            e = &conn_pool[i];
+            break;
+        }
+        if (e == NULL || now - conn_pool[i].idle_since > now - e->idle_since) {
+            e = &conn_pool[i];
+        }
+    }
+    evict = e->conn;
+    e->conn = conn;
+    e->val_id = conn->val_id;
+    e->type = nc->type;
+    e->port = nc->pool_port;
+    strcpy(e->host, nc->pool_host);
+    e->idle_since = now;
+
+    nc->conn = NULL;
+    esp_conn_set_arg(conn, NULL);               /* Events go to pool */
+    esp_core_unlock();
+
+    if (evict != NULL) {
+        esp_conn_close(evict, 0);
+    }
+    esp_conn_set_poll_interval(conn, ESP_CFG_CONN_POLL_INTERVAL);   /* Poll events check idle time */
+    flush_mboxes(nc, 1);                        /* Flush message queues */
+    return espOK;
+}
+
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__ */
+
 /**
  * \brief           Get connection number used for netconn
  * \param[in]       nc: Netconn handle
@@ -773,4 +1545,146 @@ esp_netconn_get_receive_timeout(esp_netconn_p nc) {
 
 #endif /* ESP_CFG_NETCONN_RECEIVE_TIMEOUT || __DOXYGEN__ */
 
+#if ESP_CFG_NETCONN_POLL || __DOXYGEN__
+
+/**
+ * \brief           Check and set ready events of poll entries
+ * \note            Core lock must be active when calling this function
+ * \param[in,out]   fds: Array of poll entries
+ * \param[in]       cnt: Number of entries in array
+ * \return          Number of entries with at least one ready event
+ */
+static size_t
+netconn_poll_check(esp_netconn_poll_t* fds, size_t cnt) {
+    size_t ready = 0;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        fds[i].revents = 0;
+        if (fds[i].nc == NULL) {
+            continue;
+        }
+        if ((fds[i].events & ESP_NETCONN_POLL_RECEIVE) && fds[i].nc->mbox_receive_entries > 0) {
+            fds[i].revents |= ESP_NETCONN_POLL_RECEIVE;
+        }
+        if ((fds[i].events & ESP_NETCONN_POLL_ACCEPT) && fds[i].nc->mbox_accept_entries > 0) {
+            fds[i].revents |= ESP_NETCONN_POLL_ACCEPT;
+        }
+        if (fds[i].revents) {
+            ++ready;
+        }
+    }
+    return ready;
+}
+
+/**
+ * \brief           Wait for events on multiple netconns
+ *
+ * Function blocks until at least one entry has ready event or timeout expires.
+ * Ready entry may then be served with \ref esp_netconn_receive or \ref esp_netconn_accept
+ * without blocking, which allows single thread to serve multiple connections
+ *
+ * \note            Netconn may only be used by one poll call at a time
+ * \param[in,out]   fds: Array of poll entries. Entries with `nc == NULL` are ignored
+ * \param[in]       cnt: Number of entries in array
+ * \param[in]       timeout: Maximal time to wait in units of milliseconds.
+ *                  Set to `0` to wait forever
+ * \param[out]      ready: Output variable to save number of ready entries to. Set to `NULL` if not used
+ * \return          \ref espOK when at least one entry is ready
+ * \return          \ref espTIMEOUT when timeout expired
+ * \return          Any other member of \ref espr_t otherwise
+ */
+espr_t
+esp_netconn_poll(esp_netconn_poll_t* fds, size_t cnt, uint32_t timeout, size_t* ready) {
+    esp_sys_sem_t sem;
+    uint32_t start, elapsed;
+    size_t n;
+
+    ESP_ASSERT("fds != NULL", fds != NULL);
+    ESP_ASSERT("cnt > 0", cnt > 0);
+
+    if (ready != NULL) {
+        *ready = 0;
+    }
+    if (!esp_sys_sem_create(&sem, 0)) {
+        return espERRMEM;
+    }
+
+    /* Register semaphore on all netconns */
+    esp_core_lock();
+    for (size_t i = 0; i < cnt; ++i) {
+        if (fds[i].nc != NULL) {
+            fds[i].nc->poll_sem = &sem;
+        }
+    }
+    esp_core_unlock();
+
+    start = esp_sys_now();
+    while (1) {
+        esp_core_lock();
+        n = netconn_poll_check(fds, cnt);
+        esp_core_unlock();
+        if (n > 0) {
+            break;
+        }
+        if (timeout > 0) {
+            elapsed = esp_sys_now() - start;
+            if (elapsed >= timeout
+                || esp_sys_sem_wait(&sem, timeout - elapsed) == ESP_SYS_TIMEOUT) {
+                break;
+            }
+        } else {
+            esp_sys_sem_wait(&sem, 0);
+        }
+    }
+
+    /* Unregister semaphore */
+    esp_core_lock();
+    for (size_t i = 0; i < cnt; ++i) {
+        if (fds[i].nc != NULL && fds[i].nc->poll_sem == &sem) {
+            fds[i].nc->poll_sem = NULL;
+        }
+    }
+    esp_core_unlock();
+    esp_sys_sem_delete(&sem);
+
+    if (ready != NULL) {
+        *ready = n;
+    }
+    return n > 0 ? espOK : espTIMEOUT;
+}
+
+#endif /* ESP_CFG_NETCONN_POLL || __DOXYGEN__ */
+
+#if ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__
+
+/**
+ * \brief           Set send window for netconn \e TCP/SSL connection
+ *
+ * \ref esp_netconn_write queues full write buffers without waiting for `SEND OK`,
+ * until number of queued bytes not yet sent reaches send window
+ *
+ * \param[in]       nc: Netconn handle
+ * \param[in]       window: Window size in units of bytes.
+ *                  Set to `0` to never block on queued data
+ */
+void
+esp_netconn_set_send_window(esp_netconn_p nc, size_t window) {
+    esp_core_lock();
+    nc->send_window = window;
+    esp_core_unlock();
+    esp_sys_sem_release(&nc->send_sem);         /* Re-check window in potential writer */
+}
+
+/**
+ * \brief           Get netconn send window value
+ * \param[in]       nc: Netconn handle
+ * \return          Window size in units of bytes
+ */
+size_t
+esp_netconn_get_send_window(esp_netconn_p nc) {
+    return nc->send_window;
+}
+
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__ */
+
 #endif /* ESP_CFG_NETCONN || __DOXYGEN__ */
@@ -34,6 +34,7 @@
 #include "esp/apps/esp_cayenne.h"
 #include "esp/esp_mem.h"
 #include "esp/esp_pbuf.h"
+#include "esp/esp_timeout.h"
 
 //#error "This driver is not ready-to-use yet and shall not be used in final product"
 
@@ -44,11 +45,13 @@
 
 #define ESP_CAYENNE_API_VERSION_LEN             (sizeof(ESP_CAYENNE_API_VERSION) - 1)
 
-#define CHECK_FORWARDSLASH_AND_FORWARD(str)     do { if ((str) == NULL || *(str) != '/') { return espERR; } ++(str); } while (0)
-
-#if !ESP_CFG_NETCONN || !ESP_CFG_MODE_STATION
+#if ESP_CAYENNE_USE_EVT_CLIENT
+#if !ESP_CFG_MODE_STATION
+#error "Station mode must be enabled!"
+#endif /* !ESP_CFG_MODE_STATION */
+#elif !ESP_CFG_NETCONN || !ESP_CFG_MODE_STATION
 #error "Netconn and station mode must be enabled!"
-#endif /* !ESP_CFG_NETCONN || !ESP_CFG_MODE_STATION */
+#endif /* ESP_CAYENNE_USE_EVT_CLIENT */
 
 /**
  * \brief           Topic type and string key-value pair structure
@@ -56,34 +59,58 @@
 typedef struct {
     esp_cayenne_topic_t topic;                  /*!< Topic name */
     const char* str;                            /*!< Topic string */
+    size_t len;                                 /*!< Topic string length */
 } topic_cmd_str_pair_t;
 
+#define TOPIC_PAIR(topic, str)                  { (topic), (str), sizeof(str) - 1 }
+
+/* Topic string length: prefix, topic, channel token and NULL termination */
+#define TOPIC_CACHE_STR_LEN                     (ESP_CAYENNE_TOPIC_PREFIX_LEN + sizeof("sys/cpu/speed/65535"))
+
 /**
  * \brief           List of key-value pairs for topic type and string
  */
 const static topic_cmd_str_pair_t
 topic_cmd_str_pairs[] = {
-    { ESP_CAYENNE_TOPIC_DATA, "data" },
-    { ESP_CAYENNE_TOPIC_COMMAND, "cmd" },
-    { ESP_CAYENNE_TOPIC_CONFIG, "conf" },
-    { ESP_CAYENNE_TOPIC_RESPONSE, "response" },
-    { ESP_CAYENNE_TOPIC_SYS_MODEL, "sys/model" },
-    { ESP_CAYENNE_TOPIC_SYS_VERSION, "sys/version" },
-    { ESP_CAYENNE_TOPIC_SYS_CPU_MODEL, "sys/cpu/model" },
-    { ESP_CAYENNE_TOPIC_SYS_CPU_SPEED, "sys/cpu/speed" },
-    { ESP_CAYENNE_TOPIC_DIGITAL, "digital" },
-    { ESP_CAYENNE_TOPIC_DIGITAL_COMMAND, "digital-cmd" },
-    { ESP_CAYENNE_TOPIC_DIGITAL_CONFIG, "digital-conf" },
-    { ESP_CAYENNE_TOPIC_ANALOG, "analog" },
-    { ESP_CAYENNE_TOPIC_ANALOG_COMMAND, "analog-cmd" },
-    { ESP_CAYENNE_TOPIC_ANALOG_CONFIG, "analog-conf" }
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_DATA, "data"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_COMMAND, "cmd"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_CONFIG, "conf"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_RESPONSE, "response"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_SYS_MODEL, "sys/model"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_SYS_VERSION, "sys/version"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_SYS_CPU_MODEL, "sys/cpu/model"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_SYS_CPU_SPEED, "sys/cpu/speed"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_DIGITAL, "digital"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_DIGITAL_COMMAND, "digital-cmd"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_DIGITAL_CONFIG, "digital-conf"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_ANALOG, "analog"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_ANALOG_COMMAND, "analog-cmd"),
+    TOPIC_PAIR(ESP_CAYENNE_TOPIC_ANALOG_CONFIG, "analog-conf")
 };
 
+#if ESP_CAYENNE_USE_EVT_CLIENT
+/*
+ * All calls end up in processing thread or under core lock,
+ * core lock is recursive and can be taken again from event function
+ */
+#define CAYENNE_PROTECT()                       esp_core_lock()
+#define CAYENNE_UNPROTECT()                     esp_core_unlock()
+
+/**
+ * \brief           Received topic and payload, both `NULL` terminated
+ */
+static char
+recv_data[ESP_CAYENNE_RX_BUFF_LEN];
+#else /* ESP_CAYENNE_USE_EVT_CLIENT */
+#define CAYENNE_PROTECT()                       esp_sys_mutex_lock(&prot_mutex)
+#define CAYENNE_UNPROTECT()                     esp_sys_mutex_unlock(&prot_mutex)
+
 /**
  * \brief           Protection mutex
  */
 static esp_sys_mutex_t
 prot_mutex;
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT */
 
 /**
  * \brief           Topic name for publish/subscribe
@@ -100,56 +127,33 @@ payload_data[128];
 /** 
  * \brief           Parse received topic string
  * \param[in]       c: Cayenne handle
- * \param[in]       buf: MQTT buffer with received data
+ * \param[in]       topic: `NULL` terminated received topic
+ * \param[in]       topic_len: Length of topic
  * \return          \ref espOK on success, member of \ref espr_t otherwise
  */
 static espr_t
-parse_topic(esp_cayenne_t* c, esp_mqtt_client_api_buf_p buf) {
+parse_topic(esp_cayenne_t* c, const char* topic, size_t topic_len) {
     esp_cayenne_msg_t* msg;
-    const char* topic;
     size_t len, i;
 
     ESP_ASSERT("c != NULL", c != NULL);
-    ESP_ASSERT("buf != NULL && buf->topic != NULL", buf != NULL && buf->topic != NULL);
+    ESP_ASSERT("topic != NULL", topic != NULL);
 
     msg = &c->msg;                              /* Get message handle */
-    topic = (void *)buf->topic;                 /* Get topic data */
 
     ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Parsing received topic: %s\r\n", topic);
 
-    /* Topic starts with API version */
-    if (strncmp(topic, ESP_CAYENNE_API_VERSION, ESP_CAYENNE_API_VERSION_LEN)) {
-        return espERR;
-    }
-    topic += ESP_CAYENNE_API_VERSION_LEN;
-    CHECK_FORWARDSLASH_AND_FORWARD(topic);
-
-    /* Check username */
-    len = strlen(c->info_c->user);
-    if (strncmp(topic, c->info_c->user, len)) {
-        return espERR;
-    }
-    topic += len;
-
-    /* Check for /things/ */
-    len = sizeof("/things/") - 1;
-    if (strncmp(topic, "/things/", len)) {
+    /* Topic starts with API version, username and client ID, compare with cached prefix */
+    if (topic_len < c->topic_prefix_len
+        || strncmp(topic, c->topic_prefix, c->topic_prefix_len)) {
         return espERR;
     }
-    topic += len;
-
-    /* Check client ID */
-    len = strlen(c->info_c->id);
-    if (strncmp(topic, c->info_c->id, len)) {
-        return espERR;
-    }
-    topic += len;
-    CHECK_FORWARDSLASH_AND_FORWARD(topic);
+    topic += c->topic_prefix_len;
 
     /* Now parse topic string */
     msg->topic = ESP_CAYENNE_TOPIC_END;
     for (i = 0; i < ESP_ARRAYSIZE(topic_cmd_str_pairs); ++i) {
-        len = strlen(topic_cmd_str_pairs[i].str);
+        len = topic_cmd_str_pairs[i].len;
         if (!strncmp(topic_cmd_str_pairs[i].str, topic, len)) {
             msg->topic = topic_cmd_str_pairs[i].topic;
             topic += len;
@@ -185,20 +189,20 @@ parse_topic(esp_cayenne_t* c, esp_mqtt_client_api_buf_p buf) {
 
 /**
  * \brief           Parse received data from MQTT channel
+ * \note            Payload is modified during parsing and message values point to it
  * \param[in]       c: Cayenne handle
- * \param[in]       buf: MQTT buffer with received data
+ * \param[in]       payload: `NULL` terminated received payload
+ * \param[in]       payload_len: Length of payload
  * \return          \ref espOK on success, member of \ref espr_t otherwise
  */
 static espr_t
-parse_payload(esp_cayenne_t* c, esp_mqtt_client_api_buf_p buf) {
+parse_payload(esp_cayenne_t* c, char* payload, size_t payload_len) {
     esp_cayenne_msg_t* msg;
-    char* payload;
 
     ESP_ASSERT("c != NULL", c != NULL);
-    ESP_ASSERT("buf != NULL", buf != NULL);
+    ESP_ASSERT("payload != NULL", payload != NULL);
 
     msg = &c->msg;                              /* Get message handle */
-    payload = (void *)buf->payload;             /* Get payload data */
 
     ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Parsing received payload\r\n");
 
@@ -207,15 +211,15 @@ parse_payload(esp_cayenne_t* c, esp_mqtt_client_api_buf_p buf) {
     /* Parse topic format here */
     switch (msg->topic) {
         case ESP_CAYENNE_TOPIC_DATA: {
-            ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] TOPIC DATA: %*s\r\n", (int)buf->payload_len, (const char *)buf->payload);
+            ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] TOPIC DATA: %.*s\r\n", (int)payload_len, payload);
             /* Parse data with '=' separator */
             break;
         }
         case ESP_CAYENNE_TOPIC_COMMAND:
         case ESP_CAYENNE_TOPIC_ANALOG_COMMAND:
         case ESP_CAYENNE_TOPIC_DIGITAL_COMMAND: {
-            /* Parsing "sequence,value" */
-            char* comm = strchr(payload, ',');
+            /* Parsing "sequence,value", payload may contain `NULL` characters */
+            char* comm = memchr(payload, ',', payload_len);
             if (comm != NULL) {
                 *comm = 0;
                 msg->seq = payload;
@@ -229,7 +233,7 @@ parse_payload(esp_cayenne_t* c, esp_mqtt_client_api_buf_p buf) {
             break;
         }
         case ESP_CAYENNE_TOPIC_ANALOG: {
-            ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] TOPIC ANALOG: %*s\r\n", (int)buf->payload_len, (const char *)buf->payload);
+            ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] TOPIC ANALOG: %.*s\r\n", (int)payload_len, payload);
             /* Here parse type,value */
         }
         default:
@@ -239,69 +243,374 @@ parse_payload(esp_cayenne_t* c, esp_mqtt_client_api_buf_p buf) {
     return espOK;
 }
 
+/**
+ * \brief           Append string to output buffer and keep it `NULL` terminated
+ * \param[out]      out: Output buffer
+ * \param[in,out]   pos: Current string length in output buffer
+ * \param[in]       size: Size of output buffer including `NULL` termination
+ * \param[in]       str: String to append
+ * \param[in]       len: Length of string to append
+ * \return          `1` on success, `0` if there is not enough memory
+ */
+static uint8_t
+str_append(char* out, size_t* pos, size_t size, const char* str, size_t len) {
+    if (*pos + len >= size) {
+        return 0;
+    }
+    memcpy(&out[*pos], str, len);
+    *pos += len;
+    out[*pos] = 0;
+    return 1;
+}
+
+/**
+ * \brief           Format float number as decimal string
+ * \note            Value is rounded to \ref ESP_CAYENNE_FLOAT_DECIMALS digits
+ *                  and trailing zeros of fractional part are removed
+ * \param[in]       f: Number to format
+ * \param[out]      out: Output buffer, at least `13 + ESP_CAYENNE_FLOAT_DECIMALS` bytes long
+ * \return          Length of string
+ */
+static size_t
+float_to_str(float f, char* out) {
+    uint32_t scale = 1, i_part, f_part;
+    uint8_t neg = 0, dec = ESP_CAYENNE_FLOAT_DECIMALS;
+    size_t len = 0;
+
+    for (uint8_t i = 0; i < ESP_CAYENNE_FLOAT_DECIMALS; ++i) {
+        scale *= 10;
+    }
+    if (f != f) {                               /* NaN cannot be sent */
+        f = 0;
+    } else if (f < 0) {
+        neg = 1;
+        f = -f;
+    }
+    f += 0.5f / (float)scale;                   /* Round to last decimal */
+    if (f >= 4294967040.0f) {                   /* Largest float below 2^32 */
+        i_part = 0xFFFFFFFF;
+        f_part = 0;
+    } else {
+        i_part = (uint32_t)f;
+        f_part = (uint32_t)((f - (float)i_part) * (float)scale);
+        if (f_part >= scale) {
+            f_part = scale - 1;
+        }
+    }
+
+    if (neg && (i_part > 0 || f_part > 0)) {
+        out[len++] = '-';
+    }
+    esp_u32_to_str(i_part, &out[len]);
+    len += strlen(&out[len]);
+
+    /* Remove trailing zeros */
+    while (dec > 0 && (f_part % 10) == 0) {
+        f_part /= 10;
+        --dec;
+    }
+    if (dec > 0) {
+        out[len++] = '.';
+        len += dec;
+        for (uint8_t i = 1; i <= dec; ++i) {
+            out[len - i] = '0' + (char)(f_part % 10);
+            f_part /= 10;
+        }
+    }
+    out[len] = 0;
+    return len;
+}
+
 /**
  * \brief           Build topic string based on input parameters
+ * \param[in]       c: Cayenne handle with cached topic prefix
  * \param[in]       topic_str: Output variable for created topic
  * \param[in]       topic_str_len: Length of topic_str param including NULL termination
- * \param[in]       username: MQTT username
- * \param[in]       client_id: MQTT client id
  * \param[in]       topic: Cayenne topic
  * \param[in]       channel: Cayenne channel
  * \return          \ref espOK on success, member of \ref espr_t otherwise
  */
 static espr_t
-build_topic(char* topic_str, size_t topic_str_len, const char* username,
-            const char* client_id, esp_cayenne_topic_t topic, uint16_t channel) {
-    size_t rem_len;
-    char ch_token[6];
+build_topic(esp_cayenne_t* c, char* topic_str, size_t topic_str_len, esp_cayenne_topic_t topic, uint16_t channel) {
+    const topic_cmd_str_pair_t* pair = NULL;
+    size_t len = 0;
+    char ch_token[7];
 
+    ESP_ASSERT("c != NULL", c != NULL);
     ESP_ASSERT("topic_str != NULL", topic_str != NULL);
-    ESP_ASSERT("username != NULL", username != NULL);
-    ESP_ASSERT("client_id != NULL", client_id != NULL);
     ESP_ASSERT("topic < ESP_CAYENNE_TOPIC_END", topic < ESP_CAYENNE_TOPIC_END);
 
-    /* Assert for basic part without topic */
-    ESP_ASSERT("topic_str_len > string_length", topic_str_len > (strlen(ESP_CAYENNE_API_VERSION) + strlen(username) + strlen(client_id) + 11));
-
-    topic_str[0] = 0;
-
-    /* Base part */
-    strcat(topic_str, ESP_CAYENNE_API_VERSION);
-    strcat(topic_str, "/");
-    strcat(topic_str, username);
-    strcat(topic_str, "/things/");
-    strcat(topic_str, client_id);
-    strcat(topic_str, "/");
-    rem_len = topic_str_len - strlen(topic_str) - 1;
-
     /* Topic string */
     for (size_t i = 0; i < ESP_ARRAYSIZE(topic_cmd_str_pairs); ++i) {
         if (topic == topic_cmd_str_pairs[i].topic) {
-            ESP_ASSERT("strlen(topic_cmd_str_pairs[i].str) <= rem_len", strlen(topic_cmd_str_pairs[i].str) <= rem_len);
-            strcat(topic_str, topic_cmd_str_pairs[i].str);
+            pair = &topic_cmd_str_pairs[i];
             break;
         }
     }
-    rem_len = topic_str_len - strlen(topic_str) - 1;
+    if (pair == NULL
+        || !str_append(topic_str, &len, topic_str_len, c->topic_prefix, c->topic_prefix_len)
+        || !str_append(topic_str, &len, topic_str_len, pair->str, pair->len)) {
+        return espERRMEM;
+    }
 
     /* Channel */
     if (channel != ESP_CAYENNE_NO_CHANNEL) {
         if (channel == ESP_CAYENNE_ALL_CHANNELS) {
-            ESP_ASSERT("rem_len >= 2", rem_len >= 2);
-            strcat(topic_str, "/+");
+            strcpy(ch_token, "/+");
         } else {
-            esp_u16_to_str(channel, ch_token);
-            strcat(topic_str, "/");
-            ESP_ASSERT("strlen(ch_token) <= rem_len", strlen(ch_token) <= rem_len - 1);
-            strcat(topic_str, ch_token);
+            ch_token[0] = '/';
+            esp_u16_to_str(channel, &ch_token[1]);
+        }
+        if (!str_append(topic_str, &len, topic_str_len, ch_token, strlen(ch_token))) {
+            return espERRMEM;
         }
     }
 
-    ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Topic: %s\r\n", topic_name);
+    ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Topic: %s\r\n", topic_str);
 
     return espOK;
 }
 
+/**
+ * \brief           Get full topic string, built only on first use
+ * \note            Protection mutex must be locked when calling this function.
+ *                  Returned string is valid until next call
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: Cayenne topic
+ * \param[in]       channel: Cayenne channel
+ * \return          Topic string on success, `NULL` otherwise
+ */
+static const char*
+get_topic(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel) {
+#if ESP_CAYENNE_TOPIC_CACHE_SIZE > 0
+    esp_cayenne_topic_cache_t* e;
+
+    e = &c->topic_cache[(ESP_SZ(channel) * ESP_CAYENNE_TOPIC_END + ESP_SZ(topic)) % ESP_CAYENNE_TOPIC_CACHE_SIZE];
+    if (e->str != NULL && e->topic == topic && e->channel == channel) {
+        return e->str;
+    }
+
+    /* Entry memory is allocated once and reused for other topics */
+    if (e->str == NULL) {
+        e->str = esp_mem_malloc(TOPIC_CACHE_STR_LEN);
+    }
+    if (e->str != NULL) {
+        if (build_topic(c, e->str, TOPIC_CACHE_STR_LEN, topic, channel) == espOK) {
+            e->topic = topic;
+            e->channel = channel;
+            return e->str;
+        }
+        esp_mem_free_s((void **)&e->str);
+    }
+#endif /* ESP_CAYENNE_TOPIC_CACHE_SIZE > 0 */
+    /* Build topic to shared buffer without caching */
+    if (build_topic(c, topic_name, sizeof(topic_name), topic, channel) != espOK) {
+        return NULL;
+    }
+    return topic_name;
+}
+
+#if ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__
+
+/**
+ * \brief           Pass new value through publish filter of topic and channel
+ * \note            Protection must be locked when calling this function
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: Cayenne topic
+ * \param[in]       channel: Cayenne channel
+ * \param[in,out]   f: New value on input, value to publish on output
+ * \return          `1` if value shall be published, `0` if it is suppressed
+ */
+static uint8_t
+filter_value(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel, float* f) {
+    esp_cayenne_filter_entry_t* e = NULL;
+    uint32_t now;
+    float v, diff;
+
+    for (size_t i = 0; i < ESP_CAYENNE_FILTER_CNT; ++i) {
+        if (c->filters[i].in_use && c->filters[i].topic == topic && c->filters[i].channel == channel) {
+            e = &c->filters[i];
+            break;
+        }
+    }
+    if (e == NULL) {                            /* No filter, publish every value */
+        return 1;
+    }
+
+    /* Aggregate value to current window */
+    now = esp_sys_now();
+    v = *f;
+    if (e->cnt == 0) {
+        e->window_start = now;
+        e->acc = v;
+    } else {
+        switch (e->policy.aggr) {
+            case ESP_CAYENNE_AGGR_MIN:
+                if (v < e->acc) {
+                    e->acc = v;
+                }
+                break;
+            case ESP_CAYENNE_AGGR_MAX:
+                if (v > e->acc) {
+                    e->acc = v;
+                }
+                break;
+            case ESP_CAYENNE_AGGR_AVG:
+                e->acc += v;
+                break;
+            default:
+                e->acc = v;
+                break;
+        }
+    }
+    ++e->cnt;
+    if ((now - e->window_start) < e->policy.window) {
+        return 0;                               /* Window is still open */
+    }
+
+    /* Window is closed, next value starts new one */
+    v = e->policy.aggr == ESP_CAYENNE_AGGR_AVG ? e->acc / (float)e->cnt : e->acc;
+    e->cnt = 0;
+
+    /* Suppress values within deadband, unless maximal interval expired */
+    diff = v > e->last_value ? v - e->last_value : e->last_value - v;
+    if (e->published && diff < e->policy.deadband
+        && (e->policy.max_interval == 0 || (now - e->last_time) < e->policy.max_interval)) {
+        return 0;
+    }
+    e->published = 1;
+    e->last_value = v;
+    e->last_time = now;
+    *f = v;
+    return 1;
+}
+
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__ */
+
+/**
+ * \brief           Publish data with MQTT client used by Cayenne handle
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: Topic to publish to
+ * \param[in]       data: Data to publish
+ * \param[in]       len: Length of data in units of bytes
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+mqtt_publish(esp_cayenne_t* c, const char* topic, const void* data, size_t len) {
+#if ESP_CAYENNE_USE_EVT_CLIENT
+    return esp_mqtt_client_publish(c->mqtt_c, topic, data, (uint16_t)len, ESP_MQTT_QOS_AT_LEAST_ONCE, 1, NULL);
+#else /* ESP_CAYENNE_USE_EVT_CLIENT */
+    return esp_mqtt_client_api_publish(c->api_c, topic, data, len, ESP_MQTT_QOS_AT_LEAST_ONCE, 1);
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT */
+}
+
+/**
+ * \brief           Parse received packet and notify user about new message
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: `NULL` terminated received topic
+ * \param[in]       topic_len: Length of topic
+ * \param[in]       payload: `NULL` terminated received payload
+ * \param[in]       payload_len: Length of payload
+ */
+static void
+process_recv(esp_cayenne_t* c, const char* topic, size_t topic_len, char* payload, size_t payload_len) {
+    ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Packet received\r\nTopic: %s\r\nData: %s\r\n\r\n", topic, payload);
+
+    /* Parse received topic and payload */
+    if (parse_topic(c, topic, topic_len) == espOK && parse_payload(c, payload, payload_len) == espOK) {
+        ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Topic and payload parsed!\r\n");
+        ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Channel: %d, Sequence: %s, Key: %s, Value: %s\r\n",
+            (int)c->msg.channel, c->msg.seq, c->msg.values[0].key, c->msg.values[0].value
+        );
+
+        /* Send notification to user */
+        c->evt.type = ESP_CAYENNE_EVT_DATA;
+        c->evt.evt.data.msg = &c->msg;
+        c->evt_fn(c, &c->evt);
+    }
+}
+
+#if ESP_CAYENNE_USE_EVT_CLIENT
+
+static void mqtt_evt_fn(esp_mqtt_client_p client, esp_mqtt_evt_t* evt);
+
+/**
+ * \brief           Reconnect timeout callback
+ * \param[in]       arg: Cayenne handle
+ */
+static void
+mqtt_reconnect_timeout_fn(void* arg) {
+    esp_cayenne_t* c = arg;
+
+    /* Station not connected yet or connection cannot be started, try again later */
+    if (esp_mqtt_client_connect(c->mqtt_c, ESP_CAYENNE_HOST, ESP_CAYENNE_PORT, mqtt_evt_fn, c->info_c) != espOK) {
+        esp_timeout_add(ESP_CAYENNE_RECONNECT_DELAY, mqtt_reconnect_timeout_fn, c);
+    }
+}
+
+/**
+ * \brief           MQTT client event callback
+ * \note            Called from processing thread with core locked
+ * \param[in]       client: MQTT client
+ * \param[in]       evt: MQTT event with type and related data
+ */
+static void
+mqtt_evt_fn(esp_mqtt_client_p client, esp_mqtt_evt_t* evt) {
+    esp_cayenne_t* c = esp_mqtt_client_get_arg(client);
+
+    switch (evt->type) {
+        case ESP_MQTT_EVT_CONNECT: {
+            if (evt->evt.connect.status == ESP_MQTT_CONN_STATUS_ACCEPTED) {
+                /* Notify user */
+                c->evt.type = ESP_CAYENNE_EVT_CONNECT;
+                c->evt_fn(c, &c->evt);
+
+                /* We are connected and ready to subscribe/publish/receive packets */
+                esp_cayenne_subscribe(c, ESP_CAYENNE_TOPIC_COMMAND, ESP_CAYENNE_ALL_CHANNELS);
+            } else if (evt->evt.connect.status == ESP_MQTT_CONN_STATUS_TCP_FAILED) {
+                /* There is no disconnect event when TCP connection fails */
+                esp_timeout_add(ESP_CAYENNE_RECONNECT_DELAY, mqtt_reconnect_timeout_fn, c);
+            }
+            break;
+        }
+        case ESP_MQTT_EVT_PUBLISH_RECV: {
+            size_t topic_len = evt->evt.publish_recv.topic_len;
+            size_t payload_len = evt->evt.publish_recv.payload_len;
+
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+            /* Commands are short, packets received in multiple chunks are ignored */
+            if (payload_len != evt->evt.publish_recv.payload_total_len) {
+                break;
+            }
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+            if (topic_len + payload_len + 2 > sizeof(recv_data)) {
+                ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE_WARNING, "[CAYENNE] Received packet too long\r\n");
+                break;
+            }
+
+            /* Parser requires NULL terminated strings and modifies payload */
+            ESP_MEMCPY(recv_data, evt->evt.publish_recv.topic, topic_len);
+            recv_data[topic_len] = 0;
+            ESP_MEMCPY(&recv_data[topic_len + 1], evt->evt.publish_recv.payload, payload_len);
+            recv_data[topic_len + 1 + payload_len] = 0;
+            process_recv(c, recv_data, topic_len, &recv_data[topic_len + 1], payload_len);
+            break;
+        }
+        case ESP_MQTT_EVT_DISCONNECT: {
+            if (evt->evt.disconnect.is_accepted) {
+                c->evt.type = ESP_CAYENNE_EVT_DISCONNECT;
+                c->evt_fn(c, &c->evt);
+            }
+            esp_timeout_add(ESP_CAYENNE_RECONNECT_DELAY, mqtt_reconnect_timeout_fn, c);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+#else /* ESP_CAYENNE_USE_EVT_CLIENT */
+
 /**
  * \brief           Cayenne thread
  * \param[in]       arg: Thread argument. Pointer to \ref esp_mqtt_client_cayenne_t structure
@@ -353,21 +662,7 @@ mqtt_thread(void * const arg) {
 
                 if (res == espOK) {
                     if (buf != NULL) {
-                        ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Packet received\r\nTopic: %s\r\nData: %s\r\n\r\n", buf->topic, buf->payload);
-
-                        /* Parse received topic and payload */
-                        if (parse_topic(c, buf) == espOK && parse_payload(c, buf) == espOK) {
-                            ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Topic and payload parsed!\r\n");
-                            ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE, "[CAYENNE] Channel: %d, Sequence: %s, Key: %s, Value: %s\r\n",
-                                (int)c->msg.channel, c->msg.seq, c->msg.values[0].key, c->msg.values[0].value
-                            );
-
-                            /* Send notification to user */
-                            c->evt.type = ESP_CAYENNE_EVT_DATA;
-                            c->evt.evt.data.msg = &c->msg;
-                            c->evt_fn(c, &c->evt);
-                        }
-
+                        process_recv(c, buf->topic, buf->topic_len, (void *)buf->payload, buf->payload_len);
                         esp_mqtt_client_api_buf_free(buf);
                         buf = NULL;
                     }
@@ -390,10 +685,14 @@ mqtt_thread(void * const arg) {
     esp_sys_thread_terminate(NULL);             /* Terminate thread */
 }
 
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT */
+
 /**
  * \brief           Create new instance of cayenne MQTT connection
  * \note            Each call to this functions starts new thread for async receive processing.
- *                  Function will block until thread is created and successfully started
+ *                  Function will block until thread is created and successfully started.
+ *                  When \ref ESP_CAYENNE_USE_EVT_CLIENT is enabled, no thread is created
+ *                  and function returns once connection is scheduled
  * \param[in]       c: Cayenne empty handle
  * \param[in]       client_info: MQTT client info with username, password and id
  * \param[in]       evt_fn: Event function
@@ -405,7 +704,40 @@ esp_cayenne_create(esp_cayenne_t* c, const esp_mqtt_client_info_t* client_info,
     ESP_ASSERT("client_info != NULL", client_info != NULL);
     ESP_ASSERT("evt_fn != NULL", evt_fn != NULL);
 
-    c->api_c = esp_mqtt_client_api_new(256, 256);
+    /* Build topic prefix only once, it is common to all topics */
+    c->topic_prefix_len = 0;
+    if (client_info->user == NULL || client_info->id == NULL
+        || !str_append(c->topic_prefix, &c->topic_prefix_len, sizeof(c->topic_prefix), ESP_CAYENNE_API_VERSION "/", ESP_CAYENNE_API_VERSION_LEN + 1)
+        || !str_append(c->topic_prefix, &c->topic_prefix_len, sizeof(c->topic_prefix), client_info->user, strlen(client_info->user))
+        || !str_append(c->topic_prefix, &c->topic_prefix_len, sizeof(c->topic_prefix), "/things/", sizeof("/things/") - 1)
+        || !str_append(c->topic_prefix, &c->topic_prefix_len, sizeof(c->topic_prefix), client_info->id, strlen(client_info->id))
+        || !str_append(c->topic_prefix, &c->topic_prefix_len, sizeof(c->topic_prefix), "/", 1)) {
+        ESP_DEBUGF(ESP_CFG_DBG_CAYENNE_TRACE_SEVERE, "[CAYENNE] Topic prefix too long\r\n");
+        return espPARERR;
+    }
+
+#if ESP_CAYENNE_TOPIC_CACHE_SIZE > 0
+    memset(c->topic_cache, 0x00, sizeof(c->topic_cache));
+#endif /* ESP_CAYENNE_TOPIC_CACHE_SIZE > 0 */
+#if ESP_CAYENNE_FILTER_CNT > 0
+    memset(c->filters, 0x00, sizeof(c->filters));
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 */
+
+#if ESP_CAYENNE_USE_EVT_CLIENT
+    c->mqtt_c = esp_mqtt_client_new(ESP_CAYENNE_TX_BUFF_LEN, ESP_CAYENNE_RX_BUFF_LEN);
+    c->info_c = client_info;
+    c->evt_fn = evt_fn;
+    if (c->mqtt_c == NULL) {
+        return espERRMEM;
+    }
+    esp_mqtt_client_set_arg(c->mqtt_c, c);
+
+    /* Start connection, retry is scheduled on failure */
+    esp_core_lock();
+    mqtt_reconnect_timeout_fn(c);
+    esp_core_unlock();
+#else /* ESP_CAYENNE_USE_EVT_CLIENT */
+    c->api_c = esp_mqtt_client_api_new(ESP_CAYENNE_TX_BUFF_LEN, ESP_CAYENNE_RX_BUFF_LEN);
     c->info_c = client_info;
     c->evt_fn = evt_fn;
     if (c->api_c == NULL) {
@@ -431,6 +763,7 @@ esp_cayenne_create(esp_cayenne_t* c, const esp_mqtt_client_info_t* client_info,
     }
     esp_sys_sem_wait(&c->sem, 0);
     esp_sys_sem_release(&c->sem);
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT */
 
     return espOK;
 }
@@ -447,19 +780,27 @@ esp_cayenne_create(esp_cayenne_t* c, const esp_mqtt_client_info_t* client_info,
 espr_t
 esp_cayenne_subscribe(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel) {
     espr_t res;
+    const char* topic_str;
 
     ESP_ASSERT("c != NULL", c != NULL);
 
-    esp_sys_mutex_lock(&prot_mutex);
-    build_topic(topic_name, sizeof(topic_name), c->info_c->user, c->info_c->id, topic, channel);
-    res = esp_mqtt_client_api_subscribe(c->api_c, topic_name, ESP_MQTT_QOS_EXACTLY_ONCE);
+    CAYENNE_PROTECT();
+    if ((topic_str = get_topic(c, topic, channel)) == NULL) {
+        CAYENNE_UNPROTECT();
+        return espERRMEM;
+    }
+#if ESP_CAYENNE_USE_EVT_CLIENT
+    res = esp_mqtt_client_subscribe(c->mqtt_c, topic_str, ESP_MQTT_QOS_EXACTLY_ONCE, NULL);
+#else /* ESP_CAYENNE_USE_EVT_CLIENT */
+    res = esp_mqtt_client_api_subscribe(c->api_c, topic_str, ESP_MQTT_QOS_EXACTLY_ONCE);
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT */
 
     ESP_DEBUGW(ESP_CFG_DBG_CAYENNE_TRACE, res == espOK,
-        "[CAYENNE] Subscribed to topic %s\r\n", topic_name);
+        "[CAYENNE] Subscribed to topic %s\r\n", topic_str);
     ESP_DEBUGW(ESP_CFG_DBG_CAYENNE_TRACE, res != espOK,
-        "[CAYENNE] Cannot subscribe to topic %s, error code: %d\r\n", topic_name, (int)res);
+        "[CAYENNE] Cannot subscribe to topic %s, error code: %d\r\n", topic_str, (int)res);
 
-    esp_sys_mutex_unlock(&prot_mutex);
+    CAYENNE_UNPROTECT();
 
     return res;
 }
@@ -476,30 +817,54 @@ esp_cayenne_subscribe(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t chan
 espr_t
 esp_cayenne_unsubscribe(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel) {
     espr_t res;
+    const char* topic_str;
 
     ESP_ASSERT("c != NULL", c != NULL);
 
-    esp_sys_mutex_lock(&prot_mutex);
-    build_topic(topic_name, sizeof(topic_name), c->info_c->user, c->info_c->id, topic, channel);
-    res = esp_mqtt_client_api_unsubscribe(c->api_c, topic_name);
+    CAYENNE_PROTECT();
+    if ((topic_str = get_topic(c, topic, channel)) == NULL) {
+        CAYENNE_UNPROTECT();
+        return espERRMEM;
+    }
+#if ESP_CAYENNE_USE_EVT_CLIENT
+    res = esp_mqtt_client_unsubscribe(c->mqtt_c, topic_str, NULL);
+#else /* ESP_CAYENNE_USE_EVT_CLIENT */
+    res = esp_mqtt_client_api_unsubscribe(c->api_c, topic_str);
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT */
 
     ESP_DEBUGW(ESP_CFG_DBG_CAYENNE_TRACE, res == espOK,
-        "[CAYENNE] Unsubscribed from topic %s\r\n", topic_name);
+        "[CAYENNE] Unsubscribed from topic %s\r\n", topic_str);
     ESP_DEBUGW(ESP_CFG_DBG_CAYENNE_TRACE, res != espOK,
-        "[CAYENNE] Cannot unsubscribe from topic %s, error code: %d\r\n", topic_name, (int)res);
+        "[CAYENNE] Cannot unsubscribe from topic %s, error code: %d\r\n", topic_str, (int)res);
 
-    esp_sys_mutex_unlock(&prot_mutex);
+    CAYENNE_UNPROTECT();
 
     return res;
 }
 
+/**
+ * \brief           Publish data to cayenne topic and channel
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: Cayenne topic
+ * \param[in]       channel: Optional channel number.
+ *                      Use \ref ESP_CAYENNE_NO_CHANNEL when channel is not needed
+ * \param[in]       type: Optional data type, set to `NULL` if not used
+ * \param[in]       unit: Optional data unit, set to `NULL` if not used
+ * \param[in]       data: Data value as string
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
 espr_t
 esp_cayenne_publish_data(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel,
                         const char* type, const char* unit, const char* data) {
     espr_t res = espOK;
+    const char* topic_str;
+
+    ESP_ASSERT("c != NULL", c != NULL);
+    ESP_ASSERT("data != NULL", data != NULL);
 
-    esp_sys_mutex_lock(&prot_mutex);
-    if ((res = build_topic(topic_name, sizeof(topic_name), c->info_c->user, c->info_c->id, topic, channel)) != espOK) {
+    CAYENNE_PROTECT();
+    if ((topic_str = get_topic(c, topic, channel)) == NULL) {
+        res = espERRMEM;
         goto exit;
     }
     payload_data[0] = 0;
@@ -517,9 +882,179 @@ esp_cayenne_publish_data(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t c
     }
     strcat(payload_data, data);
 
-    res = esp_mqtt_client_api_publish(c->api_c, topic_name, payload_data, strlen(payload_data), ESP_MQTT_QOS_AT_LEAST_ONCE, 1);
+    res = mqtt_publish(c, topic_str, payload_data, strlen(payload_data));
+exit:
+    CAYENNE_UNPROTECT();
+    return res;
+}
+
+/**
+ * \brief           Publish float value to cayenne topic and channel
+ * \note            When filter is set for topic and channel with \ref esp_cayenne_set_filter,
+ *                  value is aggregated and published only when filter policy allows it.
+ *                  Function returns \ref espOK for suppressed values
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: Cayenne topic
+ * \param[in]       channel: Optional channel number.
+ *                      Use \ref ESP_CAYENNE_NO_CHANNEL when channel is not needed
+ * \param[in]       type: Optional data type, set to `NULL` if not used
+ * \param[in]       unit: Optional data unit, set to `NULL` if not used
+ * \param[in]       f: Value to publish
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_cayenne_publish_float(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel,
+                        const char* type, const char* unit, float f) {
+    char str[16 + ESP_CAYENNE_FLOAT_DECIMALS];
+#if ESP_CAYENNE_FILTER_CNT > 0
+    uint8_t publish;
+
+    CAYENNE_PROTECT();
+    publish = filter_value(c, topic, channel, &f);
+    CAYENNE_UNPROTECT();
+    if (!publish) {
+        return espOK;
+    }
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 */
+
+    float_to_str(f, str);
+    return esp_cayenne_publish_data(c, topic, channel, type, unit, str);
+}
+
+#if ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__
+
+/**
+ * \brief           Set publish filter policy for topic and channel
+ *
+ * Values published with \ref esp_cayenne_publish_float are aggregated over window
+ * and at most one value per window is sent to server.
+ * Value is further suppressed when it is within deadband of last published value
+ *
+ * \param[in]       c: Cayenne handle
+ * \param[in]       topic: Cayenne topic
+ * \param[in]       channel: Optional channel number.
+ *                      Use \ref ESP_CAYENNE_NO_CHANNEL when channel is not needed
+ * \param[in]       policy: Filter policy. Set to `NULL` to remove filter and publish every value
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_cayenne_set_filter(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel, const esp_cayenne_filter_t* policy) {
+    esp_cayenne_filter_entry_t* e = NULL, *free_e = NULL;
+    espr_t res = espOK;
+
+    ESP_ASSERT("c != NULL", c != NULL);
+    ESP_ASSERT("topic < ESP_CAYENNE_TOPIC_END", topic < ESP_CAYENNE_TOPIC_END);
+
+    CAYENNE_PROTECT();
+    for (size_t i = 0; i < ESP_CAYENNE_FILTER_CNT; ++i) {
+        if (c->filters[i].in_use) {
+            if (c->filters[i].topic == topic && c->filters[i].channel == channel) {
+                e = &c->filters[i];
+                break;
+            }
+        } else if (free_e == NULL) {
+            free_e = &c->filters[i];
+        }
+    }
+    if (policy == NULL) {
+        if (e != NULL) {
+            e->in_use = 0;
+        }
+    } else {
+        if (e == NULL) {
+            e = free_e;
+        }
+        if (e != NULL) {
+            memset(e, 0x00, sizeof(*e));        /* Start with empty window */
+            e->in_use = 1;
+            e->topic = topic;
+            e->channel = channel;
+            e->policy = *policy;
+        } else {
+            res = espERRMEM;
+        }
+    }
+    CAYENNE_UNPROTECT();
+    return res;
+}
+
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__ */
+
+/**
+ * \brief           Publish values of multiple channels with minimal number of packets
+ *
+ * Values are sent as JSON array to `data/json` topic.
+ * Multiple values are packed to single packet of maximal \ref ESP_CAYENNE_BATCH_PAYLOAD_LEN bytes,
+ * so that only few packets are sent instead of one packet per channel
+ *
+ * \param[in]       c: Cayenne handle
+ * \param[in]       data: Array of channel values
+ * \param[in]       count: Number of entries in `data` array
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_cayenne_publish_data_batch(esp_cayenne_t* c, const esp_cayenne_data_t* data, size_t count) {
+    static char batch_data[ESP_CAYENNE_BATCH_PAYLOAD_LEN];
+    char num[16 + ESP_CAYENNE_FLOAT_DECIMALS];
+    size_t topic_len, pos = 0, entry_pos;
+    espr_t res = espOK;
+
+    ESP_ASSERT("c != NULL", c != NULL);
+    ESP_ASSERT("data != NULL", data != NULL);
+    ESP_ASSERT("count > 0", count > 0);
+
+    CAYENNE_PROTECT();
+    if ((res = build_topic(c, topic_name, sizeof(topic_name), ESP_CAYENNE_TOPIC_DATA, ESP_CAYENNE_NO_CHANNEL)) != espOK) {
+        goto exit;
+    }
+    topic_len = strlen(topic_name);
+    if (!str_append(topic_name, &topic_len, sizeof(topic_name), "/json", 5)) {
+        res = espERRMEM;
+        goto exit;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t ok;
+
+        /* Entry is written after last one, ']' must still fit after it */
+        entry_pos = pos;
+        ok = str_append(batch_data, &pos, sizeof(batch_data) - 1, pos == 0 ? "[{\"channel\":" : ",{\"channel\":", 12);
+        esp_u16_to_str(data[i].channel, num);
+        ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, num, strlen(num));
+        ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, ",\"value\":", 9);
+        ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, num, float_to_str(data[i].value, num));
+        if (data[i].type != NULL) {
+            ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, ",\"type\":\"", 9);
+            ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, data[i].type, strlen(data[i].type));
+            ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, "\"", 1);
+        }
+        if (data[i].unit != NULL) {
+            ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, ",\"unit\":\"", 9);
+            ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, data[i].unit, strlen(data[i].unit));
+            ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, "\"", 1);
+        }
+        ok = ok && str_append(batch_data, &pos, sizeof(batch_data) - 1, "}", 1);
+
+        if (!ok) {
+            if (entry_pos == 0) {               /* Single entry does not fit to packet */
+                res = espERRMEM;
+                goto exit;
+            }
+            /* Send packet with previous entries and start new one with this entry */
+            pos = entry_pos;
+            str_append(batch_data, &pos, sizeof(batch_data), "]", 1);
+            if ((res = mqtt_publish(c, topic_name, batch_data, pos)) != espOK) {
+                goto exit;
+            }
+            pos = 0;
+            --i;
+            continue;
+        }
+    }
+    str_append(batch_data, &pos, sizeof(batch_data), "]", 1);
+    res = mqtt_publish(c, topic_name, batch_data, pos);
 exit:
-    esp_sys_mutex_unlock(&prot_mutex);
+    CAYENNE_UNPROTECT();
     return res;
 }
 
@@ -535,12 +1070,14 @@ espr_t
 esp_cayenne_publish_response(esp_cayenne_t* c, esp_cayenne_msg_t* msg, esp_cayenne_resp_t resp, const char* message) {
     espr_t res = espOK;
     size_t len, msg_len;
+    const char* topic_str;
 
     ESP_ASSERT("c != NULL", c != NULL);
     ESP_ASSERT("msg != NULL && msg->seq != NULL", msg != NULL && msg->seq != NULL);
 
-    esp_sys_mutex_lock(&prot_mutex);
-    if ((res = build_topic(topic_name, sizeof(topic_name), c->info_c->user, c->info_c->id, ESP_CAYENNE_TOPIC_RESPONSE, ESP_CAYENNE_NO_CHANNEL)) != espOK) {
+    CAYENNE_PROTECT();
+    if ((topic_str = get_topic(c, ESP_CAYENNE_TOPIC_RESPONSE, ESP_CAYENNE_NO_CHANNEL)) == NULL) {
+        res = espERRMEM;
         goto exit;
     }
     payload_data[0] = 0;
@@ -556,8 +1093,8 @@ esp_cayenne_publish_response(esp_cayenne_t* c, esp_cayenne_msg_t* msg, esp_cayen
         strncpy(&payload_data[len], message, msg_len);
         payload_data[len + msg_len] = 0;
     }
-    res = esp_mqtt_client_api_publish(c->api_c, topic_name, payload_data, strlen(payload_data), ESP_MQTT_QOS_AT_LEAST_ONCE, 1);
+    res = mqtt_publish(c, topic_str, payload_data, strlen(payload_data));
 exit:
-    esp_sys_mutex_unlock(&prot_mutex);
+    CAYENNE_UNPROTECT();
     return res;
 }
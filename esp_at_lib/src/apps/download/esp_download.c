@@ -0,0 +1,205 @@
+/**
+ * \file            esp_download.c
+ * \brief           Streaming download from connection to storage on top of netconn API
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/apps/esp_download.h"
+#include "esp/esp_mem.h"
+
+#if ESP_CFG_NETCONN || __DOXYGEN__
+
+/**
+ * \brief           Download block
+ */
+typedef struct {
+    uint8_t* data;                              /*!< Block memory */
+    size_t len;                                 /*!< Number of valid bytes in block */
+    uint8_t is_last;                            /*!< Set to `1` on last block of download */
+} download_block_t;
+
+/**
+ * \brief           Download pipeline shared between receiving and writing thread
+ */
+typedef struct {
+    esp_sys_mbox_t mbox_free;                   /*!< Blocks ready to be filled from network */
+    esp_sys_mbox_t mbox_full;                   /*!< Blocks ready to be passed to writer */
+    esp_sys_sem_t sem_done;                     /*!< Released by writer after last block */
+    esp_download_write_fn write_fn;             /*!< Writer callback */
+    void* arg;                                  /*!< Writer callback argument */
+    espr_t res;                                 /*!< First error returned by writer */
+    size_t total;                               /*!< Number of bytes accepted by writer */
+    download_block_t blocks[ESP_CFG_DOWNLOAD_BLOCK_CNT];/*!< List of blocks */
+} download_t;
+
+/**
+ * \brief           Writer thread, passes full blocks to writer callback
+ * \param[in]       arg: Pointer to \ref download_t structure
+ */
+static void
+download_writer_thread(void* const arg) {
+    download_t* dl = arg;
+    download_block_t* blk;
+    uint8_t is_last;
+
+    do {
+        esp_sys_mbox_get(&dl->mbox_full, (void **)&blk, 0);
+        if (dl->res == espOK && blk->len > 0) { /* Blocks are only recycled after writer error */
+            dl->res = dl->write_fn(dl->arg, blk->data, blk->len);
+            if (dl->res == espOK) {
+                dl->total += blk->len;
+            }
+        }
+        is_last = blk->is_last;
+        esp_sys_mbox_put(&dl->mbox_free, blk);
+    } while (!is_last);
+    esp_sys_sem_release(&dl->sem_done);
+    esp_sys_thread_terminate(NULL);             /* Terminate thread */
+}
+
+/**
+ * \brief           Download data from connection and pass them to writer
+ *
+ * Function blocks until connection is closed by remote side, receive fails or writer returns error.
+ * Received data are written by separate thread in blocks of `block_len` bytes,
+ * while caller thread continues to receive next block from connection.
+ *
+ * \note            Connection is not closed by this function
+ *
+ * \param[in]       nc: Connected netconn handle
+ * \param[in]       block_len: Size of one block in units of bytes.
+ *                      Set to `0` to use \ref ESP_CFG_DOWNLOAD_BLOCK_LEN
+ * \param[in]       write_fn: Writer callback, called from download thread
+ * \param[in]       arg: Custom argument for writer callback
+ * \param[out]      total: Pointer to output variable for number of bytes accepted by writer.
+ *                      Set to `NULL` when not used
+ * \return          \ref espOK when connection has been closed by remote side after all data were written,
+ *                      error returned by writer or by \ref esp_netconn_receive otherwise
+ */
+espr_t
+esp_download_netconn(esp_netconn_p nc, size_t block_len, esp_download_write_fn write_fn, void* arg, size_t* total) {
+    download_t* dl;
+    download_block_t* blk;
+    esp_pbuf_p pbuf = NULL;
+    size_t pbuf_off = 0;
+    uint8_t is_last;
+    espr_t res;
+
+    ESP_ASSERT("nc != NULL", nc != NULL);
+    ESP_ASSERT("write_fn != NULL", write_fn != NULL);
+
+    if (total != NULL) {
+        *total = 0;
+    }
+    if (block_len == 0) {
+        block_len = ESP_CFG_DOWNLOAD_BLOCK_LEN;
+    }
+
+    /* Pipeline structure and all blocks in single allocation */
+    if ((dl = esp_mem_calloc(1, sizeof(*dl) + ESP_CFG_DOWNLOAD_BLOCK_CNT * block_len)) == NULL) {
+        return espERRMEM;
+    }
+    dl->write_fn = write_fn;
+    dl->arg = arg;
+    res = espERRMEM;
+    if (!esp_sys_mbox_create(&dl->mbox_free, ESP_CFG_DOWNLOAD_BLOCK_CNT)) {
+        goto err_mbox_free;
+    }
+    if (!esp_sys_mbox_create(&dl->mbox_full, ESP_CFG_DOWNLOAD_BLOCK_CNT)) {
+        goto err_mbox_full;
+    }
+    if (!esp_sys_sem_create(&dl->sem_done, 0)) {/* Released by writer at the end */
+        goto err_sem;
+    }
+    for (size_t i = 0; i < ESP_CFG_DOWNLOAD_BLOCK_CNT; ++i) {
+        dl->blocks[i].data = (uint8_t *)(dl + 1) + i * block_len;
+        esp_sys_mbox_put(&dl->mbox_free, &dl->blocks[i]);
+    }
+    if (!esp_sys_thread_create(NULL, "esp_download", download_writer_thread, dl, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+        goto cleanup;
+    }
+
+    /* Fill free blocks from connection until it is closed */
+    res = espOK;
+    do {
+        esp_sys_mbox_get(&dl->mbox_free, (void **)&blk, 0);
+        blk->len = 0;
+        while (dl->res == espOK && blk->len < block_len) {
+            size_t pbuf_len, copied;
+
+            /* Next data are requested from connection only when there is room for them */
+            if (pbuf == NULL) {
+                if ((res = esp_netconn_receive(nc, &pbuf)) != espOK) {
+                    break;
+                }
+                pbuf_off = 0;
+            }
+            pbuf_len = esp_pbuf_length(pbuf, 1);
+            copied = esp_pbuf_copy(pbuf, blk->data + blk->len, block_len - blk->len, pbuf_off);
+            pbuf_off += copied;
+            blk->len += copied;
+            if (pbuf_off >= pbuf_len) {
+                esp_pbuf_free(pbuf);
+                pbuf = NULL;
+            }
+        }
+        is_last = res != espOK || dl->res != espOK;
+        blk->is_last = is_last;
+        esp_sys_mbox_put(&dl->mbox_full, blk);
+    } while (!is_last);
+    if (pbuf != NULL) {
+        esp_pbuf_free(pbuf);
+    }
+
+    /* Wait writer to process last block */
+    esp_sys_sem_wait(&dl->sem_done, 0);
+    if (dl->res != espOK) {
+        res = dl->res;
+    } else if (res == espCLOSED) {
+        res = espOK;                            /* Closed by remote side, download completed */
+    }
+    if (total != NULL) {
+        *total = dl->total;
+    }
+
+    /* Release resources in reverse order of creation */
+cleanup:
+    while (esp_sys_mbox_getnow(&dl->mbox_free, (void **)&blk)) {}   /* All blocks are back in free queue */
+    esp_sys_sem_delete(&dl->sem_done);
+err_sem:
+    esp_sys_mbox_delete(&dl->mbox_full);
+err_mbox_full:
+    esp_sys_mbox_delete(&dl->mbox_free);
+err_mbox_free:
+    esp_mem_free(dl);
+    return res;
+}
+
+#endif /* ESP_CFG_NETCONN || __DOXYGEN__ */
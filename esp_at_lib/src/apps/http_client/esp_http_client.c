@@ -0,0 +1,543 @@
+/**
+ * \file            esp_http_client.c
+ * \brief           HTTP/1.1 client on top of netconn API
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/apps/esp_http_client.h"
+#include "esp/esp_netconn.h"
+#include "esp/esp_mem.h"
+#include <ctype.h>
+#include <stdio.h>
+
+#if (ESP_CFG_NETCONN && !ESP_CFG_HTTP_CLIENT_AT) || __DOXYGEN__
+
+#define ESP_CFG_DBG_HTTP_CLIENT_TRACE           (ESP_CFG_DBG_HTTP_CLIENT | ESP_DBG_TYPE_TRACE)
+#define ESP_CFG_DBG_HTTP_CLIENT_TRACE_WARNING   (ESP_CFG_DBG_HTTP_CLIENT | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING)
+
+#define CRLF                        "\r\n"
+
+/**
+ * \brief           Response parser state
+ */
+typedef enum {
+    HTTP_CLIENT_STATE_STATUS = 0x00,            /*!< Waiting for status line */
+    HTTP_CLIENT_STATE_HEADER,                   /*!< Reading header lines */
+    HTTP_CLIENT_STATE_BODY,                     /*!< Reading body with known length */
+    HTTP_CLIENT_STATE_BODY_CLOSE,               /*!< Reading body until connection is closed */
+    HTTP_CLIENT_STATE_CHUNK_SIZE,               /*!< Reading chunk size line */
+    HTTP_CLIENT_STATE_CHUNK_DATA,               /*!< Reading chunk data */
+    HTTP_CLIENT_STATE_CHUNK_END,                /*!< Reading `CRLF` after chunk data */
+    HTTP_CLIENT_STATE_TRAILER,                  /*!< Reading trailer lines after last chunk */
+    HTTP_CLIENT_STATE_DONE,                     /*!< Response is complete */
+} http_client_state_t;
+
+/**
+ * \brief           HTTP client structure
+ */
+typedef struct esp_http_client {
+    esp_netconn_p nc;                           /*!< Connection kept open for next request */
+    char* host;                                 /*!< Host of kept connection */
+    esp_port_t port;                            /*!< Port of kept connection */
+    uint8_t ssl;                                /*!< Type of kept connection */
+
+    const esp_http_client_req_t* req;           /*!< Request in progress */
+    http_client_state_t state;                  /*!< Response parser state */
+    uint16_t status;                            /*!< Response status code */
+    uint8_t is_chunked;                         /*!< Response uses chunked transfer encoding */
+    uint8_t has_len;                            /*!< Response has `Content-Length` header */
+    uint8_t is_close;                           /*!< Server closes connection after response */
+    size_t rem_len;                             /*!< Remaining length of body or current chunk */
+    size_t line_len;                            /*!< Number of characters received in current line */
+    char line[ESP_CFG_HTTP_CLIENT_LINE_LEN];    /*!< Current status, header or chunk size line */
+} esp_http_client_t;
+
+static const char* const
+http_client_methods[] = {
+    "GET", "HEAD", "POST", "PUT", "DELETE",
+};
+
+/**
+ * \brief           Compare 2 strings in case insensitive way
+ * \param[in]       a: String a to compare
+ * \param[in]       b: String b to compare
+ * \return          `1` if equal, `0` otherwise
+ */
+static uint8_t
+http_client_streq(const char* a, const char* b) {
+    for (; tolower((unsigned char)*a) == tolower((unsigned char)*b); ++a, ++b) {
+        if (!*a) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Close kept connection
+ * \param[in]       client: HTTP client
+ * \param[in]       reuse: Set to `1` to release connection to netconn pool when available
+ */
+static void
+http_client_close(esp_http_client_t* client, uint8_t reuse) {
+    if (client->nc != NULL) {
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0
+        if (reuse) {
+            esp_netconn_release(client->nc);
+        } else
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 */
+        {
+            ESP_UNUSED(reuse);
+            esp_netconn_close(client->nc);
+        }
+        esp_netconn_delete(client->nc);
+        client->nc = NULL;
+    }
+    esp_mem_free_s((void **)&client->host);
+}
+
+/**
+ * \brief           Open connection to request host or keep existing one
+ * \param[in]       client: HTTP client
+ * \param[in]       req: Request with host information
+ * \param[in]       port: Port to connect to
+ * \param[out]      reused: Set to `1` when kept connection is used
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+http_client_connect(esp_http_client_t* client, const esp_http_client_req_t* req, esp_port_t port, uint8_t* reused) {
+    size_t len;
+    espr_t res;
+
+    *reused = 0;
+    if (client->nc != NULL) {
+        if (client->port == port && client->ssl == !!req->ssl
+            && http_client_streq(client->host, req->host) && esp_netconn_getconnnum(client->nc) >= 0) {
+            *reused = 1;
+            return espOK;
+        }
+        http_client_close(client, 1);
+    }
+
+    client->nc = esp_netconn_new(req->ssl ? ESP_NETCONN_TYPE_SSL : ESP_NETCONN_TYPE_TCP);
+    if (client->nc == NULL) {
+        return espERRMEM;
+    }
+#if ESP_CFG_NETCONN_RECEIVE_TIMEOUT
+    esp_netconn_set_receive_timeout(client->nc, ESP_CFG_HTTP_CLIENT_TIMEOUT);
+#endif /* ESP_CFG_NETCONN_RECEIVE_TIMEOUT */
+    res = esp_netconn_connect(client->nc, req->host, port);
+    if (res == espOK) {
+        len = strlen(req->host) + 1;
+        if ((client->host = esp_mem_malloc_tag(len, ESP_MEM_TAG_HTTP)) != NULL) {
+            ESP_MEMCPY(client->host, req->host, len);
+        } else {
+            res = espERRMEM;
+        }
+    }
+    if (res != espOK) {
+        http_client_close(client, 0);
+        return res;
+    }
+    client->port = port;
+    client->ssl = !!req->ssl;
+    ESP_DEBUGF(ESP_CFG_DBG_HTTP_CLIENT_TRACE, "[HTTP CLIENT] Connected to %s:%d\r\n", req->host, (int)port);
+    return espOK;
+}
+
+/**
+ * \brief           Write chunk of request body with chunk size line when needed
+ * \param[in]       nc: Netconn handle
+ * \param[in]       data: Chunk data
+ * \param[in]       len: Length of chunk data in units of bytes
+ * \param[in]       chunked: Set to `1` when chunked transfer encoding is used
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+http_client_write_chunk(esp_netconn_p nc, const void* data, size_t len, uint8_t chunked) {
+    char size[12];
+    espr_t res;
+
+    if (!chunked) {
+        return esp_netconn_write(nc, data, len);
+    }
+    sprintf(size, "%X" CRLF, (unsigned)len);
+    if ((res = esp_netconn_write(nc, size, strlen(size))) == espOK
+        && (res = esp_netconn_write(nc, data, len)) == espOK) {
+        res = esp_netconn_write(nc, CRLF, 2);
+    }
+    return res;
+}
+
+/**
+ * \brief           Write request line, headers and body to connection
+ * \param[in]       client: HTTP client
+ * \param[in]       req: Request to send
+ * \param[in]       port: Server port
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+http_client_send_request(esp_http_client_t* client, const esp_http_client_req_t* req, esp_port_t port) {
+    esp_netconn_p nc = client->nc;
+    uint8_t chunked = 0;
+    char num[16];
+    espr_t res;
+
+#define HTTP_CLIENT_WRITE_STR(str)      do { if ((res = esp_netconn_write(nc, (str), strlen(str))) != espOK) { return res; } } while (0)
+
+    HTTP_CLIENT_WRITE_STR(http_client_methods[req->method]);
+    HTTP_CLIENT_WRITE_STR(" ");
+    HTTP_CLIENT_WRITE_STR(req->path != NULL ? req->path : "/");
+    HTTP_CLIENT_WRITE_STR(" HTTP/1.1" CRLF "Host: ");
+    HTTP_CLIENT_WRITE_STR(req->host);
+    if (port != (req->ssl ? 443 : 80)) {
+        sprintf(num, ":%u", (unsigned)port);
+        HTTP_CLIENT_WRITE_STR(num);
+    }
+    HTTP_CLIENT_WRITE_STR(CRLF);
+    if (req->content_type != NULL) {
+        HTTP_CLIENT_WRITE_STR("Content-Type: ");
+        HTTP_CLIENT_WRITE_STR(req->content_type);
+        HTTP_CLIENT_WRITE_STR(CRLF);
+    }
+    if (req->body == NULL && req->body_fn != NULL && req->body_len == 0) {
+        chunked = 1;
+        HTTP_CLIENT_WRITE_STR("Transfer-Encoding: chunked" CRLF);
+    } else if (req->body_len > 0 || req->method == ESP_HTTP_CLIENT_METHOD_POST || req->method == ESP_HTTP_CLIENT_METHOD_PUT) {
+        sprintf(num, "%u", (unsigned)req->body_len);
+        HTTP_CLIENT_WRITE_STR("Content-Length: ");
+        HTTP_CLIENT_WRITE_STR(num);
+        HTTP_CLIENT_WRITE_STR(CRLF);
+    }
+    if (req->headers != NULL) {
+        HTTP_CLIENT_WRITE_STR(req->headers);
+    }
+    HTTP_CLIENT_WRITE_STR(CRLF);
+
+    /* Send body from memory or stream it from callback */
+    if (req->body != NULL) {
+        if (req->body_len > 0 && (res = esp_netconn_write(nc, req->body, req->body_len)) != espOK) {
+            return res;
+        }
+    } else if (req->body_fn != NULL) {
+        uint8_t* buff;
+        size_t len, total = 0;
+
+        if ((buff = esp_mem_malloc_tag(ESP_CFG_HTTP_CLIENT_BODY_BUFF_LEN, ESP_MEM_TAG_HTTP)) == NULL) {
+            return espERRMEM;
+        }
+        res = espOK;
+        while (res == espOK && (chunked || total < req->body_len)) {
+            len = ESP_CFG_HTTP_CLIENT_BODY_BUFF_LEN;
+            if (!chunked) {
+                len = ESP_MIN(len, req->body_len - total);
+            }
+            if ((len = req->body_fn(req->arg, buff, len)) == 0) {
+                break;
+            }
+            total += len;
+            res = http_client_write_chunk(nc, buff, len, chunked);
+        }
+        esp_mem_free_s((void **)&buff);
+        if (res != espOK) {
+            return res;
+        }
+        if (!chunked && total < req->body_len) {/* Callback ended before announced length */
+            return espERR;
+        }
+        if (chunked) {
+            HTTP_CLIENT_WRITE_STR("0" CRLF CRLF);
+        }
+    }
+#undef HTTP_CLIENT_WRITE_STR
+    return esp_netconn_flush(nc);
+}
+
+/**
+ * \brief           Process complete status, header or chunk line
+ * \param[in]       client: HTTP client
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+http_client_process_line(esp_http_client_t* client) {
+    const esp_http_client_req_t* req = client->req;
+    char* line = client->line;
+    char* value;
+
+    switch (client->state) {
+        case HTTP_CLIENT_STATE_STATUS: {
+            if (strncmp(line, "HTTP/1.", 7) || (value = strchr(line, ' ')) == NULL) {
+                return espERR;
+            }
+            client->status = (uint16_t)strtoul(value, NULL, 10);
+            client->is_chunked = 0;
+            client->has_len = 0;
+            client->is_close = line[7] == '0';  /* HTTP/1.0 closes connection by default */
+            client->rem_len = 0;
+            client->state = HTTP_CLIENT_STATE_HEADER;
+            break;
+        }
+        case HTTP_CLIENT_STATE_HEADER: {
+            if (*line == '\0') {                /* Empty line ends headers */
+                if (client->status >= 100 && client->status < 200) {
+                    client->state = HTTP_CLIENT_STATE_STATUS;   /* Informational response, final status follows */
+                } else if (req->method == ESP_HTTP_CLIENT_METHOD_HEAD
+                            || client->status == 204 || client->status == 304) {
+                    client->state = HTTP_CLIENT_STATE_DONE;
+                } else if (client->is_chunked) {
+                    client->state = HTTP_CLIENT_STATE_CHUNK_SIZE;
+                } else if (client->has_len) {
+                    client->state = client->rem_len > 0 ? HTTP_CLIENT_STATE_BODY : HTTP_CLIENT_STATE_DONE;
+                } else {
+                    client->is_close = 1;
+                    client->state = HTTP_CLIENT_STATE_BODY_CLOSE;
+                }
+                break;
+            }
+            if ((value = strchr(line, ':')) == NULL) {
+                break;                          /* Ignore invalid header line */
+            }
+            *value++ = '\0';
+            while (*value == ' ' || *value == '\t') {
+                ++value;
+            }
+            if (http_client_streq(line, "Content-Length")) {
+                client->rem_len = (size_t)strtoul(value, NULL, 10);
+                client->has_len = 1;
+            } else if (http_client_streq(line, "Transfer-Encoding")) {
+                client->is_chunked = http_client_streq(value, "chunked");
+            } else if (http_client_streq(line, "Connection")) {
+                if (http_client_streq(value, "close")) {
+                    client->is_close = 1;
+                } else if (http_client_streq(value, "keep-alive")) {
+                    client->is_close = 0;
+                }
+            }
+            if (req->header_fn != NULL) {
+                req->header_fn(req->arg, line, value);
+            }
+            break;
+        }
+        case HTTP_CLIENT_STATE_CHUNK_SIZE: {
+            if (!isxdigit((unsigned char)*line)) {
+                return espERR;
+            }
+            client->rem_len = (size_t)strtoul(line, NULL, 16);  /* Chunk extensions are ignored */
+            client->state = client->rem_len > 0 ? HTTP_CLIENT_STATE_CHUNK_DATA : HTTP_CLIENT_STATE_TRAILER;
+            break;
+        }
+        case HTTP_CLIENT_STATE_CHUNK_END: {
+            if (*line != '\0') {
+                return espERR;
+            }
+            client->state = HTTP_CLIENT_STATE_CHUNK_SIZE;
+            break;
+        }
+        case HTTP_CLIENT_STATE_TRAILER: {
+            if (*line == '\0') {
+                client->state = HTTP_CLIENT_STATE_DONE;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return espOK;
+}
+
+/**
+ * \brief           Parse part of response
+ * \param[in]       client: HTTP client
+ * \param[in]       data: Received data
+ * \param[in]       len: Length of data in units of bytes
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+http_client_parse(esp_http_client_t* client, const char* data, size_t len) {
+    const esp_http_client_req_t* req = client->req;
+    espr_t res = espOK;
+    size_t n;
+
+    while (len > 0 && res == espOK && client->state != HTTP_CLIENT_STATE_DONE) {
+        switch (client->state) {
+            case HTTP_CLIENT_STATE_BODY:
+            case HTTP_CLIENT_STATE_CHUNK_DATA:
+            case HTTP_CLIENT_STATE_BODY_CLOSE: {
+                n = len;
+                if (client->state != HTTP_CLIENT_STATE_BODY_CLOSE) {
+                    n = ESP_MIN(n, client->rem_len);
+                    client->rem_len -= n;
+                }
+                if (req->data_fn != NULL) {
+                    res = req->data_fn(req->arg, data, n);
+                }
+                data += n;
+                len -= n;
+                if (client->state == HTTP_CLIENT_STATE_BODY && client->rem_len == 0) {
+                    client->state = HTTP_CLIENT_STATE_DONE;
+                } else if (client->state == HTTP_CLIENT_STATE_CHUNK_DATA && client->rem_len == 0) {
+                    client->state = HTTP_CLIENT_STATE_CHUNK_END;
+                }
+                break;
+            }
+            default: {                          /* Line based states */
+                char ch = *data++;
+
+                --len;
+                if (ch == '\n') {
+                    if (client->line_len > 0 && client->line[client->line_len - 1] == '\r') {
+                        --client->line_len;
+                    }
+                    client->line[client->line_len] = '\0';
+                    client->line_len = 0;
+                    res = http_client_process_line(client);
+                } else if (client->line_len < sizeof(client->line) - 1) {
+                    client->line[client->line_len++] = ch;
+                }
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+/**
+ * \brief           Create new HTTP client
+ * \return          Client handle on success, `NULL` otherwise
+ */
+esp_http_client_p
+esp_http_client_new(void) {
+    return esp_mem_calloc_tag(1, sizeof(esp_http_client_t), ESP_MEM_TAG_HTTP);
+}
+
+/**
+ * \brief           Delete HTTP client and its kept connection
+ *
+ * Kept connection is released to netconn connection pool when enabled
+ *
+ * \param[in]       client: Client handle
+ */
+void
+esp_http_client_delete(esp_http_client_p client) {
+    if (client == NULL) {
+        return;
+    }
+    http_client_close(client, 1);
+    esp_mem_free_s((void **)&client);
+}
+
+/**
+ * \brief           Send request and receive response
+ *
+ * Function blocks until response is received completely.
+ * Headers and body are passed to request callbacks while they are received.
+ *
+ * Connection is kept open when server allows it and used by next request to the same server.
+ * When kept connection has been closed by server in the meantime, request is sent again on new connection,
+ * except when body is streamed from callback
+ *
+ * \param[in]       client: Client handle
+ * \param[in]       req: Request description, must stay valid until function returns
+ * \param[out]      status: Pointer to output variable for response status code. Set to `NULL` when not used
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_http_client_request(esp_http_client_p client, const esp_http_client_req_t* req, uint16_t* status) {
+    esp_port_t port;
+    esp_pbuf_p pbuf;
+    uint8_t reused, received;
+    espr_t res;
+
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("req != NULL", req != NULL);
+    ESP_ASSERT("req->host != NULL", req->host != NULL);
+    ESP_ASSERT("req->method", (size_t)req->method < ESP_ARRAYSIZE(http_client_methods));
+
+    port = req->port;
+    if (port == 0) {
+        port = req->ssl ? 443 : 80;
+    }
+
+    do {
+        if ((res = http_client_connect(client, req, port, &reused)) != espOK) {
+            return res;
+        }
+
+        client->req = req;
+        client->state = HTTP_CLIENT_STATE_STATUS;
+        client->status = 0;
+        client->line_len = 0;
+        received = 0;
+
+        res = http_client_send_request(client, req, port);
+        while (res == espOK && client->state != HTTP_CLIENT_STATE_DONE) {
+            if ((res = esp_netconn_receive(client->nc, &pbuf)) != espOK) {
+                if (res == espCLOSED && client->state == HTTP_CLIENT_STATE_BODY_CLOSE) {
+                    client->state = HTTP_CLIENT_STATE_DONE; /* Body delimited by connection close */
+                    res = espOK;
+                }
+                break;
+            }
+            received = 1;
+
+            /* Parse all packet buffers in chain without copying */
+            for (size_t offset = 0, len; res == espOK && offset < esp_pbuf_length(pbuf, 1); offset += len) {
+                const char* d = esp_pbuf_get_linear_addr(pbuf, offset, &len);
+
+                if (d == NULL) {
+                    break;
+                }
+                res = http_client_parse(client, d, len);
+            }
+            esp_pbuf_free(pbuf);
+        }
+
+        /* Kept connection was closed by server before response */
+        if (res != espOK && reused && !received && req->body_fn == NULL) {
+            ESP_DEBUGF(ESP_CFG_DBG_HTTP_CLIENT_TRACE_WARNING, "[HTTP CLIENT] Kept connection closed, reconnecting\r\n");
+            http_client_close(client, 0);
+            continue;
+        }
+        break;
+    } while (1);
+
+    if (res == espOK && status != NULL) {
+        *status = client->status;
+    }
+
+    /* Keep connection only when response end is known and server does not close it */
+    if (res != espOK || client->is_close) {
+        http_client_close(client, 0);
+    }
+    client->req = NULL;
+    return res;
+}
+
+#endif /* (ESP_CFG_NETCONN && !ESP_CFG_HTTP_CLIENT_AT) || __DOXYGEN__ */
@@ -0,0 +1,201 @@
+/**
+ * \file            esp_http_client_at.c
+ * \brief           HTTP client on top of ESP32 AT commands
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/apps/esp_http_client.h"
+#include "esp/esp_mem.h"
+#include <stdio.h>
+
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+
+/**
+ * \brief           HTTP client structure
+ */
+typedef struct esp_http_client {
+    const esp_http_client_req_t* req;           /*!< Request in progress */
+} esp_http_client_t;
+
+static const esp_http_at_method_t
+http_client_methods[] = {
+    ESP_HTTP_AT_METHOD_GET, ESP_HTTP_AT_METHOD_HEAD, ESP_HTTP_AT_METHOD_POST,
+    ESP_HTTP_AT_METHOD_PUT, ESP_HTTP_AT_METHOD_DELETE,
+};
+
+/**
+ * \brief           Pass response data from device to request callback
+ * \note            Function is called from processing thread
+ * \param[in]       data: Part of response body
+ * \param[in]       len: Length of data in units of bytes
+ * \param[in]       arg: HTTP client
+ */
+static void
+http_client_at_data(const void* data, size_t len, void* arg) {
+    esp_http_client_t* client = arg;
+
+    if (client->req != NULL && client->req->data_fn != NULL) {
+        client->req->data_fn(client->req->arg, data, len);
+    }
+}
+
+/**
+ * \brief           Get content type parameter of `AT+HTTPCLIENT` command from `Content-Type` value
+ * \param[in]       type: Content type string or `NULL`
+ * \return          Content type supported by device
+ */
+static esp_http_at_content_type_t
+http_client_at_content_type(const char* type) {
+    if (type != NULL) {
+        if (strstr(type, "json") != NULL) {
+            return ESP_HTTP_AT_CONTENT_TYPE_JSON;
+        } else if (strstr(type, "multipart") != NULL) {
+            return ESP_HTTP_AT_CONTENT_TYPE_MULTIPART;
+        } else if (strstr(type, "xml") != NULL) {
+            return ESP_HTTP_AT_CONTENT_TYPE_XML;
+        }
+    }
+    return ESP_HTTP_AT_CONTENT_TYPE_FORM;
+}
+
+/**
+ * \brief           Create new HTTP client
+ * \return          Client handle on success, `NULL` otherwise
+ */
+esp_http_client_p
+esp_http_client_new(void) {
+    return esp_mem_calloc_tag(1, sizeof(esp_http_client_t), ESP_MEM_TAG_HTTP);
+}
+
+/**
+ * \brief           Delete HTTP client
+ * \param[in]       client: Client handle
+ */
+void
+esp_http_client_delete(esp_http_client_p client) {
+    esp_mem_free_s((void **)&client);
+}
+
+/**
+ * \brief           Send request and receive response
+ *
+ * Request is executed by device, connection is opened and closed by device for every request.
+ * Compared to netconn based client:
+ *
+ *  - Body is sent as string and must not contain `NULL` characters, `body_fn` is not supported
+ *  - Response headers are not reported and `header_fn` is never called
+ *  - `data_fn` is called from processing thread and its return value is ignored
+ *  - Device reports error for unsuccessful response, status is set to `200` on success
+ *
+ * \param[in]       client: Client handle
+ * \param[in]       req: Request description, must stay valid until function returns
+ * \param[out]      status: Pointer to output variable for response status code. Set to `NULL` when not used
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_http_client_request(esp_http_client_p client, const esp_http_client_req_t* req, uint16_t* status) {
+    const char* path;
+    char* url, *body = NULL, *hdrs = NULL, *p;
+    size_t len, hdrs_cnt = 0;
+    esp_port_t port;
+    espr_t res;
+
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("req != NULL", req != NULL);
+    ESP_ASSERT("req->host != NULL", req->host != NULL);
+    ESP_ASSERT("req->method", (size_t)req->method < ESP_ARRAYSIZE(http_client_methods));
+
+    if (req->body == NULL && req->body_fn != NULL) {
+        return espPARERR;                       /* Device cannot stream request body */
+    }
+
+    /* Build full URL from host, port and path */
+    path = req->path != NULL ? req->path : "/";
+    port = req->port != 0 ? req->port : (req->ssl ? 443 : 80);
+    len = strlen(req->host) + strlen(path) + 16;
+    if ((url = esp_mem_malloc_tag(len, ESP_MEM_TAG_HTTP)) == NULL) {
+        return espERRMEM;
+    }
+    if (port != (req->ssl ? 443 : 80)) {
+        sprintf(url, "%s://%s:%u%s", req->ssl ? "https" : "http", req->host, (unsigned)port, path);
+    } else {
+        sprintf(url, "%s://%s%s", req->ssl ? "https" : "http", req->host, path);
+    }
+
+    res = espOK;
+    if (req->body != NULL) {                    /* Body must be string for device */
+        if ((body = esp_mem_malloc_tag(req->body_len + 1, ESP_MEM_TAG_HTTP)) != NULL) {
+            ESP_MEMCPY(body, req->body, req->body_len);
+            body[req->body_len] = '\0';
+        } else {
+            res = espERRMEM;
+        }
+    }
+
+    /* Split header lines to separate strings */
+    if (res == espOK && req->headers != NULL && *req->headers) {
+        len = strlen(req->headers) + 1;
+        if ((hdrs = esp_mem_malloc_tag(len, ESP_MEM_TAG_HTTP)) != NULL) {
+            const char* s = req->headers;
+
+            for (p = hdrs; *s; ) {
+                const char* e = strstr(s, "\r\n");
+                size_t l = e != NULL ? (size_t)(e - s) : strlen(s);
+
+                if (l > 0) {
+                    ESP_MEMCPY(p, s, l);
+                    p += l;
+                    *p++ = '\0';
+                    ++hdrs_cnt;
+                }
+                s += l + (e != NULL ? 2 : 0);
+            }
+        } else {
+            res = espERRMEM;
+        }
+    }
+
+    if (res == espOK) {
+        client->req = req;
+        res = esp_http_at_request(http_client_methods[req->method], http_client_at_content_type(req->content_type),
+            url, body, hdrs, hdrs_cnt, http_client_at_data, client, NULL, NULL, 1);
+        client->req = NULL;
+        if (res == espOK && status != NULL) {
+            *status = 200;
+        }
+    }
+
+    esp_mem_free_s((void **)&hdrs);
+    esp_mem_free_s((void **)&body);
+    esp_mem_free_s((void **)&url);
+    return res;
+}
+
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
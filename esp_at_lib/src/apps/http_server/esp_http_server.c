@@ -34,6 +34,7 @@
 #include "esp/apps/esp_http_server.h"
 #include "esp/esp_mem.h"
 #include <ctype.h>
+#include <stdlib.h>
 
 #define ESP_CFG_DBG_SERVER_TRACE            (ESP_CFG_DBG_SERVER | ESP_DBG_TYPE_TRACE)
 #define ESP_CFG_DBG_SERVER_TRACE_WARNING    (ESP_CFG_DBG_SERVER | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING)
@@ -43,18 +44,79 @@
 uint8_t     http_fs_data_open_file(const http_init_t* hi, http_fs_file_t* file, const char* path);
 uint32_t    http_fs_data_read_file(const http_init_t* hi, http_fs_file_t* file, void** buff, size_t btr, size_t* br);
 void        http_fs_data_close_file(const http_init_t* hi, http_fs_file_t* file);
+#if HTTP_RANGE_REQUESTS
+uint8_t     http_fs_data_seek_file(const http_init_t* hi, http_fs_file_t* file, uint32_t pos, uint32_t end);
+#endif /* HTTP_RANGE_REQUESTS */
+
+static uint8_t http_recv(http_state_t* hs, esp_pbuf_p p);
 
 /** Number of opened files in system */
 uint16_t http_fs_opened_files_cnt;
 
 #define CRLF                        "\r\n"
 
-static char http_uri[HTTP_MAX_URI_LEN + 1];
+#if HTTP_ETAG && !HTTP_DYNAMIC_HEADERS
+#error "HTTP_ETAG requires HTTP_DYNAMIC_HEADERS"
+#endif /* HTTP_ETAG && !HTTP_DYNAMIC_HEADERS */
+
+/* Dynamic header indexes, content type is always last */
+#define HTTP_HDR_IDX_CONNECTION     3
+#define HTTP_HDR_IDX_RANGE          (HTTP_HDR_IDX_ENCODING - (HTTP_GZIP_STATIC_FILES ? 1 : 0))
+#define HTTP_HDR_IDX_ENCODING       (HTTP_MAX_HEADERS - 2 - (HTTP_ETAG ? 1 : 0))
+#define HTTP_HDR_IDX_ETAG           (HTTP_MAX_HEADERS - 2)
+
+#if HTTP_SSI_HASH_SIZE & (HTTP_SSI_HASH_SIZE - 1)
+#error "HTTP_SSI_HASH_SIZE must be a power of 2"
+#endif /* HTTP_SSI_HASH_SIZE & (HTTP_SSI_HASH_SIZE - 1) */
+
+#if HTTP_POST_FLOW_CONTROL && (!HTTP_SUPPORT_POST || !ESP_CFG_CONN_MANUAL_TCP_RECEIVE)
+#error "HTTP_POST_FLOW_CONTROL requires HTTP_SUPPORT_POST and ESP_CFG_CONN_MANUAL_TCP_RECEIVE"
+#endif
+
+#if HTTP_KEEP_ALIVE && (!HTTP_DYNAMIC_HEADERS || !HTTP_DYNAMIC_HEADERS_CONTENT_LEN)
+#error "HTTP_KEEP_ALIVE requires HTTP_DYNAMIC_HEADERS and HTTP_DYNAMIC_HEADERS_CONTENT_LEN"
+#endif /* HTTP_KEEP_ALIVE && (!HTTP_DYNAMIC_HEADERS || !HTTP_DYNAMIC_HEADERS_CONTENT_LEN) */
+
+#if HTTP_RANGE_REQUESTS && (!HTTP_DYNAMIC_HEADERS || !HTTP_DYNAMIC_HEADERS_CONTENT_LEN)
+#error "HTTP_RANGE_REQUESTS requires HTTP_DYNAMIC_HEADERS and HTTP_DYNAMIC_HEADERS_CONTENT_LEN"
+#endif /* HTTP_RANGE_REQUESTS && (!HTTP_DYNAMIC_HEADERS || !HTTP_DYNAMIC_HEADERS_CONTENT_LEN) */
+
+#if HTTP_CHUNKED_ENCODING && !HTTP_KEEP_ALIVE
+#error "HTTP_CHUNKED_ENCODING requires HTTP_KEEP_ALIVE"
+#endif /* HTTP_CHUNKED_ENCODING && !HTTP_KEEP_ALIVE */
+
+static char http_uri_buff[HTTP_MAX_URI_LEN + 1];
+static char* http_uri;
 static http_param_t http_params[HTTP_MAX_PARAMS];
 
 /* HTTP init structure with user settings */
 static const http_init_t* hi;
 
+#if HTTP_RESP_CACHE
+/**
+ * \brief           Cached response entry
+ */
+typedef struct http_cache_entry {
+    uint8_t* buff;                              /*!< Request URI, file path and response body, `NULL` when entry is empty */
+    const char* path;                           /*!< Path of file response was rendered from */
+    const uint8_t* data;                        /*!< Response body */
+    size_t len;                                 /*!< Length of response body in units of bytes */
+    uint32_t time;                              /*!< Time when response was stored */
+    uint32_t ttl;                               /*!< Time-to-live in units of milliseconds, `0` when not limited */
+    uint16_t ref;                               /*!< Number of connections sending this response */
+    uint8_t valid;                              /*!< Set to `1` when entry may be used for new requests */
+} http_cache_entry_t;
+
+/* Cached responses and invalidation counter for responses being captured */
+static http_cache_entry_t http_cache_entries[HTTP_RESP_CACHE_ENTRIES];
+static uint8_t http_cache_epoch;
+#endif /* HTTP_RESP_CACHE */
+
+#if HTTP_STATE_POOL
+/* Preallocated HTTP states, indexed by connection number */
+static http_state_t http_states[ESP_CFG_MAX_CONNS];
+#endif /* HTTP_STATE_POOL */
+
 #if HTTP_USE_METHOD_NOTALLOWED_RESP
 /**
  * \brief           Default output for method not allowed response
@@ -81,10 +143,37 @@ typedef enum {
     HTTP_HDR_200,
     HTTP_HDR_400,
     HTTP_HDR_404,
+#if HTTP_ETAG
+    HTTP_HDR_304,
+#endif /* HTTP_ETAG */
+#if HTTP_RANGE_REQUESTS
+    HTTP_HDR_206,
+#endif /* HTTP_RANGE_REQUESTS */
 
     /* Server response code */
     HTTP_HDR_SERVER,
 
+#if HTTP_RANGE_REQUESTS
+    /* Range support */
+    HTTP_HDR_ACCEPT_RANGES,
+#endif /* HTTP_RANGE_REQUESTS */
+
+#if HTTP_KEEP_ALIVE
+    /* Connection persistence */
+    HTTP_HDR_KEEP_ALIVE,
+    HTTP_HDR_CLOSE,
+#endif /* HTTP_KEEP_ALIVE */
+
+#if HTTP_CHUNKED_ENCODING
+    /* Transfer encoding */
+    HTTP_HDR_CHUNKED,
+#endif /* HTTP_CHUNKED_ENCODING */
+
+#if HTTP_GZIP_STATIC_FILES
+    /* Content encoding */
+    HTTP_HDR_GZIP,
+#endif /* HTTP_GZIP_STATIC_FILES */
+
     /* Content type strings */
     HTTP_HDR_HTML,
     HTTP_HDR_PNG,
@@ -106,10 +195,37 @@ http_dynstrs[] = {
     "HTTP/1.1 200 OK" CRLF,
     "HTTP/1.1 400 Bad Request" CRLF,
     "HTTP/1.1 404 File Not Found" CRLF,
+#if HTTP_ETAG
+    "HTTP/1.1 304 Not Modified" CRLF,
+#endif /* HTTP_ETAG */
+#if HTTP_RANGE_REQUESTS
+    "HTTP/1.1 206 Partial Content" CRLF,
+#endif /* HTTP_RANGE_REQUESTS */
 
     /* Server response code */
     "Server: " HTTP_SERVER_NAME CRLF,
 
+#if HTTP_RANGE_REQUESTS
+    /* Range support */
+    "Accept-Ranges: bytes" CRLF,
+#endif /* HTTP_RANGE_REQUESTS */
+
+#if HTTP_KEEP_ALIVE
+    /* Connection persistence */
+    "Connection: keep-alive" CRLF,
+    "Connection: close" CRLF,
+#endif /* HTTP_KEEP_ALIVE */
+
+#if HTTP_CHUNKED_ENCODING
+    /* Transfer encoding */
+    "Transfer-Encoding: chunked" CRLF,
+#endif /* HTTP_CHUNKED_ENCODING */
+
+#if HTTP_GZIP_STATIC_FILES
+    /* Content encoding */
+    "Content-Encoding: gzip" CRLF,
+#endif /* HTTP_GZIP_STATIC_FILES */
+
     /* Content type strings */
     "Content-type: text/html" CRLF CRLF,
     "Content-type: image/png" CRLF CRLF,
@@ -203,8 +319,80 @@ strcmpa(const char* a, const char* b) {
     }
 }
 
+#if HTTP_SORTED_URI_TABLES
+/**
+ * \brief           Compare URI with CGI entry for binary search
+ * \param[in]       key: URI to search for
+ * \param[in]       entry: CGI entry
+ * \return          Result of `strcmp` between URI and entry URI
+ */
+static int
+http_cgi_cmp(const void* key, const void* entry) {
+    return strcmp(key, ((const http_cgi_t *)entry)->uri);
+}
+#endif /* HTTP_SORTED_URI_TABLES */
+
+#if HTTP_SSI_HASH_SIZE > 0
+
+/* FNV-1a hash of SSI tag name, calculated character by character */
+#define HTTP_SSI_HASH_INIT          0x811C9DC5UL
+#define HTTP_SSI_HASH_STEP(h, ch)   (((h) ^ (uint8_t)(ch)) * 0x01000193UL)
+
+static uint32_t ssi_index_hash[HTTP_SSI_HASH_SIZE];         /*!< Tag name hash of each slot */
+static const http_ssi_t* ssi_index[HTTP_SSI_HASH_SIZE];     /*!< Table entry of slot, `NULL` when slot is free */
+
+/**
+ * \brief           Build hash index of SSI tag table
+ * \param[in]       init: HTTP init structure
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+http_ssi_index_build(const http_init_t* init) {
+    ESP_MEMSET(ssi_index, 0x00, sizeof(ssi_index));
+    if (init == NULL || init->ssi == NULL) {
+        return espOK;
+    }
+    if (init->ssi_count >= HTTP_SSI_HASH_SIZE) {    /* Keep at least one free slot to end lookup */
+        return espERRMEM;
+    }
+    for (size_t i = 0; i < init->ssi_count; ++i) {
+        uint32_t hash = HTTP_SSI_HASH_INIT;
+        size_t slot;
+
+        for (const char* t = init->ssi[i].tag; *t != '\0'; ++t) {
+            hash = HTTP_SSI_HASH_STEP(hash, *t);
+        }
+        for (slot = hash & (HTTP_SSI_HASH_SIZE - 1); ssi_index[slot] != NULL; slot = (slot + 1) & (HTTP_SSI_HASH_SIZE - 1)) {}
+        ssi_index[slot] = &init->ssi[i];
+        ssi_index_hash[slot] = hash;
+    }
+    return espOK;
+}
+
+/**
+ * \brief           Find SSI table entry for tag
+ * \param[in]       hash: Hash of tag name
+ * \param[in]       tag: Tag name
+ * \return          Table entry on success, `NULL` otherwise
+ */
+static const http_ssi_t*
+http_ssi_find(uint32_t hash, const char* tag) {
+    for (size_t slot = hash & (HTTP_SSI_HASH_SIZE - 1); ssi_index[slot] != NULL; slot = (slot + 1) & (HTTP_SSI_HASH_SIZE - 1)) {
+        if (ssi_index_hash[slot] == hash && !strcmp(ssi_index[slot]->tag, tag)) {
+            return ssi_index[slot];
+        }
+    }
+    return NULL;
+}
+
+#endif /* HTTP_SSI_HASH_SIZE > 0 */
+
 /**
- * \brief           Parse URI from HTTP request and copy it to linear memory location
+ * \brief           Parse URI from HTTP request
+ *
+ *                  When URI is in single linear part of pbuf chain, it is terminated in place
+ *                  and used directly from received data. It is copied to linear memory otherwise
+ *
  * \param[in]       p: Chain of pbufs from request
  * \return          \ref espOK if successfully parsed, member of \ref espr_t otherwise
  */
@@ -212,6 +400,9 @@ static espr_t
 http_parse_uri(esp_pbuf_p p) {
     size_t pos_s, pos_e, pos_crlf, uri_len;
 
+    http_uri = http_uri_buff;                   /* Empty URI on failure */
+    http_uri[0] = 0;
+
     pos_s = esp_pbuf_strfind(p, " ", 0);        /* Find first " " in request header */
     if (pos_s == ESP_SIZET_MAX || (pos_s != 3 && pos_s != 4)) {
         return espERR;
@@ -221,7 +412,7 @@ http_parse_uri(esp_pbuf_p p) {
         return espERR;
     }
     pos_e = esp_pbuf_strfind(p, " ", pos_s + 1);/* Find second " " in request header */
-    if (pos_e == ESP_SIZET_MAX) {               /* If there is no second " " */
+    if (pos_e == ESP_SIZET_MAX || pos_e > pos_crlf) {   /* If there is no second " " in request line */
         /*
          * HTTP 0.9 request is "GET /\r\n" without
          * space between request URI and CRLF
@@ -233,6 +424,18 @@ http_parse_uri(esp_pbuf_p p) {
     if (uri_len > HTTP_MAX_URI_LEN) {
         return espERR;
     }
+
+    /* Space after URI is replaced by terminating 0, CRLF is kept for further header parsing */
+    if (pos_e != pos_crlf) {
+        size_t len;
+
+        http_uri = esp_pbuf_get_linear_addr(p, pos_s + 1, &len);
+        if (http_uri != NULL && len > uri_len) {
+            http_uri[uri_len] = 0;              /* Set terminating 0 */
+            return espOK;
+        }
+        http_uri = http_uri_buff;
+    }
     esp_pbuf_copy(p, http_uri, uri_len, pos_s + 1); /* Copy data from pbuf to linear memory */
     http_uri[uri_len] = 0;                      /* Set terminating 0 */
 
@@ -274,6 +477,114 @@ http_get_params(char* params) {
     return cnt;
 }
 
+#if HTTP_ETAG
+/**
+ * \brief           Check if `If-None-Match` request header contains entity tag
+ * \param[in]       p: Received request with headers
+ * \param[in]       etag: Entity tag of response file
+ * \return          `1` if client has current file version, `0` otherwise
+ */
+static uint8_t
+http_req_etag_match(esp_pbuf_p p, const char* etag) {
+    size_t pos, pos_crlf, hdr_end;
+
+    if (p == NULL || (hdr_end = esp_pbuf_strfind(p, CRLF CRLF, 0)) == ESP_SIZET_MAX) {
+        return 0;
+    }
+    if (((pos = esp_pbuf_strfind(p, "If-None-Match:", 0)) != ESP_SIZET_MAX && pos < hdr_end) ||
+        ((pos = esp_pbuf_strfind(p, "if-none-match:", 0)) != ESP_SIZET_MAX && pos < hdr_end)) {
+        pos_crlf = esp_pbuf_strfind(p, CRLF, pos);
+        pos = esp_pbuf_strfind(p, etag, pos);   /* Tag may be one of the list */
+        return pos != ESP_SIZET_MAX && pos < pos_crlf;
+    }
+    return 0;
+}
+#endif /* HTTP_ETAG */
+
+#if HTTP_RANGE_REQUESTS
+/**
+ * \brief           Get single byte range from `Range` request header
+ * \param[in]       p: Received request with headers
+ * \param[in]       size: Total size of response file
+ * \param[in]       etag: Entity tag of response file to validate `If-Range` header or `NULL`
+ * \param[out]      start: Pointer to output variable to save position of first byte in range
+ * \param[out]      end: Pointer to output variable to save position of last byte in range
+ * \return          `1` if valid range is requested, `0` otherwise
+ */
+static uint8_t
+http_req_range(esp_pbuf_p p, uint32_t size, const char* etag, uint32_t* start, uint32_t* end) {
+    size_t pos, pos_crlf, hdr_end;
+    uint32_t s = 0, e = 0;
+    uint8_t ch, has_s = 0, has_e = 0;
+
+    if (p == NULL || size == 0 || (hdr_end = esp_pbuf_strfind(p, CRLF CRLF, 0)) == ESP_SIZET_MAX) {
+        return 0;
+    }
+
+    /* Range applies only to the same file version as client already has */
+    if (((pos = esp_pbuf_strfind(p, "If-Range:", 0)) != ESP_SIZET_MAX && pos < hdr_end) ||
+        ((pos = esp_pbuf_strfind(p, "if-range:", 0)) != ESP_SIZET_MAX && pos < hdr_end)) {
+        pos_crlf = esp_pbuf_strfind(p, CRLF, pos);
+        if (etag == NULL || (pos = esp_pbuf_strfind(p, etag, pos)) == ESP_SIZET_MAX || pos > pos_crlf) {
+            return 0;
+        }
+    }
+
+    if (!(((pos = esp_pbuf_strfind(p, "Range: bytes=", 0)) != ESP_SIZET_MAX && pos < hdr_end) ||
+        ((pos = esp_pbuf_strfind(p, "range: bytes=", 0)) != ESP_SIZET_MAX && pos < hdr_end))) {
+        return 0;
+    }
+    pos += 13;                                  /* Skip header name */
+
+    /* Parse "start-end", "start-" or "-suffix" format */
+    while (esp_pbuf_get_at(p, pos, &ch) && ch >= '0' && ch <= '9') {
+        if (s > size) {
+            return 0;
+        }
+        s = 10 * s + (ch - '0');
+        has_s = 1;
+        ++pos;
+    }
+    if (!esp_pbuf_get_at(p, pos, &ch) || ch != '-') {
+        return 0;
+    }
+    ++pos;
+    while (esp_pbuf_get_at(p, pos, &ch) && ch >= '0' && ch <= '9') {
+        if (e <= size) {
+            e = 10 * e + (ch - '0');
+        }
+        has_e = 1;
+        ++pos;
+    }
+    if (!esp_pbuf_get_at(p, pos, &ch) || ch != '\r') {
+        return 0;                               /* Multiple ranges are not supported */
+    }
+
+    if (has_s) {
+        if (s >= size) {
+            return 0;
+        }
+        if (!has_e || e >= size) {
+            e = size - 1;
+        }
+        if (e < s) {
+            return 0;
+        }
+    } else if (has_e && e > 0) {
+        if (e > size) {
+            e = size;
+        }
+        s = size - e;                           /* Last bytes of file */
+        e = size - 1;
+    } else {
+        return 0;
+    }
+    *start = s;
+    *end = e;
+    return 1;
+}
+#endif /* HTTP_RANGE_REQUESTS */
+
 #if HTTP_DYNAMIC_HEADERS
 /**
  * \brief           Prepare dynamic headers to be sent as response to user
@@ -289,22 +600,15 @@ prepare_dynamic_headers(http_state_t* hs, const char* uri) {
     hs->dyn_hdr_pos = 0;
 
     hs->dyn_hdr_strs[1] = http_dynstrs[HTTP_HDR_SERVER];    /* Set server name */
+    hs->dyn_hdr_strs[2] = NULL;                 /* No content length by default */
     if (!hs->resp_file_opened) {                /* This should never be the case as 404.html file exists as static */
         hs->dyn_hdr_strs[0] = http_dynstrs[HTTP_HDR_404];   /* 404 Not Found */
         hs->dyn_hdr_strs[HTTP_MAX_HEADERS - 1] = http_dynstrs[HTTP_HDR_HTML];   /* Content type text/html */
     } else {
         /*
-         * Try to find CRLFCRLF sequence on static files and remove
-         * the headers if dynamic headers are used
+         * Headers embedded in static files are already skipped on file open,
+         * using header length from static file table
          */
-        if (hs->resp_file.is_static) {
-            char* crlfcrlf;
-            crlfcrlf = strstr((const char *)hs->resp_file.data, CRLF CRLF);
-            if (crlfcrlf != NULL) {             /* Skip header part of file */
-                hs->resp_file.size -= (const char *)crlfcrlf - (const char *)hs->resp_file.data + 4;/* Decrease file size first! */
-                hs->resp_file.data += (const char *)crlfcrlf - (const char *)hs->resp_file.data + 4;/* Advance file pointer */
-            }
-        }
 
         /*
          * Process with content-length response header
@@ -317,7 +621,10 @@ prepare_dynamic_headers(http_state_t* hs, const char* uri) {
         hs->dyn_hdr_strs[2] = NULL;             /* No content length involved */
 #if HTTP_DYNAMIC_HEADERS_CONTENT_LEN
         if (!hs->is_ssi) {
-            sprintf(hs->dyn_hdr_cnt_len, "Content-Length: %d" CRLF, (int)hs->resp_file.size);
+            /* Build header directly, it is sent on every response */
+            ESP_MEMCPY(hs->dyn_hdr_cnt_len, "Content-Length: ", 16);
+            esp_u32_to_str(hs->resp_file.size, &hs->dyn_hdr_cnt_len[16]);
+            strcat(hs->dyn_hdr_cnt_len, CRLF);
             hs->dyn_hdr_strs[2] = hs->dyn_hdr_cnt_len;
         }
 #endif /* HTTP_DYNAMIC_HEADERS_CONTENT_LEN */
@@ -334,7 +641,8 @@ prepare_dynamic_headers(http_state_t* hs, const char* uri) {
         }
 
         /*
-         * Try to find content type by inspecting file extensions
+         * Try to find content type by inspecting file extensions,
+         * when it is not known from file system already
          *
          * At this point, uri should not include parameters in string as we are searching for actual file
          *
@@ -344,7 +652,10 @@ prepare_dynamic_headers(http_state_t* hs, const char* uri) {
 
         /* Step 1: Find extension of request path */
         ext = NULL;                             /* No extension on beginning */
-        u = strchr(uri, '.');                   /* Find first dot in string */
+        u = NULL;
+        if (hs->resp_file.content_type == HTTP_CONTENT_TYPE_AUTO) {
+            u = strchr(uri, '.');               /* Find first dot in string */
+        }
         while (u != NULL) {
             ext = u + 1;                        /* Set current u as extension but skip dot character */
             u = strchr(u + 1, '.');             /* Find next dot */
@@ -361,12 +672,90 @@ prepare_dynamic_headers(http_state_t* hs, const char* uri) {
         }
 
         /* Finally set the output content type header */
-        if (ext != NULL && i < ESP_ARRAYSIZE(dynamic_headers_pairs)) {
+        if (hs->resp_file.content_type != HTTP_CONTENT_TYPE_AUTO) {
+            hs->dyn_hdr_strs[HTTP_MAX_HEADERS - 1] = http_dynstrs[HTTP_HDR_HTML + (hs->resp_file.content_type - HTTP_CONTENT_TYPE_HTML)];
+        } else if (ext != NULL && i < ESP_ARRAYSIZE(dynamic_headers_pairs)) {
             hs->dyn_hdr_strs[HTTP_MAX_HEADERS - 1] = http_dynstrs[dynamic_headers_pairs[i].index];  /* Set response from index directly */
         } else {
             hs->dyn_hdr_strs[HTTP_MAX_HEADERS - 1] = http_dynstrs[HTTP_HDR_PLAIN];  /* Plain text, unknown type */
         }
+
+#if HTTP_ETAG
+        /*
+         * Send entity tag to allow client to validate its cached copy.
+         * When client already has the same content, respond without it
+         */
+        hs->dyn_hdr_strs[HTTP_HDR_IDX_ETAG] = NULL;
+        if (!hs->is_ssi && hs->resp_file.etag != NULL   /* SSI output is different on every request */
+            && strlen(hs->resp_file.etag) <= HTTP_ETAG_MAX_LEN) {
+            sprintf(hs->dyn_hdr_etag, "ETag: %s" CRLF "Cache-Control: " HTTP_CACHE_CONTROL CRLF, hs->resp_file.etag);
+            hs->dyn_hdr_strs[HTTP_HDR_IDX_ETAG] = hs->dyn_hdr_etag;
+            if (hs->req_method == HTTP_METHOD_GET && http_req_etag_match(hs->p, hs->resp_file.etag)) {
+                hs->not_modified = 1;
+                hs->dyn_hdr_strs[0] = http_dynstrs[HTTP_HDR_304];
+                hs->dyn_hdr_strs[2] = NULL;     /* No content is sent */
+            }
+        }
+#endif /* HTTP_ETAG */
+
+#if HTTP_RANGE_REQUESTS
+        /* Client may request part of file with known length */
+        hs->dyn_hdr_strs[HTTP_HDR_IDX_RANGE] = NULL;
+        if (!hs->is_ssi
+#if HTTP_ETAG
+            && !hs->not_modified
+#endif /* HTTP_ETAG */
+            ) {
+            uint32_t start, end;
+
+            hs->dyn_hdr_strs[HTTP_HDR_IDX_RANGE] = http_dynstrs[HTTP_HDR_ACCEPT_RANGES];
+            if (hs->req_method == HTTP_METHOD_GET && hs->dyn_hdr_strs[0] == http_dynstrs[HTTP_HDR_200]
+#if HTTP_ETAG
+                && http_req_range(hs->p, hs->resp_file.size, hs->resp_file.etag, &start, &end)
+#else /* HTTP_ETAG */
+                && http_req_range(hs->p, hs->resp_file.size, NULL, &start, &end)
+#endif /* !HTTP_ETAG */
+                && http_fs_data_seek_file(hi, &hs->resp_file, start, end + 1)) {
+                sprintf(hs->dyn_hdr_range, "Content-Range: bytes %u-%u/%u" CRLF,
+                    (unsigned)start, (unsigned)end, (unsigned)hs->resp_file.size);
+                sprintf(hs->dyn_hdr_cnt_len, "Content-Length: %d" CRLF, (int)(end - start + 1));
+                hs->dyn_hdr_strs[0] = http_dynstrs[HTTP_HDR_206];
+                hs->dyn_hdr_strs[2] = hs->dyn_hdr_cnt_len;
+                hs->dyn_hdr_strs[HTTP_HDR_IDX_RANGE] = hs->dyn_hdr_range;
+            }
+        }
+#endif /* HTTP_RANGE_REQUESTS */
+    }
+
+#if HTTP_CHUNKED_ENCODING
+    /* Response with unknown length is delimited by chunks on persistent connection */
+    hs->chunked = 0;
+    if (hs->resp_file_opened && hs->keep_alive && hs->dyn_hdr_strs[2] == NULL
+#if HTTP_ETAG
+        && !hs->not_modified
+#endif /* HTTP_ETAG */
+        ) {
+        hs->chunked = 1;
+        hs->dyn_hdr_strs[2] = http_dynstrs[HTTP_HDR_CHUNKED];
+    }
+#endif /* HTTP_CHUNKED_ENCODING */
+#if HTTP_KEEP_ALIVE
+    /*
+     * Connection may only stay opened when client knows where response ends,
+     * otherwise end of response is marked by closing the connection
+     */
+    if (!hs->resp_file_opened || (hs->dyn_hdr_strs[2] == NULL
+#if HTTP_ETAG
+        && !hs->not_modified
+#endif /* HTTP_ETAG */
+        )) {
+        hs->keep_alive = 0;
     }
+    hs->dyn_hdr_strs[HTTP_HDR_IDX_CONNECTION] = http_dynstrs[hs->keep_alive ? HTTP_HDR_KEEP_ALIVE : HTTP_HDR_CLOSE];
+#endif /* HTTP_KEEP_ALIVE */
+#if HTTP_GZIP_STATIC_FILES
+    hs->dyn_hdr_strs[HTTP_HDR_IDX_ENCODING] = hs->resp_file_opened && hs->is_gzip ? http_dynstrs[HTTP_HDR_GZIP] : NULL;
+#endif /* HTTP_GZIP_STATIC_FILES */
 }
 
 /**
@@ -412,6 +801,244 @@ send_dynamic_headers(http_state_t* hs) {
 }
 #endif
 
+/**
+ * \brief           Open response file for URI
+ *
+ *                  When client accepts gzip encoding,
+ *                  precompressed `.gz` variant of file is tried first
+ *
+ * \param[in]       hs: HTTP state
+ * \param[in]       uri: File path to open
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+http_open_file(http_state_t* hs, const char* uri) {
+#if HTTP_GZIP_STATIC_FILES
+    static char gz_uri[HTTP_MAX_URI_LEN + sizeof(".gz")];
+    size_t len;
+
+    hs->is_gzip = 0;
+    len = strlen(uri);
+    if (hs->accept_gzip && len < HTTP_MAX_URI_LEN) {
+        ESP_MEMCPY(gz_uri, uri, len);
+        ESP_MEMCPY(&gz_uri[len], ".gz", sizeof(".gz"));
+        if (http_fs_data_open_file(hi, &hs->resp_file, gz_uri)) {
+            hs->is_gzip = 1;
+            return 1;
+        }
+    }
+#endif /* HTTP_GZIP_STATIC_FILES */
+    return http_fs_data_open_file(hi, &hs->resp_file, uri);
+}
+
+#if HTTP_GZIP_STATIC_FILES
+/**
+ * \brief           Check if client accepts gzip content encoding
+ * \param[in]       p: Received request with headers
+ * \param[in]       hdr_end: Position of end of headers in request
+ * \return          `1` if gzip is accepted, `0` otherwise
+ */
+static uint8_t
+http_req_accept_gzip(esp_pbuf_p p, size_t hdr_end) {
+    size_t pos, pos_crlf;
+
+    if (((pos = esp_pbuf_strfind(p, "Accept-Encoding:", 0)) != ESP_SIZET_MAX && pos < hdr_end) ||
+        ((pos = esp_pbuf_strfind(p, "accept-encoding:", 0)) != ESP_SIZET_MAX && pos < hdr_end)) {
+        pos_crlf = esp_pbuf_strfind(p, CRLF, pos);
+        pos = esp_pbuf_strfind(p, "gzip", pos);
+        return pos != ESP_SIZET_MAX && pos < pos_crlf;
+    }
+    return 0;
+}
+#endif /* HTTP_GZIP_STATIC_FILES */
+
+#if HTTP_RESP_CACHE
+
+/**
+ * \brief           Free cache entry memory when entry is invalid and not used by any connection
+ * \param[in]       e: Cache entry
+ */
+static void
+http_cache_release(http_cache_entry_t* e) {
+    if (e->buff != NULL && !e->valid && e->ref == 0) {
+        esp_mem_free_s((void **)&e->buff);
+    }
+}
+
+/**
+ * \brief           Check if request URI matches URI without parameters
+ * \param[in]       req_uri: Request URI with optional parameters
+ * \param[in]       uri: URI without parameters
+ * \return          `1` on match, `0` otherwise
+ */
+static uint8_t
+http_cache_uri_match(const char* req_uri, const char* uri) {
+    size_t len = strlen(uri);
+
+    return !strncmp(req_uri, uri, len) && (req_uri[len] == '\0' || req_uri[len] == '?');
+}
+
+/**
+ * \brief           Append data to response captured for cache
+ *
+ *                  Capture is stopped when response does not fit to \ref HTTP_RESP_CACHE_MAX_LEN bytes
+ *
+ * \param[in]       hs: HTTP state
+ * \param[in]       data: Data to append
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+http_cache_capture(http_state_t* hs, const void* data, size_t len) {
+    uint8_t* buff;
+    size_t size;
+
+    if (hs->cache_buff_len + len > HTTP_RESP_CACHE_MAX_LEN) {
+        esp_mem_free_s((void **)&hs->cache_buff);   /* Response is sent normally */
+        return;
+    }
+    if (hs->cache_buff_len + len > hs->cache_buff_size) {
+        size = ESP_MIN(ESP_MAX(2 * hs->cache_buff_size, hs->cache_buff_len + len), HTTP_RESP_CACHE_MAX_LEN);
+        if ((buff = esp_mem_realloc(hs->cache_buff, size)) == NULL) {
+            esp_mem_free_s((void **)&hs->cache_buff);
+            return;
+        }
+        hs->cache_buff = buff;
+        hs->cache_buff_size = size;
+    }
+    ESP_MEMCPY(&hs->cache_buff[hs->cache_buff_len], data, len);
+    hs->cache_buff_len += len;
+}
+
+/**
+ * \brief           Open response from cache or start capture of cacheable response
+ * \param[in]       hs: HTTP state
+ * \param[in]       uri: Request URI with parameters
+ * \return          `1` if response is served from cache, `0` otherwise
+ */
+static uint8_t
+http_cache_open(http_state_t* hs, const char* uri) {
+    http_cache_entry_t* e;
+    uint32_t now = esp_sys_now();
+    size_t i, len;
+
+    for (i = 0; i < ESP_ARRAYSIZE(http_cache_entries); ++i) {
+        e = &http_cache_entries[i];
+        if (e->valid && e->ttl > 0 && (now - e->time) >= e->ttl) {
+            e->valid = 0;                       /* Entry expired */
+            http_cache_release(e);
+        }
+        if (e->valid && !strcmp((const char *)e->buff, uri)) {
+            ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] Response for %s served from cache\r\n", uri);
+            hs->resp_file.data = e->data;       /* Cached response is sent as static file */
+            hs->resp_file.size = e->len;
+            hs->resp_file.is_static = 1;
+            hs->resp_file_opened = 1;
+            hs->is_ssi = 0;
+            hs->cache_entry = e;
+            ++e->ref;
+            return 1;
+        }
+    }
+
+    /* Capture response of cacheable URI, starting with request URI as entry key */
+    if (hi != NULL && hi->cache != NULL) {
+        for (i = 0; i < hi->cache_count; ++i) {
+            if (http_cache_uri_match(uri, hi->cache[i].uri)) {
+                len = strlen(uri) + 1;
+                if ((hs->cache_buff = esp_mem_malloc_tag(len, ESP_MEM_TAG_HTTP)) != NULL) {
+                    ESP_MEMCPY(hs->cache_buff, uri, len);
+                    hs->cache_buff_len = len;
+                    hs->cache_buff_size = len;
+                    hs->cache_ttl = hi->cache[i].ttl;
+                    hs->cache_epoch = http_cache_epoch;
+                }
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Store fully captured response to cache
+ *
+ *                  Empty entry or oldest entry not used by any connection is replaced
+ *
+ * \param[in]       hs: HTTP state
+ */
+static void
+http_cache_store(http_state_t* hs) {
+    http_cache_entry_t* e, *victim = NULL;
+    size_t i, key_len, path_len;
+    uint8_t* buff;
+
+    if (hs->cache_epoch != http_cache_epoch) {  /* Invalidated while response was rendered */
+        esp_mem_free_s((void **)&hs->cache_buff);
+        return;
+    }
+    for (i = 0; i < ESP_ARRAYSIZE(http_cache_entries); ++i) {
+        e = &http_cache_entries[i];
+        if (e->valid && !strcmp((const char *)e->buff, (const char *)hs->cache_buff)) {
+            e->valid = 0;                       /* Replace response for the same URI */
+            http_cache_release(e);
+        }
+        if (e->ref > 0) {
+            continue;
+        }
+        if (e->buff == NULL) {
+            if (victim == NULL || victim->buff != NULL) {
+                victim = e;
+            }
+        } else if (victim == NULL || (victim->buff != NULL && (int32_t)(e->time - victim->time) < 0)) {
+            victim = e;
+        }
+    }
+    if (victim == NULL) {                       /* All entries are being sent */
+        esp_mem_free_s((void **)&hs->cache_buff);
+        return;
+    }
+    if (victim->buff != NULL) {
+        victim->valid = 0;
+        http_cache_release(victim);
+    }
+
+    /* Shrink buffer to length of response */
+    if ((buff = esp_mem_realloc(hs->cache_buff, hs->cache_buff_len)) == NULL) {
+        buff = hs->cache_buff;
+    }
+    hs->cache_buff = NULL;
+
+    key_len = strlen((const char *)buff) + 1;
+    path_len = strlen((const char *)&buff[key_len]) + 1;
+    victim->buff = buff;
+    victim->path = (const char *)&buff[key_len];
+    victim->data = &buff[key_len + path_len];
+    victim->len = hs->cache_buff_len - key_len - path_len;
+    victim->time = esp_sys_now();
+    victim->ttl = hs->cache_ttl;
+    victim->valid = 1;
+    ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] Response for %s stored to cache, %d bytes\r\n",
+        (const char *)buff, (int)victim->len);
+}
+
+/**
+ * \brief           Release cache entry used by response and free unfinished capture
+ * \param[in]       hs: HTTP state
+ */
+static void
+http_cache_close(http_state_t* hs) {
+    if (hs->cache_entry != NULL) {
+        --hs->cache_entry->ref;
+        http_cache_release(hs->cache_entry);
+        hs->cache_entry = NULL;
+    }
+    if (hs->cache_buff != NULL) {
+        esp_mem_free_s((void **)&hs->cache_buff);
+    }
+}
+
+#endif /* HTTP_RESP_CACHE */
+
 /**
  * \brief           Get file from uri in format /folder/file?param1=value1&...
  * \param[in]       hs: HTTP state
@@ -423,6 +1050,14 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
     size_t uri_len;
 
     ESP_MEMSET(&hs->resp_file, 0x00, sizeof(hs->resp_file));
+#if HTTP_RESP_CACHE
+    if (http_cache_open(hs, uri)) {             /* Repeat request is served without SSI and CGI processing */
+#if HTTP_DYNAMIC_HEADERS
+        prepare_dynamic_headers(hs, hs->cache_entry->path);
+#endif /* HTTP_DYNAMIC_HEADERS */
+        return 1;
+    }
+#endif /* HTTP_RESP_CACHE */
     uri_len = strlen(uri);                      /* Get URI total length */
     if ((uri_len == 1 && uri[0] == '/') ||      /* Index file only requested */
         (uri_len > 1 && uri[0] == '/' && uri[1] == '?')) {  /* Index file + parameters */
@@ -432,7 +1067,7 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
          * available to return as main file
          */
         for (i = 0; i < ESP_ARRAYSIZE(http_index_filenames); ++i) {
-            hs->resp_file_opened = http_fs_data_open_file(hi, &hs->resp_file, http_index_filenames[i]); /* Give me a file with desired path */
+            hs->resp_file_opened = http_open_file(hs, http_index_filenames[i]); /* Give me a file with desired path */
             if (hs->resp_file_opened) {         /* Do we have a file? */
                 uri = http_index_filenames[i];  /* Set new URI for next of this func */
                 break;
@@ -455,14 +1090,22 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
 
         params_len = http_get_params(req_params);   /* Get request params from request */
         if (hi != NULL && hi->cgi != NULL) {    /* Check if any user specific controls to process */
+#if HTTP_SORTED_URI_TABLES
+            const http_cgi_t* cgi;
+            cgi = bsearch(uri, hi->cgi, hi->cgi_count, sizeof(*hi->cgi), http_cgi_cmp);
+            if (cgi != NULL) {
+                uri = cgi->fn(http_params, params_len);
+            }
+#else /* HTTP_SORTED_URI_TABLES */
             for (size_t i = 0; i < hi->cgi_count; ++i) {
                 if (!strcmp(hi->cgi[i].uri, uri)) {
                     uri = hi->cgi[i].fn(http_params, params_len);
                     break;
                 }
             }
+#endif /* !HTTP_SORTED_URI_TABLES */
         }
-        hs->resp_file_opened = http_fs_data_open_file(hi, &hs->resp_file, uri); /* Give me a new file now */
+        hs->resp_file_opened = http_open_file(hs, uri); /* Give me a new file now */
     }
 
     /*
@@ -472,7 +1115,7 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
     if (!hs->resp_file_opened) {
         for (size_t i = 0; i < ESP_ARRAYSIZE(http_404_uris); ++i) {
             uri = http_404_uris[i];
-            hs->resp_file_opened = http_fs_data_open_file(hi, &hs->resp_file, uri); /* Get 404 error page */
+            hs->resp_file_opened = http_open_file(hs, uri); /* Get 404 error page */
             if (hs->resp_file_opened) {
                 break;
             }
@@ -483,7 +1126,12 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
      * Check if SSI should be supported on this file
      */
     hs->is_ssi = 0;                             /* By default no SSI is supported */
-    if (hs->resp_file_opened) {
+#if HTTP_GZIP_STATIC_FILES
+    if (hs->resp_file_opened && !hs->is_gzip)   /* Compressed file cannot be parsed */
+#else /* HTTP_GZIP_STATIC_FILES */
+    if (hs->resp_file_opened)
+#endif /* !HTTP_GZIP_STATIC_FILES */
+    {
         size_t uri_len, suffix_len;
         const char* suffix;
 
@@ -498,6 +1146,15 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
             }
         }
     }
+#if HTTP_RESP_CACHE
+    if (hs->cache_buff != NULL) {
+        if (hs->is_ssi) {
+            http_cache_capture(hs, uri, strlen(uri) + 1);   /* File path gives content type of cached response */
+        } else {
+            esp_mem_free_s((void **)&hs->cache_buff);   /* Only rendered SSI output is cached */
+        }
+    }
+#endif /* HTTP_RESP_CACHE */
 
 #if HTTP_DYNAMIC_HEADERS
     /*
@@ -518,24 +1175,70 @@ http_get_file_from_uri(http_state_t* hs, const char* uri) {
  * \param[in]       hs: HTTP state context
  * \param[in]       pbuf: Pbuf with received data
  * \param[in]       offset: Offset in pbuf where to start reading the buffer
+ * \return          Result of user callback function, \ref espOK if data were not sent
  */
-static void
+static espr_t
 http_post_send_to_user(http_state_t* hs, esp_pbuf_p pbuf, size_t offset) {
     esp_pbuf_p new_pbuf;
 
     if (hi == NULL || hi->post_data_fn == NULL) {
-        return;
+        return espOK;
     }
 
     new_pbuf = esp_pbuf_skip(pbuf, offset, &offset);    /* Skip pbufs and create this one */
     if (new_pbuf != NULL) {
         esp_pbuf_advance(new_pbuf, offset);     /* Advance pbuf for remaining bytes */
 
-        hi->post_data_fn(hs, new_pbuf);         /* Notify user with data */
+        return hi->post_data_fn(hs, new_pbuf);  /* Notify user with data */
+    }
+    return espOK;
+}
+
+#if HTTP_POST_FLOW_CONTROL
+/**
+ * \brief           Acknowledge POST data consumed by application to stack
+ * \note            Core must be locked when calling this function
+ * \param[in]       hs: HTTP state
+ */
+static void
+http_post_release(http_state_t* hs) {
+    if (hs->p_post != NULL) {
+        esp_conn_recved(hs->conn, hs->p_post);  /* Allow stack to read more data */
+        esp_pbuf_free(hs->p_post);
+        hs->p_post = NULL;
     }
 }
+#endif /* HTTP_POST_FLOW_CONTROL */
 #endif /* HTTP_SUPPORT_POST */
 
+/**
+ * \brief           Allocate memory and read next block of non-static response file
+ * \param[in]       hs: HTTP state
+ * \param[in]       len: Number of remaining bytes in file
+ * \param[out]      buff_len: Pointer to output variable to save length of block
+ * \return          Pointer to allocated block on success, `NULL` otherwise
+ */
+static const uint8_t*
+read_resp_file_block(http_state_t* hs, uint32_t len, uint32_t* buff_len) {
+    uint8_t* buff;
+
+    if (len > ESP_CFG_CONN_MAX_DATA_LEN) {      /* Limit to maximal length */
+        len = ESP_CFG_CONN_MAX_DATA_LEN;
+    }
+    do {
+        buff = esp_mem_malloc_tag(sizeof(*buff) * len, ESP_MEM_TAG_HTTP);
+        if (buff != NULL) {                     /* Is memory ready? */
+            /* Read file directly and stop everything */
+            if (!http_fs_data_read_file(hi, &hs->resp_file, (void **)&buff, len, NULL)) {
+                esp_mem_free_s((void **)&buff);
+            }
+            break;
+        }
+    } while ((len >>= 1) > 64);
+    *buff_len = len;
+    return buff;
+}
+
 /**
  * \brief           Read next part of response file
  * \param[in]       hs: HTTP state
@@ -557,6 +1260,13 @@ read_resp_file(http_state_t* hs) {
         }
         hs->buff = NULL;                        /* ...and reset pointer */
     }
+#if HTTP_FS_READ_AHEAD
+    if (hs->buff_next != NULL) {                /* Use block read during previous send */
+        hs->buff = hs->buff_next;
+        hs->buff_len = hs->buff_next_len;
+        hs->buff_next = NULL;
+    }
+#endif /* HTTP_FS_READ_AHEAD */
 
     /*
      * Is buffer set to NULL?
@@ -573,21 +1283,7 @@ read_resp_file(http_state_t* hs) {
                     hs->buff = NULL;            /* Reset buffer */
                 }
             } else {
-                if (len > ESP_CFG_CONN_MAX_DATA_LEN) {  /* Limit to maximal length */
-                    len = ESP_CFG_CONN_MAX_DATA_LEN;
-                }
-                hs->buff_ptr = 0;               /* Reset read pointer */
-                do {
-                    hs->buff_len = len;
-                    hs->buff = (const void *)esp_mem_malloc(sizeof(*hs->buff) * hs->buff_len);
-                    if (hs->buff != NULL) {     /* Is memory ready? */
-                        /* Read file directly and stop everything */
-                        if (!http_fs_data_read_file(hi, &hs->resp_file, (void **)&hs->buff, hs->buff_len, NULL)) {
-                            esp_mem_free_s((void **)&hs->buff);
-                        }
-                        break;
-                    }
-                } while ((len >>= 1) > 64);
+                hs->buff = read_resp_file_block(hs, len, &hs->buff_len);
             }
         }
     }
@@ -595,6 +1291,81 @@ read_resp_file(http_state_t* hs) {
     return hs->buff != NULL;                    /* Do we have our memory ready? */
 }
 
+#if HTTP_FS_READ_AHEAD
+/**
+ * \brief           Read next block of non-static response file while current one is sent
+ * \param[in]       hs: HTTP state
+ */
+static void
+read_resp_file_ahead(http_state_t* hs) {
+    uint32_t len;
+
+    if (!hs->resp_file_opened || hs->resp_file.is_static || hs->buff_next != NULL) {
+        return;
+    }
+    len = http_fs_data_read_file(hi, &hs->resp_file, NULL, 0, NULL);
+    if (len > 0) {
+        hs->buff_next = read_resp_file_block(hs, len, &hs->buff_next_len);
+    }
+}
+#endif /* HTTP_FS_READ_AHEAD */
+
+/**
+ * \brief           Write response content to connection output buffer
+ *
+ *                  On chunked response, data are written as single chunk.
+ *                  Chunk header and trailer are copied to the same write buffer as data,
+ *                  so framing does not need additional send command
+ *
+ * \param[in]       hs: HTTP state
+ * \param[in]       data: Data to write
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+http_write_resp(http_state_t* hs, const void* data, size_t len) {
+#if HTTP_RESP_CACHE
+    if (hs->cache_buff != NULL) {
+        http_cache_capture(hs, data, len);
+    }
+#endif /* HTTP_RESP_CACHE */
+#if HTTP_CHUNKED_ENCODING
+    if (hs->chunked) {
+        esp_iovec_t iov[3];
+        char chunk_hdr[sizeof(size_t) * 2 + 3];
+
+        if (len == 0) {                         /* Empty chunk marks end of response */
+            return;
+        }
+        iov[0].data = chunk_hdr;
+        iov[0].len = sprintf(chunk_hdr, "%X" CRLF, (unsigned)len);
+        iov[1].data = data;
+        iov[1].len = len;
+        iov[2].data = CRLF;
+        iov[2].len = 2;
+        esp_conn_writev(hs->conn, iov, ESP_ARRAYSIZE(iov), 0, &hs->conn_mem_available);
+        hs->written_total += iov[0].len + len + 2;
+        return;
+    }
+#endif /* HTTP_CHUNKED_ENCODING */
+    esp_conn_write(hs->conn, data, len, 0, &hs->conn_mem_available);
+    hs->written_total += len;
+}
+
+#if HTTP_CHUNKED_ENCODING
+/**
+ * \brief           Write last chunk of chunked response and flush output
+ * \param[in]       hs: HTTP state
+ */
+static void
+http_write_resp_end(http_state_t* hs) {
+    static const char last_chunk[] = "0" CRLF CRLF;
+
+    esp_conn_write(hs->conn, last_chunk, sizeof(last_chunk) - 1, 1, &hs->conn_mem_available);
+    hs->written_total += sizeof(last_chunk) - 1;
+    hs->chunked_end = 1;
+}
+#endif /* HTTP_CHUNKED_ENCODING */
+
 /**
  * \brief           Send response using SSI processing
  * \param[in]       hs: HTTP state
@@ -617,8 +1388,7 @@ send_response_ssi(http_state_t* hs) {
         size_t len;
         len = ESP_MIN(hs->ssi_tag_buff_ptr - hs->ssi_tag_buff_written, hs->conn_mem_available);
         if (len > 0) {                              /* More data to send? */
-            esp_conn_write(hs->conn, &hs->ssi_tag_buff[hs->ssi_tag_buff_written], len, 0, &hs->conn_mem_available);
-            hs->written_total += len;           /* Increase total number of written elements */
+            http_write_resp(hs, &hs->ssi_tag_buff[hs->ssi_tag_buff_written], len);
             hs->ssi_tag_buff_written += len;    /* Increase total number of written SSI buffer */
 
             if (hs->ssi_tag_buff_written == hs->ssi_tag_buff_ptr) {
@@ -638,6 +1408,26 @@ send_response_ssi(http_state_t* hs) {
      */
     if (hs->buff != NULL) {
         while (hs->buff_ptr < hs->buff_len && hs->conn_mem_available) { /* Process entire buffer if possible */
+            /*
+             * Outside of tag, send literal run up to next possible tag start in one write,
+             * character by character processing is only needed around tags
+             */
+            if (hs->ssi_state == HTTP_SSI_STATE_WAIT_BEGIN) {
+                const uint8_t* tag_start;
+                size_t len;
+
+                len = hs->buff_len - hs->buff_ptr;
+                tag_start = memchr(&hs->buff[hs->buff_ptr], HTTP_SSI_TAG_START[0], len);
+                if (tag_start != NULL) {
+                    len = (size_t)(tag_start - &hs->buff[hs->buff_ptr]);
+                }
+                len = ESP_MIN(len, hs->conn_mem_available);
+                if (len > 0) {
+                    http_write_resp(hs, &hs->buff[hs->buff_ptr], len);
+                    hs->buff_ptr += len;
+                    continue;
+                }
+            }
             ch = hs->buff[hs->buff_ptr];        /* Get next character */
             switch (hs->ssi_state) {
                 case HTTP_SSI_STATE_WAIT_BEGIN: {
@@ -659,6 +1449,9 @@ send_response_ssi(http_state_t* hs) {
                         if (hs->ssi_tag_buff_ptr == HTTP_SSI_TAG_START_LEN) {
                             hs->ssi_state = HTTP_SSI_STATE_TAG;
                             hs->ssi_tag_len = 0;
+#if HTTP_SSI_HASH_SIZE > 0
+                            hs->ssi_tag_hash = HTTP_SSI_HASH_INIT;
+#endif /* HTTP_SSI_HASH_SIZE > 0 */
                         }
                     } else {
                         reset = 1;
@@ -674,6 +1467,9 @@ send_response_ssi(http_state_t* hs) {
                             hs->ssi_tag_buff[hs->ssi_tag_buff_ptr] = ch;
                             ++hs->ssi_tag_buff_ptr;
                             ++hs->ssi_tag_len;
+#if HTTP_SSI_HASH_SIZE > 0
+                            hs->ssi_tag_hash = HTTP_SSI_HASH_STEP(hs->ssi_tag_hash, ch);
+#endif /* HTTP_SSI_HASH_SIZE > 0 */
                         } else {
                             reset = 1;
                         }
@@ -691,9 +1487,20 @@ send_response_ssi(http_state_t* hs) {
                             hs->ssi_tag_buff[HTTP_SSI_TAG_START_LEN + hs->ssi_tag_len] = 0;
 
                             hs->ssi_tag_process_more = 0;
-                            if (hi != NULL && hi->ssi_fn != NULL) {
-                                /* Call user function */
-                                hs->ssi_tag_process_more = !hi->ssi_fn(hs, &hs->ssi_tag_buff[HTTP_SSI_TAG_START_LEN], hs->ssi_tag_len);
+                            if (hi != NULL) {
+                                http_ssi_fn ssi_fn = hi->ssi_fn;
+#if HTTP_SSI_HASH_SIZE > 0
+                                const http_ssi_t* ssi;
+
+                                /* Tag handler from table takes precedence over global callback */
+                                if ((ssi = http_ssi_find(hs->ssi_tag_hash, &hs->ssi_tag_buff[HTTP_SSI_TAG_START_LEN])) != NULL) {
+                                    ssi_fn = ssi->fn;
+                                }
+#endif /* HTTP_SSI_HASH_SIZE > 0 */
+                                if (ssi_fn != NULL) {
+                                    /* Call user function */
+                                    hs->ssi_tag_process_more = !ssi_fn(hs, &hs->ssi_tag_buff[HTTP_SSI_TAG_START_LEN], hs->ssi_tag_len);
+                                }
                             }
                             hs->ssi_state = HTTP_SSI_STATE_WAIT_BEGIN;
                             hs->ssi_tag_len = 0;
@@ -714,16 +1521,14 @@ send_response_ssi(http_state_t* hs) {
                     size_t len;
 
                     len = ESP_MIN(hs->ssi_tag_buff_ptr, hs->conn_mem_available);
-                    esp_conn_write(hs->conn, hs->ssi_tag_buff, len, 0, &hs->conn_mem_available);
-                    hs->written_total += len;   /* Increase total written length */
+                    http_write_resp(hs, hs->ssi_tag_buff, len);
                     hs->ssi_tag_buff_written = len; /* Set length of number of written buffer */
                     if (len == hs->ssi_tag_buff_ptr) {
                         hs->ssi_tag_buff_ptr = 0;
                     }
                 }
                 if (hs->conn_mem_available > 0) {   /* Is there memory to write a current byte? */
-                    esp_conn_write(hs->conn, &ch, 1, 0, &hs->conn_mem_available);
-                    ++hs->written_total;
+                    http_write_resp(hs, &ch, 1);
                     ++hs->buff_ptr;
                 }
                 hs->ssi_state = HTTP_SSI_STATE_WAIT_BEGIN;
@@ -735,6 +1540,107 @@ send_response_ssi(http_state_t* hs) {
     esp_conn_write(hs->conn, NULL, 0, 1, &hs->conn_mem_available);  /* Flush to output if possible */
 }
 
+/**
+ * \brief           Close response file and free its buffer
+ * \param[in]       hs: HTTP state
+ */
+static void
+http_close_resp_file(http_state_t* hs) {
+    if (hs->resp_file_opened) {                 /* Is file opened? */
+        uint8_t is_static = hs->resp_file.is_static;
+        http_fs_data_close_file(hi, &hs->resp_file);    /* Close file at this point */
+        if (!is_static && hs->buff != NULL) {
+            esp_mem_free_s((void **)&hs->buff);
+        }
+#if HTTP_FS_READ_AHEAD
+        if (hs->buff_next != NULL) {
+            esp_mem_free_s((void **)&hs->buff_next);
+        }
+#endif /* HTTP_FS_READ_AHEAD */
+        hs->resp_file_opened = 0;               /* File is not opened anymore */
+    }
+#if HTTP_RESP_CACHE
+    http_cache_close(hs);
+#endif /* HTTP_RESP_CACHE */
+}
+
+#if HTTP_KEEP_ALIVE
+
+/**
+ * \brief           Check if client requested persistent connection
+ * \param[in]       p: Received request with headers
+ * \param[in]       hdr_end: Position of end of headers in request
+ * \return          `1` if connection shall stay opened, `0` otherwise
+ */
+static uint8_t
+http_req_keep_alive(esp_pbuf_p p, size_t hdr_end) {
+    size_t pos, pos_crlf;
+
+    /* Persistent connection is default for HTTP/1.1 requests only */
+    pos_crlf = esp_pbuf_strfind(p, CRLF, 0);
+    pos = esp_pbuf_strfind(p, " HTTP/1.1" CRLF, 0);
+    if (pos == ESP_SIZET_MAX || (pos + 9) != pos_crlf) {
+        return 0;
+    }
+
+    /* Check if client wants to close connection after response */
+    if (((pos = esp_pbuf_strfind(p, "Connection: close", 0)) != ESP_SIZET_MAX && pos < hdr_end) ||
+        ((pos = esp_pbuf_strfind(p, "connection: close", 0)) != ESP_SIZET_MAX && pos < hdr_end)) {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Finish request on persistent connection and process next pipelined request
+ * \param[in]       hs: HTTP state
+ */
+static void
+http_next_request(http_state_t* hs) {
+    esp_conn_p conn = hs->conn;
+    esp_pbuf_p next = hs->p_next;
+    void* arg = hs->arg;
+    size_t len;
+
+    ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] Response finished, keeping connection alive\r\n");
+
+    /* Data after current request belong to next request */
+    if (hs->p != NULL) {
+        len = esp_pbuf_length(hs->p, 1);
+        if (len > hs->req_len) {
+            esp_pbuf_p rem;
+
+            len -= hs->req_len;
+            if ((rem = esp_pbuf_new(len)) == NULL) {
+                esp_conn_close(conn, 0);        /* Resources are freed on close event */
+                return;
+            }
+            esp_pbuf_copy(hs->p, esp_pbuf_data(rem), len, hs->req_len);
+            if (next != NULL) {
+                esp_pbuf_cat(rem, next);        /* Queued references are moved to new chain */
+            }
+            next = rem;
+        }
+        esp_pbuf_free(hs->p);
+    }
+#if HTTP_POST_FLOW_CONTROL
+    http_post_release(hs);                      /* Connection is reused, data must be acknowledged */
+#endif /* HTTP_POST_FLOW_CONTROL */
+    http_close_resp_file(hs);
+
+    /* Start with clean state for next request */
+    ESP_MEMSET(hs, 0x00, sizeof(*hs));
+    hs->conn = conn;
+    hs->arg = arg;
+
+    if (next != NULL) {
+        http_recv(hs, next);
+        esp_pbuf_free(next);                    /* State keeps its own reference */
+    }
+}
+
+#endif /* HTTP_KEEP_ALIVE */
+
 /**
  * \brief           Send more data without SSI tags parsing
  * \param[in]       hs: HTTP state
@@ -775,6 +1681,9 @@ send_response_no_ssi(http_state_t* hs) {
         if (blen > 0) {
             if (esp_conn_send(hs->conn, b, blen, NULL, 0) == espOK) {
                 hs->written_total += blen;      /* Set written total length */
+#if HTTP_FS_READ_AHEAD
+                read_resp_file_ahead(hs);       /* Read next block while this one is sent */
+#endif /* HTTP_FS_READ_AHEAD */
             }
         }
     }
@@ -788,6 +1697,9 @@ send_response_no_ssi(http_state_t* hs) {
 static void
 send_response(http_state_t* hs, uint8_t ft) {
     uint8_t close = 0;
+#if HTTP_KEEP_ALIVE
+    uint8_t finished = 0;
+#endif /* HTTP_KEEP_ALIVE */
 
     if (!hs->process_resp ||                    /* Not yet ready to process response? */
         (hs->written_total > 0 && hs->written_total != hs->sent_total)) {   /* Did we wrote something but didn't send yet? */
@@ -809,6 +1721,21 @@ send_response(http_state_t* hs, uint8_t ft) {
             send_dynamic_headers(hs);           /* Send dynamic headers to output */
             send_dyn_head = 1;
         }
+#if HTTP_ETAG
+        if (hs->not_modified) {
+            /* Response has headers only, finish it once they are sent */
+            if (hs->dyn_hdr_idx >= HTTP_MAX_HEADERS && !send_dyn_head && hs->written_total == hs->sent_total) {
+#if HTTP_KEEP_ALIVE
+                if (hs->keep_alive) {
+                    finished = 1;
+                } else
+#endif /* HTTP_KEEP_ALIVE */
+                {
+                    close = 1;
+                }
+            }
+        } else
+#endif /* HTTP_ETAG */
         if (hs->dyn_hdr_idx >= HTTP_MAX_HEADERS)
 #endif /* HTTP_DYNAMIC_HEADERS */
         {
@@ -826,7 +1753,26 @@ send_response(http_state_t* hs, uint8_t ft) {
              * Currently this is a solution to close the file
              */
             if (hs->buff == NULL) {             /* Sent everything or problem somehow? */
-                close = 1;
+#if HTTP_RESP_CACHE
+                if (hs->cache_buff != NULL && !http_fs_data_read_file(hi, &hs->resp_file, NULL, 0, NULL)) {
+                    http_cache_store(hs);       /* Entire response was rendered */
+                }
+#endif /* HTTP_RESP_CACHE */
+#if HTTP_CHUNKED_ENCODING
+                /* Terminate chunked response first and finish it once sent */
+                if (hs->chunked && !hs->chunked_end && !http_fs_data_read_file(hi, &hs->resp_file, NULL, 0, NULL)) {
+                    http_write_resp_end(hs);
+                } else
+#endif /* HTTP_CHUNKED_ENCODING */
+#if HTTP_KEEP_ALIVE
+                /* Keep connection only when entire file was sent */
+                if (hs->keep_alive && !http_fs_data_read_file(hi, &hs->resp_file, NULL, 0, NULL)) {
+                    finished = 1;
+                } else
+#endif /* HTTP_KEEP_ALIVE */
+                {
+                    close = 1;
+                }
             }
         }
 #if HTTP_DYNAMIC_HEADERS
@@ -863,6 +1809,576 @@ send_response(http_state_t* hs, uint8_t ft) {
     if (close) {
         esp_conn_close(hs->conn, 0);            /* Close the connection as no file opened in this case */
     }
+#if HTTP_KEEP_ALIVE
+    else if (finished) {
+        http_next_request(hs);                  /* Wait for or process next request */
+    }
+#endif /* HTTP_KEEP_ALIVE */
+}
+
+#if HTTP_WEBSOCKET
+
+/** WebSocket key magic string from RFC 6455 */
+#define HTTP_WS_GUID                "258EAFA5-E914-47DA-95CA-C5AB0DC11B85"
+
+/** Length of base64 encoded 16-byte `Sec-WebSocket-Key` value */
+#define HTTP_WS_KEY_LEN             24
+
+/** Rotate 32-bit value left */
+#define HTTP_WS_ROL(x, n)           (((x) << (n)) | ((x) >> (32 - (n))))
+
+/** Unmasked payload of currently processed frame */
+static uint8_t http_ws_frame[HTTP_WS_MAX_FRAME_LEN];
+
+/**
+ * \brief           Calculate SHA-1 digest of short message
+ * \note            Message must be shorter than `120` bytes, enough for key with magic string
+ * \param[in]       data: Message to hash
+ * \param[in]       len: Length of message in units of bytes
+ * \param[out]      digest: Output buffer of `20` bytes
+ */
+static void
+http_ws_sha1(const uint8_t* data, size_t len, uint8_t* digest) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    uint32_t w[16], a, b, c, d, e, f, k, t;
+    uint8_t msg[128];
+    size_t blocks, i, j;
+
+    /* Pad message with single bit and message length in bits */
+    blocks = (len + 9 + 63) / 64;
+    ESP_MEMSET(msg, 0x00, sizeof(msg));
+    ESP_MEMCPY(msg, data, len);
+    msg[len] = 0x80;
+    msg[blocks * 64 - 2] = ESP_U8(len >> 5);
+    msg[blocks * 64 - 1] = ESP_U8(len << 3);
+
+    for (i = 0; i < blocks; ++i) {
+        a = h[0]; b = h[1]; c = h[2]; d = h[3]; e = h[4];
+        for (j = 0; j < 80; ++j) {
+            if (j < 16) {
+                w[j] = ESP_U32(msg[i * 64 + j * 4]) << 24 | ESP_U32(msg[i * 64 + j * 4 + 1]) << 16
+                    | ESP_U32(msg[i * 64 + j * 4 + 2]) << 8 | ESP_U32(msg[i * 64 + j * 4 + 3]);
+            } else {                            /* Message schedule is kept in rolling window */
+                t = w[(j + 13) & 0x0F] ^ w[(j + 8) & 0x0F] ^ w[(j + 2) & 0x0F] ^ w[j & 0x0F];
+                w[j & 0x0F] = HTTP_WS_ROL(t, 1);
+            }
+            if (j < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (j < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (j < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            t = HTTP_WS_ROL(a, 5) + f + e + k + w[j & 0x0F];
+            e = d; d = c; c = HTTP_WS_ROL(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (i = 0; i < 20; ++i) {
+        digest[i] = ESP_U8(h[i >> 2] >> (24 - 8 * (i & 0x03)));
+    }
+}
+
+/**
+ * \brief           Encode data to base64 string
+ * \param[in]       data: Data to encode
+ * \param[in]       len: Length of data in units of bytes
+ * \param[out]      out: Output buffer for `4 * ((len + 2) / 3) + 1` characters
+ */
+static void
+http_ws_base64(const uint8_t* data, size_t len, char* out) {
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint32_t v;
+    size_t i;
+
+    for (i = 0; i < len; i += 3) {
+        v = ESP_U32(data[i]) << 16;
+        if (i + 1 < len) {
+            v |= ESP_U32(data[i + 1]) << 8;
+        }
+        if (i + 2 < len) {
+            v |= ESP_U32(data[i + 2]);
+        }
+        *out++ = b64[(v >> 18) & 0x3F];
+        *out++ = b64[(v >> 12) & 0x3F];
+        *out++ = i + 1 < len ? b64[(v >> 6) & 0x3F] : '=';
+        *out++ = i + 2 < len ? b64[v & 0x3F] : '=';
+    }
+    *out = 0;
+}
+
+/**
+ * \brief           Write single unmasked WebSocket frame to connection and flush it
+ * \param[in]       hs: HTTP state
+ * \param[in]       opcode: Frame opcode
+ * \param[in]       data: Frame payload
+ * \param[in]       len: Length of payload, up to `0xFFFF` bytes
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+http_ws_write_frame(http_state_t* hs, http_ws_opcode_t opcode, const void* data, size_t len) {
+    esp_iovec_t iov[2];
+    uint8_t hdr[4];
+
+    hdr[0] = 0x80 | ESP_U8(opcode);             /* Server sends unfragmented messages only */
+    if (len < 126) {
+        hdr[1] = ESP_U8(len);
+        iov[0].len = 2;
+    } else {
+        hdr[1] = 126;                           /* 16-bit extended payload length */
+        hdr[2] = ESP_U8(len >> 8);
+        hdr[3] = ESP_U8(len);
+        iov[0].len = 4;
+    }
+    iov[0].data = hdr;
+    iov[1].data = data;
+    iov[1].len = len;
+    return esp_conn_writev(hs->conn, iov, len > 0 ? 2 : 1, 1, &hs->conn_mem_available);
+}
+
+/**
+ * \brief           Send close frame with status code and close connection
+ * \param[in]       hs: HTTP state
+ * \param[in]       code: Close status code, `1000` for normal closure
+ */
+static void
+http_ws_close(http_state_t* hs, uint16_t code) {
+    uint8_t status[2];
+
+    if (hs->ws_closing) {
+        return;
+    }
+    status[0] = ESP_U8(code >> 8);
+    status[1] = ESP_U8(code);
+    http_ws_write_frame(hs, HTTP_WS_OPCODE_CLOSE, status, sizeof(status));
+    esp_conn_close(hs->conn, 0);                /* Resources are freed on close event */
+    hs->ws_closing = 1;
+}
+
+/**
+ * \brief           Process received data on WebSocket connection
+ *
+ *                  Data are kept in `p` chain until full frame is received
+ *
+ * \param[in]       hs: HTTP state
+ * \param[in]       p: Received packet buffer
+ * \return          `1` if received data may be acknowledged to stack, `0` if application still holds them
+ */
+static uint8_t
+http_ws_recv(http_state_t* hs, esp_pbuf_p p) {
+    http_ws_opcode_t opcode;
+    uint8_t b0, b1, mask[4];
+    size_t tot, pos = 0, hdr, len, i;
+
+    if (hs->ws_closing) {                       /* Data after close are ignored */
+        return 1;
+    }
+    if (hs->p == NULL) {
+        hs->p = p;
+    } else {
+        esp_pbuf_cat(hs->p, p);
+    }
+    esp_pbuf_ref(p);
+
+    tot = esp_pbuf_length(hs->p, 1);
+    while (!hs->ws_closing && tot - pos >= 2) {
+        esp_pbuf_get_at(hs->p, pos, &b0);
+        esp_pbuf_get_at(hs->p, pos + 1, &b1);
+        opcode = (http_ws_opcode_t)(b0 & 0x0F);
+        len = b1 & 0x7F;
+        hdr = 2;
+        if (len == 126) {
+            uint8_t lh, ll;
+
+            if (tot - pos < 4) {
+                break;
+            }
+            esp_pbuf_get_at(hs->p, pos + 2, &lh);
+            esp_pbuf_get_at(hs->p, pos + 3, &ll);
+            len = ESP_SZ(lh) << 8 | ESP_SZ(ll);
+            hdr = 4;
+        }
+
+        /* Client frames must be masked, control frames must be short and unfragmented */
+        if (!(b1 & 0x80) || (b0 & 0x70) || ((opcode & 0x08) && (len > 125 || !(b0 & 0x80)))) {
+            ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE_WARNING, "[HTTP SERVER] Invalid WebSocket frame, closing connection\r\n");
+            http_ws_close(hs, 1002);
+            break;
+        }
+        if ((b1 & 0x7F) == 127 || len > HTTP_WS_MAX_FRAME_LEN) {
+            ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE_WARNING, "[HTTP SERVER] WebSocket frame too long, closing connection\r\n");
+            http_ws_close(hs, 1009);
+            break;
+        }
+        if (tot - pos < hdr + 4 + len) {        /* Wait for the rest of frame */
+            break;
+        }
+
+        /* Copy payload to linear buffer and unmask it */
+        esp_pbuf_copy(hs->p, mask, sizeof(mask), pos + hdr);
+        esp_pbuf_copy(hs->p, http_ws_frame, len, pos + hdr + 4);
+        for (i = 0; i < len; ++i) {
+            http_ws_frame[i] ^= mask[i & 0x03];
+        }
+        pos += hdr + 4 + len;
+
+        switch (opcode) {
+            case HTTP_WS_OPCODE_CONT:
+            case HTTP_WS_OPCODE_TEXT:
+            case HTTP_WS_OPCODE_BINARY: {
+                if (hi->ws_data_fn != NULL
+                    && hi->ws_data_fn(hs, opcode, http_ws_frame, len, (b0 & 0x80) != 0) != espOK) {
+                    http_ws_close(hs, 1000);
+                }
+                break;
+            }
+            case HTTP_WS_OPCODE_PING: {
+                http_ws_write_frame(hs, HTTP_WS_OPCODE_PONG, http_ws_frame, len);
+                break;
+            }
+            case HTTP_WS_OPCODE_PONG: {
+                break;
+            }
+            case HTTP_WS_OPCODE_CLOSE: {
+                ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] WebSocket close requested by client\r\n");
+                http_ws_close(hs, 1000);
+                break;
+            }
+            default: {
+                http_ws_close(hs, 1002);        /* Unknown opcode */
+                break;
+            }
+        }
+    }
+
+    /* Keep only part of frame not yet received in full */
+    if (hs->ws_closing || pos == tot) {
+        esp_pbuf_free(hs->p);
+        hs->p = NULL;
+    } else if (pos > 0) {
+        esp_pbuf_p rem;
+
+        if ((rem = esp_pbuf_new(tot - pos)) != NULL) {
+            esp_pbuf_copy(hs->p, esp_pbuf_data(rem), tot - pos, pos);
+        }
+        esp_pbuf_free(hs->p);
+        hs->p = rem;
+        if (rem == NULL) {
+            http_ws_close(hs, 1011);
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Check for WebSocket upgrade request and switch protocols
+ * \param[in]       hs: HTTP state with received GET request in `p` chain
+ * \param[in]       hdr_end: Position of end of headers in request
+ * \return          `1` if connection was upgraded to WebSocket, `0` otherwise
+ */
+static uint8_t
+http_ws_upgrade(http_state_t* hs, size_t hdr_end) {
+    static const char resp[] = ""
+        "HTTP/1.1 101 Switching Protocols" CRLF
+        "Upgrade: websocket" CRLF
+        "Connection: Upgrade" CRLF
+        "Sec-WebSocket-Accept: ";
+    uint8_t key[HTTP_WS_KEY_LEN + sizeof(HTTP_WS_GUID) - 1], digest[20], ch;
+    char accept[4 * ((sizeof(digest) + 2) / 3) + 1];
+    esp_iovec_t iov[3];
+    esp_pbuf_p rem = NULL;
+    size_t pos, len;
+
+    if (hi == NULL || hi->ws_connect_fn == NULL) {
+        return 0;
+    }
+
+    /* Check for upgrade header and get client key */
+    if ((((pos = esp_pbuf_strfind(hs->p, "Upgrade: websocket", 0)) == ESP_SIZET_MAX || pos > hdr_end) &&
+        ((pos = esp_pbuf_strfind(hs->p, "upgrade: websocket", 0)) == ESP_SIZET_MAX || pos > hdr_end))) {
+        return 0;
+    }
+    if ((((pos = esp_pbuf_strfind(hs->p, "Sec-WebSocket-Key:", 0)) == ESP_SIZET_MAX || pos > hdr_end) &&
+        ((pos = esp_pbuf_strfind(hs->p, "sec-websocket-key:", 0)) == ESP_SIZET_MAX || pos > hdr_end))) {
+        return 0;
+    }
+    for (pos += 18; esp_pbuf_get_at(hs->p, pos, &ch) && ch == ' '; ++pos) {}
+    if (esp_pbuf_copy(hs->p, key, HTTP_WS_KEY_LEN, pos) != HTTP_WS_KEY_LEN
+        || !esp_pbuf_get_at(hs->p, pos + HTTP_WS_KEY_LEN, &ch) || ch != '\r') {
+        return 0;
+    }
+
+    /* Let application decide if URI is WebSocket endpoint */
+    if (hi->ws_connect_fn(hs, http_uri) != espOK) {
+        return 0;
+    }
+    ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] Switching to WebSocket on %s\r\n", http_uri);
+
+    /* Accept value is base64 encoded SHA-1 of key and magic string */
+    ESP_MEMCPY(&key[HTTP_WS_KEY_LEN], HTTP_WS_GUID, sizeof(HTTP_WS_GUID) - 1);
+    http_ws_sha1(key, sizeof(key), digest);
+    http_ws_base64(digest, sizeof(digest), accept);
+
+    iov[0].data = resp;
+    iov[0].len = sizeof(resp) - 1;
+    iov[1].data = accept;
+    iov[1].len = sizeof(accept) - 1;
+    iov[2].data = CRLF CRLF;
+    iov[2].len = 4;
+    esp_conn_writev(hs->conn, iov, ESP_ARRAYSIZE(iov), 1, &hs->conn_mem_available);
+
+    hs->ws = 1;
+    hs->process_resp = 0;                       /* There is no file response on this connection */
+
+    /* Frames sent right after request are processed as WebSocket data */
+    len = esp_pbuf_length(hs->p, 1);
+    if (len > hdr_end + 4) {
+        if ((rem = esp_pbuf_new(len - hdr_end - 4)) != NULL) {
+            esp_pbuf_copy(hs->p, esp_pbuf_data(rem), len - hdr_end - 4, hdr_end + 4);
+        }
+    }
+    esp_pbuf_free(hs->p);
+    hs->p = NULL;
+    if (rem != NULL) {
+        http_ws_recv(hs, rem);
+        esp_pbuf_free(rem);                     /* State keeps its own reference */
+    } else if (len > hdr_end + 4) {
+        http_ws_close(hs, 1011);
+    }
+    return 1;
+}
+
+#endif /* HTTP_WEBSOCKET */
+
+/**
+ * \brief           Process received data on connection
+ * \param[in]       hs: HTTP state
+ * \param[in]       p: Received packet buffer
+ * \return          `1` if received data may be acknowledged to stack, `0` if application still holds them
+ */
+static uint8_t
+http_recv(http_state_t* hs, esp_pbuf_p p) {
+    uint8_t ack = 1;
+    size_t pos;
+
+#if HTTP_WEBSOCKET
+    if (hs->ws) {                               /* Upgraded connection carries frames only */
+        return http_ws_recv(hs, p);
+    }
+#endif /* HTTP_WEBSOCKET */
+
+    /*
+     * Check if we have to receive headers data first
+     * before we can proceed with everything else
+     */
+    if (!hs->headers_received) {                /* Are we still waiting for headers data? */
+        if (hs->p == NULL) {
+            hs->p = p;                          /* This is a first received packet */
+        } else {
+            esp_pbuf_cat(hs->p, p); /* Add new packet to the end of linked list of recieved data */
+        }
+        esp_pbuf_ref(p);                        /* Increase reference counter */
+
+        /*
+         * Check if headers are fully received.
+         * To know this, search for "\r\n\r\n" sequence in received data,
+         * starting where previous search stopped instead of beginning of chain
+         */
+        if ((pos = esp_pbuf_strfind(hs->p, CRLF CRLF, hs->headers_scan_pos)) == ESP_SIZET_MAX) {
+            pos = esp_pbuf_length(hs->p, 1);
+            hs->headers_scan_pos = pos > 3 ? pos - 3 : 0;   /* Sequence may continue in next packet */
+        } else {
+            uint8_t http_uri_parsed;
+#if HTTP_WEBSOCKET
+            size_t hdr_end = pos;
+#endif /* HTTP_WEBSOCKET */
+            ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] HTTP headers received!\r\n");
+            hs->headers_received = 1;           /* Flag received headers */
+            hs->p = esp_pbuf_compact(hs->p, 0); /* Headers are scanned many times, merge received segments */
+#if HTTP_KEEP_ALIVE
+            hs->req_len = pos + 4;              /* Request without content ends with headers */
+            hs->keep_alive = http_req_keep_alive(hs->p, pos);
+#endif /* HTTP_KEEP_ALIVE */
+#if HTTP_GZIP_STATIC_FILES
+            hs->accept_gzip = http_req_accept_gzip(hs->p, pos);
+#endif /* HTTP_GZIP_STATIC_FILES */
+
+            /* Parse the URI, process request and open response file */
+            http_uri_parsed = http_parse_uri(hs->p) == espOK;
+
+#if HTTP_SUPPORT_POST
+            /* Check for request method used on this connection */
+            if (!esp_pbuf_strcmp(hs->p, "POST ", 0)) {
+                size_t data_pos, pbuf_total_len;
+
+                hs->req_method = HTTP_METHOD_POST;  /* Save a new value as POST method */
+
+                /*
+                 * At this point, all headers are received
+                 * We can start process them into something useful
+                 */
+                data_pos = pos + 4; /* Ignore 4 bytes of CRLF sequence */
+
+                /*
+                 * Try to find content length on this request
+                 * search for 2 possible values "Content-Length" or "content-length" parameters
+                 */
+                hs->content_length = 0;
+                if (((pos = esp_pbuf_strfind(hs->p, "Content-Length:", 0)) != ESP_SIZET_MAX) ||
+                    (pos = esp_pbuf_strfind(hs->p, "content-length:", 0)) != ESP_SIZET_MAX) {
+                    uint8_t ch;
+
+                    pos += 15;                  /* Skip this part */
+                    if (esp_pbuf_get_at(hs->p, pos, &ch) && ch == ' ') {
+                        ++pos;
+                    }
+                    esp_pbuf_get_at(hs->p, pos, &ch);
+                    while (ch >= '0' && ch <= '9') {
+                        hs->content_length = 10 * hs->content_length + (ch - '0');
+                        ++pos;
+                        if (!esp_pbuf_get_at(hs->p, pos, &ch)) {
+                            break;
+                        }
+                    }
+                }
+
+                /* Check if we are expecting any data on POST request */
+                if (hs->content_length > 0) {
+                    /*
+                     * Call user POST start method here
+                     * to notify him to prepare himself to receive POST data
+                     */
+                    if (hi != NULL && hi->post_start_fn != NULL) {
+                        hi->post_start_fn(hs, http_uri, hs->content_length);
+                    }
+
+                    /*
+                     * Check if there is anything to send already
+                     * to user from data part of request
+                     */
+                    pbuf_total_len = esp_pbuf_length(hs->p, 1); /* Get total length of current received pbuf */
+                    if ((pbuf_total_len - data_pos) > 0) {
+                        hs->content_received = pbuf_total_len - data_pos;
+#if HTTP_KEEP_ALIVE
+                        if (hs->content_received > hs->content_length) {
+                            hs->keep_alive = 0; /* Pipelining after content is not supported */
+                        }
+#endif /* HTTP_KEEP_ALIVE */
+
+                        /* Send data to user */
+                        http_post_send_to_user(hs, hs->p, data_pos);
+
+                        /*
+                         * Did we receive everything in single packet?
+                         * Close POST loop at this point and notify user
+                         */
+                        if (hs->content_received >= hs->content_length) {
+                            hs->process_resp = 1;   /* Process with response to user */
+                            if (hi != NULL && hi->post_end_fn != NULL) {
+                                hi->post_end_fn(hs);
+                            }
+                        }
+                    }
+                } else {
+                    hs->process_resp = 1;
+                }
+            } else
+#else /* HTTP_SUPPORT_POST */
+            ESP_UNUSED(pos);
+#endif /* !HTTP_SUPPORT_POST */
+            {
+                if (!esp_pbuf_strcmp(hs->p, "GET ", 0)) {
+                    hs->req_method = HTTP_METHOD_GET;
+                    hs->process_resp = 1;       /* Process with response to user */
+                } else {
+                    hs->req_method = HTTP_METHOD_NOTALLOWED;
+                    hs->process_resp = 1;
+                }
+            }
+
+            /*
+             * If uri was parsed succssfully and if method is allowed,
+             * then open and prepare file for future response
+             */
+            if (http_uri_parsed && hs->req_method != HTTP_METHOD_NOTALLOWED) {
+#if HTTP_WEBSOCKET
+                if (hs->req_method == HTTP_METHOD_GET && http_ws_upgrade(hs, hdr_end)) {
+                    return ack;
+                }
+#endif /* HTTP_WEBSOCKET */
+                http_get_file_from_uri(hs, http_uri);   /* Open file */
+            }
+        }
+    } else {
+#if HTTP_SUPPORT_POST
+        /*
+         * We are receiving request data now
+         * as headers are already received
+         */
+        if (hs->req_method == HTTP_METHOD_POST
+            && hs->content_received < hs->content_length) { /* Did we receive all the data on POST? */
+            size_t tot_len;
+
+            tot_len = esp_pbuf_length(p, 1);    /* Get length of pbuf */
+            hs->content_received += tot_len;
+#if HTTP_KEEP_ALIVE
+            if (hs->content_received > hs->content_length) {
+                hs->keep_alive = 0;             /* Pipelining after content is not supported */
+            }
+#endif /* HTTP_KEEP_ALIVE */
+
+#if HTTP_POST_FLOW_CONTROL
+            /* Hold data until application consumes them */
+            if (http_post_send_to_user(hs, p, 0) == espINPROG) {
+                if (hs->p_post == NULL) {
+                    hs->p_post = p;
+                    esp_pbuf_ref(p);
+                } else {
+                    esp_pbuf_chain(hs->p_post, p);  /* Chain increases reference counter */
+                }
+                ack = 0;
+            }
+#else /* HTTP_POST_FLOW_CONTROL */
+            http_post_send_to_user(hs, p, 0);   /* Send data directly to user */
+#endif /* !HTTP_POST_FLOW_CONTROL */
+
+            /* Check if everything received */
+            if (hs->content_received >= hs->content_length) {
+                hs->process_resp = 1;           /* Process with response to user */
+
+                /* Stop the response part here! */
+                if (hi != NULL && hi->post_end_fn) {
+                    hi->post_end_fn(hs);
+                }
+            }
+        } else
+#endif /* HTTP_SUPPORT_POST */
+        {
+#if HTTP_KEEP_ALIVE
+            /* Next pipelined request, processed when current response is finished */
+            if (hs->p_next == NULL) {
+                hs->p_next = p;
+            } else {
+                esp_pbuf_cat(hs->p_next, p);
+            }
+            esp_pbuf_ref(p);                    /* Increase reference counter */
+#else /* HTTP_KEEP_ALIVE */
+            /* Protocol violation at this point! */
+#endif /* !HTTP_KEEP_ALIVE */
+        }
+    }
+
+    /* Do the processing on response */
+    if (hs->process_resp) {
+        send_response(hs, 1);                   /* Send the response data */
+    }
+    return ack;
 }
 
 /**
@@ -885,10 +2401,16 @@ http_evt(esp_evt_t* evt) {
         case ESP_EVT_CONN_ACTIVE: {
             ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE_WARNING, "[HTTP SERVER] Conn %d active\r\n",
                 (int)esp_conn_getnum(conn));
-            hs = esp_mem_calloc(1, sizeof(*hs));
+#if HTTP_STATE_POOL
+            hs = &http_states[esp_conn_getnum(conn)];   /* State of this connection number is reused */
+            ESP_MEMSET(hs, 0x00, sizeof(*hs));
+#else /* HTTP_STATE_POOL */
+            hs = esp_mem_calloc_tag(1, sizeof(*hs), ESP_MEM_TAG_HTTP);
+#endif /* !HTTP_STATE_POOL */
             if (hs != NULL) {
                 hs->conn = conn;                /* Save connection handle */
                 esp_conn_set_arg(conn, hs);     /* Set argument for connection */
+                esp_conn_set_poll_interval(conn, ESP_CFG_CONN_POLL_INTERVAL);   /* Response is sent in poll too */
             } else {
                 ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE_WARNING,
                     "[HTTP SERVER] Cannot allocate memory for http state\r\n");
@@ -900,168 +2422,19 @@ http_evt(esp_evt_t* evt) {
         /* Data received on connection */
         case ESP_EVT_CONN_RECV: {
             esp_pbuf_p p;
-            size_t pos;
 
             p = esp_evt_conn_recv_get_buff(evt);   /* Get received buffer */
             if (hs != NULL) {                   /* Do we have a valid http state? */
-                /*
-                 * Check if we have to receive headers data first
-                 * before we can proceed with everything else
-                 */
-                if (!hs->headers_received) {    /* Are we still waiting for headers data? */
-                    if (hs->p == NULL) {
-                        hs->p = p;              /* This is a first received packet */
-                    } else {
-                        esp_pbuf_cat(hs->p, p); /* Add new packet to the end of linked list of recieved data */
-                    }
-                    esp_pbuf_ref(p);            /* Increase reference counter */
-
-                    /*
-                     * Check if headers are fully received.
-                     * To know this, search for "\r\n\r\n" sequence in received data
-                     */
-                    if ((pos = esp_pbuf_strfind(hs->p, CRLF CRLF, 0)) != ESP_SIZET_MAX) {
-                        uint8_t http_uri_parsed;
-                        ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] HTTP headers received!\r\n");
-                        hs->headers_received = 1;   /* Flag received headers */
-
-                        /* Parse the URI, process request and open response file */
-                        http_uri_parsed = http_parse_uri(hs->p) == espOK;
-
-#if HTTP_SUPPORT_POST
-                        /* Check for request method used on this connection */
-                        if (!esp_pbuf_strcmp(hs->p, "POST ", 0)) {
-                            size_t data_pos, pbuf_total_len;
-
-                            hs->req_method = HTTP_METHOD_POST;  /* Save a new value as POST method */
-
-                            /*
-                             * At this point, all headers are received
-                             * We can start process them into something useful
-                             */
-                            data_pos = pos + 4; /* Ignore 4 bytes of CRLF sequence */
-
-                            /*
-                             * Try to find content length on this request
-                             * search for 2 possible values "Content-Length" or "content-length" parameters
-                             */
-                            hs->content_length = 0;
-                            if (((pos = esp_pbuf_strfind(hs->p, "Content-Length:", 0)) != ESP_SIZET_MAX) ||
-                                (pos = esp_pbuf_strfind(hs->p, "content-length:", 0)) != ESP_SIZET_MAX) {
-                                uint8_t ch;
-
-                                pos += 15;      /* Skip this part */
-                                if (esp_pbuf_get_at(hs->p, pos, &ch) && ch == ' ') {
-                                    ++pos;
-                                }
-                                esp_pbuf_get_at(hs->p, pos, &ch);
-                                while (ch >= '0' && ch <= '9') {
-                                    hs->content_length = 10 * hs->content_length + (ch - '0');
-                                    ++pos;
-                                    if (!esp_pbuf_get_at(hs->p, pos, &ch)) {
-                                        break;
-                                    }
-                                }
-                            }
-
-                            /* Check if we are expecting any data on POST request */
-                            if (hs->content_length > 0) {
-                                /*
-                                 * Call user POST start method here
-                                 * to notify him to prepare himself to receive POST data
-                                 */
-                                if (hi != NULL && hi->post_start_fn != NULL) {
-                                    hi->post_start_fn(hs, http_uri, hs->content_length);
-                                }
-
-                                /*
-                                 * Check if there is anything to send already
-                                 * to user from data part of request
-                                 */
-                                pbuf_total_len = esp_pbuf_length(hs->p, 1); /* Get total length of current received pbuf */
-                                if ((pbuf_total_len - data_pos) > 0) {
-                                    hs->content_received = pbuf_total_len - data_pos;
-
-                                    /* Send data to user */
-                                    http_post_send_to_user(hs, hs->p, data_pos);
-
-                                    /*
-                                     * Did we receive everything in single packet?
-                                     * Close POST loop at this point and notify user
-                                     */
-                                    if (hs->content_received >= hs->content_length) {
-                                        hs->process_resp = 1;   /* Process with response to user */
-                                        if (hi != NULL && hi->post_end_fn != NULL) {
-                                            hi->post_end_fn(hs);
-                                        }
-                                    }
-                                }
-                            } else {
-                                hs->process_resp = 1;
-                            }
-                        } else
-#else /* HTTP_SUPPORT_POST */
-                        ESP_UNUSED(pos);
-#endif /* !HTTP_SUPPORT_POST */
-                        {
-                            if (!esp_pbuf_strcmp(hs->p, "GET ", 0)) {
-                                hs->req_method = HTTP_METHOD_GET;
-                                hs->process_resp = 1;   /* Process with response to user */
-                            } else {
-                                hs->req_method = HTTP_METHOD_NOTALLOWED;
-                                hs->process_resp = 1;
-                            }
-                        }
-
-                        /*
-                         * If uri was parsed succssfully and if method is allowed,
-                         * then open and prepare file for future response
-                         */
-                        if (http_uri_parsed && hs->req_method != HTTP_METHOD_NOTALLOWED) {
-                            http_get_file_from_uri(hs, http_uri);   /* Open file */
-                        }
-                    }
-                } else {
-#if HTTP_SUPPORT_POST
-                    /*
-                     * We are receiving request data now
-                     * as headers are already received
-                     */
-                    if (hs->req_method == HTTP_METHOD_POST) {
-                        /* Did we receive all the data on POST? */
-                        if (hs->content_received < hs->content_length) {
-                            size_t tot_len;
-
-                            tot_len = esp_pbuf_length(p, 1);/* Get length of pbuf */
-                            hs->content_received += tot_len;
-
-                            http_post_send_to_user(hs, p, 0);   /* Send data directly to user */
-
-                            /* Check if everything received */
-                            if (hs->content_received >= hs->content_length) {
-                                hs->process_resp = 1;   /* Process with response to user */
-
-                                /* Stop the response part here! */
-                                if (hi != NULL && hi->post_end_fn) {
-                                    hi->post_end_fn(hs);
-                                }
-                            }
-                        }
-                    } else
-#endif /* HTTP_SUPPORT_POST */
-                    {
-                        /* Protocol violation at this point! */
-                    }
-                }
-
-                /* Do the processing on response */
-                if (hs->process_resp) {
-                    send_response(hs, 1);       /* Send the response data */
+#if HTTP_KEEP_ALIVE
+                hs->idle_time = 0;                  /* Connection is not idle anymore */
+#endif /* HTTP_KEEP_ALIVE */
+                if (http_recv(hs, p)) {         /* Process received data */
+                    esp_conn_recved(conn, p);   /* Notify stack about received data */
                 }
             } else {
                 close = 1;
+                esp_conn_recved(conn, p);       /* Notify stack about received data */
             }
-            esp_conn_recved(conn, p);           /* Notify stack about received data */
             break;
         }
 
@@ -1088,6 +2461,11 @@ http_evt(esp_evt_t* evt) {
         case ESP_EVT_CONN_CLOSE: {
             ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] connection closed\r\n");
             if (hs != NULL) {
+#if HTTP_WEBSOCKET
+                if (hs->ws && hi != NULL && hi->ws_close_fn != NULL) {
+                    hi->ws_close_fn(hs);
+                }
+#endif /* HTTP_WEBSOCKET */
 #if HTTP_SUPPORT_POST
                 if (hs->req_method == HTTP_METHOD_POST) {
                     if (hs->content_received < hs->content_length) {
@@ -1096,20 +2474,27 @@ http_evt(esp_evt_t* evt) {
                         }
                     }
                 }
+#if HTTP_POST_FLOW_CONTROL
+                if (hs->p_post != NULL) {
+                    esp_pbuf_free(hs->p_post);  /* Free data not consumed by application */
+                    hs->p_post = NULL;
+                }
+#endif /* HTTP_POST_FLOW_CONTROL */
 #endif /* HTTP_SUPPORT_POST */
                 if (hs->p != NULL) {
                     esp_pbuf_free(hs->p);       /* Free packet buffer */
                     hs->p = NULL;
                 }
-                if (hs->resp_file_opened) {     /* Is file opened? */
-                    uint8_t is_static = hs->resp_file.is_static;
-                    http_fs_data_close_file(hi, &hs->resp_file);    /* Close file at this point */
-                    if (!is_static && hs->buff != NULL) {
-                        esp_mem_free_s((void **)&hs->buff);
-                    }
-                    hs->resp_file_opened = 0;   /* File is not opened anymore */
+#if HTTP_KEEP_ALIVE
+                if (hs->p_next != NULL) {
+                    esp_pbuf_free(hs->p_next);  /* Free pipelined requests */
+                    hs->p_next = NULL;
                 }
+#endif /* HTTP_KEEP_ALIVE */
+                http_close_resp_file(hs);
+#if !HTTP_STATE_POOL
                 esp_mem_free_s((void **)&hs);
+#endif /* !HTTP_STATE_POOL */
             }
             break;
         }
@@ -1117,6 +2502,17 @@ http_evt(esp_evt_t* evt) {
         /* Poll the connection */
         case ESP_EVT_CONN_POLL: {
             if (hs != NULL) {
+#if HTTP_KEEP_ALIVE
+                /* Close connection when waiting too long for next request */
+                if (hs->p == NULL && !hs->headers_received) {
+                    hs->idle_time += ESP_CFG_CONN_POLL_INTERVAL;
+                    if (hs->idle_time >= HTTP_KEEP_ALIVE_TIMEOUT) {
+                        ESP_DEBUGF(ESP_CFG_DBG_SERVER_TRACE, "[HTTP SERVER] Idle timeout, closing connection\r\n");
+                        esp_conn_close(conn, 0);
+                        break;
+                    }
+                }
+#endif /* HTTP_KEEP_ALIVE */
                 send_response(hs, 0);           /* Send more data if possible */
             } else {
                 close = 1;
@@ -1143,6 +2539,11 @@ http_evt(esp_evt_t* evt) {
 espr_t
 esp_http_server_init(const http_init_t* init, esp_port_t port) {
     espr_t res;
+#if HTTP_SSI_HASH_SIZE > 0
+    if ((res = http_ssi_index_build(init)) != espOK) {
+        return res;
+    }
+#endif /* HTTP_SSI_HASH_SIZE > 0 */
     if ((res = esp_set_server(1, port, ESP_CFG_MAX_CONNS, 80, http_evt, NULL, NULL, 1)) == espOK) {
         hi = init;
     }
@@ -1159,7 +2560,116 @@ esp_http_server_init(const http_init_t* init, esp_port_t port) {
  */
 size_t
 esp_http_server_write(http_state_t* hs, const void* data, size_t len) {
-    esp_conn_write(hs->conn, data, len, 0, &hs->conn_mem_available);
-    hs->written_total += len;                   /* Increase total length */
+    http_write_resp(hs, data, len);             /* Write data, framed on chunked response */
     return len;
 }
+
+#if HTTP_POST_FLOW_CONTROL || __DOXYGEN__
+
+/**
+ * \brief           Notify server that application consumed POST data
+ *
+ *                  Call this function after \ref http_post_data_fn returned \ref espINPROG
+ *                  and data were processed. Server then acknowledges data to stack
+ *                  and reading of next data from device continues
+ *
+ * \note            Function may be called from POST callback or from other thread
+ * \param[in]       hs: HTTP state
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_http_server_post_data_consumed(http_state_t* hs) {
+    ESP_ASSERT("hs != NULL", hs != NULL);
+
+    esp_core_lock();
+    http_post_release(hs);
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* HTTP_POST_FLOW_CONTROL || __DOXYGEN__ */
+
+#if HTTP_RESP_CACHE || __DOXYGEN__
+
+/**
+ * \brief           Invalidate cached responses
+ *
+ *                  Next request for invalidated URI is processed with CGI and SSI callbacks again
+ *
+ * \note            Function may be called from server callbacks or from other thread
+ * \param[in]       uri: Request URI without parameters, responses for all its parameters are invalidated.
+ *                      Set to `NULL` to invalidate all cached responses
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_http_server_cache_invalidate(const char* uri) {
+    http_cache_entry_t* e;
+
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(http_cache_entries); ++i) {
+        e = &http_cache_entries[i];
+        if (e->valid && (uri == NULL || http_cache_uri_match((const char *)e->buff, uri))) {
+            e->valid = 0;
+            http_cache_release(e);              /* Memory is freed once response is sent */
+        }
+    }
+    ++http_cache_epoch;                         /* Responses being rendered are not stored */
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* HTTP_RESP_CACHE || __DOXYGEN__ */
+
+#if HTTP_WEBSOCKET || __DOXYGEN__
+
+/**
+ * \brief           Send message to WebSocket client
+ *
+ *                  Message is sent as single frame, written directly to connection buffer and flushed
+ *
+ * \note            Function may be called from server callbacks or from other thread,
+ *                  until \ref http_init_t.ws_close_fn callback is called for connection
+ * \param[in]       hs: HTTP state of WebSocket connection
+ * \param[in]       data: Message payload
+ * \param[in]       len: Length of payload in units of bytes, up to `0xFFFF` bytes
+ * \param[in]       binary: Set to `1` to send binary message or `0` to send text message
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_http_server_ws_write(http_state_t* hs, const void* data, size_t len, uint8_t binary) {
+    espr_t res = espCLOSED;
+
+    ESP_ASSERT("hs != NULL", hs != NULL);
+    ESP_ASSERT("len <= 0xFFFF", len <= 0xFFFF);
+    ESP_ASSERT("data != NULL || len == 0", data != NULL || len == 0);
+
+    esp_core_lock();
+    if (hs->ws && !hs->ws_closing) {
+        res = http_ws_write_frame(hs, binary ? HTTP_WS_OPCODE_BINARY : HTTP_WS_OPCODE_TEXT, data, len);
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Close WebSocket connection with normal closure status
+ * \note            Function may be called from server callbacks or from other thread
+ * \param[in]       hs: HTTP state of WebSocket connection
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_http_server_ws_close(http_state_t* hs) {
+    espr_t res = espCLOSED;
+
+    ESP_ASSERT("hs != NULL", hs != NULL);
+
+    esp_core_lock();
+    if (hs->ws && !hs->ws_closing) {
+        http_ws_close(hs, 1000);
+        res = espOK;
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* HTTP_WEBSOCKET || __DOXYGEN__ */
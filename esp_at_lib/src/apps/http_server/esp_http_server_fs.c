@@ -32,21 +32,40 @@
  * Version:         $_version_$
  */
 #include "esp/apps/esp_http_server.h"
+#if HTTP_FS_IMAGE
+#include "esp/apps/esp_http_server_fs_image.h"
+#endif /* HTTP_FS_IMAGE */
 #include "esp/esp_mem.h"
+#include <stdlib.h>
+
+/* Add entity tag to static file table entry */
+#if HTTP_ETAG
+#define HTTP_FS_ETAG(tag)               , (tag)
+#else /* HTTP_ETAG */
+#define HTTP_FS_ETAG(tag)
+#endif /* !HTTP_ETAG */
 
 /* Number of opened files in system */
 extern uint16_t http_fs_opened_files_cnt;
 
+/**
+ * \brief           Response headers embedded in default files
+ * \note            Length of headers is known at compile time and stored in file table,
+ *                  no scanning for end of headers is needed on request
+ */
+#define HTTP_FS_HDR(code, type)         "HTTP/1.1 " code "\r\n" "Server: " HTTP_SERVER_NAME "\r\n" "Content-Type: " type "\r\n" "\r\n"
+#define HTTP_FS_HDR_200_HTML            HTTP_FS_HDR("200 OK", "text/html")
+#define HTTP_FS_HDR_200_CSS             HTTP_FS_HDR("200 OK", "text/css")
+#define HTTP_FS_HDR_200_JS              HTTP_FS_HDR("200 OK", "text/javascript")
+#define HTTP_FS_HDR_404_HTML            HTTP_FS_HDR("404 Not Found", "text/html")
+
 #if HTTP_USE_DEFAULT_STATIC_FILES
 /**
  * \brief           Default index.html file including response headers
  */
 static const uint8_t
 responseData[] = ""
-    "HTTP/1.1 200 OK\r\n"
-    "Server: " HTTP_SERVER_NAME "\r\n"
-    "Content-Type: text/html\r\n"
-    "\r\n"
+    HTTP_FS_HDR_200_HTML
     "<html>\n"
     "   <head>\n"
     "       <title><!--#title--></title>\n"
@@ -74,10 +93,7 @@ responseData[] = ""
  */
 static const uint8_t
 responseData_css[] = ""
-    "HTTP/1.1 200 OK\r\n"
-    "Server: " HTTP_SERVER_NAME "\r\n"
-    "Content-Type: text/css\r\n"
-    "\r\n"
+    HTTP_FS_HDR_200_CSS
     "html, body { margin: 0; padding: 0; color: blue; font-family: Arial, Tahoma; }\r\n"
     "h1 { font-size: 22px; }\n"
     "footer .container { width: 1000px; padding: 6px 3px; border: 1px solid #000000; font-size: 11px; }\n"
@@ -91,10 +107,7 @@ responseData_css[] = ""
  */
 static const uint8_t
 responseData_js1[] = ""
-    "HTTP/1.1 200 OK\r\n"
-    "Server: " HTTP_SERVER_NAME "\r\n"
-    "Content-Type: text/javascript\r\n"
-    "\r\n"
+    HTTP_FS_HDR_200_JS
     "jQuery(document).ready(function() {\n"
     "   jQuery(\"#maindiv\").append(\"<p>This paragraphs was written using jQuery</p>\");\n"
     "})\n";
@@ -105,26 +118,85 @@ responseData_js1[] = ""
  */
 static const uint8_t
 responseData_404[] = ""
-    "HTTP/1.1 404 Not Found\r\n"
-    "Server: " HTTP_SERVER_NAME "\r\n"
-    "Content-Type: text/html\r\n"
-    "\r\n"
+    HTTP_FS_HDR_404_HTML
     "<html><body><h1>404 Page not found!</h1></body></html>\n";
 
 /**
  * \brief           List of dummy files for output on user request
+ * \note            Entries are sorted by path for \ref HTTP_SORTED_URI_TABLES
  */
 const http_fs_file_table_t
 http_fs_static_files[] = {
+    {"/404.html",           responseData_404,   sizeof(responseData_404) - 1,   sizeof(HTTP_FS_HDR_404_HTML) - 1,   HTTP_CONTENT_TYPE_HTML  HTTP_FS_ETAG("\"def-404-1\"")},
 #if HTTP_USE_DEFAULT_STATIC_FILES
-    {"/index.html",         responseData,       sizeof(responseData) - 1},
-    {"/index.shtml",        responseData,       sizeof(responseData) - 1},
-    {"/css/style.css",      responseData_css,   sizeof(responseData_css) - 1},
-    {"/js/js.js",           responseData_js1,   sizeof(responseData_js1) - 1},
+    {"/css/style.css",      responseData_css,   sizeof(responseData_css) - 1,   sizeof(HTTP_FS_HDR_200_CSS) - 1,    HTTP_CONTENT_TYPE_CSS   HTTP_FS_ETAG("\"def-css-1\"")},
+    {"/index.html",         responseData,       sizeof(responseData) - 1,       sizeof(HTTP_FS_HDR_200_HTML) - 1,   HTTP_CONTENT_TYPE_HTML  HTTP_FS_ETAG("\"def-index-1\"")},
+    {"/index.shtml",        responseData,       sizeof(responseData) - 1,       sizeof(HTTP_FS_HDR_200_HTML) - 1,   HTTP_CONTENT_TYPE_HTML  HTTP_FS_ETAG(NULL)},
+    {"/js/js.js",           responseData_js1,   sizeof(responseData_js1) - 1,   sizeof(HTTP_FS_HDR_200_JS) - 1,     HTTP_CONTENT_TYPE_JS    HTTP_FS_ETAG("\"def-js-1\"")},
 #endif /* HTTP_USE_DEFAULT_STATIC_FILES */
-    {"/404.html",           responseData_404,   sizeof(responseData_404) - 1},
 };
 
+#if HTTP_SORTED_URI_TABLES
+/**
+ * \brief           Compare path with static file table entry for binary search
+ * \param[in]       key: Path to search for
+ * \param[in]       entry: Table entry
+ * \return          Result of `strcmp` between path and entry path
+ */
+static int
+http_fs_static_file_cmp(const void* key, const void* entry) {
+    return strcmp(key, ((const http_fs_file_table_t *)entry)->path);
+}
+#endif /* HTTP_SORTED_URI_TABLES */
+
+#if HTTP_RANGE_REQUESTS
+/**
+ * \brief           Limit number of bytes to read to end of requested range
+ * \param[in]       file: File handle
+ * \param[in]       len: Number of bytes to limit
+ * \return          Limited number of bytes
+ */
+static uint32_t
+http_fs_range_limit(const http_fs_file_t* file, uint32_t len) {
+    if (file->range_end > 0) {
+        len = ESP_MIN(len, file->range_end > file->fptr ? file->range_end - file->fptr : 0);
+    }
+    return len;
+}
+#endif /* HTTP_RANGE_REQUESTS */
+
+/**
+ * \brief           Set file to static data in device memory
+ * \param[in]       file: Pointer to file structure
+ * \param[in]       data: File data, including embedded headers
+ * \param[in]       size: Size of file, including embedded headers
+ * \param[in]       body_offset: Length of embedded headers
+ * \param[in]       content_type: Content type of file
+ * \param[in]       etag: Quoted entity tag or `NULL` if not used
+ */
+static void
+http_fs_set_static(http_fs_file_t* file, const void* data, uint32_t size, uint32_t body_offset,
+                    http_content_type_t content_type, const char* etag) {
+    ESP_MEMSET(file, 0x00, sizeof(*file));
+
+    file->size = size;
+    file->data = data;
+#if HTTP_DYNAMIC_HEADERS
+    /* Embedded headers are replaced by dynamic headers */
+    file->size -= body_offset;
+    file->data += body_offset;
+#else /* HTTP_DYNAMIC_HEADERS */
+    ESP_UNUSED(body_offset);
+#endif /* !HTTP_DYNAMIC_HEADERS */
+    file->content_type = content_type;
+    file->is_static = 1;    /* Set to 0 for testing purposes */
+#if HTTP_ETAG
+    file->etag = etag;
+#else /* HTTP_ETAG */
+    ESP_UNUSED(etag);
+#endif /* !HTTP_ETAG */
+}
+
 /**
  * \brief           Open file from file system
  * \param[in]       hi: HTTP init structure
@@ -134,9 +206,20 @@ http_fs_static_files[] = {
  */
 uint8_t
 http_fs_data_open_file(const http_init_t* hi, http_fs_file_t* file, const char* path) {
-    uint8_t i, res;
+    const http_fs_file_table_t* entry = NULL;
+#if HTTP_FS_IMAGE
+    const http_fs_image_entry_t* img_entry;
+#endif /* HTTP_FS_IMAGE */
+#if !HTTP_SORTED_URI_TABLES
+    size_t i;
+#endif /* !HTTP_SORTED_URI_TABLES */
+    uint8_t res;
 
     file->fptr = 0;
+    file->content_type = HTTP_CONTENT_TYPE_AUTO;
+#if HTTP_RANGE_REQUESTS
+    file->range_end = 0;
+#endif /* HTTP_RANGE_REQUESTS */
     if (hi != NULL && hi->fs_open != NULL) {    /* Is user defined file system ready? */
         file->rem_open_files = &http_fs_opened_files_cnt;   /* Set pointer to opened files */
         res = hi->fs_open(file, path);          /* Try to read file from user file system */
@@ -151,16 +234,40 @@ http_fs_data_open_file(const http_init_t* hi, http_fs_file_t* file, const char*
     /*
      * Try to open static file if available
      */
-    for (i = 0; i < ESP_ARRAYSIZE(http_fs_static_files); ++i) {
-        if (path != NULL && !strcmp(http_fs_static_files[i].path, path)) {
-            ESP_MEMSET(file, 0x00, sizeof(*file));
+    if (path == NULL) {
+        return 0;
+    }
+#if HTTP_FS_IMAGE
+    if (hi != NULL && hi->fs_image != NULL
+        && (img_entry = http_fs_image_find(hi->fs_image, path)) != NULL) {
+        const uint8_t* img = hi->fs_image;
 
-            file->size = http_fs_static_files[i].size;
-            file->data = (uint8_t *)http_fs_static_files[i].data;
-            file->is_static = 1;    /* Set to 0 for testing purposes */
-            return 1;
+        /* File is sent directly from image memory */
+        http_fs_set_static(file, img + img_entry->data_offset, img_entry->size, img_entry->body_offset,
+            (http_content_type_t)img_entry->content_type,
+            img_entry->etag_offset > 0 ? (const char *)img + img_entry->etag_offset : NULL);
+        return 1;
+    }
+#endif /* HTTP_FS_IMAGE */
+#if HTTP_SORTED_URI_TABLES
+    entry = bsearch(path, http_fs_static_files, ESP_ARRAYSIZE(http_fs_static_files),
+                    sizeof(http_fs_static_files[0]), http_fs_static_file_cmp);
+#else /* HTTP_SORTED_URI_TABLES */
+    for (i = 0; i < ESP_ARRAYSIZE(http_fs_static_files); ++i) {
+        if (!strcmp(http_fs_static_files[i].path, path)) {
+            entry = &http_fs_static_files[i];
+            break;
         }
     }
+#endif /* !HTTP_SORTED_URI_TABLES */
+    if (entry != NULL) {
+#if HTTP_ETAG
+        http_fs_set_static(file, entry->data, entry->size, entry->body_offset, entry->content_type, entry->etag);
+#else /* HTTP_ETAG */
+        http_fs_set_static(file, entry->data, entry->size, entry->body_offset, entry->content_type, NULL);
+#endif /* !HTTP_ETAG */
+        return 1;
+    }
     return 0;
 }
 
@@ -180,12 +287,22 @@ http_fs_data_read_file(const http_init_t* hi, http_fs_file_t* file, void** buff,
     len = file->size - file->fptr;              /* Calculate remaining length */
     if (buff == NULL) {                         /* If there is no buffer */
         if (file->is_static) {                  /* Check static file */
+#if HTTP_RANGE_REQUESTS
+            len = http_fs_range_limit(file, len);
+#endif /* HTTP_RANGE_REQUESTS */
             return len;                         /* Simply return difference */
         } else if (hi != NULL && hi->fs_read != NULL) { /* Check for read function */
-            return hi->fs_read(file, NULL, 0);  /* Call a function for dynamic file check */
+            len = hi->fs_read(file, NULL, 0);   /* Call a function for dynamic file check */
+#if HTTP_RANGE_REQUESTS
+            len = http_fs_range_limit(file, len);
+#endif /* HTTP_RANGE_REQUESTS */
+            return len;
         }
         return 0;                               /* No bytes to read */
     }
+#if HTTP_RANGE_REQUESTS
+    len = http_fs_range_limit(file, len);
+#endif /* HTTP_RANGE_REQUESTS */
 
     len = ESP_MIN(btr, len);                    /* Get number of bytes we can read */
     if (file->is_static) {                      /* Is file static? */
@@ -215,3 +332,30 @@ http_fs_data_close_file(const http_init_t* hi, http_fs_file_t* file) {
         }
     }
 }
+
+#if HTTP_RANGE_REQUESTS
+
+/**
+ * \brief           Set read position and end of range for file
+ * \param[in]       hi: HTTP init structure
+ * \param[in]       file: File handle
+ * \param[in]       pos: Absolute position of first byte to read
+ * \param[in]       end: Position after last byte to read
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+http_fs_data_seek_file(const http_init_t* hi, http_fs_file_t* file, uint32_t pos, uint32_t end) {
+    if (pos >= end || end > file->size) {
+        return 0;
+    }
+    if (!file->is_static) {
+        if (hi == NULL || hi->fs_seek == NULL || !hi->fs_seek(file, pos)) {
+            return 0;
+        }
+    }
+    file->fptr = pos;
+    file->range_end = end;
+    return 1;
+}
+
+#endif /* HTTP_RANGE_REQUESTS */
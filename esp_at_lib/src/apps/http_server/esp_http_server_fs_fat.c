@@ -66,7 +66,7 @@ http_fs_open(http_fs_file_t* file, const char* path) {
     sprintf(fs_path, "SD:www%s", path);
 
     /* Allocate memory for FATFS file structure */
-    fil = esp_mem_malloc(sizeof(*fil));
+    fil = esp_mem_malloc_tag(sizeof(*fil), ESP_MEM_TAG_HTTP);
     if (fil == NULL) {
         return 0;
     }
@@ -120,6 +120,23 @@ http_fs_read(http_fs_file_t* file, void* buff, size_t btr) {
     return 0;
 }
 
+/**
+ * \brief           Set read position of a file
+ * \param[in]       file: File handle
+ * \param[in]       pos: Absolute position from beginning of file
+ * \return          1 on success, 0 otherwise
+ */
+uint8_t
+http_fs_seek(http_fs_file_t* file, uint32_t pos) {
+    FIL* fil;
+
+    fil = file->arg;                            /* Get file argument */
+    if (fil == NULL) {                          /* Check if argument is valid */
+        return 0;
+    }
+    return f_lseek(fil, pos) == FR_OK;
+}
+
 /**
  * \brief           Close a file handle
  * \param[in]       file: File handle
@@ -0,0 +1,129 @@
+/**
+ * \file            esp_http_server_fs_image.c
+ * \brief           Packed read-only file image for HTTP server
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/apps/esp_http_server.h"
+#include "esp/apps/esp_http_server_fs_image.h"
+
+#if HTTP_FS_IMAGE || __DOXYGEN__
+
+/**
+ * \brief           Calculate path hash for image index
+ *
+ * Hash is 32-bit FNV-1a of path, without `NULL` termination.
+ * Image generator must use the same function to sort index entries.
+ *
+ * \param[in]       path: File path, ex. `/index.html`
+ * \return          Path hash
+ */
+uint32_t
+http_fs_image_hash(const char* path) {
+    uint32_t hash = 0x811C9DC5UL;
+
+    for (; *path != '\0'; ++path) {
+        hash ^= (uint8_t)*path;
+        hash *= 0x01000193UL;
+    }
+    return hash;
+}
+
+/**
+ * \brief           Check if image header and index are valid
+ * \note            Call function once when image is written or mapped, lookup only checks header
+ * \param[in]       image: Pointer to beginning of image
+ * \return          `1` if image is valid, `0` otherwise
+ */
+uint8_t
+http_fs_image_check(const void* image) {
+    const http_fs_image_hdr_t* hdr = image;
+    const http_fs_image_entry_t* entries;
+    size_t i;
+
+    if (hdr == NULL || hdr->magic != HTTP_FS_IMAGE_MAGIC || hdr->version != HTTP_FS_IMAGE_VERSION
+        || hdr->size < sizeof(*hdr) + hdr->count * sizeof(*entries)) {
+        return 0;
+    }
+    entries = (const void *)(hdr + 1);
+    for (i = 0; i < hdr->count; ++i) {
+        const http_fs_image_entry_t* e = &entries[i];
+
+        if ((i > 0 && e->hash < entries[i - 1].hash)    /* Index must be sorted */
+            || e->path_offset >= hdr->size || e->etag_offset >= hdr->size
+            || e->data_offset > hdr->size || e->size > hdr->size - e->data_offset
+            || e->body_offset > e->size) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Find file in image
+ * \param[in]       image: Pointer to beginning of image
+ * \param[in]       path: File path to find
+ * \return          Pointer to index entry on success, `NULL` otherwise
+ */
+const http_fs_image_entry_t*
+http_fs_image_find(const void* image, const char* path) {
+    const http_fs_image_hdr_t* hdr = image;
+    const http_fs_image_entry_t* entries;
+    size_t l, r, m;
+    uint32_t hash;
+
+    if (hdr == NULL || path == NULL || hdr->magic != HTTP_FS_IMAGE_MAGIC) {
+        return NULL;
+    }
+    entries = (const void *)(hdr + 1);
+    hash = http_fs_image_hash(path);
+
+    /* Find first entry with matching hash */
+    l = 0;
+    r = hdr->count;
+    while (l < r) {
+        m = l + (r - l) / 2;
+        if (entries[m].hash < hash) {
+            l = m + 1;
+        } else {
+            r = m;
+        }
+    }
+
+    /* Compare paths, hash collisions are next to each other */
+    for (; l < hdr->count && entries[l].hash == hash; ++l) {
+        if (!strcmp((const char *)image + entries[l].path_offset, path)) {
+            return &entries[l];
+        }
+    }
+    return NULL;
+}
+
+#endif /* HTTP_FS_IMAGE || __DOXYGEN__ */
@@ -96,6 +96,23 @@ http_fs_read(http_fs_file_t* file, void* buff, size_t btr) {
     return br;
 }
 
+/**
+ * \brief           Set read position of a file
+ * \param[in]       file: File handle
+ * \param[in]       pos: Absolute position from beginning of file
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+http_fs_seek(http_fs_file_t* file, uint32_t pos) {
+    FILE* fil;
+
+    fil = file->arg;                            /* Get file argument */
+    if (fil == NULL) {                          /* Check if argument is valid */
+        return 0;
+    }
+    return !fseek(fil, pos, SEEK_SET);
+}
+
 /**
  * \brief           Close a file handle
  * \param[in]       file: File handle
@@ -34,6 +34,25 @@
 #include "esp/apps/esp_mqtt_client.h"
 #include "esp/esp_mem.h"
 #include "esp/esp_pbuf.h"
+#include "esp/esp_timeout.h"
+
+#if !ESP_CFG_MQTT_AT || __DOXYGEN__
+
+#if ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__
+
+/**
+ * \brief           Topic filter trie node, one per topic level
+ */
+typedef struct esp_mqtt_topic_node {
+    struct esp_mqtt_topic_node* child;          /*!< First node on next topic level */
+    struct esp_mqtt_topic_node* next;           /*!< Next node on the same topic level */
+    esp_mqtt_topic_fn fn;                       /*!< Handler for filter ending on this node, `NULL` if none */
+    void* arg;                                  /*!< Handler user argument */
+    size_t level_len;                           /*!< Length of topic level */
+    char level[1];                              /*!< Topic level, allocated together with node */
+} esp_mqtt_topic_node_t;
+
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__ */
 
 /**
  * \brief           MQTT client connection
@@ -43,7 +62,11 @@ typedef struct esp_mqtt_client {
     const esp_mqtt_client_info_t* info;         /*!< Connection info */
     esp_mqtt_state_t conn_state;                /*!< MQTT connection state */
 
-    uint32_t poll_time;                         /*!< Poll time, increased every 500ms */
+    uint32_t poll_time;                         /*!< Poll time since last packet sent, increased every poll interval */
+#if ESP_CFG_MQTT_STATS || __DOXYGEN__
+    esp_mqtt_client_stats_t stats;              /*!< Keep-alive statistics */
+    uint8_t ping_suppressed;                    /*!< Set to `1` when `PINGREQ` was suppressed in current keep-alive period */
+#endif /* ESP_CFG_MQTT_STATS || __DOXYGEN__ */
 
     esp_mqtt_evt_t evt;                         /*!< MQTT event callback */
     esp_mqtt_evt_fn evt_fn;                     /*!< Event callback function */
@@ -51,12 +74,29 @@ typedef struct esp_mqtt_client {
     esp_buff_t tx_buff;                         /*!< Buffer for raw output data to transmit */
 
     uint8_t is_sending;                         /*!< Flag if we are sending data currently */
+#if ESP_CFG_MQTT_TX_LINGER_TIME > 0 || __DOXYGEN__
+    uint8_t linger_active;                      /*!< Set to `1` when linger timeout is waiting to send data */
+#if ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__
+    esp_timeout_t linger_timeout;               /*!< Linger timeout handle */
+#endif /* ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__ */
+#endif /* ESP_CFG_MQTT_TX_LINGER_TIME > 0 || __DOXYGEN__ */
     uint32_t sent_total;                        /*!< Total number of bytes sent so far on connection */
     uint32_t written_total;                     /*!< Total number of bytes written into send buffer and queued for send */
+#if ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__
+    const void* ref_data;                       /*!< Payload sent from user memory, `NULL` when not used */
+    uint16_t ref_len;                           /*!< Length of payload in user memory */
+    size_t ref_hdr_rem;                         /*!< Bytes in output buffer to send before payload in user memory */
+    uint8_t ref_sending;                        /*!< Set to `1` when current send is payload in user memory */
+    esp_conn_release_fn ref_release_fn;         /*!< Function to call when payload memory is not used anymore */
+    void* ref_release_arg;                      /*!< User argument for release function */
+#endif /* ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__ */
 
     uint16_t last_packet_id;                    /*!< Packet ID used on last packet */
 
     esp_mqtt_request_t requests[ESP_CFG_MQTT_MAX_REQUESTS]; /*!< List of requests */
+#if ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 || __DOXYGEN__
+    esp_mqtt_request_t* requests_inflight[ESP_CFG_MQTT_INFLIGHT_WINDOW];  /*!< Requests with packet ID, indexed by lower bits of packet ID */
+#endif /* ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 || __DOXYGEN__ */
 
     uint8_t* rx_buff;                           /*!< Raw RX buffer */
     size_t rx_buff_len;                         /*!< Length of raw RX buffer */
@@ -66,6 +106,37 @@ typedef struct esp_mqtt_client {
     uint32_t msg_rem_len;                       /*!< Remaining length value of current message */
     uint8_t msg_rem_len_mult;                   /*!< Multiplier for remaining length */
     uint32_t msg_curr_pos;                      /*!< Current buffer write pointer */
+#if ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__
+    uint32_t msg_pub_hdr_len;                   /*!< Length of PUBLISH variable header (topic and packet ID) in streaming mode */
+#if ESP_CFG_MQTT_V5 || __DOXYGEN__
+    uint32_t msg_pub_props_pos;                 /*!< Position of PUBLISH properties length while it is being received, `0` otherwise */
+#endif /* ESP_CFG_MQTT_V5 || __DOXYGEN__ */
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__
+    esp_mqtt_topic_node_t* topic_trie;          /*!< First node of topic handlers trie */
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_V5 || __DOXYGEN__
+    uint32_t max_packet_size;                   /*!< Maximum packet size accepted by server, `0` if not limited */
+    uint16_t topic_alias_max;                   /*!< Maximum topic alias value accepted by server */
+    char* topic_aliases[ESP_CFG_MQTT_V5_TOPIC_ALIASES]; /*!< Topics with assigned alias, alias value is index + 1 */
+#endif /* ESP_CFG_MQTT_V5 || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__
+    uint8_t offline_en;                         /*!< Set to `1` when offline queue is enabled */
+    const esp_mqtt_offline_store_t* offline_store;  /*!< User storage for offline queue or `NULL` for RAM queue */
+    esp_buff_t offline_buff;                    /*!< RAM offline queue */
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_QOS0_FAST || __DOXYGEN__
+    uint8_t qos0_fast;                          /*!< Set to `1` to publish QoS 0 packets without request */
+#endif /* ESP_CFG_MQTT_QOS0_FAST || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_RESUBSCRIBE > 0 || __DOXYGEN__
+    char* subs[ESP_CFG_MQTT_RESUBSCRIBE];       /*!< Remembered subscription topics, `NULL` when entry is free */
+    esp_mqtt_qos_t subs_qos[ESP_CFG_MQTT_RESUBSCRIBE];  /*!< Quality of service of remembered subscriptions */
+#endif /* ESP_CFG_MQTT_RESUBSCRIBE > 0 || __DOXYGEN__ */
 
     void* arg;                                  /*!< User argument */
 } esp_mqtt_client_t;
@@ -77,6 +148,9 @@ typedef struct esp_mqtt_client {
 
 static espr_t   mqtt_conn_cb(esp_evt_t* evt);
 static void     send_data(esp_mqtt_client_p client);
+#if ESP_CFG_MQTT_OFFLINE_QUEUE
+static void     mqtt_offline_flush(esp_mqtt_client_p client);
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE */
 
 /**
  * \brief           List of MQTT message types
@@ -105,10 +179,21 @@ typedef enum {
 #define MQTT_FLAG_CONNECT_WILL          0x04    /*!< Packet contains will topic and will message */
 #define MQTT_FLAG_CONNECT_CLEAN_SESSION 0x02    /*!< Start with clean session of this client */
 
+#if ESP_CFG_MQTT_V5 || __DOXYGEN__
+/* MQTT 5 property identifiers */
+#define MQTT_PROP_TOPIC_ALIAS_MAX       0x22    /*!< Topic alias maximum, 2 bytes */
+#define MQTT_PROP_TOPIC_ALIAS           0x23    /*!< Topic alias, 2 bytes */
+#define MQTT_PROP_MAX_PACKET_SIZE       0x27    /*!< Maximum packet size, 4 bytes */
+#endif /* ESP_CFG_MQTT_V5 || __DOXYGEN__ */
+
 /* Parser states */
 #define MQTT_PARSER_STATE_INIT          0x00    /*!< MQTT parser in initialized state */
 #define MQTT_PARSER_STATE_CALC_REM_LEN  0x01    /*!< MQTT parser in calculating remaining length state */
 #define MQTT_PARSER_STATE_READ_REM      0x02    /*!< MQTT parser in reading remaining bytes state */
+#if ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__
+#define MQTT_PARSER_STATE_READ_PUB_HDR  0x03    /*!< MQTT parser in reading PUBLISH variable header state */
+#define MQTT_PARSER_STATE_READ_PUB_DATA 0x04    /*!< MQTT parser in streaming PUBLISH payload state */
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__ */
 
 /* Get packet type from incoming byte */
 #define MQTT_RCV_GET_PACKET_TYPE(d)     ((mqtt_msg_type_t)(((d) >> 0x04) & 0x0F))
@@ -178,6 +263,16 @@ request_create(esp_mqtt_client_p client, uint16_t packet_id, void* arg) {
     esp_mqtt_request_t* request;
     uint16_t i;
 
+#if ESP_CFG_MQTT_INFLIGHT_WINDOW > 0
+    /* Oldest request in window still waits for acknowledge */
+    if (packet_id > 0
+        && client->requests_inflight[packet_id & (ESP_CFG_MQTT_INFLIGHT_WINDOW - 1)] != NULL) {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+            "[MQTT] In-flight window is full for pkt_id: %d\r\n", (int)packet_id);
+        return NULL;
+    }
+#endif /* ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 */
+
     /* Try to find a new request which does not have IN_USE flag set */
     for (request = NULL, i = 0; i < ESP_CFG_MQTT_MAX_REQUESTS; ++i) {
         if (!(client->requests[i].status & MQTT_REQUEST_FLAG_IN_USE)) {
@@ -189,6 +284,11 @@ request_create(esp_mqtt_client_p client, uint16_t packet_id, void* arg) {
         request->packet_id = packet_id;         /* Set request packet ID */
         request->arg = arg;                     /* Set user argument */
         request->status = MQTT_REQUEST_FLAG_IN_USE; /* Reset everything at this point */
+#if ESP_CFG_MQTT_INFLIGHT_WINDOW > 0
+        if (packet_id > 0) {
+            client->requests_inflight[packet_id & (ESP_CFG_MQTT_INFLIGHT_WINDOW - 1)] = request;
+        }
+#endif /* ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 */
     }
     return request;
 }
@@ -201,7 +301,13 @@ request_create(esp_mqtt_client_p client, uint16_t packet_id, void* arg) {
 static void
 request_delete(esp_mqtt_client_p client, esp_mqtt_request_t* request) {
     request->status = 0;                        /* Reset status to make request unused */
+#if ESP_CFG_MQTT_INFLIGHT_WINDOW > 0
+    if (request->packet_id > 0) {
+        client->requests_inflight[request->packet_id & (ESP_CFG_MQTT_INFLIGHT_WINDOW - 1)] = NULL;
+    }
+#else /* ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 */
     ESP_UNUSED(client);
+#endif /* !(ESP_CFG_MQTT_INFLIGHT_WINDOW > 0) */
 }
 
 /**
@@ -224,6 +330,17 @@ request_set_pending(esp_mqtt_client_p client, esp_mqtt_request_t* request) {
  */
 static esp_mqtt_request_t *
 request_get_pending(esp_mqtt_client_p client, int32_t pkt_id) {
+#if ESP_CFG_MQTT_INFLIGHT_WINDOW > 0
+    /* Requests with packet ID are indexed */
+    if (pkt_id > 0) {
+        esp_mqtt_request_t* request = client->requests_inflight[pkt_id & (ESP_CFG_MQTT_INFLIGHT_WINDOW - 1)];
+        if (request != NULL && (request->status & MQTT_REQUEST_FLAG_PENDING)
+            && request->packet_id == (uint16_t)pkt_id) {
+            return request;
+        }
+        return NULL;
+    }
+#endif /* ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 */
     /* Try to find a new request which does not have IN_USE flag set */
     for (size_t i = 0; i < ESP_CFG_MQTT_MAX_REQUESTS; ++i) {
         if ((client->requests[i].status & MQTT_REQUEST_FLAG_PENDING)
@@ -330,26 +447,203 @@ write_data(esp_mqtt_client_p client, const void* data, size_t len) {
 
 /**
  * \brief           Check if output buffer has enough memory to handle
- *                  all bytes required to encode packet to RAW format
+ *                  all bytes required to encode packet to RAW format,
+ *                  except part of packet which is not written to buffer
  *
  *                  It calculates additional bytes required to encode
  *                  remaining length itself + 1 byte for packet header
  * \param[in]       client: MQTT client
  * \param[in]       rem_len: Remaining length of packet
- * \return          Number of required RAW bytes or `0` if no memory available
+ * \param[in]       ext_len: Number of packet bytes sent directly from user memory
+ * \return          Number of required RAW bytes of entire packet or `0` if no memory available
  */
-static uint16_t
-output_check_enough_memory(esp_mqtt_client_p client, uint16_t rem_len) {
-    uint16_t total_len = rem_len + 1;           /* Remaining length + first (packet start) byte */
+static uint32_t
+output_check_enough_memory_ext(esp_mqtt_client_p client, uint32_t rem_len, uint32_t ext_len) {
+    uint32_t total_len = rem_len + 1;           /* Remaining length + first (packet start) byte */
 
     do {                                        /* Calculate bytes for encoding remaining length itself */
         ++total_len;
         rem_len >>= 7;                          /* Encoded with 7 bits per byte */
     } while (rem_len > 0);
 
-    return ESP_U16(esp_buff_get_free(&client->tx_buff)) >= total_len ? total_len : 0;
+    return esp_buff_get_free(&client->tx_buff) >= (total_len - ext_len) ? total_len : 0;
+}
+
+/**
+ * \brief           Check if output buffer has enough memory to handle
+ *                  all bytes required to encode packet to RAW format
+ * \param[in]       client: MQTT client
+ * \param[in]       rem_len: Remaining length of packet
+ * \return          Number of required RAW bytes or `0` if no memory available
+ */
+static uint16_t
+output_check_enough_memory(esp_mqtt_client_p client, uint16_t rem_len) {
+    return ESP_U16(output_check_enough_memory_ext(client, rem_len, 0));
+}
+
+#if ESP_CFG_MQTT_V5 || __DOXYGEN__
+
+/**
+ * \brief           Get number of bytes to encode variable byte integer
+ * \param[in]       num: Number to encode
+ * \return          Number of bytes
+ */
+static uint8_t
+mqtt_var_int_len(uint32_t num) {
+    uint8_t len = 0;
+    do {
+        ++len;
+        num >>= 7;
+    } while (num > 0);
+    return len;
+}
+
+/**
+ * \brief           Write variable byte integer to output buffer
+ * \param[in]       client: MQTT client
+ * \param[in]       num: Number to write
+ */
+static void
+write_var_int(esp_mqtt_client_p client, uint32_t num) {
+    do {
+        write_u8(client, ESP_U8((num & 0x7F) | (num > 0x7F ? 0x80 : 0)));
+        num >>= 7;
+    } while (num > 0);
+}
+
+/**
+ * \brief           Read variable byte integer from received data
+ * \param[in]       d: Received data
+ * \param[in]       len: Length of received data
+ * \param[out]      num: Output variable for decoded number
+ * \return          Number of bytes used by encoded number or `0` if not valid
+ */
+static size_t
+read_var_int(const uint8_t* d, size_t len, uint32_t* num) {
+    *num = 0;
+    for (size_t i = 0; i < len && i < 4; ++i) {
+        *num |= (uint32_t)(d[i] & 0x7F) << (7 * i);
+        if (!(d[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Get length of MQTT 5 property value
+ * \param[in]       id: Property identifier
+ * \param[in]       d: Property value data
+ * \param[in]       len: Length of available data
+ * \return          Length of property value or `0` if not valid
+ */
+static size_t
+mqtt_v5_prop_len(uint8_t id, const uint8_t* d, size_t len) {
+    uint32_t num;
+    size_t l;
+
+    switch (id) {
+        case 0x01: case 0x17: case 0x19: case 0x24:
+        case 0x25: case 0x28: case 0x29: case 0x2A:
+            l = 1;                              /* Byte */
+            break;
+        case 0x13: case 0x21: case 0x22: case 0x23:
+            l = 2;                              /* Two byte integer */
+            break;
+        case 0x02: case 0x11: case 0x18: case 0x27:
+            l = 4;                              /* Four byte integer */
+            break;
+        case 0x0B:                              /* Variable byte integer */
+            l = read_var_int(d, len, &num);
+            break;
+        case 0x03: case 0x08: case 0x09: case 0x12:
+        case 0x15: case 0x16: case 0x1A: case 0x1C: case 0x1F:
+            l = len >= 2 ? (2 + ((d[0] << 8) | d[1])) : 0;  /* String or binary data */
+            break;
+        case 0x26:                              /* String pair */
+            l = len >= 2 ? (2 + ((d[0] << 8) | d[1])) : 0;
+            if (l > 0 && len >= (l + 2)) {
+                l += 2 + ((d[l] << 8) | d[l + 1]);
+            } else {
+                l = 0;
+            }
+            break;
+        default:
+            l = 0;
+    }
+    return l <= len ? l : 0;
+}
+
+/**
+ * \brief           Parse properties of received packet
+ * \param[in]       client: MQTT client
+ * \param[in]       d: Received data, starting with properties length
+ * \param[in]       len: Length of available data
+ * \return          Number of bytes used by properties including its length or `0` if not valid
+ */
+static size_t
+mqtt_v5_parse_props(esp_mqtt_client_p client, const uint8_t* d, size_t len) {
+    uint32_t props_len;
+    size_t i, l, hdr_len;
+
+    if ((hdr_len = read_var_int(d, len, &props_len)) == 0
+        || (hdr_len + props_len) > len) {
+        return 0;
+    }
+    d += hdr_len;
+    for (i = 0; i < props_len; i += 1 + l) {
+        if ((l = mqtt_v5_prop_len(d[i], &d[i + 1], props_len - i - 1)) == 0) {
+            return 0;
+        }
+        if (MQTT_RCV_GET_PACKET_TYPE(client->msg_hdr_byte) == MQTT_MSG_TYPE_CONNACK) {
+            if (d[i] == MQTT_PROP_TOPIC_ALIAS_MAX) {
+                client->topic_alias_max = (d[i + 1] << 8) | d[i + 2];
+            } else if (d[i] == MQTT_PROP_MAX_PACKET_SIZE) {
+                client->max_packet_size = ((uint32_t)d[i + 1] << 24) | ((uint32_t)d[i + 2] << 16)
+                                            | ((uint32_t)d[i + 3] << 8) | d[i + 4];
+            }
+        }
+    }
+    return hdr_len + props_len;
 }
 
+/**
+ * \brief           Get topic alias for PUBLISH packet
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic to get alias for
+ * \param[in]       len: Length of topic
+ * \param[out]      is_new: Set to `1` if alias is free and topic must be sent with it, `0` otherwise
+ * \return          Alias value or `0` if topic has no alias
+ */
+static uint16_t
+mqtt_v5_topic_alias_get(esp_mqtt_client_p client, const char* topic, uint16_t len, uint8_t* is_new) {
+    *is_new = 0;
+    for (size_t i = 0; i < ESP_CFG_MQTT_V5_TOPIC_ALIASES && i < client->topic_alias_max; ++i) {
+        if (client->topic_aliases[i] == NULL) {
+            *is_new = 1;
+            return ESP_U16(i + 1);
+        } else if (!strncmp(client->topic_aliases[i], topic, len) && client->topic_aliases[i][len] == '\0') {
+            return ESP_U16(i + 1);
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Free all topic aliases
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_v5_topic_alias_reset(esp_mqtt_client_p client) {
+    for (size_t i = 0; i < ESP_CFG_MQTT_V5_TOPIC_ALIASES; ++i) {
+        esp_mem_free_s((void **)&client->topic_aliases[i]);
+    }
+    client->topic_alias_max = 0;
+    client->max_packet_size = 0;
+}
+
+#endif /* ESP_CFG_MQTT_V5 || __DOXYGEN__ */
+
 /**
  * \brief           Write and send acknowledge/record
  * \param[in]       client: MQTT client
@@ -386,6 +680,39 @@ write_string(esp_mqtt_client_p client, const char* str, uint16_t len) {
     esp_buff_write(&client->tx_buff, str, len); /* Write string to buffer */
 }
 
+#if ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__
+
+/**
+ * \brief           Give payload memory back to user
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_publish_ref_release(esp_mqtt_client_p client) {
+    const void* data = client->ref_data;
+
+    client->ref_data = NULL;
+    client->ref_len = 0;
+    client->ref_hdr_rem = 0;
+    if (client->ref_release_fn != NULL) {
+        client->ref_release_fn(data, client->ref_release_arg);
+    }
+}
+
+/**
+ * \brief           Connection layer finished using payload memory
+ * \param[in]       data: Payload memory
+ * \param[in]       arg: MQTT client
+ */
+static void
+mqtt_publish_ref_release_cb(const void* data, void* arg) {
+    esp_mqtt_client_p client = arg;
+
+    ESP_UNUSED(data);
+    mqtt_publish_ref_release(client);
+}
+
+#endif /* ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__ */
+
 /**
  * \brief           Send the actual data to the remote
  * \param[in]       client: MQTT client
@@ -399,7 +726,29 @@ send_data(esp_mqtt_client_p client) {
         return;
     }
 
+#if ESP_CFG_MQTT_PUBLISH_REF
+    if (client->ref_data != NULL && !client->ref_sending && client->ref_hdr_rem == 0) {
+        espr_t res;
+        /* Packet header was sent, continue with payload directly from user memory */
+        if ((res = esp_conn_send_ref(client->conn, client->ref_data, client->ref_len,
+                mqtt_publish_ref_release_cb, client, 0)) == espOK) {
+            client->written_total += client->ref_len;
+            client->is_sending = 1;
+            client->ref_sending = 1;
+        } else {
+            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+                "[MQTT] Cannot send payload with error: %d\r\n", (int)res);
+        }
+        return;
+    }
+#endif /* ESP_CFG_MQTT_PUBLISH_REF */
+
     len = esp_buff_get_linear_block_read_length(&client->tx_buff);  /* Get length of linear memory */
+#if ESP_CFG_MQTT_PUBLISH_REF
+    if (client->ref_data != NULL && !client->ref_sending) {
+        len = ESP_MIN(len, client->ref_hdr_rem);/* Stop at the point where payload is inserted */
+    }
+#endif /* ESP_CFG_MQTT_PUBLISH_REF */
     if (len > 0) {                                  /* Anything to send? */
         espr_t res;
         addr = esp_buff_get_linear_block_read_address(&client->tx_buff);/* Get address of linear memory */
@@ -421,6 +770,73 @@ send_data(esp_mqtt_client_p client) {
     }
 }
 
+#if ESP_CFG_MQTT_TX_LINGER_TIME > 0 || __DOXYGEN__
+
+/**
+ * \brief           Linger timeout callback, send all queued data
+ * \param[in]       arg: MQTT client
+ */
+static void
+send_data_linger_cb(void* arg) {
+    esp_mqtt_client_p client = arg;
+
+    client->linger_active = 0;
+    send_data(client);
+}
+
+/**
+ * \brief           Stop pending linger timeout
+ * \param[in]       client: MQTT client
+ */
+static void
+send_data_linger_stop(esp_mqtt_client_p client) {
+    if (client->linger_active) {
+#if ESP_CFG_TIMEOUT_WHEEL
+        esp_timeout_stop(&client->linger_timeout);
+#else /* ESP_CFG_TIMEOUT_WHEEL */
+        esp_timeout_remove(send_data_linger_cb);
+#endif /* !ESP_CFG_TIMEOUT_WHEEL */
+        client->linger_active = 0;
+    }
+}
+
+#endif /* ESP_CFG_MQTT_TX_LINGER_TIME > 0 || __DOXYGEN__ */
+
+/**
+ * \brief           Send data to the remote after linger time
+ *
+ * Data are sent immediately if there is enough of them in output buffer,
+ * otherwise linger timeout is started and more packets can be written to output buffer
+ * before they are all sent with single command.
+ *
+ * If sending is already in progress, data are sent after current send finishes
+ *
+ * \param[in]       client: MQTT client
+ */
+static void
+send_data_linger(esp_mqtt_client_p client) {
+#if ESP_CFG_MQTT_TX_LINGER_TIME > 0
+    if (!client->is_sending
+#if ESP_CFG_MQTT_TX_LINGER_LEN > 0
+        && esp_buff_get_full(&client->tx_buff) < ESP_CFG_MQTT_TX_LINGER_LEN
+#endif /* ESP_CFG_MQTT_TX_LINGER_LEN > 0 */
+        ) {
+        if (!client->linger_active) {
+#if ESP_CFG_TIMEOUT_WHEEL
+            esp_timeout_start(&client->linger_timeout, ESP_CFG_MQTT_TX_LINGER_TIME, send_data_linger_cb, client);
+            client->linger_active = 1;
+#else /* ESP_CFG_TIMEOUT_WHEEL */
+            client->linger_active = esp_timeout_add(ESP_CFG_MQTT_TX_LINGER_TIME, send_data_linger_cb, client) == espOK;
+#endif /* !ESP_CFG_TIMEOUT_WHEEL */
+        }
+        if (client->linger_active) {
+            return;
+        }
+    }
+#endif /* ESP_CFG_MQTT_TX_LINGER_TIME > 0 */
+    send_data(client);
+}
+
 /**
  * \brief           Close a MQTT connection with server
  * \param[in]       client: MQTT client
@@ -469,6 +885,9 @@ sub_unsub(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, void*
     if (sub) {
         ++rem_len;
     }
+#if ESP_CFG_MQTT_V5
+    ++rem_len;                                  /* Properties length */
+#endif /* ESP_CFG_MQTT_V5 */
 
     esp_core_lock();
     if (client->conn_state == ESP_MQTT_CONNECTED
@@ -478,6 +897,9 @@ sub_unsub(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, void*
         if (request != NULL) {                  /* Do we have a request */
             write_fixed_header(client, sub ? MQTT_MSG_TYPE_SUBSCRIBE : MQTT_MSG_TYPE_UNSUBSCRIBE, 0, (esp_mqtt_qos_t)1, 0, rem_len);
             write_u16(client, pkt_id);          /* Write packet ID */
+#if ESP_CFG_MQTT_V5
+            write_var_int(client, 0);           /* Properties length */
+#endif /* ESP_CFG_MQTT_V5 */
             write_string(client, topic, len_topic); /* Write topic string to packet */
             if (sub) {                          /* Send quality of service only on subscribe */
                 write_u8(client, ESP_MIN(ESP_U8(qos), ESP_U8(ESP_MQTT_QOS_EXACTLY_ONCE)));  /* Write quality of service */
@@ -493,6 +915,288 @@ sub_unsub(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, void*
     return ret;
 }
 
+#if ESP_CFG_MQTT_RESUBSCRIBE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Remember or forget subscription
+ * \note            Core must be locked when calling this function
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Subscribed or unsubscribed topic
+ * \param[in]       qos: Quality of service, used only on subscribe
+ * \param[in]       sub: Set to `1` to remember subscription, `0` to forget it
+ */
+static void
+mqtt_subs_update(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, uint8_t sub) {
+    size_t i, free_idx = ESP_CFG_MQTT_RESUBSCRIBE, len;
+
+    for (i = 0; i < ESP_CFG_MQTT_RESUBSCRIBE; ++i) {
+        if (client->subs[i] == NULL) {
+            if (free_idx == ESP_CFG_MQTT_RESUBSCRIBE) {
+                free_idx = i;
+            }
+        } else if (!strcmp(client->subs[i], topic)) {
+            break;
+        }
+    }
+    if (!sub) {
+        if (i < ESP_CFG_MQTT_RESUBSCRIBE) {
+            esp_mem_free_s((void **)&client->subs[i]);
+        }
+        return;
+    }
+    if (i == ESP_CFG_MQTT_RESUBSCRIBE) {        /* New topic */
+        ESP_DEBUGW(ESP_CFG_DBG_MQTT_TRACE_WARNING, free_idx == ESP_CFG_MQTT_RESUBSCRIBE,
+            "[MQTT] No free entry to remember subscription\r\n");
+        if (free_idx == ESP_CFG_MQTT_RESUBSCRIBE) {
+            return;
+        }
+        len = strlen(topic) + 1;
+        if ((client->subs[free_idx] = esp_mem_malloc_tag(len, ESP_MEM_TAG_MQTT)) == NULL) {
+            return;
+        }
+        ESP_MEMCPY(client->subs[free_idx], topic, len);
+        i = free_idx;
+    }
+    client->subs_qos[i] = qos;
+}
+
+/**
+ * \brief           Subscribe again to all remembered topics
+ * \note            Core must be locked when calling this function
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_subs_resubscribe(esp_mqtt_client_p client) {
+    for (size_t i = 0; i < ESP_CFG_MQTT_RESUBSCRIBE; ++i) {
+        if (client->subs[i] != NULL && !sub_unsub(client, client->subs[i], client->subs_qos[i], NULL, 1)) {
+            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+                "[MQTT] Cannot subscribe again to %s\r\n", client->subs[i]);
+        }
+    }
+}
+
+/**
+ * \brief           Forget all subscriptions
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_subs_free(esp_mqtt_client_p client) {
+    for (size_t i = 0; i < ESP_CFG_MQTT_RESUBSCRIBE; ++i) {
+        esp_mem_free_s((void **)&client->subs[i]);
+    }
+}
+
+#endif /* ESP_CFG_MQTT_RESUBSCRIBE > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__
+
+/**
+ * \brief           Get length of first topic level
+ * \param[in]       topic: Topic or topic filter
+ * \param[in]       len: Length of topic
+ * \return          Length of level up to first `/` character or end of topic
+ */
+static size_t
+mqtt_topic_level_len(const char* topic, size_t len) {
+    size_t i;
+    for (i = 0; i < len && topic[i] != '/'; ++i) {}
+    return i;
+}
+
+/**
+ * \brief           Check if trie node is single level wildcard
+ * \param[in]       n: Trie node
+ */
+#define MQTT_TOPIC_NODE_IS_PLUS(n)      ((n)->level_len == 1 && (n)->level[0] == '+')
+
+/**
+ * \brief           Check if trie node is multi level wildcard
+ * \param[in]       n: Trie node
+ */
+#define MQTT_TOPIC_NODE_IS_HASH(n)      ((n)->level_len == 1 && (n)->level[0] == '#')
+
+/**
+ * \brief           Call all handlers on trie level matching received topic
+ * \param[in]       client: MQTT client
+ * \param[in]       node: First node on trie level
+ * \param[in]       topic: Remaining part of received topic
+ * \param[in]       len: Length of remaining topic
+ * \param[in]       wildcard: Set to `1` if wildcards can match current level, `0` otherwise
+ * \return          `1` if at least one handler was called, `0` otherwise
+ */
+static uint8_t
+mqtt_topic_trie_dispatch(esp_mqtt_client_p client, esp_mqtt_topic_node_t* node,
+                         const char* topic, size_t len, uint8_t wildcard) {
+    size_t level_len;
+    uint8_t matched = 0;
+
+    level_len = mqtt_topic_level_len(topic, len);
+    for (; node != NULL; node = node->next) {
+        if (MQTT_TOPIC_NODE_IS_HASH(node)) {
+            if (wildcard && node->fn != NULL) {
+                node->fn(client, &client->evt, node->arg);
+                matched = 1;
+            }
+        } else if ((wildcard && MQTT_TOPIC_NODE_IS_PLUS(node))
+            || (node->level_len == level_len && !strncmp(node->level, topic, level_len))) {
+            if (level_len == len) {             /* Last level of received topic */
+                if (node->fn != NULL) {
+                    node->fn(client, &client->evt, node->arg);
+                    matched = 1;
+                }
+
+                /* Filter "a/#" matches topic "a" too */
+                for (esp_mqtt_topic_node_t* c = node->child; c != NULL; c = c->next) {
+                    if (MQTT_TOPIC_NODE_IS_HASH(c) && c->fn != NULL) {
+                        c->fn(client, &client->evt, c->arg);
+                        matched = 1;
+                    }
+                }
+            } else {
+                matched |= mqtt_topic_trie_dispatch(client, node->child,
+                    topic + level_len + 1, len - level_len - 1, 1);
+            }
+        }
+    }
+    return matched;
+}
+
+/**
+ * \brief           Remove handler from trie and delete unused nodes
+ * \param[in]       node_ptr: Pointer to first node on trie level
+ * \param[in]       filter: Remaining part of topic filter
+ * \param[in]       len: Length of remaining topic filter
+ * \return          `1` if handler was found and removed, `0` otherwise
+ */
+static uint8_t
+mqtt_topic_trie_remove(esp_mqtt_topic_node_t** node_ptr, const char* filter, size_t len) {
+    esp_mqtt_topic_node_t* node;
+    size_t level_len;
+    uint8_t res = 0;
+
+    level_len = mqtt_topic_level_len(filter, len);
+    for (; (node = *node_ptr) != NULL; node_ptr = &node->next) {
+        if (node->level_len == level_len && !strncmp(node->level, filter, level_len)) {
+            break;
+        }
+    }
+    if (node == NULL) {
+        return 0;
+    }
+    if (level_len == len) {
+        res = node->fn != NULL;
+        node->fn = NULL;
+        node->arg = NULL;
+    } else {
+        res = mqtt_topic_trie_remove(&node->child, filter + level_len + 1, len - level_len - 1);
+    }
+
+    /* Delete node which has no handler and no next level */
+    if (node->fn == NULL && node->child == NULL) {
+        *node_ptr = node->next;
+        esp_mem_free(node);
+    }
+    return res;
+}
+
+/**
+ * \brief           Delete trie level with all next levels
+ * \param[in]       node: First node on trie level
+ */
+static void
+mqtt_topic_trie_free(esp_mqtt_topic_node_t* node) {
+    esp_mqtt_topic_node_t* next;
+
+    for (; node != NULL; node = next) {
+        next = node->next;
+        mqtt_topic_trie_free(node->child);
+        esp_mem_free(node);
+    }
+}
+
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__ */
+
+/**
+ * \brief           Process variable header of received PUBLISH packet
+ *
+ * Variable header (topic length, topic and packet ID) must be available in RX buffer.
+ * Function sends response to server if quality of service is more than `0`
+ *
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_process_publish_hdr(esp_mqtt_client_p client) {
+    esp_mqtt_qos_t qos;
+    uint16_t topic_len, pkt_id;
+
+    qos = MQTT_RCV_GET_PACKET_QOS(client->msg_hdr_byte);    /* Get QoS from received packet */
+    topic_len = (client->rx_buff[0] << 8) | client->rx_buff[1];
+
+    /* Packet ID is only available if quality of service is not 0 */
+    if (qos > 0) {
+        pkt_id = (client->rx_buff[2 + topic_len] << 8) | client->rx_buff[2 + topic_len + 1];/* Get packet ID */
+    } else {
+        pkt_id = 0;                             /* No packet ID */
+    }
+
+    ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE,
+        "[MQTT] Publish packet received on topic %.*s; QoS: %d; pkt_id: %d\r\n",
+        (int)topic_len, (const char *)&client->rx_buff[2], (int)qos, (int)pkt_id);
+
+    /*
+     * We have to send respond to command if
+     * Quality of Service is more than 0
+     *
+     * Response type depends on QoS and is
+     * either PUBACK or PUBREC
+     */
+    if (qos > 0) {                              /* We have to reply on QoS > 0 */
+        mqtt_msg_type_t resp_msg_type = qos == 1 ? MQTT_MSG_TYPE_PUBACK : MQTT_MSG_TYPE_PUBREC;
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Sending publish resp: %s on pkt_id: %d\r\n", \
+                    mqtt_msg_type_to_str(resp_msg_type), (int)pkt_id);
+
+        write_ack_rec_rel_resp(client, resp_msg_type, pkt_id, qos);
+    }
+}
+
+/**
+ * \brief           Notify application layer about received PUBLISH payload
+ *
+ * Topic must be available in RX buffer
+ *
+ * \param[in]       client: MQTT client
+ * \param[in]       data: Payload data
+ * \param[in]       len: Length of payload data
+ * \param[in]       offset: Offset of data in entire payload
+ * \param[in]       total_len: Total length of packet payload
+ */
+static void
+mqtt_publish_recv_notify(esp_mqtt_client_p client, const void* data, size_t len, size_t offset, size_t total_len) {
+    client->evt.type = ESP_MQTT_EVT_PUBLISH_RECV;
+    client->evt.evt.publish_recv.topic = &client->rx_buff[2];
+    client->evt.evt.publish_recv.topic_len = (client->rx_buff[0] << 8) | client->rx_buff[1];
+    client->evt.evt.publish_recv.payload = data;
+    client->evt.evt.publish_recv.payload_len = len;
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+    client->evt.evt.publish_recv.payload_offset = offset;
+    client->evt.evt.publish_recv.payload_total_len = total_len;
+#else /* ESP_CFG_MQTT_PUBLISH_STREAM */
+    ESP_UNUSED(offset);
+    ESP_UNUSED(total_len);
+#endif /* !ESP_CFG_MQTT_PUBLISH_STREAM */
+    client->evt.evt.publish_recv.dup = MQTT_RCV_GET_PACKET_DUP(client->msg_hdr_byte);
+    client->evt.evt.publish_recv.qos = MQTT_RCV_GET_PACKET_QOS(client->msg_hdr_byte);
+#if ESP_CFG_MQTT_TOPIC_TRIE
+    /* Wildcards do not match topics starting with `$` character */
+    if (mqtt_topic_trie_dispatch(client, client->topic_trie,
+            (const char *)client->evt.evt.publish_recv.topic, client->evt.evt.publish_recv.topic_len,
+            client->evt.evt.publish_recv.topic_len == 0 || client->evt.evt.publish_recv.topic[0] != '$')) {
+        return;
+    }
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE */
+    client->evt_fn(client, &client->evt);
+}
+
 /**
  * \brief           Process incoming fully received message
  * \param[in]       client: MQTT client
@@ -514,9 +1218,17 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
     switch (msg_type) {
         case MQTT_MSG_TYPE_CONNACK: {
             esp_mqtt_conn_status_t err = (esp_mqtt_conn_status_t)client->rx_buff[1];
+#if ESP_CFG_MQTT_V5
+            if (client->msg_rem_len > 2) {      /* Get server limits from properties */
+                mqtt_v5_parse_props(client, &client->rx_buff[2], client->msg_rem_len - 2);
+            }
+#endif /* ESP_CFG_MQTT_V5 */
             if (client->conn_state == ESP_MQTT_CONNECTING) {
                 if (err == ESP_MQTT_CONN_STATUS_ACCEPTED) {
                     client->conn_state = ESP_MQTT_CONNECTED;
+#if ESP_CFG_MQTT_RESUBSCRIBE > 0
+                    mqtt_subs_resubscribe(client);  /* Restore subscriptions before user can subscribe */
+#endif /* ESP_CFG_MQTT_RESUBSCRIBE > 0 */
                 }
                 ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE,
                     "[MQTT] CONNACK received with result: %d\r\n", (int)err);
@@ -525,6 +1237,9 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
                 client->evt.type = ESP_MQTT_EVT_CONNECT;
                 client->evt.evt.connect.status = err;
                 client->evt_fn(client, &client->evt);
+#if ESP_CFG_MQTT_OFFLINE_QUEUE
+                mqtt_offline_flush(client);     /* Send packets queued while offline */
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE */
             } else {
                 /* Protocol violation here */
                 ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE,
@@ -534,10 +1249,9 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
         }
         case MQTT_MSG_TYPE_PUBLISH: {
             uint16_t topic_len, data_len;
-            uint8_t *topic, *data, dup;
+            uint8_t *topic, *data;
 
             qos = MQTT_RCV_GET_PACKET_QOS(client->msg_hdr_byte);    /* Get QoS from received packet */
-            dup = MQTT_RCV_GET_PACKET_DUP(client->msg_hdr_byte);    /* Get duplicate flag */
 
             topic_len = (client->rx_buff[0] << 8) | client->rx_buff[1];
             topic = &client->rx_buff[2];        /* Start of topic */
@@ -546,45 +1260,33 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
 
             /* Packet ID is only available if quality of service is not 0 */
             if (qos > 0) {
-                pkt_id = (client->rx_buff[2 + topic_len] << 8) | client->rx_buff[2 + topic_len + 1];/* Get packet ID */
                 data += 2;                      /* Increase pointer for 2 bytes */
-            } else {
-                pkt_id = 0;                     /* No packet ID */
             }
-            data_len = client->msg_rem_len - (data - client->rx_buff);  /* Calculate length of remaining data */
-
-            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE,
-                "[MQTT] Publish packet received on topic %.*s; QoS: %d; pkt_id: %d; data_len: %d\r\n",
-                (int)topic_len, (const char *)topic, (int)qos, (int)pkt_id, (int)data_len);
-
-            /*
-             * We have to send respond to command if
-             * Quality of Service is more than 0
-             *
-             * Response type depends on QoS and is
-             * either PUBACK or PUBREC
-             */
-            if (qos > 0) {                      /* We have to reply on QoS > 0 */
-                mqtt_msg_type_t resp_msg_type = qos == 1 ? MQTT_MSG_TYPE_PUBACK : MQTT_MSG_TYPE_PUBREC;
-                ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Sending publish resp: %s on pkt_id: %d\r\n", \
-                            mqtt_msg_type_to_str(resp_msg_type), (int)pkt_id);
-
-                write_ack_rec_rel_resp(client, resp_msg_type, pkt_id, qos);
+#if ESP_CFG_MQTT_V5
+            {
+                size_t props_len = 0;
+                if ((size_t)(data - client->rx_buff) < client->msg_rem_len) {
+                    props_len = mqtt_v5_parse_props(client, data, client->msg_rem_len - (data - client->rx_buff));
+                }
+                if (props_len == 0) {
+                    ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+                        "[MQTT] Invalid properties in publish packet\r\n");
+                    break;
+                }
+                data += props_len;              /* Skip publish properties */
             }
+#endif /* ESP_CFG_MQTT_V5 */
+            data_len = client->msg_rem_len - (data - client->rx_buff);  /* Calculate length of remaining data */
 
-            /* Notify application layer about received packet */
-            client->evt.type = ESP_MQTT_EVT_PUBLISH_RECV;
-            client->evt.evt.publish_recv.topic = topic;
-            client->evt.evt.publish_recv.topic_len = topic_len;
-            client->evt.evt.publish_recv.payload = data;
-            client->evt.evt.publish_recv.payload_len = data_len;
-            client->evt.evt.publish_recv.dup = dup;
-            client->evt.evt.publish_recv.qos = qos;
-            client->evt_fn(client, &client->evt);
+            mqtt_process_publish_hdr(client);   /* Send response to server */
+            mqtt_publish_recv_notify(client, data, data_len, 0, data_len);
             break;
         }
         case MQTT_MSG_TYPE_PINGRESP: {          /* Respond to PINGREQ received */
             ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Ping response received\r\n");
+#if ESP_CFG_MQTT_STATS
+            ++client->stats.pingresp_recv;
+#endif /* ESP_CFG_MQTT_STATS */
 
             client->evt.type = ESP_MQTT_EVT_KEEP_ALIVE;
             client->evt_fn(client, &client->evt);
@@ -596,9 +1298,38 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
         case MQTT_MSG_TYPE_PUBREL:
         case MQTT_MSG_TYPE_PUBACK:
         case MQTT_MSG_TYPE_PUBCOMP: {
+            espr_t res = espOK;
+
             pkt_id = client->rx_buff[0] << 8 | client->rx_buff[1];  /* Get packet ID */
 
-            if (msg_type == MQTT_MSG_TYPE_PUBREC) { /* Publish record received from server */
+#if ESP_CFG_MQTT_V5
+            /* Reason code is optional for publish acknowledges, and follows properties on (un)subscribe */
+            if (msg_type == MQTT_MSG_TYPE_SUBACK || msg_type == MQTT_MSG_TYPE_UNSUBACK) {
+                size_t props_len = client->msg_rem_len > 2 ? mqtt_v5_parse_props(client, &client->rx_buff[2], client->msg_rem_len - 2) : 0;
+                if (props_len == 0 || (2 + props_len) >= client->msg_rem_len || client->rx_buff[2 + props_len] >= 0x80) {
+                    res = espERR;
+                }
+            } else if (client->msg_rem_len > 2 && client->rx_buff[2] >= 0x80) {
+                res = espERR;
+            }
+#else /* ESP_CFG_MQTT_V5 */
+            if (msg_type == MQTT_MSG_TYPE_SUBACK || msg_type == MQTT_MSG_TYPE_UNSUBACK) {
+                res = client->rx_buff[2] < 3 ? espOK : espERR;
+            }
+#endif /* !ESP_CFG_MQTT_V5 */
+
+            if (msg_type == MQTT_MSG_TYPE_PUBREC && res != espOK) {
+                /* Server refused the packet, there is no PUBREL/PUBCOMP flow */
+                esp_mqtt_request_t* request = request_get_pending(client, pkt_id);
+                if (request != NULL) {
+                    void* arg = request->arg;
+                    request_delete(client, request);
+                    client->evt.type = ESP_MQTT_EVT_PUBLISH;
+                    client->evt.evt.publish.arg = arg;
+                    client->evt.evt.publish.res = res;
+                    client->evt_fn(client, &client->evt);
+                }
+            } else if (msg_type == MQTT_MSG_TYPE_PUBREC) { /* Publish record received from server */
                 write_ack_rec_rel_resp(client, MQTT_MSG_TYPE_PUBREL, pkt_id, (esp_mqtt_qos_t)1);    /* Send back publish release message */
             } else if (msg_type == MQTT_MSG_TYPE_PUBREL) {  /* Publish release was received */
                 write_ack_rec_rel_resp(client, MQTT_MSG_TYPE_PUBCOMP, pkt_id, (esp_mqtt_qos_t)0);   /* Send back publish complete */
@@ -621,7 +1352,7 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
                         || msg_type == MQTT_MSG_TYPE_UNSUBACK) {
                         client->evt.type = msg_type == MQTT_MSG_TYPE_SUBACK ? ESP_MQTT_EVT_SUBSCRIBE : ESP_MQTT_EVT_UNSUBSCRIBE;
                         client->evt.evt.sub_unsub_scribed.arg = request->arg;
-                        client->evt.evt.sub_unsub_scribed.res = client->rx_buff[2] < 3 ? espOK : espERR;
+                        client->evt.evt.sub_unsub_scribed.res = res;
                         client->evt_fn(client, &client->evt);
 
                     /*
@@ -632,7 +1363,7 @@ mqtt_process_incoming_message(esp_mqtt_client_p client) {
                             || msg_type == MQTT_MSG_TYPE_PUBACK) {
                         client->evt.type = ESP_MQTT_EVT_PUBLISH;
                         client->evt.evt.publish.arg = request->arg;
-                        client->evt.evt.publish.res = espOK;
+                        client->evt.evt.publish.res = res;
                         client->evt_fn(client, &client->evt);
                     }
                     request_delete(client, request);    /* Delete request object */
@@ -708,52 +1439,425 @@ mqtt_parse_incoming(esp_mqtt_client_p client, esp_pbuf_p pbuf) {
 
                                 mqtt_process_incoming_message(client);  /* Process new message */
 
-                                /* Reset to previous values */
-                                client->rx_buff = tmp_ptr;
-                                client->rx_buff_len = tmp_len;
-                                client->parser_state = MQTT_PARSER_STATE_INIT;
+                                /* Reset to previous values */
+                                client->rx_buff = tmp_ptr;
+                                client->rx_buff_len = tmp_len;
+                                client->parser_state = MQTT_PARSER_STATE_INIT;
+
+                                idx += client->msg_rem_len; /* Skip data part only, idx is increased again in for loop */
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+                            } else if (MQTT_RCV_GET_PACKET_TYPE(client->msg_hdr_byte) == MQTT_MSG_TYPE_PUBLISH) {
+                                client->parser_state = MQTT_PARSER_STATE_READ_PUB_HDR;
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+                            } else {
+                                client->parser_state = MQTT_PARSER_STATE_READ_REM;
+                            }
+                        } else {
+                            mqtt_process_incoming_message(client);
+                            client->parser_state = MQTT_PARSER_STATE_INIT;
+                        }
+                    }
+                    break;
+                }
+                case MQTT_PARSER_STATE_READ_REM: {  /* Read remaining bytes and write to RX buffer */
+                    /* Process only if rx buff length is big enough */
+                    if (client->msg_curr_pos < client->rx_buff_len) {
+                        client->rx_buff[client->msg_curr_pos] = ch; /* Write received character */
+                    }
+                    ++client->msg_curr_pos;
+
+                    /* We reached end of received characters? */
+                    if (client->msg_curr_pos == client->msg_rem_len) {
+                        if (client->msg_curr_pos <= client->rx_buff_len) {  /* Check if it was possible to write all data to rx buffer */
+                            ESP_DEBUGF(ESP_CFG_DBG_MQTT_STATE,
+                                "[MQTT] Packet parsed and ready for processing\r\n");
+
+                            mqtt_process_incoming_message(client);  /* Process incoming packet */
+                        } else {
+                            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+                                "[MQTT] Packet too big for rx buffer. Packet discarded\r\n");
+                        }
+                        client->parser_state = MQTT_PARSER_STATE_INIT;  /* Go to initial state and listen for next received packet */
+                    }
+                    break;
+                }
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+                case MQTT_PARSER_STATE_READ_PUB_HDR: {  /* Read PUBLISH topic and packet ID to RX buffer */
+                    if (client->msg_curr_pos < client->rx_buff_len) {
+                        client->rx_buff[client->msg_curr_pos] = ch; /* Write received character */
+                    }
+                    ++client->msg_curr_pos;
+
+                    /* Topic length received, calculate variable header length */
+                    if (client->msg_curr_pos == 2) {
+                        client->msg_pub_hdr_len = 2 + ((client->rx_buff[0] << 8) | client->rx_buff[1]);
+                        if (MQTT_RCV_GET_PACKET_QOS(client->msg_hdr_byte) > 0) {
+                            client->msg_pub_hdr_len += 2;   /* Packet ID is part of header */
+                        }
+#if ESP_CFG_MQTT_V5
+                        client->msg_pub_props_pos = client->msg_pub_hdr_len;
+                        ++client->msg_pub_hdr_len;  /* At least one byte for properties length */
+#endif /* ESP_CFG_MQTT_V5 */
+
+                        /*
+                         * Header must fit to RX buffer and must be part of packet,
+                         * otherwise continue with default read, which discards the packet
+                         */
+                        if (client->msg_pub_hdr_len > client->rx_buff_len
+                            || client->msg_pub_hdr_len > client->msg_rem_len) {
+                            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+                                "[MQTT] Publish topic too big for rx buffer\r\n");
+                            client->parser_state = MQTT_PARSER_STATE_READ_REM;
+                            break;
+                        }
+                    }
+
+#if ESP_CFG_MQTT_V5
+                    /* Properties length received, properties are part of header */
+                    if (client->msg_pub_props_pos > 0 && client->msg_curr_pos > client->msg_pub_props_pos) {
+                        if (ch & 0x80) {
+                            ++client->msg_pub_hdr_len;  /* Properties length has more bytes */
+                        } else {
+                            uint32_t props_len;
+
+                            read_var_int(&client->rx_buff[client->msg_pub_props_pos],
+                                client->msg_curr_pos - client->msg_pub_props_pos, &props_len);
+                            client->msg_pub_hdr_len = client->msg_curr_pos + props_len;
+                            client->msg_pub_props_pos = 0;
+                        }
+                        if (client->msg_pub_hdr_len > client->rx_buff_len
+                            || client->msg_pub_hdr_len > client->msg_rem_len
+                            || (client->msg_pub_props_pos > 0 && (client->msg_curr_pos - client->msg_pub_props_pos) >= 4)) {
+                            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
+                                "[MQTT] Publish properties too big for rx buffer\r\n");
+                            client->parser_state = MQTT_PARSER_STATE_READ_REM;
+                            break;
+                        }
+                    }
+#endif /* ESP_CFG_MQTT_V5 */
+
+                    /* Variable header received, start with payload */
+                    if (client->msg_curr_pos > 1 && client->msg_curr_pos == client->msg_pub_hdr_len) {
+                        mqtt_process_publish_hdr(client);   /* Send response to server */
+                        if (client->msg_curr_pos == client->msg_rem_len) {
+                            mqtt_publish_recv_notify(client, NULL, 0, 0, 0);
+                            client->parser_state = MQTT_PARSER_STATE_INIT;
+                        } else {
+                            client->parser_state = MQTT_PARSER_STATE_READ_PUB_DATA;
+                        }
+                    }
+                    break;
+                }
+                case MQTT_PARSER_STATE_READ_PUB_DATA: { /* Report payload directly from pbuf */
+                    size_t len;
+
+                    len = ESP_MIN(buff_len - idx, (size_t)(client->msg_rem_len - client->msg_curr_pos));
+                    mqtt_publish_recv_notify(client, &d[idx], len,
+                        client->msg_curr_pos - client->msg_pub_hdr_len,
+                        client->msg_rem_len - client->msg_pub_hdr_len);
+
+                    client->msg_curr_pos += len;
+                    idx += len - 1;             /* Skip data part only, idx is increased again in for loop */
+                    if (client->msg_curr_pos == client->msg_rem_len) {
+                        client->parser_state = MQTT_PARSER_STATE_INIT;
+                    }
+                    break;
+                }
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+                default:
+                    client->parser_state = MQTT_PARSER_STATE_INIT;
+            }
+        }
+    } while (buff_len > 0);
+    return 0;
+}
+
+/**
+ * \brief           Write PUBLISH packet to output buffer and start sending
+ * \note            Core must be locked and client connected when calling this function
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic to send message to
+ * \param[in]       len_topic: Length of topic
+ * \param[in]       payload: Message data
+ * \param[in]       payload_len: Length of payload data
+ * \param[in]       by_ref: Set to `1` to send payload from user memory instead of copying it to output buffer
+ * \param[in]       qos: Quality of service
+ * \param[in]       retain: Retain parameter value
+ * \param[in]       arg: User custom argument used in callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+mqtt_publish_write(esp_mqtt_client_p client, const char* topic, uint16_t len_topic, const void* payload,
+                    uint16_t payload_len, uint8_t by_ref, esp_mqtt_qos_t qos, uint8_t retain, void* arg) {
+    espr_t res = espOK;
+    esp_mqtt_request_t* request = NULL;
+    uint32_t rem_len, raw_len;
+    uint16_t pkt_id;
+    uint8_t qos_u8 = ESP_U8(qos), track = 1;
+#if ESP_CFG_MQTT_V5
+    char* alias_topic = NULL;
+    uint16_t alias;
+    uint8_t alias_new;
+#endif /* ESP_CFG_MQTT_V5 */
+
+    /*
+     * Calculate remaining length of packet
+     *
+     * rem_len = 2 (topic_len) + topic_len + 2 (pkt_idm only if qos > 0) + payload_len
+     */
+    rem_len = 2 + len_topic + (payload != NULL ? payload_len : 0);
+    if (qos_u8 > 0) {
+        rem_len += 2;
+    }
+
+#if ESP_CFG_MQTT_V5
+    /* Use topic alias when available, new alias needs copy of topic */
+    alias = mqtt_v5_topic_alias_get(client, topic, len_topic, &alias_new);
+    if (alias > 0 && alias_new) {
+        if ((alias_topic = esp_mem_malloc_tag(len_topic + 1, ESP_MEM_TAG_MQTT)) != NULL) {
+            ESP_MEMCPY(alias_topic, topic, len_topic);
+            alias_topic[len_topic] = '\0';
+        } else {
+            alias = 0;
+        }
+    }
+    rem_len += 1 + (alias > 0 ? 3 : 0);         /* Properties length and topic alias property */
+    if (alias > 0 && !alias_new) {
+        rem_len -= len_topic;                   /* Topic is replaced with alias */
+    }
+    if (client->max_packet_size > 0
+        && (rem_len + 1 + mqtt_var_int_len(rem_len)) > client->max_packet_size) {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING, "[MQTT] Publish packet exceeds server maximum packet size\r\n");
+        res = espERR;
+    } else
+#endif /* ESP_CFG_MQTT_V5 */
+    if ((raw_len = output_check_enough_memory_ext(client, rem_len, by_ref && payload != NULL ? payload_len : 0)) != 0) {
+        pkt_id = qos_u8 > 0 ? create_packet_id(client) : 0; /* Create new packet ID */
+#if ESP_CFG_MQTT_QOS0_FAST
+        track = qos_u8 > 0 || !client->qos0_fast;   /* QoS 0 send completion is not reported */
+#endif /* ESP_CFG_MQTT_QOS0_FAST */
+        if (track) {
+            request = request_create(client, pkt_id, arg);  /* Create request for packet */
+        }
+        if (request != NULL || !track) {
+            /*
+             * Set expected number of bytes we should send before
+             * we can say that this packet was sent.
+             * Used in case QoS is set to 0 where packet notification
+             * is not received by server. In this case, wait
+             * number of bytes sent before notifying user about success
+             */
+            if (request != NULL) {
+                request->expected_sent_len = client->written_total + raw_len;
+            }
+
+            write_fixed_header(client, MQTT_MSG_TYPE_PUBLISH, 0, (esp_mqtt_qos_t)ESP_MIN(qos_u8, ESP_U8(ESP_MQTT_QOS_EXACTLY_ONCE)), retain, rem_len);
+#if ESP_CFG_MQTT_V5
+            if (alias > 0 && !alias_new) {
+                write_u16(client, 0);           /* Empty topic, alias is used */
+            } else
+#endif /* ESP_CFG_MQTT_V5 */
+            write_string(client, topic, len_topic); /* Write topic string to packet */
+            if (qos_u8) {
+                write_u16(client, pkt_id);      /* Write packet ID */
+            }
+#if ESP_CFG_MQTT_V5
+            write_var_int(client, alias > 0 ? 3 : 0);   /* Properties length */
+            if (alias > 0) {
+                write_u8(client, MQTT_PROP_TOPIC_ALIAS);
+                write_u16(client, alias);
+                if (alias_new) {                /* Server learns alias with this packet */
+                    client->topic_aliases[alias - 1] = alias_topic;
+                    alias_topic = NULL;
+                }
+            }
+#endif /* ESP_CFG_MQTT_V5 */
+#if ESP_CFG_MQTT_PUBLISH_REF
+            if (by_ref && payload != NULL && payload_len) {
+                client->ref_data = payload;     /* Payload is sent after all bytes currently in buffer */
+                client->ref_len = payload_len;
+                client->ref_hdr_rem = esp_buff_get_full(&client->tx_buff);
+            } else
+#endif /* ESP_CFG_MQTT_PUBLISH_REF */
+            if (payload != NULL && payload_len) {
+                write_data(client, payload, payload_len);   /* Write RAW topic payload */
+            }
+            if (request != NULL) {
+                request_set_pending(client, request);   /* Set request as pending waiting for server reply */
+            }
+
+            send_data_linger(client);           /* Try to send data */
+
+            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE,
+                "[MQTT] Pkt publish start. QoS: %d, pkt_id: %d\r\n", (int)qos_u8, (int)pkt_id);
+        } else {
+            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] No free request available to publish message\r\n");
+            res = espERRMEM;
+        }
+    } else {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Not enough memory to publish message\r\n");
+        res = espERRMEM;
+    }
+#if ESP_CFG_MQTT_V5
+    esp_mem_free_s((void **)&alias_topic);      /* Free copy if alias was not used */
+#endif /* ESP_CFG_MQTT_V5 */
+    return res;
+}
+
+#if ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__
+
+/* Offline record header: flags (1), topic length (2), payload length (2), user argument */
+#define MQTT_OFFLINE_HDR_LEN            (5 + sizeof(void *))
+
+/**
+ * \brief           Add record to offline queue
+ * \param[in]       client: MQTT client
+ * \param[in]       data: Record data
+ * \param[in]       len: Length of record
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+mqtt_offline_push(esp_mqtt_client_p client, const void* data, size_t len) {
+    uint16_t l = ESP_U16(len);
+
+    if (client->offline_store != NULL) {
+        return client->offline_store->push(client->offline_store->arg, data, len);
+    }
+    if (esp_buff_get_free(&client->offline_buff) < (sizeof(l) + len)) {
+        return 0;
+    }
+    esp_buff_write(&client->offline_buff, &l, sizeof(l));   /* Each record starts with its length */
+    esp_buff_write(&client->offline_buff, data, len);
+    return 1;
+}
+
+/**
+ * \brief           Get oldest record from offline queue
+ * \param[in]       client: MQTT client
+ * \param[out]      data: Output buffer, set to `NULL` to get record length only
+ * \param[in]       len: Length of output buffer
+ * \return          Record length or `0` if queue is empty
+ */
+static size_t
+mqtt_offline_peek(esp_mqtt_client_p client, void* data, size_t len) {
+    uint16_t l;
+
+    if (client->offline_store != NULL) {
+        return client->offline_store->peek(client->offline_store->arg, data, len);
+    }
+    if (esp_buff_peek(&client->offline_buff, 0, &l, sizeof(l)) != sizeof(l)) {
+        return 0;
+    }
+    if (data != NULL && len >= l) {
+        esp_buff_peek(&client->offline_buff, sizeof(l), data, l);
+    }
+    return l;
+}
+
+/**
+ * \brief           Remove oldest record from offline queue
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_offline_pop(esp_mqtt_client_p client) {
+    uint16_t l;
+
+    if (client->offline_store != NULL) {
+        client->offline_store->pop(client->offline_store->arg);
+    } else if (esp_buff_peek(&client->offline_buff, 0, &l, sizeof(l)) == sizeof(l)) {
+        esp_buff_skip(&client->offline_buff, sizeof(l) + l);
+    }
+}
+
+/**
+ * \brief           Store PUBLISH packet to offline queue
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic to send message to
+ * \param[in]       len_topic: Length of topic
+ * \param[in]       payload: Message data
+ * \param[in]       payload_len: Length of payload data
+ * \param[in]       qos: Quality of service
+ * \param[in]       retain: Retain parameter value
+ * \param[in]       arg: User custom argument used in callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+mqtt_offline_store(esp_mqtt_client_p client, const char* topic, uint16_t len_topic, const void* payload,
+                    uint16_t payload_len, esp_mqtt_qos_t qos, uint8_t retain, void* arg) {
+    uint8_t* rec;
+    size_t len;
+    espr_t res = espOK;
+
+    if (payload == NULL) {
+        payload_len = 0;
+    }
+    len = MQTT_OFFLINE_HDR_LEN + len_topic + payload_len;
+    if ((rec = esp_mem_malloc_tag(len, ESP_MEM_TAG_MQTT)) == NULL) {
+        return espERRMEM;
+    }
+    rec[0] = ESP_U8((ESP_U8(qos) & 0x03) | (ESP_U8(!!retain) << 2));
+    rec[1] = ESP_U8(len_topic >> 8);
+    rec[2] = ESP_U8(len_topic);
+    rec[3] = ESP_U8(payload_len >> 8);
+    rec[4] = ESP_U8(payload_len);
+    ESP_MEMCPY(&rec[5], &arg, sizeof(arg));
+    ESP_MEMCPY(&rec[MQTT_OFFLINE_HDR_LEN], topic, len_topic);
+    if (payload_len > 0) {
+        ESP_MEMCPY(&rec[MQTT_OFFLINE_HDR_LEN + len_topic], payload, payload_len);
+    }
+    if (!mqtt_offline_push(client, rec, len)) {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING, "[MQTT] Offline queue is full\r\n");
+        res = espERRMEM;
+    } else {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Publish stored to offline queue\r\n");
+    }
+    esp_mem_free(rec);
+    return res;
+}
 
-                                idx += client->msg_rem_len; /* Skip data part only, idx is increased again in for loop */
-                            } else {
-                                client->parser_state = MQTT_PARSER_STATE_READ_REM;
-                            }
-                        } else {
-                            mqtt_process_incoming_message(client);
-                            client->parser_state = MQTT_PARSER_STATE_INIT;
-                        }
-                    }
-                    break;
-                }
-                case MQTT_PARSER_STATE_READ_REM: {  /* Read remaining bytes and write to RX buffer */
-                    /* Process only if rx buff length is big enough */
-                    if (client->msg_curr_pos < client->rx_buff_len) {
-                        client->rx_buff[client->msg_curr_pos] = ch; /* Write received character */
-                    }
-                    ++client->msg_curr_pos;
+/**
+ * \brief           Send packets from offline queue until output buffer is full
+ * \note            Core must be locked when calling this function
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_offline_flush(esp_mqtt_client_p client) {
+    uint8_t* rec;
+    size_t len;
+    espr_t res;
 
-                    /* We reached end of received characters? */
-                    if (client->msg_curr_pos == client->msg_rem_len) {
-                        if (client->msg_curr_pos <= client->rx_buff_len) {  /* Check if it was possible to write all data to rx buffer */
-                            ESP_DEBUGF(ESP_CFG_DBG_MQTT_STATE,
-                                "[MQTT] Packet parsed and ready for processing\r\n");
+    while (client->offline_en && client->conn_state == ESP_MQTT_CONNECTED
+        && (len = mqtt_offline_peek(client, NULL, 0)) >= MQTT_OFFLINE_HDR_LEN) {
+        void* arg;
+        uint16_t len_topic, payload_len;
 
-                            mqtt_process_incoming_message(client);  /* Process incoming packet */
-                        } else {
-                            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE_WARNING,
-                                "[MQTT] Packet too big for rx buffer. Packet discarded\r\n");
-                        }
-                        client->parser_state = MQTT_PARSER_STATE_INIT;  /* Go to initial state and listen for next received packet */
-                    }
-                    break;
-                }
-                default:
-                    client->parser_state = MQTT_PARSER_STATE_INIT;
-            }
+        if ((rec = esp_mem_malloc_tag(len, ESP_MEM_TAG_MQTT)) == NULL) {
+            break;
         }
-    } while (buff_len > 0);
-    return 0;
+        mqtt_offline_peek(client, rec, len);
+        len_topic = ESP_U16((rec[1] << 8) | rec[2]);
+        payload_len = ESP_U16((rec[3] << 8) | rec[4]);
+        ESP_MEMCPY(&arg, &rec[5], sizeof(arg));
+
+        res = mqtt_publish_write(client, (const char *)&rec[MQTT_OFFLINE_HDR_LEN], len_topic,
+            &rec[MQTT_OFFLINE_HDR_LEN + len_topic], payload_len, 0,
+            (esp_mqtt_qos_t)(rec[0] & 0x03), ESP_U8((rec[0] >> 2) & 0x01), arg);
+        esp_mem_free(rec);
+        if (res == espERRMEM) {                 /* Output buffer or requests full, continue later */
+            break;
+        }
+        mqtt_offline_pop(client);
+        if (res != espOK) {                     /* Packet cannot be sent at all */
+            client->evt.type = ESP_MQTT_EVT_PUBLISH;
+            client->evt.evt.publish.arg = arg;
+            client->evt.evt.publish.res = res;
+            client->evt_fn(client, &client->evt);
+        }
+    }
 }
 
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__ */
+
 /******************************************************************************************************/
 /******************************************************************************************************/
 /* Connection callback functions                                                                      */
@@ -768,6 +1872,9 @@ static void
 mqtt_connected_cb(esp_mqtt_client_p client) {
     uint16_t rem_len, len_id, len_pass = 0, len_user = 0, len_will_topic = 0, len_will_message = 0;
     uint8_t flags = 0;
+#if ESP_CFG_MQTT_V5
+    uint8_t props_len = 0;
+#endif /* ESP_CFG_MQTT_V5 */
 
     flags |= MQTT_FLAG_CONNECT_CLEAN_SESSION;   /* Start as clean session */
 
@@ -778,6 +1885,12 @@ mqtt_connected_cb(esp_mqtt_client_p client) {
      * Minimum length consists of 2 + "MQTT" (4) + protocol_level (1) + flags (1) + keep_alive (2)
      */
     rem_len = 10;                               /* Set remaining length of fixed header */
+#if ESP_CFG_MQTT_V5
+#if !ESP_CFG_MQTT_PUBLISH_STREAM
+    props_len = 5;                              /* Maximum packet size we can receive to RX buffer */
+#endif /* !ESP_CFG_MQTT_PUBLISH_STREAM */
+    rem_len += mqtt_var_int_len(props_len) + props_len;
+#endif /* ESP_CFG_MQTT_V5 */
 
     len_id = ESP_U16(strlen(client->info->id)); /* Get cliend ID length */
     rem_len += len_id + 2;                      /* Add client id length including length entries */
@@ -791,6 +1904,9 @@ mqtt_connected_cb(esp_mqtt_client_p client) {
 
         rem_len += len_will_topic + 2;          /* Add will topic parameter */
         rem_len += len_will_message + 2;        /* Add will message parameter */
+#if ESP_CFG_MQTT_V5
+        rem_len += 1;                           /* Empty will properties */
+#endif /* ESP_CFG_MQTT_V5 */
     }
 
     if (client->info->user != NULL) {           /* Check for username */
@@ -814,11 +1930,27 @@ mqtt_connected_cb(esp_mqtt_client_p client) {
     /* Write everything to output buffer */
     write_fixed_header(client, MQTT_MSG_TYPE_CONNECT, 0, (esp_mqtt_qos_t)0, 0, rem_len);
     write_string(client, "MQTT", 4);            /* Protocol name */
+#if ESP_CFG_MQTT_V5
+    write_u8(client, 5);                        /* Protocol version */
+#else /* ESP_CFG_MQTT_V5 */
     write_u8(client, 4);                        /* Protocol version */
+#endif /* !ESP_CFG_MQTT_V5 */
     write_u8(client, flags);                    /* Flags for CONNECT message */
     write_u16(client, client->info->keep_alive);/* Keep alive timeout in units of seconds */
+#if ESP_CFG_MQTT_V5
+    write_var_int(client, props_len);           /* Properties length */
+    if (props_len > 0) {
+        write_u8(client, MQTT_PROP_MAX_PACKET_SIZE);
+        write_u16(client, ESP_U16(((uint32_t)client->rx_buff_len) >> 16));
+        write_u16(client, ESP_U16(client->rx_buff_len));
+    }
+    mqtt_v5_topic_alias_reset(client);          /* Aliases are valid for single connection only */
+#endif /* ESP_CFG_MQTT_V5 */
     write_string(client, client->info->id, len_id); /* This is client ID string */
     if (flags & MQTT_FLAG_CONNECT_WILL) {       /* Check for will topic */
+#if ESP_CFG_MQTT_V5
+        write_var_int(client, 0);               /* Will properties length */
+#endif /* ESP_CFG_MQTT_V5 */
         write_string(client, client->info->will_topic, len_will_topic); /* Write topic to packet */
         write_string(client, client->info->will_message, len_will_message); /* Write message to packet */
     }
@@ -832,6 +1964,10 @@ mqtt_connected_cb(esp_mqtt_client_p client) {
     client->parser_state = MQTT_PARSER_STATE_INIT;  /* Reset parser state */
 
     client->poll_time = 0;                      /* Reset kep alive time */
+#if ESP_CFG_MQTT_STATS
+    ESP_MEMSET(&client->stats, 0x00, sizeof(client->stats));
+    client->ping_suppressed = 0;
+#endif /* ESP_CFG_MQTT_STATS */
     client->conn_state = ESP_MQTT_CONNECTING;   /* MQTT is connecting to server */
 
     send_data(client);                          /* Flush and send the actual data */
@@ -845,7 +1981,7 @@ mqtt_connected_cb(esp_mqtt_client_p client) {
  */
 static uint8_t
 mqtt_data_recv_cb(esp_mqtt_client_p client, esp_pbuf_p pbuf) {
-    client->poll_time = 0;                      /* Reset kep alive time */
+    /* Keep alive is measured between packets sent by client, received data do not reset it */
     mqtt_parse_incoming(client, pbuf);
     esp_conn_recved(client->conn, pbuf);        /* Notify stack about received data */
     return 1;
@@ -861,11 +1997,19 @@ mqtt_data_recv_cb(esp_mqtt_client_p client, esp_pbuf_p pbuf) {
 static uint8_t
 mqtt_data_sent_cb(esp_mqtt_client_p client, size_t sent_len, uint8_t successful) {
     esp_mqtt_request_t* request;
+#if ESP_CFG_MQTT_PUBLISH_REF
+    uint8_t ref_sent = client->ref_sending;
+
+    client->ref_sending = 0;                    /* Payload memory was already released */
+#endif /* ESP_CFG_MQTT_PUBLISH_REF */
 
     client->is_sending = 0;                     /* We are not sending anymore */
     client->sent_total += sent_len;
 
     client->poll_time = 0;                      /* Reset kep alive time */
+#if ESP_CFG_MQTT_STATS
+    client->ping_suppressed = 0;
+#endif /* ESP_CFG_MQTT_STATS */
 
     /*
      * In case transmit was not successful,
@@ -879,7 +2023,16 @@ mqtt_data_sent_cb(esp_mqtt_client_p client, size_t sent_len, uint8_t successful)
         mqtt_close(client);
         return 0;
     }
+#if ESP_CFG_MQTT_PUBLISH_REF
+    if (!ref_sent) {                            /* Payload from user memory is not in buffer */
+        if (client->ref_data != NULL) {
+            client->ref_hdr_rem -= ESP_MIN(sent_len, client->ref_hdr_rem);
+        }
+        esp_buff_skip(&client->tx_buff, sent_len);
+    }
+#else /* ESP_CFG_MQTT_PUBLISH_REF */
     esp_buff_skip(&client->tx_buff, sent_len);  /* Skip buffer for actual sent data */
+#endif /* !ESP_CFG_MQTT_PUBLISH_REF */
 
     /*
      * Check pending publish requests without QoS because there is no confirmation received by server.
@@ -903,6 +2056,9 @@ mqtt_data_sent_cb(esp_mqtt_client_p client, size_t sent_len, uint8_t successful)
         }
     }
 
+#if ESP_CFG_MQTT_OFFLINE_QUEUE
+    mqtt_offline_flush(client);                 /* Continue with packets queued while offline */
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE */
     send_data(client);                          /* Try to send more */
     return 1;
 }
@@ -924,17 +2080,32 @@ mqtt_poll_cb(esp_mqtt_client_p client) {
     /*
      * Check for keep-alive time if equal or greater than
      * keep alive time. In that case, send packet
-     * to make sure we are still alive
+     * to make sure we are still alive.
+     *
+     * Poll time is reset on every packet sent to server,
+     * PINGREQ is therefore sent only when link is idle
      */
     if (client->info->keep_alive                /* Keep alive must be enabled */
         /* Poll time is in units of ESP_CFG_CONN_POLL_INTERVAL milliseconds,
            while keep_alive is in units of seconds */
         && (client->poll_time * ESP_CFG_CONN_POLL_INTERVAL) >= (uint32_t)(client->info->keep_alive * 1000)) {
 
-        if (output_check_enough_memory(client, 0)) {/* Check if memory available in output buffer */
+        if (client->is_sending || esp_buff_get_full(&client->tx_buff) > 0) {
+            /* Packet is on its way to server and serves as keep-alive */
+#if ESP_CFG_MQTT_STATS
+            if (!client->ping_suppressed) {     /* Count once per keep-alive period */
+                client->ping_suppressed = 1;
+                ++client->stats.pingreq_suppressed;
+            }
+#endif /* ESP_CFG_MQTT_STATS */
+            send_data(client);                  /* Do not wait for linger time */
+        } else if (output_check_enough_memory(client, 0)) {/* Check if memory available in output buffer */
             write_fixed_header(client, MQTT_MSG_TYPE_PINGREQ, 0, (esp_mqtt_qos_t)0, 0, 0);  /* Write PINGREQ command to output buffer */
             send_data(client);                  /* Force send data */
             client->poll_time = 0;              /* Reset polling time */
+#if ESP_CFG_MQTT_STATS
+            ++client->stats.pingreq_sent;
+#endif /* ESP_CFG_MQTT_STATS */
 
             ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Sending PINGREQ packet\r\n");
         } else {
@@ -942,6 +2113,16 @@ mqtt_poll_cb(esp_mqtt_client_p client) {
         }
     }
 
+#if ESP_CFG_MQTT_TX_LINGER_TIME > 0
+    /*
+     * Without timeout wheel, removing linger timeout of other client
+     * may remove this client's one, make sure data are not delayed further
+     */
+    if (client->linger_active) {
+        send_data(client);
+    }
+#endif /* ESP_CFG_MQTT_TX_LINGER_TIME > 0 */
+
     /*
      * Process all active packets and
      * check for timeout if there was no reply from MQTT server
@@ -981,6 +2162,11 @@ mqtt_closed_cb(esp_mqtt_client_p client, espr_t res, uint8_t forced) {
     }
     ESP_MEMSET(client->requests, 0x00, sizeof(client->requests));
 
+#if ESP_CFG_MQTT_PUBLISH_REF
+    if (client->ref_data != NULL && !client->ref_sending) { /* Payload not passed to connection yet */
+        mqtt_publish_ref_release(client);
+    }
+#endif /* ESP_CFG_MQTT_PUBLISH_REF */
     client->is_sending = client->sent_total = client->written_total = 0;
     client->parser_state = MQTT_PARSER_STATE_INIT;
     esp_buff_reset(&client->tx_buff);           /* Reset TX buffer */
@@ -1032,6 +2218,7 @@ mqtt_conn_cb(esp_evt_t* evt) {
 
         /* Connection active to MQTT server */
         case ESP_EVT_CONN_ACTIVE: {
+            esp_conn_set_poll_interval(conn, ESP_CFG_CONN_POLL_INTERVAL);   /* Keep-alive is handled in poll */
             mqtt_connected_cb(client);          /* Call function to process status */
             break;
         }
@@ -1080,7 +2267,7 @@ esp_mqtt_client_t *
 esp_mqtt_client_new(size_t tx_buff_len, size_t rx_buff_len) {
     esp_mqtt_client_p client;
 
-    client = esp_mem_malloc(sizeof(*client));
+    client = esp_mem_malloc_tag(sizeof(*client), ESP_MEM_TAG_MQTT);
     if (client != NULL) {
         ESP_MEMSET(client, 0x00, sizeof(*client));
         client->conn_state = ESP_MQTT_CONN_DISCONNECTED;/* Set to disconnected mode */
@@ -1090,7 +2277,7 @@ esp_mqtt_client_new(size_t tx_buff_len, size_t rx_buff_len) {
         }
         if (client != NULL) {
             client->rx_buff_len = rx_buff_len;
-            client->rx_buff = esp_mem_malloc(rx_buff_len);
+            client->rx_buff = esp_mem_malloc_tag(rx_buff_len, ESP_MEM_TAG_MQTT);
             if (client->rx_buff == NULL) {
                 esp_buff_free(&client->tx_buff);
                 esp_mem_free_s((void **)&client);
@@ -1108,6 +2295,23 @@ esp_mqtt_client_new(size_t tx_buff_len, size_t rx_buff_len) {
 void
 esp_mqtt_client_delete(esp_mqtt_client_p client) {
     if (client != NULL) {
+#if ESP_CFG_MQTT_TX_LINGER_TIME > 0
+        esp_core_lock();
+        send_data_linger_stop(client);          /* Timeout must not use deleted client */
+        esp_core_unlock();
+#endif /* ESP_CFG_MQTT_TX_LINGER_TIME > 0 */
+#if ESP_CFG_MQTT_TOPIC_TRIE
+        mqtt_topic_trie_free(client->topic_trie);
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE */
+#if ESP_CFG_MQTT_V5
+        mqtt_v5_topic_alias_reset(client);
+#endif /* ESP_CFG_MQTT_V5 */
+#if ESP_CFG_MQTT_OFFLINE_QUEUE
+        esp_buff_free(&client->offline_buff);
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE */
+#if ESP_CFG_MQTT_RESUBSCRIBE > 0
+        mqtt_subs_free(client);
+#endif /* ESP_CFG_MQTT_RESUBSCRIBE > 0 */
         esp_mem_free_s((void **)&client->rx_buff);
         esp_buff_free(&client->tx_buff);
         esp_mem_free_s((void **)&client);
@@ -1178,7 +2382,18 @@ esp_mqtt_client_disconnect(esp_mqtt_client_p client) {
  */
 espr_t
 esp_mqtt_client_subscribe(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, void* arg) {
+#if ESP_CFG_MQTT_RESUBSCRIBE > 0
+    espr_t res;
+
+    esp_core_lock();
+    if ((res = sub_unsub(client, topic, qos, arg, 1) == 1 ? espOK : espERR) == espOK) {
+        mqtt_subs_update(client, topic, qos, 1);
+    }
+    esp_core_unlock();
+    return res;
+#else /* ESP_CFG_MQTT_RESUBSCRIBE > 0 */
     return sub_unsub(client, topic, qos, arg, 1) == 1 ? espOK : espERR;  /* Subscribe to topic */
+#endif /* !(ESP_CFG_MQTT_RESUBSCRIBE > 0) */
 }
 
 /**
@@ -1190,7 +2405,18 @@ esp_mqtt_client_subscribe(esp_mqtt_client_p client, const char* topic, esp_mqtt_
  */
 espr_t
 esp_mqtt_client_unsubscribe(esp_mqtt_client_p client, const char* topic, void* arg) {
+#if ESP_CFG_MQTT_RESUBSCRIBE > 0
+    espr_t res;
+
+    esp_core_lock();
+    if ((res = sub_unsub(client, topic, (esp_mqtt_qos_t)0, arg, 0) == 1 ? espOK : espERR) == espOK) {
+        mqtt_subs_update(client, topic, (esp_mqtt_qos_t)0, 0);
+    }
+    esp_core_unlock();
+    return res;
+#else /* ESP_CFG_MQTT_RESUBSCRIBE > 0 */
     return sub_unsub(client, topic, (esp_mqtt_qos_t)0, arg, 0) == 1 ? espOK : espERR;    /* Unsubscribe from topic */
+#endif /* !(ESP_CFG_MQTT_RESUBSCRIBE > 0) */
 }
 
 /**
@@ -1207,68 +2433,83 @@ esp_mqtt_client_unsubscribe(esp_mqtt_client_p client, const char* topic, void* a
 espr_t
 esp_mqtt_client_publish(esp_mqtt_client_p client, const char* topic, const void* payload,
                         uint16_t payload_len, esp_mqtt_qos_t qos, uint8_t retain, void* arg) {
-    espr_t res = espOK;
-    esp_mqtt_request_t* request = NULL;
-    uint32_t rem_len, raw_len;
-    uint16_t len_topic, pkt_id;
-    uint8_t qos_u8 = ESP_U8(qos);
+    espr_t res;
+    uint16_t len_topic;
 
     if (!(len_topic = ESP_U16(strlen(topic)))) {    /* Get length of topic */
         return espERR;
     }
 
-    /*
-     * Calculate remaining length of packet
-     *
-     * rem_len = 2 (topic_len) + topic_len + 2 (pkt_idm only if qos > 0) + payload_len
-     */
-    rem_len = 2 + len_topic + (payload != NULL ? payload_len : 0);
-    if (qos_u8 > 0) {
-        rem_len += 2;
-    }
-
     esp_core_lock();
+#if ESP_CFG_MQTT_OFFLINE_QUEUE
+    /* Keep order of packets, queue new one if older are not sent yet */
+    if (client->offline_en
+        && (client->conn_state != ESP_MQTT_CONNECTED || mqtt_offline_peek(client, NULL, 0) > 0)) {
+        res = mqtt_offline_store(client, topic, len_topic, payload, payload_len, qos, retain, arg);
+        mqtt_offline_flush(client);
+    } else
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE */
     if (client->conn_state != ESP_MQTT_CONNECTED) {
         res = espCLOSED;
-    } else if ((raw_len = output_check_enough_memory(client, rem_len)) != 0) {
-        pkt_id = qos_u8 > 0 ? create_packet_id(client) : 0; /* Create new packet ID */
-        request = request_create(client, pkt_id, arg);  /* Create request for packet */
-        if (request != NULL) {
-            /*
-             * Set expected number of bytes we should send before
-             * we can say that this packet was sent.
-             * Used in case QoS is set to 0 where packet notification
-             * is not received by server. In this case, wait
-             * number of bytes sent before notifying user about success
-             */
-            request->expected_sent_len = client->written_total + raw_len;
+    } else {
+        res = mqtt_publish_write(client, topic, len_topic, payload, payload_len, 0, qos, retain, arg);
+    }
+    esp_core_unlock();
+    return res;
+}
 
-            write_fixed_header(client, MQTT_MSG_TYPE_PUBLISH, 0, (esp_mqtt_qos_t)ESP_MIN(qos_u8, ESP_U8(ESP_MQTT_QOS_EXACTLY_ONCE)), retain, rem_len);
-            write_string(client, topic, len_topic); /* Write topic string to packet */
-            if (qos_u8) {
-                write_u16(client, pkt_id);      /* Write packet ID */
-            }
-            if (payload != NULL && payload_len) {
-                write_data(client, payload, payload_len);   /* Write RAW topic payload */
-            }
-            request_set_pending(client, request);   /* Set request as pending waiting for server reply */
+#if ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__
 
-            send_data(client);                  /* Try to send data */
+/**
+ * \brief           Publish a new message on specific topic with payload sent directly from user memory
+ *
+ * Only packet header and topic are written to output buffer,
+ * output buffer does not need to be big enough for payload.
+ *
+ * \note            Payload memory must stay valid until `release_fn` is called.
+ *                  When function does not return \ref espOK, `release_fn` is not called
+ *                  and memory ownership stays with the caller
+ * \note            Only one message with payload in user memory may be pending at a time
+ *                  and it is never stored to offline queue
+ *
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic to send message to
+ * \param[in]       payload: Message data
+ * \param[in]       payload_len: Length of payload data
+ * \param[in]       qos: Quality of service. This parameter can be a value of \ref esp_mqtt_qos_t enumeration
+ * \param[in]       retain: Retian parameter value
+ * \param[in]       release_fn: Function called with `payload` and `arg` when payload memory is not used anymore.
+ *                      Set to `NULL` if not used
+ * \param[in]       arg: User custom argument used in callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_publish_ref(esp_mqtt_client_p client, const char* topic, const void* payload,
+                        uint16_t payload_len, esp_mqtt_qos_t qos, uint8_t retain,
+                        esp_conn_release_fn release_fn, void* arg) {
+    espr_t res;
+    uint16_t len_topic;
 
-            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE,
-                "[MQTT] Pkt publish start. QoS: %d, pkt_id: %d\r\n", (int)qos_u8, (int)pkt_id);
-        } else {
-            ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] No free request available to publish message\r\n");
-            res = espERRMEM;
-        }
-    } else {
-        ESP_DEBUGF(ESP_CFG_DBG_MQTT_TRACE, "[MQTT] Not enough memory to publish message\r\n");
+    if (!(len_topic = ESP_U16(strlen(topic)))) {    /* Get length of topic */
+        return espERR;
+    }
+
+    esp_core_lock();
+    if (client->conn_state != ESP_MQTT_CONNECTED) {
+        res = espCLOSED;
+    } else if (client->ref_data != NULL) {      /* Previous payload is still in use */
         res = espERRMEM;
+    } else {
+        client->ref_release_fn = release_fn;
+        client->ref_release_arg = arg;
+        res = mqtt_publish_write(client, topic, len_topic, payload, payload_len, 1, qos, retain, arg);
     }
     esp_core_unlock();
     return res;
 }
 
+#endif /* ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__ */
+
 /**
  * \brief           Test if client is connected to server and accepted to MQTT protocol
  * \note            Function will return error if TCP is connected but MQTT not accepted
@@ -1298,6 +2539,32 @@ esp_mqtt_client_set_arg(esp_mqtt_client_p client, void* arg) {
     esp_core_unlock();
 }
 
+#if ESP_CFG_MQTT_QOS0_FAST || __DOXYGEN__
+
+/**
+ * \brief           Enable or disable QoS 0 publish without request tracking
+ *
+ * When enabled, QoS 0 packets do not use request entries
+ * and \ref ESP_MQTT_EVT_PUBLISH event is not sent for them.
+ * Packets with higher QoS are not affected
+ *
+ * \note            Do not enable it on client used by MQTT client API, which waits for publish event
+ * \param[in]       client: MQTT client handle
+ * \param[in]       en: Set to `1` to enable fast path, `0` to disable it
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_set_qos0_fast(esp_mqtt_client_p client, uint8_t en) {
+    ESP_ASSERT("client != NULL", client != NULL);
+
+    esp_core_lock();
+    client->qos0_fast = ESP_U8(en > 0);
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* ESP_CFG_MQTT_QOS0_FAST || __DOXYGEN__ */
+
 /**
  * \brief           Get user argument on client
  * \param[in]       client: MQTT client handle
@@ -1307,3 +2574,169 @@ void *
 esp_mqtt_client_get_arg(esp_mqtt_client_p client) {
     return client->arg;
 }
+
+#if ESP_CFG_MQTT_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get keep-alive statistics of client
+ * \note            Statistics are reset when client starts connecting to server
+ * \param[in]       client: MQTT client
+ * \param[out]      stats: Output variable to save statistics to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_get_stats(esp_mqtt_client_p client, esp_mqtt_client_stats_t* stats) {
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &client->stats, sizeof(*stats));
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* ESP_CFG_MQTT_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__
+
+/**
+ * \brief           Enable or disable offline queue for PUBLISH packets
+ *
+ * When enabled, packets published while client is not connected are stored to queue
+ * and sent after connection is accepted by server.
+ * \ref ESP_MQTT_EVT_PUBLISH event for queued packet is sent when packet is actually sent.
+ *
+ * \note            Packets already sent to server when connection is closed are not queued
+ *                  and are reported as failed
+ * \param[in]       client: MQTT client
+ * \param[in]       en: Set to `1` to enable queue, `0` to disable it
+ * \param[in]       store: User storage for queue or `NULL` to use RAM queue
+ *                      of \ref ESP_CFG_MQTT_OFFLINE_QUEUE_SIZE bytes
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_set_offline_queue(esp_mqtt_client_p client, uint8_t en, const esp_mqtt_offline_store_t* store) {
+    espr_t res = espOK;
+
+    ESP_ASSERT("client != NULL", client != NULL);
+
+    esp_core_lock();
+    client->offline_store = store;
+    if (en && store == NULL && client->offline_buff.buff == NULL
+        && !esp_buff_init(&client->offline_buff, ESP_CFG_MQTT_OFFLINE_QUEUE_SIZE)) {
+        res = espERRMEM;
+    }
+    client->offline_en = res == espOK ? en : 0;
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__
+
+/**
+ * \brief           Add handler for received packets on topics matching topic filter
+ *
+ * Handler for existing filter is replaced with new one.
+ * Received packet is given to all handlers with matching filter,
+ * \ref ESP_MQTT_EVT_PUBLISH_RECV event is sent to client callback only
+ * if there is no matching handler.
+ *
+ * \note            Handler does not subscribe to topic,
+ *                  use \ref esp_mqtt_client_subscribe to receive packets from server
+ * \note            Handlers must not be added or removed from handler callback
+ * \param[in]       client: MQTT client
+ * \param[in]       filter: Topic filter, `+` and `#` wildcards are allowed
+ * \param[in]       fn: Handler callback function
+ * \param[in]       arg: User argument passed to handler
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_topic_handler_add(esp_mqtt_client_p client, const char* filter, esp_mqtt_topic_fn fn, void* arg) {
+    esp_mqtt_topic_node_t** node_ptr, *node;
+    const char* f = filter;
+    size_t len, level_len;
+    espr_t res = espOK;
+
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("filter != NULL", filter != NULL);
+    ESP_ASSERT("fn != NULL", fn != NULL);
+
+    len = strlen(filter);
+    if (len == 0) {
+        return espPARERR;
+    }
+
+    /* Wildcard must be entire level and multi level wildcard must be last level */
+    for (size_t i = 0; i < len; ++i) {
+        if ((filter[i] == '+' || filter[i] == '#')
+            && ((i > 0 && filter[i - 1] != '/')
+                || (i + 1 < len && filter[i + 1] != '/')
+                || (filter[i] == '#' && i + 1 != len))) {
+            return espPARERR;
+        }
+    }
+
+    esp_core_lock();
+    node_ptr = &client->topic_trie;
+    while (1) {
+        level_len = mqtt_topic_level_len(f, len);
+
+        /* Find node for level or create new one */
+        for (; (node = *node_ptr) != NULL; node_ptr = &node->next) {
+            if (node->level_len == level_len && !strncmp(node->level, f, level_len)) {
+                break;
+            }
+        }
+        if (node == NULL) {
+            node = esp_mem_calloc_tag(1, sizeof(*node) + level_len, ESP_MEM_TAG_MQTT);
+            if (node == NULL) {
+                res = espERRMEM;
+                break;
+            }
+            ESP_MEMCPY(node->level, f, level_len);
+            node->level_len = level_len;
+            *node_ptr = node;
+        }
+
+        if (level_len == len) {                 /* Last level of filter */
+            node->fn = fn;
+            node->arg = arg;
+            break;
+        }
+        node_ptr = &node->child;
+        f += level_len + 1;
+        len -= level_len + 1;
+    }
+
+    /* Delete levels already created for filter */
+    if (res != espOK) {
+        mqtt_topic_trie_remove(&client->topic_trie, filter, strlen(filter));
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Remove handler for topic filter
+ * \param[in]       client: MQTT client
+ * \param[in]       filter: Topic filter used when handler was added
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_topic_handler_remove(esp_mqtt_client_p client, const char* filter) {
+    espr_t res;
+
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("filter != NULL", filter != NULL);
+
+    esp_core_lock();
+    res = mqtt_topic_trie_remove(&client->topic_trie, filter, strlen(filter)) ? espOK : espERR;
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__ */
+
+#endif /* !ESP_CFG_MQTT_AT || __DOXYGEN__ */
@@ -51,8 +51,38 @@ struct esp_mqtt_client_api {
     uint8_t release_sem;                        /*!< Set to `1` to release semaphore */
     esp_mqtt_conn_status_t connect_resp;        /*!< Response when connecting to server */
     espr_t sub_pub_resp;                        /*!< Subscribe/Unsubscribe/Publish response */
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0 || __DOXYGEN__
+    uint8_t* rx_slots;                          /*!< Preallocated receive slots memory */
+    size_t rx_slot_size;                        /*!< Size of single receive slot in units of bytes */
+    size_t rx_slot_next;                        /*!< Index of next slot to check for allocation */
+#endif /* ESP_CFG_MQTT_API_RX_SLOTS > 0 || __DOXYGEN__ */
+#if ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__
+    esp_mqtt_client_api_buf_p rcv_buf;          /*!< Publish packet currently being reassembled from payload chunks */
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__ */
+#if ESP_CFG_MQTT_API_GROUP || __DOXYGEN__
+    esp_mqtt_client_api_group_p grp;            /*!< Receive group or `NULL` when own receive mbox is used */
+    esp_mqtt_client_api_buf_t closed_buf;       /*!< Closed event entry for group queue, with `NULL` topic */
+#endif /* ESP_CFG_MQTT_API_GROUP || __DOXYGEN__ */
 } esp_mqtt_client_api_t;
 
+#if ESP_CFG_MQTT_API_GROUP || __DOXYGEN__
+
+/**
+ * \brief           MQTT API receive group structure
+ */
+typedef struct esp_mqtt_client_api_group {
+    esp_sys_mbox_t rcv_mbox;                    /*!< Received data mbox shared by clients in group */
+} esp_mqtt_client_api_group_t;
+
+#endif /* ESP_CFG_MQTT_API_GROUP || __DOXYGEN__ */
+
+/* Receive mbox size, one more entry than slots for closed event */
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0
+#define ESP_MQTT_API_RCV_MBOX_SIZE              (ESP_CFG_MQTT_API_RX_SLOTS + 1)
+#else /* ESP_CFG_MQTT_API_RX_SLOTS > 0 */
+#define ESP_MQTT_API_RCV_MBOX_SIZE              5
+#endif /* !(ESP_CFG_MQTT_API_RX_SLOTS > 0) */
+
 /**
  * \brief           Variable used as pointer for message queue when MQTT connection is closed
  */
@@ -71,6 +101,90 @@ release_sem(esp_mqtt_client_api_p client) {
     }
 }
 
+/**
+ * \brief           Get mbox for received packets and closed events of client
+ * \param[in]       client: MQTT API client handle
+ * \return          Group mbox when client is part of group, own mbox otherwise
+ */
+static esp_sys_mbox_t*
+rcv_mbox_get(esp_mqtt_client_api_p client) {
+#if ESP_CFG_MQTT_API_GROUP
+    if (client->grp != NULL) {
+        return &client->grp->rcv_mbox;
+    }
+#endif /* ESP_CFG_MQTT_API_GROUP */
+    return &client->rcv_mbox;
+}
+
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0 || __DOXYGEN__
+
+/**
+ * \brief           Get free receive slot for new packet
+ * \param[in]       client: MQTT API client handle
+ * \param[in]       topic_len: Length of packet topic
+ * \param[in]       payload_len: Length of packet payload
+ * \return          Slot buffer with topic and payload pointers set on success, `NULL` otherwise
+ */
+static esp_mqtt_client_api_buf_p
+rx_slot_get(esp_mqtt_client_api_p client, size_t topic_len, size_t payload_len) {
+    esp_mqtt_client_api_buf_p buf = NULL;
+    size_t buf_size;
+
+    buf_size = ESP_MEM_ALIGN(sizeof(*buf));
+    if ((buf_size + topic_len + 1 + payload_len + 1) > client->rx_slot_size) {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_WARNING,
+            "[MQTT API] Packet too big for receive slot\r\n");
+        return NULL;
+    }
+
+    /* Find first free slot, starting after last allocated one */
+    for (size_t i = 0; i < ESP_CFG_MQTT_API_RX_SLOTS; ++i) {
+        esp_mqtt_client_api_buf_p b;
+
+        b = (void *)&client->rx_slots[client->rx_slot_size * ((client->rx_slot_next + i) % ESP_CFG_MQTT_API_RX_SLOTS)];
+        if (!b->in_use) {
+            client->rx_slot_next = (client->rx_slot_next + i + 1) % ESP_CFG_MQTT_API_RX_SLOTS;
+            buf = b;
+            break;
+        }
+    }
+
+#if ESP_CFG_MQTT_API_RX_SLOTS_DROP_OLDEST
+    /* Take oldest packet user did not read yet, group queue may hold packets of other clients */
+#if ESP_CFG_MQTT_API_GROUP
+    if (buf == NULL && client->grp == NULL) {
+#else /* ESP_CFG_MQTT_API_GROUP */
+    if (buf == NULL) {
+#endif /* !ESP_CFG_MQTT_API_GROUP */
+        void* d;
+        if (esp_sys_mbox_getnow(&client->rcv_mbox, &d)) {
+            if ((uint8_t *)d != (uint8_t *)&mqtt_closed && ((esp_mqtt_client_api_buf_p)d)->is_slot) {
+                ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_WARNING,
+                    "[MQTT API] No free receive slot. Oldest packet discarded\r\n");
+                buf = d;
+            } else {
+                esp_sys_mbox_putnow(&client->rcv_mbox, d);  /* Not slot entry, put it back */
+            }
+        }
+    }
+#endif /* ESP_CFG_MQTT_API_RX_SLOTS_DROP_OLDEST */
+
+    if (buf != NULL) {
+        buf->topic = (void *)((uint8_t *)buf + buf_size);
+        buf->payload = (void *)((uint8_t *)buf->topic + topic_len + 1);
+        buf->topic[topic_len] = 0;
+        buf->payload[payload_len] = 0;
+        buf->is_slot = 1;
+        buf->in_use = 1;
+    } else {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_WARNING,
+            "[MQTT API] No free receive slot. Packet discarded\r\n");
+    }
+    return buf;
+}
+
+#endif /* ESP_CFG_MQTT_API_RX_SLOTS > 0 || __DOXYGEN__ */
+
 /**
  * \brief           MQTT event callback function
  */
@@ -107,9 +221,9 @@ mqtt_evt(esp_mqtt_client_p client, esp_mqtt_evt_t* evt) {
         }
         case ESP_MQTT_EVT_PUBLISH_RECV: {
             /* Check valid receive mbox */
-            if (esp_sys_mbox_isvalid(&api_client->rcv_mbox)) {
+            if (esp_sys_mbox_isvalid(rcv_mbox_get(api_client))) {
                 esp_mqtt_client_api_buf_p buf;
-                size_t size, buf_size, topic_size, payload_size;
+                size_t size, buf_size, topic_size, payload_size, payload_offset = 0, payload_total_len;
 
                 /* Get event data */
                 const char* topic = esp_mqtt_client_evt_publish_recv_get_topic(client, evt);
@@ -118,39 +232,94 @@ mqtt_evt(esp_mqtt_client_p client, esp_mqtt_evt_t* evt) {
                 size_t payload_len = esp_mqtt_client_evt_publish_recv_get_payload_len(client, evt);
                 esp_mqtt_qos_t qos = esp_mqtt_client_evt_publish_recv_get_qos(client, evt);
 
-                /* Print debug message */
-                ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE,
-                    "[MQTT API] New publish received on topic %.*s\r\n", (int)topic_len, topic);
-
-                /* Calculate memory sizes */
-                buf_size = ESP_MEM_ALIGN(sizeof(*buf));
-                topic_size = ESP_MEM_ALIGN(sizeof(*topic) * (topic_len + 1));
-                payload_size = ESP_MEM_ALIGN(sizeof(*payload) * (payload_len + 1));
-                
-                size = buf_size + topic_size + payload_size;
-                buf = esp_mem_malloc(size);
-                if (buf != NULL) {
-                    ESP_MEMSET(buf, 0x00, size);
-                    buf->topic = (void *)((uint8_t *)buf + buf_size);
-                    buf->payload = (void *)((uint8_t *)buf + buf_size + topic_size);
-                    buf->topic_len = topic_len;
-                    buf->payload_len = payload_len;
-                    buf->qos = qos;
-
-                    /* Copy content to new memory */
-                    ESP_MEMCPY(buf->topic, topic, sizeof(*topic) * topic_len);
-                    ESP_MEMCPY(buf->payload, payload, sizeof(*payload) * payload_len);
-
-                    /* Write to receive queue */
-                    if (!esp_sys_mbox_putnow(&api_client->rcv_mbox, buf)) {
-                        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_WARNING,
-                            "[MQTT API] Cannot put new received MQTT publish to queue\r\n");
-                        esp_mem_free_s((void **)&buf);
+                payload_total_len = payload_len;
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+                payload_offset = esp_mqtt_client_evt_publish_recv_get_payload_offset(client, evt);
+                payload_total_len = esp_mqtt_client_evt_publish_recv_get_payload_total_len(client, evt);
+
+                /* Continue with packet being reassembled from chunks */
+                if (payload_offset > 0) {
+                    buf = api_client->rcv_buf;
+                    if (buf == NULL) {
+                        break;                  /* First chunk was not accepted, ignore the rest */
                     }
                 } else {
+                    esp_mqtt_client_api_buf_free(api_client->rcv_buf);  /* Free incomplete packet, if any */
+                    api_client->rcv_buf = NULL;
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+
+                    /* Print debug message */
+                    ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE,
+                        "[MQTT API] New publish received on topic %.*s\r\n", (int)topic_len, topic);
+
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0
+                    ESP_UNUSED(size);
+                    ESP_UNUSED(buf_size);
+                    ESP_UNUSED(topic_size);
+                    ESP_UNUSED(payload_size);
+
+                    buf = rx_slot_get(api_client, topic_len, payload_total_len);
+                    if (buf != NULL) {
+                        buf->topic_len = topic_len;
+                        buf->payload_len = payload_total_len;
+                        buf->qos = qos;
+
+                        /* Copy topic to slot memory */
+                        ESP_MEMCPY(buf->topic, topic, sizeof(*topic) * topic_len);
+                    } else {
+                        break;
+                    }
+#else /* ESP_CFG_MQTT_API_RX_SLOTS > 0 */
+                    /* Calculate memory sizes */
+                    buf_size = ESP_MEM_ALIGN(sizeof(*buf));
+                    topic_size = ESP_MEM_ALIGN(sizeof(*topic) * (topic_len + 1));
+                    payload_size = ESP_MEM_ALIGN(sizeof(*payload) * (payload_total_len + 1));
+
+                    size = buf_size + topic_size + payload_size;
+                    buf = esp_mem_malloc_tag(size, ESP_MEM_TAG_MQTT);
+                    if (buf != NULL) {
+                        ESP_MEMSET(buf, 0x00, size);
+                        buf->topic = (void *)((uint8_t *)buf + buf_size);
+                        buf->payload = (void *)((uint8_t *)buf + buf_size + topic_size);
+                        buf->topic_len = topic_len;
+                        buf->payload_len = payload_total_len;
+                        buf->qos = qos;
+
+                        /* Copy topic to new memory */
+                        ESP_MEMCPY(buf->topic, topic, sizeof(*topic) * topic_len);
+                    } else {
+                        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_WARNING,
+                            "[MQTT API] Cannot allocate memory for packet buffer of size %d bytes\r\n",
+                            (int)size);
+                        break;
+                    }
+#endif /* !(ESP_CFG_MQTT_API_RX_SLOTS > 0) */
+#if ESP_CFG_MQTT_API_GROUP
+                    buf->client = api_client;
+#endif /* ESP_CFG_MQTT_API_GROUP */
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+                }
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+
+                /* Copy content to new memory */
+                if (payload_len > 0) {
+                    ESP_MEMCPY(&buf->payload[payload_offset], payload, sizeof(*payload) * payload_len);
+                }
+
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+                /* Wait for remaining chunks before packet is given to user */
+                if ((payload_offset + payload_len) < payload_total_len) {
+                    api_client->rcv_buf = buf;
+                    break;
+                }
+                api_client->rcv_buf = NULL;
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+
+                /* Write to receive queue */
+                if (!esp_sys_mbox_putnow(rcv_mbox_get(api_client), buf)) {
                     ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_WARNING,
-                        "[MQTT API] Cannot allocate memory for packet buffer of size %d bytes\r\n",
-                        (int)size);
+                        "[MQTT API] Cannot put new received MQTT publish to queue\r\n");
+                    esp_mqtt_client_api_buf_free(buf);
                 }
             }
             break;
@@ -197,8 +366,19 @@ mqtt_evt(esp_mqtt_client_p client, esp_mqtt_evt_t* evt) {
             ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE,
                 "[MQTT API] Disconnect event\r\n");
 
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+            /* Packet cannot be completed anymore */
+            esp_mqtt_client_api_buf_free(api_client->rcv_buf);
+            api_client->rcv_buf = NULL;
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+
             /* Write to receive mbox to wakeup receive thread */
-            if (is_accepted && esp_sys_mbox_isvalid(&api_client->rcv_mbox)) {
+            if (is_accepted && esp_sys_mbox_isvalid(rcv_mbox_get(api_client))) {
+#if ESP_CFG_MQTT_API_GROUP
+                if (api_client->grp != NULL) {
+                    esp_sys_mbox_putnow(&api_client->grp->rcv_mbox, &api_client->closed_buf);
+                } else
+#endif /* ESP_CFG_MQTT_API_GROUP */
                 esp_sys_mbox_putnow(&api_client->rcv_mbox, &mqtt_closed);
             }
 
@@ -223,19 +403,34 @@ esp_mqtt_client_api_new(size_t tx_buff_len, size_t rx_buff_len) {
     size = ESP_MEM_ALIGN(sizeof(*client));      /* Get size of client itself */
 
     /* Create client APi structure */
-    client = esp_mem_calloc(1, size);           /* Allocate client memory */
+    client = esp_mem_calloc_tag(1, size, ESP_MEM_TAG_MQTT);           /* Allocate client memory */
     if (client != NULL) {
+#if ESP_CFG_MQTT_API_GROUP
+        client->closed_buf.client = client;     /* Closed entry identifies client in group queue */
+#endif /* ESP_CFG_MQTT_API_GROUP */
         /* Create MQTT raw client structure */
         client->mc = esp_mqtt_client_new(tx_buff_len, rx_buff_len);
         if (client->mc != NULL) {
             /* Create receive mbox queue */
-            if (esp_sys_mbox_create(&client->rcv_mbox, 5)) {
+            if (esp_sys_mbox_create(&client->rcv_mbox, ESP_MQTT_API_RCV_MBOX_SIZE)) {
                 /* Create synchronization semaphore */
                 if (esp_sys_sem_create(&client->sync_sem, 1)) {
                     /* Create mutex */
                     if (esp_sys_mutex_create(&client->mutex)) {
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0
+                        /* Allocate receive slots, each for topic and payload of RX buffer length */
+                        client->rx_slot_size = ESP_MEM_ALIGN(sizeof(esp_mqtt_client_api_buf_t)) + ESP_MEM_ALIGN(rx_buff_len + 2);
+                        client->rx_slots = esp_mem_calloc_tag(ESP_CFG_MQTT_API_RX_SLOTS, client->rx_slot_size, ESP_MEM_TAG_MQTT);
+                        if (client->rx_slots != NULL) {
+                            esp_mqtt_client_set_arg(client->mc, client);/* Set client to mqtt client argument */
+                            return client;
+                        }
+                        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_SEVERE,
+                            "[MQTT API] Cannot allocate receive slots\r\n");
+#else /* ESP_CFG_MQTT_API_RX_SLOTS > 0 */
                         esp_mqtt_client_set_arg(client->mc, client);/* Set client to mqtt client argument */
                         return client;
+#endif /* !(ESP_CFG_MQTT_API_RX_SLOTS > 0) */
                     } else {
                         ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_SEVERE,
                             "[MQTT API] Cannot allocate mutex\r\n");
@@ -293,6 +488,12 @@ esp_mqtt_client_api_delete(esp_mqtt_client_api_p client) {
         esp_mqtt_client_delete(client->mc);
         client->mc = NULL;
     }
+#if ESP_CFG_MQTT_PUBLISH_STREAM
+    esp_mqtt_client_api_buf_free(client->rcv_buf);
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM */
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0
+    esp_mem_free_s((void **)&client->rx_slots);
+#endif /* ESP_CFG_MQTT_API_RX_SLOTS > 0 */
     esp_mem_free_s((void **)&client);
 }
 
@@ -519,5 +720,130 @@ esp_mqtt_client_api_receive(esp_mqtt_client_api_p client, esp_mqtt_client_api_bu
  */
 void
 esp_mqtt_client_api_buf_free(esp_mqtt_client_api_buf_p p) {
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0
+    if (p != NULL && p->is_slot) {
+        p->in_use = 0;                          /* Return slot back to client */
+        return;
+    }
+#endif /* ESP_CFG_MQTT_API_RX_SLOTS > 0 */
     esp_mem_free_s((void **)&p);
 }
+
+#if ESP_CFG_MQTT_API_GROUP || __DOXYGEN__
+
+/**
+ * \brief           Create new receive group for MQTT API clients
+ * \param[in]       queue_len: Length of shared receive queue.
+ *                      It should be big enough for packets of all clients in group
+ * \return          Group handle on success, `NULL` otherwise
+ */
+esp_mqtt_client_api_group_p
+esp_mqtt_client_api_group_new(size_t queue_len) {
+    esp_mqtt_client_api_group_p grp;
+
+    if (queue_len == 0) {
+        return NULL;
+    }
+
+    grp = esp_mem_calloc_tag(1, sizeof(*grp), ESP_MEM_TAG_MQTT);
+    if (grp != NULL) {
+        if (!esp_sys_mbox_create(&grp->rcv_mbox, queue_len)) {
+            ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_SEVERE,
+                "[MQTT API] Cannot allocate group receive queue\r\n");
+            esp_mem_free_s((void **)&grp);
+        }
+    } else {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE_SEVERE,
+            "[MQTT API] Cannot allocate memory for group\r\n");
+    }
+    return grp;
+}
+
+/**
+ * \brief           Delete receive group from memory
+ * \note            All clients must be removed from group before it is deleted
+ * \param[in]       grp: Group handle
+ */
+void
+esp_mqtt_client_api_group_delete(esp_mqtt_client_api_group_p grp) {
+    void* d;
+
+    if (grp == NULL) {
+        return;
+    }
+    if (esp_sys_mbox_isvalid(&grp->rcv_mbox)) {
+        while (esp_sys_mbox_getnow(&grp->rcv_mbox, &d)) {
+            if (((esp_mqtt_client_api_buf_p)d)->topic != NULL) {
+                esp_mqtt_client_api_buf_free(d);
+            }
+        }
+        esp_sys_mbox_delete(&grp->rcv_mbox);
+        esp_sys_mbox_invalid(&grp->rcv_mbox);
+    }
+    esp_mem_free_s((void **)&grp);
+}
+
+/**
+ * \brief           Add client to receive group or remove it from group
+ *
+ * Received packets and closed events of client are written to group queue
+ * and must be read with \ref esp_mqtt_client_api_receive_any
+ * instead of \ref esp_mqtt_client_api_receive.
+ *
+ * \note            Change group only when client is not connected,
+ *                  packets already queued are not moved
+ * \param[in]       client: MQTT API client handle
+ * \param[in]       grp: Group handle or `NULL` to use own receive queue again
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+espr_t
+esp_mqtt_client_api_set_group(esp_mqtt_client_api_p client, esp_mqtt_client_api_group_p grp) {
+    ESP_ASSERT("client != NULL", client != NULL);
+
+    esp_core_lock();                            /* Events are processed with core locked */
+    client->grp = grp;
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Receive next packet of any client in group in specific timeout time
+ * \param[in]       grp: Group handle
+ * \param[out]      client: Pointer to output variable for client which received packet or was closed
+ * \param[in]       p: Pointer to output buffer
+ * \param[in]       timeout: Maximal time to wait before function returns timeout
+ * \return          \ref espOK on success, \ref espCLOSED if MQTT of `client` is closed, \ref espTIMEOUT on timeout
+ */
+espr_t
+esp_mqtt_client_api_receive_any(esp_mqtt_client_api_group_p grp, esp_mqtt_client_api_p* client,
+                                esp_mqtt_client_api_buf_p* p, uint32_t timeout) {
+    ESP_ASSERT("grp != NULL", grp != NULL);
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("p != NULL", p != NULL);
+
+    *p = NULL;
+    *client = NULL;
+
+    /* Get new entry from mbox */
+    if (timeout == 0) {
+        if (!esp_sys_mbox_getnow(&grp->rcv_mbox, (void **)p)) {
+            return espTIMEOUT;
+        }
+    } else if (esp_sys_mbox_get(&grp->rcv_mbox, (void **)p, timeout) == ESP_SYS_TIMEOUT) {
+        return espTIMEOUT;
+    }
+    *client = (*p)->client;
+
+    /* Check for MQTT closed event */
+    if ((*p)->topic == NULL) {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_API_TRACE,
+            "[MQTT API] Closed event received from group queue\r\n");
+
+        *p = NULL;
+        return espCLOSED;
+    }
+    return espOK;
+}
+
+#endif /* ESP_CFG_MQTT_API_GROUP || __DOXYGEN__ */
+
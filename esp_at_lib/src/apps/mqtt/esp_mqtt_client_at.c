@@ -0,0 +1,518 @@
+/**
+ * \file            esp_mqtt_client_at.c
+ * \brief           MQTT client on top of ESP32 AT MQTT commands
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/apps/esp_mqtt_client.h"
+#include "esp/esp_mem.h"
+
+#if ESP_CFG_MQTT_AT
+
+/**
+ * \brief           MQTT client on ESP device
+ */
+typedef struct esp_mqtt_client {
+    const esp_mqtt_client_info_t* info;         /*!< Connection info */
+    esp_mqtt_at_info_t at_info;                 /*!< Connection info in format for AT commands */
+    esp_mqtt_state_t conn_state;                /*!< MQTT connection state */
+    uint8_t is_accepted;                        /*!< Set to `1` when connect command succeeded */
+
+    esp_mqtt_evt_t evt;                         /*!< MQTT event callback */
+    esp_mqtt_evt_fn evt_fn;                     /*!< Event callback function */
+
+    void* arg;                                  /*!< User argument */
+} esp_mqtt_client_t;
+
+/**
+ * \brief           Command in progress on active client
+ *
+ * Strings and data are copied,
+ * so that application does not need to keep them until command finishes
+ */
+typedef struct {
+    esp_mqtt_client_p client;                   /*!< Client which started command */
+    void* arg;                                  /*!< User argument for event */
+    char data[1];                               /*!< Topic or host with `NULL` termination, followed by payload */
+} mqtt_at_req_t;
+
+/* Tracing debug message */
+#define ESP_CFG_DBG_MQTT_TRACE                  (ESP_CFG_DBG_MQTT | ESP_DBG_TYPE_TRACE)
+#define ESP_CFG_DBG_MQTT_STATE                  (ESP_CFG_DBG_MQTT | ESP_DBG_TYPE_STATE)
+
+static esp_mqtt_client_p mqtt_at_client;        /*!< Device supports one client only */
+
+/**
+ * \brief           Default event callback function
+ * \param[in]       client: MQTT client
+ * \param[in]       evt: Event
+ */
+static void
+mqtt_evt_fn_default(esp_mqtt_client_p client, esp_mqtt_evt_t* evt) {
+    ESP_UNUSED(client);
+    ESP_UNUSED(evt);
+}
+
+/**
+ * \brief           Allocate command request with copy of string and data
+ * \param[in]       client: MQTT client
+ * \param[in]       arg: User argument for event
+ * \param[in]       str: Topic or host to copy
+ * \param[in]       data: Data to copy after string. Set to `NULL` when not used
+ * \param[in]       len: Length of data
+ * \return          New request or `NULL` on failure
+ */
+static mqtt_at_req_t *
+mqtt_at_req_new(esp_mqtt_client_p client, void* arg, const char* str, const void* data, size_t len) {
+    mqtt_at_req_t* req;
+    size_t str_len = strlen(str);
+
+    req = esp_mem_malloc_tag(sizeof(*req) + str_len + len, ESP_MEM_TAG_MQTT);
+    if (req != NULL) {
+        req->client = client;
+        req->arg = arg;
+        ESP_MEMCPY(req->data, str, str_len + 1);
+        if (data != NULL) {
+            ESP_MEMCPY(&req->data[str_len + 1], data, len);
+        }
+    }
+    return req;
+}
+
+/**
+ * \brief           Send disconnect event to application
+ * \param[in]       client: MQTT client
+ */
+static void
+mqtt_at_disconnected(esp_mqtt_client_p client) {
+    client->evt.type = ESP_MQTT_EVT_DISCONNECT;
+    client->evt.evt.disconnect.is_accepted = client->is_accepted;
+    client->conn_state = ESP_MQTT_CONN_DISCONNECTED;
+    client->is_accepted = 0;
+    client->evt_fn(client, &client->evt);
+}
+
+/**
+ * \brief           Connect command finished
+ * \param[in]       res: Command result
+ * \param[in]       arg: Request
+ */
+static void
+mqtt_at_connect_cb(espr_t res, void* arg) {
+    mqtt_at_req_t* req = arg;
+    esp_mqtt_client_p client = req->client;
+
+    /* Client may be disconnected while connect command is in progress */
+    if (client == mqtt_at_client && client->conn_state == ESP_MQTT_CONNECTING) {
+        ESP_DEBUGF(ESP_CFG_DBG_MQTT_STATE,
+            "[MQTT AT] Connect finished with result: %d\r\n", (int)res);
+        if (res == espOK) {
+            client->conn_state = ESP_MQTT_CONNECTED;
+            client->is_accepted = 1;
+            client->evt.evt.connect.status = ESP_MQTT_CONN_STATUS_ACCEPTED;
+        } else {
+            client->conn_state = ESP_MQTT_CONN_DISCONNECTED;
+            client->evt.evt.connect.status = ESP_MQTT_CONN_STATUS_TCP_FAILED;
+        }
+        client->evt.type = ESP_MQTT_EVT_CONNECT;
+        client->evt_fn(client, &client->evt);
+    }
+    esp_mem_free(req);
+}
+
+/**
+ * \brief           Close command finished
+ * \param[in]       res: Command result
+ * \param[in]       arg: MQTT client
+ */
+static void
+mqtt_at_close_cb(espr_t res, void* arg) {
+    esp_mqtt_client_p client = arg;
+
+    ESP_UNUSED(res);
+    if (client == mqtt_at_client && client->conn_state == ESP_MQTT_CONN_DISCONNECTING) {
+        mqtt_at_disconnected(client);           /* Connection is released even if command failed */
+    }
+}
+
+/**
+ * \brief           Subscribe or unsubscribe command finished
+ * \param[in]       res: Command result
+ * \param[in]       req: Request
+ * \param[in]       type: Event type to send
+ */
+static void
+mqtt_at_sub_unsub_finish(espr_t res, mqtt_at_req_t* req, esp_mqtt_evt_type_t type) {
+    esp_mqtt_client_p client = req->client;
+
+    if (client == mqtt_at_client) {
+        client->evt.type = type;
+        client->evt.evt.sub_unsub_scribed.arg = req->arg;
+        client->evt.evt.sub_unsub_scribed.res = res;
+        client->evt_fn(client, &client->evt);
+    }
+    esp_mem_free(req);
+}
+
+/**
+ * \brief           Subscribe command finished
+ * \param[in]       res: Command result
+ * \param[in]       arg: Request
+ */
+static void
+mqtt_at_sub_cb(espr_t res, void* arg) {
+    mqtt_at_sub_unsub_finish(res, arg, ESP_MQTT_EVT_SUBSCRIBE);
+}
+
+/**
+ * \brief           Unsubscribe command finished
+ * \param[in]       res: Command result
+ * \param[in]       arg: Request
+ */
+static void
+mqtt_at_unsub_cb(espr_t res, void* arg) {
+    mqtt_at_sub_unsub_finish(res, arg, ESP_MQTT_EVT_UNSUBSCRIBE);
+}
+
+/**
+ * \brief           Publish command finished
+ * \param[in]       res: Command result
+ * \param[in]       arg: Request
+ */
+static void
+mqtt_at_pub_cb(espr_t res, void* arg) {
+    mqtt_at_req_t* req = arg;
+    esp_mqtt_client_p client = req->client;
+
+    if (client == mqtt_at_client) {
+        client->evt.type = ESP_MQTT_EVT_PUBLISH;
+        client->evt.evt.publish.arg = req->arg;
+        client->evt.evt.publish.res = res;
+        client->evt_fn(client, &client->evt);
+    }
+    esp_mem_free(req);
+}
+
+/**
+ * \brief           Global event callback for connection status and received messages
+ * \param[in]       evt: Event
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+mqtt_at_evt_fn(esp_evt_t* evt) {
+    esp_mqtt_client_p client = mqtt_at_client;
+
+    if (client == NULL) {
+        return espOK;
+    }
+    switch (esp_evt_get_type(evt)) {
+        case ESP_EVT_MQTT_AT_CONN: {
+            /* Connect is reported by command result, disconnect only when it is not requested */
+            if (!esp_evt_mqtt_at_conn_is_connected(evt) && client->conn_state == ESP_MQTT_CONNECTED) {
+                ESP_DEBUGF(ESP_CFG_DBG_MQTT_STATE, "[MQTT AT] Connection closed by device\r\n");
+                mqtt_at_disconnected(client);
+            }
+            break;
+        }
+        case ESP_EVT_MQTT_AT_RECV: {
+            if (client->conn_state == ESP_MQTT_CONNECTED) {
+                client->evt.type = ESP_MQTT_EVT_PUBLISH_RECV;
+                client->evt.evt.publish_recv.topic = (const void *)esp_evt_mqtt_at_recv_get_topic(evt);
+                client->evt.evt.publish_recv.topic_len = esp_evt_mqtt_at_recv_get_topic_len(evt);
+                client->evt.evt.publish_recv.payload = esp_evt_mqtt_at_recv_get_data(evt);
+                client->evt.evt.publish_recv.payload_len = esp_evt_mqtt_at_recv_get_len(evt);
+                client->evt.evt.publish_recv.dup = 0;   /* Not reported by device */
+                client->evt.evt.publish_recv.qos = ESP_MQTT_QOS_AT_MOST_ONCE;
+                client->evt_fn(client, &client->evt);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return espOK;
+}
+
+/**
+ * \brief           Allocate a new MQTT client structure
+ * \note            Device supports one client, function fails if client already exists
+ * \param[in]       tx_buff_len: Not used, data are buffered on device
+ * \param[in]       rx_buff_len: Not used, data are buffered on device
+ * \return          Pointer to new allocated MQTT client structure or `NULL` on failure
+ */
+esp_mqtt_client_t *
+esp_mqtt_client_new(size_t tx_buff_len, size_t rx_buff_len) {
+    esp_mqtt_client_p client = NULL;
+
+    ESP_UNUSED(tx_buff_len);
+    ESP_UNUSED(rx_buff_len);
+
+    esp_core_lock();
+    if (mqtt_at_client == NULL && esp_evt_register(mqtt_at_evt_fn) == espOK) {
+        client = esp_mem_malloc_tag(sizeof(*client), ESP_MEM_TAG_MQTT);
+        if (client != NULL) {
+            ESP_MEMSET(client, 0x00, sizeof(*client));
+            client->conn_state = ESP_MQTT_CONN_DISCONNECTED;/* Set to disconnected mode */
+            mqtt_at_client = client;
+        } else {
+            esp_evt_unregister(mqtt_at_evt_fn);
+        }
+    }
+    esp_core_unlock();
+    return client;
+}
+
+/**
+ * \brief           Delete MQTT client structure
+ * \note            MQTT client must be disconnected first
+ * \param[in]       client: MQTT client
+ */
+void
+esp_mqtt_client_delete(esp_mqtt_client_p client) {
+    if (client != NULL) {
+        esp_core_lock();
+        if (client == mqtt_at_client) {
+            mqtt_at_client = NULL;              /* Pending commands must not use deleted client */
+            esp_evt_unregister(mqtt_at_evt_fn);
+        }
+        esp_core_unlock();
+        esp_mem_free_s((void **)&client);
+    }
+}
+
+/**
+ * \brief           Connect to MQTT server
+ * \note            Device connects to server and sends CONNECT packet with single command
+ * \param[in]       client: MQTT client
+ * \param[in]       host: Host address for server
+ * \param[in]       port: Host port number
+ * \param[in]       evt_fn: Callback function for all events on this MQTT client
+ * \param[in]       info: Information structure for connection
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_connect(esp_mqtt_client_p client, const char* host, esp_port_t port,
+                        esp_mqtt_evt_fn evt_fn, const esp_mqtt_client_info_t* info) {
+    mqtt_at_req_t* req;
+    espr_t res = espERR;
+
+    ESP_ASSERT("client != NULL", client != NULL);
+    ESP_ASSERT("host != NULL", host != NULL);
+    ESP_ASSERT("port > 0", port > 0);
+    ESP_ASSERT("info != NULL", info != NULL);
+
+    esp_core_lock();
+    if (esp_sta_is_joined() && client->conn_state == ESP_MQTT_CONN_DISCONNECTED) {
+        client->info = info;                    /* Save client info parameters */
+        client->evt_fn = evt_fn != NULL ? evt_fn : mqtt_evt_fn_default;
+
+        client->at_info.id = info->id;
+        client->at_info.user = info->user;
+        client->at_info.pass = info->pass;
+        client->at_info.keep_alive = info->keep_alive;
+        client->at_info.will_topic = info->will_topic;
+        client->at_info.will_message = info->will_message;
+        client->at_info.will_qos = ESP_U8(info->will_qos);
+
+        if ((req = mqtt_at_req_new(client, NULL, host, NULL, 0)) == NULL) {
+            res = espERRMEM;
+        } else if ((res = esp_mqtt_at_connect(&client->at_info, req->data, port, mqtt_at_connect_cb, req, 0)) == espOK) {
+            client->conn_state = ESP_MQTT_CONNECTING;
+        } else {
+            esp_mem_free(req);
+        }
+    }
+    esp_core_unlock();
+
+    return res;
+}
+
+/**
+ * \brief           Disconnect from MQTT server
+ * \param[in]       client: MQTT client
+ * \return          \ref espOK if request sent to queue or member of \ref espr_t otherwise
+ */
+espr_t
+esp_mqtt_client_disconnect(esp_mqtt_client_p client) {
+    espr_t res = espERR;
+
+    esp_core_lock();
+    if (client->conn_state != ESP_MQTT_CONN_DISCONNECTED
+        && client->conn_state != ESP_MQTT_CONN_DISCONNECTING) {
+        if ((res = esp_mqtt_at_close(mqtt_at_close_cb, client, 0)) == espOK) {
+            client->conn_state = ESP_MQTT_CONN_DISCONNECTING;
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Subscribe to or unsubscribe from MQTT topic
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic name
+ * \param[in]       qos: Quality of service, used on subscribe only
+ * \param[in]       arg: User custom argument used in callback
+ * \param[in]       sub: Set to `1` to subscribe or `0` to unsubscribe
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+sub_unsub(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, void* arg, uint8_t sub) {
+    mqtt_at_req_t* req;
+    espr_t res = espERR;
+
+    if (!strlen(topic)) {
+        return espERR;
+    }
+
+    esp_core_lock();
+    if (client->conn_state == ESP_MQTT_CONNECTED) {
+        if ((req = mqtt_at_req_new(client, arg, topic, NULL, 0)) == NULL) {
+            res = espERRMEM;
+        } else {
+            if (sub) {
+                res = esp_mqtt_at_subscribe(req->data, ESP_U8(qos), mqtt_at_sub_cb, req, 0);
+            } else {
+                res = esp_mqtt_at_unsubscribe(req->data, mqtt_at_unsub_cb, req, 0);
+            }
+            if (res != espOK) {
+                esp_mem_free(req);
+            }
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Subscribe to MQTT topic
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic name to subscribe to
+ * \param[in]       qos: Quality of service. This parameter can be a value of \ref esp_mqtt_qos_t
+ * \param[in]       arg: User custom argument used in callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_subscribe(esp_mqtt_client_p client, const char* topic, esp_mqtt_qos_t qos, void* arg) {
+    return sub_unsub(client, topic, qos, arg, 1);
+}
+
+/**
+ * \brief           Unsubscribe from MQTT topic
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic name to unsubscribe from
+ * \param[in]       arg: User custom argument used in callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_unsubscribe(esp_mqtt_client_p client, const char* topic, void* arg) {
+    return sub_unsub(client, topic, (esp_mqtt_qos_t)0, arg, 0);
+}
+
+/**
+ * \brief           Publish a new message on specific topic
+ *
+ * Topic and payload are copied, \ref ESP_MQTT_EVT_PUBLISH event
+ * is sent for every quality of service when device reports result
+ *
+ * \param[in]       client: MQTT client
+ * \param[in]       topic: Topic to send message to
+ * \param[in]       payload: Message data
+ * \param[in]       payload_len: Length of payload data
+ * \param[in]       qos: Quality of service. This parameter can be a value of \ref esp_mqtt_qos_t enumeration
+ * \param[in]       retain: Retian parameter value
+ * \param[in]       arg: User custom argument used in callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_client_publish(esp_mqtt_client_p client, const char* topic, const void* payload,
+                        uint16_t payload_len, esp_mqtt_qos_t qos, uint8_t retain, void* arg) {
+    mqtt_at_req_t* req;
+    espr_t res;
+
+    if (!strlen(topic) || payload == NULL || payload_len == 0) {    /* Device does not accept empty payload */
+        return espERR;
+    }
+
+    esp_core_lock();
+    if (client->conn_state != ESP_MQTT_CONNECTED) {
+        res = espCLOSED;
+    } else if ((req = mqtt_at_req_new(client, arg, topic, payload, payload_len)) == NULL) {
+        res = espERRMEM;
+    } else {
+        res = esp_mqtt_at_publish(req->data, &req->data[strlen(req->data) + 1], payload_len,
+                                    ESP_U8(qos), retain, mqtt_at_pub_cb, req, 0);
+        if (res != espOK) {
+            esp_mem_free(req);
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Test if client is connected to server and accepted to MQTT protocol
+ * \param[in]       client: MQTT client
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_mqtt_client_is_connected(esp_mqtt_client_p client) {
+    uint8_t res;
+
+    esp_core_lock();
+    res = ESP_U8(client->conn_state == ESP_MQTT_CONNECTED);
+    esp_core_unlock();
+
+    return res;
+}
+
+/**
+ * \brief           Set user argument on client
+ * \param[in]       client: MQTT client handle
+ * \param[in]       arg: User argument
+ */
+void
+esp_mqtt_client_set_arg(esp_mqtt_client_p client, void* arg) {
+    esp_core_lock();
+    client->arg = arg;
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Get user argument on client
+ * \param[in]       client: MQTT client handle
+ * \return          User argument
+ */
+void *
+esp_mqtt_client_get_arg(esp_mqtt_client_p client) {
+    return client->arg;
+}
+
+#endif /* ESP_CFG_MQTT_AT */
@@ -39,6 +39,8 @@
 
 static cli_commands_t cli_command_table[CLI_MAX_MODULES];
 static size_t num_of_modules;
+static const cli_command_t* cli_command_index[CLI_MAX_COMMANDS];    /* Commands sorted by name */
+static size_t num_of_indexed_commands;
 
 static void cli_list(cli_printf cliprintf, int argc, char** argv);
 static void cli_help(cli_printf cliprintf, int argc, char** argv);
@@ -52,6 +54,27 @@ commands[] = {
     { "list",           "Lists available commands",                 cli_list },
 };
 
+/**
+ * \brief           Find first entry in sorted index not smaller than name
+ * \param[in]       name: Command name or prefix to search for
+ * \param[in]       len: Number of characters to compare, whole name when set to `SIZE_MAX`
+ * \return          Index of first entry, equal to number of entries when not found
+ */
+static size_t
+cli_index_lower_bound(const char* name, size_t len) {
+    size_t lo = 0, hi = num_of_indexed_commands;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strncmp(cli_command_index[mid]->name, name, len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 /**
  * \brief           Find the CLI command that matches the input string
  * \param[in]       command: pointer to command string for which we are searching
@@ -59,13 +82,10 @@ commands[] = {
  */
 const cli_command_t *
 cli_lookup_command(char* command) {
-    uint32_t module_index, command_index;
-    for (module_index = 0; module_index < num_of_modules; ++module_index) {
-        for (command_index = 0; command_index < cli_command_table[module_index].num_of_commands; ++command_index) {
-            if (!strcmp(command, cli_command_table[module_index].commands[command_index].name)) {
-                return &cli_command_table[module_index].commands[command_index];
-            }
-        }
+    size_t i = cli_index_lower_bound(command, SIZE_MAX);
+
+    if (i < num_of_indexed_commands && !strcmp(command, cli_command_index[i]->name)) {
+        return cli_command_index[i];
     }
     return NULL;
 }
@@ -80,54 +100,55 @@ cli_lookup_command(char* command) {
 void
 cli_tab_auto_complete(cli_printf cliprintf, char* cmd_buffer, uint32_t* cmd_pos, bool print_options) {
     const char* matched_command = NULL;
-    uint32_t module_index, command_index;
+    size_t index;
     uint32_t num_of_matched_commands = 0;
     uint32_t common_command_len = 0;
 
-    for (module_index = 0; module_index < num_of_modules; ++module_index) {
-        for (command_index = 0; command_index < cli_command_table[module_index].num_of_commands; ++command_index) {
-            const cli_command_t *command = &cli_command_table[module_index].commands[command_index];
-            if (!strncmp(cmd_buffer, cli_command_table[module_index].commands[command_index].name, *cmd_pos)) {
-                /* Found a new command which matches the string */
-                if (num_of_matched_commands == 0) {
-                    /*
-                     * Save the first match for later tab completion in case
-                     * print_option is true (double tab)
-                     */
-                    matched_command = command->name;
-                    common_command_len = strlen(matched_command);
-                } else {
-                    /*
-                     * More then one match
-                     * in case of print_option we need to print all options
-                     */
-                    if (print_options) {
-                        /*
-                         * Because we want to print help options only when we
-                         * have multiple matches, print also the first one.
-                         */
-                        if (num_of_matched_commands == 1) {
-                            cliprintf(CLI_NL"%s"CLI_NL, matched_command);
-                        }
-                        cliprintf("%s"CLI_NL, command->name);
-                    }
-
-                    /*
-                     * Find the common prefix of all the matched commands for
-                     * partial completion
-                     */
-                    uint32_t last_common_command_len = common_command_len;
-                    common_command_len = 0;
-                    while (matched_command[common_command_len] == command->name[common_command_len]
-                            && matched_command[common_command_len] != '\0'
-                            && command->name[common_command_len] != '\0'
-                            && common_command_len < last_common_command_len) {
-                        ++common_command_len;
-                    }
+    /* Matching commands are next to each other in sorted index */
+    for (index = cli_index_lower_bound(cmd_buffer, *cmd_pos); index < num_of_indexed_commands; ++index) {
+        const cli_command_t *command = cli_command_index[index];
+        if (strncmp(cmd_buffer, command->name, *cmd_pos)) {
+            break;                              /* No more commands with this prefix */
+        }
+
+        /* Found a new command which matches the string */
+        if (num_of_matched_commands == 0) {
+            /*
+             * Save the first match for later tab completion in case
+             * print_option is true (double tab)
+             */
+            matched_command = command->name;
+            common_command_len = strlen(matched_command);
+        } else {
+            /*
+             * More then one match
+             * in case of print_option we need to print all options
+             */
+            if (print_options) {
+                /*
+                 * Because we want to print help options only when we
+                 * have multiple matches, print also the first one.
+                 */
+                if (num_of_matched_commands == 1) {
+                    cliprintf(CLI_NL"%s"CLI_NL, matched_command);
                 }
-                ++num_of_matched_commands;
+                cliprintf("%s"CLI_NL, command->name);
+            }
+
+            /*
+             * Find the common prefix of all the matched commands for
+             * partial completion
+             */
+            uint32_t last_common_command_len = common_command_len;
+            common_command_len = 0;
+            while (matched_command[common_command_len] == command->name[common_command_len]
+                    && matched_command[common_command_len] != '\0'
+                    && command->name[common_command_len] != '\0'
+                    && common_command_len < last_common_command_len) {
+                ++common_command_len;
             }
         }
+        ++num_of_matched_commands;
     }
 
     /* Do the full/partial tab completion */
@@ -151,6 +172,10 @@ cli_register_commands(const cli_command_t* commands, size_t num_of_commands) {
         printf("Exceeded the maximum number of CLI modules\n\r");
         return false;
     }
+    if (num_of_indexed_commands + num_of_commands > CLI_MAX_COMMANDS) {
+        printf("Exceeded the maximum number of CLI commands\n\r");
+        return false;
+    }
 
     /*
      * Warning: Not threadsafe!
@@ -160,6 +185,17 @@ cli_register_commands(const cli_command_t* commands, size_t num_of_commands) {
     cli_command_table[num_of_modules].num_of_commands = num_of_commands;
     ++num_of_modules;
 
+    /* Insert to sorted index, after commands with the same name registered before */
+    for (size_t i = 0; i < num_of_commands; ++i) {
+        size_t pos = num_of_indexed_commands;
+        while (pos > 0 && strcmp(cli_command_index[pos - 1]->name, commands[i].name) > 0) {
+            cli_command_index[pos] = cli_command_index[pos - 1];
+            --pos;
+        }
+        cli_command_index[pos] = &commands[i];
+        ++num_of_indexed_commands;
+    }
+
     return true;
 }
 
@@ -32,44 +32,42 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include "cli/cli.h"
 #include "cli/cli_input.h"
 #include "cli/cli_config.h"
 
-/* Statically allocate CLI buffer to eliminate overhead of using heap*/
-static char cmd_buffer[CLI_MAX_CMD_LENGTH];
-static uint32_t cmd_pos;
-
-static char cmd_history_buffer[CLI_CMD_HISTORY][CLI_MAX_CMD_LENGTH];
-static uint32_t cmd_history_pos;
-static uint32_t cmd_history_full;
+/* Statically allocate default session to eliminate overhead of using heap */
+static cli_session_t default_session;
 
 /**
  * \brief           Clear the command buffer and reset the position
+ * \param[in]       s: CLI session
  */
 static void
-clear_cmd_buffer( void ) {
-    memset(cmd_buffer, 0x0, sizeof(cmd_buffer));
-    cmd_pos = 0;
+clear_cmd_buffer(cli_session_t* s) {
+    memset(s->cmd_buffer, 0x0, sizeof(s->cmd_buffer));
+    s->cmd_pos = 0;
 }
 
 /**
  * \brief           Stores the command to history
+ * \param[in]       s: CLI session
  */
 static void
-store_command_to_history(void) {
+store_command_to_history(cli_session_t* s) {
     uint32_t hist_count;
-    if (strcmp(cmd_history_buffer[0], cmd_buffer)) {
+    if (strcmp(s->cmd_history_buffer[0], s->cmd_buffer)) {
         for (hist_count = CLI_CMD_HISTORY - 1; hist_count > 0; --hist_count) {
-            memcpy(cmd_history_buffer[hist_count], cmd_history_buffer[hist_count-1], CLI_MAX_CMD_LENGTH);
+            memcpy(s->cmd_history_buffer[hist_count], s->cmd_history_buffer[hist_count-1], CLI_MAX_CMD_LENGTH);
         }
-        ++cmd_history_full;
-        if (cmd_history_full > CLI_CMD_HISTORY) {
-            cmd_history_full = CLI_CMD_HISTORY;
+        ++s->cmd_history_full;
+        if (s->cmd_history_full > CLI_CMD_HISTORY) {
+            s->cmd_history_full = CLI_CMD_HISTORY;
         }
-        memcpy(cmd_history_buffer[0], cmd_buffer, CLI_MAX_CMD_LENGTH);
-        cmd_history_buffer[0][CLI_MAX_CMD_LENGTH - 1] = '\0';
+        memcpy(s->cmd_history_buffer[0], s->cmd_buffer, CLI_MAX_CMD_LENGTH);
+        s->cmd_history_buffer[0][CLI_MAX_CMD_LENGTH - 1] = '\0';
     }
 }
 
@@ -82,53 +80,52 @@ store_command_to_history(void) {
  *                      ^[D  : Left
  *                      ^[1~ : Home (TODO)
  *                      ^OF  : End (TODO)
- * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       s: CLI session
  * \param[in]       ch: input char from CLI
  * \return          true when special key sequence is active, else false
  */
 static bool
-cli_special_key_check(cli_printf cliprintf, char ch) {
-    static uint32_t key_sequence;
-    static char last_ch;
+cli_special_key_check(cli_session_t* s, char ch) {
+    cli_printf* cliprintf = s->cliprintf;
     bool special_key_found = false;
 
-    if (key_sequence == 0 && ch == 27) {
+    if (s->key_sequence == 0 && ch == 27) {
         special_key_found = true;
-        key_sequence = 1;
-    } else if (key_sequence == 1 && (ch == '[' || ch == 'O')) {
+        s->key_sequence = 1;
+    } else if (s->key_sequence == 1 && (ch == '[' || ch == 'O')) {
         special_key_found = true;
-        key_sequence = 2;
-    } else if (key_sequence == 2 && ch >= 'A' && ch <= 'D') {
+        s->key_sequence = 2;
+    } else if (s->key_sequence == 2 && ch >= 'A' && ch <= 'D') {
         special_key_found = true;
-        key_sequence = 0;
+        s->key_sequence = 0;
         switch (ch) {
             case 'A':                           /* Up */
-                if (cmd_history_pos < cmd_history_full) {
+                if (s->cmd_history_pos < s->cmd_history_full) {
                     /* Clear the line */
-                    memset(cmd_buffer, ' ', cmd_pos);
-                    cliprintf("\r%s       \r" CLI_PROMPT, cmd_buffer);
+                    memset(s->cmd_buffer, ' ', s->cmd_pos);
+                    cliprintf("\r%s       \r" CLI_PROMPT, s->cmd_buffer);
 
-                    strcpy(cmd_buffer, cmd_history_buffer[cmd_history_pos]);
-                    cmd_pos = strlen(cmd_buffer);
-                    cliprintf("%s", cmd_buffer);
+                    strcpy(s->cmd_buffer, s->cmd_history_buffer[s->cmd_history_pos]);
+                    s->cmd_pos = strlen(s->cmd_buffer);
+                    cliprintf("%s", s->cmd_buffer);
 
-                    ++cmd_history_pos;
+                    ++s->cmd_history_pos;
                 } else {
                     cliprintf("\a");
                 }
                 break;
             case 'B':                           /* Down */
-                if (cmd_history_pos > 0) {
+                if (s->cmd_history_pos > 0) {
                     /* Clear the line */
-                    memset(cmd_buffer, ' ', cmd_pos);
-                    cliprintf("\r%s       \r" CLI_PROMPT, cmd_buffer);
+                    memset(s->cmd_buffer, ' ', s->cmd_pos);
+                    cliprintf("\r%s       \r" CLI_PROMPT, s->cmd_buffer);
 
-                    if (--cmd_history_pos != 0) {
-                        strcpy(cmd_buffer, cmd_history_buffer[cmd_history_pos]);
-                        cmd_pos = strlen(cmd_buffer);
-                        cliprintf("%s", cmd_buffer);
+                    if (--s->cmd_history_pos != 0) {
+                        strcpy(s->cmd_buffer, s->cmd_history_buffer[s->cmd_history_pos]);
+                        s->cmd_pos = strlen(s->cmd_buffer);
+                        cliprintf("%s", s->cmd_buffer);
                     } else {
-                        clear_cmd_buffer();
+                        clear_cmd_buffer(s);
                     }
                 } else {
                     cliprintf("\a");
@@ -139,8 +136,8 @@ cli_special_key_check(cli_printf cliprintf, char ch) {
                 /* TODO not finnished
                  * need to implement a courser
                  */
-                if (cmd_pos < strlen(cmd_buffer)) {
-                    ++cmd_pos;
+                if (s->cmd_pos < strlen(s->cmd_buffer)) {
+                    ++s->cmd_pos;
                     cliprintf("\033[\1C");
                 } else {
                     cliprintf("\a");
@@ -150,41 +147,37 @@ cli_special_key_check(cli_printf cliprintf, char ch) {
                 /* TODO not finnished
                  * need to implement a courser
                  */
-                if (cmd_pos > 0) {
-                    --cmd_pos;
+                if (s->cmd_pos > 0) {
+                    --s->cmd_pos;
                     cliprintf("\033[\1D");
                 } else {
                     cliprintf("\a");
                 }
                 break;
         }
-    } else if (key_sequence == 2 && (ch == 'F')) {
+    } else if (s->key_sequence == 2 && (ch == 'F')) {
         /* End*/
         /* TODO: for now just return invalid key */
         cliprintf("\a");
-    } else if (key_sequence == 2 && (ch == '1' || ch == '3')) {
+    } else if (s->key_sequence == 2 && (ch == '1' || ch == '3')) {
         /* Home or Delete, we need to check one more character */
         special_key_found = true;
-        key_sequence = 3;
-    } else if (key_sequence == 3) {
+        s->key_sequence = 3;
+    } else if (s->key_sequence == 3) {
         /* TODO Home and Delete: for now just return invalid key */
         cliprintf("\a");
         special_key_found = true;
     } else {
         /* Unknown sequence */
-        key_sequence = 0;
+        s->key_sequence = 0;
     }
 
-    /* Store the last character */
-    last_ch = ch;
-
-    (void)last_ch;                              /* Prevent compiler warnings */
-
     return special_key_found;
 }
 
 /**
  * \brief           parse and execute the given command
+ * \note            Input is split in place, without `strtok`, so sessions may run in parallel
  * \param[in]       cliprintf: Pointer to CLI printf function
  * \param[in]       input: input string to parse
  * \return          `true` when command is found and parsed, else `false`
@@ -195,9 +188,24 @@ cli_parse_and_execute_command(cli_printf cliprintf, char *input) {
     char * argv[CLI_MAX_NUM_OF_ARGS];
     uint32_t argc = 0;
 
-    argv[argc] = strtok(input, " ");
-    while (argv[argc] != NULL) {
-        argv[++argc] = strtok (NULL, " ");
+    while (argc < CLI_MAX_NUM_OF_ARGS - 1) {
+        while (*input == ' ') {                 /* Skip separators */
+            ++input;
+        }
+        if (*input == '\0') {
+            break;
+        }
+        argv[argc++] = input;
+        while (*input != ' ' && *input != '\0') {
+            ++input;
+        }
+        if (*input == ' ') {
+            *input++ = '\0';
+        }
+    }
+    argv[argc] = NULL;
+    if (argc == 0) {
+        return false;
     }
 
     if ((command = cli_lookup_command(argv[0])) == NULL) {
@@ -211,25 +219,36 @@ cli_parse_and_execute_command(cli_printf cliprintf, char *input) {
 }
 
 /**
- * \brief           parse new characters to the CLI
- * \param[in]       cliprintf: Pointer to CLI printf function
- * \param[in]       ch: new character to CLI
+ * \brief           Initialize CLI session
+ * \param[in]       s: CLI session to initialize
+ * \param[in]       cliprintf: Pointer to CLI printf function used for session output
  */
 void
-cli_in_data(cli_printf cliprintf, char ch) {
-    static char last_ch;
+cli_session_init(cli_session_t* s, cli_printf cliprintf) {
+    memset(s, 0x00, sizeof(*s));
+    s->cliprintf = cliprintf;
+}
+
+/**
+ * \brief           Process new character of the CLI session
+ * \param[in]       s: CLI session
+ * \param[in]       ch: new character to CLI
+ */
+static void
+session_process_ch(cli_session_t* s, char ch) {
+    cli_printf* cliprintf = s->cliprintf;
 
-    if (!cli_special_key_check(cliprintf, ch)) {
+    if (!cli_special_key_check(s, ch)) {
         /* Parse the characters only if they are not part of the special key sequence */
         switch (ch) {
             /* Backspace */
             case '\b':
             case 127:
-                if (cmd_pos != 0) {
+                if (s->cmd_pos != 0) {
                     /* TODO not finished
                      * in case courser is not at the end this doesn't work properly
                      */
-                    cmd_buffer[--cmd_pos] = '\0';
+                    s->cmd_buffer[--s->cmd_pos] = '\0';
                     cliprintf("\033[\1D");
                     cliprintf("\033[K");
                 } else {
@@ -238,39 +257,149 @@ cli_in_data(cli_printf cliprintf, char ch) {
                 break;
             /* Tab for autocomplete */
             case '\t':
-                cli_tab_auto_complete(cliprintf, cmd_buffer, &cmd_pos, (last_ch == '\t'));
+                cli_tab_auto_complete(cliprintf, s->cmd_buffer, &s->cmd_pos, (s->last_ch == '\t'));
                 break;
             /* New line -> new command */
             case '\n':
             case '\r':
-                cmd_history_pos = 0;
-                if (!strlen(cmd_buffer)) {
-                    clear_cmd_buffer();
+                s->cmd_history_pos = 0;
+                if (!strlen(s->cmd_buffer)) {
+                    clear_cmd_buffer(s);
                     cliprintf(CLI_NL CLI_PROMPT);
-                    return;
+                    break;
                 }
 
                 cliprintf(CLI_NL);
-                store_command_to_history();
-                cli_parse_and_execute_command(cliprintf, cmd_buffer);
+                store_command_to_history(s);
+                cli_parse_and_execute_command(cliprintf, s->cmd_buffer);
 
-                clear_cmd_buffer();
+                clear_cmd_buffer(s);
                 cliprintf(CLI_NL CLI_PROMPT);
                 break;
             /* All other chars */
             default:
-                if (cmd_pos < CLI_MAX_CMD_LENGTH) {
-                    cmd_buffer[cmd_pos++] = ch;
+                if (s->cmd_pos < CLI_MAX_CMD_LENGTH - 1) {
+                    s->cmd_buffer[s->cmd_pos++] = ch;
                 } else {
-                    clear_cmd_buffer();
+                    clear_cmd_buffer(s);
                     cliprintf(CLI_NL"\aERR: Command too long"CLI_NL CLI_PROMPT);
-                    return;
+                    break;
                 }
                 cliprintf("%c", ch);
         }
     }
 
     /* Store last character for double tab detection */
-    last_ch = ch;
+    s->last_ch = ch;
+}
+
+/**
+ * \brief           parse new character to the CLI session
+ * \param[in]       s: CLI session
+ * \param[in]       ch: new character to CLI
+ */
+void
+cli_session_in_data(cli_session_t* s, char ch) {
+    session_process_ch(s, ch);
+#if CLI_OUT_BUFF_SIZE > 0
+    cli_session_flush(s);
+#endif /* CLI_OUT_BUFF_SIZE > 0 */
 }
 
+/**
+ * \brief           parse block of received characters to the CLI session
+ * \note            With buffered output, echo and command output of whole block are written at once
+ * \param[in]       s: CLI session
+ * \param[in]       data: Received characters
+ * \param[in]       len: Number of characters
+ */
+void
+cli_session_in_buff(cli_session_t* s, const void* data, size_t len) {
+    const char* d = data;
+
+    for (size_t i = 0; i < len; ++i) {
+        session_process_ch(s, d[i]);
+    }
+#if CLI_OUT_BUFF_SIZE > 0
+    cli_session_flush(s);
+#endif /* CLI_OUT_BUFF_SIZE > 0 */
+}
+
+#if CLI_OUT_BUFF_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Enable buffered output of CLI session
+ *
+ * Printf function of session must forward its output to \ref cli_session_vprintf
+ *
+ * \param[in]       s: CLI session
+ * \param[in]       write_fn: Function to write collected output, `NULL` to disable buffering
+ * \param[in]       arg: User argument for write function
+ */
+void
+cli_session_set_output(cli_session_t* s, cli_write_fn* write_fn, void* arg) {
+    s->out_write = write_fn;
+    s->out_arg = arg;
+    s->out_len = 0;
+}
+
+/**
+ * \brief           Format output to session output buffer
+ * \param[in]       s: CLI session with output set by \ref cli_session_set_output
+ * \param[in]       fmt: Format for the printf
+ * \param[in]       argptr: Format arguments
+ */
+void
+cli_session_vprintf(cli_session_t* s, const char* fmt, va_list argptr) {
+    va_list args;
+    int len;
+
+    if (s->out_write == NULL) {
+        return;
+    }
+    va_copy(args, argptr);
+    len = vsnprintf(&s->out_buff[s->out_len], sizeof(s->out_buff) - s->out_len, fmt, args);
+    va_end(args);
+    if (len < 0) {
+        return;
+    }
+    if ((size_t)len >= sizeof(s->out_buff) - s->out_len) {
+        if (s->out_len > 0) {                   /* Does not fit behind pending output, write it first */
+            cli_session_flush(s);
+            len = vsnprintf(s->out_buff, sizeof(s->out_buff), fmt, argptr);
+            if (len < 0) {
+                return;
+            }
+        }
+        if ((size_t)len >= sizeof(s->out_buff)) {
+            len = (int)sizeof(s->out_buff) - 1; /* Keep truncated output */
+        }
+    }
+    s->out_len += (size_t)len;
+}
+
+/**
+ * \brief           Write collected output of CLI session
+ * \param[in]       s: CLI session
+ */
+void
+cli_session_flush(cli_session_t* s) {
+    if (s->out_write != NULL && s->out_len > 0) {
+        s->out_write(s->out_arg, s->out_buff, s->out_len);
+    }
+    s->out_len = 0;
+}
+
+#endif /* CLI_OUT_BUFF_SIZE > 0 || __DOXYGEN__ */
+
+/**
+ * \brief           parse new characters to the CLI
+ * \note            Uses single default session, use \ref cli_session_in_data for multiple sessions
+ * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       ch: new character to CLI
+ */
+void
+cli_in_data(cli_printf cliprintf, char ch) {
+    default_session.cliprintf = cliprintf;
+    cli_session_in_data(&default_session, ch);
+}
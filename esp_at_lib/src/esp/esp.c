@@ -34,19 +34,24 @@
 #include "esp/esp_private.h"
 #include "esp/esp_mem.h"
 #include "esp/esp_threads.h"
+#include "esp/esp_timeout.h"
 #include "system/esp_ll.h"
 
-/* Check for configuration */
-#if ESP_CFG_OS != 1
-#error ESP_CFG_OS must be set to 1 in current revision!
-#endif /* ESP_CFG_OS != 1 */
-
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
 //#error ESP_CFG_CONN_MANUAL_TCP_RECEIVE must be set to 0 in current revision!
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
 
 static espr_t           def_callback(esp_evt_t* evt);
 static esp_evt_func_t   def_evt_link;
+#if ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT
+static void             init_reset_fn(espr_t res, void* arg);
+#define INIT_RESET_FN   init_reset_fn
+#else /* ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT */
+#define INIT_RESET_FN   NULL
+#endif /* !(ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT) */
+#if ESP_CFG_TELEMETRY_INTERVAL > 0
+static void             telemetry_sample_cb(void* arg);
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 */
 
 esp_t esp;
 
@@ -61,6 +66,22 @@ def_callback(esp_evt_t* evt) {
     return espOK;
 }
 
+#if (ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT) || __DOXYGEN__
+
+/**
+ * \brief           Init reset sequence finished callback
+ * \param[in]       res: Reset sequence result
+ * \param[in]       arg: Custom argument
+ */
+static void
+init_reset_fn(espr_t res, void* arg) {
+    espi_send_cb(ESP_EVT_INIT_FINISH);          /* Stack is ready for use now */
+    ESP_UNUSED(res);
+    ESP_UNUSED(arg);
+}
+
+#endif /* (ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT) || __DOXYGEN__ */
+
 /**
  * \brief           Init and prepare ESP stack for device operation
  * \note            Function must be called from operating system thread context. 
@@ -81,6 +102,7 @@ esp_init(esp_evt_fn evt_func, const uint32_t blocking) {
     esp.status.f.initialized = 0;               /* Clear possible init flag */
 
     def_evt_link.fn = evt_func != NULL ? evt_func : def_callback;
+    def_evt_link.mask = ESP_EVT_MASK_ALL;       /* Default function receives all events */
     esp.evt_func = &def_evt_link;               /* Set callback function */
 
     esp.evt_server = NULL;                      /* Set default server callback function */
@@ -89,23 +111,44 @@ esp_init(esp_evt_fn evt_func, const uint32_t blocking) {
         goto cleanup;
     }
 
+#if ESP_CFG_OS
     if (!esp_sys_sem_create(&esp.sem_sync, 1)) {/* Create sync semaphore between threads */
         ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
             "[CORE] Cannot allocate sync semaphore!\r\n");
         goto cleanup;
     }
+#endif /* ESP_CFG_OS */
 
     /* Create message queues */
-    if (!esp_sys_mbox_create(&esp.mbox_producer, ESP_CFG_THREAD_PRODUCER_MBOX_SIZE)) {  /* Producer */
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    if (!esp_sys_mbox_create(&esp.mbox_producer_lane[ESP_MSG_PRIO_HIGH], ESP_CFG_THREAD_PRODUCER_MBOX_SIZE)
+        || !esp_sys_mbox_create(&esp.mbox_producer_lane[ESP_MSG_PRIO_LOW], ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE)) {
+        ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
+            "[CORE] Cannot allocate producer lane mbox queue!\r\n");
+        goto cleanup;
+    }
+    if (!esp_sys_mbox_create(&esp.mbox_producer, ESP_CFG_THREAD_PRODUCER_MBOX_SIZE + ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE + ESP_CFG_CONN_SEND_QUEUE)) {  /* Producer wake-up tokens */
+#else /* ESP_CFG_THREAD_PRODUCER_PRIO */
+    /* One more entry for connection send queues token, which is written again if other messages fill it */
+    if (!esp_sys_mbox_create(&esp.mbox_producer, ESP_CFG_THREAD_PRODUCER_MBOX_SIZE + ESP_CFG_CONN_SEND_QUEUE)) {  /* Producer */
+#endif /* !ESP_CFG_THREAD_PRODUCER_PRIO */
         ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
             "[CORE] Cannot allocate producer mbox queue!\r\n");
         goto cleanup;
     }
+#if ESP_CFG_OS
     if (!esp_sys_mbox_create(&esp.mbox_process, ESP_CFG_THREAD_PROCESS_MBOX_SIZE)) {  /* Process */
         ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
             "[CORE] Cannot allocate process mbox queue!\r\n");
         goto cleanup;
     }
+#if ESP_CFG_CONN_SEND_QUEUE
+    if (!esp_sys_sem_create(&esp.conn_send_q_sem, 0)) {
+        ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
+            "[CORE] Cannot allocate send queue semaphore!\r\n");
+        goto cleanup;
+    }
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
 
     /* Create threads */
     esp_sys_sem_wait(&esp.sem_sync, 0);         /* Lock semaphore */
@@ -124,26 +167,66 @@ esp_init(esp_evt_fn evt_func, const uint32_t blocking) {
         goto cleanup;
     }
     esp_sys_sem_wait(&esp.sem_sync, 0);         /* Wait semaphore, should be unlocked in produce thread */
+#if ESP_CFG_EVT_DEFERRED
+    if (!esp_sys_sem_create(&esp.evt_sem, 0)) {
+        ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
+            "[CORE] Cannot allocate event semaphore!\r\n");
+        esp_sys_thread_terminate(&esp.thread_produce);  /* Delete produce thread */
+        esp_sys_thread_terminate(&esp.thread_process);  /* Delete process thread */
+        esp_sys_sem_release(&esp.sem_sync);     /* Release semaphore and return */
+        goto cleanup;
+    }
+    if (!esp_sys_thread_create(&esp.thread_evt, "esp_evt", esp_thread_evt, &esp.sem_sync, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+        ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_LVL_SEVERE | ESP_DBG_TYPE_TRACE,
+            "[CORE] Cannot create event thread!\r\n");
+        esp_sys_thread_terminate(&esp.thread_produce);  /* Delete produce thread */
+        esp_sys_thread_terminate(&esp.thread_process);  /* Delete process thread */
+        esp_sys_sem_release(&esp.sem_sync);     /* Release semaphore and return */
+        goto cleanup;
+    }
+    esp_sys_sem_wait(&esp.sem_sync, 0);         /* Wait semaphore, should be unlocked in event thread */
+#endif /* ESP_CFG_EVT_DEFERRED */
     esp_sys_sem_release(&esp.sem_sync);         /* Release semaphore manually */
+#else /* ESP_CFG_OS */
+    esp.poll_state = ESP_POLL_STATE_IDLE;       /* Commands are executed by esp_poll */
+    esp.poll_next = NULL;
+#endif /* !ESP_CFG_OS */
 
     esp_core_lock();
     esp.ll.uart.baudrate = ESP_CFG_AT_PORT_BAUDRATE;/* Set default baudrate value */
-    esp_ll_init(&esp.ll);                       /* Init low-level communication */
+#if ESP_CFG_AT_CAPTURE
+    ESP_MEMSET(&esp.capture_buff, 0x00, sizeof(esp.capture_buff));
+    esp.capture_buff.buff = esp.capture_mem;    /* Use static memory for capture records */
+    esp.capture_buff.size = sizeof(esp.capture_mem);
+    esp.capture_en = 1;                         /* Record everything from the start */
+#endif /* ESP_CFG_AT_CAPTURE */
+    espi_ll_init();                             /* Init low-level communication */
 
 #if !ESP_CFG_INPUT_USE_PROCESS
+#if ESP_CFG_MEM_STATIC
+    ESP_MEMSET(&esp.buff, 0x00, sizeof(esp.buff));
+    esp.buff.buff = esp.rcv_buff_mem;           /* Use static memory for input data */
+    esp.buff.size = sizeof(esp.rcv_buff_mem);
+#else /* ESP_CFG_MEM_STATIC */
     esp_buff_init(&esp.buff, ESP_CFG_RCV_BUFF_SIZE);    /* Init buffer for input data */
+#endif /* !ESP_CFG_MEM_STATIC */
 #endif /* !ESP_CFG_INPUT_USE_PROCESS */
 
     esp.status.f.initialized = 1;               /* We are initialized now */
     esp.status.f.dev_present = 1;               /* We assume device is present at this point */
 
+#if !(ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT)
     espi_send_cb(ESP_EVT_INIT_FINISH);          /* Call user callback function */
+#endif /* !(ESP_CFG_INIT_FINISH_AFTER_RESET && ESP_CFG_RESET_ON_INIT) */
 
     /*
      * Call reset command and call default
      * AT commands to prepare basic setup for device
      */
     espi_conn_init();                           /* Init connection module */
+#if ESP_CFG_TELEMETRY_INTERVAL > 0
+    esp_timeout_add(ESP_CFG_TELEMETRY_INTERVAL, telemetry_sample_cb, NULL);
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 */
 
 #if ESP_CFG_RESTORE_ON_INIT
     if (esp.status.f.dev_present) {             /* In case device exists */
@@ -155,7 +238,7 @@ esp_init(esp_evt_fn evt_func, const uint32_t blocking) {
 #if ESP_CFG_RESET_ON_INIT
     if (esp.status.f.dev_present) {
         esp_core_unlock();
-        res = esp_reset_with_delay(ESP_CFG_RESET_DELAY_DEFAULT, NULL, NULL, blocking);  /* Send reset sequence with delay */
+        res = esp_reset_with_delay(ESP_CFG_RESET_DELAY_DEFAULT, INIT_RESET_FN, NULL, blocking);    /* Send reset sequence with delay */
         esp_core_lock();
     }
 #endif /* ESP_CFG_RESET_ON_INIT */
@@ -169,14 +252,36 @@ cleanup:
         esp_sys_mbox_delete(&esp.mbox_producer);
         esp_sys_mbox_invalid(&esp.mbox_producer);
     }
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    for (size_t i = 0; i < ESP_MSG_PRIO_END; ++i) {
+        if (esp_sys_mbox_isvalid(&esp.mbox_producer_lane[i])) {
+            esp_sys_mbox_delete(&esp.mbox_producer_lane[i]);
+            esp_sys_mbox_invalid(&esp.mbox_producer_lane[i]);
+        }
+    }
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO */
+#if ESP_CFG_OS
     if (esp_sys_mbox_isvalid(&esp.mbox_process)) {
         esp_sys_mbox_delete(&esp.mbox_process);
         esp_sys_mbox_invalid(&esp.mbox_process);
     }
+#if ESP_CFG_CONN_SEND_QUEUE
+    if (esp_sys_sem_isvalid(&esp.conn_send_q_sem)) {
+        esp_sys_sem_delete(&esp.conn_send_q_sem);
+        esp_sys_sem_invalid(&esp.conn_send_q_sem);
+    }
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+#if ESP_CFG_EVT_DEFERRED
+    if (esp_sys_sem_isvalid(&esp.evt_sem)) {
+        esp_sys_sem_delete(&esp.evt_sem);
+        esp_sys_sem_invalid(&esp.evt_sem);
+    }
+#endif /* ESP_CFG_EVT_DEFERRED */
     if (esp_sys_sem_isvalid(&esp.sem_sync)) {
         esp_sys_sem_delete(&esp.sem_sync);
         esp_sys_sem_invalid(&esp.sem_sync);
     }
+#endif /* ESP_CFG_OS */
     return espERRMEM;
 }
 
@@ -289,6 +394,7 @@ esp_set_at_baudrate(uint32_t baud,
  * \param[in]       evt_arg: Custom argument for event callback function
  * \param[in]       blocking: Status whether command should be blocking or not
  * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ * \note            Server can not be enabled when \ref ESP_CFG_SINGLE_CONN is used
  */
 espr_t
 esp_set_server(uint8_t en, esp_port_t port, uint16_t max_conn, uint16_t timeout, esp_evt_fn server_evt_fn,
@@ -296,6 +402,11 @@ esp_set_server(uint8_t en, esp_port_t port, uint16_t max_conn, uint16_t timeout,
     ESP_MSG_VAR_DEFINE(msg);
 
     ESP_ASSERT("port > 0", port > 0);
+#if ESP_CFG_SINGLE_CONN
+    if (en) {
+        return espERR;                          /* Server requires multiple connections on device */
+    }
+#endif /* ESP_CFG_SINGLE_CONN */
 
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
@@ -316,6 +427,11 @@ esp_set_server(uint8_t en, esp_port_t port, uint16_t max_conn, uint16_t timeout,
 
 /**
  * \brief           Update ESP software remotely
+ *
+ * Update stages are reported with \ref ESP_EVT_UPDATE_PROGRESS event.
+ * When \ref ESP_CFG_UPDATE_ASYNC is enabled, command finishes once device starts with update
+ * and final result is reported with \ref ESP_EVT_UPDATE event
+ *
  * \note            ESP must be connected to access point to use this feature
  * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
  * \param[in]       evt_arg: Custom argument for event callback function
@@ -330,7 +446,7 @@ esp_update_sw(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIUPDATE;
 
-    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 180000);
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, ESP_CFG_UPDATE_TIMEOUT);
 }
 
 #endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
@@ -411,6 +527,126 @@ esp_device_set_present(uint8_t present,
     return res;
 }
 
+#if ESP_CFG_CMD_BATCH || __DOXYGEN__
+
+/**
+ * \brief           Open command batch
+ *
+ * All commands started by this thread until \ref esp_cmd_batch_commit
+ * are appended to batch instead of being sent to producing thread one by one.
+ * Blocking parameter of these commands is ignored, they always return immediately.
+ *
+ * \note            Core stays locked until \ref esp_cmd_batch_commit is called.
+ *                  Only command functions may be called while batch is open
+ *
+ * \note            Memory passed to commands (output variables, strings)
+ *                  must stay valid until batch finishes
+ *
+ * \param[in]       batch: Command batch to open
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_cmd_batch_begin(esp_cmd_batch_t* batch) {
+    ESP_ASSERT("batch != NULL", batch != NULL);
+
+    esp_core_lock();
+    if (esp.batch != NULL) {                    /* Nested batches are not supported */
+        esp_core_unlock();
+        return espERR;
+    }
+    ESP_MEMSET(batch, 0x00, sizeof(*batch));
+    esp.batch = batch;
+    return espOK;                               /* Keep core locked until commit */
+}
+
+/**
+ * \brief           Close command batch and send all its commands for execution
+ *
+ * Commands are executed in order. When any command fails,
+ * remaining commands are not executed and finish with the same error
+ *
+ * \param[in]       batch: Command batch opened with \ref esp_cmd_batch_begin
+ * \param[in]       blocking: Status whether command should be blocking or not.
+ *                      When blocking, function waits once for the whole batch
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_cmd_batch_commit(esp_cmd_batch_t* batch, const uint32_t blocking) {
+    ESP_ASSERT("batch != NULL", batch != NULL);
+
+    esp_core_lock();
+    if (esp.batch != batch) {
+        esp_core_unlock();
+        return espERR;
+    }
+    esp.batch = NULL;
+    esp_core_unlock();
+    esp_core_unlock();                          /* Release lock taken in begin */
+
+    if (batch->first == NULL) {                 /* Nothing to execute */
+        return espOK;
+    }
+    return espi_send_batch_to_producer_mbox(batch, blocking);
+}
+
+#endif /* ESP_CFG_CMD_BATCH || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_CANCEL || __DOXYGEN__
+
+/**
+ * \brief           Check if message is identified by cancellation handle
+ * \param[in]       msg: Message to check
+ * \param[in]       handle: Callback argument or connection handle
+ * \return          `1` if message matches, `0` otherwise
+ */
+static uint8_t
+cmd_cancel_match(esp_msg_t* msg, const void* const handle) {
+    return msg->evt_arg == handle
+        || (msg->cmd_def == ESP_CMD_TCPIP_CIPSEND && msg->msg.conn_send.conn == handle);
+}
+
+/**
+ * \brief           Cancel commands started with callback argument
+ *
+ * Commands waiting in queue are not sent to device, they finish with \ref espABORTED result
+ * when producing thread takes them. Data send in progress stops after current segment.
+ * Other commands in progress cannot be aborted and finish normally
+ *
+ * \note            Data send functions have no callback argument, connection handle
+ *                  is used instead to cancel all data sends on connection
+ * \param[in]       evt_arg: Callback argument used when command was started,
+ *                      such as \ref esp_async_t token, or connection handle
+ * \return          \ref espOK when at least one command was cancelled,
+ *                  \ref espINPROG when command is in progress and cannot be cancelled,
+ *                  member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_cmd_cancel(const void* const evt_arg) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("evt_arg != NULL", evt_arg != NULL);
+
+    esp_core_lock();
+    for (esp_msg_t* m = esp.cmd_queued; m != NULL; m = m->queued_next) {
+        if (cmd_cancel_match(m, evt_arg)) {
+            m->cancelled = 1;
+            res = espOK;
+        }
+    }
+    if (esp.msg != NULL && cmd_cancel_match(esp.msg, evt_arg)) {
+        if (esp.msg->cmd_def == ESP_CMD_TCPIP_CIPSEND) {
+            esp.msg->cancelled = 1;             /* Stop before next segment */
+            res = espOK;
+        } else if (res != espOK) {
+            res = espINPROG;
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_CMD_CANCEL || __DOXYGEN__ */
+
 /**
  * \brief           Check if device is present
  * \return          `1` on success, `0` otherwise
@@ -418,9 +654,9 @@ esp_device_set_present(uint8_t present,
 uint8_t
 esp_device_is_present(void) {
     uint8_t res;
-    esp_core_lock();
+    ESP_CORE_READ_LOCK();
     res = esp.status.f.dev_present;
-    esp_core_unlock();
+    ESP_CORE_READ_UNLOCK();
     return res;
 }
 
@@ -433,9 +669,9 @@ esp_device_is_present(void) {
 uint8_t
 esp_device_is_esp8266(void) {
     uint8_t res;
-    esp_core_lock();
+    ESP_CORE_READ_LOCK();
     res = esp.status.f.dev_present && esp.m.device == ESP_DEVICE_ESP8266;
-    esp_core_unlock();
+    ESP_CORE_READ_UNLOCK();
     return res;
 }
 
@@ -450,9 +686,9 @@ esp_device_is_esp8266(void) {
 uint8_t
 esp_device_is_esp32(void) {
     uint8_t res;
-    esp_core_lock();
+    ESP_CORE_READ_LOCK();
     res = esp.status.f.dev_present && esp.m.device == ESP_DEVICE_ESP32;
-    esp_core_unlock();
+    ESP_CORE_READ_UNLOCK();
     return res;
 }
 
@@ -469,6 +705,324 @@ esp_get_current_at_fw_version(esp_sw_version_t* const version) {
     return 1;
 }
 
+/**
+ * \brief           Get AT port traffic counters
+ * \param[out]      stats: Output variable to save counters to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_io_stats_get(esp_io_stats_t* stats) {
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    stats->recv_bytes = esp.recv_total_len;
+    stats->recv_calls = esp.recv_calls;
+    stats->send_bytes = esp.send_total_len;
+    stats->send_calls = esp.send_calls;
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Clear AT port traffic counters
+ */
+void
+esp_io_stats_reset(void) {
+    esp_core_lock();
+    esp.recv_total_len = 0;
+    esp.recv_calls = 0;
+    esp.send_total_len = 0;
+    esp.send_calls = 0;
+    esp_core_unlock();
+}
+
+#if ESP_CFG_CMD_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get number of command types with statistics
+ * \return          Number of command types, valid `cmd` values for \ref esp_cmd_stats_get are below it
+ */
+size_t
+esp_cmd_stats_get_count(void) {
+    return (size_t)ESP_CMD_END;
+}
+
+/**
+ * \brief           Get latency statistics for command type
+ * \param[in]       cmd: Command type number, lower than \ref esp_cmd_stats_get_count
+ * \param[out]      stats: Output variable to save statistics to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_cmd_stats_get(size_t cmd, esp_cmd_stats_t* stats) {
+    ESP_ASSERT("cmd < ESP_CMD_END", cmd < (size_t)ESP_CMD_END);
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &esp.cmd_stats[cmd], sizeof(*stats));
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Clear latency statistics of all commands
+ */
+void
+esp_cmd_stats_reset(void) {
+    esp_core_lock();
+    ESP_MEMSET(esp.cmd_stats, 0x00, sizeof(esp.cmd_stats));
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_CMD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+
+/**
+ * \brief           Add latency sample to data path stage
+ * \note            Core must be locked when calling this function
+ * \param[in]       stage: Data path stage
+ * \param[in]       latency: Time spent in stage in units of milliseconds
+ */
+void
+espi_trace_add(esp_trace_stage_t stage, uint32_t latency) {
+    esp_trace_stats_t* stats = &esp.trace[stage];
+    size_t bucket = 0;
+
+    ++stats->count;
+    if (latency > stats->max) {
+        stats->max = latency;
+    }
+    while (latency > 0 && bucket < ESP_ARRAYSIZE(stats->hist) - 1) {
+        latency >>= 1;
+        ++bucket;
+    }
+    ++stats->hist[bucket];
+}
+
+/**
+ * \brief           Get latency statistics for data path stage
+ * \param[in]       stage: Data path stage
+ * \param[out]      stats: Output variable to save statistics to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_trace_get(esp_trace_stage_t stage, esp_trace_stats_t* stats) {
+    ESP_ASSERT("stage < ESP_TRACE_END", stage < ESP_TRACE_END);
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &esp.trace[stage], sizeof(*stats));
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Clear latency statistics of all data path stages
+ */
+void
+esp_trace_reset(void) {
+    esp_core_lock();
+    ESP_MEMSET(esp.trace, 0x00, sizeof(esp.trace));
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+
+/**
+ * \brief           Mark library thread start or end of waiting
+ *
+ * Time since previous call is added to busy time when wait starts
+ * and to idle time when wait ends.
+ * Statistics of thread are only written by thread itself
+ *
+ * \param[in]       thread: Thread calling the function
+ * \param[in]       wait: Set to `1` before thread blocks, `0` after it wakes up
+ */
+void
+espi_thread_stats_wait(esp_thread_type_t thread, uint8_t wait) {
+    esp_thread_stats_t* stats = &esp.thread_stats[thread];
+    uint32_t now = esp_sys_now();
+
+    if (wait) {
+        stats->busy_time += now - esp.thread_stats_time[thread];
+    } else {
+        stats->idle_time += now - esp.thread_stats_time[thread];
+        ++stats->wakeups;
+    }
+    esp.thread_stats_time[thread] = now;
+}
+
+/**
+ * \brief           Get load and stack statistics of library thread
+ * \param[in]       thread: Library thread
+ * \param[out]      stats: Output variable to save statistics to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_thread_stats_get(esp_thread_type_t thread, esp_thread_stats_t* stats) {
+    ESP_ASSERT("thread < ESP_THREAD_END", thread < ESP_THREAD_END);
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &esp.thread_stats[thread], sizeof(*stats));
+    esp_core_unlock();
+    stats->stack_free = esp_sys_thread_stack_free(thread == ESP_THREAD_PRODUCE ? &esp.thread_produce : &esp.thread_process);
+    return espOK;
+}
+
+/**
+ * \brief           Clear load statistics of library threads
+ * \note            Stack high-water mark is kept by system and cannot be cleared
+ */
+void
+esp_thread_stats_reset(void) {
+    esp_core_lock();
+    ESP_MEMSET(esp.thread_stats, 0x00, sizeof(esp.thread_stats));
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_TELEMETRY_INTERVAL > 0 || __DOXYGEN__
+
+/**
+ * \brief           Periodic device telemetry sampling
+ * \param[in]       arg: Timeout callback custom argument
+ */
+static void
+telemetry_sample_cb(void* arg) {
+    if (esp.status.f.dev_present) {
+        esp_msg_t* msg = ESP_MSG_VAR_MALLOC();
+
+        if (msg != NULL) {
+            ESP_MEMSET(msg, 0x00, sizeof(*msg));
+            msg->cmd_def = ESP_CMD_SYSRAM;
+#if ESP_CFG_MODE_STATION
+            msg->msg.sta_info_ap.info = &esp.telemetry_ap;
+#endif /* ESP_CFG_MODE_STATION */
+            espi_send_msg_to_producer_mbox(msg, espi_initiate_cmd, 1000);   /* Result arrives through response parsing */
+        }
+    }
+    esp_timeout_add(ESP_CFG_TELEMETRY_INTERVAL, telemetry_sample_cb, arg);
+}
+
+/**
+ * \brief           Get last device telemetry sample
+ * \param[out]      telemetry: Output variable to save telemetry to
+ * \return          \ref espOK on success, \ref espERR when no sample was taken yet,
+ *                  member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_telemetry_get(esp_telemetry_t* telemetry) {
+    espr_t res;
+
+    ESP_ASSERT("telemetry != NULL", telemetry != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(telemetry, &esp.telemetry, sizeof(*telemetry));
+    res = esp.telemetry.samples > 0 ? espOK : espERR;
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Clear telemetry statistics
+ *
+ * Lowest free RAM value starts again from next sample
+ */
+void
+esp_telemetry_reset(void) {
+    esp_core_lock();
+    ESP_MEMSET(&esp.telemetry, 0x00, sizeof(esp.telemetry));
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__
+
+/**
+ * \brief           Register handler for received lines too long for internal line buffer
+ *
+ * Once line starting with `prefix` fills the buffer, it is delivered to `fn`
+ * in fragments instead of being truncated and parsed.
+ *
+ * \param[in]       prefix: Line prefix, such as `+CWLAP`. Memory must stay valid while registered
+ * \param[in]       fn: Callback function to receive line fragments
+ * \param[in]       arg: Custom user argument passed to callback
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_recv_line_register(const char* prefix, esp_recv_line_fn fn, void* arg) {
+    espr_t res = espERRMEM;
+
+    ESP_ASSERT("prefix != NULL", prefix != NULL);
+    ESP_ASSERT("fn != NULL", fn != NULL);
+
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_CFG_RECV_LINE_HANDLERS; ++i) {
+        esp_recv_line_handler_t* h = &esp.recv_line_handlers[i];
+        if (h->fn == NULL) {
+            h->prefix = prefix;
+            h->prefix_len = strlen(prefix);
+            h->arg = arg;
+            h->fn = fn;
+            res = espOK;
+            break;
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Unregister handler for oversized received lines
+ * \param[in]       fn: Callback function previously registered with \ref esp_recv_line_register
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_recv_line_unregister(esp_recv_line_fn fn) {
+    espr_t res = espERR;
+
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_CFG_RECV_LINE_HANDLERS; ++i) {
+        esp_recv_line_handler_t* h = &esp.recv_line_handlers[i];
+        if (h->fn == fn) {
+            if (esp.recv_line_stream == h) {
+                esp.recv_line_stream = NULL;    /* Rest of current line is dropped */
+            }
+            h->fn = NULL;
+            res = espOK;
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__
+
+/**
+ * \brief           Set allocation policy for packet buffers of received network data
+ * \note            Function is called from processing thread with core locked
+ * \param[in]       fn: Policy function. Set to `NULL` to use default policy
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ * \sa              ESP_CFG_IPD_ALLOC_POLICY
+ */
+espr_t
+esp_set_ipd_alloc_fn(esp_ipd_alloc_fn fn) {
+    esp_core_lock();
+    esp.ipd_alloc_fn = fn;
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__ */
+
 /**
  * \brief           Delay for amount of milliseconds
  *
@@ -476,15 +1030,22 @@ esp_get_current_at_fw_version(esp_sw_version_t* const version) {
  * It locks semaphore and waits for timeout in `ms` time.
  * Based on operating system, thread may be put to \e blocked list during delay and may improve execution speed
  *
+ * \note            When \ref ESP_CFG_OS is disabled, function waits in busy loop using \ref esp_sys_now
+ *
  * \param[in]       ms: Milliseconds to delay
  * \return          `1` on success, `0` otherwise
  */
 uint8_t
 esp_delay(const uint32_t ms) {
+#if ESP_CFG_OS
     esp_sys_sem_t sem;
+#else /* ESP_CFG_OS */
+    uint32_t start;
+#endif /* !ESP_CFG_OS */
     if (ms == 0) {
         return 1;
     }
+#if ESP_CFG_OS
     if (esp_sys_sem_create(&sem, 0)) {
         esp_sys_sem_wait(&sem, ms);
         esp_sys_sem_release(&sem);
@@ -492,4 +1053,9 @@ esp_delay(const uint32_t ms) {
         return 1;
     }
     return 0;
+#else /* ESP_CFG_OS */
+    start = esp_sys_now();
+    while ((uint32_t)(esp_sys_now() - start) < ms) {}
+    return 1;
+#endif /* !ESP_CFG_OS */
 }
@@ -52,6 +52,27 @@ esp_ap_getip(esp_ip_t* ip, esp_ip_t* gw, esp_ip_t* nm,
                 const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
     ESP_MSG_VAR_DEFINE(msg);
 
+#if ESP_CFG_GETTER_CACHE
+    esp_core_lock();
+    if (esp.m.cache_valid & ESP_CACHE_AP_IP) {
+        if (ip != NULL) {
+            ESP_MEMCPY(ip, &esp.m.ap.ip, sizeof(*ip));
+        }
+        if (gw != NULL) {
+            ESP_MEMCPY(gw, &esp.m.ap.gw, sizeof(*gw));
+        }
+        if (nm != NULL) {
+            ESP_MEMCPY(nm, &esp.m.ap.nm, sizeof(*nm));
+        }
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_GETTER_CACHE */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CIPAP_GET;
@@ -105,6 +126,21 @@ esp_ap_getmac(esp_mac_t* mac,
                 const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
     ESP_MSG_VAR_DEFINE(msg);
 
+#if ESP_CFG_GETTER_CACHE
+    esp_core_lock();
+    if (esp.m.cache_valid & ESP_CACHE_AP_MAC) {
+        if (mac != NULL) {
+            ESP_MEMCPY(mac, &esp.m.ap.mac, sizeof(*mac));
+        }
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_GETTER_CACHE */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CIPAPMAC_GET;
@@ -182,8 +218,77 @@ esp_ap_configure(const char* ssid, const char* pwd, uint8_t ch, esp_ecn_t ecn, u
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
 }
 
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Find station in local table
+ * \param[in]       mac: MAC address of station
+ * \return          Table entry, `NULL` if not found
+ */
+static esp_sta_t*
+ap_sta_cache_find(const esp_mac_t* mac) {
+    for (size_t i = 0; i < esp.m.ap_stas_cnt; ++i) {
+        if (!memcmp(&esp.m.ap_stas[i].mac, mac, sizeof(*mac))) {
+            return &esp.m.ap_stas[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Add station to local table or update its IP address
+ *
+ * When table is full, it does not hold all stations anymore
+ * and \ref esp_ap_list_sta uses AT command until table is filled again
+ *
+ * \note            Core must be locked before calling this function
+ * \param[in]       mac: MAC address of station
+ * \param[in]       ip: IP address of station, `NULL` if not known yet
+ */
+void
+espi_ap_sta_cache_set(const esp_mac_t* mac, const esp_ip_t* ip) {
+    esp_sta_t* sta = ap_sta_cache_find(mac);
+
+    if (sta == NULL) {
+        if (esp.m.ap_stas_cnt >= ESP_ARRAYSIZE(esp.m.ap_stas)) {
+            esp.m.ap_stas_overflow = 1;
+            esp.m.ap_stas_valid = 0;
+            return;
+        }
+        sta = &esp.m.ap_stas[esp.m.ap_stas_cnt++];
+        ESP_MEMSET(sta, 0x00, sizeof(*sta));
+        ESP_MEMCPY(&sta->mac, mac, sizeof(sta->mac));
+    }
+    if (ip != NULL) {
+        ESP_MEMCPY(&sta->ip, ip, sizeof(sta->ip));
+    }
+}
+
+/**
+ * \brief           Remove disconnected station from local table
+ * \note            Core must be locked before calling this function
+ * \param[in]       mac: MAC address of station
+ */
+void
+espi_ap_sta_cache_remove(const esp_mac_t* mac) {
+    esp_sta_t* sta = ap_sta_cache_find(mac);
+
+    if (sta != NULL) {
+        *sta = esp.m.ap_stas[--esp.m.ap_stas_cnt];  /* Move last entry to free place */
+    }
+}
+
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_AP_LIST_STA || __DOXYGEN__
+
 /**
  * \brief           List stations connected to access point
+ *
+ * With \ref ESP_CFG_AP_STA_CACHE_SIZE enabled, stations are listed from local table
+ * without AT command once table was filled. Station which did not get IP address yet
+ * is listed with all zeros IP address
+ *
  * \param[in]       sta: Pointer to array of \ref esp_sta_t structure to fill with stations
  * \param[in]       stal: Number of array entries of sta parameter
  * \param[out]      staf: Number of stations connected to access point
@@ -204,6 +309,24 @@ esp_ap_list_sta(esp_sta_t* sta, size_t stal, size_t* staf,
         *staf = 0;
     }
 
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0
+    esp_core_lock();
+    if (esp.m.ap_stas_valid) {                  /* List from table without AT command */
+        size_t cnt = ESP_MIN(stal, esp.m.ap_stas_cnt);
+
+        ESP_MEMCPY(sta, esp.m.ap_stas, cnt * sizeof(*sta));
+        if (staf != NULL) {
+            *staf = cnt;
+        }
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CWLIF;
@@ -214,6 +337,8 @@ esp_ap_list_sta(esp_sta_t* sta, size_t stal, size_t* staf,
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 1000);
 }
 
+#endif /* ESP_CFG_AP_LIST_STA || __DOXYGEN__ */
+
 /**
  * \brief           Disconnects connected station from SoftAP access point
  * \param[in]       mac: Device MAC address to disconnect.
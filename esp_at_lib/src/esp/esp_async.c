@@ -0,0 +1,122 @@
+/**
+ * \file            esp_async.c
+ * \brief           Completion tokens for asynchronous API calls
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_async.h"
+
+#if ESP_CFG_ASYNC || __DOXYGEN__
+
+/**
+ * \brief           Initialize token and set optional completion function
+ * \param[in]       tok: Token to initialize
+ * \param[in]       fn: Function called when command has finished, for example to resume a coroutine.
+ *                      Set to `NULL` when token is only polled
+ * \param[in]       arg: Custom argument for completion function
+ */
+void
+esp_async_init(esp_async_t* tok, esp_api_cmd_evt_fn fn, void* arg) {
+    tok->fn = fn;
+    tok->arg = arg;
+    tok->res = espINPROG;
+    tok->done = 0;
+}
+
+/**
+ * \brief           Prepare token for new command
+ * \note            Used by \ref ESP_ASYNC macro, completion function is kept
+ * \param[in]       tok: Token to prepare
+ * \return          Token as callback argument
+ */
+void*
+esp_async_start(esp_async_t* tok) {
+    tok->res = espINPROG;
+    tok->done = 0;
+    return tok;
+}
+
+/**
+ * \brief           API callback function, which completes the token
+ * \note            Called from processing thread when command has finished
+ * \param[in]       res: Command result
+ * \param[in]       arg: Token as passed by \ref ESP_ASYNC macro
+ */
+void
+esp_async_evt_fn(espr_t res, void* arg) {
+    esp_async_t* tok = arg;
+
+    tok->res = res;
+    tok->done = 1;                              /* Set after result so reader sees valid result */
+    if (tok->fn != NULL) {
+        tok->fn(res, tok->arg);
+    }
+}
+
+/**
+ * \brief           Process immediate return value of API function
+ *
+ * When command could not be started, callback is never called.
+ * In this case token is completed with returned error.
+ *
+ * \param[in]       tok: Token passed to API function
+ * \param[in]       res: Value returned by API function
+ * \return          Value returned by API function
+ */
+espr_t
+esp_async_submit(esp_async_t* tok, espr_t res) {
+    if (res != espOK) {
+        esp_async_evt_fn(res, tok);
+    }
+    return res;
+}
+
+/**
+ * \brief           Check if command has finished
+ * \param[in]       tok: Token to check
+ * \return          `1` when finished, `0` otherwise
+ */
+uint8_t
+esp_async_is_done(const esp_async_t* tok) {
+    return tok->done;
+}
+
+/**
+ * \brief           Get command result
+ * \param[in]       tok: Token to read
+ * \return          Command result when finished, \ref espINPROG otherwise
+ */
+espr_t
+esp_async_get_result(const esp_async_t* tok) {
+    return tok->done ? tok->res : espINPROG;
+}
+
+#endif /* ESP_CFG_ASYNC || __DOXYGEN__ */
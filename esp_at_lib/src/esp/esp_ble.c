@@ -0,0 +1,157 @@
+/**
+ * \file            esp_ble.c
+ * \brief           BLE data channel of ESP32 AT firmware
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_ble.h"
+#include "esp/esp_mem.h"
+
+#if ESP_CFG_BLE || __DOXYGEN__
+
+/**
+ * \brief           Initialize BLE as GATT server and start advertising
+ * \note            Name must stay valid until command finishes
+ * \param[in]       name: BLE device name. Set to `NULL` to keep device default
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ble_start(const char* name,
+                const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_BLEADVSTART;
+    ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_BLEINIT;    /* Initialize and create services first */
+    ESP_MSG_VAR_REF(msg).msg.ble.en = 1;
+    ESP_MSG_VAR_REF(msg).msg.ble.name = name;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
+}
+
+/**
+ * \brief           Deinitialize BLE, connected clients are disconnected
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ble_stop(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_BLEINIT;
+    ESP_MSG_VAR_REF(msg).msg.ble.en = 0;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 5000);
+}
+
+/**
+ * \brief           Start advertising again, after client disconnected
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ble_adv_start(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_BLEADVSTART;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 1000);
+}
+
+/**
+ * \brief           Send data to connected BLE client
+ *
+ * Data are sent as notifications of \ref ESP_CFG_BLE_NTFY_CHAR_INDEX characteristic,
+ * split to parts of maximal \ref ESP_CFG_BLE_NTFY_LEN bytes.
+ * Client must enable notifications before
+ *
+ * \note            Data must stay valid until command finishes
+ * \param[in]       conn: BLE connection index of client
+ * \param[in]       data: Data to send
+ * \param[in]       len: Length of data in units of bytes
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ble_send(uint8_t conn, const void* data, size_t len,
+                const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("data != NULL", data != NULL);
+    ESP_ASSERT("len > 0", len > 0);
+
+    if (!esp_ble_is_connected(conn)) {
+        return espCLOSED;
+    }
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_BLEGATTSNTFY;
+    ESP_MSG_VAR_REF(msg).msg.ble.conn = conn;
+    ESP_MSG_VAR_REF(msg).msg.ble.data = data;
+    ESP_MSG_VAR_REF(msg).msg.ble.len = len;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
+}
+
+/**
+ * \brief           Check if BLE client is connected
+ * \param[in]       conn: BLE connection index
+ * \return          `1` when connected, `0` otherwise
+ */
+uint8_t
+esp_ble_is_connected(uint8_t conn) {
+    uint8_t res;
+
+    if (conn >= sizeof(esp.m.ble_conns) * 8) {
+        return 0;
+    }
+    esp_core_lock();
+    res = ESP_U8((esp.m.ble_conns & (1U << conn)) != 0);
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
@@ -47,6 +47,41 @@
 #define BUF_MIN(x, y)                   ((x) < (y) ? (x) : (y))
 #define BUF_MAX(x, y)                   ((x) > (y) ? (x) : (y))
 
+#if ESP_CFG_BUFF_SPSC
+#define BUF_BARRIER()                   ESP_CFG_BUFF_MEMORY_BARRIER()
+#else /* ESP_CFG_BUFF_SPSC */
+#define BUF_BARRIER()
+#endif /* !ESP_CFG_BUFF_SPSC */
+
+/**
+ * \brief           Load read or write pointer (acquire)
+ *
+ * Barrier after load guarantees data are not accessed before pointer is read
+ *
+ * \param[in]       ptr: Pointer to read or write pointer variable
+ * \return          Pointer value
+ */
+static size_t
+buf_load(const size_t* ptr) {
+    size_t val = *(const volatile size_t *)ptr;
+    BUF_BARRIER();
+    return val;
+}
+
+/**
+ * \brief           Store read or write pointer (release)
+ *
+ * Barrier before store guarantees data are copied before other side sees new pointer
+ *
+ * \param[in]       ptr: Pointer to read or write pointer variable
+ * \param[in]       val: New pointer value
+ */
+static void
+buf_store(size_t* ptr, size_t val) {
+    BUF_BARRIER();
+    *(volatile size_t *)ptr = val;
+}
+
 /**
  * \brief           Initialize buffer
  * \param[in]       buff: Pointer to buffer structure
@@ -92,7 +127,7 @@ BUF_PREF(buff_free)(BUF_PREF(buff_t)* buff) {
  */
 size_t
 BUF_PREF(buff_write)(BUF_PREF(buff_t)* buff, const void* data, size_t btw) {
-    size_t tocopy, free;
+    size_t tocopy, free, w;
     const uint8_t* d = data;
 
     if (!BUF_IS_VALID(buff) || btw == 0) {
@@ -105,22 +140,24 @@ BUF_PREF(buff_write)(BUF_PREF(buff_t)* buff, const void* data, size_t btw) {
     if (btw == 0) {
         return 0;
     }
+    w = buff->w;                                /* Write pointer is owned by writer */
 
     /* Step 1: Write data to linear part of buffer */
-    tocopy = BUF_MIN(buff->size - buff->w, btw);
-    BUF_MEMCPY(&buff->buff[buff->w], d, tocopy);
-    buff->w += tocopy;
+    tocopy = BUF_MIN(buff->size - w, btw);
+    BUF_MEMCPY(&buff->buff[w], d, tocopy);
+    w += tocopy;
     btw -= tocopy;
 
     /* Step 2: Write data to beginning of buffer (overflow part) */
     if (btw > 0) {
         BUF_MEMCPY(buff->buff, (void *)&d[tocopy], btw);
-        buff->w = btw;
+        w = btw;
     }
 
-    if (buff->w >= buff->size) {
-        buff->w = 0;
+    if (w >= buff->size) {
+        w = 0;
     }
+    buf_store(&buff->w, w);                     /* Publish all data with single update */
     return tocopy + btw;
 }
 
@@ -134,7 +171,7 @@ BUF_PREF(buff_write)(BUF_PREF(buff_t)* buff, const void* data, size_t btw) {
  */
 size_t
 BUF_PREF(buff_read)(BUF_PREF(buff_t)* buff, void* data, size_t btr) {
-    size_t tocopy, full;
+    size_t tocopy, full, r;
     uint8_t *d = data;
 
     if (!BUF_IS_VALID(buff) || btr == 0) {
@@ -147,23 +184,25 @@ BUF_PREF(buff_read)(BUF_PREF(buff_t)* buff, void* data, size_t btr) {
     if (btr == 0) {
         return 0;
     }
+    r = buff->r;                                /* Read pointer is owned by reader */
 
     /* Step 1: Read data from linear part of buffer */
-    tocopy = BUF_MIN(buff->size - buff->r, btr);
-    BUF_MEMCPY(d, &buff->buff[buff->r], tocopy);
-    buff->r += tocopy;
+    tocopy = BUF_MIN(buff->size - r, btr);
+    BUF_MEMCPY(d, &buff->buff[r], tocopy);
+    r += tocopy;
     btr -= tocopy;
 
     /* Step 2: Read data from beginning of buffer (overflow part) */
     if (btr > 0) {
         BUF_MEMCPY(&d[tocopy], buff->buff, btr);
-        buff->r = btr;
+        r = btr;
     }
 
     /* Step 3: Check end of buffer */
-    if (buff->r >= buff->size) {
-        buff->r = 0;
+    if (r >= buff->size) {
+        r = 0;
     }
+    buf_store(&buff->r, r);                     /* Release memory with single update */
     return tocopy + btr;
 }
 
@@ -231,8 +270,8 @@ BUF_PREF(buff_get_free)(BUF_PREF(buff_t)* buff) {
     }
 
     /* Use temporary values in case they are changed during operations */
-    w = buff->w;
-    r = buff->r;
+    w = buf_load(&buff->w);
+    r = buf_load(&buff->r);
     if (w == r) {
         size = buff->size;
     } else if (r > w) {
@@ -259,8 +298,8 @@ BUF_PREF(buff_get_full)(BUF_PREF(buff_t)* buff) {
     }
 
     /* Use temporary values in case they are changed during operations */
-    w = buff->w;
-    r = buff->r;
+    w = buf_load(&buff->w);
+    r = buf_load(&buff->r);
     if (w == r) {
         size = 0;
     } else if (w > r) {
@@ -310,8 +349,8 @@ BUF_PREF(buff_get_linear_block_read_length)(BUF_PREF(buff_t)* buff) {
     }
 
     /* Use temporary values in case they are changed during operations */
-    w = buff->w;
-    r = buff->r;
+    w = buf_load(&buff->w);
+    r = buf_load(&buff->r);
     if (w > r) {
         len = w - r;
     } else if (r > w) {
@@ -322,6 +361,48 @@ BUF_PREF(buff_get_linear_block_read_length)(BUF_PREF(buff_t)* buff) {
     return len;
 }
 
+/**
+ * \brief           Get all readable data as up to `2` contiguous blocks
+ *
+ * First block starts at read pointer, second block (if data wraps) starts at buffer beginning.
+ * Data can be consumed in parts with \ref esp_buff_skip while blocks are processed,
+ * giving memory back to writer before entire peeked length is processed
+ *
+ * \param[in]       buff: Buffer handle
+ * \param[out]      blocks: Array of `2` blocks to fill. Unused block has length set to `0`
+ * \return          Total number of bytes in both blocks
+ */
+size_t
+BUF_PREF(buff_get_read_blocks)(BUF_PREF(buff_t)* buff, BUF_PREF(buff_block_t)* blocks) {
+    size_t w, r;
+
+    if (blocks == NULL) {
+        return 0;
+    }
+    blocks[0].data = blocks[1].data = NULL;
+    blocks[0].len = blocks[1].len = 0;
+    if (!BUF_IS_VALID(buff)) {
+        return 0;
+    }
+
+    /* Use temporary values in case they are changed during operations */
+    w = buf_load(&buff->w);
+    r = buf_load(&buff->r);
+    if (w > r) {
+        blocks[0].len = w - r;
+    } else if (r > w) {
+        blocks[0].len = buff->size - r;
+        if (w > 0) {
+            blocks[1].data = &buff->buff[0];
+            blocks[1].len = w;
+        }
+    }
+    if (blocks[0].len > 0) {
+        blocks[0].data = &buff->buff[r];
+    }
+    return blocks[0].len + blocks[1].len;
+}
+
 /**
  * \brief           Skip (ignore; advance read pointer) buffer data
  *                  Marks data as read in the buffer and increases free memory for up to `len` bytes
@@ -332,17 +413,18 @@ BUF_PREF(buff_get_linear_block_read_length)(BUF_PREF(buff_t)* buff) {
  */
 size_t
 BUF_PREF(buff_skip)(BUF_PREF(buff_t)* buff, size_t len) {
-    size_t full;
+    size_t full, r;
 
     if (!BUF_IS_VALID(buff) || len == 0) {
         return 0;
     }
 
     full = BUF_PREF(buff_get_full)(buff);       /* Get buffer used length */
-    buff->r += BUF_MIN(len, full);              /* Advance read pointer */
-    if (buff->r >= buff->size) {                /* Subtract possible overflow */
-        buff->r -= buff->size;
+    r = buff->r + BUF_MIN(len, full);           /* Advance read pointer */
+    if (r >= buff->size) {                      /* Subtract possible overflow */
+        r -= buff->size;
     }
+    buf_store(&buff->r, r);
     return len;
 }
 
@@ -373,8 +455,8 @@ BUF_PREF(buff_get_linear_block_write_length)(BUF_PREF(buff_t)* buff) {
     }
 
     /* Use temporary values in case they are changed during operations */
-    w = buff->w;
-    r = buff->r;
+    w = buf_load(&buff->w);
+    r = buf_load(&buff->r);
     if (w >= r) {
         len = buff->size - w;
         /*
@@ -407,16 +489,70 @@ BUF_PREF(buff_get_linear_block_write_length)(BUF_PREF(buff_t)* buff) {
  */
 size_t
 BUF_PREF(buff_advance)(BUF_PREF(buff_t)* buff, size_t len) {
-    size_t free;
+    size_t free, w;
 
     if (!BUF_IS_VALID(buff) || len == 0) {
         return 0;
     }
 
     free = BUF_PREF(buff_get_free)(buff);       /* Get buffer free length */
-    buff->w += BUF_MIN(len, free);              /* Advance write pointer */
-    if (buff->w >= buff->size) {                /* Subtract possible overflow */
-        buff->w -= buff->size;
+    w = buff->w + BUF_MIN(len, free);           /* Advance write pointer */
+    if (w >= buff->size) {                      /* Subtract possible overflow */
+        w -= buff->size;
+    }
+    buf_store(&buff->w, w);
+    return len;
+}
+
+/**
+ * \brief           Reserve linear block of memory for batch write
+ *
+ * Writer (for example DMA interrupt) fills returned memory and publishes
+ * all bytes at once with \ref esp_buff_write_commit
+ *
+ * \param[in]       buff: Buffer handle
+ * \param[in,out]   len: Input: requested number of bytes. Set to `0` for maximal available length.
+ *                      Output: number of bytes available at returned address
+ * \return          Address of reserved memory or `NULL` if buffer is full
+ */
+void *
+BUF_PREF(buff_write_reserve)(BUF_PREF(buff_t)* buff, size_t* len) {
+    size_t avail;
+
+    if (!BUF_IS_VALID(buff) || len == NULL) {
+        return NULL;
+    }
+
+    avail = BUF_PREF(buff_get_linear_block_write_length)(buff);
+    if (*len == 0 || *len > avail) {
+        *len = avail;
+    }
+    if (*len == 0) {
+        return NULL;
+    }
+    return &buff->buff[buff->w];
+}
+
+/**
+ * \brief           Commit data written to memory returned by \ref esp_buff_write_reserve
+ * \note            Write pointer is updated only once, making all data visible to reader at the same time
+ * \param[in]       buff: Buffer handle
+ * \param[in]       len: Number of bytes written to reserved memory
+ * \return          Number of bytes committed
+ */
+size_t
+BUF_PREF(buff_write_commit)(BUF_PREF(buff_t)* buff, size_t len) {
+    size_t w;
+
+    if (!BUF_IS_VALID(buff) || len == 0) {
+        return 0;
+    }
+
+    len = BUF_MIN(len, BUF_PREF(buff_get_linear_block_write_length)(buff));
+    w = buff->w + len;
+    if (w >= buff->size) {
+        w = 0;
     }
+    buf_store(&buff->w, w);
     return len;
 }
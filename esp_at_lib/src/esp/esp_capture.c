@@ -0,0 +1,197 @@
+/**
+ * \file            esp_capture.c
+ * \brief           AT stream capture
+ */
+
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_capture.h"
+
+#if ESP_CFG_AT_CAPTURE || __DOXYGEN__
+
+static esp_ll_send_fn capture_ll_send_fn;       /*!< Send function of low-level layer */
+
+/**
+ * \brief           Remove oldest record from capture buffer
+ * \note            Core must be locked when calling this function
+ */
+static void
+capture_drop_oldest(void) {
+    uint8_t hdr[ESP_CAPTURE_HDR_LEN];
+
+    if (esp_buff_peek(&esp.capture_buff, 0, hdr, sizeof(hdr)) == sizeof(hdr)) {
+        esp_buff_skip(&esp.capture_buff, sizeof(hdr) + (size_t)(hdr[4] | (hdr[5] << 8)));
+        ++esp.capture_lost;
+    }
+}
+
+/**
+ * \brief           Write data to capture buffer as one or more records
+ * \param[in]       dir: Direction of data, \ref ESP_CAPTURE_DIR_RX or \ref ESP_CAPTURE_DIR_TX
+ * \param[in]       data: Data exchanged with device
+ * \param[in]       len: Length of data in units of bytes
+ */
+void
+espi_capture_write(uint8_t dir, const void* data, size_t len) {
+    const uint8_t* d = data;
+    uint8_t hdr[ESP_CAPTURE_HDR_LEN];
+    uint32_t now;
+    size_t chunk;
+
+    esp_core_lock();
+    if (esp.capture_en && d != NULL) {
+        now = esp_sys_now();
+        while (len > 0) {
+            chunk = ESP_MIN(len, ESP_CAPTURE_REC_MAX_LEN);
+            while (esp_buff_get_free(&esp.capture_buff) < sizeof(hdr) + chunk) {
+                capture_drop_oldest();
+            }
+            hdr[0] = ESP_U8(now);
+            hdr[1] = ESP_U8(now >> 8);
+            hdr[2] = ESP_U8(now >> 16);
+            hdr[3] = ESP_U8(now >> 24);
+            hdr[4] = ESP_U8(chunk);
+            hdr[5] = ESP_U8(chunk >> 8);
+            hdr[6] = dir;
+            hdr[7] = 0;
+            esp_buff_write(&esp.capture_buff, hdr, sizeof(hdr));
+            esp_buff_write(&esp.capture_buff, d, chunk);
+            d += chunk;
+            len -= chunk;
+        }
+    }
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Send function installed to low-level layer to record sent data
+ * \param[in]       data: Data to send, `NULL` to flush
+ * \param[in]       len: Length of data in units of bytes
+ * \return          Number of bytes sent by low-level layer
+ */
+static size_t
+capture_send(const void* data, size_t len) {
+    size_t sent;
+
+    sent = capture_ll_send_fn(data, len);
+    if (data != NULL && sent > 0) {
+        espi_capture_write(ESP_CAPTURE_DIR_TX, data, sent);
+    }
+    return sent;
+}
+
+/**
+ * \brief           Install capture between stack and low-level send function
+ * \note            Must be called after every \ref esp_ll_init call, which may set send function
+ * \param[in,out]   ll: Low-level structure filled by \ref esp_ll_init
+ */
+void
+espi_capture_ll_hook(esp_ll_t* ll) {
+    if (ll->send_fn != NULL && ll->send_fn != capture_send) {
+        capture_ll_send_fn = ll->send_fn;
+        ll->send_fn = capture_send;
+    }
+}
+
+/**
+ * \brief           Start or stop writing new records
+ *
+ * Capture is enabled after \ref esp_init.
+ * Disable it to freeze buffer content after problem has been detected
+ *
+ * \param[in]       en: Set to `1` to enable capture, `0` to stop it
+ */
+void
+esp_capture_enable(uint8_t en) {
+    esp_core_lock();
+    esp.capture_en = ESP_U8(!!en);
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Read oldest records from capture buffer
+ *
+ * Only complete records are read and removed from buffer.
+ * Use output buffer of at least \ref ESP_CAPTURE_HDR_LEN + \ref ESP_CAPTURE_REC_MAX_LEN bytes
+ * to always read at least one record
+ *
+ * \param[out]      data: Output buffer to write records to
+ * \param[in]       len: Length of output buffer in units of bytes
+ * \return          Number of bytes written to output buffer
+ */
+size_t
+esp_capture_read(void* data, size_t len) {
+    uint8_t* d = data;
+    uint8_t hdr[ESP_CAPTURE_HDR_LEN];
+    size_t rec_len, read = 0;
+
+    if (data == NULL) {
+        return 0;
+    }
+
+    esp_core_lock();
+    while (esp_buff_peek(&esp.capture_buff, 0, hdr, sizeof(hdr)) == sizeof(hdr)) {
+        rec_len = sizeof(hdr) + (size_t)(hdr[4] | (hdr[5] << 8));
+        if (read + rec_len > len) {
+            break;
+        }
+        read += esp_buff_read(&esp.capture_buff, &d[read], rec_len);
+    }
+    esp_core_unlock();
+    return read;
+}
+
+/**
+ * \brief           Remove all records from capture buffer and clear lost record counter
+ */
+void
+esp_capture_clear(void) {
+    esp_core_lock();
+    esp_buff_reset(&esp.capture_buff);
+    esp.capture_lost = 0;
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Get number of oldest records overwritten because buffer was full
+ * \return          Number of lost records since \ref esp_init or \ref esp_capture_clear
+ */
+uint32_t
+esp_capture_get_lost(void) {
+    uint32_t lost;
+
+    esp_core_lock();
+    lost = esp.capture_lost;
+    esp_core_unlock();
+    return lost;
+}
+
+#endif /* ESP_CFG_AT_CAPTURE || __DOXYGEN__ */
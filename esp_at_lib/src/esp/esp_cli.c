@@ -33,6 +33,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "esp/esp.h"
+#include "esp/esp_mem.h"
+#include "esp/esp_timeout.h"
 #if ESP_CFG_MODE_STATION
 #include "esp/esp_sta.h"
 #endif /* ESP_CFG_MODE_STATION */
@@ -42,12 +44,38 @@
 #if ESP_CFG_MODE_STATION
 static void cli_station_info(cli_printf cliprintf, int argc, char** argv);
 #endif /* ESP_CFG_MODE_STATION */
+static void cli_stats(cli_printf cliprintf, int argc, char** argv);
+#if ESP_CFG_CMD_STATS
+static void cli_cmd_stats(cli_printf cliprintf, int argc, char** argv);
+#endif /* ESP_CFG_CMD_STATS */
+#if ESP_CFG_LATENCY_TRACE
+static void cli_trace(cli_printf cliprintf, int argc, char** argv);
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_THREAD_STATS
+static void cli_threads(cli_printf cliprintf, int argc, char** argv);
+#endif /* ESP_CFG_THREAD_STATS */
+#if ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM
+static void cli_mem_profile(cli_printf cliprintf, int argc, char** argv);
+#endif /* ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM */
 
 static const cli_command_t
 commands[] = {
 #if ESP_CFG_MODE_STATION
     { "station-info",       "Get current station info",                 cli_station_info },
 #endif /* ESP_CFG_MODE_STATION */
+    { "stats",              "Print library counters, \"io\", \"rx\", \"conn\", \"cmd\", \"mem\" or \"timeout\" to select, \"reset\" to clear", cli_stats },
+#if ESP_CFG_CMD_STATS
+    { "cmd-stats",          "Print command latency histograms, \"reset\" to clear", cli_cmd_stats },
+#endif /* ESP_CFG_CMD_STATS */
+#if ESP_CFG_LATENCY_TRACE
+    { "trace",              "Print data path latency histograms, \"reset\" to clear", cli_trace },
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_THREAD_STATS
+    { "threads",            "Print library thread load and free stack, \"reset\" to clear", cli_threads },
+#endif /* ESP_CFG_THREAD_STATS */
+#if ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM
+    { "mem-profile",        "Print top allocators, \"bytes\" or \"live\" to sort, \"reset\" to clear", cli_mem_profile },
+#endif /* ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM */
 
 };
 
@@ -88,3 +116,283 @@ cli_station_info(cli_printf cliprintf, int argc, char** argv) {
 }
 
 #endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+
+/**
+ * \brief           CLI command for printing and clearing library counters
+ *
+ * Without arguments all available groups are printed,
+ * optional group name selects single group and `reset` clears selected groups
+ *
+ * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       argc: Number fo arguments in argv
+ * \param[in]       argv: Pointer to the commands arguments
+ */
+static void
+cli_stats(cli_printf cliprintf, int argc, char** argv) {
+    static const char* const groups[] = { "io", "rx", "conn", "cmd", "mem", "timeout" };
+    uint32_t mask = 0;
+    uint8_t reset = 0;
+    esp_io_stats_t io;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "reset")) {
+            reset = 1;
+            continue;
+        }
+        for (size_t g = 0; g < ESP_ARRAYSIZE(groups); ++g) {
+            if (!strcmp(argv[i], groups[g])) {
+                mask |= (uint32_t)1 << g;
+            }
+        }
+    }
+    if (mask == 0) {
+        mask = ((uint32_t)1 << ESP_ARRAYSIZE(groups)) - 1;
+    }
+
+    if (mask & 0x01) {
+        if (reset) {
+            esp_io_stats_reset();
+        } else if (esp_io_stats_get(&io) == espOK) {
+            cliprintf("  IO:      recv %u bytes in %u calls, send %u bytes in %u calls"CLI_NL,
+                (unsigned)io.recv_bytes, (unsigned)io.recv_calls, (unsigned)io.send_bytes, (unsigned)io.send_calls);
+        }
+    }
+#if ESP_CFG_RX_STATS
+    if (mask & 0x02) {
+        esp_rx_stats_t rx;
+
+        if (reset) {
+            esp_input_reset_stats();
+        } else if (esp_input_get_stats(&rx) == espOK) {
+            cliprintf("  RX:      high-water %u/%u bytes, %u overflows, %u bytes dropped"CLI_NL,
+                (unsigned)rx.high_water, (unsigned)rx.size, (unsigned)rx.overflows, (unsigned)rx.dropped);
+        }
+    }
+#endif /* ESP_CFG_RX_STATS */
+#if ESP_CFG_CONN_STATS
+    if (mask & 0x04) {
+        esp_conn_stats_t cs;
+        esp_conn_p conn;
+
+        if (!reset) {
+            cliprintf("  CONN     SENT    RECV CIPSEND SEND_OK FAIL RETRY LAT_MIN LAT_AVG LAT_MAX"CLI_NL);
+        }
+        for (uint8_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {
+            conn = esp_conn_get_by_num(i);
+            if (reset) {
+                esp_conn_reset_stats(conn);
+            } else if (esp_conn_get_stats(conn, &cs) == espOK && (esp_conn_is_active(conn) || cs.cipsend_cnt > 0)) {
+                cliprintf("  %4u %8u %7u %7u %7u %4u %5u %7u %7u %7u"CLI_NL, (unsigned)i,
+                    (unsigned)cs.bytes_sent, (unsigned)cs.bytes_recved, (unsigned)cs.cipsend_cnt,
+                    (unsigned)cs.send_ok_cnt, (unsigned)cs.send_fail_cnt, (unsigned)cs.retries,
+                    (unsigned)cs.latency_min, (unsigned)cs.latency_avg, (unsigned)cs.latency_max);
+            }
+        }
+    }
+#endif /* ESP_CFG_CONN_STATS */
+#if ESP_CFG_CMD_STATS
+    if (mask & 0x08) {
+        if (reset) {
+            esp_cmd_stats_reset();
+        } else {
+            cli_cmd_stats(cliprintf, 1, argv);
+        }
+    }
+#endif /* ESP_CFG_CMD_STATS */
+    if (mask & 0x10) {
+#if ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM
+        esp_mem_stats_t ms;
+
+        if (reset) {
+            esp_mem_reset_stats();
+        } else if (esp_mem_get_stats(&ms)) {
+            cliprintf("  MEM:     free %u bytes, min %u, largest block %u, fragmentation %u%%"CLI_NL,
+                (unsigned)ms.free_bytes, (unsigned)ms.min_free_bytes, (unsigned)ms.max_free_block, (unsigned)ms.fragmentation);
+            cliprintf("           %u blocks allocated, %u allocations total, bytes per tag:",
+                (unsigned)ms.alloc_cnt, (unsigned)ms.alloc_total);
+            for (size_t i = 0; i < ESP_ARRAYSIZE(ms.tag_bytes); ++i) {
+                cliprintf(" %u", (unsigned)ms.tag_bytes[i]);
+            }
+            cliprintf(CLI_NL);
+        }
+#endif /* ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM */
+#if ESP_CFG_PBUF_POOL
+        esp_pbuf_pool_stats_t ps;
+
+        if (reset) {
+            esp_pbuf_pool_reset_stats();
+        } else {
+            for (size_t i = 0; i < 3; ++i) {    /* Library has 3 pools */
+                if (esp_pbuf_pool_get_stats(i, &ps) != espOK) {
+                    continue;
+                }
+                cliprintf("  PBUF %u:  size %u, used %u/%u, max %u, allocs %u, heap fallbacks %u"CLI_NL,
+                    (unsigned)i, (unsigned)ps.size, (unsigned)ps.used, (unsigned)ps.num,
+                    (unsigned)ps.max_used, (unsigned)ps.alloc_cnt, (unsigned)ps.fail_cnt);
+            }
+        }
+#endif /* ESP_CFG_PBUF_POOL */
+    }
+    if ((mask & 0x20) && !reset) {
+        cliprintf("  TIMEOUT: %u pending"CLI_NL, (unsigned)esp_timeout_get_count());
+    }
+    if (reset) {
+        cliprintf("Statistics cleared"CLI_NL);
+    }
+}
+
+#if ESP_CFG_CMD_STATS || __DOXYGEN__
+
+/**
+ * \brief           CLI command for printing command latency statistics
+ * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       argc: Number fo arguments in argv
+ * \param[in]       argv: Pointer to the commands arguments
+ */
+static void
+cli_cmd_stats(cli_printf cliprintf, int argc, char** argv) {
+    esp_cmd_stats_t stats;
+
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        esp_cmd_stats_reset();
+        cliprintf("Statistics cleared"CLI_NL);
+        return;
+    }
+
+    cliprintf("  CMD   COUNT TIMEOUT  HISTOGRAM [0ms, 1ms, 2-3ms, 4-7ms, ...]"CLI_NL);
+    for (size_t cmd = 0; cmd < esp_cmd_stats_get_count(); ++cmd) {
+        if (esp_cmd_stats_get(cmd, &stats) != espOK || stats.count == 0) {
+            continue;
+        }
+        cliprintf("  %3d %7u %7u ", (int)cmd, (unsigned)stats.count, (unsigned)stats.timeouts);
+        for (size_t i = 0; i < ESP_ARRAYSIZE(stats.hist); ++i) {
+            cliprintf(" %u", (unsigned)stats.hist[i]);
+        }
+        cliprintf(CLI_NL);
+    }
+}
+
+#endif /* ESP_CFG_CMD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+
+/**
+ * \brief           CLI command for printing data path latency statistics
+ * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       argc: Number fo arguments in argv
+ * \param[in]       argv: Pointer to the commands arguments
+ */
+static void
+cli_trace(cli_printf cliprintf, int argc, char** argv) {
+    static const char* const names[] = { "rx-input", "rx-ipd", "rx-mbox", "rx-total", "msg-queue", "tx-send" };
+    esp_trace_stats_t stats;
+
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        esp_trace_reset();
+        cliprintf("Statistics cleared"CLI_NL);
+        return;
+    }
+
+    cliprintf("  STAGE       COUNT     MAX  HISTOGRAM [0ms, 1ms, 2-3ms, 4-7ms, ...]"CLI_NL);
+    for (size_t stage = 0; stage < ESP_ARRAYSIZE(names); ++stage) {
+        if (esp_trace_get((esp_trace_stage_t)stage, &stats) != espOK) {
+            continue;
+        }
+        cliprintf("  %-9s %7u %7u ", names[stage], (unsigned)stats.count, (unsigned)stats.max);
+        for (size_t i = 0; i < ESP_ARRAYSIZE(stats.hist); ++i) {
+            cliprintf(" %u", (unsigned)stats.hist[i]);
+        }
+        cliprintf(CLI_NL);
+    }
+}
+
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+
+/**
+ * \brief           CLI command for printing library thread statistics
+ * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       argc: Number fo arguments in argv
+ * \param[in]       argv: Pointer to the commands arguments
+ */
+static void
+cli_threads(cli_printf cliprintf, int argc, char** argv) {
+    static const char* const names[] = { "produce", "process" };
+    esp_thread_stats_t stats;
+    uint32_t total;
+
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        esp_thread_stats_reset();
+        cliprintf("Statistics cleared"CLI_NL);
+        return;
+    }
+
+    cliprintf("  THREAD     BUSY[ms] IDLE[ms] LOAD  WAKEUPS STACK_FREE"CLI_NL);
+    for (size_t thread = 0; thread < ESP_ARRAYSIZE(names); ++thread) {
+        if (esp_thread_stats_get((esp_thread_type_t)thread, &stats) != espOK) {
+            continue;
+        }
+        total = stats.busy_time + stats.idle_time;
+        cliprintf("  %-9s %9u %8u %3u%% %8u %10u"CLI_NL, names[thread],
+            (unsigned)stats.busy_time, (unsigned)stats.idle_time,
+            (unsigned)(total > 0 ? (uint32_t)((uint64_t)stats.busy_time * 100 / total) : 0),
+            (unsigned)stats.wakeups, (unsigned)stats.stack_free);
+    }
+}
+
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
+
+#if (ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__
+
+/**
+ * \brief           CLI command for printing allocation profiler statistics
+ * \param[in]       cliprintf: Pointer to CLI printf function
+ * \param[in]       argc: Number fo arguments in argv
+ * \param[in]       argv: Pointer to the commands arguments
+ */
+static void
+cli_mem_profile(cli_printf cliprintf, int argc, char** argv) {
+    static const char* const tags[] = { "other", "pbuf", "msg", "conn", "mqtt", "http" };
+    esp_mem_profile_sort_t sort = ESP_MEM_PROFILE_SORT_COUNT;
+    esp_mem_site_t sites[10];
+    esp_mem_frag_t frag;
+    const char* file;
+    size_t cnt;
+
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        esp_mem_profile_reset();
+        cliprintf("Statistics cleared"CLI_NL);
+        return;
+    } else if (argc > 1 && !strcmp(argv[1], "bytes")) {
+        sort = ESP_MEM_PROFILE_SORT_BYTES;
+    } else if (argc > 1 && !strcmp(argv[1], "live")) {
+        sort = ESP_MEM_PROFILE_SORT_LIVE;
+    }
+
+    cnt = esp_mem_profile_get_sites(sites, ESP_ARRAYSIZE(sites), sort);
+    cliprintf("  SITE                       TAG     COUNT    BYTES   MAX  LIVE LIVE_B SHORT AVG[ms]"CLI_NL);
+    for (size_t i = 0; i < cnt; ++i) {
+        file = sites[i].file != NULL ? sites[i].file : "?";
+        if (strlen(file) > 20) {                /* Keep end of path */
+            file += strlen(file) - 20;
+        }
+        cliprintf("  %20s:%-5u %-5s %7u %8u %5u %5u %6u %5u %7u"CLI_NL, file, (unsigned)sites[i].line,
+            (size_t)sites[i].tag < ESP_ARRAYSIZE(tags) ? tags[sites[i].tag] : "?",
+            (unsigned)sites[i].alloc_cnt, (unsigned)sites[i].alloc_bytes, (unsigned)sites[i].max_size,
+            (unsigned)sites[i].live_cnt, (unsigned)sites[i].live_bytes, (unsigned)sites[i].short_lived_cnt,
+            (unsigned)(sites[i].free_cnt > 0 ? sites[i].lifetime_total / sites[i].free_cnt : 0));
+    }
+
+    if (esp_mem_profile_get_frag(&frag)) {
+        cliprintf("  FREE: %u bytes in %u blocks, largest %u"CLI_NL,
+            (unsigned)frag.free_bytes, (unsigned)frag.free_blocks, (unsigned)frag.max_free_block);
+        cliprintf("  FREE BLOCKS [<32, 32-63, 64-127, ...]");
+        for (size_t i = 0; i < ESP_ARRAYSIZE(frag.hist); ++i) {
+            cliprintf(" %u", (unsigned)frag.hist[i]);
+        }
+        cliprintf(CLI_NL);
+    }
+}
+
+#endif /* (ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__ */
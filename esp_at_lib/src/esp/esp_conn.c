@@ -53,38 +53,145 @@
     }                                           \
 } while (0)
 
+static void conn_poll_schedule(void);
+static espr_t flush_buff(esp_conn_p conn);
+
 /**
- * \brief           Timeout callback for connection
+ * \brief           Get interval used to schedule connection processing
+ *
+ * With manual TCP receive, connections are processed periodically
+ * to read data, even when poll events are not enabled
+ *
+ * \param[in]       conn: Connection handle
+ * \return          Interval in units of milliseconds, `0` if connection is not scheduled
+ */
+static uint32_t
+conn_poll_get_interval(esp_conn_p conn) {
+    if (!conn->status.f.active) {
+        return 0;
+    }
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+    if (conn->poll_interval == 0) {
+        return ESP_CFG_CONN_POLL_INTERVAL;
+    }
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+    return conn->poll_interval;
+}
+
+/**
+ * \brief           Timeout callback for connection poll
+ *
+ * Single timeout serves all connections. Only connections with expired
+ * poll time are processed, then timeout is scheduled for next one
+ *
  * \param[in]       arg: Timeout callback custom argument
  */
 static void
 conn_timeout_cb(void* arg) {
-    esp_conn_p conn = arg;                      /* Argument is actual connection */
-
-    if (conn->status.f.active) {                /* Handle only active connections */
-        esp.evt.type = ESP_EVT_CONN_POLL;       /* Poll connection event */
-        esp.evt.evt.conn_poll.conn = conn;      /* Set connection pointer */
-        espi_send_conn_cb(conn, NULL);          /* Send connection callback */
+    uint32_t now = esp_sys_now(), interval, active;
+    esp_conn_p conn;
+
+    esp.conn_poll_scheduled = 0;
+    for (active = esp.m.conns_active_mask; active; active &= active - 1) {  /* Only active connections may poll */
+        conn = &esp.m.conns[espi_bit_ffs(active)];
+#if ESP_CFG_CONN_WRITE_LINGER
+        if (conn->status.f.write_linger_armed && (int32_t)(now - conn->write_flush_time) >= 0) {
+            flush_buff(conn);                   /* Linger time expired, send buffered data */
+        }
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
+        interval = conn_poll_get_interval(conn);
+        if (interval == 0 || (int32_t)(now - conn->poll_next) < 0) {
+            continue;
+        }
+        conn->poll_next = now + interval;       /* Schedule next poll before callback */
 
-        espi_conn_start_timeout(conn);          /* Schedule new timeout */
-        ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
-            "[CONN] Poll event: %p\r\n", conn);
-    }
+        if (conn->poll_interval > 0) {          /* Connection subscribed to poll events */
+            esp.evt.type = ESP_EVT_CONN_POLL;   /* Poll connection event */
+            esp.evt.evt.conn_poll.conn = conn;  /* Set connection pointer */
+            espi_send_conn_cb(conn, NULL);      /* Send connection callback */
+            ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
+                "[CONN] Poll event: %p\r\n", conn);
+        }
 
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
-    espi_conn_manual_tcp_try_read_data(conn);   /* Try to read data manually */
+        espi_conn_manual_tcp_try_read_data(conn);   /* Try to read data manually */
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+    }
+    conn_poll_schedule();                       /* Schedule for next connection */
+    ESP_UNUSED(arg);
+}
+
+/**
+ * \brief           Schedule poll timeout for connection with earliest poll time
+ * \note            Core must be locked when calling this function
+ */
+static void
+conn_poll_schedule(void) {
+    uint32_t now = esp_sys_now(), min = 0xFFFFFFFF, rem, active;
+    esp_conn_p conn;
+
+    for (active = esp.m.conns_active_mask; active; active &= active - 1) {
+        conn = &esp.m.conns[espi_bit_ffs(active)];
+#if ESP_CFG_CONN_WRITE_LINGER
+        if (conn->status.f.write_linger_armed) {
+            rem = (int32_t)(conn->write_flush_time - now) > 0 ? conn->write_flush_time - now : 0;
+            min = ESP_MIN(min, rem);
+        }
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
+        if (conn_poll_get_interval(conn) == 0) {
+            continue;
+        }
+        rem = (int32_t)(conn->poll_next - now) > 0 ? conn->poll_next - now : 0;
+        min = ESP_MIN(min, rem);
+    }
+
+#if ESP_CFG_TIMEOUT_WHEEL
+    if (min != 0xFFFFFFFF) {
+        esp_timeout_start(&esp.conn_poll_timeout, min, conn_timeout_cb, NULL);
+    } else {
+        esp_timeout_stop(&esp.conn_poll_timeout);
+    }
+#else /* ESP_CFG_TIMEOUT_WHEEL */
+    if (esp.conn_poll_scheduled) {
+        esp_timeout_remove(conn_timeout_cb);
+    }
+    if (min != 0xFFFFFFFF) {
+        esp_timeout_add(min, conn_timeout_cb, NULL);
+    }
+#endif /* !ESP_CFG_TIMEOUT_WHEEL */
+    esp.conn_poll_scheduled = min != 0xFFFFFFFF;
 }
 
 /**
  * \brief           Start timeout function for connection
+ * \note            Called when connection becomes active
  * \param[in]       conn: Connection handle as user argument
  */
 void
 espi_conn_start_timeout(esp_conn_p conn) {
-    esp_timeout_add(ESP_CFG_CONN_POLL_INTERVAL, conn_timeout_cb, conn); /* Add connection timeout */
+#if !ESP_CFG_CONN_POLL_OPT_IN
+    conn->poll_interval = ESP_CFG_CONN_POLL_INTERVAL;
+#endif /* !ESP_CFG_CONN_POLL_OPT_IN */
+    conn->poll_next = esp_sys_now() + conn_poll_get_interval(conn);
+    conn_poll_schedule();
 }
 
+#if ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__
+
+/**
+ * \brief           Flush write buffer waiting for linger time, when previous send has finished
+ * \note            Core must be locked when calling this function
+ * \param[in]       conn: Connection handle
+ */
+void
+espi_conn_write_idle(esp_conn_p conn) {
+    if (conn->status.f.write_linger_armed) {
+        flush_buff(conn);
+    }
+}
+
+#endif /* ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__ */
+
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
 
 /**
@@ -97,13 +204,122 @@ manual_tcp_read_data_evt_fn(espr_t res, void* arg) {
     esp_conn_p conn = arg;
 
     conn->status.f.receive_is_command_queued = 0;
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO
+    esp.conn_recv_queued = 0;
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO */
     espi_conn_manual_tcp_try_read_data(conn);
 }
 
+/**
+ * \brief           Get receive window of connection
+ * \param[in]       conn: Connection handle
+ * \return          Maximal number of not acknowledged bytes, `0` if not limited
+ */
+static size_t
+manual_tcp_get_window(esp_conn_p conn) {
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO
+    if (conn->recv_window > 0) {
+        return conn->recv_window;
+    }
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO */
+    ESP_UNUSED(conn);
+    return ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW;
+}
+
+/**
+ * \brief           Get number of bytes to read with next read command
+ *
+ * Length is limited by data available on device, by receive window of not acknowledged bytes
+ * and by largest free memory block when memory statistics are enabled
+ *
+ * \param[in]       conn: Connection handle
+ * \return          Number of bytes to read, `0` if read shall not start
+ */
+size_t
+espi_conn_manual_tcp_get_read_len(esp_conn_p conn) {
+    size_t len, window;
+
+    len = ESP_MIN(ESP_CFG_CONN_MANUAL_TCP_RECEIVE_MAX_LEN, conn->tcp_available_bytes);
+    window = manual_tcp_get_window(conn);
+    if (window > 0) {
+        if (conn->tcp_not_ack_bytes >= window) {
+            return 0;                           /* Back-pressure, wait for application */
+        }
+        len = ESP_MIN(len, window - conn->tcp_not_ack_bytes);
+    }
+#if ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM
+    {
+        esp_mem_stats_t stats;
+
+        /* Use at most half of largest free block, leave memory for other allocations */
+        if (len > 0 && esp_mem_get_stats(&stats)) {
+            len = ESP_MIN(len, stats.max_free_block / 2);
+        }
+    }
+#endif /* ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM */
+    return len;
+}
+
+/**
+ * \brief           Check if read command may be started on connection
+ * \param[in]       conn: Connection handle
+ * \return          \ref espOK if connection is ready to read, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+manual_tcp_can_read(esp_conn_p conn) {
+    /* Receive must not be blocked and other command must not be in queue to read data */
+    if (conn->status.f.receive_blocked
+        || conn->status.f.receive_is_command_queued) {
+        return espINPROG;
+    }
+
+    /* Any available data to process? */
+    if (conn->tcp_available_bytes == 0) {
+        return espERR;
+    }
+
+    /* Application did not process previous data yet */
+    if (espi_conn_manual_tcp_get_read_len(conn) == 0) {
+        return espINPROG;
+    }
+    return espOK;
+}
+
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO || __DOXYGEN__
+
+/**
+ * \brief           Find connection to read from next
+ *
+ * Connection with highest receive priority is chosen,
+ * connections with same priority are served in round-robin order
+ *
+ * \return          Connection handle or `NULL` if no connection is ready to read
+ */
+static esp_conn_p
+manual_tcp_get_next_conn(void) {
+    esp_conn_p conn, best = NULL;
+    uint8_t num;
+
+    for (size_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {
+        num = (uint8_t)((esp.conn_recv_next + i) % ESP_CFG_MAX_CONNS);
+        conn = &esp.m.conns[num];
+        if (conn->status.f.active && manual_tcp_can_read(conn) == espOK
+            && (best == NULL || conn->recv_prio > best->recv_prio)) {
+            best = conn;
+        }
+    }
+    return best;
+}
+
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO || __DOXYGEN__ */
+
 /**
  * \brief           Manually start data read operation with desired length on specific connection
+ *
+ * With \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO enabled, read is started
+ * on connection chosen by receive priority, which may not be input connection
+ *
  * \param[in]       conn: Connection handle
- * \param[in]       len: Number of bytes to read
  * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
  */
 espr_t
@@ -114,16 +330,18 @@ espi_conn_manual_tcp_try_read_data(esp_conn_p conn) {
 
     ESP_ASSERT("conn != NULL", conn != NULL);
 
-    /* Receive must not be blocked and other command must not be in queue to read data */
-    if (conn->status.f.receive_blocked
-        || conn->status.f.receive_is_command_queued) {
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO
+    if (esp.conn_recv_queued) {                 /* Next connection is chosen when current read finishes */
         return espINPROG;
     }
-
-    /* Any available data to process? */
-    if (conn->tcp_available_bytes == 0) {
+    if ((conn = manual_tcp_get_next_conn()) == NULL) {
         return espERR;
     }
+#else /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO */
+    if ((res = manual_tcp_can_read(conn)) != espOK) {
+        return res;
+    }
+#endif /* !ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO */
 
     ESP_MSG_VAR_ALLOC(msg, blocking);           /* Allocate first, will return on failure */
     ESP_MSG_VAR_SET_EVT(msg, manual_tcp_read_data_evt_fn, conn);/* Set event callback function */
@@ -136,6 +354,10 @@ espi_conn_manual_tcp_try_read_data(esp_conn_p conn) {
     /* Try to start command */
     if ((res = espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 60000)) == espOK) {
         conn->status.f.receive_is_command_queued = 1;   /* Command queued */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO
+        esp.conn_recv_queued = 1;
+        esp.conn_recv_next = (uint8_t)((conn->num + 1) % ESP_CFG_MAX_CONNS);
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO */
     }
     return res;
 }
@@ -156,6 +378,36 @@ espi_conn_get_val_id(esp_conn_p conn) {
     return val_id;
 }
 
+#if ESP_CFG_MEM_STATIC
+ESP_MEM_POOL_DEFINE(conn_buff_pool, ESP_CFG_CONN_MAX_DATA_LEN, ESP_CFG_MEM_STATIC_CONN_BUFFS);
+#endif /* ESP_CFG_MEM_STATIC */
+
+/**
+ * \brief           Allocate connection write buffer of \ref ESP_CFG_CONN_MAX_DATA_LEN bytes
+ * \return          Pointer to buffer on success, `NULL` otherwise
+ */
+void *
+espi_conn_buff_alloc(void) {
+#if ESP_CFG_MEM_STATIC
+    return espi_mem_pool_alloc(&conn_buff_pool);
+#else /* ESP_CFG_MEM_STATIC */
+    return esp_mem_malloc_tag(ESP_CFG_CONN_MAX_DATA_LEN, ESP_MEM_TAG_CONN);
+#endif /* !ESP_CFG_MEM_STATIC */
+}
+
+/**
+ * \brief           Free connection write buffer allocated with \ref espi_conn_buff_alloc
+ * \param[in]       buff: Buffer to free
+ */
+void
+espi_conn_buff_free(void* buff) {
+#if ESP_CFG_MEM_STATIC
+    espi_mem_pool_free(&conn_buff_pool, buff);
+#else /* ESP_CFG_MEM_STATIC */
+    esp_mem_free(buff);
+#endif /* !ESP_CFG_MEM_STATIC */
+}
+
 /**
  * \brief           Send data on already active connection of type UDP to specific remote IP and port
  * \note            In case IP and port values are not set, it will behave as normal send function (suitable for TCP too)
@@ -166,12 +418,15 @@ espi_conn_get_val_id(esp_conn_p conn) {
  * \param[in]       btw: Number of bytes to send
  * \param[out]      bw: Pointer to output variable to save number of sent data when successfully sent
  * \param[in]       fau: "Free After Use" flag. Set to `1` if stack should free the memory after data sent
+ * \param[in]       release_fn: Function called when caller owned data are not used anymore. Set to `NULL` if not used
+ * \param[in]       release_arg: Custom argument for release function
  * \param[in]       blocking: Status whether command should be blocking or not
  * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
  */
 static espr_t
 conn_send(esp_conn_p conn, const esp_ip_t* const ip, esp_port_t port, const void* data,
-            size_t btw, size_t* const bw, uint8_t fau, const uint32_t blocking) {
+            size_t btw, size_t* const bw, uint8_t fau, esp_conn_release_fn release_fn,
+            void* const release_arg, const uint32_t blocking) {
     ESP_MSG_VAR_DEFINE(msg);
 
     ESP_ASSERT("conn != NULL", conn != NULL);
@@ -184,6 +439,41 @@ conn_send(esp_conn_p conn, const esp_ip_t* const ip, esp_port_t port, const void
 
     CONN_CHECK_CLOSED_IN_CLOSING(conn);         /* Check if we can continue */
 
+#if ESP_CFG_CONN_SEND_QUEUE
+    espi_conn_send_q_wait(conn);                /* Back-pressure when too many commands are waiting */
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+
+#if ESP_CFG_CONN_TRANSPARENT
+    /* In transparent mode, data are written directly to AT port */
+    esp_core_lock();
+    if (conn == esp.m.transparent_conn && !esp.m.transparent_prompt) {
+        size_t sent;
+
+        sent = esp.ll.send_fn(data, btw);
+        esp.ll.send_fn(NULL, 0);                /* Flush data */
+        esp.send_total_len += (uint32_t)sent;
+        ++esp.send_calls;
+        if (bw != NULL) {
+            *bw = sent;
+        }
+        /*
+         * Caller owned data were accepted once written to AT port,
+         * they are released whatever the result.
+         * Write buffer is freed by caller when function fails
+         */
+        if (fau) {
+            if (sent == btw) {
+                espi_conn_buff_free((void *)data);
+            }
+        } else if (release_fn != NULL) {
+            release_fn(data, release_arg);
+        }
+        esp_core_unlock();
+        return sent == btw ? espOK : espERR;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPSEND;
 
@@ -194,6 +484,8 @@ conn_send(esp_conn_p conn, const esp_ip_t* const ip, esp_port_t port, const void
     ESP_MSG_VAR_REF(msg).msg.conn_send.remote_ip = ip;
     ESP_MSG_VAR_REF(msg).msg.conn_send.remote_port = port;
     ESP_MSG_VAR_REF(msg).msg.conn_send.fau = fau;
+    ESP_MSG_VAR_REF(msg).msg.conn_send.release_fn = release_fn;
+    ESP_MSG_VAR_REF(msg).msg.conn_send.release_arg = release_arg;
     ESP_MSG_VAR_REF(msg).msg.conn_send.val_id = espi_conn_get_val_id(conn);
 
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 60000);
@@ -214,27 +506,48 @@ flush_buff(esp_conn_p conn) {
          * simply free the memory and stop execution
          */
         if (conn->buff.ptr > 0) {               /* Anything to send at the moment? */
-            res = conn_send(conn, NULL, 0, conn->buff.buff, conn->buff.ptr, NULL, 1, 0);
+            res = conn_send(conn, NULL, 0, conn->buff.buff, conn->buff.ptr, NULL, 1, NULL, NULL, 0);
         } else {
             res = espERR;
         }
         if (res != espOK) {
             ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
                 "[CONN] Free write buffer: %p\r\n", (void *)conn->buff.buff);
-            esp_mem_free_s((void **)&conn->buff.buff);
+            espi_conn_buff_free(conn->buff.buff);
         }
         conn->buff.buff = NULL;
+#if ESP_CFG_CONN_WRITE_LINGER
+        conn->status.f.write_linger_armed = 0;
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
     }
     esp_core_unlock();
     return res;
 }
 
+#if ESP_CFG_CONN_STATUS_CHECK_INTERVAL > 0 || __DOXYGEN__
+
+/**
+ * \brief           Periodic connection table consistency check
+ * \param[in]       arg: Timeout callback custom argument
+ */
+static void
+conn_status_check_cb(void* arg) {
+    if (esp.status.f.dev_present) {
+        esp_get_conns_status(0);                /* Result arrives through regular CIPSTATUS parsing */
+    }
+    esp_timeout_add(ESP_CFG_CONN_STATUS_CHECK_INTERVAL, conn_status_check_cb, arg);
+}
+
+#endif /* ESP_CFG_CONN_STATUS_CHECK_INTERVAL > 0 || __DOXYGEN__ */
+
 /**
  * \brief           Initialize connection module
  */
 void
 espi_conn_init(void) {
-
+#if ESP_CFG_CONN_STATUS_CHECK_INTERVAL > 0
+    esp_timeout_add(ESP_CFG_CONN_STATUS_CHECK_INTERVAL, conn_status_check_cb, NULL);
+#endif /* ESP_CFG_CONN_STATUS_CHECK_INTERVAL > 0 */
 }
 
 /**
@@ -259,7 +572,9 @@ esp_conn_start(esp_conn_p* conn, esp_conn_type_t type, const char* const remote_
 
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPSTART;
+#if !ESP_CFG_CONN_STATUS_TRUST_EVENTS
     ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_TCPIP_CIPSTATUS;
+#endif /* !ESP_CFG_CONN_STATUS_TRUST_EVENTS */
     ESP_MSG_VAR_REF(msg).msg.conn_start.num = ESP_CFG_MAX_CONNS;/* Set maximal value as invalid number */
     ESP_MSG_VAR_REF(msg).msg.conn_start.conn = conn;
     ESP_MSG_VAR_REF(msg).msg.conn_start.type = type;
@@ -292,7 +607,9 @@ esp_conn_startex(esp_conn_p* conn, esp_conn_start_t* start_struct,
 
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPSTART;
+#if !ESP_CFG_CONN_STATUS_TRUST_EVENTS
     ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_TCPIP_CIPSTATUS;
+#endif /* !ESP_CFG_CONN_STATUS_TRUST_EVENTS */
     ESP_MSG_VAR_REF(msg).msg.conn_start.num = ESP_CFG_MAX_CONNS;/* Set maximal value as invalid number */
     ESP_MSG_VAR_REF(msg).msg.conn_start.conn = conn;
     ESP_MSG_VAR_REF(msg).msg.conn_start.type = start_struct->type;
@@ -313,6 +630,115 @@ esp_conn_startex(esp_conn_p* conn, esp_conn_start_t* start_struct,
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 60000);
 }
 
+/**
+ * \brief           Queue multiple connection starts at once in non-blocking mode
+ *
+ * All requests are put to producer queue back-to-back, so next `AT+CIPSTART`
+ * is sent immediately after previous finishes, without waiting for application thread.
+ * Results are reported per connection with \ref ESP_EVT_CONN_ACTIVE or \ref ESP_EVT_CONN_ERROR events.
+ *
+ * \note            Start structures and host strings must stay valid until connection result event
+ * \param[out]      conns: Array of `count` connection handles, set on successful connect. Set to `NULL` if not used
+ * \param[in]       start_structs: Array of `count` connection start structures
+ * \param[in]       count: Number of connections to start
+ * \param[in]       arg: Pointer to user argument passed to each connection
+ * \param[in]       conn_evt_fn: Callback function for all connections
+ * \return          \ref espOK if all requests were queued, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_start_multi(esp_conn_p* conns, esp_conn_start_t* start_structs, size_t count,
+    void* const arg, esp_evt_fn conn_evt_fn) {
+    espr_t res = espOK;
+
+    ESP_ASSERT("start_structs != NULL", start_structs != NULL);
+    ESP_ASSERT("count > 0", count > 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        res = esp_conn_startex(conns != NULL ? &conns[i] : NULL, &start_structs[i], arg, conn_evt_fn, 0);
+        if (res != espOK) {
+            break;
+        }
+    }
+    return res;
+}
+
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+
+/**
+ * \brief           Start a new connection in transparent (CIPMODE=1) mode
+ * \note            Device is put to single connection mode and all other AT commands
+ *                  are rejected until \ref esp_conn_stop_transparent is called
+ * \note            Data can be sent with \ref esp_conn_send once function returns \ref espOK
+ * \param[out]      conn: Pointer to connection handle to set new connection reference in case of successfully connected
+ * \param[in]       type: Connection type. This parameter can be a value of \ref esp_conn_type_t enumeration
+ * \param[in]       remote_host: Connection host. In case of IP, write it as string, ex. "192.168.1.1"
+ * \param[in]       remote_port: Connection port
+ * \param[in]       arg: Pointer to user argument passed to connection if successfully connected
+ * \param[in]       conn_evt_fn: Callback function for this connection
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_start_transparent(esp_conn_p* conn, esp_conn_type_t type, const char* const remote_host, esp_port_t remote_port,
+                void* const arg, esp_evt_fn conn_evt_fn, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("remote_host != NULL", remote_host != NULL);
+    ESP_ASSERT("remote_port > 0", remote_port > 0);
+    ESP_ASSERT("conn_evt_fn != NULL", conn_evt_fn != NULL);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPMODE;
+    ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_TCPIP_CIPMUX;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.num = 0;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.conn = conn;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.type = type;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.remote_host = remote_host;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.remote_port = remote_port;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.evt_func = conn_evt_fn;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.arg = arg;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.transparent = 1;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 60000);
+}
+
+/**
+ * \brief           Leave transparent mode, close connection and restore multiple connections mode
+ * \note            Exit sequence `+++` requires \ref ESP_CFG_CONN_TRANSPARENT_GUARD_TIME
+ *                  of silence on the line before and after it
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_stop_transparent(const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPMODE;
+    ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_TCPIP_TRANSPARENT_EXIT;
+    ESP_MSG_VAR_REF(msg).msg.conn_start.transparent = 0;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000 + 2 * ESP_CFG_CONN_TRANSPARENT_GUARD_TIME);
+}
+
+/**
+ * \brief           Check if connection is in transparent mode
+ * \param[in]       conn: Pointer to connection to check for status
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_conn_is_transparent(esp_conn_p conn) {
+    uint8_t res = 0;
+    if (conn != NULL && espi_is_valid_conn_ptr(conn)) {
+        ESP_CORE_READ_LOCK();
+        res = conn == esp.m.transparent_conn;
+        ESP_CORE_READ_UNLOCK();
+    }
+    return res;
+}
+
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
+
 /**
  * \brief           Close specific or all connections
  * \param[in]       conn: Connection handle to close. Set to NULL if you want to close all connections.
@@ -328,6 +754,13 @@ esp_conn_close(esp_conn_p conn, const uint32_t blocking) {
 
     CONN_CHECK_CLOSED_IN_CLOSING(conn);         /* Check if we can continue */
 
+#if ESP_CFG_CONN_TRANSPARENT
+    if (esp_conn_is_transparent(conn)) {        /* Closing transparent connection leaves transparent mode */
+        flush_buff(conn);
+        return esp_conn_stop_transparent(blocking);
+    }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+
     /* Proceed with close event at this point! */
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPCLOSE;
@@ -346,6 +779,54 @@ esp_conn_close(esp_conn_p conn, const uint32_t blocking) {
     return res;
 }
 
+/**
+ * \brief           Close all active connections with single command
+ *
+ * Device closes all connections at once. \ref ESP_EVT_CONN_CLOSE event
+ * is sent for each connection, which was active, when command finishes
+ *
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_close_all(const uint32_t blocking) {
+    espr_t res;
+    uint32_t active;
+    ESP_MSG_VAR_DEFINE(msg);
+
+    esp_core_lock();
+    active = esp.m.conns_active_mask;
+    esp_core_unlock();
+    if (!active) {                              /* Nothing to close */
+        return espOK;
+    }
+
+#if ESP_CFG_CONN_TRANSPARENT
+    if (esp_conn_is_transparent(&esp.m.conns[0])) { /* Closing transparent connection leaves transparent mode */
+        return esp_conn_close(&esp.m.conns[0], blocking);
+    }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPCLOSE;
+    ESP_MSG_VAR_REF(msg).msg.conn_close.conn = NULL;/* Close all connections */
+
+    esp_core_lock();
+    for (active = esp.m.conns_active_mask; active; active &= active - 1) {
+        flush_buff(&esp.m.conns[espi_bit_ffs(active)]); /* First flush buffers */
+    }
+    esp_core_unlock();
+    res = espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 1000);
+    if (res == espOK && !blocking) {            /* Function succedded in non-blocking mode */
+        esp_core_lock();
+        for (active = esp.m.conns_active_mask; active; active &= active - 1) {
+            esp.m.conns[espi_bit_ffs(active)].status.f.in_closing = 1;
+        }
+        esp_core_unlock();
+    }
+    return res;
+}
+
 /**
  * \brief           Send data on active connection of type UDP to specific remote IP and port
  * \note            In case IP and port values are not set, it will behave as normal send function (suitable for TCP too)
@@ -364,7 +845,7 @@ esp_conn_sendto(esp_conn_p conn, const esp_ip_t* const ip, esp_port_t port, cons
     ESP_ASSERT("conn != NULL", conn != NULL);
 
     flush_buff(conn);                           /* Flush currently written memory if exists */
-    return conn_send(conn, ip, port, data, btw, bw, 0, blocking);
+    return conn_send(conn, ip, port, data, btw, bw, 0, NULL, NULL, blocking);
 }
 
 /**
@@ -401,11 +882,38 @@ esp_conn_send(esp_conn_p conn, const void* data, size_t btw, size_t* const bw,
     esp_core_unlock();
     res = flush_buff(conn);                     /* Flush currently written memory if exists */
     if (btw > 0) {                              /* Check for remaining data */
-        res = conn_send(conn, NULL, 0, d, btw, bw, 0, blocking);
+        res = conn_send(conn, NULL, 0, d, btw, bw, 0, NULL, NULL, blocking);
     }
     return res;
 }
 
+/**
+ * \brief           Send data directly from caller owned memory on already active connection
+ * \note            Data are not copied. Memory must stay valid until `release_fn` is called.
+ *                  Once data are accepted by the stack, `release_fn` is called exactly once,
+ *                  whatever the result of sending: after command finished, before \ref ESP_EVT_CONN_SEND event
+ *                  and before blocking call returns.
+ *                  When function fails before data are accepted (connection closed, out of memory, ...),
+ *                  `release_fn` is not called and memory ownership stays with the caller.
+ *                  Blocking call may return error after data were accepted, use `release_fn` to tell both cases apart
+ * \param[in]       conn: Connection handle to send data
+ * \param[in]       data: Data to send
+ * \param[in]       btw: Number of bytes to send
+ * \param[in]       release_fn: Function to call when memory is not used anymore by the stack
+ * \param[in]       release_arg: Custom argument for release function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_send_ref(esp_conn_p conn, const void* data, size_t btw, esp_conn_release_fn release_fn,
+                void* const release_arg, const uint32_t blocking) {
+    ESP_ASSERT("conn != NULL", conn != NULL);
+    ESP_ASSERT("release_fn != NULL", release_fn != NULL);
+
+    flush_buff(conn);                           /* Flush currently written memory if exists */
+    return conn_send(conn, NULL, 0, data, btw, NULL, 0, release_fn, release_arg, blocking);
+}
+
 /**
  * \brief           Notify connection about received data which means connection is ready to accept more data
  *
@@ -430,6 +938,14 @@ esp_conn_recved(esp_conn_p conn, esp_pbuf_p pbuf) {
     } else {
         /* Warning here, de-sync happened somewhere! */
     }
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH > 0
+    /* Accumulate acknowledgements, unless application consumed everything */
+    conn->tcp_ack_pending += len;
+    if (conn->tcp_ack_pending < ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH && conn->tcp_not_ack_bytes > 0) {
+        return espOK;
+    }
+    conn->tcp_ack_pending = 0;
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH > 0 */
     espi_conn_manual_tcp_try_read_data(conn);   /* Try to read more connection data */
 #else /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
     ESP_UNUSED(conn);
@@ -462,9 +978,9 @@ esp_conn_set_arg(esp_conn_p conn, void* const arg) {
 void *
 esp_conn_get_arg(esp_conn_p conn) {
     void* arg;
-    esp_core_lock();
+    ESP_CORE_READ_LOCK();
     arg = conn->arg;                            /* Set argument for connection */
-    esp_core_unlock();
+    ESP_CORE_READ_UNLOCK();
     return arg;
 }
 
@@ -483,6 +999,158 @@ esp_get_conns_status(const uint32_t blocking) {
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 1000);
 }
 
+/**
+ * \brief           Set interval of \ref ESP_EVT_CONN_POLL events for connection
+ * \note            Interval is reset when connection becomes active again
+ * \param[in]       conn: Connection handle
+ * \param[in]       interval: Interval in units of milliseconds. Set to `0` to disable poll events
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_set_poll_interval(esp_conn_p conn, uint32_t interval) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("conn != NULL", conn != NULL);
+
+    esp_core_lock();
+    if (espi_is_valid_conn_ptr(conn) && conn->status.f.active) {
+        conn->poll_interval = interval;
+        conn->poll_next = esp_sys_now() + conn_poll_get_interval(conn);
+        conn_poll_schedule();
+        res = espOK;
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#if ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__
+
+/**
+ * \brief           Set linger time of data buffered with \ref esp_conn_write
+ *
+ * Buffered data are sent automatically when linger time expires
+ * or when previous send on connection finishes, whichever comes first
+ *
+ * \note            Linger time is reset to \ref ESP_CFG_CONN_WRITE_LINGER_TIME when connection becomes active again
+ * \param[in]       conn: Connection handle
+ * \param[in]       linger: Linger time in units of milliseconds.
+ *                      Set to `0` to disable automatic flush, buffered data are sent immediately
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_set_write_linger(esp_conn_p conn, uint32_t linger) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("conn != NULL", conn != NULL);
+
+    esp_core_lock();
+    if (espi_is_valid_conn_ptr(conn) && conn->status.f.active) {
+        conn->write_linger = linger;
+        if (conn->status.f.write_linger_armed) {
+            if (linger == 0) {
+                flush_buff(conn);
+            } else {
+                conn->write_flush_time = esp_sys_now() + linger;
+            }
+            conn_poll_schedule();
+        }
+        res = espOK;
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__ */
+
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+
+/**
+ * \brief           Set weight of connection in send queue scheduling
+ *
+ * Producing thread takes up to `weight` queued send commands of connection in one round-robin turn,
+ * before it continues with next connection. Use higher weight for latency sensitive connections,
+ * which shall not wait behind bulk transfers on other connections
+ *
+ * \note            Weight is reset to `1` when connection becomes active again
+ * \param[in]       conn: Connection handle
+ * \param[in]       weight: Number of send commands per turn. Set to `0` or `1` for plain round-robin
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_set_send_weight(esp_conn_p conn, uint8_t weight) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("conn != NULL", conn != NULL);
+
+    esp_core_lock();
+    if (espi_is_valid_conn_ptr(conn) && conn->status.f.active) {
+        conn->send_weight = weight;
+        res = espOK;
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+
+#if (ESP_CFG_CONN_MANUAL_TCP_RECEIVE && ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO) || __DOXYGEN__
+
+/**
+ * \brief           Set priority of connection for manual TCP receive
+ *
+ * When more connections have data available on device,
+ * data of connection with highest priority are read first
+ *
+ * \note            Priority is reset to `0` when connection becomes active again
+ * \param[in]       conn: Connection handle
+ * \param[in]       prio: Receive priority. Connection with higher value is read first
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_set_recv_priority(esp_conn_p conn, uint8_t prio) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("conn != NULL", conn != NULL);
+
+    esp_core_lock();
+    if (espi_is_valid_conn_ptr(conn) && conn->status.f.active) {
+        conn->recv_prio = prio;
+        res = espOK;
+    }
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Set receive window of connection for manual TCP receive
+ *
+ * Stack stops reading connection data from device when `window` bytes
+ * are not yet acknowledged by application with \ref esp_conn_recved
+ *
+ * \note            Window is reset to \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW when connection becomes active again
+ * \param[in]       conn: Connection handle
+ * \param[in]       window: Receive window in units of bytes.
+ *                      Set to `0` to use \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_set_recv_window(esp_conn_p conn, size_t window) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("conn != NULL", conn != NULL);
+
+    esp_core_lock();
+    if (espi_is_valid_conn_ptr(conn) && conn->status.f.active) {
+        conn->recv_window = window;
+        espi_conn_manual_tcp_try_read_data(conn);   /* Larger window may allow more data */
+        res = espOK;
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* (ESP_CFG_CONN_MANUAL_TCP_RECEIVE && ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO) || __DOXYGEN__ */
+
 /**
  * \brief           Check if connection type is client
  * \param[in]       conn: Pointer to connection to check for status
@@ -492,9 +1160,9 @@ uint8_t
 esp_conn_is_client(esp_conn_p conn) {
     uint8_t res = 0;
     if (conn != NULL && espi_is_valid_conn_ptr(conn)) {
-        esp_core_lock();
+        ESP_CORE_READ_LOCK();
         res = conn->status.f.active && conn->status.f.client;
-        esp_core_unlock();
+        ESP_CORE_READ_UNLOCK();
     }
     return res;
 }
@@ -508,9 +1176,9 @@ uint8_t
 esp_conn_is_server(esp_conn_p conn) {
     uint8_t res = 0;
     if (conn != NULL && espi_is_valid_conn_ptr(conn)) {
-        esp_core_lock();
+        ESP_CORE_READ_LOCK();
         res = conn->status.f.active && !conn->status.f.client;
-        esp_core_unlock();
+        ESP_CORE_READ_UNLOCK();
     }
     return res;
 }
@@ -524,9 +1192,9 @@ uint8_t
 esp_conn_is_active(esp_conn_p conn) {
     uint8_t res = 0;
     if (conn != NULL && espi_is_valid_conn_ptr(conn)) {
-        esp_core_lock();
+        ESP_CORE_READ_LOCK();
         res = conn->status.f.active;
-        esp_core_unlock();
+        ESP_CORE_READ_UNLOCK();
     }
     return res;
 }
@@ -540,9 +1208,9 @@ uint8_t
 esp_conn_is_closed(esp_conn_p conn) {
     uint8_t res = 0;
     if (conn != NULL && espi_is_valid_conn_ptr(conn)) {
-        esp_core_lock();
+        ESP_CORE_READ_LOCK();
         res = !conn->status.f.active;
-        esp_core_unlock();
+        ESP_CORE_READ_UNLOCK();
     }
     return res;
 }
@@ -562,6 +1230,19 @@ esp_conn_getnum(esp_conn_p conn) {
     return res;
 }
 
+/**
+ * \brief           Get connection handle from connection number
+ * \param[in]       num: Connection number, from `0` to `ESP_CFG_MAX_CONNS - 1`
+ * \return          Connection handle on success, `NULL` if number is out of range
+ */
+esp_conn_p
+esp_conn_get_by_num(uint8_t num) {
+    if (num >= ESP_CFG_MAX_CONNS) {
+        return NULL;
+    }
+    return &esp.m.conns[num];                   /* Connection handles never change */
+}
+
 /**
  * \brief           Set internal buffer size for SSL connection on ESP device
  * \note            Use this function before you start first SSL connection
@@ -644,25 +1325,28 @@ esp_conn_write(esp_conn_p conn, const void* data, size_t btw, uint8_t flush,
         /* Step 1.1 */
         if (conn->buff.ptr == conn->buff.len || flush) {
             /* Try to send to processing queue in non-blocking way */
-            if (conn_send(conn, NULL, 0, conn->buff.buff, conn->buff.ptr, NULL, 1, 0) != espOK) {
+            if (conn_send(conn, NULL, 0, conn->buff.buff, conn->buff.ptr, NULL, 1, NULL, NULL, 0) != espOK) {
                 ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
                     "[CONN] Free write buffer: %p\r\n", conn->buff.buff);
-                esp_mem_free_s((void **)&conn->buff.buff);
+                espi_conn_buff_free(conn->buff.buff);
             }
             conn->buff.buff = NULL;
+#if ESP_CFG_CONN_WRITE_LINGER
+            conn->status.f.write_linger_armed = 0;
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
         }
     }
 
     /* Step 2 */
     while (btw >= ESP_CFG_CONN_MAX_DATA_LEN) {
         uint8_t* buff;
-        buff = esp_mem_malloc(sizeof(*buff) * ESP_CFG_CONN_MAX_DATA_LEN);
+        buff = espi_conn_buff_alloc();
         if (buff != NULL) {
             ESP_MEMCPY(buff, d, ESP_CFG_CONN_MAX_DATA_LEN); /* Copy data to buffer */
-            if (conn_send(conn, NULL, 0, buff, ESP_CFG_CONN_MAX_DATA_LEN, NULL, 1, 0) != espOK) {
+            if (conn_send(conn, NULL, 0, buff, ESP_CFG_CONN_MAX_DATA_LEN, NULL, 1, NULL, NULL, 0) != espOK) {
                 ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
                     "[CONN] Free write buffer: %p\r\n", (void *)buff);
-                esp_mem_free_s((void **)&buff);
+                espi_conn_buff_free(buff);
                 return espERRMEM;
             }
         } else {
@@ -675,7 +1359,7 @@ esp_conn_write(esp_conn_p conn, const void* data, size_t btw, uint8_t flush,
 
     /* Step 3 */
     if (conn->buff.buff == NULL) {
-        conn->buff.buff = esp_mem_malloc(sizeof(*conn->buff.buff) * ESP_CFG_CONN_MAX_DATA_LEN);
+        conn->buff.buff = espi_conn_buff_alloc();
         conn->buff.len = ESP_CFG_CONN_MAX_DATA_LEN;
         conn->buff.ptr = 0;
 
@@ -698,6 +1382,16 @@ esp_conn_write(esp_conn_p conn, const void* data, size_t btw, uint8_t flush,
         flush_buff(conn);
     }
 
+#if ESP_CFG_CONN_WRITE_LINGER
+    /* Start linger time when first data wait in buffer */
+    if (conn->write_linger > 0 && conn->buff.buff != NULL && conn->buff.ptr > 0
+        && !conn->status.f.write_linger_armed) {
+        conn->status.f.write_linger_armed = 1;
+        conn->write_flush_time = esp_sys_now() + conn->write_linger;
+        conn_poll_schedule();
+    }
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
+
     /* Calculate number of available memory after write operation */
     if (mem_available != NULL) {
         if (conn->buff.buff != NULL) {
@@ -709,6 +1403,34 @@ esp_conn_write(esp_conn_p conn, const void* data, size_t btw, uint8_t flush,
     return espOK;
 }
 
+/**
+ * \brief           Write multiple data fragments to connection buffer and if it is full, send it non-blocking way
+ * \note            This function may only be called from core (connection callbacks)
+ * \note            Fragments are coalesced into connection write buffer, so several small
+ *                  fragments (header, body, trailer) are sent with single `CIPSEND` command
+ * \param[in]       conn: Connection to write
+ * \param[in]       iov: Array of data fragments to write
+ * \param[in]       iovcnt: Number of entries in `iov` array
+ * \param[in]       flush: Flush flag. Set to `1` if you want to send data immediatelly after last fragment
+ * \param[out]      mem_available: Available memory size available in current write buffer.
+ *                  Check \ref esp_conn_write for more information
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_writev(esp_conn_p conn, const esp_iovec_t* iov, size_t iovcnt, uint8_t flush,
+                size_t* const mem_available) {
+    espr_t res = espOK;
+
+    ESP_ASSERT("conn != NULL", conn != NULL);
+    ESP_ASSERT("iov != NULL", iov != NULL);
+
+    for (size_t i = 0; i < iovcnt && res == espOK; ++i) {
+        res = esp_conn_write(conn, iov[i].data, iov[i].len,
+                flush && i == iovcnt - 1, mem_available);
+    }
+    return res;
+}
+
 /**
  * \brief           Get total number of bytes ever received on connection and sent to user
  * \param[in]       conn: Connection handle
@@ -726,6 +1448,54 @@ esp_conn_get_total_recved_count(esp_conn_p conn) {
     return tot;
 }
 
+#if ESP_CFG_CONN_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get send and receive statistics of connection
+ * \note            Statistics are reset when connection becomes active
+ * \param[in]       conn: Connection handle
+ * \param[out]      stats: Output variable to save statistics to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_get_stats(esp_conn_p conn, esp_conn_stats_t* stats) {
+    ESP_ASSERT("conn != NULL", conn != NULL);
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &conn->stats, sizeof(*stats));
+    stats->bytes_recved = conn->total_recved;
+    stats->latency_avg = stats->send_ok_cnt > 0 ? conn->latency_sum / stats->send_ok_cnt : 0;
+#if ESP_CFG_CONN_SEND_PACING
+    stats->seg_len = conn->send_seg_len > 0 ? conn->send_seg_len : ESP_CFG_CONN_MAX_DATA_LEN;
+    stats->backoff = conn->send_backoff;
+#else /* ESP_CFG_CONN_SEND_PACING */
+    stats->seg_len = ESP_CFG_CONN_MAX_DATA_LEN;
+#endif /* !ESP_CFG_CONN_SEND_PACING */
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Clear send statistics of connection
+ * \note            Number of received bytes is not cleared, it is total of connection,
+ *                  also returned by \ref esp_conn_get_total_recved_count
+ * \param[in]       conn: Connection handle
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_conn_reset_stats(esp_conn_p conn) {
+    ESP_ASSERT("conn != NULL", conn != NULL);
+
+    esp_core_lock();
+    ESP_MEMSET(&conn->stats, 0x00, sizeof(conn->stats));
+    conn->latency_sum = 0;
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* ESP_CFG_CONN_STATS || __DOXYGEN__ */
+
 /**
  * \brief           Get connection remote IP address
  * \param[in]       conn: Connection handle
@@ -735,9 +1505,7 @@ esp_conn_get_total_recved_count(esp_conn_p conn) {
 uint8_t
 esp_conn_get_remote_ip(esp_conn_p conn, esp_ip_t* ip) {
     if (conn != NULL && ip != NULL) {
-        esp_core_lock();
-        ESP_MEMCPY(ip, &conn->remote_ip, sizeof(*ip));  /* Copy data */
-        esp_core_unlock();
+        ESP_CORE_SEQ_READ(ESP_MEMCPY(ip, &conn->remote_ip, sizeof(*ip)));   /* Copy data */
         return 1;
     }
     return 0;
@@ -752,9 +1520,9 @@ esp_port_t
 esp_conn_get_remote_port(esp_conn_p conn) {
     esp_port_t port = 0;
     if (conn != NULL) {
-        esp_core_lock();
+        ESP_CORE_READ_LOCK();
         port = conn->remote_port;
-        esp_core_unlock();
+        ESP_CORE_READ_UNLOCK();
     }
     return port;
 }
@@ -768,9 +1536,9 @@ esp_port_t
 esp_conn_get_local_port(esp_conn_p conn) {
     esp_port_t port = 0;
     if (conn != NULL) {
-        esp_core_lock();
+        ESP_CORE_READ_LOCK();
         port = conn->local_port;
-        esp_core_unlock();
+        ESP_CORE_READ_UNLOCK();
     }
     return port;
 }
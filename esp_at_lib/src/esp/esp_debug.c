@@ -47,4 +47,80 @@ espi_dbg_msg_to_string(esp_cmd_t cmd) {
     return "";
 }
 
+#if ESP_CFG_DBG_TRACE || __DOXYGEN__
+
+/**
+ * \brief           Debug trace ring
+ */
+static struct {
+    uint32_t magic;                             /*!< Marker to find ring in memory dump */
+    uint32_t len;                               /*!< Number of records in ring */
+    volatile uint32_t idx;                      /*!< Number of records written since reset */
+    esp_dbg_trace_rec_t recs[ESP_CFG_DBG_TRACE_LEN];/*!< Trace records */
+} dbg_trace = {
+    .magic = 0x54505345UL,                      /* "ESPT" in little endian */
+    .len = ESP_CFG_DBG_TRACE_LEN,
+};
+
+/**
+ * \brief           Store new record to debug trace ring
+ *
+ * Slot is reserved with atomic increment, so function may be called
+ * from any thread or interrupt without locking
+ *
+ * \param[in]       fmt: Format string address
+ * \param[in]       args: Arguments converted to `32-bit` integers
+ * \param[in]       nargs: Number of arguments
+ */
+void
+espi_dbg_trace(const char* fmt, const uint32_t* args, size_t nargs) {
+    esp_dbg_trace_rec_t* rec;
+    uint32_t seq;
+
+#if defined(__GNUC__) || defined(__clang__)
+    seq = __atomic_fetch_add(&dbg_trace.idx, 1, __ATOMIC_RELAXED);
+#else
+    seq = dbg_trace.idx++;
+#endif /* defined(__GNUC__) || defined(__clang__) */
+    rec = &dbg_trace.recs[seq & (ESP_CFG_DBG_TRACE_LEN - 1)];
+    rec->seq = 0;                               /* Mark record as being written */
+    rec->time = (uint32_t)ESP_CFG_DBG_TRACE_TIME();
+    rec->fmt = fmt;
+    rec->nargs = (uint32_t)nargs;
+    for (size_t i = 0; i < nargs; ++i) {
+        rec->args[i] = args[i];
+    }
+    rec->seq = seq + 1;
+}
+
+/**
+ * \brief           Output raw debug trace ring for offline decoding on host
+ *
+ * Output starts with `12` bytes of header (magic `ESPT`, number of records, write index),
+ * followed by all records in ring order. Record is valid when `seq` is not `0`,
+ * format strings are resolved with symbol table and read-only data of firmware image
+ *
+ * \note            Records written during dump may appear incomplete
+ * \param[in]       out_fn: Function to output data
+ */
+void
+esp_dbg_trace_dump(esp_dbg_trace_out_fn out_fn) {
+    if (out_fn == NULL) {
+        return;
+    }
+    out_fn(&dbg_trace, 3 * sizeof(uint32_t));
+    out_fn(dbg_trace.recs, sizeof(dbg_trace.recs));
+}
+
+/**
+ * \brief           Clear all records from debug trace ring
+ */
+void
+esp_dbg_trace_reset(void) {
+    ESP_MEMSET(dbg_trace.recs, 0x00, sizeof(dbg_trace.recs));
+    dbg_trace.idx = 0;
+}
+
+#endif /* ESP_CFG_DBG_TRACE || __DOXYGEN__ */
+
 #endif /* ESP_CFG_DBG || __DOXYGEN__ */
@@ -37,6 +37,111 @@
 
 #if ESP_CFG_DNS || __DOXYGEN__
 
+#if ESP_CFG_DNS_CACHE_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           DNS cache entry
+ */
+typedef struct {
+    char host[ESP_CFG_DNS_CACHE_HOST_LEN];      /*!< Host name, empty when entry is not used */
+    esp_ip_t ip;                                /*!< Resolved IP address */
+    uint32_t time;                              /*!< Time when entry was stored */
+    uint32_t used;                              /*!< Time of last use */
+} esp_dns_cache_entry_t;
+
+static esp_dns_cache_entry_t dns_cache[ESP_CFG_DNS_CACHE_SIZE];
+
+/**
+ * \brief           Check if host is IP address in string format
+ * \param[in]       host: Host name to check
+ * \return          `1` if host contains only digits and dots, `0` otherwise
+ */
+static uint8_t
+dns_cache_is_ip(const char* host) {
+    for (; *host != '\0'; ++host) {
+        if (!ESP_CHARISNUM(*host) && *host != '.') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Get IP address of host from DNS cache
+ * \note            Core must be locked before calling this function
+ * \param[in]       host: Host name to search for
+ * \param[out]      ip: Pointer to \ref esp_ip_t variable to save IP
+ * \return          `1` on valid cache hit, `0` otherwise
+ */
+uint8_t
+espi_dns_cache_get(const char* host, esp_ip_t* ip) {
+    uint32_t now = esp_sys_now();
+
+    for (size_t i = 0; i < ESP_ARRAYSIZE(dns_cache); ++i) {
+        esp_dns_cache_entry_t* e = &dns_cache[i];
+        if (e->host[0] != '\0' && !strcmp(e->host, host)) {
+            if ((uint32_t)(now - e->time) >= ESP_CFG_DNS_CACHE_TTL) {
+                e->host[0] = '\0';             /* Entry expired, release it */
+                return 0;
+            }
+            e->used = now;
+            ESP_MEMCPY(ip, &e->ip, sizeof(*ip));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Save resolved IP address of host to DNS cache
+ *
+ * Existing entry is refreshed, otherwise free or least recently used entry is replaced
+ *
+ * \note            Core must be locked before calling this function
+ * \param[in]       host: Host name
+ * \param[in]       ip: Resolved IP address
+ */
+void
+espi_dns_cache_put(const char* host, const esp_ip_t* ip) {
+    esp_dns_cache_entry_t* e = NULL;
+    uint32_t now = esp_sys_now();
+    size_t len = strlen(host);
+
+    if (len == 0 || len >= ESP_CFG_DNS_CACHE_HOST_LEN || dns_cache_is_ip(host)
+        || (ip->ip[0] == 0 && ip->ip[1] == 0 && ip->ip[2] == 0 && ip->ip[3] == 0)) {
+        return;                                 /* Not a name or no valid address */
+    }
+    for (size_t i = 0; i < ESP_ARRAYSIZE(dns_cache); ++i) {
+        esp_dns_cache_entry_t* c = &dns_cache[i];
+        if (c->host[0] != '\0' && !strcmp(c->host, host)) {
+            e = c;                              /* Refresh existing entry */
+            break;
+        }
+        if (e == NULL || (e->host[0] != '\0'
+            && (c->host[0] == '\0' || (uint32_t)(now - c->used) > (uint32_t)(now - e->used)))) {
+            e = c;                              /* Free or least recently used entry */
+        }
+    }
+    ESP_MEMCPY(e->host, host, len + 1);
+    ESP_MEMCPY(&e->ip, ip, sizeof(e->ip));
+    e->time = now;
+    e->used = now;
+}
+
+/**
+ * \brief           Remove all entries from DNS cache
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_dns_cache_flush(void) {
+    esp_core_lock();
+    ESP_MEMSET(dns_cache, 0x00, sizeof(dns_cache));
+    esp_core_unlock();
+    return espOK;
+}
+
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 || __DOXYGEN__ */
+
 /**
  * \brief           Get IP address from host name
  * \param[in]       host: Pointer to host name to get IP for
@@ -54,6 +159,22 @@ esp_dns_gethostbyname(const char* host, esp_ip_t* const ip,
     ESP_ASSERT("host != NULL", host != NULL);
     ESP_ASSERT("ip != NULL", ip != NULL);
 
+#if ESP_CFG_DNS_CACHE_SIZE > 0
+    esp_core_lock();
+    if (espi_dns_cache_get(host, ip)) {         /* Resolve from cache without AT command */
+        esp.evt.evt.dns_hostbyname.res = espOK;
+        esp.evt.evt.dns_hostbyname.host = host;
+        esp.evt.evt.dns_hostbyname.ip = ip;
+        espi_send_cb(ESP_EVT_DNS_HOSTBYNAME);
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPDOMAIN;
@@ -63,6 +184,72 @@ esp_dns_gethostbyname(const char* host, esp_ip_t* const ip,
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 20000);
 }
 
+/**
+ * \brief           Get IP addresses for multiple host names with single command sequence
+ *
+ * Names are resolved one after another inside one message, without other commands in between.
+ * \ref ESP_EVT_DNS_HOSTBYNAME event is sent for every name when its result is known
+ *
+ * \param[in]       hosts: Array of host names to get IP for
+ * \param[out]      ips: Array of `cnt` \ref esp_ip_t variables to save IP addresses
+ * \param[out]      res: Array of `cnt` results, \ref espOK for every successfully resolved name.
+ *                      Entry is set to \ref espCONT while name is not resolved yet
+ * \param[in]       cnt: Number of host names
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK when all names were resolved, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_dns_gethostbyname_multi(const char* const* hosts, esp_ip_t* ips, espr_t* res, size_t cnt,
+                        const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    size_t first = cnt;
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("hosts != NULL", hosts != NULL);
+    ESP_ASSERT("ips != NULL", ips != NULL);
+    ESP_ASSERT("res != NULL", res != NULL);
+    ESP_ASSERT("cnt > 0", cnt > 0);
+
+    esp_core_lock();
+    for (size_t i = 0; i < cnt; ++i) {
+        res[i] = espCONT;
+#if ESP_CFG_DNS_CACHE_SIZE > 0
+        if (espi_dns_cache_get(hosts[i], &ips[i])) {
+            res[i] = espOK;
+            esp.evt.evt.dns_hostbyname.res = espOK;
+            esp.evt.evt.dns_hostbyname.host = hosts[i];
+            esp.evt.evt.dns_hostbyname.ip = &ips[i];
+            espi_send_cb(ESP_EVT_DNS_HOSTBYNAME);
+            continue;
+        }
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 */
+        if (first == cnt) {
+            first = i;                          /* First name to resolve with command */
+        }
+    }
+    esp_core_unlock();
+    if (first == cnt) {                         /* All names resolved from cache */
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPDOMAIN;
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.host = hosts[first];
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.ip = &ips[first];
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.hosts = hosts;
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.ips = ips;
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.res = res;
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.cnt = cnt;
+    ESP_MSG_VAR_REF(msg).msg.dns_getbyhostname.idx = first;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 20000 * (uint32_t)(cnt - first));
+}
+
 /**
  * \brief           Enable or disable custom DNS server configuration
  *
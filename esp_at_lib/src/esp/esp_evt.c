@@ -35,6 +35,15 @@
 #include "esp/esp_evt.h"
 #include "esp/esp_mem.h"
 
+#if ESP_CFG_MEM_STATIC
+ESP_MEM_POOL_DEFINE(evt_func_pool, sizeof(esp_evt_func_t), ESP_CFG_MEM_STATIC_EVT_FUNCS);
+#define EVT_FUNC_ALLOC()                espi_mem_pool_alloc(&evt_func_pool)
+#define EVT_FUNC_FREE(func)             espi_mem_pool_free(&evt_func_pool, (func))
+#else /* ESP_CFG_MEM_STATIC */
+#define EVT_FUNC_ALLOC()                esp_mem_malloc(sizeof(esp_evt_func_t))
+#define EVT_FUNC_FREE(func)             esp_mem_free(func)
+#endif /* !ESP_CFG_MEM_STATIC */
+
 /**
  * \brief           Register event function for global (non-connection based) events
  * \param[in]       fn: Callback function to call on specific event
@@ -42,6 +51,22 @@
  */
 espr_t
 esp_evt_register(esp_evt_fn fn) {
+    return esp_evt_register_ex(fn, ESP_EVT_MASK_ALL);
+}
+
+/**
+ * \brief           Register event function for selected global (non-connection based) events
+ *
+ * Function is called only for events with bit set in mask,
+ * other events are skipped during dispatch
+ *
+ * \param[in]       fn: Callback function to call on specific event
+ * \param[in]       mask: Mask of events to receive, combine \ref ESP_EVT_MASK values
+ *                      or use \ref ESP_EVT_MASK_ALL for all events
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_evt_register_ex(esp_evt_fn fn, uint32_t mask) {
     espr_t res = espOK;
     esp_evt_func_t* func, *newFunc;
 
@@ -58,16 +83,17 @@ esp_evt_register(esp_evt_fn fn) {
     }
 
     if (res == espOK) {
-        newFunc = esp_mem_malloc(sizeof(*newFunc));
+        newFunc = EVT_FUNC_ALLOC();
         if (newFunc != NULL) {
             ESP_MEMSET(newFunc, 0x00, sizeof(*newFunc));
             newFunc->fn = fn;                   /* Set function pointer */
+            newFunc->mask = mask;               /* Set event mask */
             for (func = esp.evt_func; func != NULL && func->next != NULL; func = func->next) {}
             if (func != NULL) {
                 func->next = newFunc;           /* Set new function as next */
                 res = espOK;
             } else {
-                esp_mem_free_s((void**)& newFunc);
+                EVT_FUNC_FREE(newFunc);
                 res = espERRMEM;
             }
         } else {
@@ -94,7 +120,7 @@ esp_evt_unregister(esp_evt_fn fn) {
     for (prev = esp.evt_func, func = esp.evt_func->next; func != NULL; prev = func, func = func->next) {
         if (func->fn == fn) {
             prev->next = func->next;
-            esp_mem_free_s((void **)&func);
+            EVT_FUNC_FREE(func);
             break;
         }
     }
@@ -142,6 +168,30 @@ esp_evt_restore_get_result(esp_evt_t* cc) {
     return cc->evt.restore.res;
 }
 
+#if ESP_CFG_RX_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get total number of receive buffer overflows
+ * \param[in]       cc: Event handle
+ * \return          Number of truncated writes since statistics reset
+ */
+uint32_t
+esp_evt_rx_overflow_get_count(esp_evt_t* cc) {
+    return cc->evt.rx_overflow.overflows;
+}
+
+/**
+ * \brief           Get total number of bytes dropped on receive buffer overflow
+ * \param[in]       cc: Event handle
+ * \return          Number of dropped bytes since statistics reset
+ */
+uint32_t
+esp_evt_rx_overflow_get_dropped(esp_evt_t* cc) {
+    return cc->evt.rx_overflow.dropped;
+}
+
+#endif /* ESP_CFG_RX_STATS || __DOXYGEN__ */
+
 #if ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__
 
 /**
@@ -358,6 +408,8 @@ esp_evt_conn_error_get_arg(esp_evt_t* cc) {
 
 #if ESP_CFG_MODE_STATION || __DOXYGEN__
 
+#if ESP_CFG_STA_LIST_AP || __DOXYGEN__
+
 /**
  * \brief           Get command success result
  * \param[in]       cc: Event handle
@@ -388,6 +440,19 @@ esp_evt_sta_list_ap_get_length(esp_evt_t* cc) {
     return cc->evt.sta_list_ap.len;
 }
 
+/**
+ * \brief           Get access point found during streaming scan
+ * \note            Valid only during event callback, copy data if needed later
+ * \param[in]       cc: Event handle
+ * \return          Pointer to access point
+ */
+esp_ap_t*
+esp_evt_sta_list_ap_entry_get_ap(esp_evt_t* cc) {
+    return cc->evt.sta_list_ap_entry.ap;
+}
+
+#endif /* ESP_CFG_STA_LIST_AP || __DOXYGEN__ */
+
 /**
  * \brief           Get command success result
  * \param[in]       cc: Event handle
@@ -518,6 +583,144 @@ esp_evt_ping_get_time(esp_evt_t* cc) {
 
 #endif /* ESP_CFG_PING || __DOXYGEN__ */
 
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+
+/**
+ * \brief           Get stage of software update
+ * \param[in]       cc: Event handle
+ * \return          Update stage reported by device
+ */
+int32_t
+esp_evt_update_progress_get_stage(esp_evt_t* cc) {
+    return cc->evt.update_progress.stage;
+}
+
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+
+#if ESP_CFG_UPDATE_ASYNC || __DOXYGEN__
+
+/**
+ * \brief           Get result of background software update
+ * \param[in]       cc: Event handle
+ * \return          \ref espOK when device accepted new software, \ref espTIMEOUT when
+ *                      update did not finish in \ref ESP_CFG_UPDATE_TIMEOUT, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_evt_update_get_result(esp_evt_t* cc) {
+    return cc->evt.update.res;
+}
+
+#endif /* ESP_CFG_UPDATE_ASYNC || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+
+/**
+ * \brief           Check if MQTT connection on ESP device is connected to broker
+ * \param[in]       cc: Event handle
+ * \return          `1` when connected, `0` otherwise
+ */
+uint8_t
+esp_evt_mqtt_at_conn_is_connected(esp_evt_t* cc) {
+    return cc->evt.mqtt_at_conn.connected;
+}
+
+/**
+ * \brief           Get topic of received MQTT message
+ * \param[in]       cc: Event handle
+ * \return          `NULL`-terminated topic
+ */
+const char*
+esp_evt_mqtt_at_recv_get_topic(esp_evt_t* cc) {
+    return cc->evt.mqtt_at_recv.topic;
+}
+
+/**
+ * \brief           Get topic length of received MQTT message
+ * \param[in]       cc: Event handle
+ * \return          Topic length in units of bytes
+ */
+size_t
+esp_evt_mqtt_at_recv_get_topic_len(esp_evt_t* cc) {
+    return cc->evt.mqtt_at_recv.topic_len;
+}
+
+/**
+ * \brief           Get data of received MQTT message
+ * \param[in]       cc: Event handle
+ * \return          Pointer to message data
+ */
+const void*
+esp_evt_mqtt_at_recv_get_data(esp_evt_t* cc) {
+    return cc->evt.mqtt_at_recv.data;
+}
+
+/**
+ * \brief           Get data length of received MQTT message
+ * \param[in]       cc: Event handle
+ * \return          Data length in units of bytes
+ */
+size_t
+esp_evt_mqtt_at_recv_get_len(esp_evt_t* cc) {
+    return cc->evt.mqtt_at_recv.len;
+}
+
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+
+#if ESP_CFG_BLE || __DOXYGEN__
+
+/**
+ * \brief           Get BLE connection index of client which connected or disconnected
+ * \param[in]       cc: Event handle
+ * \return          BLE connection index
+ */
+uint8_t
+esp_evt_ble_conn_get_conn(esp_evt_t* cc) {
+    return cc->evt.ble_conn.conn;
+}
+
+/**
+ * \brief           Get address of BLE client which connected or disconnected
+ * \param[in]       cc: Event handle
+ * \return          Client address
+ */
+const esp_mac_t*
+esp_evt_ble_conn_get_mac(esp_evt_t* cc) {
+    return &cc->evt.ble_conn.mac;
+}
+
+/**
+ * \brief           Check if BLE client connected or disconnected
+ * \param[in]       cc: Event handle
+ * \return          `1` when connected, `0` when disconnected
+ */
+uint8_t
+esp_evt_ble_conn_is_connected(esp_evt_t* cc) {
+    return cc->evt.ble_conn.connected;
+}
+
+/**
+ * \brief           Get BLE connection index of client which wrote data
+ * \param[in]       cc: Event handle
+ * \return          BLE connection index
+ */
+uint8_t
+esp_evt_ble_recv_get_conn(esp_evt_t* cc) {
+    return cc->evt.ble_recv.conn;
+}
+
+/**
+ * \brief           Get buffer with data written by BLE client
+ * \note            Buffer is freed after event, use \ref esp_pbuf_ref to keep it
+ * \param[in]       cc: Event handle
+ * \return          Packet buffer handle
+ */
+esp_pbuf_p
+esp_evt_ble_recv_get_buff(esp_evt_t* cc) {
+    return cc->evt.ble_recv.buff;
+}
+
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+
 
 /**
  * \brief           Get server command result
@@ -77,6 +77,23 @@ esp_hostname_get(char* hostname, size_t size,
     ESP_ASSERT("hostname != NULL", hostname != NULL);
     ESP_ASSERT("size > 0", size > 0);
 
+#if ESP_CFG_GETTER_CACHE
+    esp_core_lock();
+    if (esp.m.cache_valid & ESP_CACHE_HOSTNAME) {
+        size_t i;
+        for (i = 0; i < (size - 1) && esp.m.hostname[i]; ++i) {
+            hostname[i] = esp.m.hostname[i];
+        }
+        hostname[i] = 0;
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_GETTER_CACHE */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CWHOSTNAME_GET;
@@ -0,0 +1,82 @@
+/**
+ * \file            esp_http_at.c
+ * \brief           HTTP client command of ESP32 AT firmware
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_http_at.h"
+#include "esp/esp_mem.h"
+
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+
+/**
+ * \brief           Execute HTTP request on device
+ * \note            URL, data and headers must stay valid until command finishes
+ * \param[in]       method: Request method
+ * \param[in]       content_type: Content type of request body
+ * \param[in]       url: Full request URL, `http://` or `https://` scheme
+ * \param[in]       data: Request body string. Set to `NULL` when not used
+ * \param[in]       headers: Request header lines, each `NULL`-terminated, one after another.
+ *                      Set to `NULL` when not used
+ * \param[in]       headers_cnt: Number of header lines in `headers`
+ * \param[in]       data_fn: Callback function called from processing thread for each part of response body.
+ *                      Set to `NULL` when not used
+ * \param[in]       data_arg: Custom argument for data callback function
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_http_at_request(esp_http_at_method_t method, esp_http_at_content_type_t content_type, const char* url, const char* data,
+                    const char* headers, size_t headers_cnt, esp_http_at_data_fn data_fn, void* const data_arg,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("url != NULL", url != NULL);
+    ESP_ASSERT("headers != NULL || !headers_cnt", headers != NULL || headers_cnt == 0);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_HTTPCLIENT;
+    ESP_MSG_VAR_REF(msg).msg.http_at.method = (uint8_t)method;
+    ESP_MSG_VAR_REF(msg).msg.http_at.content_type = (uint8_t)content_type;
+    ESP_MSG_VAR_REF(msg).msg.http_at.url = url;
+    ESP_MSG_VAR_REF(msg).msg.http_at.data = data;
+    ESP_MSG_VAR_REF(msg).msg.http_at.headers = headers;
+    ESP_MSG_VAR_REF(msg).msg.http_at.headers_cnt = headers_cnt;
+    ESP_MSG_VAR_REF(msg).msg.http_at.data_fn = data_fn;
+    ESP_MSG_VAR_REF(msg).msg.http_at.data_arg = data_arg;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 30000);
+}
+
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
@@ -36,9 +36,6 @@
 #include "esp/esp_input.h"
 #include "esp/esp_buff.h"
 
-static uint32_t esp_recv_total_len;
-static uint32_t esp_recv_calls;
-
 #if !ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__
 
 /**
@@ -50,16 +47,91 @@ static uint32_t esp_recv_calls;
  */
 espr_t
 esp_input(const void* data, size_t len) {
+#if ESP_CFG_RX_STATS
+    size_t written, full;
+#endif /* ESP_CFG_RX_STATS */
+
     if (!esp.status.f.initialized || esp.buff.buff == NULL) {
         return espERR;
     }
+#if ESP_CFG_LATENCY_TRACE
+    if (!esp.trace_rx_pending) {                /* Stamp oldest data only, processing thread clears the flag */
+        esp.trace_rx_time = esp_sys_now();
+        esp.trace_rx_pending = 1;
+    }
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_RX_STATS
+    written = esp_buff_write(&esp.buff, data, len); /* Write data to buffer */
+    if (written < len) {                        /* Buffer is full, rest of data is lost */
+        ++esp.rx_stats.overflows;
+        esp.rx_stats.dropped += (uint32_t)(len - written);
+    }
+    full = esp_buff_get_full(&esp.buff);
+    if (full > esp.rx_stats.high_water) {
+        esp.rx_stats.high_water = full;
+    }
+#else /* ESP_CFG_RX_STATS */
     esp_buff_write(&esp.buff, data, len);       /* Write data to buffer */
-    esp_sys_mbox_putnow(&esp.mbox_process, NULL);   /* Write empty box, don't care if write fails */
-    esp_recv_total_len += len;                  /* Update total number of received bytes */
-    ++esp_recv_calls;                           /* Update number of calls */
+#endif /* !ESP_CFG_RX_STATS */
+
+#if ESP_CFG_INPUT_FLOW_CTRL
+    /* Pause device before buffer overflows, processing thread resumes it */
+    if (!esp.input_paused && esp.ll.flow_fn != NULL
+        && esp_buff_get_full(&esp.buff) >= ESP_CFG_INPUT_FLOW_HIGH) {
+        esp.input_paused = 1;
+        esp.ll.flow_fn(1);
+    }
+#endif /* ESP_CFG_INPUT_FLOW_CTRL */
+
+    /*
+     * Notify process thread only if previous notification was already consumed.
+     * Thread drains complete buffer in one wakeup, so posting for every chunk
+     * only floods the mbox. Write may only fail when mbox is full,
+     * in which case thread is already about to wake up and clear the flag.
+     * Without OS, data are processed in next esp_poll call
+     */
+#if ESP_CFG_OS
+    if (!esp.input_wakeup_pending) {
+        esp.input_wakeup_pending = 1;
+        esp_sys_mbox_putnow(&esp.mbox_process, NULL);   /* Write empty box, don't care if write fails */
+    }
+#endif /* ESP_CFG_OS */
+    esp.recv_total_len += len;                  /* Update total number of received bytes */
+    ++esp.recv_calls;                           /* Update number of calls */
     return espOK;
 }
 
+#if ESP_CFG_RX_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get receive buffer overflow statistics
+ * \param[out]      stats: Output variable to save statistics to
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_input_get_stats(esp_rx_stats_t* stats) {
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &esp.rx_stats, sizeof(*stats));
+    stats->size = esp.buff.size > 0 ? esp.buff.size - 1 : 0;
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Clear receive buffer statistics and restart high-water mark tracking
+ */
+void
+esp_input_reset_stats(void) {
+    esp_core_lock();
+    ESP_MEMSET(&esp.rx_stats, 0x00, sizeof(esp.rx_stats));
+    esp.rx_overflows_reported = 0;
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_RX_STATS || __DOXYGEN__ */
+
 #endif /* !ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__ */
 
 #if ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__
@@ -83,15 +155,69 @@ esp_input_process(const void* data, size_t len) {
         return espERR;
     }
 
-    esp_recv_total_len += len;                  /* Update total number of received bytes */
-    ++esp_recv_calls;                           /* Update number of calls */
+    esp.recv_total_len += len;                  /* Update total number of received bytes */
+    ++esp.recv_calls;                           /* Update number of calls */
 
     if (len > 0) {
         esp_core_lock();
+#if ESP_CFG_LATENCY_TRACE
+        esp.trace_rx_cur = esp_sys_now();       /* Data are processed immediately */
+#endif /* ESP_CFG_LATENCY_TRACE */
         res = espi_process(data, len);          /* Process input data */
         esp_core_unlock();
     }
     return res;
 }
 
+#if ESP_CFG_INPUT_FRAMED || __DOXYGEN__
+
+/**
+ * \brief           Process typed fragments received from framed transport
+ *
+ * Command fragments are processed by AT parser, same as with \ref esp_input_process.
+ * Data fragments are delivered to connection as packet buffers without parsing
+ *
+ * \note            \ref ESP_CFG_INPUT_FRAMED must be enabled to use this function
+ * \param[in]       frags: Array of fragments in order of reception
+ * \param[in]       cnt: Number of fragments in array
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise.
+ *                      All fragments are processed, result of first failed one is returned
+ */
+espr_t
+esp_input_process_frag(const esp_input_frag_t* frags, size_t cnt) {
+    espr_t res = espOK;
+
+    ESP_ASSERT("frags != NULL", frags != NULL || cnt == 0);
+
+    if (!esp.status.f.initialized) {
+        return espERR;
+    }
+
+    ++esp.recv_calls;                           /* Update number of calls */
+    esp_core_lock();
+#if ESP_CFG_LATENCY_TRACE
+    esp.trace_rx_cur = esp_sys_now();           /* Data are processed immediately */
+#endif /* ESP_CFG_LATENCY_TRACE */
+    for (size_t i = 0; i < cnt; ++i) {
+        espr_t r;
+
+        esp.recv_total_len += frags[i].len;     /* Update total number of received bytes */
+        if (frags[i].len == 0) {
+            continue;
+        }
+        if (frags[i].type == ESP_INPUT_FRAG_DATA) {
+            r = espi_process_conn_data(frags[i].conn_num, frags[i].data, frags[i].len);
+        } else {
+            r = espi_process(frags[i].data, frags[i].len);
+        }
+        if (r != espOK && res == espOK) {
+            res = r;                            /* Keep first error, continue with next fragment */
+        }
+    }
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_INPUT_FRAMED || __DOXYGEN__ */
+
 #endif /* ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__ */
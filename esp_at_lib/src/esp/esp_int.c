@@ -36,31 +36,47 @@
 #include "esp/esp_int.h"
 #include "esp/esp_mem.h"
 #include "esp/esp_parser.h"
+#include "esp/esp_timeout.h"
 #include "esp/esp_unicode.h"
 #include "system/esp_ll.h"
 
 #if !__DOXYGEN__
+/* Receive character macros */
+#if ESP_CFG_RECV_LINE_HANDLERS > 0
+#define RECV_OVERFLOW()                     espi_recv_line_overflow()
+#else /* ESP_CFG_RECV_LINE_HANDLERS > 0 */
+#define RECV_OVERFLOW()                     0
+#endif /* !(ESP_CFG_RECV_LINE_HANDLERS > 0) */
+#define RECV_ADD(ch)                        do { if (esp.recv_buff.len >= (sizeof(esp.recv_buff.data)) - 1) { (void)RECV_OVERFLOW(); } if (esp.recv_buff.len < (sizeof(esp.recv_buff.data)) - 1) { esp.recv_buff.data[esp.recv_buff.len++] = ch; esp.recv_buff.data[esp.recv_buff.len] = 0; } } while (0)
+#define RECV_RESET()                        do { esp.recv_buff.len = 0; esp.recv_buff.data[0] = 0; } while (0)
+#define RECV_LEN()                          ((size_t)esp.recv_buff.len)
+#define RECV_IDX(index)                     esp.recv_buff.data[index]
+
 /**
- * \brief           Receive character structure to handle full line terminated with `\n` character
+ * \brief           Bit map of characters without special meaning in command mode.
+ *
+ * Valid ASCII characters except `\n`, `,`, `:` and `>`,
+ * which may end line or start data or prompt processing
  */
-typedef struct {
-    char data[128];                             /*!< Received characters */
-    size_t len;                                 /*!< Length of valid characters */
-} esp_recv_t;
-
-/* Receive character macros */
-#define RECV_ADD(ch)                        do { if (recv_buff.len < (sizeof(recv_buff.data)) - 1) { recv_buff.data[recv_buff.len++] = ch; recv_buff.data[recv_buff.len] = 0; } } while (0)
-#define RECV_RESET()                        do { recv_buff.len = 0; recv_buff.data[0] = 0; } while (0)
-#define RECV_LEN()                          ((size_t)recv_buff.len)
-#define RECV_IDX(index)                     recv_buff.data[index]
+static const uint32_t plain_chr_map[8] = {
+    0x00002000, 0xBBFFEFFF, 0xFFFFFFFF, 0x7FFFFFFF, 0, 0, 0, 0
+};
+#define IS_PLAIN_CHR(c)                     ((plain_chr_map[(c) >> 5] & (1UL << ((c) & 0x1F))) != 0)
 
 /* Send data over AT port */
-#define AT_PORT_SEND_STR(str)               esp.ll.send_fn((const void *)(str), (size_t)strlen(str))
-#define AT_PORT_SEND_CONST_STR(str)         esp.ll.send_fn((const void *)(str), (size_t)(sizeof(str) - 1))
-#define AT_PORT_SEND_CHR(str)               esp.ll.send_fn((const void *)(str), (size_t)1)
+#define AT_PORT_SEND_LL(d, l)               do { size_t at_len = (size_t)(l); esp.send_total_len += (uint32_t)at_len; ++esp.send_calls; esp.ll.send_fn((const void *)(d), at_len); } while (0)
+#if ESP_CFG_AT_PORT_TX_BUFF_SIZE
+#define AT_PORT_SEND(d, l)                  at_port_send((const void *)(d), (size_t)(l))
+#define AT_PORT_SEND_FLUSH()                at_port_flush()
+#define AT_PORT_SEND_WITH_FLUSH(d, l)       do { at_port_send_buff(); AT_PORT_SEND_LL((d), (l)); esp.ll.send_fn(NULL, 0); } while (0)
+#else /* ESP_CFG_AT_PORT_TX_BUFF_SIZE */
+#define AT_PORT_SEND(d, l)                  AT_PORT_SEND_LL((d), (l))
 #define AT_PORT_SEND_FLUSH()                esp.ll.send_fn(NULL, 0)
-#define AT_PORT_SEND(d, l)                  esp.ll.send_fn((const void *)(d), (size_t)(l))
 #define AT_PORT_SEND_WITH_FLUSH(d, l)       do { AT_PORT_SEND((d), (l)); AT_PORT_SEND_FLUSH(); } while (0)
+#endif /* !ESP_CFG_AT_PORT_TX_BUFF_SIZE */
+#define AT_PORT_SEND_STR(str)               AT_PORT_SEND((str), strlen(str))
+#define AT_PORT_SEND_CONST_STR(str)         AT_PORT_SEND((str), sizeof(str) - 1)
+#define AT_PORT_SEND_CHR(str)               AT_PORT_SEND((str), 1)
 
 /* Beginning and end of every AT command */
 #define AT_PORT_SEND_BEGIN_AT()             do { AT_PORT_SEND_CONST_STR("AT"); } while (0)
@@ -72,8 +88,90 @@ typedef struct {
 #define AT_PORT_SEND_EQUAL_COND(e)          do { if ((e)) { AT_PORT_SEND_CONST_STR("="); } } while (0)
 #endif /* !__DOXYGEN__ */
 
-static esp_recv_t recv_buff;
 static espr_t espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t* is_ready);
+static void espi_process_cmd_result(uint8_t is_ok, uint8_t is_error, uint8_t is_ready);
+
+#if ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__
+
+/**
+ * \brief           Handle full receive buffer by passing it to registered line handler
+ * \return          `1` if buffer content was delivered and buffer is empty again, `0` otherwise
+ */
+static uint8_t
+espi_recv_line_overflow(void) {
+    if (esp.recv_line_stream == NULL) {         /* Find handler for new oversized line */
+        for (size_t i = 0; i < ESP_CFG_RECV_LINE_HANDLERS; ++i) {
+            esp_recv_line_handler_t* h = &esp.recv_line_handlers[i];
+            if (h->fn != NULL && esp.recv_buff.len >= h->prefix_len
+                && !strncmp(esp.recv_buff.data, h->prefix, h->prefix_len)) {
+                esp.recv_line_stream = h;
+                esp.recv_line_first = 1;
+                break;
+            }
+        }
+        if (esp.recv_line_stream == NULL) {
+            return 0;                           /* Nobody is interested, line is truncated */
+        }
+    }
+    esp.recv_line_stream->fn(esp.recv_buff.data, esp.recv_buff.len, esp.recv_line_first, 0, esp.recv_line_stream->arg);
+    esp.recv_line_first = 0;
+    RECV_RESET();
+    return 1;
+}
+
+#endif /* ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_AT_PORT_TX_BUFF_SIZE || __DOXYGEN__
+
+/**
+ * \brief           Pass collected command data to low-level driver
+ */
+static void
+at_port_send_buff(void) {
+    if (esp.at_tx_buff_len > 0) {
+        AT_PORT_SEND_LL(esp.at_tx_buff, esp.at_tx_buff_len);
+        esp.at_tx_buff_len = 0;
+    }
+}
+
+/**
+ * \brief           Add data to AT command buffer
+ * \param[in]       data: Data to send
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+at_port_send(const void* data, size_t len) {
+    const uint8_t* d = data;
+    size_t to_copy;
+
+    /* Large data do not fit buffer anyway, send them directly */
+    if (len >= sizeof(esp.at_tx_buff)) {
+        at_port_send_buff();
+        AT_PORT_SEND_LL(data, len);
+        return;
+    }
+    while (len > 0) {
+        to_copy = ESP_MIN(len, sizeof(esp.at_tx_buff) - esp.at_tx_buff_len);
+        ESP_MEMCPY(&esp.at_tx_buff[esp.at_tx_buff_len], d, to_copy);
+        esp.at_tx_buff_len += to_copy;
+        d += to_copy;
+        len -= to_copy;
+        if (esp.at_tx_buff_len == sizeof(esp.at_tx_buff)) {
+            at_port_send_buff();
+        }
+    }
+}
+
+/**
+ * \brief           Send collected data and flush low-level driver
+ */
+static void
+at_port_flush(void) {
+    at_port_send_buff();
+    esp.ll.send_fn(NULL, 0);
+}
+
+#endif /* ESP_CFG_AT_PORT_TX_BUFF_SIZE || __DOXYGEN__ */
 
 /**
  * \brief           Free connection send data memory
@@ -85,8 +183,13 @@ static espr_t espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_e
         if ((m)->msg.conn_send.data != NULL) {      \
             ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,   \
                 "[CONN] Free write buffer fau: %p\r\n", (void *)(m)->msg.conn_send.data);   \
-            esp_mem_free_s((void **)&((m)->msg.conn_send.data));\
+            espi_conn_buff_free((void *)(m)->msg.conn_send.data); \
+            (m)->msg.conn_send.data = NULL;         \
         }                                           \
+    } else if ((m) != NULL && (m)->msg.conn_send.release_fn != NULL) {  \
+        esp_conn_release_fn release_fn = (m)->msg.conn_send.release_fn; \
+        (m)->msg.conn_send.release_fn = NULL;       \
+        release_fn((m)->msg.conn_send.data, (m)->msg.conn_send.release_arg);    \
     }                                               \
 } while (0)
 
@@ -190,29 +293,23 @@ static espr_t espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_e
  */
 void
 espi_send_ip_mac(const void* d, uint8_t is_ip, uint8_t q, uint8_t c) {
-    uint8_t ch;
-    char str[4];
-    const esp_mac_t* mac = d;
-    const esp_ip_t* ip = d;
+    char str[20], *p = str;                     /* Comma, quotes and "AA:BB:CC:DD:EE:FF" */
 
-    AT_PORT_SEND_COMMA_COND(c);                 /* Send comma */
-    if (d == NULL) {
-        return;
+    if (c) {
+        *p++ = ',';                             /* Add comma */
     }
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
-    ch = is_ip ? '.' : ':';                     /* Get delimiter character */
-    for (uint8_t i = 0; i < (is_ip ? 4 : 6); ++i) { /* Process byte by byte */
-        if (is_ip) {                            /* In case of IP ... */
-            esp_u8_to_str(ip->ip[i], str);      /* ... go to decimal format ... */
-        } else {                                /* ... in case of MAC ... */
-            esp_u8_to_hex_str(mac->mac[i], str, 2); /* ... go to HEX format */
+    if (d != NULL) {
+        if (q) {
+            *p++ = '"';                         /* Add quote */
         }
-        AT_PORT_SEND_STR(str);                  /* Send str */
-        if (i < (is_ip ? 4 : 6) - 1) {          /* Check end if characters */
-            AT_PORT_SEND_CHR(&ch);              /* Send character */
+        p += espi_ip_mac_to_str(d, is_ip, p);   /* Format complete address at once */
+        if (q) {
+            *p++ = '"';                         /* Add quote */
         }
     }
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
+    if (p != str) {
+        AT_PORT_SEND(str, p - str);             /* Single send for complete field */
+    }
 }
 
 /**
@@ -244,6 +341,33 @@ espi_send_string(const char* str, uint8_t e, uint8_t q, uint8_t c) {
     AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
 }
 
+/**
+ * \brief           Send formatted decimal number with optional comma and quotes in one call
+ * \param[in]       num: Number to send, absolute value
+ * \param[in]       neg: Set to `1` to prefix number with `-`
+ * \param[in]       q: Value to indicate starting and ending quotes, enabled (`1`) or disabled (`0`)
+ * \param[in]       c: Set to `1` to include comma before string
+ */
+static void
+send_dec_field(uint32_t num, uint8_t neg, uint8_t q, uint8_t c) {
+    char str[16], *p = str;                     /* Comma, 2 quotes, sign and 10 digits */
+
+    if (c) {
+        *p++ = ',';
+    }
+    if (q) {
+        *p++ = '"';
+    }
+    if (neg) {
+        *p++ = '-';
+    }
+    p += espi_u32_to_dec_str(num, p);
+    if (q) {
+        *p++ = '"';
+    }
+    AT_PORT_SEND(str, p - str);
+}
+
 /**
  * \brief           Send number (decimal) to AT port
  * \param[in]       num: Number to send to AT port
@@ -252,14 +376,7 @@ espi_send_string(const char* str, uint8_t e, uint8_t q, uint8_t c) {
  */
 void
 espi_send_number(uint32_t num, uint8_t q, uint8_t c) {
-    char str[11];
-
-    esp_u32_to_str(num, str);                   /* Convert digit to decimal string */
-
-    AT_PORT_SEND_COMMA_COND(c);                 /* Send comma */
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
-    AT_PORT_SEND_STR(str);                      /* Send string with number */
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
+    send_dec_field(num, 0, q, c);
 }
 
 /**
@@ -270,14 +387,7 @@ espi_send_number(uint32_t num, uint8_t q, uint8_t c) {
  */
 void
 espi_send_port(esp_port_t port, uint8_t q, uint8_t c) {
-    char str[6];
-
-    esp_u16_to_str(ESP_PORT2NUM(port), str);    /* Convert digit to decimal string */
-
-    AT_PORT_SEND_COMMA_COND(c);                 /* Send comma */
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
-    AT_PORT_SEND_STR(str);                      /* Send string with number */
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
+    send_dec_field(ESP_U32(ESP_U16(ESP_PORT2NUM(port))), 0, q, c);
 }
 
 /**
@@ -288,14 +398,7 @@ espi_send_port(esp_port_t port, uint8_t q, uint8_t c) {
  */
 void
 espi_send_signed_number(int32_t num, uint8_t q, uint8_t c) {
-    char str[11];
-
-    esp_i32_to_str(num, str);                   /* Convert digit to decimal string */
-
-    AT_PORT_SEND_COMMA_COND(c);                 /* Send comma */
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
-    AT_PORT_SEND_STR(str);                      /* Send string with number */
-    AT_PORT_SEND_QUOTE_COND(q);                 /* Send quote */
+    send_dec_field(num < 0 ? (uint32_t)0 - ESP_U32(num) : ESP_U32(num), num < 0, q, c);
 }
 
 /**
@@ -309,203 +412,1703 @@ reset_connections(uint8_t forced) {
     esp.evt.evt.conn_active_close.forced = forced;
     esp.evt.evt.conn_active_close.res = espOK;
 
-    for (size_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {/* Check all connections */
-        if (esp.m.conns[i].status.f.active) {
-            esp.m.conns[i].status.f.active = 0;
+    while (esp.m.conns_active_mask) {           /* Visit active connections only */
+        esp_conn_t* c = &esp.m.conns[espi_bit_ffs(esp.m.conns_active_mask)];
 
-            esp.evt.evt.conn_active_close.conn = &esp.m.conns[i];
-            esp.evt.evt.conn_active_close.client = esp.m.conns[i].status.f.client;
-            espi_send_conn_cb(&esp.m.conns[i], NULL);   /* Send callback function */
-        }
+        ESP_CONN_SET_ACTIVE(c, 0);
+        esp.evt.evt.conn_active_close.conn = c;
+        esp.evt.evt.conn_active_close.client = c->status.f.client;
+        espi_send_conn_cb(c, NULL);             /* Send callback function */
     }
 }
 
 /**
- * \brief           Reset everything after reset was detected
- * \param[in]       forced: Set to `1` if reset forced by user
+ * \brief           Get baudrate to set with UART command
+ * \param[in]       msg: Current message
+ * \return          Baudrate in units of bits per second
  */
-void
-espi_reset_everything(uint8_t forced) {
-    /**
-     * \todo: Put stack to default state:
-     *          - Close all the connections in memory
-     *          - Clear entire data memory
-     *          - Reset esp structure with IP
-     *          - Start over init procedure
-     */
+static uint32_t
+espi_get_uart_cmd_baudrate(esp_msg_t* msg) {
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO
+    if (msg->cmd_def == ESP_CMD_RESET || msg->cmd_def == ESP_CMD_RESTORE) {
+        return msg->msg.reset.baudrate;         /* Baudrate negotiation in reset sequence */
+    }
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO */
+    return msg->msg.uart.baudrate;
+}
 
-    /* Step 1: Close all connections in memory */
-    reset_connections(forced);
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__
 
-#if ESP_CFG_MODE_STATION
-    esp.m.sta.has_ip = 0;
-    if (esp.m.sta.is_connected) {
-        espi_send_cb(ESP_EVT_WIFI_DISCONNECTED);
+/* List of baudrates to probe */
+static const uint32_t
+baudrate_auto_list[] = { ESP_CFG_AT_PORT_BAUDRATE_AUTO_LIST };
+
+/**
+ * \brief           Get next baudrate to probe
+ * \param[in]       baud: Current baudrate
+ * \return          Next higher baudrate supported by board or `0` if none
+ */
+static uint32_t
+espi_baudrate_auto_get_next(uint32_t baud) {
+    for (size_t i = 0; i < ESP_ARRAYSIZE(baudrate_auto_list); ++i) {
+        if (baudrate_auto_list[i] > baud
+            && (esp.ll.uart.max_baudrate == 0 || baudrate_auto_list[i] <= esp.ll.uart.max_baudrate)) {
+            return baudrate_auto_list[i];
+        }
     }
-    esp.m.sta.is_connected = 0;
-#endif /* ESP_CFG_MODE_STATION */
+    return 0;
+}
 
-    /* Check if IPD active */
-    if (esp.m.ipd.buff != NULL) {
-        esp_pbuf_free(esp.m.ipd.buff);
-        esp.m.ipd.buff = NULL;
+/**
+ * \brief           Baudrate probe timeout callback
+ *
+ * Garbled link produces neither `OK` nor `ERROR`, finish probe as failed
+ *
+ * \param[in]       arg: Reset message which started probe
+ */
+static void
+espi_baudrate_auto_timeout_cb(void* arg) {
+    if (esp.msg != arg || !(CMD_IS_DEF(ESP_CMD_RESET) || CMD_IS_DEF(ESP_CMD_RESTORE))
+        || !(CMD_IS_CUR(ESP_CMD_UART) || CMD_IS_CUR(ESP_CMD_AT))) {
+        return;                                 /* Probe finished in the meantime */
     }
+    esp.msg->msg.reset.baudrate_timeout = 1;
+    espi_process_cmd_result(0, 1, 0);           /* Finish probe with error */
+}
 
-    /* Invalid ESP modules */
-    ESP_MEMSET(&esp.m, 0x00, sizeof(esp.m));
+/**
+ * \brief           Start timeout for probe command of baudrate negotiation
+ * \param[in]       msg: Current message
+ */
+static void
+espi_baudrate_auto_probe_start(esp_msg_t* msg) {
+    if (msg->cmd_def == ESP_CMD_RESET || msg->cmd_def == ESP_CMD_RESTORE) {
+        msg->msg.reset.baudrate_timeout = 0;
+        esp_timeout_remove(espi_baudrate_auto_timeout_cb);
+        esp_timeout_add(ESP_CFG_AT_PORT_BAUDRATE_AUTO_TIMEOUT, espi_baudrate_auto_timeout_cb, msg);
+    }
+}
 
-    /* Set default device */
-#if ESP_CFG_ESP8266 && !ESP_CFG_ESP32
-    esp.m.device = ESP_DEVICE_ESP8266;
-#elif !ESP_CFG_ESP8266 && ESP_CFG_ESP32
-    esp.m.device = ESP_DEVICE_ESP32;
-#else
-    esp.m.device = ESP_DEVICE_UNKNOWN;
-#endif  /* ESP_CFG_ESP8266 && !ESP_CFG_ESP32 */
+/**
+ * \brief           Mark probed baudrate as failed
+ *
+ * Last stable baudrate is remembered and negotiation is not repeated on next reset
+ *
+ * \param[in]       msg: Reset message
+ */
+static void
+espi_baudrate_auto_set_failed(esp_msg_t* msg) {
+    ESP_DEBUGF(ESP_CFG_DBG_INIT | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+        "[CORE] Baudrate %d not stable, fallback to %d\r\n",
+        (int)msg->msg.reset.baudrate, (int)msg->msg.reset.baudrate_prev);
+    esp.baudrate_auto = msg->msg.reset.baudrate_prev != ESP_CFG_AT_PORT_BAUDRATE ? msg->msg.reset.baudrate_prev : 0;
+    esp.baudrate_auto_done = 1;
+}
 
-    /* Reset baudrate to default */
-    esp.ll.uart.baudrate = ESP_CFG_AT_PORT_BAUDRATE;
-    esp_ll_init(&esp.ll);
+/**
+ * \brief           Get next command of baudrate negotiation in reset sequence
+ *
+ * Sequence is `UART` command with new baudrate, followed by `AT` link tests.
+ * On test failure or probe timeout, device and host are set back to last stable baudrate
+ *
+ * \param[in]       msg: Reset message
+ * \param[in]       is_ok: Status of current command
+ * \return          Next command or \ref ESP_CMD_IDLE when negotiation finished
+ */
+static esp_cmd_t
+espi_baudrate_auto_get_sub_cmd(esp_msg_t* msg, uint8_t is_ok) {
+    uint32_t next;
 
-    /* If reset was not forced by user, repeat with manual reset */
-    if (!forced) {
-        esp_reset(NULL, NULL, 0);
+    esp_timeout_remove(espi_baudrate_auto_timeout_cb);
+    switch (CMD_GET_CUR()) {
+        case ESP_CMD_UART: {
+            if (msg->msg.reset.baudrate == msg->msg.reset.baudrate_prev) {
+                /* Rollback finished, make sure host uses stable baudrate even if device did not respond */
+                if (esp.ll.uart.baudrate != msg->msg.reset.baudrate_prev) {
+                    esp.ll.uart.baudrate = msg->msg.reset.baudrate_prev;
+                    espi_ll_init();
+                }
+                return ESP_CMD_IDLE;
+            }
+            if (!is_ok) {
+                espi_baudrate_auto_set_failed(msg);
+                if (!msg->msg.reset.baudrate_timeout) {
+                    return ESP_CMD_IDLE;        /* Rate not accepted by device, it stays on previous one */
+                }
+
+                /* No response, device may have switched already. Roll it back from new rate */
+                esp.ll.uart.baudrate = msg->msg.reset.baudrate;
+                espi_ll_init();
+                msg->msg.reset.baudrate = msg->msg.reset.baudrate_prev;
+                return ESP_CMD_UART;
+            }
+            msg->msg.reset.baudrate_tests = 0;
+            return ESP_CMD_AT;                  /* Host already changed baudrate, test link */
+        }
+        case ESP_CMD_AT: {
+            if (!is_ok) {                       /* Link not stable, roll back */
+                espi_baudrate_auto_set_failed(msg);
+                msg->msg.reset.baudrate = msg->msg.reset.baudrate_prev;
+                return ESP_CMD_UART;
+            }
+            if (++msg->msg.reset.baudrate_tests < ESP_CFG_AT_PORT_BAUDRATE_AUTO_TESTS) {
+                return ESP_CMD_AT;
+            }
+
+            /* Baudrate is stable */
+            esp.baudrate_auto = msg->msg.reset.baudrate;
+            msg->msg.reset.baudrate_prev = msg->msg.reset.baudrate;
+            next = esp.baudrate_auto_done ? 0 : espi_baudrate_auto_get_next(msg->msg.reset.baudrate);
+            if (next == 0) {
+                esp.baudrate_auto_done = 1;
+                return ESP_CMD_IDLE;
+            }
+            msg->msg.reset.baudrate = next;
+            return ESP_CMD_UART;
+        }
+        default: {                              /* Start negotiation, device is on default baudrate */
+            msg->msg.reset.baudrate_prev = esp.ll.uart.baudrate;
+            next = esp.baudrate_auto_done ? esp.baudrate_auto : espi_baudrate_auto_get_next(esp.ll.uart.baudrate);
+            if (next == 0) {
+                return ESP_CMD_IDLE;
+            }
+            msg->msg.reset.baudrate = next;
+            return ESP_CMD_UART;
+        }
     }
 }
 
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__ */
+
+#if ESP_CFG_UPDATE_ASYNC || __DOXYGEN__
+
 /**
- * \brief           Process callback function to user with specific type
- * \param[in]       type: Callback event type
- * \return          Member of \ref espr_t enumeration
+ * \brief           Finish background software update and notify application
+ * \param[in]       res: Result of update
  */
-espr_t
-espi_send_cb(esp_evt_type_t type) {
-    esp.evt.type = type;                        /* Set callback type to process */
+static void
+espi_update_finish(espr_t res);
 
-    /* Call callback function for all registered functions */
-    for (esp_evt_func_t* link = esp.evt_func; link != NULL; link = link->next) {
-        link->fn(&esp.evt);
+/**
+ * \brief           Background software update timeout callback
+ * \param[in]       arg: Custom user argument
+ */
+static void
+espi_update_timeout_cb(void* arg) {
+    ESP_UNUSED(arg);
+    if (esp.m.update_active) {
+        espi_update_finish(espTIMEOUT);
     }
-    return espOK;
+}
+
+static void
+espi_update_finish(espr_t res) {
+    esp_timeout_remove(espi_update_timeout_cb);
+    esp.m.update_active = 0;
+    esp.evt.evt.update.res = res;
+    espi_send_cb(ESP_EVT_UPDATE);
 }
 
 /**
- * \brief           Process connection callback
- * \note            Before calling function, callback structure must be prepared
- * \param[in]       conn: Pointer to connection to use as callback
- * \param[in]       evt: Event callback function for connection
- * \return          Member of \ref espr_t enumeration
+ * \brief           Check if command can be started during background software update
+ * \param[in]       msg: Message to start
+ * \return          `1` if command can be started, `0` otherwise
  */
-espr_t
-espi_send_conn_cb(esp_conn_t* conn, esp_evt_fn evt) {
-    if (conn->status.f.in_closing && esp.evt.type != ESP_EVT_CONN_CLOSE) {  /* Do not continue if in closing mode */
-        /* return espOK; */
+uint8_t
+espi_update_cmd_allowed(esp_msg_t* msg) {
+    ESP_UNUSED(msg);                            /* Default check does not use command type */
+    if (!esp.m.update_active) {
+        return 1;
     }
+    /* Device only waits to report final result after last update stage */
+    return esp.m.update_stage < 4 && ESP_CFG_UPDATE_CMD_ALLOWED(msg->cmd_def);
+}
 
-    if (evt != NULL) {                          /* Try with user connection */
-        return evt(&esp.evt);                   /* Call temporary function */
-    } else if (conn != NULL && conn->evt_func != NULL) {/* Connection custom callback? */
-        return conn->evt_func(&esp.evt);        /* Process callback function */
-    } else if (conn == NULL) {
-        return espOK;
-    }
+#endif /* ESP_CFG_UPDATE_ASYNC || __DOXYGEN__ */
 
-    /*
-     * On normal API operation,
-     * we should never enter to this part of code
-     */
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
 
-    /*
-     * If connection doesn't have callback function
-     * automatically close the connection?
-     *
-     * Since function call is non-blocking,
-     * it will set active connection to closing mode
-     * and further callback events should not be executed anymore
-     */
-    return esp_conn_close(conn, 0);
+/**
+ * \brief           Process new stage of remote software update
+ *
+ * With \ref ESP_CFG_UPDATE_ASYNC enabled, update command is finished
+ * on first reported stage and update continues in background
+ *
+ * \param[in]       stage: Stage reported by device
+ */
+static void
+espi_process_update_stage(int32_t stage) {
+    esp.evt.evt.update_progress.stage = stage;
+    espi_send_cb(ESP_EVT_UPDATE_PROGRESS);
+#if ESP_CFG_UPDATE_ASYNC
+    esp.m.update_stage = stage;
+    if (CMD_IS_CUR(ESP_CMD_TCPIP_CIUPDATE) && !esp.m.update_active) {
+        esp.m.update_active = 1;
+        esp_timeout_add(ESP_CFG_UPDATE_TIMEOUT, espi_update_timeout_cb, NULL);
+        espi_process_cmd_result(1, 0, 0);       /* Update accepted, release producing thread */
+    }
+#endif /* ESP_CFG_UPDATE_ASYNC */
 }
 
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+
 /**
- * \brief           Process and send data from device buffer
- * \return          Member of \ref espr_t enumeration
+ * \brief           Update status of MQTT connection on device and notify application on change
+ * \param[in]       connected: Set to `1` when connected to broker, `0` otherwise
  */
-static espr_t
-espi_tcpip_process_send_data(void) {
-    esp_conn_t* c = esp.msg->msg.conn_send.conn;
-    if (!esp_conn_is_active(c) ||               /* Is the connection already closed? */
-        esp.msg->msg.conn_send.val_id != c->val_id  /* Did validation ID change after we set parameter? */
-    ) {
-        /* Send event to user about failed send event */
-        CONN_SEND_DATA_SEND_EVT(esp.msg, espCLOSED);
-        return espERR;
+static void
+espi_mqtt_at_set_connected(uint8_t connected) {
+    if (esp.m.mqtt_at_connected != connected) {
+        esp.m.mqtt_at_connected = connected;
+        esp.evt.evt.mqtt_at_conn.connected = connected;
+        espi_send_cb(ESP_EVT_MQTT_AT_CONN);
     }
-    esp.msg->msg.conn_send.sent = ESP_MIN(esp.msg->msg.conn_send.btw, ESP_CFG_CONN_MAX_DATA_LEN);
-
-    AT_PORT_SEND_BEGIN_AT();
-    AT_PORT_SEND_CONST_STR("+CIPSEND=");
-    espi_send_number(ESP_U32(c->num), 0, 0);    /* Send connection number */
-    espi_send_number(ESP_U32(esp.msg->msg.conn_send.sent), 0, 1);   /* Send length number */
+}
 
-    /* On UDP connections, IP address and port may be included */
-    if (c->type == ESP_CONN_TYPE_UDP) {
-        if (esp.msg->msg.conn_send.remote_ip != NULL && esp.msg->msg.conn_send.remote_port) {
-            espi_send_ip_mac(esp.msg->msg.conn_send.remote_ip, 1, 1, 1);/* Send IP address including quotes */
-            espi_send_port(esp.msg->msg.conn_send.remote_port, 0, 1);   /* Send length number */
-        }
+/**
+ * \brief           Send received MQTT message to application and stop reading
+ */
+static void
+espi_mqtt_at_recv_finish(void) {
+    if (esp.m.mqtt_at_recv.buff != NULL) {
+        esp.evt.evt.mqtt_at_recv.topic = esp.m.mqtt_at_recv.buff;
+        esp.evt.evt.mqtt_at_recv.topic_len = esp.m.mqtt_at_recv.topic_len;
+        esp.evt.evt.mqtt_at_recv.data = &esp.m.mqtt_at_recv.buff[esp.m.mqtt_at_recv.topic_len + 1];
+        esp.evt.evt.mqtt_at_recv.len = esp.m.mqtt_at_recv.len;
+        espi_send_cb(ESP_EVT_MQTT_AT_RECV);
+        esp_mem_free_s((void **)&esp.m.mqtt_at_recv.buff);
     }
-    AT_PORT_SEND_END_AT();
-    return espOK;
+    esp.m.mqtt_at_recv.read = 0;
 }
 
 /**
- * \brief           Process data sent and send remaining
- * \param[in]       sent: Status whether data were sent or not,
- *                      info received from ESP with `SEND OK` or `SEND FAIL`
- * \return          `1` in case we should stop sending or `0` if we still have data to process
+ * \brief           Parse `+MQTTSUBRECV` header in receive buffer and start reading message data
+ *
+ * Header is complete when closing quote of topic is followed by data length and comma:
+ * `+MQTTSUBRECV:<link_id>,"<topic>",<len>,`
+ *
+ * \return          `1` when header is complete, `0` otherwise
  */
 static uint8_t
-espi_tcpip_process_data_sent(uint8_t sent) {
-    if (sent) {                                 /* Data were successfully sent */
-        esp.msg->msg.conn_send.sent_all += esp.msg->msg.conn_send.sent;
-        esp.msg->msg.conn_send.btw -= esp.msg->msg.conn_send.sent;
-        esp.msg->msg.conn_send.ptr += esp.msg->msg.conn_send.sent;
-        if (esp.msg->msg.conn_send.bw != NULL) {
-            *esp.msg->msg.conn_send.bw += esp.msg->msg.conn_send.sent;
+espi_mqtt_at_recv_start(void) {
+    const char* end = &esp.recv_buff.data[esp.recv_buff.len - 1];
+    const char* topic, *q, *tmp;
+
+    topic = strchr(esp.recv_buff.data, '"');
+    q = strrchr(esp.recv_buff.data, '"');
+    if (topic == NULL || q == topic || q[1] != ',' || &q[2] >= end) {
+        return 0;
+    }
+    for (tmp = &q[2]; tmp < end; ++tmp) {
+        if (!ESP_CHARISNUM(*tmp)) {             /* Comma inside topic */
+            return 0;
+        }
+    }
+    ++topic;
+    tmp = &q[2];
+
+    esp.m.mqtt_at_recv.topic_len = (size_t)(q - topic);
+    esp.m.mqtt_at_recv.len = (size_t)espi_parse_number(&tmp);
+    esp.m.mqtt_at_recv.pos = 0;
+    esp.m.mqtt_at_recv.buff = esp_mem_malloc_tag(esp.m.mqtt_at_recv.topic_len + 1 + esp.m.mqtt_at_recv.len, ESP_MEM_TAG_MQTT);
+    ESP_DEBUGW(ESP_CFG_DBG_MQTT | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING, esp.m.mqtt_at_recv.buff == NULL,
+        "[MQTT AT] Buffer allocation failed for %d byte(s)\r\n", (int)esp.m.mqtt_at_recv.len);
+    if (esp.m.mqtt_at_recv.buff != NULL) {
+        ESP_MEMCPY(esp.m.mqtt_at_recv.buff, topic, esp.m.mqtt_at_recv.topic_len);
+        esp.m.mqtt_at_recv.buff[esp.m.mqtt_at_recv.topic_len] = 0;
+    }
+    esp.m.mqtt_at_recv.read = 1;
+    if (esp.m.mqtt_at_recv.len == 0) {
+        espi_mqtt_at_recv_finish();
+    }
+    return 1;
+}
+
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+
+/**
+ * \brief           Parse `+HTTPCLIENT` header in receive buffer and start reading response data
+ *
+ * Header is complete when data length is followed by comma: `+HTTPCLIENT:<len>,`
+ *
+ * \return          `1` when header is complete, `0` otherwise
+ */
+static uint8_t
+espi_http_at_recv_start(void) {
+    const char* tmp = &esp.recv_buff.data[12];
+
+    for (size_t i = 12; i < esp.recv_buff.len - 1; ++i) {
+        if (!ESP_CHARISNUM(esp.recv_buff.data[i])) {
+            return 0;
+        }
+    }
+    esp.m.http_at_recv.len = (size_t)espi_parse_number(&tmp);
+    esp.m.http_at_recv.pos = 0;
+    esp.m.http_at_recv.read = esp.m.http_at_recv.len > 0;
+    return 1;
+}
+
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
+
+#if ESP_CFG_BLE || __DOXYGEN__
+
+/**
+ * \brief           Parse `+BLECONN` or `+BLEDISCONN` notification and notify application
+ * \param[in]       str: Notification after colon: `<conn_index>,"<remote_address>"`
+ * \param[in]       connected: Set to `1` when client connected, `0` when disconnected
+ */
+static void
+espi_ble_set_connected(const char* str, uint8_t connected) {
+    uint8_t conn = (uint8_t)espi_parse_number(&str);
+
+    if (conn >= sizeof(esp.m.ble_conns) * 8) {
+        return;
+    }
+    if (connected) {
+        esp.m.ble_conns |= ESP_U8(1U << conn);
+    } else {
+        esp.m.ble_conns &= ESP_U8(~(1U << conn));
+    }
+    esp.evt.evt.ble_conn.conn = conn;
+    espi_parse_mac(&str, &esp.evt.evt.ble_conn.mac);
+    esp.evt.evt.ble_conn.connected = connected;
+    espi_send_cb(ESP_EVT_BLE_CONN);
+}
+
+/**
+ * \brief           Send data written by BLE client to application and stop reading
+ */
+static void
+espi_ble_recv_finish(void) {
+    if (esp.m.ble_recv.buff != NULL) {
+        esp.evt.evt.ble_recv.conn = esp.m.ble_recv.conn;
+        esp.evt.evt.ble_recv.buff = esp.m.ble_recv.buff;
+        espi_send_cb(ESP_EVT_BLE_RECV);
+        esp_pbuf_free(esp.m.ble_recv.buff);     /* Application referenced buffer if it needs it */
+        esp.m.ble_recv.buff = NULL;
+    }
+    esp.m.ble_recv.read = 0;
+}
+
+/**
+ * \brief           Parse `+WRITE` header in receive buffer and start reading written value
+ *
+ * Header is complete when data length is followed by comma, descriptor index is empty
+ * for characteristic value: `+WRITE:<conn_index>,<srv_index>,<char_index>,[<desc_index>],<len>,`
+ *
+ * Only characteristic values of \ref ESP_CFG_BLE_SRV_INDEX service are passed to application,
+ * other written values (such as client enabling notifications) are skipped
+ *
+ * \return          `1` when header is complete, `0` otherwise
+ */
+static uint8_t
+espi_ble_recv_start(void) {
+    const char* tmp = &esp.recv_buff.data[7];
+    size_t commas = 0;
+    uint8_t srv, is_desc;
+
+    for (size_t i = 7; i < esp.recv_buff.len; ++i) {
+        if (esp.recv_buff.data[i] == ',') {
+            ++commas;
+        } else if (!ESP_CHARISNUM(esp.recv_buff.data[i])) {
+            return 0;
+        }
+    }
+    if (commas != 5) {
+        return 0;
+    }
+    esp.m.ble_recv.conn = (uint8_t)espi_parse_number(&tmp);
+    srv = (uint8_t)espi_parse_number(&tmp);
+    espi_parse_number(&tmp);                    /* Characteristic index */
+    is_desc = *tmp != ',';
+    if (is_desc) {
+        espi_parse_number(&tmp);                /* Descriptor index */
+    } else {
+        ++tmp;                                  /* Skip empty descriptor index */
+    }
+    esp.m.ble_recv.len = (size_t)espi_parse_number(&tmp);
+    esp.m.ble_recv.pos = 0;
+    esp.m.ble_recv.buff = NULL;
+    if (srv == ESP_CFG_BLE_SRV_INDEX && !is_desc && esp.m.ble_recv.len > 0) {
+        esp.m.ble_recv.buff = esp_pbuf_new(esp.m.ble_recv.len);
+        ESP_DEBUGW(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING, esp.m.ble_recv.buff == NULL,
+            "[BLE] Buffer allocation failed for %d byte(s)\r\n", (int)esp.m.ble_recv.len);
+    }
+    esp.m.ble_recv.read = 1;
+    if (esp.m.ble_recv.len == 0) {
+        espi_ble_recv_finish();
+    }
+    return 1;
+}
+
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+
+#if ESP_CFG_RESET_RECOVERY || __DOXYGEN__
+
+/**
+ * \brief           Start reset sequence after unexpected device reset
+ *
+ * Device has already restarted and reported `ready`,
+ * sequence therefore starts after `AT+RST` command
+ *
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+espi_recovery_start(void) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, 0);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_RESET;
+    ESP_MSG_VAR_REF(msg).cmd = ESP_CFG_AT_ECHO ? ESP_CMD_ATE1 : ESP_CMD_ATE0;
+    ESP_MSG_VAR_REF(msg).msg.reset.recovery = 1;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 5000);
+}
+
+/**
+ * \brief           Queue remembered server and access point settings after recovery reset sequence
+ */
+static void
+espi_recovery_replay(void) {
+    esp_recovery_t* r = &esp.recovery;
+
+    if (r->server_en) {
+        esp_set_server(1, r->server_port, r->server_max_conn, r->server_timeout, r->server_cb, NULL, NULL, 0);
+    }
+#if ESP_CFG_MODE_STATION
+    if (r->sta_valid) {
+        esp_sta_join(r->sta_name, r->sta_pass, r->sta_has_mac ? &r->sta_mac : NULL, NULL, NULL, 0);
+    }
+#endif /* ESP_CFG_MODE_STATION */
+}
+
+/**
+ * \brief           Remember or forget settings replayed after unexpected reset
+ * \note            Function is called when command finished
+ * \param[in]       msg: Finished command message
+ * \param[in]       ok: Set to `1` if command finished successfully
+ */
+static void
+espi_recovery_update(esp_msg_t* msg, uint8_t ok) {
+    esp_recovery_t* r = &esp.recovery;
+
+    if (!ok) {
+        return;
+    }
+    if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPSERVER)) {
+        r->server_en = msg->msg.tcpip_server.en;
+        r->server_port = msg->msg.tcpip_server.port;
+        r->server_max_conn = msg->msg.tcpip_server.max_conn;
+        r->server_timeout = msg->msg.tcpip_server.timeout;
+        r->server_cb = msg->msg.tcpip_server.cb;
+    } else if (CMD_IS_DEF(ESP_CMD_RESTORE)) {
+        ESP_MEMSET(r, 0x00, sizeof(*r));
+#if ESP_CFG_MODE_STATION
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWJAP)) {
+        if (msg->msg.sta_join.name != r->sta_name) {    /* Strings may already be remembered ones */
+            strncpy(r->sta_name, msg->msg.sta_join.name, sizeof(r->sta_name) - 1);
+            r->sta_name[sizeof(r->sta_name) - 1] = '\0';
+            r->sta_pass[0] = '\0';
+            if (msg->msg.sta_join.pass != NULL) {
+                strncpy(r->sta_pass, msg->msg.sta_join.pass, sizeof(r->sta_pass) - 1);
+                r->sta_pass[sizeof(r->sta_pass) - 1] = '\0';
+            }
+            r->sta_has_mac = msg->msg.sta_join.mac != NULL;
+            if (r->sta_has_mac) {
+                ESP_MEMCPY(&r->sta_mac, msg->msg.sta_join.mac, sizeof(r->sta_mac));
+            }
+        }
+        r->sta_valid = 1;
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWQAP)) {
+        r->sta_valid = 0;
+#endif /* ESP_CFG_MODE_STATION */
+    }
+}
+
+#endif /* ESP_CFG_RESET_RECOVERY || __DOXYGEN__ */
+
+#if ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__
+
+#if ESP_CFG_MODE_STATION || ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__
+
+/**
+ * \brief           Check if IP setup reported by device matches recorded one
+ * \param[in]       im: IP setup reported by device
+ * \param[in]       ip: Recorded IP address
+ * \param[in]       gw: Recorded gateway address, not checked when zero
+ * \param[in]       nm: Recorded netmask address, not checked when zero
+ * \return          `1` if equal, `0` otherwise
+ */
+static uint8_t
+espi_snapshot_ip_equal(const esp_ip_mac_t* im, const esp_ip_t* ip, const esp_ip_t* gw, const esp_ip_t* nm) {
+    return !memcmp(&im->ip, ip, sizeof(*ip))
+        && (gw->ip[0] == 0 || !memcmp(&im->gw, gw, sizeof(*gw)))
+        && (nm->ip[0] == 0 || !memcmp(&im->nm, nm, sizeof(*nm)));
+}
+
+#endif /* ESP_CFG_MODE_STATION || ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__ */
+
+/**
+ * \brief           Queue recorded settings which differ from device after reset or restore sequence
+ *
+ * Device values were read by the sequence, mode was already set by it
+ */
+static void
+espi_snapshot_replay(void) {
+    esp_snapshot_t* s = &esp.snapshot;
+
+#if ESP_CFG_MODE_STATION
+    if ((s->flags & ESP_SNAPSHOT_STA_IP) && !espi_snapshot_ip_equal(&esp.m.sta, &s->sta_ip, &s->sta_gw, &s->sta_nm)) {
+        esp_sta_setip(&s->sta_ip, &s->sta_gw, &s->sta_nm, NULL, NULL, 0);   /* Disables DHCP client too */
+    } else if ((s->flags & ESP_SNAPSHOT_DHCP_STA) && s->dhcp_sta != esp.m.sta.dhcp) {
+        esp_dhcp_configure(1, 0, s->dhcp_sta, NULL, NULL, 0);
+    }
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+    if ((s->flags & ESP_SNAPSHOT_DHCP_AP) && s->dhcp_ap != esp.m.ap.dhcp) {
+        esp_dhcp_configure(0, 1, s->dhcp_ap, NULL, NULL, 0);
+    }
+    if ((s->flags & ESP_SNAPSHOT_AP_IP) && !espi_snapshot_ip_equal(&esp.m.ap, &s->ap_ip, &s->ap_gw, &s->ap_nm)) {
+        esp_ap_setip(&s->ap_ip, &s->ap_gw, &s->ap_nm, NULL, NULL, 0);
+    }
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+#if ESP_CFG_HOSTNAME
+    if ((s->flags & ESP_SNAPSHOT_HOSTNAME) && !esp.snapshot_hostname_ok) {
+        esp_hostname_set(s->hostname, NULL, NULL, 0);
+    }
+#endif /* ESP_CFG_HOSTNAME */
+}
+
+/**
+ * \brief           Record successfully applied setting to configuration snapshot
+ * \note            Function is called when command finished
+ * \param[in]       msg: Finished command message
+ * \param[in]       ok: Set to `1` if command finished successfully
+ */
+static void
+espi_snapshot_update(esp_msg_t* msg, uint8_t ok) {
+    esp_snapshot_t* s = &esp.snapshot;
+
+    if (!ok) {
+        return;
+    }
+    if (CMD_IS_DEF(ESP_CMD_WIFI_CWMODE)) {
+        s->mode = (uint8_t)msg->msg.wifi_mode.mode;
+        s->flags |= ESP_SNAPSHOT_MODE;
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWDHCP_SET)) {
+        if (msg->msg.wifi_cwdhcp.sta) {
+            s->dhcp_sta = !!msg->msg.wifi_cwdhcp.en;
+            s->flags |= ESP_SNAPSHOT_DHCP_STA;
+            if (s->dhcp_sta) {
+                s->flags &= ~ESP_SNAPSHOT_STA_IP;   /* Address is assigned by DHCP server again */
+            }
+        }
+        if (msg->msg.wifi_cwdhcp.ap) {
+            s->dhcp_ap = !!msg->msg.wifi_cwdhcp.en;
+            s->flags |= ESP_SNAPSHOT_DHCP_AP;
+        }
+#if ESP_CFG_MODE_STATION
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CIPSTA_SET)) {
+        s->sta_ip = msg->msg.sta_ap_setip.ip;
+        s->sta_gw = msg->msg.sta_ap_setip.gw;
+        s->sta_nm = msg->msg.sta_ap_setip.nm;
+        s->dhcp_sta = 0;                        /* Static address disables DHCP client */
+        s->flags |= ESP_SNAPSHOT_STA_IP | ESP_SNAPSHOT_DHCP_STA;
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CIPAP_SET)) {
+        s->ap_ip = msg->msg.sta_ap_setip.ip;
+        s->ap_gw = msg->msg.sta_ap_setip.gw;
+        s->ap_nm = msg->msg.sta_ap_setip.nm;
+        s->flags |= ESP_SNAPSHOT_AP_IP;
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+#if ESP_CFG_HOSTNAME
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWHOSTNAME_SET)) {
+        if (msg->msg.wifi_hostname.hostname_set != s->hostname) {  /* String may already be recorded one */
+            strncpy(s->hostname, msg->msg.wifi_hostname.hostname_set, sizeof(s->hostname) - 1);
+            s->hostname[sizeof(s->hostname) - 1] = '\0';
+        }
+        s->flags |= ESP_SNAPSHOT_HOSTNAME;
+#endif /* ESP_CFG_HOSTNAME */
+    }
+}
+
+#endif /* ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__ */
+
+/**
+ * \brief           Initialize low-level communication with current settings in \ref esp_t.ll
+ * \note            Use it instead of direct \ref esp_ll_init call to keep send function hooks installed
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+espi_ll_init(void) {
+    espr_t res;
+
+    res = esp_ll_init(&esp.ll);
+#if ESP_CFG_AT_CAPTURE
+    espi_capture_ll_hook(&esp.ll);              /* Record data sent to device */
+#endif /* ESP_CFG_AT_CAPTURE */
+    return res;
+}
+
+/**
+ * \brief           Reset everything after reset was detected
+ * \param[in]       forced: Set to `1` if reset forced by user
+ */
+void
+espi_reset_everything(uint8_t forced) {
+    /**
+     * \todo: Put stack to default state:
+     *          - Close all the connections in memory
+     *          - Clear entire data memory
+     *          - Reset esp structure with IP
+     *          - Start over init procedure
+     */
+
+    /* Step 1: Close all connections in memory */
+    reset_connections(forced);
+
+#if ESP_CFG_UPDATE_ASYNC
+    if (esp.m.update_active) {                  /* Device restarted before reporting update result */
+        espi_update_finish(espERR);
+    }
+#endif /* ESP_CFG_UPDATE_ASYNC */
+
+#if ESP_CFG_MODE_STATION
+    esp.m.sta.has_ip = 0;
+    if (esp.m.sta.is_connected) {
+        espi_send_cb(ESP_EVT_WIFI_DISCONNECTED);
+    }
+    esp.m.sta.is_connected = 0;
+#endif /* ESP_CFG_MODE_STATION */
+
+    /* Check if IPD active */
+#if ESP_CFG_IPD_ALLOC_POLICY
+    if (esp.m.ipd.buff_head != NULL) {          /* Current buffer is part of the chain */
+        esp.m.ipd.buff = esp.m.ipd.buff_head;
+        esp.m.ipd.buff_head = NULL;
+    }
+    esp.m.ipd.whole = 0;
+#endif /* ESP_CFG_IPD_ALLOC_POLICY */
+    if (esp.m.ipd.buff != NULL) {
+        esp_pbuf_free(esp.m.ipd.buff);
+        esp.m.ipd.buff = NULL;
+    }
+
+#if ESP_CFG_MQTT_AT
+    esp_mem_free_s((void **)&esp.m.mqtt_at_recv.buff);
+    espi_mqtt_at_set_connected(0);
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_BLE
+    if (esp.m.ble_recv.buff != NULL) {
+        esp_pbuf_free(esp.m.ble_recv.buff);
+        esp.m.ble_recv.buff = NULL;
+    }
+#endif /* ESP_CFG_BLE */
+#if ESP_CFG_HTTP_CLIENT_AT
+    esp.m.http_at_recv.read = 0;
+#endif /* ESP_CFG_HTTP_CLIENT_AT */
+
+    /* Invalid ESP modules */
+    ESP_CORE_SEQ_WRITE_BEGIN();
+    ESP_MEMSET(&esp.m, 0x00, sizeof(esp.m));
+    ESP_CORE_SEQ_WRITE_END();
+
+    /* Set default device */
+#if ESP_CFG_ESP8266 && !ESP_CFG_ESP32
+    esp.m.device = ESP_DEVICE_ESP8266;
+#elif !ESP_CFG_ESP8266 && ESP_CFG_ESP32
+    esp.m.device = ESP_DEVICE_ESP32;
+#else
+    esp.m.device = ESP_DEVICE_UNKNOWN;
+#endif  /* ESP_CFG_ESP8266 && !ESP_CFG_ESP32 */
+
+    /* Reset baudrate to default */
+    esp.ll.uart.baudrate = ESP_CFG_AT_PORT_BAUDRATE;
+    espi_ll_init();
+
+    /* If reset was not forced by user, repeat with manual reset */
+    if (!forced) {
+#if ESP_CFG_RESET_RECOVERY
+        espi_recovery_start();                  /* Device is already restarted, continue with recovery */
+#else /* ESP_CFG_RESET_RECOVERY */
+        esp_reset(NULL, NULL, 0);
+#endif /* !ESP_CFG_RESET_RECOVERY */
+    }
+}
+
+#if ESP_CFG_EVT_DEFERRED || __DOXYGEN__
+
+/**
+ * \brief           Copy current event to deferred event queue
+ * \note            Core must be locked before calling this function
+ * \param[in]       conn: Connection for connection event, `NULL` for global event
+ * \param[in]       fn: Callback function for connection event, `NULL` to call all global event functions
+ */
+static void
+espi_evt_deferred_put(esp_conn_p conn, esp_evt_fn fn) {
+    esp_evt_deferred_t* e;
+    esp_evt_t evt = esp.evt;                    /* Callbacks during flush may modify current event */
+
+    if (esp.evt_queue_cnt == ESP_ARRAYSIZE(esp.evt_queue)) {
+        espi_evt_deferred_flush();              /* Queue is full, deliver pending events in current thread */
+    }
+    e = &esp.evt_queue[(esp.evt_queue_r + esp.evt_queue_cnt) % ESP_ARRAYSIZE(esp.evt_queue)];
+    e->evt = evt;
+    e->conn = conn;
+    e->fn = fn;
+
+    /* Copy data event points to on caller stack */
+    switch (evt.type) {
+#if ESP_CFG_MODE_STATION
+        case ESP_EVT_STA_LIST_AP_ENTRY:
+            ESP_MEMCPY(&e->ap, evt.evt.sta_list_ap_entry.ap, sizeof(e->ap));
+            break;
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+        case ESP_EVT_AP_CONNECTED_STA:
+        case ESP_EVT_AP_DISCONNECTED_STA:
+            ESP_MEMCPY(&e->mac, evt.evt.ap_conn_disconn_sta.mac, sizeof(e->mac));
+            break;
+        case ESP_EVT_AP_IP_STA:
+            ESP_MEMCPY(&e->mac, evt.evt.ap_ip_sta.mac, sizeof(e->mac));
+            ESP_MEMCPY(&e->ip, evt.evt.ap_ip_sta.ip, sizeof(e->ip));
+            break;
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+        case ESP_EVT_CONN_RECV:
+            esp_pbuf_ref(evt.evt.conn_data_recv.buff);  /* Keep buffer until event is delivered */
+            break;
+        default:
+            break;
+    }
+
+    if (esp.evt_queue_cnt++ == 0) {
+        esp_sys_sem_release(&esp.evt_sem);      /* Wake-up event thread */
+    }
+}
+
+/**
+ * \brief           Deliver oldest deferred event to callback functions
+ * \note            Core must be locked before calling this function
+ * \return          `1` if event was delivered, `0` if queue is empty
+ */
+uint8_t
+espi_evt_deferred_process(void) {
+    esp_evt_deferred_t e;
+
+    if (esp.evt_queue_cnt == 0) {
+        return 0;
+    }
+
+    /* Remove entry first, callback may add new events to queue */
+    e = esp.evt_queue[esp.evt_queue_r];
+    esp.evt_queue_r = (esp.evt_queue_r + 1) % ESP_ARRAYSIZE(esp.evt_queue);
+    --esp.evt_queue_cnt;
+
+    switch (e.evt.type) {
+#if ESP_CFG_MODE_STATION
+        case ESP_EVT_STA_LIST_AP_ENTRY:
+            e.evt.evt.sta_list_ap_entry.ap = &e.ap;
+            break;
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+        case ESP_EVT_AP_CONNECTED_STA:
+        case ESP_EVT_AP_DISCONNECTED_STA:
+            e.evt.evt.ap_conn_disconn_sta.mac = &e.mac;
+            break;
+        case ESP_EVT_AP_IP_STA:
+            e.evt.evt.ap_ip_sta.mac = &e.mac;
+            e.evt.evt.ap_ip_sta.ip = &e.ip;
+            break;
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+        default:
+            break;
+    }
+
+    if (e.fn != NULL) {
+        e.fn(&e.evt);
+        if (e.evt.type == ESP_EVT_CONN_RECV) {
+            esp_pbuf_free(e.evt.evt.conn_data_recv.buff);   /* Release reference from queue */
+        }
+    } else {
+        for (esp_evt_func_t* link = esp.evt_func; link != NULL; link = link->next) {
+            if (link->mask & ESP_EVT_MASK(e.evt.type)) {
+                link->fn(&e.evt);
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Deliver all deferred events in current thread
+ *
+ * Used when queue is full and before connection structure is reused,
+ * so events of previous connection are delivered in order
+ *
+ * \note            Core must be locked before calling this function
+ */
+void
+espi_evt_deferred_flush(void) {
+    while (espi_evt_deferred_process()) {}
+}
+
+#endif /* ESP_CFG_EVT_DEFERRED || __DOXYGEN__ */
+
+/**
+ * \brief           Process callback function to user with specific type
+ * \param[in]       type: Callback event type
+ * \return          Member of \ref espr_t enumeration
+ */
+espr_t
+espi_send_cb(esp_evt_type_t type) {
+    esp.evt.type = type;                        /* Set callback type to process */
+
+#if ESP_CFG_EVT_DEFERRED
+    espi_evt_deferred_put(NULL, NULL);          /* Deliver from event thread */
+    return espOK;
+#endif /* ESP_CFG_EVT_DEFERRED */
+
+    /* Call callback function for all registered functions subscribed to event */
+    for (esp_evt_func_t* link = esp.evt_func; link != NULL; link = link->next) {
+        if (link->mask & ESP_EVT_MASK(type)) {
+            link->fn(&esp.evt);
+        }
+    }
+    return espOK;
+}
+
+/**
+ * \brief           Process connection callback
+ * \note            Before calling function, callback structure must be prepared
+ * \param[in]       conn: Pointer to connection to use as callback
+ * \param[in]       evt: Event callback function for connection
+ * \return          Member of \ref espr_t enumeration
+ */
+espr_t
+espi_send_conn_cb(esp_conn_t* conn, esp_evt_fn evt) {
+    if (conn->status.f.in_closing && esp.evt.type != ESP_EVT_CONN_CLOSE) {  /* Do not continue if in closing mode */
+        /* return espOK; */
+    }
+
+#if ESP_CFG_EVT_DEFERRED
+    if (conn != NULL && (evt != NULL || conn->evt_func != NULL)) {
+        espi_evt_deferred_put(conn, evt != NULL ? evt : conn->evt_func);    /* Deliver from event thread */
+        return espOK;
+    }
+#endif /* ESP_CFG_EVT_DEFERRED */
+
+    if (evt != NULL) {                          /* Try with user connection */
+        return evt(&esp.evt);                   /* Call temporary function */
+    } else if (conn != NULL && conn->evt_func != NULL) {/* Connection custom callback? */
+        return conn->evt_func(&esp.evt);        /* Process callback function */
+    } else if (conn == NULL) {
+        return espOK;
+    }
+
+    /*
+     * On normal API operation,
+     * we should never enter to this part of code
+     */
+
+    /*
+     * If connection doesn't have callback function
+     * automatically close the connection?
+     *
+     * Since function call is non-blocking,
+     * it will set active connection to closing mode
+     * and further callback events should not be executed anymore
+     */
+    return esp_conn_close(conn, 0);
+}
+
+/**
+ * \brief           Send `AT+CIPSEND` command for current send message
+ * \param[in]       len: Length of data segment in units of bytes
+ */
+static void
+espi_tcpip_send_cipsend(size_t len) {
+    esp_conn_t* c = esp.msg->msg.conn_send.conn;
+
+    AT_PORT_SEND_BEGIN_AT();
+    AT_PORT_SEND_CONST_STR("+CIPSEND=");
+#if ESP_CFG_SINGLE_CONN
+    espi_send_number(ESP_U32(len), 0, 0);       /* Send length number, no link ID in single connection mode */
+#else /* ESP_CFG_SINGLE_CONN */
+    espi_send_number(ESP_U32(c->num), 0, 0);    /* Send connection number */
+    espi_send_number(ESP_U32(len), 0, 1);       /* Send length number */
+#endif /* !ESP_CFG_SINGLE_CONN */
+
+    /* On UDP connections, IP address and port may be included */
+    if (c->type == ESP_CONN_TYPE_UDP) {
+        if (esp.msg->msg.conn_send.remote_ip != NULL && esp.msg->msg.conn_send.remote_port) {
+            espi_send_ip_mac(esp.msg->msg.conn_send.remote_ip, 1, 1, 1);/* Send IP address including quotes */
+            espi_send_port(esp.msg->msg.conn_send.remote_port, 0, 1);   /* Send length number */
+        }
+    }
+    AT_PORT_SEND_END_AT();
+}
+
+/**
+ * \brief           Get maximal length of next data segment for connection
+ * \param[in]       c: Connection handle
+ * \return          Segment length in units of bytes
+ */
+static size_t
+espi_tcpip_seg_len(esp_conn_t* c) {
+#if ESP_CFG_CONN_SEND_PACING
+    if (c->send_seg_len > 0) {
+        return c->send_seg_len;
+    }
+#endif /* ESP_CFG_CONN_SEND_PACING */
+    ESP_UNUSED(c);
+    return ESP_CFG_CONN_MAX_DATA_LEN;
+}
+
+/**
+ * \brief           Process and send data from device buffer
+ * \return          Member of \ref espr_t enumeration
+ */
+static espr_t
+espi_tcpip_process_send_data(void) {
+    esp_conn_t* c = esp.msg->msg.conn_send.conn;
+    if (!esp_conn_is_active(c) ||               /* Is the connection already closed? */
+        esp.msg->msg.conn_send.val_id != c->val_id  /* Did validation ID change after we set parameter? */
+    ) {
+        /* Send event to user about failed send event */
+        CONN_SEND_DATA_SEND_EVT(esp.msg, espCLOSED);
+        return espERR;
+    }
+    esp.msg->msg.conn_send.sent = ESP_MIN(esp.msg->msg.conn_send.btw, espi_tcpip_seg_len(c));
+#if ESP_CFG_CONN_STATS
+    esp.msg->msg.conn_send.start_time = esp_sys_now();
+    ++c->stats.cipsend_cnt;
+#endif /* ESP_CFG_CONN_STATS */
+    espi_tcpip_send_cipsend(esp.msg->msg.conn_send.sent);
+    return espOK;
+}
+
+#if ESP_CFG_CONN_SEND_PIPELINE || __DOXYGEN__
+
+/**
+ * \brief           Start next data segment while current one is still in progress
+ *
+ * Called when ESP reports it received data of current segment (`Recv x bytes`),
+ * before `SEND OK` is reported. Command for next segment is sent immediately
+ * to overlap round trip of next segment with sending of current one.
+ */
+static void
+espi_tcpip_process_send_pipeline(void) {
+    size_t rem;
+    esp_conn_t* c = esp.msg->msg.conn_send.conn;
+
+    if (esp.msg->msg.conn_send.pipe_len > 0     /* Next segment already started? */
+        || esp.msg->msg.conn_send.pipe_failed   /* Command finishes after current segment */
+        || !esp_conn_is_active(c) || esp.msg->msg.conn_send.val_id != c->val_id) {
+        return;
+    }
+    rem = esp.msg->msg.conn_send.btw - esp.msg->msg.conn_send.sent;
+    if (rem > 0) {
+        esp.msg->msg.conn_send.pipe_len = ESP_MIN(rem, espi_tcpip_seg_len(c));
+        esp.msg->msg.conn_send.pipe_data_sent = 0;
+#if ESP_CFG_CONN_STATS
+        esp.msg->msg.conn_send.pipe_start_time = esp_sys_now();
+        ++c->stats.cipsend_cnt;
+#endif /* ESP_CFG_CONN_STATS */
+        espi_tcpip_send_cipsend(esp.msg->msg.conn_send.pipe_len);
+    }
+}
+
+#endif /* ESP_CFG_CONN_SEND_PIPELINE || __DOXYGEN__ */
+
+#if ESP_CFG_CONN_SEND_PACING || __DOXYGEN__
+
+/**
+ * \brief           Update send pacing of connection after segment result
+ *
+ * Segment length of TCP and SSL connections grows additively on success
+ * and is halved on failure. Retry delay doubles on every consecutive failure
+ *
+ * \param[in]       c: Connection handle
+ * \param[in]       sent: Set to `1` when segment was sent, `0` on failure
+ */
+static void
+espi_tcpip_pacing_update(esp_conn_t* c, uint8_t sent) {
+    size_t len = espi_tcpip_seg_len(c);
+
+    if (sent) {
+        c->send_backoff = 0;
+        len = ESP_MIN(len + ESP_CFG_CONN_SEND_PACING_INC, ESP_CFG_CONN_MAX_DATA_LEN);
+    } else {
+        c->send_backoff = c->send_backoff > 0 ? ESP_MIN(2 * c->send_backoff, ESP_CFG_CONN_SEND_PACING_BACKOFF_MAX)
+                                              : ESP_CFG_CONN_SEND_PACING_BACKOFF;
+        len = ESP_MAX(len / 2, ESP_CFG_CONN_SEND_PACING_MIN_LEN);
+    }
+    if (c->type != ESP_CONN_TYPE_UDP) {         /* UDP datagrams are not split further */
+        c->send_seg_len = len;
+    }
+}
+
+/**
+ * \brief           Send segment again after retry delay
+ * \param[in]       arg: Message which scheduled retry
+ */
+static void
+espi_tcpip_send_backoff_cb(void* arg) {
+    if (esp.msg != arg || !CMD_IS_CUR(ESP_CMD_TCPIP_CIPSEND) || !esp.msg->msg.conn_send.backoff) {
+        return;                                 /* Command finished in the meantime */
+    }
+    esp.msg->msg.conn_send.backoff = 0;
+    if (espi_tcpip_process_send_data() != espOK) {
+        espi_process_cmd_result(0, 1, 0);       /* Finish command with error */
+    }
+}
+
+#endif /* ESP_CFG_CONN_SEND_PACING || __DOXYGEN__ */
+
+/**
+ * \brief           Process data sent and send remaining
+ * \param[in]       sent: Status whether data were sent or not,
+ *                      info received from ESP with `SEND OK` or `SEND FAIL`
+ * \return          `1` in case we should stop sending or `0` if we still have data to process
+ */
+static uint8_t
+espi_tcpip_process_data_sent(uint8_t sent) {
+#if ESP_CFG_CONN_STATS
+    esp_conn_t* c = esp.msg->msg.conn_send.conn;
+
+    if (sent) {
+        uint32_t latency = esp_sys_now() - esp.msg->msg.conn_send.start_time;
+
+        c->stats.bytes_sent += esp.msg->msg.conn_send.sent;
+        if (c->stats.send_ok_cnt == 0 || latency < c->stats.latency_min) {
+            c->stats.latency_min = latency;
+        }
+        if (latency > c->stats.latency_max) {
+            c->stats.latency_max = latency;
+        }
+        c->latency_sum += latency;
+        ++c->stats.send_ok_cnt;
+    } else {
+        ++c->stats.send_fail_cnt;
+    }
+#endif /* ESP_CFG_CONN_STATS */
+#if ESP_CFG_CONN_SEND_PACING
+    espi_tcpip_pacing_update(esp.msg->msg.conn_send.conn, sent);
+#endif /* ESP_CFG_CONN_SEND_PACING */
+    if (sent) {                                 /* Data were successfully sent */
+        esp.msg->msg.conn_send.sent_all += esp.msg->msg.conn_send.sent;
+        esp.msg->msg.conn_send.btw -= esp.msg->msg.conn_send.sent;
+        esp.msg->msg.conn_send.ptr += esp.msg->msg.conn_send.sent;
+        if (esp.msg->msg.conn_send.bw != NULL) {
+            *esp.msg->msg.conn_send.bw += esp.msg->msg.conn_send.sent;
         }
         esp.msg->msg.conn_send.tries = 0;
     } else {                                    /* We were not successful */
+#if ESP_CFG_CONN_SEND_PIPELINE
+        if (esp.msg->msg.conn_send.pipe_failed) {   /* Segment after failed one did not start */
+            return 1;
+        }
+        if (esp.msg->msg.conn_send.pipe_len > 0) {  /* Next segment is already in progress, retry is not possible */
+            /*
+             * Device may already wait for data of next segment.
+             * Complete it to keep AT state in sync and finish with error after its result
+             */
+            esp.msg->msg.conn_send.pipe_failed = 1;
+            esp.msg->msg.conn_send.ptr += esp.msg->msg.conn_send.sent;
+            esp.msg->msg.conn_send.sent = esp.msg->msg.conn_send.pipe_len;
+            esp.msg->msg.conn_send.wait_send_ok_err = esp.msg->msg.conn_send.pipe_data_sent;
+            esp.msg->msg.conn_send.pipe_len = 0;
+            esp.msg->msg.conn_send.pipe_data_sent = 0;
+            return 0;
+        }
+#endif /* ESP_CFG_CONN_SEND_PIPELINE */
         ++esp.msg->msg.conn_send.tries;         /* Increase number of tries */
         if (esp.msg->msg.conn_send.tries == ESP_CFG_MAX_SEND_RETRIES) { /* In case we reached max number of retransmissions */
             return 1;                           /* Return 1 and indicate error */
         }
+#if ESP_CFG_CONN_STATS
+        ++c->stats.retries;                     /* Segment is sent again */
+#endif /* ESP_CFG_CONN_STATS */
+#if ESP_CFG_CONN_SEND_PACING
+        if (esp.msg->msg.conn_send.conn->send_backoff > 0) {
+            /* Give device time to free its buffers before segment is sent again */
+            esp.msg->msg.conn_send.backoff = 1;
+            esp_timeout_remove(espi_tcpip_send_backoff_cb);
+            esp_timeout_add(esp.msg->msg.conn_send.conn->send_backoff, espi_tcpip_send_backoff_cb, esp.msg);
+            return 0;
+        }
+#endif /* ESP_CFG_CONN_SEND_PACING */
+    }
+    if (esp.msg->msg.conn_send.btw > 0) {       /* Do we still have data to send? */
+#if ESP_CFG_CONN_SEND_PIPELINE
+        if (esp.msg->msg.conn_send.pipe_len > 0) {  /* Command for next segment already sent? */
+            esp.msg->msg.conn_send.sent = esp.msg->msg.conn_send.pipe_len;
+            esp.msg->msg.conn_send.wait_send_ok_err = esp.msg->msg.conn_send.pipe_data_sent;
+#if ESP_CFG_CONN_STATS
+            esp.msg->msg.conn_send.start_time = esp.msg->msg.conn_send.pipe_start_time;
+#endif /* ESP_CFG_CONN_STATS */
+            esp.msg->msg.conn_send.pipe_len = 0;
+            esp.msg->msg.conn_send.pipe_data_sent = 0;
+            return 0;                           /* We still have data to send */
+        }
+#endif /* ESP_CFG_CONN_SEND_PIPELINE */
+#if ESP_CFG_CMD_CANCEL
+        if (esp.msg->cancelled) {               /* Application cancelled send, stop between segments */
+            return 1;
+        }
+#endif /* ESP_CFG_CMD_CANCEL */
+        if (espi_tcpip_process_send_data() != espOK) {  /* Check if we can continue */
+            return 1;                           /* Finish at this point */
+        }
+        return 0;                               /* We still have data to send */
+    }
+    return 1;                                   /* Everything was sent, we can stop execution */
+}
+
+/**
+ * \brief           Send error event to application layer
+ * \param[in]       msg: Message from user with connection start
+ * \param[in]       error: Value indicating cause of error
+ */
+static void
+espi_send_conn_error_cb(esp_msg_t* msg, espr_t error) {
+    esp.evt.type = ESP_EVT_CONN_ERROR;          /* Connection error */
+    esp.evt.evt.conn_error.host = esp.msg->msg.conn_start.remote_host;
+    esp.evt.evt.conn_error.port = esp.msg->msg.conn_start.remote_port;
+    esp.evt.evt.conn_error.type = esp.msg->msg.conn_start.type;
+    esp.evt.evt.conn_error.arg = esp.msg->msg.conn_start.arg;
+    esp.evt.evt.conn_error.err = error;
+
+    /* Call callback specified by user on connection startup */
+#if ESP_CFG_EVT_DEFERRED
+    espi_evt_deferred_put(NULL, esp.msg->msg.conn_start.evt_func);
+#else /* ESP_CFG_EVT_DEFERRED */
+    esp.msg->msg.conn_start.evt_func(&esp.evt);
+#endif /* !ESP_CFG_EVT_DEFERRED */
+    ESP_UNUSED(msg);
+}
+
+#if ESP_CFG_CONN_TRANSPARENT
+/**
+ * \brief           Set connection `0` active after transparent mode connection start
+ * \note            When `+LINK_CONN` is reported by device, connection is already active
+ * \param[in]       msg: Message from user with connection start
+ */
+static void
+espi_transparent_conn_active(esp_msg_t* msg) {
+    esp_conn_t* conn = &esp.m.conns[0];         /* Single connection mode uses first connection */
+    uint8_t id;
+
+    if (!conn->status.f.active) {
+#if ESP_CFG_EVT_DEFERRED
+        espi_evt_deferred_flush();              /* Deliver events of previous connection first */
+#endif /* ESP_CFG_EVT_DEFERRED */
+        id = conn->val_id;
+        ESP_CORE_SEQ_WRITE_BEGIN();
+        ESP_MEMSET(conn, 0x00, sizeof(*conn));  /* Reset connection parameters */
+        conn->num = 0;                          /* Set connection number */
+        conn->val_id = ++id;                    /* Set new validation ID */
+        conn->type = msg->msg.conn_start.type;  /* Set connection type */
+        conn->remote_port = msg->msg.conn_start.remote_port;
+#if ESP_CFG_CONN_WRITE_LINGER
+        conn->write_linger = ESP_CFG_CONN_WRITE_LINGER_TIME;
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
+        ESP_CORE_SEQ_WRITE_END();
+        ESP_CONN_SET_ACTIVE(conn, 1);
+        conn->status.f.client = 1;
+        conn->evt_func = msg->msg.conn_start.evt_func;  /* Set callback function */
+        conn->arg = msg->msg.conn_start.arg;    /* Set argument for function */
+
+        esp.evt.type = ESP_EVT_CONN_ACTIVE;     /* Connection just active */
+        esp.evt.evt.conn_active_close.conn = conn;
+        esp.evt.evt.conn_active_close.client = 1;
+        esp.evt.evt.conn_active_close.forced = 1;
+        espi_send_conn_cb(conn, NULL);          /* Send event */
+        espi_conn_start_timeout(conn);          /* Start connection timeout timer */
+    }
+    msg->msg.conn_start.success = 1;
+}
+
+/**
+ * \brief           Set connection `0` closed after transparent mode has been left
+ * \note            Device does not report `CLOSED` with connection number in single connection mode
+ */
+static void
+espi_transparent_conn_closed(void) {
+    esp_conn_t* conn = &esp.m.conns[0];
+
+    if (conn->status.f.active) {
+        ESP_CONN_SET_ACTIVE(conn, 0);
+
+        esp.evt.type = ESP_EVT_CONN_CLOSE;
+        esp.evt.evt.conn_active_close.conn = conn;
+        esp.evt.evt.conn_active_close.client = conn->status.f.client;
+        esp.evt.evt.conn_active_close.forced = 1;
+        esp.evt.evt.conn_active_close.res = espOK;
+        espi_send_conn_cb(conn, NULL);          /* Send event */
+
+        if (conn->buff.buff != NULL) {
+            espi_conn_buff_free(conn->buff.buff);
+            conn->buff.buff = NULL;
+        }
+    }
+}
+
+/**
+ * \brief           Process raw data received in transparent mode
+ * \param[in]       data: Received data
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+espi_transparent_process_data(const void* data, size_t len) {
+    esp_conn_t* conn = esp.m.transparent_conn;
+    esp_pbuf_p p;
+
+#if ESP_CFG_IPD_ZERO_COPY
+    p = espi_pbuf_new_ref(data, len);           /* Reference data from receive buffer */
+#else /* ESP_CFG_IPD_ZERO_COPY */
+    p = esp_pbuf_new(len);
+    if (p != NULL) {
+        ESP_MEMCPY(p->payload, data, len);
+    }
+#endif /* !ESP_CFG_IPD_ZERO_COPY */
+    if (p == NULL) {
+        ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+            "[TRANSPARENT] Buffer allocation failed for %d bytes\r\n", (int)len);
+        return;
+    }
+    esp_pbuf_set_ip(p, &conn->remote_ip, conn->remote_port);
+    conn->total_recved += len;
+#if ESP_CFG_LATENCY_TRACE
+    p->trace_in = esp.trace_rx_cur;
+    p->trace_time = esp_sys_now();
+#endif /* ESP_CFG_LATENCY_TRACE */
+
+    esp.evt.type = ESP_EVT_CONN_RECV;
+    esp.evt.evt.conn_data_recv.buff = p;
+    esp.evt.evt.conn_data_recv.conn = conn;
+    espi_send_conn_cb(conn, NULL);
+#if ESP_CFG_IPD_ZERO_COPY
+    espi_pbuf_release_payload(p);               /* Receive buffer is reused after return */
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+    esp_pbuf_free(p);
+}
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+
+#if ESP_CFG_INPUT_FRAMED || __DOXYGEN__
+/**
+ * \brief           Deliver data fragment from framed transport to connection
+ * \note            Transport already separated data from command text, AT parser is not used
+ * \param[in]       conn_num: Connection number data belong to
+ * \param[in]       data: Received data
+ * \param[in]       len: Length of data in units of bytes
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+espi_process_conn_data(uint8_t conn_num, const void* data, size_t len) {
+    esp_conn_t* conn;
+    esp_pbuf_p p;
+
+    if (conn_num >= ESP_CFG_MAX_CONNS) {
+        return espPARERR;
+    }
+    conn = &esp.m.conns[conn_num];
+    if (!conn->status.f.active) {
+        ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+            "[FRAMED] Data for inactive connection %d dropped\r\n", (int)conn_num);
+        return espCLOSED;
+    }
+#if ESP_CFG_SLEEP
+    esp.sleep_active_time = esp_sys_now();      /* Device is awake while it sends data */
+#endif /* ESP_CFG_SLEEP */
+
+#if ESP_CFG_IPD_ZERO_COPY
+    p = espi_pbuf_new_ref(data, len);           /* Reference data from transport frame */
+#else /* ESP_CFG_IPD_ZERO_COPY */
+    p = esp_pbuf_new(len);
+    if (p != NULL) {
+        ESP_MEMCPY(p->payload, data, len);
+    }
+#endif /* !ESP_CFG_IPD_ZERO_COPY */
+    if (p == NULL) {
+        ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+            "[FRAMED] Buffer allocation failed for %d bytes\r\n", (int)len);
+        return espERRMEM;
+    }
+    esp_pbuf_set_ip(p, &conn->remote_ip, conn->remote_port);
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+    conn->tcp_not_ack_bytes += len;
+    if (conn->tcp_available_bytes >= len) {
+        conn->tcp_available_bytes -= len;
+    }
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+    conn->total_recved += len;
+#if ESP_CFG_LATENCY_TRACE
+    p->trace_in = esp.trace_rx_cur;
+    p->trace_time = esp_sys_now();
+#endif /* ESP_CFG_LATENCY_TRACE */
+
+    esp.evt.type = ESP_EVT_CONN_RECV;
+    esp.evt.evt.conn_data_recv.buff = p;
+    esp.evt.evt.conn_data_recv.conn = conn;
+    espi_send_conn_cb(conn, NULL);
+#if ESP_CFG_IPD_ZERO_COPY
+    espi_pbuf_release_payload(p);               /* Frame memory is reused after return */
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+    esp_pbuf_free(p);
+    return espOK;
+}
+#endif /* ESP_CFG_INPUT_FRAMED || __DOXYGEN__ */
+
+/**
+ * \brief           Check if received string starts with constant string
+ * \note            Length of constant string is known at compile time
+ * \param[in]       rcv: Pointer to \ref esp_recv_t structure with input string
+ * \param[in]       str: Constant string to compare with
+ */
+#define RECV_STARTS_WITH(rcv, str)          (!strncmp((rcv)->data, (str), sizeof(str) - 1))
+
+#if ESP_CFG_MODE_STATION || ESP_CFG_MODE_ACCESS_POINT
+/**
+ * \brief           Process `+CIPSTAMAC` or `+CIPAPMAC` response
+ * \param[in]       rcv: Pointer to \ref esp_recv_t structure with input string
+ */
+static void
+espi_parse_received_mac(esp_recv_t* rcv) {
+    const char* tmp = NULL;
+    esp_mac_t mac;
+
+    if (rcv->data[9] == ':') {
+        tmp = &rcv->data[10];
+    } else if (rcv->data[10] == ':') {
+        tmp = &rcv->data[11];
+    }
+    if (tmp == NULL) {
+        return;
+    }
+
+    espi_parse_mac(&tmp, &mac);                 /* Save as current MAC address */
+#if ESP_CFG_MODE_STATION
+    if (CMD_IS_CUR(ESP_CMD_WIFI_CIPSTAMAC_GET)) {
+        ESP_MEMCPY(&esp.m.sta.mac, &mac, 6);    /* Copy to current setup */
+    }
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+    if (CMD_IS_CUR(ESP_CMD_WIFI_CIPAPMAC_GET)) {
+        ESP_MEMCPY(&esp.m.ap.mac, &mac, 6);     /* Copy to current setup */
+    }
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+    if (esp.msg->msg.sta_ap_getmac.mac != NULL && CMD_IS_CUR(CMD_GET_DEF())) {
+        ESP_MEMCPY(esp.msg->msg.sta_ap_getmac.mac, &mac, sizeof(mac));  /* Copy to current setup */
+    }
+}
+
+/**
+ * \brief           Process `+CIPSTA` or `+CIPAP` response
+ * \param[in]       rcv: Pointer to \ref esp_recv_t structure with input string
+ * \param[in]       im: IP and MAC structure to update
+ */
+static void
+espi_parse_received_ip(esp_recv_t* rcv, esp_ip_mac_t* im) {
+    const char* tmp = NULL;
+    esp_ip_t ip, *a = NULL, *b = NULL;
+    uint8_t ch = 0;
+
+    /* We expect "+CIPSTA:" or "+CIPAP:" ... */
+    if (rcv->data[6] == ':') {
+        ch = rcv->data[7];
+    } else if (rcv->data[7] == ':') {
+        ch = rcv->data[8];
+    }
+    switch (ch) {
+        case 'i': tmp = &rcv->data[10]; a = &im->ip; b = esp.msg->msg.sta_ap_getip.ip; break;
+        case 'g': tmp = &rcv->data[15]; a = &im->gw; b = esp.msg->msg.sta_ap_getip.gw; break;
+        case 'n': tmp = &rcv->data[15]; a = &im->nm; b = esp.msg->msg.sta_ap_getip.nm; break;
+        default: tmp = NULL; a = NULL; b = NULL; break;
+    }
+    if (tmp != NULL) {                          /* Do we have temporary string? */
+        if (*tmp == ':') {
+            ++tmp;
+        }
+        espi_parse_ip(&tmp, &ip);               /* Parse IP address */
+        ESP_CORE_SEQ_WRITE_BEGIN();
+        ESP_MEMCPY(a, &ip, sizeof(ip));         /* Copy to current setup */
+        ESP_CORE_SEQ_WRITE_END();
+        if (b != NULL && CMD_IS_CUR(CMD_GET_DEF())) {   /* Is current command the same as default one? */
+            ESP_MEMCPY(b, &ip, sizeof(ip));     /* Copy to user variable */
+        }
     }
-    if (esp.msg->msg.conn_send.btw > 0) {       /* Do we still have data to send? */
-        if (espi_tcpip_process_send_data() != espOK) {  /* Check if we can continue */
-            return 1;                           /* Finish at this point */
+}
+#endif /* ESP_CFG_MODE_STATION || ESP_CFG_MODE_ACCESS_POINT */
+
+/**
+ * \brief           Process unsolicited statements starting with `+` character
+ *
+ * Statements are dispatched by first character after `+`,
+ * making processing time independent on number of enabled features
+ *
+ * \param[in]       rcv: Pointer to \ref esp_recv_t structure with input string
+ * \return          `1` if statement was processed, `0` otherwise
+ */
+static uint8_t
+espi_parse_received_unsolicited(esp_recv_t* rcv) {
+    switch (rcv->data[1]) {
+        case 'I': {
+            if (RECV_STARTS_WITH(rcv, "+IPD")) {/* Check received network data */
+                espi_parse_ipd(rcv->data);      /* Parse IPD statement and start receiving network data */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+                if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPRECVDATA) && CMD_IS_CUR(ESP_CMD_TCPIP_CIPRECVLEN)) {
+                    esp.msg->msg.ciprecvdata.ipd_recv = 1;  /* Command repeat, try again */
+                }
+                /* IPD message notification? */
+                espi_conn_manual_tcp_try_read_data(esp.m.ipd.conn);
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+                return 1;
+            }
+            break;
         }
-        return 0;                               /* We still have data to send */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE || ESP_CFG_MODE_STATION
+        case 'C': {
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+            if (RECV_STARTS_WITH(rcv, "+CIPRECVDATA")) {
+                espi_parse_ciprecvdata(rcv->data);  /* Parse CIPRECVDATA statement and start receiving network data */
+                return 1;
+            } else if (RECV_STARTS_WITH(rcv, "+CIPRECVLEN")) {
+                espi_parse_ciprecvlen(rcv->data);   /* Parse CIPRECVLEN statement */
+                return 1;
+            }
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+#if ESP_CFG_MODE_STATION
+            if (RECV_STARTS_WITH(rcv, "+CIPUPDATE")) {  /* Update stage is reported also after command finished */
+                const char* tmp = &rcv->data[11];
+                espi_process_update_stage(espi_parse_number(&tmp));
+                return 1;
+            }
+#endif /* ESP_CFG_MODE_STATION */
+            break;
+        }
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE || ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+        case 'S': {
+            if (RECV_STARTS_WITH(rcv, "+STA_CONNECTED")) {
+                espi_parse_ap_conn_disconn_sta(&rcv->data[15], 1);  /* Parse string and send to user layer */
+                return 1;
+            } else if (RECV_STARTS_WITH(rcv, "+STA_DISCONNECTED")) {
+                espi_parse_ap_conn_disconn_sta(&rcv->data[18], 0);  /* Parse string and send to user layer */
+                return 1;
+            }
+            break;
+        }
+        case 'D': {
+            if (RECV_STARTS_WITH(rcv, "+DIST_STA_IP")) {
+                espi_parse_ap_ip_sta(&rcv->data[13]);   /* Parse string and send to user layer */
+                return 1;
+            }
+            break;
+        }
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+#if ESP_CFG_MQTT_AT
+        case 'M': {
+            if (RECV_STARTS_WITH(rcv, "+MQTTCONNECTED")) {
+                espi_mqtt_at_set_connected(1);
+                return 1;
+            } else if (RECV_STARTS_WITH(rcv, "+MQTTDISCONNECTED")) {
+                espi_mqtt_at_set_connected(0);
+                return 1;
+            }
+            break;
+        }
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_BLE
+        case 'B': {
+            if (RECV_STARTS_WITH(rcv, "+BLECONN:")) {
+                espi_ble_set_connected(&rcv->data[9], 1);
+                return 1;
+            } else if (RECV_STARTS_WITH(rcv, "+BLEDISCONN:")) {
+                espi_ble_set_connected(&rcv->data[12], 0);
+                return 1;
+            }
+            break;
+        }
+#endif /* ESP_CFG_BLE */
+        default:
+            break;
     }
-    return 1;                                   /* Everything was sent, we can stop execution */
+    return 0;
 }
 
 /**
- * \brief           Send error event to application layer
- * \param[in]       msg: Message from user with connection start
- * \param[in]       error: Value indicating cause of error
+ * \brief           Process statements starting with `+` character as response to active command
+ *
+ * Current command directly selects expected statement,
+ * only one string comparison is required per received line
+ *
+ * \note            Function must be called only when there is active message
+ * \param[in]       rcv: Pointer to \ref esp_recv_t structure with input string
  */
 static void
-espi_send_conn_error_cb(esp_msg_t* msg, espr_t error) {
-    esp.evt.type = ESP_EVT_CONN_ERROR;          /* Connection error */
-    esp.evt.evt.conn_error.host = esp.msg->msg.conn_start.remote_host;
-    esp.evt.evt.conn_error.port = esp.msg->msg.conn_start.remote_port;
-    esp.evt.evt.conn_error.type = esp.msg->msg.conn_start.type;
-    esp.evt.evt.conn_error.arg = esp.msg->msg.conn_start.arg;
-    esp.evt.evt.conn_error.err = error;
+espi_parse_received_cmd_resp(esp_recv_t* rcv) {
+    switch (CMD_GET_CUR()) {
+#if ESP_CFG_MODE_STATION
+        case ESP_CMD_WIFI_CIPSTAMAC_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CIPSTAMAC")) {
+                espi_parse_received_mac(rcv);
+            }
+            break;
+        }
+        case ESP_CMD_WIFI_CIPSTA_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CIPSTA")) {
+                espi_parse_received_ip(rcv, &esp.m.sta);
+            }
+            break;
+        }
+#if ESP_CFG_STA_LIST_AP
+        case ESP_CMD_WIFI_CWLAP: {
+            if (RECV_STARTS_WITH(rcv, "+CWLAP")) {
+                espi_parse_cwlap(rcv->data, esp.msg);   /* Parse CWLAP entry */
+            }
+            break;
+        }
+#endif /* ESP_CFG_STA_LIST_AP */
+        case ESP_CMD_WIFI_CWJAP: {
+            if (RECV_STARTS_WITH(rcv, "+CWJAP")) {
+                const char* tmp = &rcv->data[7];/* Go to the number position */
+                esp.msg->msg.sta_join.error_num = (uint8_t)espi_parse_number(&tmp);
+            }
+            break;
+        }
+        case ESP_CMD_WIFI_CWJAP_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CWJAP")) {
+                espi_parse_cwjap(rcv->data, esp.msg);   /* Parse CWJAP */
+            }
+            break;
+        }
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+        case ESP_CMD_WIFI_CIPAPMAC_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CIPAPMAC")) {
+                espi_parse_received_mac(rcv);
+            }
+            break;
+        }
+        case ESP_CMD_WIFI_CIPAP_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CIPAP")) {
+                espi_parse_received_ip(rcv, &esp.m.ap);
+            }
+            break;
+        }
+#if ESP_CFG_AP_LIST_STA
+        case ESP_CMD_WIFI_CWLIF: {
+            if (RECV_STARTS_WITH(rcv, "+CWLIF")) {
+                espi_parse_cwlif(rcv->data, esp.msg);   /* Parse CWLIF entry */
+            }
+            break;
+        }
+#endif /* ESP_CFG_AP_LIST_STA */
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+#if ESP_CFG_DNS
+        case ESP_CMD_TCPIP_CIPDOMAIN: {
+            if (RECV_STARTS_WITH(rcv, "+CIPDOMAIN")) {
+                espi_parse_cipdomain(rcv->data, esp.msg);   /* Parse CIPDOMAIN entry */
+            }
+            break;
+        }
+#endif /* ESP_CFG_DNS */
+#if ESP_CFG_PING
+        case ESP_CMD_TCPIP_PING: {
+            if (RECV_STARTS_WITH(rcv, "+PING")) {
+                espi_parse_ping_time(rcv->data, esp.msg);   /* Parse ping time */
+            }
+            break;
+        }
+#endif /* ESP_CFG_PING */
+#if ESP_CFG_SNTP
+        case ESP_CMD_TCPIP_CIPSNTPTIME: {
+            if (RECV_STARTS_WITH(rcv, "+CIPSNTPTIME")) {
+                espi_parse_cipsntptime(rcv->data, esp.msg); /* Parse CIPSNTPTIME entry */
+            }
+            break;
+        }
+#endif /* ESP_CFG_SNTP */
+#if ESP_CFG_HOSTNAME
+        case ESP_CMD_WIFI_CWHOSTNAME_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CWHOSTNAME")) {
+                espi_parse_hostname(rcv->data, esp.msg);/* Parse HOSTNAME entry */
+            }
+            break;
+        }
+#endif /* ESP_CFG_HOSTNAME */
+#if ESP_CFG_TELEMETRY_INTERVAL > 0
+        case ESP_CMD_SYSRAM: {
+            if (RECV_STARTS_WITH(rcv, "+SYSRAM")) {
+                const char* tmp = &rcv->data[8];/* Go to the number position */
+                esp.telemetry.ram_free = ESP_U32(espi_parse_number(&tmp));
+            }
+            break;
+        }
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 */
+        case ESP_CMD_WIFI_CWDHCP_GET: {
+            if (RECV_STARTS_WITH(rcv, "+CWDHCP")) {
+                espi_parse_cwdhcp(rcv->data);   /* Parse CWDHCP state */
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
 
-    /* Call callback specified by user on connection startup */
-    esp.msg->msg.conn_start.evt_func(&esp.evt);
-    ESP_UNUSED(msg);
+/**
+ * \brief           Process final result of current command
+ *
+ * Next subcommand is started or command is finished
+ * and producing thread is notified
+ *
+ * \param[in]       is_ok: Status whether last command result was OK
+ * \param[in]       is_error: Status whether last command result was ERROR
+ * \param[in]       is_ready: Status whether last command result was ready
+ */
+static void
+espi_process_cmd_result(uint8_t is_ok, uint8_t is_error, uint8_t is_ready) {
+    espr_t res = espOK;
+    if (esp.msg != NULL) {                      /* Do we have active message? */
+        res = espi_process_sub_cmd(esp.msg, &is_ok, &is_error, &is_ready);
+        if (res != espCONT) {                   /* Shall we continue with next subcommand under this one? */
+            if (is_ok || is_ready) {            /* Check ready or ok status */
+                res = esp.msg->res = espOK;
+            } else {                            /* Or error status */
+                res = esp.msg->res = res;       /* Set the error status */
+            }
+#if ESP_CFG_CMD_CANCEL
+            /* Only data send is cancelled in progress, report it when data were left */
+            if (esp.msg->cancelled && CMD_IS_DEF(ESP_CMD_TCPIP_CIPSEND) && esp.msg->msg.conn_send.btw > 0) {
+                res = esp.msg->res = espABORTED;
+            }
+#endif /* ESP_CFG_CMD_CANCEL */
+        } else {
+            ++esp.msg->i;                       /* Number of continue calls */
+        }
+
+        /*
+         * When the command is finished,
+         * release synchronization semaphore
+         * from user thread and start with next command
+         */
+        if (res != espCONT) {                   /* Do we have to continue to wait for command? */
+#if !ESP_CFG_OS
+            esp.poll_cmd_done = 1;              /* Finish command in next esp_poll step */
+#elif ESP_CFG_SYS_THREAD_NOTIFY
+            esp_sys_thread_notify(&esp.thread_produce); /* Notify producing thread */
+#else /* ESP_CFG_SYS_THREAD_NOTIFY */
+            esp_sys_sem_release(&esp.sem_sync); /* Release semaphore */
+#endif /* !ESP_CFG_SYS_THREAD_NOTIFY */
+        }
+    }
 }
 
 /**
@@ -561,141 +2164,25 @@ espi_parse_received(esp_recv_t* rcv) {
         espi_send_cb(ESP_EVT_RESET_DETECTED);   /* Call user callback function */
     }
 
+#if ESP_CFG_UPDATE_ASYNC
+    /*
+     * Background update has no active message, except update command itself until producing thread finishes it.
+     * Result received while no other command is in progress belongs to update
+     */
+    if (esp.m.update_active) {
+        if ((esp.msg == NULL || CMD_IS_DEF(ESP_CMD_TCPIP_CIUPDATE)) && (is_ok || is_error)) {
+            espi_update_finish(is_ok ? espOK : espERR);
+            is_ok = is_error = 0;
+        } else if (esp.msg != NULL && !strncmp(rcv->data, "busy", 4)) {
+            is_error = 1;                       /* Device cannot execute command during update */
+        }
+    }
+#endif /* ESP_CFG_UPDATE_ASYNC */
+
     /* Read and process statements starting with '+' character */
     if (rcv->data[0] == '+') {
-        if (!strncmp("+IPD", rcv->data, 4)) {   /* Check received network data */
-            espi_parse_ipd(rcv->data);          /* Parse IPD statement and start receiving network data */
-#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
-            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPRECVDATA) && CMD_IS_CUR(ESP_CMD_TCPIP_CIPRECVLEN)) {
-                esp.msg->msg.ciprecvdata.ipd_recv = 1;  /* Command repeat, try again */
-            }
-            /* IPD message notification? */
-            espi_conn_manual_tcp_try_read_data(esp.m.ipd.conn);
-        } else if (!strncmp("+CIPRECVDATA", rcv->data, 12)) {
-            espi_parse_ciprecvdata(rcv->data);  /* Parse CIPRECVDATA statement and start receiving network data */
-        } else if (!strncmp("+CIPRECVLEN", rcv->data, 11)) {
-            espi_parse_ciprecvlen(rcv->data);   /* Parse CIPRECVLEN statement */
-#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
-#if ESP_CFG_MODE_ACCESS_POINT
-        } else if (!strncmp(rcv->data, "+STA_CONNECTED", 14)) {
-            espi_parse_ap_conn_disconn_sta(&rcv->data[15], 1);  /* Parse string and send to user layer */
-        } else if (!strncmp(rcv->data, "+STA_DISCONNECTED", 17)) {
-            espi_parse_ap_conn_disconn_sta(&rcv->data[18], 0);  /* Parse string and send to user layer */
-        } else if (!strncmp(rcv->data, "+DIST_STA_IP", 12)) {
-            espi_parse_ap_ip_sta(&rcv->data[13]);   /* Parse string and send to user layer */
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
-        } else if (esp.msg != NULL) {
-            if (0
-#if ESP_CFG_MODE_STATION
-                || (CMD_IS_CUR(ESP_CMD_WIFI_CIPSTAMAC_GET) && !strncmp(rcv->data, "+CIPSTAMAC", 10))
-#endif /* ESP_CFG_MODE_STATION */
-#if ESP_CFG_MODE_ACCESS_POINT
-                || (CMD_IS_CUR(ESP_CMD_WIFI_CIPAPMAC_GET) && !strncmp(rcv->data, "+CIPAPMAC", 9))
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
-            ) {
-                const char* tmp;
-                esp_mac_t mac;
-
-                if (rcv->data[9] == ':') {
-                    tmp = &rcv->data[10];
-                } else if (rcv->data[10] == ':') {
-                    tmp = &rcv->data[11];
-                }
-
-                espi_parse_mac(&tmp, &mac);     /* Save as current MAC address */
-#if ESP_CFG_MODE_STATION
-                if (CMD_IS_CUR(ESP_CMD_WIFI_CIPSTAMAC_GET)) {
-                    ESP_MEMCPY(&esp.m.sta.mac, &mac, 6);/* Copy to current setup */
-                }
-#endif /* ESP_CFG_MODE_STATION */
-#if ESP_CFG_MODE_ACCESS_POINT
-                if (CMD_IS_CUR(ESP_CMD_WIFI_CIPAPMAC_GET)) {
-                    ESP_MEMCPY(&esp.m.ap.mac, &mac, 6); /* Copy to current setup */
-                }
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
-                if (esp.msg->msg.sta_ap_getmac.mac != NULL && CMD_IS_CUR(CMD_GET_DEF())) {
-                    ESP_MEMCPY(esp.msg->msg.sta_ap_getmac.mac, &mac, sizeof(mac));  /* Copy to current setup */
-                }
-            } else if (0
-#if ESP_CFG_MODE_STATION
-                || (CMD_IS_CUR(ESP_CMD_WIFI_CIPSTA_GET) && !strncmp(rcv->data, "+CIPSTA", 7))
-#endif /* ESP_CFG_MODE_STATION */
-#if ESP_CFG_MODE_ACCESS_POINT
-                || (CMD_IS_CUR(ESP_CMD_WIFI_CIPAP_GET) && !strncmp(rcv->data, "+CIPAP", 6))
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
-            ) {
-                const char* tmp = NULL;
-                esp_ip_t ip, *a = NULL, *b = NULL;
-                esp_ip_mac_t* im;
-                uint8_t ch = 0;
-
-#if ESP_CFG_MODE_STATION
-                if (CMD_IS_CUR(ESP_CMD_WIFI_CIPSTA_GET)) {
-                    im = &esp.m.sta;            /* Get IP and MAC structure first */
-                }
-#endif /* ESP_CFG_MODE_STATION */
-#if ESP_CFG_MODE_ACCESS_POINT
-                if (CMD_IS_CUR(ESP_CMD_WIFI_CIPAP_GET)) {
-                    im = &esp.m.ap;             /* Get IP and MAC structure first */
-                }
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
-
-                if (im != NULL) {
-                    /* We expect "+CIPSTA:" or "+CIPAP:" ... */
-                    if (rcv->data[6] == ':') {
-                        ch = rcv->data[7];
-                    } else if (rcv->data[7] == ':') {
-                        ch = rcv->data[8];
-                    }
-                    switch (ch) {
-                        case 'i': tmp = &rcv->data[10]; a = &im->ip; b = esp.msg->msg.sta_ap_getip.ip; break;
-                        case 'g': tmp = &rcv->data[15]; a = &im->gw; b = esp.msg->msg.sta_ap_getip.gw; break;
-                        case 'n': tmp = &rcv->data[15]; a = &im->nm; b = esp.msg->msg.sta_ap_getip.nm; break;
-                        default: tmp = NULL; a = NULL; b = NULL; break;
-                    }
-                    if (tmp != NULL) {          /* Do we have temporary string? */
-                        if (*tmp == ':') {
-                            ++tmp;
-                        }
-                        espi_parse_ip(&tmp, &ip);   /* Parse IP address */
-                        ESP_MEMCPY(a, &ip, sizeof(ip)); /* Copy to current setup */
-                        if (b != NULL && CMD_IS_CUR(CMD_GET_DEF())) {   /* Is current command the same as default one? */
-                            ESP_MEMCPY(b, &ip, sizeof(ip)); /* Copy to user variable */
-                        }
-                    }
-                }
-#if ESP_CFG_MODE_STATION
-            } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWLAP) && !strncmp(rcv->data, "+CWLAP", 6)) {
-                espi_parse_cwlap(rcv->data, esp.msg);   /* Parse CWLAP entry */
-            } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWJAP) && !strncmp(rcv->data, "+CWJAP", 6)) {
-                const char* tmp = &rcv->data[7];/* Go to the number position */
-                esp.msg->msg.sta_join.error_num = (uint8_t)espi_parse_number(&tmp);
-            } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWJAP_GET) && !strncmp(rcv->data, "+CWJAP", 6)) {
-                espi_parse_cwjap(rcv->data, esp.msg);/* Parse CWJAP */
-#endif /* ESP_CFG_MODE_STATION */
-#if ESP_CFG_MODE_ACCESS_POINT
-            } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWLIF) && !strncmp(rcv->data, "+CWLIF", 6)) {
-                espi_parse_cwlif(rcv->data, esp.msg);   /* Parse CWLIF entry */
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
-#if ESP_CFG_DNS
-            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPDOMAIN) && !strncmp(rcv->data, "+CIPDOMAIN", 10)) {
-                espi_parse_cipdomain(rcv->data, esp.msg);   /* Parse CIPDOMAIN entry */
-#endif /* ESP_CFG_DNS */ 
-#if ESP_CFG_PING
-            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_PING) && !strncmp(rcv->data, "+PING", 5)) {
-                espi_parse_ping_time(rcv->data, esp.msg);   /* Parse ping time */
-#endif /* ESP_CFG_PING */
-#if ESP_CFG_SNTP
-            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSNTPTIME) && !strncmp(rcv->data, "+CIPSNTPTIME", 12)) {
-                espi_parse_cipsntptime(rcv->data, esp.msg); /* Parse CIPSNTPTIME entry */
-#endif /* ESP_CFG_SNTP */
-#if ESP_CFG_HOSTNAME
-            } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWHOSTNAME_GET) && !strncmp(rcv->data, "+CWHOSTNAME", 11)) {
-                espi_parse_hostname(rcv->data, esp.msg);/* Parse HOSTNAME entry */
-#endif /* ESP_CFG_HOSTNAME */
-            } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWDHCP_GET) && !strncmp(rcv->data, "+CWDHCP", 7)) {
-                espi_parse_cwdhcp(rcv->data);   /* Parse CWDHCP state */
-            }
+        if (!espi_parse_received_unsolicited(rcv) && esp.msg != NULL) {
+            espi_parse_received_cmd_resp(rcv);  /* Process as response to current command */
         }
 #if ESP_CFG_MODE_STATION
     } else if (strlen(rcv->data) > 4 && !strncmp(rcv->data, "WIFI", 4)) {
@@ -708,9 +2195,15 @@ espi_parse_received(esp_recv_t* rcv) {
         } else if (!strncmp(&rcv->data[5], "DISCONNECT", 10)) {
             esp.m.sta.is_connected = 0;         /* Wifi is disconnected */
             esp.m.sta.has_ip = 0;               /* There is no valid IP */
+#if ESP_CFG_GETTER_CACHE
+            esp.m.cache_valid &= ~ESP_CACHE_STA_IP;
+#endif /* ESP_CFG_GETTER_CACHE */
             espi_send_cb(ESP_EVT_WIFI_DISCONNECTED);/* Call user callback function */
         } else if (!strncmp(&rcv->data[5], "GOT IP", 6)) {
             esp.m.sta.has_ip = 1;               /* Wifi got IP address */
+#if ESP_CFG_GETTER_CACHE
+            esp.m.cache_valid &= ~ESP_CACHE_STA_IP; /* Wait for new address to be read */
+#endif /* ESP_CFG_GETTER_CACHE */
             espi_send_cb(ESP_EVT_WIFI_GOT_IP);  /* Call user callback function */
             if (!CMD_IS_CUR(ESP_CMD_WIFI_CWJAP)) { /* In case of auto connection */
                 esp_sta_getip(NULL, NULL, NULL, NULL, NULL, 0); /* Get new IP address */
@@ -763,13 +2256,17 @@ espi_parse_received(esp_recv_t* rcv) {
         if ((CMD_IS_CUR(ESP_CMD_RESET) || CMD_IS_CUR(ESP_CMD_RESTORE)) && is_ok) {  /* Check for reset/restore command */
             is_ok = 0;                          /* We must wait for "ready", not only "OK" */
             esp.ll.uart.baudrate = ESP_CFG_AT_PORT_BAUDRATE;/* Save user baudrate */
-            esp_ll_init(&esp.ll);               /* Set new baudrate */
+            espi_ll_init();                     /* Set new baudrate */
         } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTATUS)) {
             if (!strncmp(rcv->data, "+CIPSTATUS", 10)) {
                 espi_parse_cipstatus(rcv->data + 11);   /* Parse CIPSTATUS response */
             } else if (is_ok) {
-                for (size_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {    /* Set current connection statuses */
-                    esp.m.conns[i].status.f.active = !!(esp.m.active_conns & (1 << i));
+                /* Update only connections which status differs from reported one */
+                uint32_t changed = (esp.m.conns_active_mask ^ esp.m.active_conns) & ESP_CONN_ALL_BITS;
+                while (changed) {
+                    uint8_t i = espi_bit_ffs(changed);
+                    changed &= changed - 1;
+                    ESP_CONN_SET_ACTIVE(&esp.m.conns[i], esp.m.active_conns & ESP_CONN_BIT(i));
                 }
             }
         } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)) {
@@ -790,11 +2287,36 @@ espi_parse_received(esp_recv_t* rcv) {
                 is_ok = 0;                      /* Do not reach on OK */
             }
             if (esp.msg->msg.conn_send.wait_send_ok_err) {
+#if ESP_CFG_CONN_SEND_PIPELINE
+                if (esp.msg->msg.conn_send.pipe_len > 0 && !esp.msg->msg.conn_send.pipe_data_sent
+                    && (is_error || !strncmp("busy", rcv->data, 4))) {
+                    /* Command for next segment was not accepted, send it normally after current segment */
+                    esp.msg->msg.conn_send.pipe_len = 0;
+                    is_error = 0;
+                } else if (esp.msg->msg.conn_send.pipe_failed
+                    && (is_error || !strncmp("SEND OK", rcv->data, 7) || !strncmp("SEND FAIL", rcv->data, 9))) {
+                    /* Segment started before failure is finished, device is in sync again */
+                    esp.msg->msg.conn_send.wait_send_ok_err = 0;
+                    is_error = 1;
+                    if (esp.msg->msg.conn_send.conn->status.f.active) {
+                        CONN_SEND_DATA_SEND_EVT(esp.msg, espERR);
+                    }
+                } else if (!strncmp("Recv ", rcv->data, 5)) {   /* Device received all data of current segment */
+                    espi_tcpip_process_send_pipeline();
+                } else
+#endif /* ESP_CFG_CONN_SEND_PIPELINE */
                 if (!strncmp("SEND OK", rcv->data, 7)) {    /* Data were sent successfully */
                     esp.msg->msg.conn_send.wait_send_ok_err = 0;
                     is_ok = espi_tcpip_process_data_sent(1);    /* Process as data were sent */
                     if (is_ok && esp.msg->msg.conn_send.conn->status.f.active) {
+#if ESP_CFG_CMD_CANCEL
+                        CONN_SEND_DATA_SEND_EVT(esp.msg, esp.msg->cancelled && esp.msg->msg.conn_send.btw > 0 ? espABORTED : espOK);
+#else /* ESP_CFG_CMD_CANCEL */
                         CONN_SEND_DATA_SEND_EVT(esp.msg, espOK);
+#endif /* !ESP_CFG_CMD_CANCEL */
+#if ESP_CFG_CONN_WRITE_LINGER
+                        espi_conn_write_idle(esp.msg->msg.conn_send.conn);  /* Send data coalesced meanwhile */
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
                     }
                 } else if (is_error || !strncmp("SEND FAIL", rcv->data, 9)) {
                     esp.msg->msg.conn_send.wait_send_ok_err = 0;
@@ -803,13 +2325,36 @@ espi_parse_received(esp_recv_t* rcv) {
                         CONN_SEND_DATA_SEND_EVT(esp.msg, espERR);
                     }
                 }
+#if ESP_CFG_CONN_SEND_PACING
+            } else if (!strncmp("busy", rcv->data, 4)) {    /* Device is overloaded and did not accept command */
+                is_error = espi_tcpip_process_data_sent(0); /* Retry after backoff */
+                if (is_error && esp.msg->msg.conn_send.conn->status.f.active) {
+                    CONN_SEND_DATA_SEND_EVT(esp.msg, espERR);
+                }
+#endif /* ESP_CFG_CONN_SEND_PACING */
             } else if (is_error) {
                 CONN_SEND_DATA_SEND_EVT(esp.msg, espERR);
             }
+#if ESP_CFG_MQTT_AT
+        } else if (CMD_IS_CUR(ESP_CMD_MQTT_PUBRAW)) {
+            if (!esp.msg->msg.mqtt_at.wait_result) {
+                is_ok = 0;                      /* Wait for "> " prompt after OK */
+            } else if (!strncmp(rcv->data, "+MQTTPUB:OK", 11)) {
+                is_ok = 1;
+            } else if (!strncmp(rcv->data, "+MQTTPUB:FAIL", 13)) {
+                is_error = 1;
+            }
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_BLE
+        } else if (CMD_IS_CUR(ESP_CMD_BLEGATTSNTFY)) {
+            if (!esp.msg->msg.ble.wait_result) {
+                is_ok = 0;                      /* Data were not sent yet, wait for "> " prompt */
+            }
+#endif /* ESP_CFG_BLE */
         } else if (CMD_IS_CUR(ESP_CMD_UART)) {  /* In case of UART command */
             if (is_ok) {                        /* We have valid OK result */
-                esp.ll.uart.baudrate = esp.msg->msg.uart.baudrate;  /* Save user baudrate */
-                esp_ll_init(&esp.ll);           /* Set new baudrate */
+                esp.ll.uart.baudrate = espi_get_uart_cmd_baudrate(esp.msg);/* Save user baudrate */
+                espi_ll_init();                 /* Set new baudrate */
             }
         }
     }
@@ -827,7 +2372,7 @@ espi_parse_received(esp_recv_t* rcv) {
             uint8_t id;
             esp_conn_t* conn = &esp.m.conns[esp.m.link_conn.num];   /* Get connection pointer */
             if (esp.m.link_conn.failed && conn->status.f.active) {  /* Connection failed and now closed? */
-                conn->status.f.active = 0;      /* Connection was just closed */
+                ESP_CONN_SET_ACTIVE(conn, 0);   /* Connection was just closed */
 
                 esp.evt.type = ESP_EVT_CONN_CLOSE;
                 esp.evt.evt.conn_active_close.conn = conn;
@@ -841,13 +2386,18 @@ espi_parse_received(esp_recv_t* rcv) {
                 if (conn->buff.buff != NULL) {
                     ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
                         "[CONN] Free write buffer: %p\r\n", conn->buff.buff);
-                    esp_mem_free_s((void **)&conn->buff.buff);
+                    espi_conn_buff_free(conn->buff.buff);
+                    conn->buff.buff = NULL;
                 }
             } else if (!esp.m.link_conn.failed && !conn->status.f.active) {
+#if ESP_CFG_EVT_DEFERRED
+                espi_evt_deferred_flush();      /* Deliver events of previous connection first */
+#endif /* ESP_CFG_EVT_DEFERRED */
                 id = conn->val_id;
+                ESP_CORE_SEQ_WRITE_BEGIN();
                 ESP_MEMSET(conn, 0x00, sizeof(*conn));  /* Reset connection parameters */
                 conn->num = esp.m.link_conn.num;/* Set connection number */
-                conn->status.f.active = !esp.m.link_conn.failed;    /* Check if connection active */
+                ESP_CONN_SET_ACTIVE(conn, !esp.m.link_conn.failed); /* Check if connection active */
                 conn->val_id = ++id;            /* Set new validation ID */
 
                 conn->type = esp.m.link_conn.type;/* Set connection type */
@@ -855,6 +2405,10 @@ espi_parse_received(esp_recv_t* rcv) {
                 conn->remote_port = esp.m.link_conn.remote_port;
                 conn->local_port = esp.m.link_conn.local_port;
                 conn->status.f.client = !esp.m.link_conn.is_server;
+#if ESP_CFG_CONN_WRITE_LINGER
+                conn->write_linger = ESP_CFG_CONN_WRITE_LINGER_TIME;
+#endif /* ESP_CFG_CONN_WRITE_LINGER */
+                ESP_CORE_SEQ_WRITE_END();
 
                 if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)
                     && esp.m.link_conn.num == esp.msg->msg.conn_start.num
@@ -863,6 +2417,11 @@ espi_parse_received(esp_recv_t* rcv) {
                     conn->evt_func = esp.msg->msg.conn_start.evt_func;  /* Set callback function */
                     conn->arg = esp.msg->msg.conn_start.arg;    /* Set argument for function */
                     esp.msg->msg.conn_start.success = 1;
+#if ESP_CFG_DNS_CACHE_SIZE > 0
+                    if (conn->type != ESP_CONN_TYPE_SSL) {
+                        espi_dns_cache_put(esp.msg->msg.conn_start.remote_host, &conn->remote_ip);
+                    }
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 */
                 } else {                        /* Server connection start */
                     conn->evt_func = esp.evt_server;/* Set server default callback */
                     conn->arg = NULL;
@@ -880,6 +2439,10 @@ espi_parse_received(esp_recv_t* rcv) {
     /*
     } else if (!strncmp(",CLOSED", &rcv->data[1], 7)) {
         const char* tmp = rcv->data; */
+#if ESP_CFG_SINGLE_CONN
+    } else if (RECV_STARTS_WITH(rcv, "CLOSED" CRLF) || RECV_STARTS_WITH(rcv, "CONNECT FAIL" CRLF)) {
+        uint32_t num = 0;                       /* Line has no link ID in single connection mode */
+#else /* ESP_CFG_SINGLE_CONN */
     } else if ( (rcv->len > 9  && (s = strstr(rcv->data, ",CLOSED" CRLF)) != NULL) ||
                 (rcv->len > 15 && (s = strstr(rcv->data, ",CONNECT FAIL" CRLF)) != NULL)) {
         const char* tmp = s;
@@ -888,11 +2451,12 @@ espi_parse_received(esp_recv_t* rcv) {
             --tmp;
         }
         num = espi_parse_number(&tmp);          /* Parse connection number */
+#endif /* !ESP_CFG_SINGLE_CONN */
         if (num < ESP_CFG_MAX_CONNS) {
             esp_conn_t* conn = &esp.m.conns[num];   /* Parse received data */
             conn->num = num;                    /* Set connection number */
             if (conn->status.f.active) {        /* Is connection actually active? */
-                conn->status.f.active = 0;      /* Connection was just closed */
+                ESP_CONN_SET_ACTIVE(conn, 0);   /* Connection was just closed */
 
                 esp.evt.type = ESP_EVT_CONN_CLOSE;
                 esp.evt.evt.conn_active_close.conn = conn;
@@ -917,7 +2481,8 @@ espi_parse_received(esp_recv_t* rcv) {
             if (conn->buff.buff != NULL) {
                 ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE,
                     "[CONN] Free write buffer: %p\r\n", conn->buff.buff);
-                esp_mem_free_s((void **)&conn->buff.buff);
+                espi_conn_buff_free(conn->buff.buff);
+                conn->buff.buff = NULL;
             }
         }
     } else if (is_error && CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)) {
@@ -939,31 +2504,240 @@ espi_parse_received(esp_recv_t* rcv) {
      * and proceed with next command
      */
     if (is_ok || is_error || is_ready) {
-        espr_t res = espOK;
-        if (esp.msg != NULL) {                  /* Do we have active message? */
-            res = espi_process_sub_cmd(esp.msg, &is_ok, &is_error, &is_ready);
-            if (res != espCONT) {               /* Shall we continue with next subcommand under this one? */
-                if (is_ok || is_ready) {        /* Check ready or ok status */
-                    res = esp.msg->res = espOK;
-                } else {                        /* Or error status */
-                    res = esp.msg->res = res;   /* Set the error status */
-                }
+        espi_process_cmd_result(is_ok, is_error, is_ready);
+    }
+}
+
+/**
+ * \brief           Prepare packet buffer for next chunk of IPD data
+ * \param[in]       len: Length of data chunk in units of bytes
+ */
+static void
+espi_ipd_new_buff(size_t len) {
+#if ESP_CFG_LATENCY_TRACE
+    esp.m.ipd.trace_start = esp_sys_now();
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_IPD_ZERO_COPY
+    /*
+     * Packet buffer is allocated once first byte of data is received,
+     * as only then it is known if entire chunk is available in input memory.
+     *
+     * Chained buffers outlive input memory and are always copied
+     */
+#if ESP_CFG_IPD_ALLOC_POLICY
+    if (!esp.m.ipd.whole)
+#endif /* ESP_CFG_IPD_ALLOC_POLICY */
+    {
+        esp.m.ipd.buff = NULL;
+        esp.m.ipd.buff_deferred_len = len;
+        return;
+    }
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+    esp.m.ipd.buff = esp_pbuf_new(len);         /* Allocate new packet buffer */
+    ESP_DEBUGW(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING, esp.m.ipd.buff == NULL,
+        "[IPD] Buffer allocation failed for %d byte(s)\r\n", (int)len);
+    if (esp.m.ipd.buff != NULL) {
+        esp_pbuf_set_ip(esp.m.ipd.buff, &esp.m.ipd.ip, esp.m.ipd.port); /* Set IP and port for received data */
+#if ESP_CFG_IPD_ALLOC_POLICY
+        if (esp.m.ipd.whole) {
+            if (esp.m.ipd.buff_head == NULL) {
+                esp.m.ipd.buff_head = esp.m.ipd.buff;
             } else {
-                ++esp.msg->i;                   /* Number of continue calls */
+                esp_pbuf_cat(esp.m.ipd.buff_head, esp.m.ipd.buff);
             }
+        }
+#endif /* ESP_CFG_IPD_ALLOC_POLICY */
+    }
+}
 
-            /*
-             * When the command is finished,
-             * release synchronization semaphore
-             * from user thread and start with next command
-             */
-            if (res != espCONT) {               /* Do we have to continue to wait for command? */
-                esp_sys_sem_release(&esp.sem_sync); /* Release semaphore */
+/**
+ * \brief           Get size of next packet buffer for IPD data
+ * \param[in]       is_first: Set to `1` for first buffer of `+IPD` statement
+ * \return          Buffer size in units of bytes
+ */
+static size_t
+espi_ipd_alloc_len(uint8_t is_first) {
+#if ESP_CFG_IPD_ALLOC_POLICY
+    esp_ipd_alloc_t req;
+    size_t len = 0;
+#if ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM
+    esp_mem_stats_t stats;
+#endif /* ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM */
+
+    ESP_MEMSET(&req, 0x00, sizeof(req));
+    req.conn = esp.m.ipd.conn;
+    req.ipd_len = esp.m.ipd.tot_len;
+    req.rem_len = esp.m.ipd.rem_len;
+    req.mem_free = SIZE_MAX;
+    req.is_first = is_first;
+#if ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM
+    if (esp_mem_get_stats(&stats)) {
+        req.mem_free = stats.max_free_block;
+    }
+#endif /* ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM */
+
+    if (esp.ipd_alloc_fn != NULL) {
+        len = esp.ipd_alloc_fn(&req);
+    }
+    if (len == 0) {                             /* Default policy */
+        len = ESP_MIN(req.rem_len, ESP_CFG_IPD_MAX_BUFF_SIZE);
+#if ESP_CFG_PBUF_POOL
+        len = ESP_MIN(len, ESP_CFG_PBUF_POOL_2_SIZE);   /* Full-size buffers fit largest pool class */
+#endif /* ESP_CFG_PBUF_POOL */
+        if (req.mem_free < len + 2 * sizeof(esp_pbuf_t) && req.mem_free > 4 * sizeof(esp_pbuf_t)) {
+            len = req.mem_free - 2 * sizeof(esp_pbuf_t);/* Smaller buffer rather than failed allocation */
+        }
+    }
+    if (is_first) {
+        esp.m.ipd.whole = req.whole;
+        esp.m.ipd.buff_head = NULL;
+    }
+    return ESP_MAX(1, ESP_MIN(len, req.rem_len));
+#else /* ESP_CFG_IPD_ALLOC_POLICY */
+    ESP_UNUSED(is_first);
+    return ESP_MIN(esp.m.ipd.rem_len, ESP_CFG_IPD_MAX_BUFF_SIZE);
+#endif /* !ESP_CFG_IPD_ALLOC_POLICY */
+}
+
+/**
+ * \brief           Prepare first packet buffer after `+IPD` header has been parsed
+ */
+static void
+espi_ipd_read_start(void) {
+    size_t len;
+
+    if (!esp.m.ipd.read) {                      /* Shall we start read procedure? */
+        return;
+    }
+    ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
+        "[IPD] Data on connection %d with total size %d byte(s)\r\n",
+        (int)esp.m.ipd.conn->num, (int)esp.m.ipd.tot_len);
+
+    len = espi_ipd_alloc_len(1);
+
+    /*
+     * Read received data in case of:
+     *
+     *  - Connection is active and
+     *  - Connection is not in closing mode
+     */
+    if (esp.m.ipd.conn->status.f.active && !esp.m.ipd.conn->status.f.in_closing) {
+        espi_ipd_new_buff(len);                 /* Allocate new packet buffer */
+    } else {
+        esp.m.ipd.buff = NULL;                  /* Ignore reading on closed connection */
+        ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
+            "[IPD] Connection %d closed or in closing, skipping %d byte(s)\r\n",
+            (int)esp.m.ipd.conn->num, (int)len);
+    }
+    esp.m.ipd.conn->status.f.data_received = 1; /* We have first received data */
+    esp.m.ipd.buff_ptr = 0;                     /* Reset buffer write pointer */
+#if ESP_CFG_LATENCY_TRACE
+    esp.m.ipd.trace_in = esp.trace_rx_cur;      /* Header arrival time is used for all data buffers */
+#endif /* ESP_CFG_LATENCY_TRACE */
+}
+
+#if ESP_CFG_IPD_HDR_FAST || __DOXYGEN__
+
+/**
+ * \brief           Feed bytes to incremental `+IPD` header recognizer
+ *
+ * Recognized bytes are stored to receive buffer without termination,
+ * so that regular line parser can continue where recognizer gave up.
+ *
+ * \param[in]       d: Input data
+ * \param[in]       d_len: Length of input data
+ * \param[out]      done: Set to `1` when complete data header was received and IPD read has started
+ * \return          Number of consumed bytes. Byte that aborted recognition is not consumed
+ */
+static size_t
+espi_ipd_hdr_process(const uint8_t* d, size_t d_len, uint8_t* done) {
+    static const char prefix[] = "+IPD,";
+    size_t i;
+
+    *done = 0;
+    for (i = 0; i < d_len; ++i) {
+        uint8_t ch = d[i];
+
+        if (esp.ipd_hdr.state < 5) {            /* Match fixed "+IPD," prefix */
+            if (ch != (uint8_t)prefix[esp.ipd_hdr.state]) {
+                break;
+            }
+            if (++esp.ipd_hdr.state == 5) {
+                esp.ipd_hdr.conn = 0;
+                esp.ipd_hdr.len = 0;
+                esp.ipd_hdr.num = 0;
+                esp.ipd_hdr.ip_idx = 0;
+                esp.ipd_hdr.has_ip = 0;
+#if ESP_CFG_SINGLE_CONN
+                esp.ipd_hdr.state = 6;          /* No link ID field, length follows prefix */
+#endif /* ESP_CFG_SINGLE_CONN */
+            }
+        } else if (ESP_CHARISNUM(ch)) {         /* Digit of any numeric field */
+            switch (esp.ipd_hdr.state) {
+                case 5: esp.ipd_hdr.conn = esp.ipd_hdr.conn * 10 + ESP_CHARTONUM(ch); break;
+                case 6: esp.ipd_hdr.len = esp.ipd_hdr.len * 10 + ESP_CHARTONUM(ch); break;
+                default: esp.ipd_hdr.num = esp.ipd_hdr.num * 10 + ESP_CHARTONUM(ch); break;
+            }
+        } else if (ch == ',' && esp.ipd_hdr.state < 8) {
+            if (esp.ipd_hdr.state == 7) {       /* End of IP address */
+                if (esp.ipd_hdr.ip_idx != 3) {
+                    break;
+                }
+                esp.ipd_hdr.ip.ip[3] = (uint8_t)esp.ipd_hdr.num;
+                esp.ipd_hdr.num = 0;
+                esp.ipd_hdr.has_ip = 1;
+            }
+            ++esp.ipd_hdr.state;
+        } else if (ch == '.' && esp.ipd_hdr.state == 7 && esp.ipd_hdr.ip_idx < 3) {
+            esp.ipd_hdr.ip.ip[esp.ipd_hdr.ip_idx++] = (uint8_t)esp.ipd_hdr.num;
+            esp.ipd_hdr.num = 0;
+        } else if (ch == '"' && esp.ipd_hdr.state == 7) {
+            /* Quotes around IP address are optional */
+        } else if (ch == ':' && (esp.ipd_hdr.state == 6 || esp.ipd_hdr.state == 8)
+                    && esp.ipd_hdr.conn < ESP_CFG_MAX_CONNS) {
+            esp_conn_p c = &esp.m.conns[esp.ipd_hdr.conn];
+
+            if (esp.ipd_hdr.has_ip) {           /* Same as espi_parse_ipd for data packets */
+                ESP_MEMCPY(&esp.m.ipd.ip, &esp.ipd_hdr.ip, sizeof(esp.m.ipd.ip));
+                esp.m.ipd.port = (esp_port_t)esp.ipd_hdr.num;
+                ESP_CORE_SEQ_WRITE_BEGIN();
+                ESP_MEMCPY(&c->remote_ip, &esp.m.ipd.ip, sizeof(esp.m.ipd.ip));
+                ESP_MEMCPY(&c->remote_port, &esp.m.ipd.port, sizeof(esp.m.ipd.port));
+                ESP_CORE_SEQ_WRITE_END();
             }
+            esp.m.ipd.tot_len = esp.ipd_hdr.len;
+            esp.m.ipd.conn = c;
+            esp.m.ipd.read = 1;
+            esp.m.ipd.rem_len = esp.ipd_hdr.len;
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPRECVDATA) && CMD_IS_CUR(ESP_CMD_TCPIP_CIPRECVLEN)) {
+                esp.msg->msg.ciprecvdata.ipd_recv = 1;  /* Command repeat, try again */
+            }
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+
+            esp.ipd_hdr.state = 0;
+            RECV_RESET();
+            espi_ipd_read_start();
+            *done = 1;
+            return i + 1;
+        } else {                                /* Not a data header */
+            break;
+        }
+
+        /* Keep raw copy for regular parser in case recognition fails later */
+        if (esp.recv_buff.len < sizeof(esp.recv_buff.data) - 1) {
+            esp.recv_buff.data[esp.recv_buff.len++] = ch;
         }
     }
+    if (i < d_len) {                            /* Recognition aborted, give control to line parser */
+        esp.ipd_hdr.state = 0;
+        esp.recv_buff.data[esp.recv_buff.len] = 0;
+    }
+    return i;
 }
 
+#endif /* ESP_CFG_IPD_HDR_FAST || __DOXYGEN__ */
+
 #if !ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__
 /**
  * \brief           Process data from input buffer
@@ -971,32 +2745,60 @@ espi_parse_received(esp_recv_t* rcv) {
  */
 espr_t
 espi_process_buffer(void) {
-    void* data;
-    size_t len;
-
-    do {
-        /*
-         * Get length of linear memory in buffer
-         * we can process directly as memory
-         */
-        len = esp_buff_get_linear_block_read_length(&esp.buff);
-        if (len > 0) {
-            /*
-             * Get memory address of first element
-             * in linear block of data to process
-             */
-            data = esp_buff_get_linear_block_read_address(&esp.buff);
+    esp_buff_block_t blocks[2];
+    const uint8_t* data;
+    size_t len, chunk;
+
+#if ESP_CFG_RX_STATS
+    /* Report dropped data before processing corrupted stream */
+    if (esp.rx_stats.overflows != esp.rx_overflows_reported) {
+        esp.rx_overflows_reported = esp.rx_stats.overflows;
+        esp.evt.evt.rx_overflow.overflows = esp.rx_stats.overflows;
+        esp.evt.evt.rx_overflow.dropped = esp.rx_stats.dropped;
+        espi_send_cb(ESP_EVT_RX_OVERFLOW);
+    }
+#endif /* ESP_CFG_RX_STATS */
 
-            /* Process actual received data */
-            espi_process(data, len);
+    /*
+     * Peek both wrap segments at once and
+     * process them directly as memory
+     */
+    while (esp_buff_get_read_blocks(&esp.buff, blocks) > 0) {
+#if ESP_CFG_LATENCY_TRACE
+        if (esp.trace_rx_pending) {             /* Data written after this point get new timestamp */
+            esp.trace_rx_cur = esp.trace_rx_time;
+            esp.trace_rx_pending = 0;
+            espi_trace_add(ESP_TRACE_RX_INPUT, esp_sys_now() - esp.trace_rx_cur);
+        }
+#endif /* ESP_CFG_LATENCY_TRACE */
+        for (size_t i = 0; i < ESP_ARRAYSIZE(blocks); ++i) {
+            data = blocks[i].data;
+            len = blocks[i].len;
+            while (len > 0) {
+                chunk = len;
+#if ESP_CFG_RCV_BUFF_COMMIT_LEN
+                chunk = ESP_MIN(chunk, ESP_CFG_RCV_BUFF_COMMIT_LEN);
+#endif /* ESP_CFG_RCV_BUFF_COMMIT_LEN */
+
+                /* Process actual received data */
+                espi_process(data, chunk);
 
-            /*
-             * Once data is processed, simply skip
-             * the buffer memory and start over
-             */
-            esp_buff_skip(&esp.buff, len);
+                /*
+                 * Once data is processed, release
+                 * buffer memory back to producer
+                 */
+                esp_buff_skip(&esp.buff, chunk);
+                data += chunk;
+                len -= chunk;
+#if ESP_CFG_INPUT_FLOW_CTRL
+                if (esp.input_paused && esp_buff_get_full(&esp.buff) <= ESP_CFG_INPUT_FLOW_LOW) {
+                    esp.input_paused = 0;       /* Enough free memory, resume device */
+                    esp.ll.flow_fn(0);
+                }
+#endif /* ESP_CFG_INPUT_FLOW_CTRL */
+            }
         }
-    } while (len);
+    }
     return espOK;
 }
 #endif /* !ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__ */
@@ -1012,33 +2814,82 @@ espi_process(const void* data, size_t data_len) {
     uint8_t ch;
     const uint8_t* d = data;
     size_t d_len = data_len;
-    static uint8_t ch_prev1, ch_prev2;
-    static esp_unicode_t unicode;
+
+#if ESP_CFG_AT_CAPTURE
+    espi_capture_write(ESP_CAPTURE_DIR_RX, data, data_len);
+#endif /* ESP_CFG_AT_CAPTURE */
 
     /* Check status if device is available */
     if (!esp.status.f.dev_present) {
         return espERRNODEVICE;
     }
+#if ESP_CFG_SLEEP
+    esp.sleep_active_time = esp_sys_now();      /* Device is awake while it sends data */
+#endif /* ESP_CFG_SLEEP */
 
     while (d_len > 0) {                         /* Read entire set of characters from buffer */
-        ch = *d;                                /* Get next character */
-        ++d;                                    /* Go to next character, must be here as it is used later on */
-        --d_len;                                /* Decrease remaining length, must be here as it is decreased later too */
+        espr_t res;
+
+#if ESP_CFG_CONN_TRANSPARENT
+        /*
+         * In transparent mode, device forwards everything
+         * to the connection without any framing
+         *
+         * Wait for `>` prompt first, then deliver entire block as data
+         */
+        if (esp.m.transparent_conn != NULL) {
+            if (esp.m.transparent_prompt) {
+                if (*d == '>') {
+                    esp.m.transparent_prompt = 0;
+                }
+                ++d;
+                --d_len;
+            } else {
+                espi_transparent_process_data(d, d_len);
+                d += d_len;
+                d_len = 0;
+            }
+            continue;
+        }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
 
         /*
          * First check if we are in IPD mode and process plain data
          * without checking for valid ASCII or unicode format
+         *
+         * Entire contiguous block, limited by remaining IPD length
+         * and free space in current packet buffer, is copied at once
          */
         if (esp.m.ipd.read) {                   /* Do we have to read incoming IPD data? */
             size_t len;
 
-            if (esp.m.ipd.buff != NULL) {       /* Do we have active buffer? */
-                esp.m.ipd.buff->payload[esp.m.ipd.buff_ptr] = ch;   /* Save data character */
+#if ESP_CFG_IPD_ZERO_COPY
+            if (esp.m.ipd.buff_deferred_len > 0) {  /* Packet buffer not yet allocated? */
+                len = esp.m.ipd.buff_deferred_len;
+                esp.m.ipd.buff_deferred_len = 0;
+                if (d_len >= len) {             /* Entire chunk in input memory, reference it directly */
+                    esp.m.ipd.buff = espi_pbuf_new_ref(d, len);
+                    if (esp.m.ipd.buff != NULL) {
+                        ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
+                            "[IPD] Zero-copy reference to %d bytes\r\n", (int)len);
+                        esp.m.ipd.buff_ptr = len;   /* Data are already in place */
+                        d_len -= len;
+                        d += len;
+                        esp.m.ipd.rem_len -= len;
+                        esp.recv_ch_prev2 = len > 1 ? d[-2] : esp.recv_ch_prev1;
+                        esp.recv_ch_prev1 = d[-1];
+                    }
+                } else {
+                    esp.m.ipd.buff = esp_pbuf_new(len); /* Allocate new packet buffer */
+                }
+                ESP_DEBUGW(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING, esp.m.ipd.buff == NULL,
+                    "[IPD] Buffer allocation failed for %d byte(s)\r\n", (int)len);
+                if (esp.m.ipd.buff != NULL) {
+                    esp_pbuf_set_ip(esp.m.ipd.buff, &esp.m.ipd.ip, esp.m.ipd.port); /* Set IP and port for received data */
+                }
             }
-            ++esp.m.ipd.buff_ptr;
-            --esp.m.ipd.rem_len;
+#endif /* ESP_CFG_IPD_ZERO_COPY */
 
-            /* Try to read more data directly from buffer */
             len = ESP_MIN(d_len, ESP_MIN(esp.m.ipd.rem_len, esp.m.ipd.buff != NULL ? (esp.m.ipd.buff->len - esp.m.ipd.buff_ptr) : esp.m.ipd.rem_len));
             ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
                 "[IPD] New length to read: %d bytes\r\n", (int)len);
@@ -1055,12 +2906,30 @@ espi_process(const void* data, size_t data_len) {
                 d += len;                       /* Skip remaining length */
                 esp.m.ipd.buff_ptr += len;      /* Forward buffer pointer */
                 esp.m.ipd.rem_len -= len;       /* Decrease remaining length */
+
+                esp.recv_ch_prev2 = len > 1 ? d[-2] : esp.recv_ch_prev1; /* Keep previous characters in sync with stream */
+                esp.recv_ch_prev1 = d[-1];
             }
 
             /* Did we reach end of buffer or no more data? */
             if (esp.m.ipd.rem_len == 0 || (esp.m.ipd.buff != NULL && esp.m.ipd.buff_ptr == esp.m.ipd.buff->len)) {
-                espr_t res = espOK;
-
+#if ESP_CFG_IPD_ALLOC_POLICY
+                if (esp.m.ipd.buff != NULL && esp.m.ipd.whole) {
+                    if (esp.m.ipd.rem_len > 0 && !esp.m.ipd.conn->status.f.in_closing) {
+                        espi_ipd_new_buff(espi_ipd_alloc_len(0));   /* Extend chain with next buffer */
+                        if (esp.m.ipd.buff != NULL) {
+                            esp.m.ipd.buff_ptr = 0;
+                            RECV_RESET();
+                            continue;
+                        }
+                        ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+                            "[IPD] Delivering partial chain, continuing with separate buffers\r\n");
+                    }
+                    esp.m.ipd.buff = esp.m.ipd.buff_head;   /* Deliver entire chain */
+                    esp.m.ipd.buff_head = NULL;
+                    esp.m.ipd.whole = 0;
+                }
+#endif /* ESP_CFG_IPD_ALLOC_POLICY */
                 /* Call user callback function with received data */
                 if (esp.m.ipd.buff != NULL) {     /* Do we have valid buffer? */
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
@@ -1074,6 +2943,11 @@ espi_process(const void* data, size_t data_len) {
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
 
                     esp.m.ipd.conn->total_recved += esp.m.ipd.buff->tot_len;  /* Increase number of bytes received */
+#if ESP_CFG_LATENCY_TRACE
+                    esp.m.ipd.buff->trace_in = esp.m.ipd.trace_in;
+                    esp.m.ipd.buff->trace_time = esp_sys_now();
+                    espi_trace_add(ESP_TRACE_RX_IPD, esp.m.ipd.buff->trace_time - esp.m.ipd.trace_start);
+#endif /* ESP_CFG_LATENCY_TRACE */
                     
                     /*
                      * Send data buffer to upper layer
@@ -1086,6 +2960,9 @@ espi_process(const void* data, size_t data_len) {
                     esp.evt.evt.conn_data_recv.conn = esp.m.ipd.conn;
                     res = espi_send_conn_cb(esp.m.ipd.conn, NULL);
 
+#if ESP_CFG_IPD_ZERO_COPY
+                    espi_pbuf_release_payload(esp.m.ipd.buff);  /* Input memory is released after this call */
+#endif /* ESP_CFG_IPD_ZERO_COPY */
                     esp_pbuf_free(esp.m.ipd.buff);  /* Free packet buffer at this point */
                     ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
                         "[IPD] Free packet buffer\r\n");
@@ -1102,18 +2979,11 @@ espi_process(const void* data, size_t data_len) {
                      *  - Connection is not in closing state
                      */
                     if (esp.m.ipd.buff != NULL && esp.m.ipd.rem_len > 0 && !esp.m.ipd.conn->status.f.in_closing) {
-                        size_t new_len = ESP_MIN(esp.m.ipd.rem_len, ESP_CFG_IPD_MAX_BUFF_SIZE); /* Calculate new buffer length */
+                        size_t new_len = espi_ipd_alloc_len(0); /* Calculate new buffer length */
 
                         ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
                             "[IPD] Allocating new packet buffer of size: %d bytes\r\n", (int)new_len);
-                        esp.m.ipd.buff = esp_pbuf_new(new_len); /* Allocate new packet buffer */
-
-                        ESP_DEBUGW(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
-                            esp.m.ipd.buff == NULL, "[IPD] Buffer allocation failed for %d bytes\r\n", (int)new_len);
-
-                        if (esp.m.ipd.buff != NULL) {
-                            esp_pbuf_set_ip(esp.m.ipd.buff, &esp.m.ipd.ip, esp.m.ipd.port); /* Set IP and port for received data */
-                        }
+                        espi_ipd_new_buff(new_len); /* Allocate new packet buffer */
                     } else {
                         esp.m.ipd.buff = NULL;  /* Reset it */
                     }
@@ -1121,141 +2991,288 @@ espi_process(const void* data, size_t data_len) {
                 if (esp.m.ipd.rem_len == 0) {   /* Check if we read everything */
                     esp.m.ipd.buff = NULL;      /* Reset buffer pointer */
                     esp.m.ipd.read = 0;         /* Stop reading data */
+#if ESP_CFG_IPD_ALLOC_POLICY
+                    esp.m.ipd.whole = 0;
+#endif /* ESP_CFG_IPD_ALLOC_POLICY */
                 }
                 esp.m.ipd.buff_ptr = 0;         /* Reset input buffer pointer */
                 RECV_RESET();                   /* Reset receive data */
             }
+            continue;
+        }
+
+#if ESP_CFG_MQTT_AT
+        /* Read data of `+MQTTSUBRECV` message without checking for valid ASCII or unicode format */
+        if (esp.m.mqtt_at_recv.read) {
+            size_t len = ESP_MIN(d_len, esp.m.mqtt_at_recv.len - esp.m.mqtt_at_recv.pos);
+
+            if (esp.m.mqtt_at_recv.buff != NULL) {
+                ESP_MEMCPY(&esp.m.mqtt_at_recv.buff[esp.m.mqtt_at_recv.topic_len + 1 + esp.m.mqtt_at_recv.pos], d, len);
+            }
+            d_len -= len;
+            d += len;
+            esp.m.mqtt_at_recv.pos += len;
+            esp.recv_ch_prev2 = len > 1 ? d[-2] : esp.recv_ch_prev1; /* Keep previous characters in sync with stream */
+            esp.recv_ch_prev1 = d[-1];
+            if (esp.m.mqtt_at_recv.pos == esp.m.mqtt_at_recv.len) {
+                espi_mqtt_at_recv_finish();
+                RECV_RESET();
+            }
+            continue;
+        }
+#endif /* ESP_CFG_MQTT_AT */
+
+#if ESP_CFG_BLE
+        /* Read value of `+WRITE` message without checking for valid ASCII or unicode format */
+        if (esp.m.ble_recv.read) {
+            size_t len = ESP_MIN(d_len, esp.m.ble_recv.len - esp.m.ble_recv.pos);
+
+            if (esp.m.ble_recv.buff != NULL) {
+                esp_pbuf_take(esp.m.ble_recv.buff, d, len, esp.m.ble_recv.pos);
+            }
+            d_len -= len;
+            d += len;
+            esp.m.ble_recv.pos += len;
+            esp.recv_ch_prev2 = len > 1 ? d[-2] : esp.recv_ch_prev1; /* Keep previous characters in sync with stream */
+            esp.recv_ch_prev1 = d[-1];
+            if (esp.m.ble_recv.pos == esp.m.ble_recv.len) {
+                espi_ble_recv_finish();
+                RECV_RESET();
+            }
+            continue;
+        }
+#endif /* ESP_CFG_BLE */
+
+#if ESP_CFG_HTTP_CLIENT_AT
+        /* Pass data of `+HTTPCLIENT` response directly to application */
+        if (esp.m.http_at_recv.read) {
+            size_t len = ESP_MIN(d_len, esp.m.http_at_recv.len - esp.m.http_at_recv.pos);
+
+            if (CMD_IS_CUR(ESP_CMD_HTTPCLIENT) && esp.msg->msg.http_at.data_fn != NULL) {
+                esp.msg->msg.http_at.data_fn(d, len, esp.msg->msg.http_at.data_arg);
+            }
+            d_len -= len;
+            d += len;
+            esp.m.http_at_recv.pos += len;
+            esp.recv_ch_prev2 = len > 1 ? d[-2] : esp.recv_ch_prev1; /* Keep previous characters in sync with stream */
+            esp.recv_ch_prev1 = d[-1];
+            if (esp.m.http_at_recv.pos == esp.m.http_at_recv.len) {
+                esp.m.http_at_recv.read = 0;
+                RECV_RESET();
+            }
+            continue;
+        }
+#endif /* ESP_CFG_HTTP_CLIENT_AT */
 
+#if ESP_CFG_IPD_HDR_FAST
         /*
-         * We are in command mode where we have to process byte by byte
-         * Simply check for ASCII and unicode format and process data accordingly
+         * Try to recognize "+IPD" data header at the beginning of line
+         * and continue with bulk data read immediately after ':'
          */
-        } else {
-            espr_t res = espERR;
-            if (ESP_ISVALIDASCII(ch)) {         /* Manually check if valid ASCII character */
-                res = espOK;
-                unicode.t = 1;                  /* Manually set total to 1 */
-                unicode.r = 0;                  /* Reset remaining bytes */
-            } else if (ch >= 0x80) {            /* Process only if more than ASCII can hold */
-                res = espi_unicode_decode(&unicode, ch);    /* Try to decode unicode format */
+        if (esp.ipd_hdr.state > 0 || (*d == '+' && RECV_LEN() == 0)) {
+            uint8_t done;
+            size_t n;
+
+            n = espi_ipd_hdr_process(d, d_len, &done);
+            if (n > 0) {
+                esp.recv_ch_prev2 = n > 1 ? d[n - 2] : esp.recv_ch_prev1; /* Keep previous characters in sync with stream */
+                esp.recv_ch_prev1 = d[n - 1];
+                d += n;
+                d_len -= n;
+                continue;
             }
+        }
+#endif /* ESP_CFG_IPD_HDR_FAST */
 
-            if (res == espERR) {                /* In case of an ERROR */
-                unicode.r = 0;
+        /*
+         * Copy entire run of plain ASCII characters and complete UTF-8 sequences
+         * to receive buffer at once.
+         * Scanning stops at first character which requires per-byte processing
+         */
+        if (esp.recv_unicode.r == 0 && (IS_PLAIN_CHR(*d) || (*d >= 0x80 && espi_unicode_seq_len(d, d_len) > 0))) {
+            size_t n = 0, cpy, seq;
+
+            while (n < d_len) {
+                if (IS_PLAIN_CHR(d[n])) {
+                    ++n;
+                } else if (d[n] >= 0x80 && (seq = espi_unicode_seq_len(&d[n], d_len - n)) > 0) {
+                    n += seq;                   /* Multi-byte sequence is not "meta" character */
+                } else {
+                    break;
+                }
+            }
+            for (size_t pos = 0; pos < n; pos += cpy) {
+                cpy = ESP_MIN(n - pos, sizeof(esp.recv_buff.data) - 1 - esp.recv_buff.len); /* Same truncation as RECV_ADD */
+                if (cpy == 0 && !RECV_OVERFLOW()) {
+                    break;
+                }
+                ESP_MEMCPY(&esp.recv_buff.data[esp.recv_buff.len], &d[pos], cpy);
+                esp.recv_buff.len += cpy;
+                esp.recv_buff.data[esp.recv_buff.len] = 0;
             }
-            if (res == espOK) {                 /* Can we process the character(s) */
-                if (unicode.t == 1) {           /* Totally 1 character? */
+
+            esp.recv_ch_prev2 = n > 1 ? d[n - 2] : esp.recv_ch_prev1; /* Keep previous characters in sync with stream */
+            esp.recv_ch_prev1 = d[n - 1];
+            d += n;
+            d_len -= n;
+            continue;
+        }
+
+        ch = *d;                                /* Get next character */
+        ++d;                                    /* Go to next character, must be here as it is used later on */
+        --d_len;                                /* Decrease remaining length, must be here as it is decreased later too */
+
+        /*
+         * We are in command mode where we have to process byte by byte
+         * Simply check for ASCII and unicode format and process data accordingly
+         */
+        res = espERR;
+        if (ESP_ISVALIDASCII(ch)) {             /* Manually check if valid ASCII character */
+            res = espOK;
+            esp.recv_unicode.t = 1;             /* Manually set total to 1 */
+            esp.recv_unicode.r = 0;             /* Reset remaining bytes */
+        } else if (ch >= 0x80) {                /* Process only if more than ASCII can hold */
+            res = espi_unicode_decode(&esp.recv_unicode, ch); /* Try to decode unicode format */
+        }
+
+        if (res == espERR) {                    /* In case of an ERROR */
+            esp.recv_unicode.r = 0;
+        }
+        if (res == espOK) {                     /* Can we process the character(s) */
+            if (esp.recv_unicode.t == 1) {      /* Totally 1 character? */
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
-                    char* tmp_ptr;
+                char* tmp_ptr;
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
-                    switch (ch) {
-                        case '\n':
-                            RECV_ADD(ch);       /* Add character to input buffer */
-                            espi_parse_received(&recv_buff);/* Parse received string */
-                            RECV_RESET();       /* Reset received string */
-                            break;
-                        default:
-                            RECV_ADD(ch);       /* Any ASCII valid character */
-                            break;
-                    }
-
-                    /* If we are waiting for "\n> " sequence when CIPSEND command is active */
-                    if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSEND)) {
-                        if (ch_prev2 == '\r' && ch_prev1 == '\n' && ch == '>') {
-                            RECV_RESET();       /* Reset received object */
+                switch (ch) {
+                    case '\n':
+                        RECV_ADD(ch);           /* Add character to input buffer */
+#if ESP_CFG_RECV_LINE_HANDLERS > 0
+                        if (esp.recv_line_stream != NULL) { /* Oversized line, give last fragment to handler */
+                            esp.recv_line_stream->fn(esp.recv_buff.data, esp.recv_buff.len, esp.recv_line_first, 1, esp.recv_line_stream->arg);
+                            esp.recv_line_stream = NULL;
+                        } else
+#endif /* ESP_CFG_RECV_LINE_HANDLERS > 0 */
+                        {
+                            espi_parse_received(&esp.recv_buff);/* Parse received string */
+                        }
+                        RECV_RESET();           /* Reset received string */
+                        break;
+                    default:
+                        RECV_ADD(ch);           /* Any ASCII valid character */
+                        break;
+                }
 
+                /* If we are waiting for "\n> " sequence when CIPSEND command is active */
+                if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSEND)) {
+                    if (esp.recv_ch_prev2 == '\r' && esp.recv_ch_prev1 == '\n' && ch == '>') {
+                        RECV_RESET();           /* Reset received object */
+
+#if ESP_CFG_CONN_SEND_PIPELINE
+                        /* Prompt for next segment while current is still waiting for "SEND OK" */
+                        if (esp.msg->msg.conn_send.wait_send_ok_err && esp.msg->msg.conn_send.pipe_len > 0) {
+                            AT_PORT_SEND_WITH_FLUSH(&esp.msg->msg.conn_send.data[esp.msg->msg.conn_send.ptr + esp.msg->msg.conn_send.sent], esp.msg->msg.conn_send.pipe_len);
+                            esp.msg->msg.conn_send.pipe_data_sent = 1;
+                        } else
+#endif /* ESP_CFG_CONN_SEND_PIPELINE */
+                        {
                             /* Now actually send the data prepared before */
                             AT_PORT_SEND_WITH_FLUSH(&esp.msg->msg.conn_send.data[esp.msg->msg.conn_send.ptr], esp.msg->msg.conn_send.sent);
                             esp.msg->msg.conn_send.wait_send_ok_err = 1;    /* Now we are waiting for "SEND OK" or "SEND ERROR" */
                         }
                     }
+                }
+#if ESP_CFG_MQTT_AT
+                if (CMD_IS_CUR(ESP_CMD_MQTT_PUBRAW) && !esp.msg->msg.mqtt_at.wait_result
+                    && esp.recv_ch_prev2 == '\r' && esp.recv_ch_prev1 == '\n' && ch == '>') {
+                    RECV_RESET();
+                    AT_PORT_SEND_WITH_FLUSH(esp.msg->msg.mqtt_at.data, esp.msg->msg.mqtt_at.len);
+                    esp.msg->msg.mqtt_at.wait_result = 1;   /* Now we are waiting for "+MQTTPUB" result */
+                }
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_BLE
+                if (CMD_IS_CUR(ESP_CMD_BLEGATTSNTFY) && !esp.msg->msg.ble.wait_result
+                    && esp.recv_ch_prev1 == '\n' && ch == '>') {
+                    RECV_RESET();
+                    AT_PORT_SEND_WITH_FLUSH(&esp.msg->msg.ble.data[esp.msg->msg.ble.ptr], esp.msg->msg.ble.sent);
+                    esp.msg->msg.ble.wait_result = 1;   /* Now we are waiting for "OK" */
+                }
+#endif /* ESP_CFG_BLE */
 
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
-                    /*
-                     * Check if "+CIPRECVDATA" statement is in array and now we received colon,
-                     * indicating end of +CIPRECVDATA statement and start of actual data
-                     *
-                     * Final conclustion for +CIPRECVDATA is:
-                     * +CIPRECVDATA:<len>,<IP>,<port>,data...
-                     *
-                     */
-                    if (ch == ',' && RECV_LEN() > 13 && RECV_IDX(0) == '+' && !strncmp(recv_buff.data, "+CIPRECVDATA", 12)
-                        && (tmp_ptr = strchr(recv_buff.data, ',')) != NULL  /* Search for first comma */
-                        && (tmp_ptr = strchr(tmp_ptr + 1, ',')) != NULL /* Search for second comma */
-                        && (tmp_ptr = strchr(tmp_ptr + 1, ',')) != NULL) {  /* Search for third comma */
-                        espi_parse_received(&recv_buff);    /* Parse received string */
-                        if (esp.m.ipd.read) {   /* Shall we start read procedure? */
-                            /*
-                             * We should have already allocated pbuf memory at this stage
-                             * in current message from actual command handle
-                             *
-                             * Pbuf length should not be bigger than number of received bytes
-                             */
-                            esp.m.ipd.buff = esp.msg->msg.ciprecvdata.buff;
-                            esp.m.ipd.conn = esp.msg->msg.ciprecvdata.conn;
-                            esp_pbuf_set_length(esp.m.ipd.buff, esp.m.ipd.tot_len); /* Set new length of buffer */
-                            esp.msg->msg.ciprecvdata.buff = NULL;   /* Clear reference for this pbuf */
-                        } else {
-                            /* ERROR handling */
-                        }
-                    } else
+                /*
+                 * Check if "+CIPRECVDATA" statement is in array and now we received colon,
+                 * indicating end of +CIPRECVDATA statement and start of actual data
+                 *
+                 * Final conclustion for +CIPRECVDATA is:
+                 * +CIPRECVDATA:<len>,<IP>,<port>,data...
+                 *
+                 */
+                if (ch == ',' && RECV_LEN() > 13 && RECV_IDX(0) == '+' && !strncmp(esp.recv_buff.data, "+CIPRECVDATA", 12)
+                    && (tmp_ptr = strchr(esp.recv_buff.data, ',')) != NULL /* Search for first comma */
+                    && (tmp_ptr = strchr(tmp_ptr + 1, ',')) != NULL /* Search for second comma */
+                    && (tmp_ptr = strchr(tmp_ptr + 1, ',')) != NULL) {  /* Search for third comma */
+                    espi_parse_received(&esp.recv_buff); /* Parse received string */
+                    if (esp.m.ipd.read) {       /* Shall we start read procedure? */
+                        /*
+                         * We should have already allocated pbuf memory at this stage
+                         * in current message from actual command handle
+                         *
+                         * Pbuf length should not be bigger than number of received bytes
+                         */
+                        esp.m.ipd.buff = esp.msg->msg.ciprecvdata.buff;
+                        esp.m.ipd.conn = esp.msg->msg.ciprecvdata.conn;
+                        esp_pbuf_set_length(esp.m.ipd.buff, esp.m.ipd.tot_len); /* Set new length of buffer */
+                        esp.msg->msg.ciprecvdata.buff = NULL;   /* Clear reference for this pbuf */
+                    } else {
+                        /* ERROR handling */
+                    }
+                } else
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
 
-                    /*
-                     * Check if "+IPD" statement is in array and now we received colon,
-                     * indicating end of +IPD and start of actual data
-                     */
-                    if (ch == ':' && RECV_LEN() > 4 && RECV_IDX(0) == '+' && !strncmp(recv_buff.data, "+IPD", 4)) {
-                        espi_parse_received(&recv_buff);/* Parse received string */
-                        if (esp.m.ipd.read) {   /* Shall we start read procedure? */
-                            size_t len;
-                            ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
-                                "[IPD] Data on connection %d with total size %d byte(s)\r\n",
-                                (int)esp.m.ipd.conn->num, (int)esp.m.ipd.tot_len);
-
-                            len = ESP_MIN(esp.m.ipd.rem_len, ESP_CFG_IPD_MAX_BUFF_SIZE);
-
-                            /*
-                             * Read received data in case of:
-                             *
-                             *  - Connection is active and
-                             *  - Connection is not in closing mode
-                             */
-                            if (esp.m.ipd.conn->status.f.active && !esp.m.ipd.conn->status.f.in_closing) {
-                                esp.m.ipd.buff = esp_pbuf_new(len); /* Allocate new packet buffer */
-                                if (esp.m.ipd.buff != NULL) {
-                                    esp_pbuf_set_ip(esp.m.ipd.buff, &esp.m.ipd.ip, esp.m.ipd.port); /* Set IP and port for received data */
-                                }
-                                ESP_DEBUGW(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING, esp.m.ipd.buff == NULL,
-                                    "[IPD] Buffer allocation failed for %d byte(s)\r\n", (int)len);
-                            } else {
-                                esp.m.ipd.buff = NULL;  /* Ignore reading on closed connection */
-                                ESP_DEBUGF(ESP_CFG_DBG_IPD | ESP_DBG_TYPE_TRACE,
-                                    "[IPD] Connection %d closed or in closing, skipping %d byte(s)\r\n",
-                                    (int)esp.m.ipd.conn->num, (int)len);
-                            }
-                            esp.m.ipd.conn->status.f.data_received = 1; /* We have first received data */
-                            esp.m.ipd.buff_ptr = 0; /* Reset buffer write pointer */
-                        }
-                        RECV_RESET();           /* Reset received buffer */
-                    }
-                } else {                        /* We have sequence of unicode characters */
-                    /*
-                     * Unicode sequence characters are not "meta" characters
-                     * so it is safe to just add them to receive array without checking
-                     * what are the actual values
-                     */
-                    for (uint8_t i = 0; i < unicode.t; ++i) {
-                        RECV_ADD(unicode.ch[i]);/* Add character to receive array */
-                    }
+                /*
+                 * Check if "+IPD" statement is in array and now we received colon,
+                 * indicating end of +IPD and start of actual data
+                 */
+                if (ch == ':' && RECV_LEN() > 4 && RECV_IDX(0) == '+' && !strncmp(esp.recv_buff.data, "+IPD", 4)) {
+                    espi_parse_received(&esp.recv_buff);/* Parse received string */
+                    espi_ipd_read_start();      /* Start reading data if needed */
+                    RECV_RESET();               /* Reset received buffer */
+                }
+#if ESP_CFG_MQTT_AT
+                /* Comma after data length finishes "+MQTTSUBRECV" header */
+                if (ch == ',' && RECV_LEN() > 17 && !strncmp(esp.recv_buff.data, "+MQTTSUBRECV:", 13) && espi_mqtt_at_recv_start()) {
+                    RECV_RESET();
+                }
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_BLE
+                /* Comma after data length finishes "+WRITE" header */
+                if (ch == ',' && RECV_LEN() > 15 && !strncmp(esp.recv_buff.data, "+WRITE:", 7) && espi_ble_recv_start()) {
+                    RECV_RESET();
+                }
+#endif /* ESP_CFG_BLE */
+#if ESP_CFG_HTTP_CLIENT_AT
+                /* Comma after data length finishes "+HTTPCLIENT" header */
+                if (ch == ',' && RECV_LEN() > 13 && CMD_IS_CUR(ESP_CMD_HTTPCLIENT)
+                    && !strncmp(esp.recv_buff.data, "+HTTPCLIENT:", 12) && espi_http_at_recv_start()) {
+                    RECV_RESET();
+                }
+#endif /* ESP_CFG_HTTP_CLIENT_AT */
+            } else {                            /* We have sequence of unicode characters */
+                /*
+                 * Unicode sequence characters are not "meta" characters
+                 * so it is safe to just add them to receive array without checking
+                 * what are the actual values
+                 */
+                for (uint8_t i = 0; i < esp.recv_unicode.t; ++i) {
+                    RECV_ADD(esp.recv_unicode.ch[i]);/* Add character to receive array */
                 }
-            } else if (res != espINPROG) {      /* Not in progress? */
-                RECV_RESET();                   /* Invalid character in sequence */
             }
+        } else if (res != espINPROG) {          /* Not in progress? */
+            RECV_RESET();                       /* Invalid character in sequence */
         }
 
-        ch_prev2 = ch_prev1;                    /* Save previous character as previous previous */
-        ch_prev1 = ch;                          /* Set current as previous */
+        esp.recv_ch_prev2 = esp.recv_ch_prev1;  /* Save previous character as previous previous */
+        esp.recv_ch_prev1 = ch;                 /* Set current as previous */
     }
     return espOK;
 }
@@ -1273,12 +3290,138 @@ espi_process(const void* data, size_t data_len) {
     n_cmd = (new_cmd);                          \
 } while (0)
 
-/* Set new cmd if condition passes */
-#define SET_NEW_CMD_COND(new_cmd, cond)  do {   \
-    if ((cond)) {                               \
-        n_cmd = (new_cmd);                      \
-    }                                           \
-} while (0)
+/* Set new cmd if condition passes */
+#define SET_NEW_CMD_COND(new_cmd, cond)  do {   \
+    if ((cond)) {                               \
+        n_cmd = (new_cmd);                      \
+    }                                           \
+} while (0)
+
+/* Check if reset sequence may skip steps with known result */
+#if ESP_CFG_RESET_WARM_BOOT
+#define RESET_IS_WARM()                         (esp.warm_boot.warm)
+#else /* ESP_CFG_RESET_WARM_BOOT */
+#define RESET_IS_WARM()                         0
+#endif /* !ESP_CFG_RESET_WARM_BOOT */
+
+#if ESP_CFG_CONN_SSL_CFG_CACHE || __DOXYGEN__
+
+/**
+ * \brief           Find next cached SSL configuration to replay
+ *
+ * Search starts at `esp.ssl_cache.idx`. On success, index points
+ * one entry after found configuration, stored in `esp.ssl_cache.cur`
+ * \return          `1` if configuration found, `0` otherwise
+ */
+static uint8_t
+espi_ssl_cache_next(void) {
+    for (; esp.ssl_cache.idx < ESP_ARRAYSIZE(esp.ssl_cache.cfg); ++esp.ssl_cache.idx) {
+        if (esp.ssl_cache.cfg[esp.ssl_cache.idx].set) {
+            esp.ssl_cache.cur = esp.ssl_cache.idx++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE || __DOXYGEN__ */
+
+#if ESP_CFG_CONN_IPD_INFO == 2 || __DOXYGEN__
+
+/**
+ * \brief           Check if `+IPD` must report remote IP and port after connection start
+ * \param[in]       msg: Connection start message
+ * \return          `1` when new or any active connection is UDP, `0` otherwise
+ */
+static uint8_t
+espi_ipd_info_required(esp_msg_t* msg) {
+    if (msg->msg.conn_start.type == ESP_CONN_TYPE_UDP) {
+        return 1;
+    }
+    for (size_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {
+        if (esp.m.conns[i].status.f.active && esp.m.conns[i].type == ESP_CONN_TYPE_UDP) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif /* ESP_CFG_CONN_IPD_INFO == 2 || __DOXYGEN__ */
+
+#if ESP_CFG_RESET_WARM_BOOT || __DOXYGEN__
+
+/**
+ * \brief           Check if two software versions are equal
+ * \param[in]       a: First version
+ * \param[in]       b: Second version
+ * \return          `1` if equal, `0` otherwise
+ */
+static uint8_t
+espi_sw_version_equal(const esp_sw_version_t* a, const esp_sw_version_t* b) {
+    return a->major == b->major && a->minor == b->minor && a->patch == b->patch;
+}
+
+/**
+ * \brief           Remember module state at the end of reset sequence
+ * \param[in]       ok: Set to `1` if reset sequence finished successfully
+ */
+static void
+espi_warm_boot_save(uint8_t ok) {
+    esp.warm_boot.warm = 0;
+    esp.warm_boot.valid = ok;
+    if (ok) {
+        ESP_MEMCPY(&esp.warm_boot.version_at, &esp.m.version_at, sizeof(esp.m.version_at));
+        ESP_MEMCPY(&esp.warm_boot.version_sdk, &esp.m.version_sdk, sizeof(esp.m.version_sdk));
+#if ESP_CFG_MODE_ACCESS_POINT
+        ESP_MEMCPY(&esp.warm_boot.ap, &esp.m.ap, sizeof(esp.m.ap));
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+    }
+}
+
+#endif /* ESP_CFG_RESET_WARM_BOOT || __DOXYGEN__ */
+
+#if ESP_CFG_GETTER_CACHE || __DOXYGEN__
+
+/**
+ * \brief           Update validity of values getters answer locally
+ *
+ * Value becomes valid when command reading it finishes successfully
+ * and invalid when command changing it finishes, regardless of result
+ *
+ * \param[in]       ok: Status whether current command finished with `OK`
+ */
+static void
+espi_getter_cache_update(uint8_t ok) {
+    uint8_t set = 0, clr = 0;
+
+    switch (CMD_GET_CUR()) {
+#if ESP_CFG_MODE_STATION
+        case ESP_CMD_WIFI_CIPSTAMAC_GET: set = ESP_CACHE_STA_MAC; break;
+        case ESP_CMD_WIFI_CIPSTAMAC_SET: clr = ESP_CACHE_STA_MAC; break;
+        case ESP_CMD_WIFI_CIPSTA_GET: set = ESP_CACHE_STA_IP; break;
+        case ESP_CMD_WIFI_CIPSTA_SET: clr = ESP_CACHE_STA_IP; break;
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+        case ESP_CMD_WIFI_CIPAPMAC_GET: set = ESP_CACHE_AP_MAC; break;
+        case ESP_CMD_WIFI_CIPAPMAC_SET: clr = ESP_CACHE_AP_MAC; break;
+        case ESP_CMD_WIFI_CIPAP_GET: set = ESP_CACHE_AP_IP; break;
+        case ESP_CMD_WIFI_CIPAP_SET: clr = ESP_CACHE_AP_IP; break;
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+#if ESP_CFG_HOSTNAME
+        case ESP_CMD_WIFI_CWHOSTNAME_GET: set = ESP_CACHE_HOSTNAME; break;
+        case ESP_CMD_WIFI_CWHOSTNAME_SET: clr = ESP_CACHE_HOSTNAME; break;
+#endif /* ESP_CFG_HOSTNAME */
+        case ESP_CMD_WIFI_CWMODE:
+        case ESP_CMD_WIFI_CWDHCP_SET: clr = ESP_CACHE_STA_IP | ESP_CACHE_AP_IP; break;
+        default: break;
+    }
+    if (ok) {
+        esp.m.cache_valid |= set;
+    }
+    esp.m.cache_valid &= ~clr;
+}
+
+#endif /* ESP_CFG_GETTER_CACHE || __DOXYGEN__ */
 
 /**
  * \brief           Get next sub command for reset or restore sequence
@@ -1297,6 +3440,14 @@ espi_get_reset_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_
             SET_NEW_CMD(ESP_CFG_AT_ECHO ? ESP_CMD_ATE1 : ESP_CMD_ATE0); break;
         case ESP_CMD_ATE0:
         case ESP_CMD_ATE1:
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO
+        case ESP_CMD_UART:
+        case ESP_CMD_AT:
+            SET_NEW_CMD(espi_baudrate_auto_get_sub_cmd(msg, *is_ok));
+            if (n_cmd != ESP_CMD_IDLE) {
+                break;
+            }
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO */
             SET_NEW_CMD(ESP_CMD_SYSMSG); break;
         case ESP_CMD_SYSMSG:
             SET_NEW_CMD(ESP_CMD_SYSLOG); break;
@@ -1312,7 +3463,20 @@ espi_get_reset_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_
 #endif /* ESP_CFG_ESP32 */
             SET_NEW_CMD(ESP_CMD_GMR); break;
         case ESP_CMD_GMR: 
-            SET_NEW_CMD(ESP_CMD_WIFI_CWMODE); break;
+#if ESP_CFG_RESET_WARM_BOOT
+            esp.warm_boot.warm = CMD_IS_DEF(ESP_CMD_RESET) && esp.warm_boot.valid && *is_ok
+                && espi_sw_version_equal(&esp.warm_boot.version_at, &esp.m.version_at)
+                && espi_sw_version_equal(&esp.warm_boot.version_sdk, &esp.m.version_sdk);
+#if ESP_CFG_MODE_ACCESS_POINT
+            if (esp.warm_boot.warm) {           /* Use remembered access point setup */
+                ESP_MEMCPY(&esp.m.ap, &esp.warm_boot.ap, sizeof(esp.m.ap));
+            }
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+#endif /* ESP_CFG_RESET_WARM_BOOT */
+            if (!RESET_IS_WARM()) {
+                SET_NEW_CMD(ESP_CMD_WIFI_CWMODE); break;    /* Set mode, unless already set on warm module */
+            }
+            /* Fallthrough */
         case ESP_CMD_WIFI_CWMODE: 
             SET_NEW_CMD(ESP_CMD_WIFI_CWDHCP_GET); break;
         case ESP_CMD_WIFI_CWDHCP_GET: 
@@ -1323,17 +3487,54 @@ espi_get_reset_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_
         case ESP_CMD_TCPIP_CIPRECVMODE:
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
 #if ESP_CFG_MODE_STATION
+#if ESP_CFG_STA_LIST_AP
             SET_NEW_CMD(ESP_CMD_WIFI_CWLAPOPT); break;/* Set visible data for CWLAP command */
         case ESP_CMD_WIFI_CWLAPOPT: 
+#endif /* ESP_CFG_STA_LIST_AP */
             SET_NEW_CMD(ESP_CMD_TCPIP_CIPSTATUS); break;/* Get connection status */
         case ESP_CMD_TCPIP_CIPSTATUS:
 #endif /* ESP_CFG_MODE_STATION */
 #if ESP_CFG_MODE_ACCESS_POINT
-            SET_NEW_CMD(ESP_CMD_WIFI_CIPAP_GET); break; /* Get access point IP */
+            if (!RESET_IS_WARM()) {
+                SET_NEW_CMD(ESP_CMD_WIFI_CIPAP_GET); break; /* Get access point IP */
+            }
+            /* Fallthrough */
         case ESP_CMD_WIFI_CIPAP_GET: 
-            SET_NEW_CMD(ESP_CMD_WIFI_CIPAPMAC_GET); break; /* Get access point MAC */
+            if (!RESET_IS_WARM()) {
+                SET_NEW_CMD(ESP_CMD_WIFI_CIPAPMAC_GET); break;  /* Get access point MAC */
+            }
+            /* Fallthrough */
         case ESP_CMD_WIFI_CIPAPMAC_GET:
 #endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_CONFIG_SNAPSHOT
+#if ESP_CFG_MODE_STATION
+            if (esp.snapshot.flags & ESP_SNAPSHOT_STA_IP) {
+                SET_NEW_CMD(ESP_CMD_WIFI_CIPSTA_GET); break;/* Read station IP to compare with snapshot */
+            }
+            /* Fallthrough */
+        case ESP_CMD_WIFI_CIPSTA_GET:
+#endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_HOSTNAME
+            esp.snapshot_hostname_ok = 0;
+            if (esp.snapshot.flags & ESP_SNAPSHOT_HOSTNAME) {
+                SET_NEW_CMD(ESP_CMD_WIFI_CWHOSTNAME_GET); break;/* Read hostname to compare with snapshot */
+            }
+            /* Fallthrough */
+        case ESP_CMD_WIFI_CWHOSTNAME_GET:
+#endif /* ESP_CFG_HOSTNAME */
+#endif /* ESP_CFG_CONFIG_SNAPSHOT */
+#if ESP_CFG_CONN_SSL_CFG_CACHE
+            esp.ssl_cache.idx = 0;
+            if (esp.ssl_cache.size > 0) {
+                SET_NEW_CMD(ESP_CMD_TCPIP_CIPSSLSIZE); break;   /* Replay SSL buffer size */
+            }
+            /* Fallthrough */
+        case ESP_CMD_TCPIP_CIPSSLSIZE:
+        case ESP_CMD_TCPIP_CIPSSLCCONF:
+            if (espi_ssl_cache_next()) {
+                SET_NEW_CMD(ESP_CMD_TCPIP_CIPSSLCCONF); break;  /* Replay next SSL configuration */
+            }
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE */
             SET_NEW_CMD(ESP_CMD_TCPIP_CIPDINFO); break; /* Set visible data on +IPD */
         default: break;
     }
@@ -1344,6 +3545,73 @@ espi_get_reset_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_
     return n_cmd;
 }
 
+#if ESP_CFG_PING || __DOXYGEN__
+
+/**
+ * \brief           Add finished ping to probe statistics and queue next ping of probe
+ *
+ * Only one ping of probe is in queue at a time,
+ * commands queued meanwhile are not delayed by remaining pings.
+ * Command callback is moved to next ping, so it is called when probe finishes
+ *
+ * \param[in]       msg: Ping message
+ * \param[in]       ok: Set to `1` when reply was received, `0` otherwise
+ */
+static void
+espi_ping_probe_next(esp_msg_t* msg, uint8_t ok) {
+    esp_ping_stats_t* s;
+    esp_msg_t* next;
+    uint32_t time = msg->msg.tcpip_ping.time;
+
+    if (msg->msg.tcpip_ping.stats == NULL) {
+        return;
+    }
+    s = &msg->msg.tcpip_ping.stats[msg->msg.tcpip_ping.idx % msg->msg.tcpip_ping.cnt];
+    ++s->sent;
+    if (ok) {
+        if (s->received == 0 || time < s->time_min) {
+            s->time_min = time;
+        }
+        if (time > s->time_max) {
+            s->time_max = time;
+        }
+        s->time_sum += time;
+        ++s->received;
+        s->time_avg = s->time_sum / s->received;
+    }
+    if (msg->msg.tcpip_ping.idx + 1 >= msg->msg.tcpip_ping.total) {
+        return;                                 /* Last ping of probe */
+    }
+
+    next = ESP_MSG_VAR_MALLOC();
+    if (next != NULL) {
+        ESP_MEMSET(next, 0x00, sizeof(*next));
+        next->cmd_def = ESP_CMD_TCPIP_PING;
+        next->msg.tcpip_ping = msg->msg.tcpip_ping;
+        next->msg.tcpip_ping.time = 0;
+        next->msg.tcpip_ping.time_out = NULL;
+        ++next->msg.tcpip_ping.idx;
+        next->msg.tcpip_ping.host = next->msg.tcpip_ping.stats[next->msg.tcpip_ping.idx % next->msg.tcpip_ping.cnt].host;
+#if ESP_CFG_USE_API_FUNC_EVT
+        next->evt_fn = msg->evt_fn;
+        next->evt_arg = msg->evt_arg;
+#endif /* ESP_CFG_USE_API_FUNC_EVT */
+        if (espi_send_msg_to_producer_mbox(next, espi_initiate_cmd, 30000) == espOK) {
+#if ESP_CFG_USE_API_FUNC_EVT
+            msg->evt_fn = NULL;                 /* Probe continues with next ping */
+#endif /* ESP_CFG_USE_API_FUNC_EVT */
+            return;
+        }
+    }
+
+    /* Remaining pings cannot be started and are lost */
+    for (size_t i = msg->msg.tcpip_ping.idx + 1; i < msg->msg.tcpip_ping.total; ++i) {
+        ++msg->msg.tcpip_ping.stats[i % msg->msg.tcpip_ping.cnt].sent;
+    }
+}
+
+#endif /* ESP_CFG_PING || __DOXYGEN__ */
+
 /**
  * \brief           Process current command with known execution status and start another if necessary
  * \param[in]       msg: Pointer to current message
@@ -1355,9 +3623,35 @@ espi_get_reset_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_
 static espr_t
 espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t* is_ready) {
     esp_cmd_t n_cmd = ESP_CMD_IDLE;
+#if ESP_CFG_RESET_WARM_BOOT
+    /* Settings remembered for warm boot are no longer valid after user change */
+    if (CMD_IS_DEF(ESP_CMD_WIFI_CWMODE)
+#if ESP_CFG_MODE_ACCESS_POINT
+        || CMD_IS_DEF(ESP_CMD_WIFI_CIPAP_SET) || CMD_IS_DEF(ESP_CMD_WIFI_CIPAPMAC_SET)
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
+        ) {
+        esp.warm_boot.valid = 0;
+    }
+#endif /* ESP_CFG_RESET_WARM_BOOT */
+#if ESP_CFG_GETTER_CACHE
+    espi_getter_cache_update(*is_ok);
+#endif /* ESP_CFG_GETTER_CACHE */
     if (CMD_IS_DEF(ESP_CMD_RESET)) {            /* Device is in reset mode */
         n_cmd = espi_get_reset_sub_cmd(msg, is_ok, is_error, is_ready);
         if (n_cmd == ESP_CMD_IDLE) {            /* Last command? */
+#if ESP_CFG_RESET_WARM_BOOT
+            espi_warm_boot_save(*is_ok);
+#endif /* ESP_CFG_RESET_WARM_BOOT */
+#if ESP_CFG_CONFIG_SNAPSHOT
+            if (*is_ok) {
+                espi_snapshot_replay();         /* Apply settings before join from recovery */
+            }
+#endif /* ESP_CFG_CONFIG_SNAPSHOT */
+#if ESP_CFG_RESET_RECOVERY
+            if (msg->msg.reset.recovery && *is_ok) {
+                espi_recovery_replay();         /* Queue remembered settings right after sequence */
+            }
+#endif /* ESP_CFG_RESET_RECOVERY */
             RESET_SEND_EVT(msg, *is_ok ? espOK : espERR);
         }
     } else if (CMD_IS_DEF(ESP_CMD_RESTORE)) {
@@ -1368,8 +3662,49 @@ espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t*
             SET_NEW_CMD(espi_get_reset_sub_cmd(msg, is_ok, is_error, is_ready));
         }
         if (n_cmd == ESP_CMD_IDLE) {
+#if ESP_CFG_RESET_WARM_BOOT
+            espi_warm_boot_save(*is_ok);
+#endif /* ESP_CFG_RESET_WARM_BOOT */
+#if ESP_CFG_CONFIG_SNAPSHOT
+            if (*is_ok) {
+                espi_snapshot_replay();         /* Restored device has default settings */
+            }
+#endif /* ESP_CFG_CONFIG_SNAPSHOT */
             RESTORE_SEND_EVT(msg, *is_ok ? espOK : espERR);
         }
+#if ESP_CFG_TELEMETRY_INTERVAL > 0
+    } else if (CMD_IS_DEF(ESP_CMD_SYSRAM)) {
+        if (CMD_IS_CUR(ESP_CMD_SYSRAM) && *is_ok) {
+            esp_telemetry_t* t = &esp.telemetry;
+
+            if (t->samples == 0 || t->ram_free < t->ram_free_min) {
+                t->ram_free_min = t->ram_free;
+            }
+            t->rssi = 0;
+            t->time = esp_sys_now();
+            ++t->samples;
+#if ESP_CFG_MODE_STATION
+            if (esp.m.sta.is_connected) {
+                esp.telemetry_ap.rssi = 0;
+                SET_NEW_CMD(ESP_CMD_WIFI_CWJAP_GET);/* Sample link quality too */
+            }
+        } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWJAP_GET)) {
+            if (*is_ok) {
+                esp.telemetry.rssi = esp.telemetry_ap.rssi;
+            }
+#endif /* ESP_CFG_MODE_STATION */
+        }
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 */
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0
+    } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWLIF)) {
+        esp.m.ap_stas_valid = *is_ok && !esp.m.ap_stas_overflow;
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 */
+#if ESP_CFG_SLEEP
+    } else if (CMD_IS_DEF(ESP_CMD_SLEEP)) {
+        if (*is_ok) {
+            esp.m.sleep_mode = msg->msg.sleep.mode; /* Wakeup is required from now on in light-sleep */
+        }
+#endif /* ESP_CFG_SLEEP */
 #if ESP_CFG_MODE_STATION
     } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWJAP)) {/* Is our intention to join to access point? */
         if (CMD_IS_CUR(ESP_CMD_WIFI_CWJAP)) {   /* Is the current command join? */
@@ -1403,8 +3738,31 @@ espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t*
         if (n_cmd == ESP_CMD_IDLE) {
             STA_JOIN_AP_SEND_EVT(msg, esp.evt.evt.sta_join_ap.res);
         }
+#if ESP_CFG_STA_LIST_AP
     } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWLAP)) {
-        STA_LIST_AP_SEND_EVT(msg, *is_ok ? espOK : espERR);
+        if (msg->msg.ap_list.fields == 0) {     /* Scan with default options */
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0
+            if (esp.m.sta_aps_filling) {        /* Table is complete, requests in queue may use it */
+                esp.m.sta_aps_valid = *is_ok && !esp.m.sta_aps_overflow;
+                esp.m.sta_aps_time = esp_sys_now();
+                esp.m.sta_aps_filling = 0;
+            }
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 */
+            STA_LIST_AP_SEND_EVT(msg, *is_ok ? espOK : espERR);
+        } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWLAPOPT) && msg->i == 0) {
+            SET_NEW_CMD_CHECK_ERROR(ESP_CMD_WIFI_CWLAP);    /* Options set, start scan */
+            if (*is_error) {
+                STA_LIST_AP_SEND_EVT(msg, espERR);
+            }
+        } else if (CMD_IS_CUR(ESP_CMD_WIFI_CWLAP)) {
+            msg->msg.ap_list.res = *is_ok ? espOK : espERR;
+            SET_NEW_CMD(ESP_CMD_WIFI_CWLAPOPT); /* Restore default options */
+        } else {                                /* Default options restored */
+            *is_ok = msg->msg.ap_list.res == espOK;
+            *is_error = !*is_ok;
+            STA_LIST_AP_SEND_EVT(msg, msg->msg.ap_list.res);
+        }
+#endif /* ESP_CFG_STA_LIST_AP */
     } else if (CMD_IS_DEF(ESP_CMD_WIFI_CWJAP_GET)) {
         STA_INFO_AP_SEND_EVT(msg, *is_ok ? espOK : espERR);
     } else if (CMD_IS_DEF(ESP_CMD_WIFI_CIPSTA_SET)) {
@@ -1439,26 +3797,169 @@ espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t*
 #endif /* ESP_CFG_MODE_ACCESS_POINT */
 #if ESP_CFG_DNS
     } else if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPDOMAIN)) {
+#if ESP_CFG_DNS_CACHE_SIZE > 0
+        if (*is_ok) {
+            espi_dns_cache_put(esp.msg->msg.dns_getbyhostname.host, esp.msg->msg.dns_getbyhostname.ip);
+        }
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 */
         CIPDOMAIN_SEND_EVT(esp.msg, *is_ok ? espOK : espERR);
+        if (msg->msg.dns_getbyhostname.cnt > 0) {   /* Resolving multiple names? */
+            size_t idx = msg->msg.dns_getbyhostname.idx;
+
+            msg->msg.dns_getbyhostname.res[idx] = *is_ok ? espOK : espERR;
+            while (++idx < msg->msg.dns_getbyhostname.cnt
+                && msg->msg.dns_getbyhostname.res[idx] != espCONT) {}
+            if (idx < msg->msg.dns_getbyhostname.cnt) { /* Continue with next unresolved name */
+                msg->msg.dns_getbyhostname.idx = idx;
+                msg->msg.dns_getbyhostname.host = msg->msg.dns_getbyhostname.hosts[idx];
+                msg->msg.dns_getbyhostname.ip = &msg->msg.dns_getbyhostname.ips[idx];
+                SET_NEW_CMD(ESP_CMD_TCPIP_CIPDOMAIN);
+            } else {                            /* Sequence finished, succeeds only if all names resolved */
+                *is_ok = 1;
+                *is_error = 0;
+                for (size_t i = 0; i < msg->msg.dns_getbyhostname.cnt; ++i) {
+                    if (msg->msg.dns_getbyhostname.res[i] != espOK) {
+                        *is_ok = 0;
+                        *is_error = 1;
+                        break;
+                    }
+                }
+            }
+        }
 #endif /* ESP_CFG_DNS */
 #if ESP_CFG_PING
     } else if (CMD_IS_DEF(ESP_CMD_TCPIP_PING)) {
+        espi_ping_probe_next(msg, *is_ok);
         PING_SEND_EVT(esp.msg, *is_ok ? espOK : espERR);
 #endif
+#if ESP_CFG_CONN_TRANSPARENT
+    } else if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPMODE)) {
+        if (msg->msg.conn_start.transparent) {  /* Enter transparent mode */
+            if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPMUX)) {
+                SET_NEW_CMD_CHECK_ERROR(ESP_CMD_TCPIP_CIPMODE);
+            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPMODE)) {
+                SET_NEW_CMD_CHECK_ERROR(ESP_CMD_TCPIP_CIPSTART);
+            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)) {
+                if (*is_ok) {
+                    espi_transparent_conn_active(msg);
+                    SET_NEW_CMD(ESP_CMD_TCPIP_CIPSEND_TRANSPARENT);
+                }
+            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSEND_TRANSPARENT)) {
+                if (*is_ok) {                   /* From now on, everything is raw data */
+                    esp.m.transparent_conn = &esp.m.conns[0];
+                    esp.m.transparent_prompt = 1;
+                }
+            }
+
+            /* Restore normal mode when failed after single connection mode has been set */
+            if (n_cmd == ESP_CMD_IDLE && *is_error && !CMD_IS_CUR(ESP_CMD_TCPIP_CIPMUX)) {
+                msg->msg.conn_start.transparent = 0;
+                msg->msg.conn_start.transparent_failed = 1;
+                SET_NEW_CMD(CMD_IS_CUR(ESP_CMD_TCPIP_CIPMODE) ? ESP_CMD_TCPIP_CIPMUX : ESP_CMD_TCPIP_CIPMODE);
+            }
+        } else {                                /* Leave transparent mode */
+            if (CMD_IS_CUR(ESP_CMD_TCPIP_TRANSPARENT_EXIT) || CMD_IS_CUR(ESP_CMD_TCPIP_CIPMODE)) {
+                SET_NEW_CMD(ESP_CMD_TCPIP_CIPCLOSE);
+            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPCLOSE)) {
+                espi_transparent_conn_closed(); /* Error is ignored, connection may be closed already */
+                SET_NEW_CMD(ESP_CMD_TCPIP_CIPMUX);
+            } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPMUX)) {
+                if (msg->msg.conn_start.transparent_failed) {
+                    *is_ok = 0;
+                    *is_error = 1;
+                }
+            }
+        }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+#if ESP_CFG_CONN_SSL_CFG_CACHE
+    } else if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPSSLSIZE)) {
+        if (*is_ok) {                           /* Remember for replay after reset */
+            esp.ssl_cache.size = msg->msg.tcpip_sslsize.size;
+        }
+    } else if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPSSLCCONF)) {
+        if (*is_ok) {                           /* Remember for replay after reset */
+            uint8_t link_id = msg->msg.tcpip_ssl_cfg.link_id;
+
+            esp.ssl_cache.cfg[link_id].auth_mode = msg->msg.tcpip_ssl_cfg.auth_mode;
+            esp.ssl_cache.cfg[link_id].pki_number = msg->msg.tcpip_ssl_cfg.pki_number;
+            esp.ssl_cache.cfg[link_id].ca_number = msg->msg.tcpip_ssl_cfg.ca_number;
+            esp.ssl_cache.cfg[link_id].set = 1;
+        }
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE */
     } else if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPSTART)) {/* Is our intention to join to access point? */
+#if ESP_CFG_CONN_IPD_INFO == 2
+        if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPDINFO)) {
+            if (*is_ok) {
+                esp.m.ipd_info = !esp.m.ipd_info;
+            }
+            SET_NEW_CMD(ESP_CMD_TCPIP_CIPSTART);/* Start connection even if setting failed */
+        } else
+#endif /* ESP_CFG_CONN_IPD_INFO == 2 */
+#if ESP_CFG_CONN_STATUS_TRUST_EVENTS
+        if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)) {
+            /* Verify with status command only if "+LINK_CONN" did not confirm connection */
+            SET_NEW_CMD_COND(ESP_CMD_TCPIP_CIPSTATUS, *is_ok && !msg->msg.conn_start.success);
+        } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTATUS)) {
+            if (!msg->msg.conn_start.success) {
+                *is_ok = 0;
+                *is_error = 1;
+            }
+        }
+#else /* ESP_CFG_CONN_STATUS_TRUST_EVENTS */
         if (msg->i == 0 && CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTATUS)) {   /* Was the current command status info? */
             SET_NEW_CMD_COND(ESP_CMD_TCPIP_CIPSTART, *is_ok);   /* Now actually start connection */
-        } else if (msg->i == 1 && CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)) {
+        } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTART)) {
             SET_NEW_CMD(ESP_CMD_TCPIP_CIPSTATUS);   /* Go to status mode */
-        } else if (msg->i == 2 && CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTATUS)) {
+        } else if (msg->i > 0 && CMD_IS_CUR(ESP_CMD_TCPIP_CIPSTATUS)) {
             /* Check if connect actually succedded */
             if (!msg->msg.conn_start.success) {
                 *is_ok = 0;
                 *is_error = 1;
             }
         }
+#endif /* !ESP_CFG_CONN_STATUS_TRUST_EVENTS */
+#if ESP_CFG_MQTT_AT
+    } else if (CMD_IS_DEF(ESP_CMD_MQTT_CONN)) {
+        if (CMD_IS_CUR(ESP_CMD_MQTT_USERCFG)) {
+            SET_NEW_CMD_CHECK_ERROR(ESP_CMD_MQTT_CONNCFG);
+        } else if (CMD_IS_CUR(ESP_CMD_MQTT_CONNCFG)) {
+            SET_NEW_CMD_CHECK_ERROR(ESP_CMD_MQTT_CONN);
+        }
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_BLE
+    } else if (CMD_IS_DEF(ESP_CMD_BLEADVSTART)) {
+        if (CMD_IS_CUR(ESP_CMD_BLEINIT)) {       /* Server initialized, set name and create services */
+            SET_NEW_CMD_CHECK_ERROR(msg->msg.ble.name != NULL ? ESP_CMD_BLENAME : ESP_CMD_BLEGATTSSRVCRE);
+        } else if (CMD_IS_CUR(ESP_CMD_BLENAME)) {
+            SET_NEW_CMD_CHECK_ERROR(ESP_CMD_BLEGATTSSRVCRE);
+        } else if (CMD_IS_CUR(ESP_CMD_BLEGATTSSRVCRE)) {
+            SET_NEW_CMD_CHECK_ERROR(ESP_CMD_BLEGATTSSRVSTART);
+        } else if (CMD_IS_CUR(ESP_CMD_BLEGATTSSRVSTART)) {
+            SET_NEW_CMD_CHECK_ERROR(ESP_CMD_BLEADVSTART);
+        }
+    } else if (CMD_IS_DEF(ESP_CMD_BLEINIT)) {
+        if (*is_ok) {
+            esp.m.ble_conns = 0;                /* Clients are disconnected with BLE */
+        }
+    } else if (CMD_IS_DEF(ESP_CMD_BLEGATTSNTFY)) {
+        if (*is_ok) {
+            msg->msg.ble.ptr += msg->msg.ble.sent;
+            SET_NEW_CMD_COND(ESP_CMD_BLEGATTSNTFY, msg->msg.ble.ptr < msg->msg.ble.len);    /* Send next part */
+        }
+#endif /* ESP_CFG_BLE */
     } else if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPCLOSE)) {
-        if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPCLOSE) && *is_error) {
+        if (msg->msg.conn_close.conn == NULL) { /* All connections closed with single command */
+            if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPCLOSE) && *is_ok) {
+                for (uint32_t active = esp.m.conns_active_mask; active; active &= active - 1) {
+                    esp_conn_t* c = &esp.m.conns[espi_bit_ffs(active)];
+                    if (c->buff.buff != NULL) {
+                        espi_conn_buff_free(c->buff.buff);
+                        c->buff.buff = NULL;
+                    }
+                }
+                reset_connections(1);           /* Device may not report every closed connection */
+            }
+        } else if (CMD_IS_CUR(ESP_CMD_TCPIP_CIPCLOSE) && *is_error) {
             /* Notify upper layer about failed close event */
             esp.evt.type = ESP_EVT_CONN_CLOSE;
             esp.evt.evt.conn_active_close.conn = msg->msg.conn_close.conn;
@@ -1484,7 +3985,7 @@ espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t*
                     SET_NEW_CMD(ESP_CMD_TCPIP_CIPRECVLEN);
                 } else {
                     /* Number of bytes to read */
-                    len = ESP_MIN(ESP_CFG_CONN_MAX_DATA_LEN, msg->msg.ciprecvdata.conn->tcp_available_bytes);
+                    len = espi_conn_manual_tcp_get_read_len(msg->msg.ciprecvdata.conn);
                     if (len > 0) {
                         esp_pbuf_p p = NULL;
 
@@ -1580,6 +4081,12 @@ espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t*
         }
     } else {
         msg->cmd = ESP_CMD_IDLE;
+#if ESP_CFG_RESET_RECOVERY
+        espi_recovery_update(msg, *is_ok);      /* Command finished, remember its settings */
+#endif /* ESP_CFG_RESET_RECOVERY */
+#if ESP_CFG_CONFIG_SNAPSHOT
+        espi_snapshot_update(msg, *is_ok);      /* Command finished, record applied setting */
+#endif /* ESP_CFG_CONFIG_SNAPSHOT */
     }
     return *is_ok || *is_ready ? espOK : espERR;
 }
@@ -1592,6 +4099,14 @@ espi_process_sub_cmd(esp_msg_t* msg, uint8_t* is_ok, uint8_t* is_error, uint8_t*
  */
 espr_t
 espi_initiate_cmd(esp_msg_t* msg) {
+#if ESP_CFG_CONN_TRANSPARENT
+    /* No AT commands are allowed while data are in transparent mode, except exit sequence */
+    if (esp.m.transparent_conn != NULL && !CMD_IS_CUR(ESP_CMD_TCPIP_TRANSPARENT_EXIT)) {
+        ESP_DEBUGF(ESP_CFG_DBG_CONN | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+            "[CONN] Command %d rejected, transparent mode is active\r\n", (int)CMD_GET_CUR());
+        return espERR;
+    }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
     switch (CMD_GET_CUR()) {                    /* Check current message we want to send over AT */
         case ESP_CMD_RESET: {                   /* Reset MCU with AT commands */
             /* Try hardware reset first */
@@ -1599,7 +4114,7 @@ espi_initiate_cmd(esp_msg_t* msg) {
 
                 /* Set baudrate to default one */
                 esp.ll.uart.baudrate = ESP_CFG_AT_PORT_BAUDRATE;
-                esp_ll_init(&esp.ll);           /* Set new baudrate */
+                espi_ll_init();                 /* Set new baudrate */
 
                 esp_delay(10);                  /* Wait some time */
                 esp.ll.reset_fn(0);             /* Release reset */
@@ -1629,12 +4144,58 @@ espi_initiate_cmd(esp_msg_t* msg) {
             AT_PORT_SEND_END_AT();
             break;
         }
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO
+        case ESP_CMD_AT: {                      /* Test AT link */
+            espi_baudrate_auto_probe_start(msg);
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO */
         case ESP_CMD_GMR: {                     /* Get AT version */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+GMR");
             AT_PORT_SEND_END_AT();
             break;
         }
+#if ESP_CFG_TELEMETRY_INTERVAL > 0
+        case ESP_CMD_SYSRAM: {                  /* Get free RAM of device */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+SYSRAM?");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 */
+#if ESP_CFG_SLEEP
+        case ESP_CMD_SLEEP: {                   /* Set sleep mode */
+            uint8_t is_esp32 = 0;
+            uint32_t mode = 0;
+
+#if ESP_CFG_ESP32
+            is_esp32 = esp.m.device == ESP_DEVICE_ESP32;
+#endif /* ESP_CFG_ESP32 */
+            /* ESP8266 and ESP32 AT firmwares use different numbers for modem and light-sleep */
+            if (msg->msg.sleep.mode == ESP_SLEEP_MODE_MODEM) {
+                mode = is_esp32 ? 1 : 2;
+            } else if (msg->msg.sleep.mode == ESP_SLEEP_MODE_LIGHT) {
+                mode = is_esp32 ? 2 : 1;
+            }
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+SLEEP=");
+            espi_send_number(mode, 0, 0);
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_WAKEUPGPIO: {              /* Configure wakeup from light-sleep */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+WAKEUPGPIO=");
+            espi_send_number(msg->msg.wakeup_gpio.enable, 0, 0);
+            espi_send_number(msg->msg.wakeup_gpio.gpio, 0, 1);
+            espi_send_number(msg->msg.wakeup_gpio.level, 0, 1);
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_SLEEP */
         case ESP_CMD_SYSMSG: {                  /* Enable system messages */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+SYSMSG=3");
@@ -1648,19 +4209,33 @@ espi_initiate_cmd(esp_msg_t* msg) {
             break;
         }
         case ESP_CMD_UART: {                    /* Change UART parameters for AT port */
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO
+            espi_baudrate_auto_probe_start(msg);
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+UART_CUR=");
-            espi_send_number(ESP_U32(msg->msg.uart.baudrate), 0, 0);
+            espi_send_number(ESP_U32(espi_get_uart_cmd_baudrate(msg)), 0, 0);
             AT_PORT_SEND_CONST_STR(",8,1,0,0");
             AT_PORT_SEND_END_AT();
             break;
         }
+#if ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP
         case ESP_CMD_WIFI_CWLAPOPT: {           /* Set visible data on CWLAP command */
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+CWLAPOPT=1,31");
+            if (CMD_IS_DEF(ESP_CMD_WIFI_CWLAP) && msg->msg.ap_list.fields != 0 && msg->i == 0) {
+                AT_PORT_SEND_CONST_STR("+CWLAPOPT=");   /* Options for extended scan */
+                espi_send_number(ESP_U32(!!msg->msg.ap_list.sort), 0, 0);
+                espi_send_number(ESP_U32(msg->msg.ap_list.fields), 0, 1);
+                if (msg->msg.ap_list.opt_rssi > -128) {
+                    espi_send_signed_number(msg->msg.ap_list.opt_rssi, 0, 1);
+                }
+            } else {
+                AT_PORT_SEND_CONST_STR("+CWLAPOPT=1,31");
+            }
             AT_PORT_SEND_END_AT();
             break;
         }
+#endif /* ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP */
 
         /* WiFi related commands */
 
@@ -1688,7 +4263,17 @@ espi_initiate_cmd(esp_msg_t* msg) {
             AT_PORT_SEND_END_AT();
             break;
         }
+#if ESP_CFG_STA_LIST_AP
         case ESP_CMD_WIFI_CWLAP: {              /* List access points */
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0
+            /* Only complete scan with default fields may be reused */
+            esp.m.sta_aps_filling = msg->msg.ap_list.ssid == NULL && msg->msg.ap_list.fields == 0 && !msg->msg.ap_list.stream;
+            if (esp.m.sta_aps_filling) {
+                esp.m.sta_aps_cnt = 0;          /* Table is filled again from response */
+                esp.m.sta_aps_valid = 0;
+                esp.m.sta_aps_overflow = 0;
+            }
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CWLAP");
             if (msg->msg.ap_list.ssid != NULL) {/* Do we want to filter by SSID? */
@@ -1698,6 +4283,7 @@ espi_initiate_cmd(esp_msg_t* msg) {
             AT_PORT_SEND_END_AT();
             break;
         }
+#endif /* ESP_CFG_STA_LIST_AP */
         case ESP_CMD_WIFI_CWAUTOCONN: {         /* Set autoconnect feature */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CWAUTOCONN=");
@@ -1723,6 +4309,11 @@ espi_initiate_cmd(esp_msg_t* msg) {
 #else /* ESP_CFG_MODE_STATION */
                 m = ESP_MODE_AP;                /* Set access point mode */
 #endif /* !ESP_CFG_MODE_STATION_ACCESS_POINT */
+#if ESP_CFG_CONFIG_SNAPSHOT
+                if (esp.snapshot.flags & ESP_SNAPSHOT_MODE) {
+                    m = (esp_mode_t)esp.snapshot.mode;  /* Mode recorded in snapshot */
+                }
+#endif /* ESP_CFG_CONFIG_SNAPSHOT */
             } else {
                 /* Use user setup */
                 m = msg->msg.wifi_mode.mode;
@@ -1868,12 +4459,19 @@ espi_initiate_cmd(esp_msg_t* msg) {
             AT_PORT_SEND_END_AT();
             break;
         }
+#if ESP_CFG_AP_LIST_STA
         case ESP_CMD_WIFI_CWLIF: {              /* List stations connected on access point */
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0
+            esp.m.ap_stas_cnt = 0;              /* Table is filled again from response */
+            esp.m.ap_stas_valid = 0;
+            esp.m.ap_stas_overflow = 0;
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CWLIF");
             AT_PORT_SEND_END_AT();
             break;
         }
+#endif /* ESP_CFG_AP_LIST_STA */
         case ESP_CMD_WIFI_CWQIF: {
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CWQIF=");
@@ -1967,6 +4565,20 @@ espi_initiate_cmd(esp_msg_t* msg) {
 #if ESP_CFG_MODE_STATION
         case ESP_CMD_TCPIP_CIPSTART: {          /* Start a new connection */
             esp_conn_t* c = NULL;
+            uint8_t has_id = !ESP_CFG_SINGLE_CONN;
+#if ESP_CFG_DNS_CACHE_SIZE > 0
+            esp_ip_t ip;
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 */
+
+#if ESP_CFG_CONN_IPD_INFO == 2
+            /* Switch +IPD remote info first when it does not match connection types */
+            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPSTART) && !msg->msg.conn_start.ipd_info_set
+                && espi_ipd_info_required(msg) != esp.m.ipd_info) {
+                msg->msg.conn_start.ipd_info_set = 1;
+                msg->cmd = ESP_CMD_TCPIP_CIPDINFO;
+                return espi_initiate_cmd(msg);
+            }
+#endif /* ESP_CFG_CONN_IPD_INFO == 2 */
 
             /* Do we have wifi connection? */
             if (!esp_sta_has_ip()) {
@@ -1975,13 +4587,27 @@ espi_initiate_cmd(esp_msg_t* msg) {
             }
 
             msg->msg.conn_start.num = 0;
-            for (int16_t i = ESP_CFG_MAX_CONNS - 1; i >= 0; --i) {  /* Find available connection */
-                if (!esp.m.conns[i].status.f.active
-                    || !(esp.m.active_conns & (1 << i))) {
+#if ESP_CFG_CONN_TRANSPARENT
+            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPMODE)) {/* Single connection mode uses first connection */
+                if (!esp.m.conns[0].status.f.active) {
+                    c = &esp.m.conns[0];
+                    c->num = 0;
+                }
+            } else
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+            {
+#if ESP_CFG_CONN_STATUS_TRUST_EVENTS
+                /* Connection table is kept from system messages, take highest free one */
+                uint32_t free_conns = ~esp.m.conns_active_mask & ESP_CONN_ALL_BITS;
+#else /* ESP_CFG_CONN_STATUS_TRUST_EVENTS */
+                /* Connection is in use when active and reported by device, take highest free one */
+                uint32_t free_conns = ~(esp.m.conns_active_mask & esp.m.active_conns) & ESP_CONN_ALL_BITS;
+#endif /* !ESP_CFG_CONN_STATUS_TRUST_EVENTS */
+                if (free_conns) {
+                    uint8_t i = espi_bit_fls(free_conns);
                     c = &esp.m.conns[i];
-                    c->num = ESP_U8(i);
-                    msg->msg.conn_start.num = ESP_U8(i);    /* Set connection number for message structure */
-                    break;
+                    c->num = i;
+                    msg->msg.conn_start.num = i;    /* Set connection number for message structure */
                 }
             }
             if (c == NULL) {
@@ -1993,17 +4619,32 @@ espi_initiate_cmd(esp_msg_t* msg) {
                 *msg->msg.conn_start.conn = c;  /* Save connection for user */
             }
 
+#if ESP_CFG_CONN_TRANSPARENT && !ESP_CFG_SINGLE_CONN
+            has_id = !CMD_IS_DEF(ESP_CMD_TCPIP_CIPMODE);/* No link ID in single connection mode */
+#endif /* ESP_CFG_CONN_TRANSPARENT && !ESP_CFG_SINGLE_CONN */
+
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CIPSTART=");
-            espi_send_number(ESP_U32(c->num), 0, 0);
+            if (has_id) {
+                espi_send_number(ESP_U32(c->num), 0, 0);
+            }
             if (msg->msg.conn_start.type == ESP_CONN_TYPE_SSL) {
-                espi_send_string("SSL", 0, 1, 1);
+                espi_send_string("SSL", 0, 1, has_id);
             } else if (msg->msg.conn_start.type == ESP_CONN_TYPE_TCP) {
-                espi_send_string("TCP", 0, 1, 1);
+                espi_send_string("TCP", 0, 1, has_id);
             } else if (msg->msg.conn_start.type == ESP_CONN_TYPE_UDP) {
-                espi_send_string("UDP", 0, 1, 1);
+                espi_send_string("UDP", 0, 1, has_id);
+            }
+#if ESP_CFG_DNS_CACHE_SIZE > 0
+            /* SSL keeps host name, it may be used for certificate verification */
+            if (msg->msg.conn_start.type != ESP_CONN_TYPE_SSL
+                && espi_dns_cache_get(msg->msg.conn_start.remote_host, &ip)) {
+                espi_send_ip_mac(&ip, 1, 1, 1); /* Use cached address, device does not resolve name again */
+            } else
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 */
+            {
+                espi_send_string(msg->msg.conn_start.remote_host, 0, 1, 1);
             }
-            espi_send_string(msg->msg.conn_start.remote_host, 0, 1, 1);
             espi_send_port(msg->msg.conn_start.remote_port, 0, 1);
 
             /* Connection-type specific features */
@@ -2027,6 +4668,14 @@ espi_initiate_cmd(esp_msg_t* msg) {
 
         case ESP_CMD_TCPIP_CIPCLOSE: {          /* Close the connection */
             esp_conn_p c = msg->msg.conn_close.conn;
+#if ESP_CFG_CONN_TRANSPARENT
+            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPMODE)) {/* Close connection in single connection mode */
+                AT_PORT_SEND_BEGIN_AT();
+                AT_PORT_SEND_CONST_STR("+CIPCLOSE");
+                AT_PORT_SEND_END_AT();
+                break;
+            }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
             if (c != NULL &&
                 /*
                  * Is connection already closed or command
@@ -2036,8 +4685,12 @@ espi_initiate_cmd(esp_msg_t* msg) {
                 return espERR;
             }
             AT_PORT_SEND_BEGIN_AT();
+#if ESP_CFG_SINGLE_CONN
+            AT_PORT_SEND_CONST_STR("+CIPCLOSE");/* Only connection is closed, no link ID */
+#else /* ESP_CFG_SINGLE_CONN */
             AT_PORT_SEND_CONST_STR("+CIPCLOSE=");
             espi_send_number(ESP_U32(msg->msg.conn_close.conn ? msg->msg.conn_close.conn->num : ESP_CFG_MAX_CONNS), 0, 0);
+#endif /* !ESP_CFG_SINGLE_CONN */
             AT_PORT_SEND_END_AT();
             break;
         }
@@ -2054,31 +4707,109 @@ espi_initiate_cmd(esp_msg_t* msg) {
         }
         case ESP_CMD_TCPIP_CIPDINFO: {          /* Set info data on +IPD command */
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+CIPDINFO=1");
+#if ESP_CFG_CONN_IPD_INFO == 2
+            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPSTART) && !esp.m.ipd_info) {
+                AT_PORT_SEND_CONST_STR("+CIPDINFO=1");  /* Enable for UDP connection */
+            } else
+#endif /* ESP_CFG_CONN_IPD_INFO == 2 */
+            if (ESP_CFG_CONN_IPD_INFO == 1) {
+                AT_PORT_SEND_CONST_STR("+CIPDINFO=1");
+            } else {
+                AT_PORT_SEND_CONST_STR("+CIPDINFO=0");  /* Peers are taken from +LINK_CONN */
+            }
             AT_PORT_SEND_END_AT();
             break;
         }
         case ESP_CMD_TCPIP_CIPMUX: {            /* Set multiple connections */
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+CIPMUX=1");
+#if ESP_CFG_CONN_TRANSPARENT
+            if (CMD_IS_DEF(ESP_CMD_TCPIP_CIPMODE) && msg->msg.conn_start.transparent) {
+                AT_PORT_SEND_CONST_STR("+CIPMUX=0");/* Transparent mode requires single connection */
+            } else
+#endif /* ESP_CFG_CONN_TRANSPARENT */
+            {
+#if ESP_CFG_SINGLE_CONN
+                AT_PORT_SEND_CONST_STR("+CIPMUX=0");
+#else /* ESP_CFG_SINGLE_CONN */
+                AT_PORT_SEND_CONST_STR("+CIPMUX=1");
+#endif /* !ESP_CFG_SINGLE_CONN */
+            }
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#if ESP_CFG_CONN_TRANSPARENT
+        case ESP_CMD_TCPIP_CIPMODE: {           /* Set transmission mode */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+CIPMODE=");
+            AT_PORT_SEND_CONST_STR(msg->msg.conn_start.transparent ? "1" : "0");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_TCPIP_CIPSEND_TRANSPARENT: {   /* Start transparent transmission */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+CIPSEND");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_TCPIP_TRANSPARENT_EXIT: {  /* Exit transparent transmission */
+            /*
+             * Sequence must be sent alone with no data
+             * on AT port before and after guard time.
+             *
+             * Core is unlocked during guard time
+             * to allow processing of received data
+             */
+            esp_core_unlock();
+            esp_delay(ESP_CFG_CONN_TRANSPARENT_GUARD_TIME);
+            esp_core_lock();
+            AT_PORT_SEND_CONST_STR("+++");
+            AT_PORT_SEND_FLUSH();
+            esp_core_unlock();
+            esp_delay(ESP_CFG_CONN_TRANSPARENT_GUARD_TIME);
+            esp_core_lock();
+            esp.m.transparent_conn = NULL;      /* Data are processed as AT responses from now */
+            esp.m.transparent_prompt = 0;
+
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+CIPMODE=0");
             AT_PORT_SEND_END_AT();
             break;
         }
+#endif /* ESP_CFG_CONN_TRANSPARENT */
         case ESP_CMD_TCPIP_CIPSSLSIZE: {        /* Set SSL size */
+            size_t size = msg->msg.tcpip_sslsize.size;
+#if ESP_CFG_CONN_SSL_CFG_CACHE
+            if (CMD_IS_DEF(ESP_CMD_RESET) || CMD_IS_DEF(ESP_CMD_RESTORE)) {
+                size = esp.ssl_cache.size;      /* Replay cached value */
+            }
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CIPSSLSIZE=");
-            espi_send_number(ESP_U32(msg->msg.tcpip_sslsize.size), 0, 0);
+            espi_send_number(ESP_U32(size), 0, 0);
             AT_PORT_SEND_END_AT();
             break;
         }
         case ESP_CMD_TCPIP_CIPSSLCCONF: {       /* Set SSL Configuration */
+            uint8_t link_id = msg->msg.tcpip_ssl_cfg.link_id;
+            uint8_t auth_mode = msg->msg.tcpip_ssl_cfg.auth_mode;
+            uint8_t pki_number = msg->msg.tcpip_ssl_cfg.pki_number;
+            uint8_t ca_number = msg->msg.tcpip_ssl_cfg.ca_number;
+#if ESP_CFG_CONN_SSL_CFG_CACHE
+            if (CMD_IS_DEF(ESP_CMD_RESET) || CMD_IS_DEF(ESP_CMD_RESTORE)) {
+                link_id = esp.ssl_cache.cur;    /* Replay cached configuration */
+                auth_mode = esp.ssl_cache.cfg[link_id].auth_mode;
+                pki_number = esp.ssl_cache.cfg[link_id].pki_number;
+                ca_number = esp.ssl_cache.cfg[link_id].ca_number;
+            }
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE */
             AT_PORT_SEND_BEGIN_AT();
             AT_PORT_SEND_CONST_STR("+CIPSSLCCONF=");
-            espi_send_number(ESP_U32(msg->msg.tcpip_ssl_cfg.link_id), 0, 0);
-            espi_send_number(ESP_U32(msg->msg.tcpip_ssl_cfg.auth_mode), 0, 1);
-            espi_send_number(ESP_U32(msg->msg.tcpip_ssl_cfg.pki_number), 0, 1);
-            espi_send_number(ESP_U32(msg->msg.tcpip_ssl_cfg.ca_number), 0, 1);
+            espi_send_number(ESP_U32(link_id), 0, 0);
+            espi_send_number(ESP_U32(auth_mode), 0, 1);
+            espi_send_number(ESP_U32(pki_number), 0, 1);
+            espi_send_number(ESP_U32(ca_number), 0, 1);
             AT_PORT_SEND_END_AT();
+            break;
         }
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
         case ESP_CMD_TCPIP_CIPRECVMODE: {       /* Set TCP data receive mode */
@@ -2110,64 +4841,198 @@ espi_initiate_cmd(esp_msg_t* msg) {
             AT_PORT_SEND_END_AT();
             break;
         }
-        case ESP_CMD_TCPIP_CIPDNS_SET: {        /* DNS set config */
+        case ESP_CMD_TCPIP_CIPDNS_SET: {        /* DNS set config */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+CIPDNS=");
+            espi_send_number(ESP_U32(!!msg->msg.dns_setconfig.en), 0, 0);
+            if (msg->msg.dns_setconfig.en) {
+                if (msg->msg.dns_setconfig.s1 != NULL) {
+                    espi_send_string(msg->msg.dns_setconfig.s1, 0, 1, 1);
+                }
+                if (msg->msg.dns_setconfig.s2 != NULL) {
+                    espi_send_string(msg->msg.dns_setconfig.s2, 0, 1, 1);
+                }
+            }
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_DNS */
+#if ESP_CFG_PING
+        case ESP_CMD_TCPIP_PING: {              /* Ping hostname or IP address */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+PING=");
+            espi_send_string(msg->msg.tcpip_ping.host, 1, 1, 0);
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_PING */
+#if ESP_CFG_SNTP
+        case ESP_CMD_TCPIP_CIPSNTPCFG: {        /* Configure SNTP */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+CIPSNTPCFG=");
+            espi_send_number(ESP_U32(!!msg->msg.tcpip_sntp_cfg.en), 0, 0);
+            espi_send_signed_number(ESP_U32(msg->msg.tcpip_sntp_cfg.tz), 0, 1);
+            if (msg->msg.tcpip_sntp_cfg.h1 != NULL && strlen(msg->msg.tcpip_sntp_cfg.h1)) {
+                espi_send_string(msg->msg.tcpip_sntp_cfg.h1, 0, 1, 1);
+            }
+            if (msg->msg.tcpip_sntp_cfg.h2 != NULL && strlen(msg->msg.tcpip_sntp_cfg.h2)) {
+                espi_send_string(msg->msg.tcpip_sntp_cfg.h2, 0, 1, 1);
+            }
+            if (msg->msg.tcpip_sntp_cfg.h3 != NULL && strlen(msg->msg.tcpip_sntp_cfg.h3)) {
+                espi_send_string(msg->msg.tcpip_sntp_cfg.h3, 0, 1, 1);
+            }
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_TCPIP_CIPSNTPTIME: {       /* Get time over SNTP */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+CIPSNTPTIME?");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_SNTP */
+#if ESP_CFG_ESP32
+        case ESP_CMD_BLEINIT_GET: {
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLEINIT?");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_ESP32 */
+#if ESP_CFG_BLE
+        case ESP_CMD_BLEINIT: {                 /* Initialize as server or deinitialize */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLEINIT=");
+            espi_send_number(msg->msg.ble.en ? 2 : 0, 0, 0);
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_BLENAME: {
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLENAME=");
+            espi_send_string(msg->msg.ble.name, 1, 1, 0);
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_BLEGATTSSRVCRE: {          /* Create default services of AT firmware */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLEGATTSSRVCRE");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_BLEGATTSSRVSTART: {
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLEGATTSSRVSTART");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_BLEADVSTART: {
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLEADVSTART");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_BLEGATTSNTFY: {            /* Notify client, data are sent after prompt */
+            msg->msg.ble.sent = ESP_MIN(msg->msg.ble.len - msg->msg.ble.ptr, ESP_CFG_BLE_NTFY_LEN);
+            msg->msg.ble.wait_result = 0;
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+BLEGATTSNTFY=");
+            espi_send_number(ESP_U32(msg->msg.ble.conn), 0, 0);
+            espi_send_number(ESP_CFG_BLE_SRV_INDEX, 0, 1);
+            espi_send_number(ESP_CFG_BLE_NTFY_CHAR_INDEX, 0, 1);
+            espi_send_number(ESP_U32(msg->msg.ble.sent), 0, 1);
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+#endif /* ESP_CFG_BLE */
+#if ESP_CFG_MQTT_AT
+        case ESP_CMD_MQTT_USERCFG: {            /* Set client ID and credentials, MQTT over TCP */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+MQTTUSERCFG=0,1");
+            espi_send_string(msg->msg.mqtt_at.info->id, 1, 1, 1);
+            espi_send_string(msg->msg.mqtt_at.info->user, 1, 1, 1);
+            espi_send_string(msg->msg.mqtt_at.info->pass, 1, 1, 1);
+            AT_PORT_SEND_CONST_STR(",0,0,\"\"");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_MQTT_CONNCFG: {            /* Set keep-alive and will message */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+MQTTCONNCFG=0");
+            espi_send_number(ESP_U32(msg->msg.mqtt_at.info->keep_alive), 0, 1);
+            AT_PORT_SEND_CONST_STR(",0");       /* Clean session */
+            espi_send_string(msg->msg.mqtt_at.info->will_topic, 1, 1, 1);
+            espi_send_string(msg->msg.mqtt_at.info->will_message, 1, 1, 1);
+            espi_send_number(ESP_U32(msg->msg.mqtt_at.info->will_qos), 0, 1);
+            AT_PORT_SEND_CONST_STR(",0");       /* Will retain */
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_MQTT_CONN: {               /* Connect to broker, without automatic reconnect */
+            AT_PORT_SEND_BEGIN_AT();
+            AT_PORT_SEND_CONST_STR("+MQTTCONN=0");
+            espi_send_string(msg->msg.mqtt_at.host, 1, 1, 1);
+            espi_send_port(msg->msg.mqtt_at.port, 0, 1);
+            AT_PORT_SEND_CONST_STR(",0");
+            AT_PORT_SEND_END_AT();
+            break;
+        }
+        case ESP_CMD_MQTT_PUBRAW: {             /* Publish message, data are sent after prompt */
+            msg->msg.mqtt_at.wait_result = 0;
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+CIPDNS=");
-            espi_send_number(ESP_U32(!!msg->msg.dns_setconfig.en), 0, 0);
-            if (msg->msg.dns_setconfig.en) {
-                if (msg->msg.dns_setconfig.s1 != NULL) {
-                    espi_send_string(msg->msg.dns_setconfig.s1, 0, 1, 1);
-                }
-                if (msg->msg.dns_setconfig.s2 != NULL) {
-                    espi_send_string(msg->msg.dns_setconfig.s2, 0, 1, 1);
-                }
-            }
+            AT_PORT_SEND_CONST_STR("+MQTTPUBRAW=0");
+            espi_send_string(msg->msg.mqtt_at.topic, 1, 1, 1);
+            espi_send_number(ESP_U32(msg->msg.mqtt_at.len), 0, 1);
+            espi_send_number(ESP_U32(msg->msg.mqtt_at.qos), 0, 1);
+            espi_send_number(ESP_U32(!!msg->msg.mqtt_at.retain), 0, 1);
             AT_PORT_SEND_END_AT();
             break;
         }
-#endif /* ESP_CFG_DNS */
-#if ESP_CFG_PING
-        case ESP_CMD_TCPIP_PING: {              /* Ping hostname or IP address */
+        case ESP_CMD_MQTT_SUB: {                /* Subscribe to topic */
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+PING=");
-            espi_send_string(msg->msg.tcpip_ping.host, 1, 1, 0);
+            AT_PORT_SEND_CONST_STR("+MQTTSUB=0");
+            espi_send_string(msg->msg.mqtt_at.topic, 1, 1, 1);
+            espi_send_number(ESP_U32(msg->msg.mqtt_at.qos), 0, 1);
             AT_PORT_SEND_END_AT();
             break;
         }
-#endif /* ESP_CFG_PING */
-#if ESP_CFG_SNTP
-        case ESP_CMD_TCPIP_CIPSNTPCFG: {        /* Configure SNTP */
+        case ESP_CMD_MQTT_UNSUB: {              /* Unsubscribe from topic */
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+CIPSNTPCFG=");
-            espi_send_number(ESP_U32(!!msg->msg.tcpip_sntp_cfg.en), 0, 0);
-            espi_send_signed_number(ESP_U32(msg->msg.tcpip_sntp_cfg.tz), 0, 1);
-            if (msg->msg.tcpip_sntp_cfg.h1 != NULL && strlen(msg->msg.tcpip_sntp_cfg.h1)) {
-                espi_send_string(msg->msg.tcpip_sntp_cfg.h1, 0, 1, 1);
-            }
-            if (msg->msg.tcpip_sntp_cfg.h2 != NULL && strlen(msg->msg.tcpip_sntp_cfg.h2)) {
-                espi_send_string(msg->msg.tcpip_sntp_cfg.h2, 0, 1, 1);
-            }
-            if (msg->msg.tcpip_sntp_cfg.h3 != NULL && strlen(msg->msg.tcpip_sntp_cfg.h3)) {
-                espi_send_string(msg->msg.tcpip_sntp_cfg.h3, 0, 1, 1);
-            }
+            AT_PORT_SEND_CONST_STR("+MQTTUNSUB=0");
+            espi_send_string(msg->msg.mqtt_at.topic, 1, 1, 1);
             AT_PORT_SEND_END_AT();
             break;
         }
-        case ESP_CMD_TCPIP_CIPSNTPTIME: {       /* Get time over SNTP */
+        case ESP_CMD_MQTT_CLEAN: {              /* Close connection */
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+CIPSNTPTIME?");
+            AT_PORT_SEND_CONST_STR("+MQTTCLEAN=0");
             AT_PORT_SEND_END_AT();
             break;
         }
-#endif /* ESP_CFG_SNTP */
-#if ESP_CFG_ESP32
-        case ESP_CMD_BLEINIT_GET: {
+#endif /* ESP_CFG_MQTT_AT */
+#if ESP_CFG_HTTP_CLIENT_AT
+        case ESP_CMD_HTTPCLIENT: {              /* Send HTTP request, host and path are taken from URL */
+            const char* hdr = msg->msg.http_at.headers;
+
+            esp.m.http_at_recv.read = 0;
             AT_PORT_SEND_BEGIN_AT();
-            AT_PORT_SEND_CONST_STR("+BLEINIT?");
+            AT_PORT_SEND_CONST_STR("+HTTPCLIENT=");
+            espi_send_number(ESP_U32(msg->msg.http_at.method), 0, 0);
+            espi_send_number(ESP_U32(msg->msg.http_at.content_type), 0, 1);
+            espi_send_string(msg->msg.http_at.url, 1, 1, 1);
+            AT_PORT_SEND_CONST_STR(",\"\",\"\"");
+            espi_send_number(strncmp(msg->msg.http_at.url, "https://", 8) ? 1 : 2, 0, 1);
+            if (msg->msg.http_at.data != NULL || msg->msg.http_at.headers_cnt > 0) {
+                espi_send_string(msg->msg.http_at.data, 1, 1, 1);
+            }
+            for (size_t i = 0; i < msg->msg.http_at.headers_cnt; ++i) {
+                espi_send_string(hdr, 1, 1, 1);
+                hdr += strlen(hdr) + 1;
+            }
             AT_PORT_SEND_END_AT();
             break;
         }
-#endif /* ESP_CFG_ESP32 */
+#endif /* ESP_CFG_HTTP_CLIENT_AT */
 
         default:
             return espERR;                      /* Invalid command */
@@ -2190,6 +5055,535 @@ espi_is_valid_conn_ptr(esp_conn_p conn) {
     return 0;
 }
 
+#if ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__
+
+/**
+ * \brief           Get priority lane for command
+ * \param[in]       cmd: Default command of message
+ * \return          Member of \ref esp_msg_prio_t enumeration
+ */
+static esp_msg_prio_t
+espi_get_msg_prio(esp_cmd_t cmd) {
+    switch (cmd) {
+        case ESP_CMD_RESTORE:
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+#if ESP_CFG_STA_LIST_AP || __DOXYGEN__
+        case ESP_CMD_WIFI_CWLAP:
+#endif /* ESP_CFG_STA_LIST_AP || __DOXYGEN__ */
+        case ESP_CMD_WIFI_CWJAP:
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+#if (ESP_CFG_MODE_ACCESS_POINT && ESP_CFG_AP_LIST_STA) || __DOXYGEN__
+        case ESP_CMD_WIFI_CWLIF:
+#endif /* (ESP_CFG_MODE_ACCESS_POINT && ESP_CFG_AP_LIST_STA) || __DOXYGEN__ */
+#if ESP_CFG_WPS || __DOXYGEN__
+        case ESP_CMD_WIFI_WPS:
+#endif /* ESP_CFG_WPS || __DOXYGEN__ */
+#if ESP_CFG_DNS || __DOXYGEN__
+        case ESP_CMD_TCPIP_CIPDOMAIN:
+#endif /* ESP_CFG_DNS || __DOXYGEN__ */
+#if ESP_CFG_PING || __DOXYGEN__
+        case ESP_CMD_TCPIP_PING:
+#endif /* ESP_CFG_PING || __DOXYGEN__ */
+        case ESP_CMD_TCPIP_CIUPDATE:
+            return ESP_MSG_PRIO_LOW;
+        default:
+            return ESP_MSG_PRIO_HIGH;
+    }
+}
+
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__ */
+
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+
+/**
+ * \brief           Wake-up token in \ref esp_t.mbox_producer for messages in connection send queues
+ */
+#define ESP_CONN_SEND_Q_TOKEN               ((void *)esp.conn_send_q)
+
+/**
+ * \brief           Get connection send queue for message
+ * \note            Core must be locked when calling this function
+ * \param[in]       msg: Message to check
+ * \return          Send queue to write message to or `NULL` if message goes to producer queue
+ */
+static esp_conn_send_q_t*
+espi_conn_send_q_get_for_msg(esp_msg_t* msg) {
+    esp_conn_send_q_t* q;
+
+    if (msg->cmd_def == ESP_CMD_TCPIP_CIPSEND) {
+        return &esp.conn_send_q[msg->msg.conn_send.conn - esp.m.conns];
+    } else if (msg->cmd_def == ESP_CMD_TCPIP_CIPCLOSE && msg->msg.conn_close.conn != NULL) {
+        /* Close must not overtake data, already waiting to be sent */
+        q = &esp.conn_send_q[msg->msg.conn_close.conn - esp.m.conns];
+        return q->len > 0 ? q : NULL;
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Write wake-up token for connection send queues to producer queue
+ *
+ * Producer queue may be full of other messages and token does not fit.
+ * In this case flag is cleared and producing thread writes token again
+ * as soon as it takes next message from queue
+ *
+ * \note            Core must be locked when calling this function
+ */
+static void
+espi_conn_send_q_wakeup(void) {
+    if (esp.conn_send_q_mask && !esp.conn_send_q_token) {
+        esp.conn_send_q_token = 1;
+        if (!esp_sys_mbox_putnow(&esp.mbox_producer, ESP_CONN_SEND_Q_TOKEN)) {
+            esp.conn_send_q_token = 0;          /* Retry after producer frees an entry */
+        }
+    }
+}
+
+/**
+ * \brief           Write message to the end of connection send queue
+ *
+ * Producing thread is woken up with single token for all send queues
+ *
+ * \note            Core must be locked when calling this function
+ * \param[in]       q: Connection send queue
+ * \param[in]       msg: Message to write
+ */
+static void
+espi_conn_send_q_put(esp_conn_send_q_t* q, esp_msg_t* msg) {
+    msg->send_q_next = NULL;
+    if (q->last != NULL) {
+        q->last->send_q_next = msg;
+    } else {
+        q->first = msg;
+    }
+    q->last = msg;
+    ++q->len;
+    esp.conn_send_q_mask |= ESP_CONN_BIT(q - esp.conn_send_q);
+    espi_conn_send_q_wakeup();
+}
+
+/**
+ * \brief           Take next message from connection send queues
+ *
+ * Connections are served in weighted round-robin order, one message per token.
+ * Connection keeps its turn for as many messages as its send weight.
+ * Token is written back to producer queue when more messages are waiting,
+ * so other commands get their turn in between
+ *
+ * \note            Called from producing thread when it receives token
+ * \return          Message to process or `NULL` if all send queues are empty
+ */
+static esp_msg_t*
+espi_conn_send_q_get(void) {
+    esp_conn_send_q_t* q;
+    esp_msg_t* msg = NULL;
+    uint32_t mask;
+    uint8_t num, weight;
+
+    esp_core_lock();
+    esp.conn_send_q_token = 0;
+    if (esp.conn_send_q_mask) {
+        mask = esp.conn_send_q_mask >> esp.conn_send_q_next;
+        if (mask) {                             /* Continue after last served connection */
+            num = esp.conn_send_q_next + espi_bit_ffs(mask);
+        } else {                                /* Wrap around */
+            num = espi_bit_ffs(esp.conn_send_q_mask);
+        }
+        if (num != esp.conn_send_q_next) {      /* Turn of other connection starts */
+            esp.conn_send_q_burst = 0;
+        }
+
+        q = &esp.conn_send_q[num];
+        msg = q->first;
+        q->first = msg->send_q_next;
+        if (q->first == NULL) {
+            q->last = NULL;
+            esp.conn_send_q_mask &= ~ESP_CONN_BIT(num);
+        }
+        --q->len;
+
+        /* Keep turn while connection has messages and weight allows it */
+        weight = esp.m.conns[num].send_weight > 0 ? esp.m.conns[num].send_weight : 1;
+        if (q->len > 0 && ++esp.conn_send_q_burst < weight) {
+            esp.conn_send_q_next = num;
+        } else {
+            esp.conn_send_q_next = (num + 1) % ESP_CFG_MAX_CONNS;
+            esp.conn_send_q_burst = 0;
+        }
+
+        espi_conn_send_q_wakeup();
+#if ESP_CFG_OS
+        if (esp.conn_send_q_waiters > 0) {
+            esp_sys_sem_release(&esp.conn_send_q_sem);  /* Writers may check their queue again */
+        }
+#endif /* ESP_CFG_OS */
+    }
+    esp_core_unlock();
+    return msg;
+}
+
+/**
+ * \brief           Wait for space in connection send queue
+ *
+ * Calling thread waits while connection has \ref ESP_CFG_CONN_SEND_QUEUE_LEN or more
+ * send commands queued. Function returns immediately when called from callback
+ * or with core locked, as producing thread could not make progress.
+ *
+ * \param[in]       conn: Connection to write data to
+ */
+void
+espi_conn_send_q_wait(esp_conn_p conn) {
+#if ESP_CFG_OS && ESP_CFG_CONN_SEND_QUEUE_LEN > 0
+    esp_conn_send_q_t* q = &esp.conn_send_q[conn - esp.m.conns];
+
+    esp_core_lock();
+    while (esp.locked_cnt == 1 && esp.status.f.dev_present
+            && q->len >= ESP_CFG_CONN_SEND_QUEUE_LEN) {
+        ++esp.conn_send_q_waiters;
+        esp_core_unlock();
+        /* Semaphore is shared by all connections, check queue periodically too */
+        esp_sys_sem_wait(&esp.conn_send_q_sem, 10);
+        esp_core_lock();
+        --esp.conn_send_q_waiters;
+    }
+    esp_core_unlock();
+#else /* ESP_CFG_OS && ESP_CFG_CONN_SEND_QUEUE_LEN > 0 */
+    ESP_UNUSED(conn);
+#endif /* !(ESP_CFG_OS && ESP_CFG_CONN_SEND_QUEUE_LEN > 0) */
+}
+
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__
+
+/**
+ * \brief           Write wake-up tokens again, which did not fit to full producer queue before
+ * \note            Called after producer took token from queue
+ */
+static void
+espi_producer_tokens_retry(void) {
+    if (esp.producer_lane_tokens == 0
+#if ESP_CFG_CONN_SEND_QUEUE
+        && (!esp.conn_send_q_mask || esp.conn_send_q_token)
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+    ) {
+        return;
+    }
+    esp_core_lock();
+    while (esp.producer_lane_tokens > 0
+        && esp_sys_mbox_putnow(&esp.mbox_producer, &esp.mbox_producer_lane[ESP_MSG_PRIO_HIGH])) {
+        --esp.producer_lane_tokens;
+    }
+#if ESP_CFG_CONN_SEND_QUEUE
+    espi_conn_send_q_wakeup();
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__ */
+
+/**
+ * \brief           Write message to producer queue
+ * \param[in]       msg: Message to write
+ * \param[in]       blocking: Set to `1` to wait for free space in queue
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+espi_put_msg_to_producer_mbox(esp_msg_t* msg, uint8_t blocking) {
+#if !ESP_CFG_OS
+    ESP_UNUSED(blocking);                       /* Messages are never blocking without OS */
+#endif /* !ESP_CFG_OS */
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    esp_sys_mbox_t* lane = &esp.mbox_producer_lane[msg->prio];
+
+#if ESP_CFG_OS
+    if (blocking) {
+        esp_sys_mbox_put(lane, msg);
+    } else
+#endif /* ESP_CFG_OS */
+    if (!esp_sys_mbox_putnow(lane, msg)) {
+        return 0;
+    }
+
+    /*
+     * Wake-up producer thread with one token per message.
+     * Token that does not fit to full queue is written after producer frees an entry
+     */
+    esp_core_lock();
+    if (!esp_sys_mbox_putnow(&esp.mbox_producer, lane)) {
+        ++esp.producer_lane_tokens;
+    }
+    esp_core_unlock();
+    return 1;
+#else /* ESP_CFG_THREAD_PRODUCER_PRIO */
+#if ESP_CFG_OS
+    if (blocking) {
+        esp_sys_mbox_put(&esp.mbox_producer, msg);
+        return 1;
+    }
+#endif /* ESP_CFG_OS */
+    return esp_sys_mbox_putnow(&esp.mbox_producer, msg);
+#endif /* !ESP_CFG_THREAD_PRODUCER_PRIO */
+}
+
+/**
+ * \brief           Wait for next message in producer queue
+ *
+ * With priority lanes enabled, message from highest priority lane is returned first
+ *
+ * \note            When \ref ESP_CFG_OS is disabled, function does not wait
+ *                  and returns `NULL` if queue is empty
+ *
+ * \return          Message to process
+ */
+esp_msg_t*
+espi_get_msg_from_producer_mbox(void) {
+    void* msg = NULL;
+#if ESP_CFG_OS
+    uint32_t time;
+
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    do {
+        time = esp_sys_mbox_get(&esp.mbox_producer, &msg, 0);   /* Wait for wake-up token */
+        if (time != ESP_SYS_TIMEOUT) {
+            espi_producer_tokens_retry();       /* Entry is free now */
+        }
+#if ESP_CFG_CONN_SEND_QUEUE
+        if (time != ESP_SYS_TIMEOUT && msg == ESP_CONN_SEND_Q_TOKEN) {
+            if ((msg = espi_conn_send_q_get()) != NULL) {
+                return msg;                     /* Message from send queue, not from lanes */
+            }
+        }
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+    } while (time == ESP_SYS_TIMEOUT || msg == NULL);
+
+    /* Every token has its message in one of lanes */
+    msg = NULL;
+    while (msg == NULL) {
+        for (size_t i = 0; i < ESP_MSG_PRIO_END; ++i) {
+            if (esp_sys_mbox_getnow(&esp.mbox_producer_lane[i], &msg) && msg != NULL) {
+                break;
+            }
+        }
+    }
+#else /* ESP_CFG_THREAD_PRODUCER_PRIO */
+    do {
+        time = esp_sys_mbox_get(&esp.mbox_producer, &msg, 0);   /* Get message from queue */
+#if ESP_CFG_CONN_SEND_QUEUE
+        if (time != ESP_SYS_TIMEOUT && msg == ESP_CONN_SEND_Q_TOKEN) {
+            msg = espi_conn_send_q_get();
+        } else if (time != ESP_SYS_TIMEOUT && esp.conn_send_q_mask && !esp.conn_send_q_token) {
+            esp_core_lock();
+            espi_conn_send_q_wakeup();          /* Token did not fit to full queue before */
+            esp_core_unlock();
+        }
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+    } while (time == ESP_SYS_TIMEOUT || msg == NULL);
+#endif /* !ESP_CFG_THREAD_PRODUCER_PRIO */
+#else /* ESP_CFG_OS */
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    if (esp_sys_mbox_getnow(&esp.mbox_producer, &msg)) {    /* Take wake-up token */
+        espi_producer_tokens_retry();           /* Entry is free now */
+#if ESP_CFG_CONN_SEND_QUEUE
+        if (msg == ESP_CONN_SEND_Q_TOKEN) {
+            return espi_conn_send_q_get();
+        }
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+        msg = NULL;
+        for (size_t i = 0; i < ESP_MSG_PRIO_END; ++i) {
+            if (esp_sys_mbox_getnow(&esp.mbox_producer_lane[i], &msg) && msg != NULL) {
+                break;
+            }
+        }
+    }
+#else /* ESP_CFG_THREAD_PRODUCER_PRIO */
+    if (!esp_sys_mbox_getnow(&esp.mbox_producer, &msg)) {
+        msg = NULL;
+#if ESP_CFG_CONN_SEND_QUEUE
+    } else if (msg == ESP_CONN_SEND_Q_TOKEN) {
+        msg = espi_conn_send_q_get();
+    } else if (esp.conn_send_q_mask && !esp.conn_send_q_token) {
+        esp_core_lock();
+        espi_conn_send_q_wakeup();              /* Token did not fit to full queue before */
+        esp_core_unlock();
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+    }
+#endif /* !ESP_CFG_THREAD_PRODUCER_PRIO */
+#endif /* !ESP_CFG_OS */
+    return msg;
+}
+
+#if ESP_CFG_CMD_COALESCE || __DOXYGEN__
+
+/**
+ * \brief           Check if message is idempotent status command, which may be coalesced
+ * \param[in]       msg: Message to check
+ * \return          `1` if message may be coalesced, `0` otherwise
+ */
+static uint8_t
+espi_cmd_coalesce_is_status(esp_msg_t* msg) {
+    return msg->cmd_def == ESP_CMD_TCPIP_CIPSTATUS;
+}
+
+/**
+ * \brief           Mark message as taken from producer queue
+ * \note            Called from producing thread with core locked
+ * \param[in]       msg: Message taken from queue
+ */
+void
+espi_cmd_coalesce_dequeued(esp_msg_t* msg) {
+    if (espi_cmd_coalesce_is_status(msg)) {
+        esp.status.f.cipstatus_queued = 0;      /* New request needs new command */
+    }
+}
+
+#endif /* ESP_CFG_CMD_COALESCE || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_CANCEL || __DOXYGEN__
+
+/**
+ * \brief           Remove message from list of queued messages
+ * \note            Called from producing thread with core locked,
+ *                  or when message did not get to queue
+ * \param[in]       msg: Message taken from queue
+ */
+void
+espi_cmd_cancel_dequeued(esp_msg_t* msg) {
+    for (esp_msg_t** m = &esp.cmd_queued; *m != NULL; m = &(*m)->queued_next) {
+        if (*m == msg) {
+            *m = msg->queued_next;
+            break;
+        }
+    }
+}
+
+#endif /* ESP_CFG_CMD_CANCEL || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_BATCH || __DOXYGEN__
+
+/**
+ * \brief           Free all messages in command batch
+ *
+ * Data of send commands were accepted when appended to batch and are released here
+ *
+ * \param[in]       msg: First message in batch
+ */
+static void
+espi_cmd_batch_free(esp_msg_t* msg) {
+    esp_msg_t* next;
+
+    for (; msg != NULL; msg = next) {
+        next = msg->next;
+        if (msg->cmd_def == ESP_CMD_TCPIP_CIPSEND) {
+            CONN_SEND_DATA_FREE(msg);
+        }
+        ESP_MSG_VAR_FREE(msg);
+    }
+}
+
+/**
+ * \brief           Append message to open command batch instead of sending it to producer queue
+ * \note            Core must be locked when calling this function
+ * \param[in]       batch: Command batch
+ * \param[in]       msg: New message to append
+ * \param[in]       process_fn: callback function used to process message
+ * \param[in]       max_block_time: Maximal time command can block in units of milliseconds
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+espi_cmd_batch_append(esp_cmd_batch_t* batch, esp_msg_t* msg, espr_t (*process_fn)(esp_msg_t *), uint32_t max_block_time) {
+    if (!esp.status.f.dev_present) {
+        ESP_MSG_VAR_FREE(msg);
+        return espERRNODEVICE;
+    }
+
+    if (!msg->cmd) {                            /* Set start command if not set by user */
+        msg->cmd = msg->cmd_def;                /* Set it as default */
+    }
+    msg->is_blocking = 0;                       /* Blocking is decided on batch commit */
+    msg->block_time = max_block_time;
+    msg->fn = process_fn;
+#if ESP_CFG_LATENCY_TRACE
+    msg->trace_time = esp_sys_now();
+#endif /* ESP_CFG_LATENCY_TRACE */
+    msg->next = NULL;
+
+    if (batch->last != NULL) {
+        batch->last->next = msg;
+    } else {
+        batch->first = msg;
+    }
+    batch->last = msg;
+    ++batch->cnt;
+    return espOK;
+}
+
+/**
+ * \brief           Send all messages in command batch to producer queue as single message
+ *
+ * Producing thread executes messages one after another.
+ * When any message fails, remaining messages are not executed
+ * and finish with the same error code
+ *
+ * \param[in]       batch: Command batch with at least one message
+ * \param[in]       blocking: Status whether to wait for last command in batch to finish
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise.
+ *                  When blocking, result of last command in batch
+ */
+espr_t
+espi_send_batch_to_producer_mbox(esp_cmd_batch_t* batch, uint32_t blocking) {
+#if ESP_CFG_OS
+    esp_msg_t* last = batch->last;
+#endif /* ESP_CFG_OS */
+    espr_t res = espOK;
+
+    esp_core_lock();
+    if ((!ESP_CFG_OS || esp.locked_cnt > 1) && blocking) {
+        res = espERRBLOCKING;                   /* Blocking mode not allowed */
+    }
+    if (res == espOK && !esp.status.f.dev_present) {
+        res = espERRNODEVICE;                   /* No device connected */
+    }
+    esp_core_unlock();
+
+#if ESP_CFG_OS
+    if (res == espOK && blocking) {
+        if (espi_sem_get(&last->sem)) {         /* Only last message signals completion */
+            last->is_blocking = 1;
+        } else {
+            res = espERRMEM;
+        }
+    }
+#endif /* ESP_CFG_OS */
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    /* Batch goes to low priority lane when any of its commands is slow */
+    for (esp_msg_t* m = batch->first; m != NULL; m = m->next) {
+        if (espi_get_msg_prio(m->cmd_def) == ESP_MSG_PRIO_LOW) {
+            batch->first->prio = ESP_MSG_PRIO_LOW;
+            break;
+        }
+    }
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO */
+    if (res == espOK && !espi_put_msg_to_producer_mbox(batch->first, blocking)) {
+        res = espERRMEM;
+    }
+    if (res != espOK) {
+        espi_cmd_batch_free(batch->first);
+    }
+#if ESP_CFG_OS
+    else if (blocking) {
+        esp_sys_sem_wait(&last->sem, 0);        /* Wait forever for last command */
+        res = last->res;
+        ESP_MSG_VAR_FREE(last);
+    }
+#endif /* ESP_CFG_OS */
+    batch->first = batch->last = NULL;
+    batch->cnt = 0;
+    return res;
+}
+
+#endif /* ESP_CFG_CMD_BATCH || __DOXYGEN__ */
+
 /**
  * \brief           Send message from API function to producer queue for further processing
  * \param[in]       msg: New message to process
@@ -2200,43 +5594,113 @@ espi_is_valid_conn_ptr(esp_conn_p conn) {
 espr_t
 espi_send_msg_to_producer_mbox(esp_msg_t* msg, espr_t (*process_fn)(esp_msg_t *), uint32_t max_block_time) {
     espr_t res = msg->res = espOK;
+    uint8_t is_blocking = msg->is_blocking;     /* Non-blocking message may be freed as soon as it is in queue */
+#if ESP_CFG_CONN_SEND_QUEUE
+    esp_conn_send_q_t* q;
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
 
     /* Check here if stack is even enabled or shall we disable new command entry? */
     esp_core_lock();
+#if ESP_CFG_CMD_BATCH
+    /*
+     * Core stays locked while batch is open,
+     * only thread which opened batch can get here
+     */
+    if (esp.batch != NULL) {
+        res = espi_cmd_batch_append(esp.batch, msg, process_fn, max_block_time);
+        esp_core_unlock();
+        return res;
+    }
+#endif /* ESP_CFG_CMD_BATCH */
     /* If locked more than 1 time, means we were called from callback or internally */
-    if (esp.locked_cnt > 1 && msg->is_blocking) {
+    if ((!ESP_CFG_OS || esp.locked_cnt > 1) && msg->is_blocking) {
         res = espERRBLOCKING;                   /* Blocking mode not allowed */
     }
     /* Check if device present */
     if (res == espOK && !esp.status.f.dev_present) {
         res = espERRNODEVICE;                   /* No device connected */
     }
+#if ESP_CFG_CMD_COALESCE
+    /*
+     * Status command waiting in queue will refresh status also for this request.
+     * Flag is set before message is written to queue,
+     * producing thread clears it when it takes message from queue
+     */
+    if (res == espOK && !msg->is_blocking && espi_cmd_coalesce_is_status(msg)
+#if ESP_CFG_USE_API_FUNC_EVT
+        && msg->evt_fn == NULL
+#endif /* ESP_CFG_USE_API_FUNC_EVT */
+        ) {
+        if (esp.status.f.cipstatus_queued) {
+            esp_core_unlock();
+            ESP_MSG_VAR_FREE(msg);              /* Merge with queued command */
+            return espOK;
+        }
+        esp.status.f.cipstatus_queued = 1;
+    }
+#endif /* ESP_CFG_CMD_COALESCE */
     esp_core_unlock();
     if (res != espOK) {
         ESP_MSG_VAR_FREE(msg);                  /* Free memory and return */
         return res;
     }
 
+#if ESP_CFG_OS
     if (msg->is_blocking) {                     /* In case message is blocking */
-        if (!esp_sys_sem_create(&msg->sem, 0)) {/* Create semaphore and lock it immediatelly */
+        if (!espi_sem_get(&msg->sem)) {         /* Get locked semaphore from cache or create new one */
             ESP_MSG_VAR_FREE(msg);              /* Release memory and return */
             return espERRMEM;
         }
     }
+#endif /* ESP_CFG_OS */
     if (!msg->cmd) {                            /* Set start command if not set by user */
         msg->cmd = msg->cmd_def;                /* Set it as default */
     }
     msg->block_time = max_block_time;           /* Set blocking status if necessary */
     msg->fn = process_fn;                       /* Save processing function to be called as callback */
-    if (msg->is_blocking) {
-        esp_sys_mbox_put(&esp.mbox_producer, msg);  /* Write message to producer queue and wait forever */
-    } else {
-        if (!esp_sys_mbox_putnow(&esp.mbox_producer, msg)) {    /* Write message to producer queue immediatelly */
-            ESP_MSG_VAR_FREE(msg);              /* Release message */
-            return espERRMEM;
+#if ESP_CFG_LATENCY_TRACE
+    msg->trace_time = esp_sys_now();            /* Queue wait starts now */
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_THREAD_PRODUCER_PRIO
+    msg->prio = espi_get_msg_prio(msg->cmd_def);/* Select priority lane */
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO */
+#if ESP_CFG_CMD_CANCEL
+    /* Listed before it is written to queue, producing thread may take it immediately */
+    esp_core_lock();
+    msg->queued_next = esp.cmd_queued;
+    esp.cmd_queued = msg;
+    esp_core_unlock();
+#endif /* ESP_CFG_CMD_CANCEL */
+    /*
+     * Blocking message waits forever for free space, others are written immediately.
+     * Connection send queues have no fixed length, message is always accepted there
+     */
+#if ESP_CFG_CONN_SEND_QUEUE
+    esp_core_lock();
+    if ((q = espi_conn_send_q_get_for_msg(msg)) != NULL) {
+        espi_conn_send_q_put(q, msg);
+    }
+    esp_core_unlock();
+    if (q == NULL)
+#endif /* ESP_CFG_CONN_SEND_QUEUE */
+    if (!espi_put_msg_to_producer_mbox(msg, is_blocking)) {
+#if ESP_CFG_CMD_COALESCE
+        if (espi_cmd_coalesce_is_status(msg)) {
+            esp_core_lock();
+            esp.status.f.cipstatus_queued = 0;  /* Message did not get to queue */
+            esp_core_unlock();
         }
+#endif /* ESP_CFG_CMD_COALESCE */
+#if ESP_CFG_CMD_CANCEL
+        esp_core_lock();
+        espi_cmd_cancel_dequeued(msg);
+        esp_core_unlock();
+#endif /* ESP_CFG_CMD_CANCEL */
+        ESP_MSG_VAR_FREE(msg);                  /* Release message */
+        return espERRMEM;
     }
-    if (res == espOK && msg->is_blocking) {     /* In case we have blocking request */
+#if ESP_CFG_OS
+    if (res == espOK && is_blocking) {          /* In case we have blocking request */
         uint32_t time;
         time = esp_sys_sem_wait(&msg->sem, 0);  /* Wait forever for semaphore */
         if (time == ESP_SYS_TIMEOUT) {          /* If semaphore was not accessed in given time */
@@ -2246,6 +5710,7 @@ espi_send_msg_to_producer_mbox(esp_msg_t* msg, espr_t (*process_fn)(esp_msg_t *)
         }
         ESP_MSG_VAR_FREE(msg);                  /* Release message */
     }
+#endif /* ESP_CFG_OS */
     return res;
 }
 
@@ -2294,11 +5759,16 @@ espi_process_events_for_timeout_or_error(esp_msg_t* msg, espr_t err) {
             break;
         }
 
+#if ESP_CFG_STA_LIST_AP
         case ESP_CMD_WIFI_CWLAP: {
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0
+            esp.m.sta_aps_filling = 0;          /* Table stays invalid after failed scan */
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 */
             /* List failed event */
             STA_LIST_AP_SEND_EVT(msg, err);
             break;
         }
+#endif /* ESP_CFG_STA_LIST_AP */
 
         case ESP_CMD_WIFI_CWJAP_GET: {
             /* Info failed event */
@@ -2310,6 +5780,7 @@ espi_process_events_for_timeout_or_error(esp_msg_t* msg, espr_t err) {
 #if ESP_CFG_PING
         case ESP_CMD_TCPIP_PING: {
             /* Ping error */
+            espi_ping_probe_next(msg, 0);
             PING_SEND_EVT(msg, err);
             break;
         }
@@ -34,15 +34,19 @@
 #include "esp/esp_private.h"
 #include "esp/esp_mem.h"
 #include <limits.h>
+#include <stddef.h>
+#include <string.h>
 
-#if !ESP_CFG_MEM_CUSTOM || __DOXYGEN__
+#if ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM
+/* Functions are defined here, call sites are recorded by wrapper macros elsewhere */
+#undef esp_mem_malloc
+#undef esp_mem_calloc
+#undef esp_mem_realloc
+#undef esp_mem_malloc_tag
+#undef esp_mem_calloc_tag
+#endif /* ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM */
 
-#if !__DOXYGEN__
-typedef struct mem_block {
-    struct mem_block* next;                     /*!< Pointer to next free block */
-    size_t size;                                /*!< Size of block */
-} mem_block_t;
-#endif /* !__DOXYGEN__ */
+#if !ESP_CFG_MEM_CUSTOM || __DOXYGEN__
 
 /**
  * \brief           Memory alignment bits and absolute number
@@ -51,11 +55,69 @@ typedef struct mem_block {
 #define MEM_ALIGN_NUM               ESP_SZ(ESP_CFG_MEM_ALIGNMENT)
 #define MEM_ALIGN(x)                ESP_MEM_ALIGN(x)
 
+/**
+ * \brief           Number of placement classes and class of block
+ */
+#if ESP_CFG_MEM_REGION_CLASS
+#define MEM_CLASS_CNT               ESP_SZ(ESP_MEM_CLASS_END)
+#define MEM_BLOCK_CLASS(b)          ((b)->mem_class)
+#else /* ESP_CFG_MEM_REGION_CLASS */
+#define MEM_CLASS_CNT               ESP_SZ(1)
+#define MEM_BLOCK_CLASS(b)          0
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
+
+#if ESP_CFG_MEM_PROFILE || __DOXYGEN__
+
+/**
+ * \brief           Add free block to fragmentation snapshot
+ * \param[in,out]   frag: Snapshot to update
+ * \param[in]       size: Size of free block including header
+ */
+static void
+mem_frag_add(esp_mem_frag_t* frag, size_t size) {
+    size_t i = 0;
+
+    if (size == 0) {                            /* End of region marker */
+        return;
+    }
+    while (i + 1 < ESP_ARRAYSIZE(frag->hist) && size >= (ESP_SZ(16) << (i + 1))) {
+        ++i;
+    }
+    ++frag->hist[i];
+    ++frag->free_blocks;
+    frag->free_bytes += size;
+    if (size > frag->max_free_block) {
+        frag->max_free_block = size;
+    }
+}
+
+#endif /* ESP_CFG_MEM_PROFILE || __DOXYGEN__ */
+
+#if !ESP_CFG_MEM_TLSF || __DOXYGEN__
+
+#if !__DOXYGEN__
+typedef struct mem_block {
+    struct mem_block* next;                     /*!< Pointer to next free block */
+    size_t size;                                /*!< Size of block */
+#if ESP_CFG_MEM_STATS
+    uint8_t tag;                                /*!< Subsystem tag of allocated block */
+#endif /* ESP_CFG_MEM_STATS */
+#if ESP_CFG_MEM_PROFILE
+    uint16_t site;                              /*!< Index of allocation call site */
+    uint32_t time;                              /*!< Time of allocation in units of milliseconds */
+#endif /* ESP_CFG_MEM_PROFILE */
+#if ESP_CFG_MEM_REGION_CLASS
+    uint8_t mem_class;                          /*!< Placement class of region block belongs to */
+#endif /* ESP_CFG_MEM_REGION_CLASS */
+} mem_block_t;
+#endif /* !__DOXYGEN__ */
+
 #define MEMBLOCK_METASIZE           MEM_ALIGN(sizeof(mem_block_t))
 
 #define MEM_ALLOC_BIT               ((size_t)((size_t)1 << (sizeof(size_t) * CHAR_BIT - 1)))
 #define MEM_BLOCK_FROM_PTR(ptr)     ((mem_block_t *)(((uint8_t *)(ptr)) - MEMBLOCK_METASIZE))
 #define MEM_BLOCK_USER_SIZE(ptr)    ((MEM_BLOCK_FROM_PTR(ptr)->size & ~MEM_ALLOC_BIT) - MEMBLOCK_METASIZE)
+#define MEM_BLOCK_IS_USED(ptr)      ((MEM_BLOCK_FROM_PTR(ptr)->size & MEM_ALLOC_BIT) && MEM_BLOCK_FROM_PTR(ptr)->next == NULL)
 
 static mem_block_t start_block;                 /*!< First block data for allocations */
 static mem_block_t* end_block;                  /*!< Pointer to last block in linked list */
@@ -182,6 +244,9 @@ mem_assignmem(const esp_mem_region_t* regions, size_t len) {
         first_block = (mem_block_t *)mem_start_addr;
         first_block->size = mem_size - MEMBLOCK_METASIZE; /* Exclude end block in chain */
         first_block->next = end_block;          /* Last block is next free in chain */
+#if ESP_CFG_MEM_REGION_CLASS
+        first_block->mem_class = regions->mem_class < ESP_MEM_CLASS_END ? (uint8_t)regions->mem_class : ESP_MEM_CLASS_FAST;
+#endif /* ESP_CFG_MEM_REGION_CLASS */
 
         /*
          * If we have previous end block
@@ -200,13 +265,35 @@ mem_assignmem(const esp_mem_region_t* regions, size_t len) {
     return 1;                                   /* Regions set as expected */
 }
 
+/**
+ * \brief           Find first free block of at least required size
+ * \param[in]       size: Required block size including metadata
+ * \param[in]       cls: Placement class of block or `MEM_CLASS_CNT` for any class
+ * \param[out]      prev: Free block before found block
+ * \return          Found block or `end_block` if not available
+ */
+static mem_block_t *
+mem_find_free(size_t size, size_t cls, mem_block_t** prev) {
+    mem_block_t* curr;
+
+    *prev = &start_block;                       /* Set first first block as previous */
+    curr = (*prev)->next;                       /* Set next block as current */
+    while ((curr->size < size || (cls < MEM_CLASS_CNT && MEM_BLOCK_CLASS(curr) != cls))
+            && (curr->next != NULL)) {
+        *prev = curr;
+        curr = curr->next;
+    }
+    return curr;
+}
+
 /**
  * \brief           Allocate memory of specific size
  * \param[in]       size: Number of bytes to allocate
+ * \param[in]       cls: Preferred placement class
  * \return          Memory address on success, `NULL` otherwise
  */
 static void *
-mem_alloc(size_t size) {
+mem_alloc(size_t size, size_t cls) {
     mem_block_t *prev, *curr, *next;
     void* retval = NULL;
 
@@ -228,11 +315,9 @@ mem_alloc(size_t size) {
      * Go through free blocks until enough memory is found
      * or end block is reached (no next free block)
      */
-    prev = &start_block;                        /* Set first first block as previous */
-    curr = prev->next;                          /* Set next block as current */
-    while ((curr->size < size) && (curr->next != NULL)) {
-        prev = curr;
-        curr = curr->next;
+    curr = mem_find_free(size, cls, &prev);
+    if (curr == end_block && MEM_CLASS_CNT > 1) {
+        curr = mem_find_free(size, MEM_CLASS_CNT, &prev);   /* Use region of any class */
     }
 
     /*
@@ -254,6 +339,9 @@ mem_alloc(size_t size) {
             next = (mem_block_t *)(((uint8_t *)curr) + size);   /* Create next memory block which is still free */
             next->size = curr->size - size;     /* Set new block size for remaining of before and used */
             curr->size = size;                  /* Set block size for used block */
+#if ESP_CFG_MEM_REGION_CLASS
+            next->mem_class = curr->mem_class;
+#endif /* ESP_CFG_MEM_REGION_CLASS */
 
             /*
              * Add virtual block to list of free blocks.
@@ -261,10 +349,9 @@ mem_alloc(size_t size) {
              */
             mem_insertfreeblock(next);          /* Insert free memory block to list of free memory blocks (linked list chain) */
         }
+        mem_available_bytes -= curr->size;      /* Decrease available memory, block may be larger than requested */
         curr->size |= MEM_ALLOC_BIT;            /* Set allocated bit = memory is allocated */
         curr->next = NULL;                      /* Clear next free block pointer as there is no one */
-
-        mem_available_bytes -= size;            /* Decrease available memory */
     } else {
         /* Allocation failed, no free blocks of required size */
     }
@@ -302,155 +389,1288 @@ mem_free(void* ptr) {
 }
 
 /**
- * \brief           Allocate memory of specific size
- * \param[in]       num: Number of elements to allocate
- * \param[in]       size: Size of element in units of bytes
- * \return          Memory address on success, `NULL` otherwise
+ * \brief           Resize allocated block in place
+ *
+ * Block shrinks by splitting off its tail, or grows into free block right after it
+ *
+ * \param[in]       ptr: Pointer to allocated memory
+ * \param[in]       size: New number of bytes
+ * \return          `1` if block was resized, `0` if new block must be allocated
  */
-static void *
-mem_calloc(size_t num, size_t size) {
-    void* ptr;
-    size_t tot_len = num * size;
+static uint8_t
+mem_resize(void* ptr, size_t size) {
+    mem_block_t *block, *prev, *next, *tail;
+    size_t block_size;
 
-    if ((ptr = mem_alloc(tot_len)) != NULL) {   /* Try to allocate memory */
-        ESP_MEMSET(ptr, 0x00, tot_len);         /* Reset entire memory */
+    block = MEM_BLOCK_FROM_PTR(ptr);
+    if (size == 0 || size >= MEM_ALLOC_BIT || !MEM_BLOCK_IS_USED(ptr)) {
+        return 0;
     }
-    return ptr;
+    size = MEM_ALIGN(size) + MEMBLOCK_METASIZE; /* Increase size for metadata */
+    block_size = block->size & ~MEM_ALLOC_BIT;
+
+    if (size > block_size) {
+        /* Find free block physically after current one */
+        next = (mem_block_t *)((uint8_t *)block + block_size);
+        for (prev = &start_block; prev->next != NULL && prev->next < next; prev = prev->next) {}
+        if (prev->next != next || next == end_block || block_size + next->size < size) {
+            return 0;
+        }
+        prev->next = next->next;                /* Remove it from free chain */
+        mem_available_bytes -= next->size;
+        block_size += next->size;
+    }
+
+    /* Give tail back to free list, it merges with free block after it */
+    block->size = block_size | MEM_ALLOC_BIT;
+    if ((block_size - size) > (2 * MEMBLOCK_METASIZE)) {
+        tail = (mem_block_t *)((uint8_t *)block + size);
+        tail->size = (block_size - size) | MEM_ALLOC_BIT;
+        tail->next = NULL;
+#if ESP_CFG_MEM_REGION_CLASS
+        tail->mem_class = block->mem_class;
+#endif /* ESP_CFG_MEM_REGION_CLASS */
+        block->size = size | MEM_ALLOC_BIT;
+        mem_free((uint8_t *)tail + MEMBLOCK_METASIZE);
+    }
+    return 1;
 }
 
+#if ESP_CFG_MEM_STATS
 /**
- * \brief           Reallocate memory to specific size
- * \note            After new memory is allocated, content of old one is copied to new memory
- * \param[in]       ptr: Pointer to current allocated memory to resize, returned using 
- *                      \ref esp_mem_malloc, \ref esp_mem_calloc or \ref esp_mem_realloc functions
- * \param[in]       size: Number of bytes to allocate on new memory
- * \return          Memory address on success, `NULL` otherwise
+ * \brief           Get size of largest free block
+ * \return          Size of block in units of bytes
  */
-static void *
-mem_realloc(void* ptr, size_t size) {
-    void* new_ptr;
-    size_t old_size;
+static size_t
+mem_get_max_free_block(void) {
+    size_t max = 0;
 
-    if (ptr == NULL) {                          /* If pointer is not valid */
-        return mem_alloc(size);                 /* Only allocate memory */
+    if (end_block == NULL) {
+        return 0;
+    }
+    for (mem_block_t* b = start_block.next; b != NULL; b = b->next) {
+        if (b->size > max) {
+            max = b->size;
+        }
     }
+    return max;
+}
+#endif /* ESP_CFG_MEM_STATS */
 
-    old_size = MEM_BLOCK_USER_SIZE(ptr);       	/* Get size of old pointer */
-    new_ptr = mem_alloc(size);                  /* Try to allocate new memory block */
-    if (new_ptr != NULL) {
-        ESP_MEMCPY(new_ptr, ptr, ESP_MIN(size, old_size));  /* Copy old data to new array */
-        mem_free(ptr);                          /* Free old pointer */
+#if ESP_CFG_MEM_PROFILE
+/**
+ * \brief           Add all free blocks to fragmentation snapshot
+ * \param[in,out]   frag: Snapshot to update
+ */
+static void
+mem_get_frag(esp_mem_frag_t* frag) {
+    if (end_block == NULL) {
+        return;
+    }
+    for (mem_block_t* b = start_block.next; b != NULL; b = b->next) {
+        mem_frag_add(frag, b->size);
     }
-    return new_ptr;
 }
+#endif /* ESP_CFG_MEM_PROFILE */
+
+#else /* !ESP_CFG_MEM_TLSF || __DOXYGEN__ */
+
+/*
+ * Two-level segregated fit allocator
+ *
+ * Free blocks are kept in lists, indexed by first level (power of 2 of block size)
+ * and second level (linear subdivision of first level range).
+ * Bitmaps mark non-empty lists, so suitable list is found without iterating.
+ * Every block keeps pointer to previous physical block for constant time merging.
+ * Region ends with used block of size `0` which stops merging with next block.
+ */
+
+#if !__DOXYGEN__
+typedef struct mem_block {
+    struct mem_block* prev_phys;                /*!< Previous physical block, `NULL` for first block in region */
+    size_t size;                                /*!< Size of block including header, lowest bit is free flag */
+#if ESP_CFG_MEM_STATS
+    uint8_t tag;                                /*!< Subsystem tag of allocated block */
+#endif /* ESP_CFG_MEM_STATS */
+#if ESP_CFG_MEM_PROFILE
+    uint16_t site;                              /*!< Index of allocation call site */
+    uint32_t time;                              /*!< Time of allocation in units of milliseconds */
+#endif /* ESP_CFG_MEM_PROFILE */
+#if ESP_CFG_MEM_REGION_CLASS
+    uint8_t mem_class;                          /*!< Placement class of region block belongs to */
+#endif /* ESP_CFG_MEM_REGION_CLASS */
+    struct mem_block* next_free;                /*!< Next block in free list, only valid for free block */
+    struct mem_block* prev_free;                /*!< Previous block in free list, only valid for free block */
+} mem_block_t;
+#endif /* !__DOXYGEN__ */
+
+#define TLSF_SL_BITS                3           /*!< Number of bits for second level index */
+#define TLSF_SL_COUNT               (1U << TLSF_SL_BITS)
+#define TLSF_FL_SHIFT               (TLSF_SL_BITS + 2)
+#define TLSF_SMALL_SIZE             ESP_SZ(1U << TLSF_FL_SHIFT)
+#define TLSF_FL_COUNT               20          /*!< Up to `2^(TLSF_FL_COUNT + TLSF_FL_SHIFT - 1)` bytes block size */
+
+#define MEM_FREE_BIT                ESP_SZ(0x01)
+#define MEMBLOCK_METASIZE           MEM_ALIGN(offsetof(mem_block_t, next_free))
+#define MEMBLOCK_MINSIZE            MEM_ALIGN(sizeof(mem_block_t))
+
+#define MEM_BLOCK_SIZE(b)           ((b)->size & ~MEM_FREE_BIT)
+#define MEM_BLOCK_IS_FREE(b)        ((b)->size & MEM_FREE_BIT)
+#define MEM_BLOCK_NEXT(b)           ((mem_block_t *)((uint8_t *)(b) + MEM_BLOCK_SIZE(b)))
+#define MEM_BLOCK_FROM_PTR(ptr)     ((mem_block_t *)(((uint8_t *)(ptr)) - MEMBLOCK_METASIZE))
+#define MEM_BLOCK_USER_SIZE(ptr)    (MEM_BLOCK_SIZE(MEM_BLOCK_FROM_PTR(ptr)) - MEMBLOCK_METASIZE)
+#define MEM_BLOCK_IS_USED(ptr)      (!MEM_BLOCK_IS_FREE(MEM_BLOCK_FROM_PTR(ptr)) && MEM_BLOCK_SIZE(MEM_BLOCK_FROM_PTR(ptr)) > 0)
+
+static uint32_t fl_bitmap[MEM_CLASS_CNT];       /*!< Bitmaps of non-empty first level ranges, per class */
+static uint8_t sl_bitmap[MEM_CLASS_CNT][TLSF_FL_COUNT]; /*!< Bitmaps of non-empty second level lists */
+static mem_block_t* free_lists[MEM_CLASS_CNT][TLSF_FL_COUNT][TLSF_SL_COUNT]; /*!< Free lists */
+static uint8_t mem_assigned;                    /*!< Set to `1` when regions are assigned */
+static size_t mem_available_bytes;              /*!< Number of available bytes for allocations */
 
 /**
- * \brief           Allocate memory of specific size
- * \param[in]       size: Number of bytes to allocate
- * \return          Memory address on success, `NULL` otherwise
- * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ * \brief           Get index of lowest set bit
+ * \param[in]       v: Value, must not be `0`
+ * \return          Bit index
  */
-void *
-esp_mem_malloc(size_t size) {
-    void* ptr;
-    esp_core_lock();
-    ptr = mem_calloc(1, size);                  /* Allocate memory and return pointer */
-    esp_core_unlock();
-    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
-        "[MEM] Allocation failed: %d bytes\r\n", (int)size);
-    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr != NULL,
-        "[MEM] Allocation OK: %d bytes, addr: %p\r\n", (int)size, ptr);
-    return ptr;
+static uint8_t
+tlsf_ffs(uint32_t v) {
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_ctz(v);
+#else /* defined(__GNUC__) */
+    uint8_t i = 0;
+    while (!(v & 0x01)) {                       /* Bounded to `32` steps */
+        v >>= 1;
+        ++i;
+    }
+    return i;
+#endif /* !defined(__GNUC__) */
 }
 
 /**
- * \brief           Reallocate memory to specific size
- * \note            After new memory is allocated, content of old one is copied to new memory
- * \param[in]       ptr: Pointer to current allocated memory to resize, returned using \ref esp_mem_malloc,
- *                      \ref esp_mem_calloc or \ref esp_mem_realloc functions
- * \param[in]       size: Number of bytes to allocate on new memory
- * \return          Memory address on success, `NULL` otherwise
- * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ * \brief           Get index of highest set bit
+ * \param[in]       v: Value, must not be `0`
+ * \return          Bit index
  */
-void *
-esp_mem_realloc(void* ptr, size_t size) {
-    esp_core_lock();
-    ptr = mem_realloc(ptr, size);               /* Reallocate and return pointer */
-    esp_core_unlock();
-    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
-        "[MEM] Reallocation failed: %d bytes\r\n", (int)size);
-    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr != NULL,
-        "[MEM] Reallocation OK: %d bytes, addr: %p\r\n", (int)size, ptr);
-    return ptr;
+static uint8_t
+tlsf_fls(size_t v) {
+    uint8_t i = 0;
+    while (v >>= 1) {                           /* Bounded to bit width of value */
+        ++i;
+    }
+    return i;
 }
 
 /**
- * \brief           Allocate memory of specific size and set memory to zero
- * \param[in]       num: Number of elements to allocate
- * \param[in]       size: Size of each element
- * \return          Memory address on success, `NULL` otherwise
- * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ * \brief           Get first and second level indexes for block size
+ * \param[in]       size: Block size
+ * \param[out]      fl: First level index
+ * \param[out]      sl: Second level index
  */
-void *
-esp_mem_calloc(size_t num, size_t size) {
-    void* ptr;
-    esp_core_lock();
-    ptr = mem_calloc(num, size);               /* Allocate memory and clear it to 0. Then return pointer */
-    esp_core_unlock();
-    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
-        "[MEM] Callocation failed: %d bytes\r\n", (int)size * (int)num);
-    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr != NULL,
-        "[MEM] Callocation OK: %d bytes, addr: %p\r\n", (int)size * (int)num, ptr);
-    return ptr;
+static void
+tlsf_mapping(size_t size, size_t* fl, size_t* sl) {
+    uint8_t f;
+
+    if (size < TLSF_SMALL_SIZE) {
+        *fl = 0;
+        *sl = size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT);
+    } else {
+        f = tlsf_fls(size);
+        *fl = f - (TLSF_FL_SHIFT - 1);
+        *sl = (size >> (f - TLSF_SL_BITS)) ^ TLSF_SL_COUNT;
+        if (*fl >= TLSF_FL_COUNT) {             /* Larger blocks all go to last list */
+            *fl = TLSF_FL_COUNT - 1;
+            *sl = TLSF_SL_COUNT - 1;
+        }
+    }
 }
 
 /**
- * \brief           Free memory
- * \param[in]       ptr: Pointer to memory previously returned using \ref esp_mem_malloc,
- *                      \ref esp_mem_calloc or \ref esp_mem_realloc functions
- * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ * \brief           Insert free block to its free list
+ * \param[in]       b: Block to insert
  */
-void
-esp_mem_free(void* ptr) {
-    if (ptr == NULL) {
-        return;
+static void
+tlsf_insert(mem_block_t* b) {
+    size_t fl, sl, c = MEM_BLOCK_CLASS(b);
+
+    tlsf_mapping(MEM_BLOCK_SIZE(b), &fl, &sl);
+    b->prev_free = NULL;
+    b->next_free = free_lists[c][fl][sl];
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b;
     }
-    ESP_DEBUGF(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE,
-        "[MEM] Free size: %d, address: %p\r\n",
-        (int)MEM_BLOCK_USER_SIZE(ptr), ptr);
-    esp_core_lock();
-    mem_free(ptr);
-    esp_core_unlock();
+    free_lists[c][fl][sl] = b;
+    fl_bitmap[c] |= (uint32_t)1 << fl;
+    sl_bitmap[c][fl] |= (uint8_t)(1U << sl);
 }
 
 /**
- * \brief           Assign memory region(s) for allocation functions
- * \note            You can allocate multiple regions by assigning start address and region size in units of bytes
- * \param[in]       regions: Pointer to list of regions to use for allocations
- * \param[in]       len: Number of regions to use
- * \return          `1` on success, `0` otherwise
- * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1`
+ * \brief           Remove free block from its free list
+ * \param[in]       b: Block to remove
  */
-uint8_t
-esp_mem_assignmemory(const esp_mem_region_t* regions, size_t len) {
-    uint8_t ret;
-    ret = mem_assignmem(regions, len);          /* Assign memory */
-    return ret;
+static void
+tlsf_remove(mem_block_t* b) {
+    size_t fl, sl, c = MEM_BLOCK_CLASS(b);
+
+    tlsf_mapping(MEM_BLOCK_SIZE(b), &fl, &sl);
+    if (b->prev_free != NULL) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        free_lists[c][fl][sl] = b->next_free;
+    }
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (free_lists[c][fl][sl] == NULL) {        /* List is empty now */
+        sl_bitmap[c][fl] &= (uint8_t)~(1U << sl);
+        if (sl_bitmap[c][fl] == 0) {
+            fl_bitmap[c] &= ~((uint32_t)1 << fl);
+        }
+    }
 }
 
-#endif /* !ESP_CFG_MEM_CUSTOM || __DOXYGEN__ */
+/**
+ * \brief           Find free block of at least required size
+ * \param[in]       size: Required block size
+ * \param[in]       c: Placement class of block
+ * \return          Free block, not yet removed from its list, or `NULL` if not available
+ */
+static mem_block_t *
+tlsf_find(size_t size, size_t c) {
+    mem_block_t* b;
+    size_t fl, sl;
+    uint32_t map;
+
+    /* Round size up to next list, so every block in found list is large enough */
+    if (size >= TLSF_SMALL_SIZE) {
+        size += (ESP_SZ(1) << (tlsf_fls(size) - TLSF_SL_BITS)) - 1;
+    }
+    tlsf_mapping(size, &fl, &sl);
+
+    map = sl_bitmap[c][fl] & (~0U << sl);       /* Lists in the same first level, large enough */
+    if (map == 0) {
+        map = fl_bitmap[c] & (~(uint32_t)0 << (fl + 1));
+        if (map == 0) {
+            return NULL;
+        }
+        fl = tlsf_ffs(map);
+        map = sl_bitmap[c][fl];
+    }
+    sl = tlsf_ffs(map);
+    b = free_lists[c][fl][sl];
+
+    /* Last list holds blocks of different sizes, check it */
+    if (fl == TLSF_FL_COUNT - 1) {
+        for (; b != NULL && MEM_BLOCK_SIZE(b) < size; b = b->next_free) {}
+    }
+    return b;
+}
 
 /**
- * \brief           Free memory in safe way by invalidating pointer after freeing
- * \param[in]       ptr: Pointer to pointer to allocated memory to free
- * \return          `1` on success, `0` otherwise
+ * \brief           Assign memory for HEAP allocations
+ * \param[in]       regions: Pointer to list of regions.
+ *                  Set regions in ascending order by address
+ * \param[in]       len: Number of regions to assign
  */
-uint8_t
-esp_mem_free_s(void** ptr) {
-    if (ptr != NULL && *ptr != NULL) {
-        esp_mem_free(*ptr);
-        *ptr = NULL;
-        return 1;
+static uint8_t
+mem_assignmem(const esp_mem_region_t* regions, size_t len) {
+    uint8_t* mem_start_addr;
+    size_t mem_size;
+    mem_block_t *first_block, *last_block;
+
+    if (mem_assigned) {                         /* Regions already defined */
+        return 0;
     }
-    return 0;
+
+    /* Check if region address are linear and rising */
+    mem_start_addr = (uint8_t *)0;
+    for (size_t i = 0; i < len; ++i) {
+        if (mem_start_addr >= (uint8_t *)regions[i].start_addr) {   /* Check if previous greater than current */
+            return 0;                           /* Return as invalid and failed */
+        }
+        mem_start_addr = (uint8_t *)regions[i].start_addr;  /* Save as previous address */
+    }
+
+    for (; len > 0; --len, ++regions) {
+        mem_size = regions->size;
+
+        /* Align start address and size */
+        mem_start_addr = (uint8_t *)regions->start_addr;
+        if (ESP_SZ(mem_start_addr) & MEM_ALIGN_BITS) {
+            mem_start_addr += MEM_ALIGN_NUM - (ESP_SZ(mem_start_addr) & MEM_ALIGN_BITS);
+            if (mem_size < ESP_SZ(mem_start_addr - (uint8_t *)regions->start_addr)) {
+                continue;
+            }
+            mem_size -= mem_start_addr - (uint8_t *)regions->start_addr;
+        }
+        mem_size &= ~MEM_ALIGN_BITS;
+
+        /* Region must hold at least one block and end block */
+        if (mem_size < (MEMBLOCK_MINSIZE + MEMBLOCK_METASIZE)) {
+            continue;
+        }
+
+        first_block = (mem_block_t *)mem_start_addr;
+        first_block->prev_phys = NULL;
+        first_block->size = (mem_size - MEMBLOCK_METASIZE) | MEM_FREE_BIT;
+#if ESP_CFG_MEM_REGION_CLASS
+        first_block->mem_class = regions->mem_class < ESP_MEM_CLASS_END ? (uint8_t)regions->mem_class : ESP_MEM_CLASS_FAST;
+#endif /* ESP_CFG_MEM_REGION_CLASS */
+
+        last_block = MEM_BLOCK_NEXT(first_block);   /* Used block of size 0 at the end of region */
+        last_block->prev_phys = first_block;
+        last_block->size = 0;
+
+        tlsf_insert(first_block);
+        mem_available_bytes += MEM_BLOCK_SIZE(first_block);
+        mem_assigned = 1;
+    }
+
+    return 1;                                   /* Regions set as expected */
 }
+
+/**
+ * \brief           Allocate memory of specific size
+ * \param[in]       size: Number of bytes to allocate
+ * \param[in]       cls: Preferred placement class
+ * \return          Memory address on success, `NULL` otherwise
+ */
+static void *
+mem_alloc(size_t size, size_t cls) {
+    mem_block_t *b = NULL, *r;
+
+    if (!mem_assigned || size == 0 || size >= (SIZE_MAX >> 1)) {
+        return NULL;
+    }
+
+    size = MEM_ALIGN(size) + MEMBLOCK_METASIZE; /* Increase size for metadata */
+    if (size < MEMBLOCK_MINSIZE) {
+        size = MEMBLOCK_MINSIZE;
+    }
+    if (size > mem_available_bytes) {
+        return NULL;
+    }
+    for (size_t i = 0; i < MEM_CLASS_CNT && b == NULL; ++i) { /* Preferred class first */
+        b = tlsf_find(size, (cls + i) % MEM_CLASS_CNT);
+    }
+    if (b == NULL) {
+        return NULL;
+    }
+    tlsf_remove(b);
+
+    /* Split block when remaining part can be used as free block */
+    if (MEM_BLOCK_SIZE(b) - size >= MEMBLOCK_MINSIZE) {
+        r = (mem_block_t *)((uint8_t *)b + size);
+        r->prev_phys = b;
+        r->size = (MEM_BLOCK_SIZE(b) - size) | MEM_FREE_BIT;
+#if ESP_CFG_MEM_REGION_CLASS
+        r->mem_class = b->mem_class;
+#endif /* ESP_CFG_MEM_REGION_CLASS */
+        MEM_BLOCK_NEXT(r)->prev_phys = r;
+        b->size = size;
+        tlsf_insert(r);
+    }
+    b->size &= ~MEM_FREE_BIT;                   /* Block is used */
+    mem_available_bytes -= MEM_BLOCK_SIZE(b);
+    return (uint8_t *)b + MEMBLOCK_METASIZE;
+}
+
+/**
+ * \brief           Free memory
+ * \param[in]       ptr: Pointer to memory previously returned using \ref esp_mem_malloc,
+ *                      \ref esp_mem_calloc or \ref esp_mem_realloc functions
+ */
+static void
+mem_free(void* ptr) {
+    mem_block_t *b, *n, *p;
+
+    if (ptr == NULL) {                          /* To be in compliance with C free function */
+        return;
+    }
+
+    b = MEM_BLOCK_FROM_PTR(ptr);
+    if (MEM_BLOCK_IS_FREE(b) || MEM_BLOCK_SIZE(b) == 0) {   /* Block must be used */
+        return;
+    }
+    mem_available_bytes += MEM_BLOCK_SIZE(b);
+
+    /* Merge with next physical block */
+    n = MEM_BLOCK_NEXT(b);
+    if (MEM_BLOCK_IS_FREE(n)) {
+        tlsf_remove(n);
+        b->size += MEM_BLOCK_SIZE(n);
+        MEM_BLOCK_NEXT(b)->prev_phys = b;
+    }
+
+    /* Merge with previous physical block */
+    p = b->prev_phys;
+    if (p != NULL && MEM_BLOCK_IS_FREE(p)) {
+        tlsf_remove(p);
+        p->size += MEM_BLOCK_SIZE(b);           /* Free bit of previous block is kept */
+        MEM_BLOCK_NEXT(p)->prev_phys = p;
+        b = p;
+    }
+    b->size |= MEM_FREE_BIT;
+    tlsf_insert(b);
+}
+
+/**
+ * \brief           Resize allocated block in place
+ *
+ * Block shrinks by splitting off its tail, or grows into free block right after it
+ *
+ * \param[in]       ptr: Pointer to allocated memory
+ * \param[in]       size: New number of bytes
+ * \return          `1` if block was resized, `0` if new block must be allocated
+ */
+static uint8_t
+mem_resize(void* ptr, size_t size) {
+    mem_block_t *b, *n, *r;
+
+    if (size == 0 || size >= (SIZE_MAX >> 1) || !MEM_BLOCK_IS_USED(ptr)) {
+        return 0;
+    }
+    size = MEM_ALIGN(size) + MEMBLOCK_METASIZE; /* Increase size for metadata */
+    if (size < MEMBLOCK_MINSIZE) {
+        size = MEMBLOCK_MINSIZE;
+    }
+
+    b = MEM_BLOCK_FROM_PTR(ptr);
+    if (size > MEM_BLOCK_SIZE(b)) {
+        n = MEM_BLOCK_NEXT(b);
+        if (!MEM_BLOCK_IS_FREE(n) || MEM_BLOCK_SIZE(b) + MEM_BLOCK_SIZE(n) < size) {
+            return 0;
+        }
+        tlsf_remove(n);                         /* Merge with next physical block */
+        mem_available_bytes -= MEM_BLOCK_SIZE(n);
+        b->size += MEM_BLOCK_SIZE(n);
+        MEM_BLOCK_NEXT(b)->prev_phys = b;
+    }
+
+    /* Give tail back to free lists, it merges with free block after it */
+    if (MEM_BLOCK_SIZE(b) - size >= MEMBLOCK_MINSIZE) {
+        r = (mem_block_t *)((uint8_t *)b + size);
+        r->prev_phys = b;
+        r->size = MEM_BLOCK_SIZE(b) - size;     /* Used block, until freed */
+#if ESP_CFG_MEM_REGION_CLASS
+        r->mem_class = b->mem_class;
+#endif /* ESP_CFG_MEM_REGION_CLASS */
+        MEM_BLOCK_NEXT(r)->prev_phys = r;
+        b->size = size;
+        mem_free((uint8_t *)r + MEMBLOCK_METASIZE);
+    }
+    return 1;
+}
+
+#if ESP_CFG_MEM_STATS
+/**
+ * \brief           Get size of largest free block
+ * \return          Size of block in units of bytes
+ */
+static size_t
+mem_get_max_free_block(void) {
+    size_t max = 0;
+    uint8_t fl, sl;
+
+    for (size_t c = 0; c < MEM_CLASS_CNT; ++c) {
+        if (fl_bitmap[c] == 0) {
+            continue;
+        }
+        fl = tlsf_fls(fl_bitmap[c]);            /* Largest blocks are in highest non-empty list */
+        sl = tlsf_fls(sl_bitmap[c][fl]);
+        for (mem_block_t* b = free_lists[c][fl][sl]; b != NULL; b = b->next_free) {
+            if (MEM_BLOCK_SIZE(b) > max) {
+                max = MEM_BLOCK_SIZE(b);
+            }
+        }
+    }
+    return max;
+}
+#endif /* ESP_CFG_MEM_STATS */
+
+#if ESP_CFG_MEM_PROFILE
+/**
+ * \brief           Add all free blocks to fragmentation snapshot
+ * \param[in,out]   frag: Snapshot to update
+ */
+static void
+mem_get_frag(esp_mem_frag_t* frag) {
+    for (size_t c = 0; c < MEM_CLASS_CNT; ++c) {
+        for (size_t fl = 0; fl < TLSF_FL_COUNT; ++fl) {
+            for (size_t sl = 0; sl < TLSF_SL_COUNT; ++sl) {
+                for (mem_block_t* b = free_lists[c][fl][sl]; b != NULL; b = b->next_free) {
+                    mem_frag_add(frag, MEM_BLOCK_SIZE(b));
+                }
+            }
+        }
+    }
+}
+#endif /* ESP_CFG_MEM_PROFILE */
+
+#endif /* ESP_CFG_MEM_TLSF && !__DOXYGEN__ */
+
+/**
+ * \brief           Allocate memory of specific size
+ * \param[in]       num: Number of elements to allocate
+ * \param[in]       size: Size of element in units of bytes
+ * \param[in]       cls: Preferred placement class
+ * \return          Memory address on success, `NULL` otherwise
+ */
+static void *
+mem_calloc(size_t num, size_t size, size_t cls) {
+    void* ptr;
+    size_t tot_len = num * size;
+
+    if ((ptr = mem_alloc(tot_len, cls)) != NULL) { /* Try to allocate memory */
+        ESP_MEMSET(ptr, 0x00, tot_len);         /* Reset entire memory */
+    }
+    return ptr;
+}
+
+/**
+ * \brief           Reallocate memory to specific size
+ * \note            Block is resized in place when possible,
+ *                  otherwise content of old one is copied to new memory
+ * \param[in]       ptr: Pointer to current allocated memory to resize, returned using 
+ *                      \ref esp_mem_malloc, \ref esp_mem_calloc or \ref esp_mem_realloc functions
+ * \param[in]       size: Number of bytes to allocate on new memory
+ * \param[in]       cls: Preferred placement class when new memory is allocated
+ * \return          Memory address on success, `NULL` otherwise
+ */
+static void *
+mem_realloc(void* ptr, size_t size, size_t cls) {
+    void* new_ptr;
+    size_t old_size;
+
+    if (ptr == NULL) {                          /* If pointer is not valid */
+        return mem_alloc(size, cls);            /* Only allocate memory */
+    }
+    if (mem_resize(ptr, size)) {                /* Try to avoid copy first */
+        return ptr;
+    }
+
+    old_size = MEM_BLOCK_USER_SIZE(ptr);       	/* Get size of old pointer */
+    new_ptr = mem_alloc(size, MEM_BLOCK_CLASS(MEM_BLOCK_FROM_PTR(ptr)));    /* Keep class of old memory */
+    if (new_ptr != NULL) {
+        ESP_MEMCPY(new_ptr, ptr, ESP_MIN(size, old_size));  /* Copy old data to new array */
+        mem_free(ptr);                          /* Free old pointer */
+    }
+    return new_ptr;
+}
+
+#if ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__
+
+/**
+ * \brief           Get preferred placement class for allocation
+ * \param[in]       tag: Subsystem tag of memory
+ * \param[in]       size: Number of bytes to allocate
+ * \return          Member of \ref esp_mem_class_t enumeration
+ */
+static size_t
+mem_tag_class(esp_mem_tag_t tag, size_t size) {
+    switch (tag) {
+        case ESP_MEM_TAG_MSG:
+            return ESP_MEM_CLASS_FAST;          /* Touched on every command */
+        case ESP_MEM_TAG_CONN:
+        case ESP_MEM_TAG_MQTT:
+        case ESP_MEM_TAG_HTTP:
+            return ESP_MEM_CLASS_BULK;          /* Application data buffers */
+        default:
+            return size <= ESP_CFG_MEM_CLASS_FAST_MAX_SIZE ? ESP_MEM_CLASS_FAST : ESP_MEM_CLASS_BULK;
+    }
+}
+
+#else /* ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__ */
+
+#define mem_tag_class(tag, size)    0
+
+#endif /* !(ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__) */
+
+#if ESP_CFG_MEM_STATS || __DOXYGEN__
+
+static size_t mem_alloc_cnt;                    /*!< Number of allocated blocks */
+static size_t mem_alloc_total;                  /*!< Number of all successful allocations */
+static size_t mem_min_available_bytes = SIZE_MAX;   /*!< Minimal number of available bytes */
+static size_t mem_tag_bytes[ESP_MEM_TAG_END];   /*!< Allocated bytes per tag */
+
+#if ESP_CFG_MEM_PROFILE || __DOXYGEN__
+
+static esp_mem_site_t mem_sites[ESP_CFG_MEM_PROFILE_SITES]; /*!< Call sites, last entry collects unknown sites */
+static size_t mem_sites_cnt;                    /*!< Number of used entries, without last one */
+
+/**
+ * \brief           Find or add entry of allocation call site
+ * \param[in]       file: Source file of caller, `NULL` if unknown
+ * \param[in]       line: Source line of caller
+ * \return          Index of call site entry
+ */
+static uint16_t
+mem_profile_site(const char* file, uint16_t line) {
+    esp_mem_site_t* s;
+
+    if (file == NULL) {
+        return (uint16_t)(ESP_ARRAYSIZE(mem_sites) - 1);
+    }
+    for (size_t i = 0; i < mem_sites_cnt; ++i) {
+        if (mem_sites[i].line == line && (mem_sites[i].file == file || !strcmp(mem_sites[i].file, file))) {
+            return (uint16_t)i;
+        }
+    }
+    if (mem_sites_cnt >= ESP_ARRAYSIZE(mem_sites) - 1) {
+        return (uint16_t)(ESP_ARRAYSIZE(mem_sites) - 1);    /* Table is full */
+    }
+    s = &mem_sites[mem_sites_cnt];
+    s->file = file;
+    s->line = line;
+    return (uint16_t)mem_sites_cnt++;
+}
+
+#endif /* ESP_CFG_MEM_PROFILE || __DOXYGEN__ */
+
+/**
+ * \brief           Update statistics after successful allocation
+ * \param[in]       ptr: Allocated memory, may be `NULL`
+ * \param[in]       tag: Subsystem tag of memory
+ * \param[in]       file: Source file of caller, `NULL` if unknown. Used only by allocation profiler
+ * \param[in]       line: Source line of caller. Used only by allocation profiler
+ */
+static void
+mem_stats_alloc(void* ptr, esp_mem_tag_t tag, const char* file, uint16_t line) {
+#if ESP_CFG_MEM_PROFILE
+    mem_block_t* b;
+    esp_mem_site_t* s;
+    size_t size;
+#endif /* ESP_CFG_MEM_PROFILE */
+
+    if (ptr == NULL) {
+        return;
+    }
+    MEM_BLOCK_FROM_PTR(ptr)->tag = (uint8_t)tag;
+    mem_tag_bytes[tag] += MEM_BLOCK_USER_SIZE(ptr);
+    ++mem_alloc_cnt;
+    ++mem_alloc_total;
+    if (mem_available_bytes < mem_min_available_bytes) {
+        mem_min_available_bytes = mem_available_bytes;
+    }
+#if ESP_CFG_MEM_PROFILE
+    b = MEM_BLOCK_FROM_PTR(ptr);
+    b->site = mem_profile_site(file, line);
+    b->time = esp_sys_now();
+    s = &mem_sites[b->site];
+    size = MEM_BLOCK_USER_SIZE(ptr);
+    s->tag = tag;
+    ++s->alloc_cnt;
+    s->alloc_bytes += size;
+    ++s->live_cnt;
+    s->live_bytes += size;
+    if (size > s->max_size) {
+        s->max_size = size;
+    }
+#else /* ESP_CFG_MEM_PROFILE */
+    ESP_UNUSED(file);
+    ESP_UNUSED(line);
+#endif /* !ESP_CFG_MEM_PROFILE */
+}
+
+/**
+ * \brief           Update statistics before memory is freed
+ * \param[in]       ptr: Memory to free
+ */
+static void
+mem_stats_free(void* ptr) {
+#if ESP_CFG_MEM_PROFILE
+    esp_mem_site_t* s;
+    uint32_t lifetime;
+#endif /* ESP_CFG_MEM_PROFILE */
+
+    if (ptr == NULL || !MEM_BLOCK_IS_USED(ptr)) {
+        return;
+    }
+    mem_tag_bytes[MEM_BLOCK_FROM_PTR(ptr)->tag] -= MEM_BLOCK_USER_SIZE(ptr);
+    --mem_alloc_cnt;
+#if ESP_CFG_MEM_PROFILE
+    s = &mem_sites[MEM_BLOCK_FROM_PTR(ptr)->site];
+    lifetime = esp_sys_now() - MEM_BLOCK_FROM_PTR(ptr)->time;
+    --s->live_cnt;
+    s->live_bytes -= MEM_BLOCK_USER_SIZE(ptr);
+    ++s->free_cnt;
+    s->lifetime_total += lifetime;
+    if (lifetime > s->lifetime_max) {
+        s->lifetime_max = lifetime;
+    }
+    if (lifetime < ESP_CFG_MEM_PROFILE_SHORT_LIVED) {
+        ++s->short_lived_cnt;
+    }
+#endif /* ESP_CFG_MEM_PROFILE */
+}
+
+/**
+ * \brief           Reallocate memory and move statistics to new memory
+ * \param[in]       ptr: Pointer to current allocated memory
+ * \param[in]       size: Number of bytes to allocate on new memory
+ * \param[in]       file: Source file of caller, `NULL` if unknown
+ * \param[in]       line: Source line of caller
+ * \return          Memory address on success, `NULL` otherwise
+ */
+static void *
+mem_realloc_stats(void* ptr, size_t size, const char* file, uint16_t line) {
+    void* new_ptr;
+    esp_mem_tag_t tag = ESP_MEM_TAG_OTHER;
+
+    esp_core_lock();
+    if (ptr != NULL && MEM_BLOCK_IS_USED(ptr)) {
+        tag = (esp_mem_tag_t)MEM_BLOCK_FROM_PTR(ptr)->tag;
+        mem_stats_free(ptr);                    /* Old memory is freed on success */
+    }
+    new_ptr = mem_realloc(ptr, size, mem_tag_class(tag, size)); /* Reallocate and return pointer */
+    mem_stats_alloc(new_ptr != NULL ? new_ptr : ptr, tag, file, line);  /* Old memory stays on failure */
+    esp_core_unlock();
+    return new_ptr;
+}
+
+#endif /* ESP_CFG_MEM_STATS || __DOXYGEN__ */
+
+/**
+ * \brief           Allocate memory of specific size
+ * \param[in]       size: Number of bytes to allocate
+ * \return          Memory address on success, `NULL` otherwise
+ * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ */
+void *
+esp_mem_malloc(size_t size) {
+    void* ptr;
+    esp_core_lock();
+    ptr = mem_calloc(1, size, mem_tag_class(ESP_MEM_TAG_OTHER, size)); /* Allocate memory and return pointer */
+#if ESP_CFG_MEM_STATS
+    mem_stats_alloc(ptr, ESP_MEM_TAG_OTHER, NULL, 0);
+#endif /* ESP_CFG_MEM_STATS */
+    esp_core_unlock();
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
+        "[MEM] Allocation failed: %d bytes\r\n", (int)size);
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr != NULL,
+        "[MEM] Allocation OK: %d bytes, addr: %p\r\n", (int)size, ptr);
+    return ptr;
+}
+
+/**
+ * \brief           Reallocate memory to specific size
+ * \note            After new memory is allocated, content of old one is copied to new memory
+ * \param[in]       ptr: Pointer to current allocated memory to resize, returned using \ref esp_mem_malloc,
+ *                      \ref esp_mem_calloc or \ref esp_mem_realloc functions
+ * \param[in]       size: Number of bytes to allocate on new memory
+ * \return          Memory address on success, `NULL` otherwise
+ * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ */
+void *
+esp_mem_realloc(void* ptr, size_t size) {
+#if ESP_CFG_MEM_STATS
+    ptr = mem_realloc_stats(ptr, size, NULL, 0);
+#else /* ESP_CFG_MEM_STATS */
+    esp_core_lock();
+    ptr = mem_realloc(ptr, size, mem_tag_class(ESP_MEM_TAG_OTHER, size)); /* Reallocate and return pointer */
+    esp_core_unlock();
+#endif /* !ESP_CFG_MEM_STATS */
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
+        "[MEM] Reallocation failed: %d bytes\r\n", (int)size);
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr != NULL,
+        "[MEM] Reallocation OK: %d bytes, addr: %p\r\n", (int)size, ptr);
+    return ptr;
+}
+
+/**
+ * \brief           Allocate memory of specific size and set memory to zero
+ * \param[in]       num: Number of elements to allocate
+ * \param[in]       size: Size of each element
+ * \return          Memory address on success, `NULL` otherwise
+ * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ */
+void *
+esp_mem_calloc(size_t num, size_t size) {
+    void* ptr;
+    esp_core_lock();
+    ptr = mem_calloc(num, size, mem_tag_class(ESP_MEM_TAG_OTHER, num * size)); /* Allocate memory and clear it to 0. Then return pointer */
+#if ESP_CFG_MEM_STATS
+    mem_stats_alloc(ptr, ESP_MEM_TAG_OTHER, NULL, 0);
+#endif /* ESP_CFG_MEM_STATS */
+    esp_core_unlock();
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
+        "[MEM] Callocation failed: %d bytes\r\n", (int)size * (int)num);
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr != NULL,
+        "[MEM] Callocation OK: %d bytes, addr: %p\r\n", (int)size * (int)num, ptr);
+    return ptr;
+}
+
+/**
+ * \brief           Free memory
+ * \param[in]       ptr: Pointer to memory previously returned using \ref esp_mem_malloc,
+ *                      \ref esp_mem_calloc or \ref esp_mem_realloc functions
+ * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1` and must be implemented by user
+ */
+void
+esp_mem_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    ESP_DEBUGF(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE,
+        "[MEM] Free size: %d, address: %p\r\n",
+        (int)MEM_BLOCK_USER_SIZE(ptr), ptr);
+    esp_core_lock();
+#if ESP_CFG_MEM_STATS
+    mem_stats_free(ptr);
+#endif /* ESP_CFG_MEM_STATS */
+    mem_free(ptr);
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Assign memory region(s) for allocation functions
+ * \note            You can allocate multiple regions by assigning start address and region size in units of bytes
+ * \param[in]       regions: Pointer to list of regions to use for allocations
+ * \param[in]       len: Number of regions to use
+ * \return          `1` on success, `0` otherwise
+ * \note            Function is not available when \ref ESP_CFG_MEM_CUSTOM is `1`
+ */
+uint8_t
+esp_mem_assignmemory(const esp_mem_region_t* regions, size_t len) {
+    uint8_t ret;
+    ret = mem_assignmem(regions, len);          /* Assign memory */
+    return ret;
+}
+
+#if ESP_CFG_MEM_STATS || ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__
+
+/**
+ * \brief           Allocate memory of specific size for subsystem
+ * \param[in]       size: Number of bytes to allocate
+ * \param[in]       tag: Subsystem using memory, used for statistics and placement class
+ * \return          Memory address on success, `NULL` otherwise
+ */
+void *
+esp_mem_malloc_tag(size_t size, esp_mem_tag_t tag) {
+    return esp_mem_calloc_tag(1, size, tag);
+}
+
+/**
+ * \brief           Allocate memory for subsystem, set it to zero and record caller
+ * \param[in]       num: Number of elements to allocate
+ * \param[in]       size: Size of each element
+ * \param[in]       tag: Subsystem using memory
+ * \param[in]       file: Source file of caller, `NULL` if unknown. Used only by allocation profiler
+ * \param[in]       line: Source line of caller. Used only by allocation profiler
+ * \return          Memory address on success, `NULL` otherwise
+ */
+static void *
+mem_calloc_tag(size_t num, size_t size, esp_mem_tag_t tag, const char* file, uint16_t line) {
+    void* ptr;
+
+    if (tag >= ESP_MEM_TAG_END) {
+        tag = ESP_MEM_TAG_OTHER;
+    }
+    esp_core_lock();
+    ptr = mem_calloc(num, size, mem_tag_class(tag, num * size));
+#if ESP_CFG_MEM_STATS
+    mem_stats_alloc(ptr, tag, file, line);
+#else /* ESP_CFG_MEM_STATS */
+    ESP_UNUSED(file);
+    ESP_UNUSED(line);
+#endif /* !ESP_CFG_MEM_STATS */
+    esp_core_unlock();
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
+        "[MEM] Allocation failed: %d bytes, tag: %d\r\n", (int)size * (int)num, (int)tag);
+    return ptr;
+}
+
+/**
+ * \brief           Allocate memory of specific size for subsystem and set memory to zero
+ * \param[in]       num: Number of elements to allocate
+ * \param[in]       size: Size of each element
+ * \param[in]       tag: Subsystem using memory, used for statistics and placement class
+ * \return          Memory address on success, `NULL` otherwise
+ */
+void *
+esp_mem_calloc_tag(size_t num, size_t size, esp_mem_tag_t tag) {
+    return mem_calloc_tag(num, size, tag, NULL, 0);
+}
+
+#endif /* ESP_CFG_MEM_STATS || ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__ */
+
+#if ESP_CFG_MEM_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get memory manager statistics
+ * \param[out]      stats: Pointer to output structure to fill
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_mem_get_stats(esp_mem_stats_t* stats) {
+    if (stats == NULL) {
+        return 0;
+    }
+    esp_core_lock();
+    stats->free_bytes = mem_available_bytes;
+    stats->min_free_bytes = ESP_MIN(mem_min_available_bytes, mem_available_bytes);
+    stats->max_free_block = mem_get_max_free_block();
+    stats->alloc_cnt = mem_alloc_cnt;
+    stats->alloc_total = mem_alloc_total;
+    ESP_MEMCPY(stats->tag_bytes, mem_tag_bytes, sizeof(stats->tag_bytes));
+    esp_core_unlock();
+
+    stats->fragmentation = 0;
+    if (stats->free_bytes > 0) {
+        stats->fragmentation = (uint8_t)(100 - (uint8_t)((stats->max_free_block * 100) / stats->free_bytes));
+    }
+    return 1;
+}
+
+/**
+ * \brief           Clear number of allocations since start and restart minimal free memory tracking
+ */
+void
+esp_mem_reset_stats(void) {
+    esp_core_lock();
+    mem_alloc_total = 0;
+    mem_min_available_bytes = mem_available_bytes;
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_MEM_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_MEM_PROFILE || __DOXYGEN__
+
+/**
+ * \brief           Allocate memory for subsystem, set it to zero and record caller for allocation profiler
+ *
+ * Called by \ref esp_mem_malloc, \ref esp_mem_calloc, \ref esp_mem_malloc_tag
+ * and \ref esp_mem_calloc_tag macros when \ref ESP_CFG_MEM_PROFILE is enabled
+ *
+ * \param[in]       num: Number of elements to allocate
+ * \param[in]       size: Size of each element
+ * \param[in]       tag: Subsystem using memory
+ * \param[in]       file: Source file of caller
+ * \param[in]       line: Source line of caller
+ * \return          Memory address on success, `NULL` otherwise
+ */
+void *
+esp_mem_calloc_site(size_t num, size_t size, esp_mem_tag_t tag, const char* file, uint16_t line) {
+    return mem_calloc_tag(num, size, tag, file, line);
+}
+
+/**
+ * \brief           Reallocate memory and record caller for allocation profiler
+ *
+ * Called by \ref esp_mem_realloc macro when \ref ESP_CFG_MEM_PROFILE is enabled.
+ * Reallocated block is accounted as freed at its previous site and allocated at new one
+ *
+ * \param[in]       ptr: Pointer to current allocated memory to resize
+ * \param[in]       size: Number of bytes to allocate on new memory
+ * \param[in]       file: Source file of caller
+ * \param[in]       line: Source line of caller
+ * \return          Memory address on success, `NULL` otherwise
+ */
+void *
+esp_mem_realloc_site(void* ptr, size_t size, const char* file, uint16_t line) {
+    ptr = mem_realloc_stats(ptr, size, file, line);
+    ESP_DEBUGW(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE, ptr == NULL,
+        "[MEM] Reallocation failed: %d bytes\r\n", (int)size);
+    return ptr;
+}
+
+/**
+ * \brief           Get usage value of call site to sort by
+ * \param[in]       s: Call site
+ * \param[in]       sort: Usage value to read
+ * \return          Usage value
+ */
+static size_t
+mem_profile_key(const esp_mem_site_t* s, esp_mem_profile_sort_t sort) {
+    switch (sort) {
+        case ESP_MEM_PROFILE_SORT_BYTES: return s->alloc_bytes;
+        case ESP_MEM_PROFILE_SORT_LIVE: return s->live_bytes;
+        default: return s->alloc_cnt;
+    }
+}
+
+/**
+ * \brief           Get allocation call sites with highest usage
+ * \param[out]      sites: Array to fill with call sites, sorted from highest to lowest usage
+ * \param[in]       len: Number of entries in array
+ * \param[in]       sort: Usage value to sort by
+ * \return          Number of entries written to array
+ */
+size_t
+esp_mem_profile_get_sites(esp_mem_site_t* sites, size_t len, esp_mem_profile_sort_t sort) {
+    const esp_mem_site_t* s;
+    size_t n = 0, key, pos;
+
+    if (sites == NULL || len == 0) {
+        return 0;
+    }
+
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(mem_sites); ++i) {
+        if (i == mem_sites_cnt) {               /* Skip unused entries, only last one remains */
+            i = ESP_ARRAYSIZE(mem_sites) - 1;
+        }
+        s = &mem_sites[i];
+        if (s->alloc_cnt == 0 && s->live_cnt == 0) {
+            continue;
+        }
+        key = mem_profile_key(s, sort);
+
+        /* Find position in sorted output, keep only `len` highest entries */
+        for (pos = n; pos > 0 && mem_profile_key(&sites[pos - 1], sort) < key; --pos) {}
+        if (pos >= len) {
+            continue;
+        }
+        if (n < len) {
+            ++n;
+        }
+        for (size_t j = n - 1; j > pos; --j) {
+            sites[j] = sites[j - 1];
+        }
+        sites[pos] = *s;
+    }
+    esp_core_unlock();
+    return n;
+}
+
+/**
+ * \brief           Get fragmentation snapshot of free memory
+ * \param[out]      frag: Pointer to output structure to fill
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_mem_profile_get_frag(esp_mem_frag_t* frag) {
+    if (frag == NULL) {
+        return 0;
+    }
+    ESP_MEMSET(frag, 0x00, sizeof(*frag));
+    esp_core_lock();
+    mem_get_frag(frag);
+    esp_core_unlock();
+    return 1;
+}
+
+/**
+ * \brief           Clear allocation profiler counters
+ * \note            Currently allocated blocks and bytes are kept, they are updated when blocks are freed
+ */
+void
+esp_mem_profile_reset(void) {
+    esp_mem_site_t* s;
+
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(mem_sites); ++i) {
+        s = &mem_sites[i];
+        s->alloc_cnt = 0;
+        s->alloc_bytes = 0;
+        s->max_size = 0;
+        s->free_cnt = 0;
+        s->short_lived_cnt = 0;
+        s->lifetime_total = 0;
+        s->lifetime_max = 0;
+    }
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_MEM_PROFILE || __DOXYGEN__ */
+
+#endif /* !ESP_CFG_MEM_CUSTOM || __DOXYGEN__ */
+
+/**
+ * \brief           Free memory in safe way by invalidating pointer after freeing
+ * \param[in]       ptr: Pointer to pointer to allocated memory to free
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_mem_free_s(void** ptr) {
+    if (ptr != NULL && *ptr != NULL) {
+        esp_mem_free(*ptr);
+        *ptr = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+#if ESP_CFG_MSG_POOL || __DOXYGEN__
+
+#if !__DOXYGEN__
+typedef union msg_pool_entry {
+    union msg_pool_entry* next;                 /*!< Pointer to next free entry */
+    esp_msg_t msg;                              /*!< Message memory */
+} msg_pool_entry_t;
+#endif /* !__DOXYGEN__ */
+
+static msg_pool_entry_t msg_pool[ESP_CFG_THREAD_PRODUCER_MBOX_SIZE];   /*!< Message pool entries */
+static msg_pool_entry_t* msg_pool_free;         /*!< Pointer to first free entry */
+static uint8_t msg_pool_init;                   /*!< Set to `1` when free list is built */
+
+/**
+ * \brief           Get message from fixed-size pool or from heap if pool is empty
+ * \return          Pointer to message memory on success, `NULL` otherwise
+ */
+esp_msg_t *
+espi_msg_pool_alloc(void) {
+    msg_pool_entry_t* e;
+
+    esp_core_lock();
+    if (!msg_pool_init) {                       /* Build free list on first use */
+        for (size_t i = 0; i < ESP_ARRAYSIZE(msg_pool); ++i) {
+            msg_pool[i].next = i + 1 < ESP_ARRAYSIZE(msg_pool) ? &msg_pool[i + 1] : NULL;
+        }
+        msg_pool_free = &msg_pool[0];
+        msg_pool_init = 1;
+    }
+    e = msg_pool_free;
+    if (e != NULL) {
+        msg_pool_free = e->next;                /* Remove entry from free list */
+    }
+    esp_core_unlock();
+
+    if (e == NULL) {                            /* Pool exhausted, use heap */
+#if ESP_CFG_MEM_STATIC
+        ESP_DEBUGF(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE,
+            "[MEM] Message pool empty\r\n");
+        return NULL;
+#else /* ESP_CFG_MEM_STATIC */
+        ESP_DEBUGF(ESP_CFG_DBG_MEM | ESP_DBG_TYPE_TRACE,
+            "[MEM] Message pool empty, using heap\r\n");
+        return esp_mem_malloc_tag(sizeof(esp_msg_t), ESP_MEM_TAG_MSG);
+#endif /* !ESP_CFG_MEM_STATIC */
+    }
+    return &e->msg;
+}
+
+/**
+ * \brief           Return message to fixed-size pool or free it if allocated from heap
+ * \param[in]       msg: Message previously returned by \ref espi_msg_pool_alloc
+ */
+void
+espi_msg_pool_free(esp_msg_t* msg) {
+    msg_pool_entry_t* e = (msg_pool_entry_t *)msg;
+
+    if (msg == NULL) {
+        return;
+    }
+    if (e >= &msg_pool[0] && e < &msg_pool[ESP_ARRAYSIZE(msg_pool)]) {
+        esp_core_lock();
+        e->next = msg_pool_free;                /* Insert entry back to free list */
+        msg_pool_free = e;
+        esp_core_unlock();
+    } else {
+        esp_mem_free(msg);
+    }
+}
+
+#endif /* ESP_CFG_MSG_POOL || __DOXYGEN__ */
+
+#if ESP_CFG_OS || __DOXYGEN__
+
+#if ESP_CFG_SEM_POOL_SIZE > 0
+static esp_sys_sem_t sem_pool[ESP_CFG_SEM_POOL_SIZE];   /*!< Cached semaphores, all in locked state */
+static size_t sem_pool_cnt;                     /*!< Number of cached semaphores */
+#endif /* ESP_CFG_SEM_POOL_SIZE > 0 */
+
+/**
+ * \brief           Get locked semaphore for blocking command
+ *
+ * Semaphore is taken from cache when available, otherwise new one is created
+ *
+ * \param[out]      sem: Semaphore handle to fill
+ * \return          `1` on success, `0` otherwise
+ * \sa              ESP_CFG_SEM_POOL_SIZE
+ */
+uint8_t
+espi_sem_get(esp_sys_sem_t* sem) {
+#if ESP_CFG_SEM_POOL_SIZE > 0
+    uint8_t found = 0;
+
+    esp_core_lock();
+    if (sem_pool_cnt > 0) {
+        *sem = sem_pool[--sem_pool_cnt];
+        found = 1;
+    }
+    esp_core_unlock();
+    if (found) {
+        return 1;
+    }
+#endif /* ESP_CFG_SEM_POOL_SIZE > 0 */
+    return esp_sys_sem_create(sem, 0);
+}
+
+/**
+ * \brief           Return semaphore after blocking command has finished
+ *
+ * Semaphore must be in locked state, which is the case
+ * once waiting thread has taken it after command completion.
+ * It is cached for next command or deleted when cache is full
+ *
+ * \param[in]       sem: Semaphore handle previously filled by \ref espi_sem_get.
+ *                      Handle is invalidated on return
+ */
+void
+espi_sem_put(esp_sys_sem_t* sem) {
+#if ESP_CFG_SEM_POOL_SIZE > 0
+    esp_core_lock();
+    if (sem_pool_cnt < ESP_ARRAYSIZE(sem_pool)) {
+        sem_pool[sem_pool_cnt++] = *sem;        /* Keep it for next command */
+        esp_sys_sem_invalid(sem);
+    }
+    esp_core_unlock();
+    if (!esp_sys_sem_isvalid(sem)) {
+        return;
+    }
+#endif /* ESP_CFG_SEM_POOL_SIZE > 0 */
+    esp_sys_sem_delete(sem);
+    esp_sys_sem_invalid(sem);
+}
+
+#endif /* ESP_CFG_OS || __DOXYGEN__ */
+
+#if ESP_CFG_MEM_STATIC || __DOXYGEN__
+
+/**
+ * \brief           Get entry from fixed-size memory pool
+ * \param[in]       pool: Pool defined with \ref ESP_MEM_POOL_DEFINE
+ * \return          Pointer to entry memory on success, `NULL` if pool is exhausted
+ */
+void *
+espi_mem_pool_alloc(esp_mem_pool_t* pool) {
+    void** e;
+
+    esp_core_lock();
+    if (!pool->init) {                          /* Build free list on first use */
+        for (size_t i = 0; i < pool->num; ++i) {
+            pool->mem[i * pool->units].ptr = i + 1 < pool->num ? &pool->mem[(i + 1) * pool->units] : NULL;
+        }
+        pool->free = pool->num > 0 ? &pool->mem[0] : NULL;
+        pool->init = 1;
+    }
+    e = pool->free;
+    if (e != NULL) {
+        pool->free = *e;                        /* Remove entry from free list */
+    }
+    esp_core_unlock();
+    return e;
+}
+
+/**
+ * \brief           Return entry to fixed-size memory pool
+ * \param[in]       pool: Pool entry was allocated from
+ * \param[in]       ptr: Entry returned by \ref espi_mem_pool_alloc
+ * \return          `1` if entry belongs to pool and was freed, `0` otherwise
+ */
+uint8_t
+espi_mem_pool_free(esp_mem_pool_t* pool, void* ptr) {
+    esp_mem_pool_unit_t* e = ptr;
+
+    if (e == NULL || e < &pool->mem[0] || e >= &pool->mem[pool->units * pool->num]) {
+        return 0;
+    }
+    esp_core_lock();
+    e->ptr = pool->free;                        /* Insert entry back to free list */
+    pool->free = e;
+    esp_core_unlock();
+    return 1;
+}
+
+#endif /* ESP_CFG_MEM_STATIC || __DOXYGEN__ */
@@ -0,0 +1,191 @@
+/**
+ * \file            esp_mqtt_at.c
+ * \brief           MQTT commands of ESP32 AT firmware
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_mqtt_at.h"
+#include "esp/esp_mem.h"
+
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+
+/**
+ * \brief           Configure client and connect to MQTT broker
+ * \note            Configuration and host must stay valid until command finishes
+ * \param[in]       info: Client information
+ * \param[in]       host: Broker host name or IP address
+ * \param[in]       port: Broker port
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_at_connect(const esp_mqtt_at_info_t* info, const char* host, esp_port_t port,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("info != NULL", info != NULL);
+    ESP_ASSERT("host != NULL", host != NULL);
+    ESP_ASSERT("port > 0", port > 0);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_MQTT_CONN;
+    ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_MQTT_USERCFG;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.info = info;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.host = host;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.port = port;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 20000);
+}
+
+/**
+ * \brief           Close MQTT connection
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_at_close(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_MQTT_CLEAN;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
+}
+
+/**
+ * \brief           Subscribe to MQTT topic
+ * \note            Topic must stay valid until command finishes
+ * \param[in]       topic: Topic name, wildcards are allowed
+ * \param[in]       qos: Quality of service
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_at_subscribe(const char* topic, uint8_t qos,
+                        const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("topic != NULL", topic != NULL);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_MQTT_SUB;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.topic = topic;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.qos = qos;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
+}
+
+/**
+ * \brief           Unsubscribe from MQTT topic
+ * \note            Topic must stay valid until command finishes
+ * \param[in]       topic: Topic name used on subscribe
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_at_unsubscribe(const char* topic,
+                        const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("topic != NULL", topic != NULL);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_MQTT_UNSUB;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.topic = topic;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
+}
+
+/**
+ * \brief           Publish message to MQTT topic
+ *
+ * Data are sent in binary form after device prompt, command finishes
+ * when device reports result of publish
+ *
+ * \note            Topic and data must stay valid until command finishes
+ * \param[in]       topic: Topic name
+ * \param[in]       data: Message data
+ * \param[in]       len: Length of message data in units of bytes
+ * \param[in]       qos: Quality of service
+ * \param[in]       retain: Set to `1` to retain message on broker
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_mqtt_at_publish(const char* topic, const void* data, size_t len, uint8_t qos, uint8_t retain,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("topic != NULL", topic != NULL);
+    ESP_ASSERT("data != NULL", data != NULL);
+    ESP_ASSERT("len > 0", len > 0);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_MQTT_PUBRAW;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.topic = topic;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.data = data;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.len = len;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.qos = qos;
+    ESP_MSG_VAR_REF(msg).msg.mqtt_at.retain = retain;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
+}
+
+/**
+ * \brief           Check if MQTT connection on device is connected to broker
+ * \return          `1` when connected, `0` otherwise
+ */
+uint8_t
+esp_mqtt_at_is_connected(void) {
+    uint8_t res;
+
+    esp_core_lock();
+    res = esp.m.mqtt_at_connected;
+    esp_core_unlock();
+    return res;
+}
+
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
@@ -36,17 +36,12 @@
 #include "esp/esp_mem.h"
 
 /**
- * \brief           Parse number from string
- * \note            Input string pointer is changed and number is skipped
- * \param[in,out]   str: Pointer to pointer to string to parse
- * \return          Parsed number
+ * \brief           Skip separator in front of response field
+ * \param[in]       p: Pointer to current position in response
+ * \return          Pointer to first character of field value
  */
-int32_t
-espi_parse_number(const char** str) {
-    int32_t val = 0;
-    uint8_t minus = 0;
-    const char* p = *str;                       /*  */
-
+static const char*
+parser_skip_field_start(const char* p) {
     if (*p == '"') {                            /* Skip leading quotes */
         ++p;
     }
@@ -56,12 +51,53 @@ espi_parse_number(const char** str) {
     if (*p == '"') {                            /* Skip leading quotes */
         ++p;
     }
+    return p;
+}
+
+/**
+ * \brief           Get value of decimal digit
+ * \param[in]       ch: Character to convert
+ * \return          Value between `0` and `9`, value greater than `9` when not a digit
+ */
+static uint8_t
+parser_dec_value(char ch) {
+    return (uint8_t)(ch - '0');                 /* Non-digits wrap above 9, single comparison */
+}
+
+/**
+ * \brief           Get value of hexadecimal digit
+ * \param[in]       ch: Character to convert
+ * \return          Value between `0` and `15`, value greater than `15` when not a digit
+ */
+static uint8_t
+parser_hex_value(char ch) {
+    uint8_t d = parser_dec_value(ch);
+
+    if (d > 9) {
+        d = (uint8_t)((ch | 0x20) - 'a');       /* Lower-case letter, compare once */
+        d = d < 6 ? (uint8_t)(d + 10) : 0xFF;
+    }
+    return d;
+}
+
+/**
+ * \brief           Parse number from string
+ * \note            Input string pointer is changed and number is skipped
+ * \param[in,out]   str: Pointer to pointer to string to parse
+ * \return          Parsed number
+ */
+int32_t
+espi_parse_number(const char** str) {
+    int32_t val = 0;
+    uint8_t minus = 0, d;
+    const char* p = parser_skip_field_start(*str);
+
     if (*p == '-') {                            /* Check negative number */
         minus = 1;
         ++p;
     }
-    while (ESP_CHARISNUM(*p)) {                 /* Parse until character is valid number */
-        val = val * 10 + ESP_CHARTONUM(*p);
+    while ((d = parser_dec_value(*p)) < 10) {   /* Parse until character is valid number */
+        val = val * 10 + d;
         ++p;
     }
     if (*p == ',') {                            /* Go to next entry if possible */
@@ -94,20 +130,12 @@ espi_parse_port(const char** str) {
  */
 uint32_t
 espi_parse_hexnumber(const char** str) {
-    int32_t val = 0;
-    const char* p = *str;                       /*  */
+    uint32_t val = 0;
+    uint8_t d;
+    const char* p = parser_skip_field_start(*str);
 
-    if (*p == '"') {                            /* Skip leading quotes */
-        ++p;
-    }
-    if (*p == ',') {                            /* Skip leading comma */
-        ++p;
-    }
-    if (*p == '"') {                            /* Skip leading quotes */
-        ++p;
-    }
-    while (ESP_CHARISHEXNUM(*p)) {              /* Parse until character is valid number */
-        val = val * 16 + ESP_CHARHEXTONUM(*p);
+    while ((d = parser_hex_value(*p)) < 16) {   /* Parse until character is valid number */
+        val = (val << 4) | d;
         ++p;
     }
     if (*p == ',') {                            /* Go to next entry if possible */
@@ -167,6 +195,10 @@ espi_parse_string(const char** src, char* dst, size_t dst_len, uint8_t trim) {
 
 /**
  * \brief           Parse string as IP address
+ *
+ * Address has fixed `a.b.c.d` format, octets are parsed directly
+ * without field separator checks of \ref espi_parse_number
+ *
  * \param[in,out]   src: Pointer to pointer to string to parse from
  * \param[out]      ip: Pointer to IP memory
  * \return          `1` on success, `0` otherwise
@@ -174,14 +206,27 @@ espi_parse_string(const char** src, char* dst, size_t dst_len, uint8_t trim) {
 uint8_t
 espi_parse_ip(const char** src, esp_ip_t* ip) {
     const char* p = *src;
+    uint8_t d;
 
     if (*p == '"') {
         ++p;
     }
-    ip->ip[0] = espi_parse_number(&p); ++p;
-    ip->ip[1] = espi_parse_number(&p); ++p;
-    ip->ip[2] = espi_parse_number(&p); ++p;
-    ip->ip[3] = espi_parse_number(&p);
+    p = parser_skip_field_start(p);
+    for (size_t i = 0; i < ESP_ARRAYSIZE(ip->ip); ++i) {
+        uint32_t val = 0;
+
+        while ((d = parser_dec_value(*p)) < 10) {
+            val = val * 10 + d;
+            ++p;
+        }
+        ip->ip[i] = ESP_U8(val);
+        if (i < ESP_ARRAYSIZE(ip->ip) - 1 && *p == '.') {
+            ++p;                                /* Skip dot between octets */
+        }
+    }
+    if (*p == ',') {                            /* Unquoted address, go to next entry */
+        ++p;
+    }
     if (*p == '"') {
         ++p;
     }
@@ -192,6 +237,10 @@ espi_parse_ip(const char** src, esp_ip_t* ip) {
 
 /**
  * \brief           Parse string as MAC address
+ *
+ * Address has fixed `aa:bb:cc:dd:ee:ff` format, bytes are parsed directly
+ * without field separator checks of \ref espi_parse_hexnumber
+ *
  * \param[in,out]   src: Pointer to pointer to string to parse from
  * \param[out]      mac: Pointer to MAC memory
  * \return          `1` on success, `0` otherwise
@@ -199,16 +248,27 @@ espi_parse_ip(const char** src, esp_ip_t* ip) {
 uint8_t
 espi_parse_mac(const char** src, esp_mac_t* mac) {
     const char* p = *src;
+    uint8_t d;
 
     if (*p == '"') {                            /* Go to next entry if possible */
         ++p;
     }
-    mac->mac[0] = espi_parse_hexnumber(&p); ++p;
-    mac->mac[1] = espi_parse_hexnumber(&p); ++p;
-    mac->mac[2] = espi_parse_hexnumber(&p); ++p;
-    mac->mac[3] = espi_parse_hexnumber(&p); ++p;
-    mac->mac[4] = espi_parse_hexnumber(&p); ++p;
-    mac->mac[5] = espi_parse_hexnumber(&p);
+    p = parser_skip_field_start(p);
+    for (size_t i = 0; i < ESP_ARRAYSIZE(mac->mac); ++i) {
+        uint32_t val = 0;
+
+        while ((d = parser_hex_value(*p)) < 16) {
+            val = (val << 4) | d;
+            ++p;
+        }
+        mac->mac[i] = ESP_U8(val);
+        if (i < ESP_ARRAYSIZE(mac->mac) - 1 && *p == ':') {
+            ++p;                                /* Skip colon between bytes */
+        }
+    }
+    if (*p == ',') {                            /* Unquoted address, go to next entry */
+        ++p;
+    }
     if (*p == '"') {                            /* Skip quotes if possible */
         ++p;
     }
@@ -226,17 +286,38 @@ espi_parse_mac(const char** src, esp_mac_t* mac) {
  */
 espr_t
 espi_parse_cipstatus(const char* str) {
-    uint8_t cn_num = 0;
+    esp_conn_t* c;
+    esp_ip_t ip;
+    esp_port_t remote_port, local_port;
+    uint8_t cn_num = 0, client;
 
     cn_num = espi_parse_number(&str);           /* Parse connection number */
-    esp.m.active_conns |= 1 << cn_num;          /* Set flag as active */
+    if (cn_num >= ESP_CFG_MAX_CONNS) {          /* Device supports more links than configured */
+        return espERR;
+    }
+    esp.m.active_conns |= ESP_CONN_BIT(cn_num); /* Set flag as active */
 
     espi_parse_string(&str, NULL, 0, 1);        /* Parse string and ignore result */
+    espi_parse_ip(&str, &ip);
+    remote_port = espi_parse_number(&str);
+    local_port = espi_parse_number(&str);
+    client = !espi_parse_number(&str);
 
-    espi_parse_ip(&str, &esp.m.conns[cn_num].remote_ip);
-    esp.m.conns[cn_num].remote_port = espi_parse_number(&str);
-    esp.m.conns[cn_num].local_port = espi_parse_number(&str);
-    esp.m.conns[cn_num].status.f.client = !espi_parse_number(&str);
+    /*
+     * Periodic status polls mostly report links exactly as they are known already.
+     * Write connection only when reported data differ, to keep readers
+     * on lockless path away from retry loops
+     */
+    c = &esp.m.conns[cn_num];
+    if (c->remote_port != remote_port || c->local_port != local_port
+        || memcmp(&c->remote_ip, &ip, sizeof(ip))) {
+        ESP_CORE_SEQ_WRITE_BEGIN();
+        c->remote_ip = ip;
+        c->remote_port = remote_port;
+        c->local_port = local_port;
+        ESP_CORE_SEQ_WRITE_END();
+    }
+    c->status.f.client = client;
 
     return espOK;
 }
@@ -310,7 +391,11 @@ espi_parse_ipd(const char* str) {
         str += 5;
     }
 
+#if ESP_CFG_SINGLE_CONN
+    conn = 0;                                   /* No link ID in single connection mode */
+#else /* ESP_CFG_SINGLE_CONN */
     conn = espi_parse_number(&str);             /* Parse number for connection number */
+#endif /* !ESP_CFG_SINGLE_CONN */
     len = espi_parse_number(&str);              /* Parse number for number of available_bytes/bytes_to_read */
 
     c = conn < ESP_CFG_MAX_CONNS ? &esp.m.conns[conn] : NULL;   /* Get connection handle */
@@ -352,8 +437,10 @@ espi_parse_ipd(const char* str) {
         espi_parse_ip(&str, &esp.m.ipd.ip);     /* Parse incoming packet IP */
         esp.m.ipd.port = espi_parse_port(&str); /* Get port on IPD data */
 
+        ESP_CORE_SEQ_WRITE_BEGIN();
         ESP_MEMCPY(&esp.m.conns[conn].remote_ip, &esp.m.ipd.ip, sizeof(esp.m.ipd.ip));
         ESP_MEMCPY(&esp.m.conns[conn].remote_port, &esp.m.ipd.port, sizeof(esp.m.ipd.port));
+        ESP_CORE_SEQ_WRITE_END();
     }
 
     /*
@@ -420,6 +507,7 @@ espi_parse_link_conn(const char* str) {
 }
 
 #if ESP_CFG_MODE_STATION || __DOXYGEN__
+#if ESP_CFG_STA_LIST_AP || __DOXYGEN__
 /**
  * \brief           Parse received message for list access points
  * \param[in]       str: Pointer to input string starting with +CWLAP
@@ -428,10 +516,29 @@ espi_parse_link_conn(const char* str) {
  */
 uint8_t
 espi_parse_cwlap(const char* str, esp_msg_t* msg) {
-    if (!CMD_IS_DEF(ESP_CMD_WIFI_CWLAP) ||      /* Do we have valid message here and enough memory to save everything? */
-        msg->msg.ap_list.aps == NULL || msg->msg.ap_list.apsi >= msg->msg.ap_list.apsl) {
+    esp_ap_t* ap;
+    uint8_t is_full;
+
+    if (!CMD_IS_DEF(ESP_CMD_WIFI_CWLAP)) {
         return 0;
     }
+    /* Do we have enough memory to save everything? */
+    is_full = !msg->msg.ap_list.stream && (msg->msg.ap_list.aps == NULL || msg->msg.ap_list.apsi >= msg->msg.ap_list.apsl);
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0
+    if (is_full && !esp.m.sta_aps_filling) {    /* Scan table still needs remaining entries */
+#else /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 */
+    if (is_full) {
+#endif /* !(ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0) */
+        return 0;
+    }
+    if (msg->msg.ap_list.stream && msg->msg.ap_list.stop_on_match && msg->msg.ap_list.apsi > 0) {
+        return 0;                               /* Match already reported, ignore rest of scan */
+    }
+    if (msg->msg.ap_list.stream || is_full || msg->msg.ap_list.filter_ssid != NULL) {
+        ap = &msg->msg.ap_list.ap;              /* Parse to temporary entry */
+    } else {
+        ap = &msg->msg.ap_list.aps[msg->msg.ap_list.apsi];
+    }
     if (*str == '+') {                          /* Does string contain '+' as first character */
         str += 7;                               /* Skip this part */
     }
@@ -440,21 +547,59 @@ espi_parse_cwlap(const char* str, esp_msg_t* msg) {
     }
     ++str;
 
-    msg->msg.ap_list.aps[msg->msg.ap_list.apsi].ecn = (esp_ecn_t)espi_parse_number(&str);
-    espi_parse_string(&str, msg->msg.ap_list.aps[msg->msg.ap_list.apsi].ssid, sizeof(msg->msg.ap_list.aps[msg->msg.ap_list.apsi].ssid), 1);
-    msg->msg.ap_list.aps[msg->msg.ap_list.apsi].rssi = espi_parse_number(&str);
-    espi_parse_mac(&str, &msg->msg.ap_list.aps[msg->msg.ap_list.apsi].mac);
-    msg->msg.ap_list.aps[msg->msg.ap_list.apsi].ch = espi_parse_number(&str);
+    if (msg->msg.ap_list.fields == 0) {         /* Default fields */
+        ap->ecn = (esp_ecn_t)espi_parse_number(&str);
+        espi_parse_string(&str, ap->ssid, sizeof(ap->ssid), 1);
+        ap->rssi = espi_parse_number(&str);
+        espi_parse_mac(&str, &ap->mac);
+        ap->ch = espi_parse_number(&str);
+    } else {                                    /* Only fields requested with CWLAPOPT are present */
+        uint8_t fields = msg->msg.ap_list.fields;
+
+        ESP_MEMSET(ap, 0x00, sizeof(*ap));
+        if (fields & ESP_STA_LIST_AP_FIELD_ECN) {
+            ap->ecn = (esp_ecn_t)espi_parse_number(&str);
+        }
+        if (fields & ESP_STA_LIST_AP_FIELD_SSID) {
+            espi_parse_string(&str, ap->ssid, sizeof(ap->ssid), 1);
+        }
+        if (fields & ESP_STA_LIST_AP_FIELD_RSSI) {
+            ap->rssi = espi_parse_number(&str);
+        }
+        if (fields & ESP_STA_LIST_AP_FIELD_MAC) {
+            espi_parse_mac(&str, &ap->mac);
+        }
+        if (fields & ESP_STA_LIST_AP_FIELD_CH) {
+            ap->ch = espi_parse_number(&str);
+        }
+    }
 
-    msg->msg.ap_list.aps[msg->msg.ap_list.apsi].bgn = 0;
+    ap->bgn = 0;
 
-    //msg->msg.ap_list.aps[msg->msg.ap_list.apsi].offset = espi_parse_number(&str);
-    //msg->msg.ap_list.aps[msg->msg.ap_list.apsi].cal = espi_parse_number(&str);
+    //ap->offset = espi_parse_number(&str);
+    //ap->cal = espi_parse_number(&str);
 
     //espi_parse_number(&str);                    /* Parse pwc */
     //espi_parse_number(&str);                    /* Parse gc */
-    //msg->msg.ap_list.aps[msg->msg.ap_list.apsi].bgn = espi_parse_number(&str);
-    //msg->msg.ap_list.aps[msg->msg.ap_list.apsi].wps = espi_parse_number(&str);
+    //ap->bgn = espi_parse_number(&str);
+    //ap->wps = espi_parse_number(&str);
+
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0
+    if (esp.m.sta_aps_filling) {
+        espi_sta_list_ap_cache_add(ap);
+    }
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 */
+    if (is_full
+        || (msg->msg.ap_list.filter_ssid != NULL && strcmp(ap->ssid, msg->msg.ap_list.filter_ssid))
+        || (msg->msg.ap_list.stream && ap->rssi < msg->msg.ap_list.min_rssi)) {
+        return 1;                               /* Filtered out on host side */
+    }
+    if (msg->msg.ap_list.stream) {
+        esp.evt.evt.sta_list_ap_entry.ap = ap;
+        espi_send_cb(ESP_EVT_STA_LIST_AP_ENTRY);/* Report access point immediately */
+    } else if (ap == &msg->msg.ap_list.ap) {
+        msg->msg.ap_list.aps[msg->msg.ap_list.apsi] = *ap;
+    }
 
     ++msg->msg.ap_list.apsi;                    /* Increase number of found elements */
     if (msg->msg.ap_list.apf != NULL) {         /* Set pointer if necessary */
@@ -463,6 +608,8 @@ espi_parse_cwlap(const char* str, esp_msg_t* msg) {
     return 1;
 }
 
+#endif /* ESP_CFG_STA_LIST_AP || __DOXYGEN__ */
+
 /**
  * \brief           Parse received message for current AP information
  * \param[in]       str: Pointer to input string starting with +CWJAP
@@ -471,7 +618,11 @@ espi_parse_cwlap(const char* str, esp_msg_t* msg) {
  */
 uint8_t
 espi_parse_cwjap(const char* str, esp_msg_t* msg) {
-    if (!CMD_IS_DEF(ESP_CMD_WIFI_CWJAP_GET)) {  /* Do we have valid message here and enough memory to save everything? */
+    if (!CMD_IS_DEF(ESP_CMD_WIFI_CWJAP_GET)     /* Do we have valid message here and enough memory to save everything? */
+#if ESP_CFG_TELEMETRY_INTERVAL > 0
+        && !CMD_IS_DEF(ESP_CMD_SYSRAM)          /* Telemetry sample reads RSSI */
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 */
+        ) {
         return 0;
     }
     if (*str == '+') {                          /* Does string contain '+' as first character */
@@ -494,16 +645,18 @@ espi_parse_cwjap(const char* str, esp_msg_t* msg) {
 #endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
 
 #if ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__
+#if ESP_CFG_AP_LIST_STA || __DOXYGEN__
 /**
  * \brief           Parse received message for list stations
- * \param[in]       str: Pointer to input string starting with +CWLAP
+ * \param[in]       str: Pointer to input string starting with +CWLIF
  * \param[in]       msg: Pointer to message
  * \return          `1` on success, `0` otherwise
  */
 uint8_t
 espi_parse_cwlif(const char* str, esp_msg_t* msg) {
-    if (!CMD_IS_DEF(ESP_CMD_WIFI_CWLIF)         /* Do we have valid message here and enough memory to save everything? */
-        || msg->msg.sta_list.stas == NULL || msg->msg.sta_list.stai >= msg->msg.sta_list.stal) {
+    esp_sta_t sta;
+
+    if (!CMD_IS_DEF(ESP_CMD_WIFI_CWLIF)) {
         return 0;
     }
 
@@ -511,9 +664,17 @@ espi_parse_cwlif(const char* str, esp_msg_t* msg) {
         str += 7;
     }
 
-    espi_parse_ip(&str, &msg->msg.sta_list.stas[msg->msg.sta_list.stai].ip);
-    espi_parse_mac(&str, &msg->msg.sta_list.stas[msg->msg.sta_list.stai].mac);
+    espi_parse_ip(&str, &sta.ip);
+    espi_parse_mac(&str, &sta.mac);
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0
+    espi_ap_sta_cache_set(&sta.mac, &sta.ip);   /* Table gets all stations, also when array below is full */
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 */
 
+    /* Do we have enough memory to save everything? */
+    if (msg->msg.sta_list.stas == NULL || msg->msg.sta_list.stai >= msg->msg.sta_list.stal) {
+        return 0;
+    }
+    ESP_MEMCPY(&msg->msg.sta_list.stas[msg->msg.sta_list.stai], &sta, sizeof(sta));
     ++msg->msg.sta_list.stai;                   /* Increase number of found elements */
     if (msg->msg.sta_list.staf != NULL) {       /* Set pointer if necessary */
         *msg->msg.sta_list.staf = msg->msg.sta_list.stai;
@@ -521,6 +682,8 @@ espi_parse_cwlif(const char* str, esp_msg_t* msg) {
     return 1;
 }
 
+#endif /* ESP_CFG_AP_LIST_STA || __DOXYGEN__ */
+
 /**
  * \brief           Parse MAC address and send to user layer
  * \param[in]       str: Input string excluding `+DIST_STA_IP:` part
@@ -532,6 +695,13 @@ espi_parse_ap_conn_disconn_sta(const char* str, uint8_t is_conn) {
     esp_mac_t mac;
 
     espi_parse_mac(&str, &mac);                 /* Parse MAC address */
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0
+    if (is_conn) {
+        espi_ap_sta_cache_set(&mac, NULL);      /* IP address follows with +DIST_STA_IP */
+    } else {
+        espi_ap_sta_cache_remove(&mac);
+    }
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 */
 
     esp.evt.evt.ap_conn_disconn_sta.mac = &mac;
     espi_send_cb(is_conn ? ESP_EVT_AP_CONNECTED_STA : ESP_EVT_AP_DISCONNECTED_STA); /* Send event function */
@@ -550,6 +720,9 @@ espi_parse_ap_ip_sta(const char* str) {
 
     espi_parse_mac(&str, &mac);                 /* Parse MAC address */
     espi_parse_ip(&str, &ip);                   /* Parse IP address */
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0
+    espi_ap_sta_cache_set(&mac, &ip);
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 */
 
     esp.evt.evt.ap_ip_sta.mac = &mac;
     esp.evt.evt.ap_ip_sta.ip = &ip;
@@ -609,12 +782,14 @@ espi_parse_cipdomain(const char* str, esp_msg_t* msg) {
 
 /**
  * \brief           Parse received message for SNTP time
- * \param[in]       str: Pointer to input string starting with +CWLAP
+ * \param[in]       str: Pointer to input string starting with +CIPSNTPTIME
  * \param[in]       msg: Pointer to message
  * \return          `1` on success, `0` otherwise
  */
 uint8_t
 espi_parse_cipsntptime(const char* str, esp_msg_t* msg) {
+    esp_datetime_t dt = {0};
+
     if (!CMD_IS_DEF(ESP_CMD_TCPIP_CIPSNTPTIME)) {
         return 0;
     }
@@ -624,61 +799,68 @@ espi_parse_cipsntptime(const char* str, esp_msg_t* msg) {
 
     /* Scan for day in a week */
     if (!strncmp(str, "Mon", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 1;
+        dt.day = 1;
     } else if (!strncmp(str, "Tue", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 2;
+        dt.day = 2;
     } else if (!strncmp(str, "Wed", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 3;
+        dt.day = 3;
     } else if (!strncmp(str, "Thu", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 4;
+        dt.day = 4;
     } else if (!strncmp(str, "Fri", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 5;
+        dt.day = 5;
     } else if (!strncmp(str, "Sat", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 6;
+        dt.day = 6;
     } else if (!strncmp(str, "Sun", 3)) {
-        msg->msg.tcpip_sntp_time.dt->day = 7;
+        dt.day = 7;
     }
     str += 4;
 
     /* Scan for month in a year */
     if (!strncmp(str, "Jan", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 1;
+        dt.month = 1;
     } else if (!strncmp(str, "Feb", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 2;
+        dt.month = 2;
     } else if (!strncmp(str, "Mar", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 3;
+        dt.month = 3;
     } else if (!strncmp(str, "Apr", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 4;
+        dt.month = 4;
     } else if (!strncmp(str, "May", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 5;
+        dt.month = 5;
     } else if (!strncmp(str, "Jun", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 6;
+        dt.month = 6;
     } else if (!strncmp(str, "Jul", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 7;
+        dt.month = 7;
     } else if (!strncmp(str, "Aug", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 8;
+        dt.month = 8;
     } else if (!strncmp(str, "Sep", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 9;
+        dt.month = 9;
     } else if (!strncmp(str, "Oct", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 10;
+        dt.month = 10;
     } else if (!strncmp(str, "Nov", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 11;
+        dt.month = 11;
     } else if (!strncmp(str, "Dec", 3)) {
-        msg->msg.tcpip_sntp_time.dt->month = 12;
+        dt.month = 12;
     }
     str += 4;
     if (*str == ' ') {                              /* Numbers < 10 could have one more space */
         ++str;
     }
-    msg->msg.tcpip_sntp_time.dt->date = espi_parse_number(&str);
+    dt.date = espi_parse_number(&str);
     ++str;
-    msg->msg.tcpip_sntp_time.dt->hours = espi_parse_number(&str);
+    dt.hours = espi_parse_number(&str);
     ++str;
-    msg->msg.tcpip_sntp_time.dt->minutes = espi_parse_number(&str);
+    dt.minutes = espi_parse_number(&str);
     ++str;
-    msg->msg.tcpip_sntp_time.dt->seconds = espi_parse_number(&str);
+    dt.seconds = espi_parse_number(&str);
     ++str;
-    msg->msg.tcpip_sntp_time.dt->year = espi_parse_number(&str);
+    dt.year = espi_parse_number(&str);
+
+    if (msg->msg.tcpip_sntp_time.dt != NULL) {
+        ESP_MEMCPY(msg->msg.tcpip_sntp_time.dt, &dt, sizeof(dt));
+    }
+#if ESP_CFG_SNTP_SYNC_INTERVAL > 0
+    espi_sntp_cache_put(&dt);
+#endif /* ESP_CFG_SNTP_SYNC_INTERVAL > 0 */
     return 1;
 }
 
@@ -695,12 +877,29 @@ espi_parse_cipsntptime(const char* str, esp_msg_t* msg) {
 uint8_t
 espi_parse_hostname(const char* str, esp_msg_t* msg) {
     size_t i;
+#if ESP_CFG_CONFIG_SNAPSHOT
+    if (CMD_IS_DEF(ESP_CMD_RESET) || CMD_IS_DEF(ESP_CMD_RESTORE)) {
+        if (*str == '+') {
+            str += 12;
+        }
+        /* Query from reset sequence only verifies recorded hostname */
+        for (i = 0; esp.snapshot.hostname[i] != '\0' && str[i] == esp.snapshot.hostname[i]; ++i) {}
+        esp.snapshot_hostname_ok = esp.snapshot.hostname[i] == '\0' && (str[i] == '\r' || str[i] == '\0');
+        return 1;
+    }
+#endif /* ESP_CFG_CONFIG_SNAPSHOT */
     if (!CMD_IS_DEF(ESP_CMD_WIFI_CWHOSTNAME_GET)) {
         return 0;
     }
     if (*str == '+') {                              /* Check input string */
         str += 12;
     }
+#if ESP_CFG_GETTER_CACHE
+    for (i = 0; i < (sizeof(esp.m.hostname) - 1) && str[i] && str[i] != '\r'; ++i) {
+        esp.m.hostname[i] = str[i];             /* Keep full hostname for later calls */
+    }
+    esp.m.hostname[i] = 0;
+#endif /* ESP_CFG_GETTER_CACHE */
     msg->msg.wifi_hostname.hostname_get[0] = 0;
     if (*str != '\r') {
         i = 0;
@@ -732,12 +931,13 @@ espi_parse_cwdhcp(const char* str) {
 
     val = espi_parse_number(&str);
 
-#if ESP_CFG_MODE_ACCESS_POINT
-    esp.m.ap.dhcp = (val & 0x01) == 0x01;
-#endif /* ESP_CFG_MODE_ACCESS_POINT */
+    /* Same bits as with `AT+CWDHCP` set command */
 #if ESP_CFG_MODE_STATION
-    esp.m.sta.dhcp = (val & 0x02) == 0x02;
+    esp.m.sta.dhcp = (val & 0x01) == 0x01;
 #endif /* ESP_CFG_MODE_STATION */
+#if ESP_CFG_MODE_ACCESS_POINT
+    esp.m.ap.dhcp = (val & 0x02) == 0x02;
+#endif /* ESP_CFG_MODE_ACCESS_POINT */
 
     return 1;
 }
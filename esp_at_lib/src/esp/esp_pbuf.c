@@ -39,6 +39,145 @@
 #define SIZEOF_PBUF_STRUCT          ESP_MEM_ALIGN(sizeof(esp_pbuf_t))
 #define SET_NEW_LEN(v, len)         do { if ((v) != NULL) { *(v) = (len); } } while (0)
 
+#if ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__
+static esp_pbuf_alloc_fn pbuf_payload_alloc_fn;  /*!< Payload allocation function for \ref esp_pbuf_new */
+static esp_pbuf_free_fn pbuf_payload_free_fn;   /*!< Payload release function for \ref esp_pbuf_new */
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__ */
+
+#if ESP_CFG_PBUF_POOL || __DOXYGEN__
+
+/**
+ * \brief           Number of \ref esp_pbuf_t sized units needed for pool entry with payload
+ */
+#define PBUF_POOL_UNITS(size)       ((SIZEOF_PBUF_STRUCT + (size) + sizeof(esp_pbuf_t) - 1) / sizeof(esp_pbuf_t))
+
+#if !__DOXYGEN__
+typedef struct {
+    esp_pbuf_t* mem;                            /*!< Pool memory start address */
+    size_t units;                               /*!< Entry size in \ref esp_pbuf_t units */
+    esp_pbuf_p free;                            /*!< First free entry, linked with `next` field */
+    esp_pbuf_pool_stats_t stats;                /*!< Pool statistics */
+} pbuf_pool_t;
+#endif /* !__DOXYGEN__ */
+
+/* Memory for pools, aligned to packet buffer structure */
+static esp_pbuf_t pbuf_pool_mem_0[ESP_CFG_PBUF_POOL_0_NUM * PBUF_POOL_UNITS(ESP_CFG_PBUF_POOL_0_SIZE) + 1];
+static esp_pbuf_t pbuf_pool_mem_1[ESP_CFG_PBUF_POOL_1_NUM * PBUF_POOL_UNITS(ESP_CFG_PBUF_POOL_1_SIZE) + 1];
+static esp_pbuf_t pbuf_pool_mem_2[ESP_CFG_PBUF_POOL_2_NUM * PBUF_POOL_UNITS(ESP_CFG_PBUF_POOL_2_SIZE) + 1];
+
+static pbuf_pool_t pbuf_pools[] = {
+    { pbuf_pool_mem_0, PBUF_POOL_UNITS(ESP_CFG_PBUF_POOL_0_SIZE), NULL, { ESP_CFG_PBUF_POOL_0_SIZE, ESP_CFG_PBUF_POOL_0_NUM, 0, 0, 0, 0 } },
+    { pbuf_pool_mem_1, PBUF_POOL_UNITS(ESP_CFG_PBUF_POOL_1_SIZE), NULL, { ESP_CFG_PBUF_POOL_1_SIZE, ESP_CFG_PBUF_POOL_1_NUM, 0, 0, 0, 0 } },
+    { pbuf_pool_mem_2, PBUF_POOL_UNITS(ESP_CFG_PBUF_POOL_2_SIZE), NULL, { ESP_CFG_PBUF_POOL_2_SIZE, ESP_CFG_PBUF_POOL_2_NUM, 0, 0, 0, 0 } },
+};
+static uint8_t pbuf_pools_init;                 /*!< Set to `1` when free lists are built */
+
+/**
+ * \brief           Build free lists of all pools
+ * \note            Core must be locked when calling this function
+ */
+static void
+pbuf_pool_init(void) {
+    pbuf_pool_t* pool;
+
+    for (size_t i = 0; i < ESP_ARRAYSIZE(pbuf_pools); ++i) {
+        pool = &pbuf_pools[i];
+        pool->free = NULL;
+        for (size_t j = pool->stats.num; j > 0; --j) {
+            esp_pbuf_p p = &pool->mem[(j - 1) * pool->units];
+            p->next = pool->free;
+            pool->free = p;
+        }
+    }
+    pbuf_pools_init = 1;
+}
+
+/**
+ * \brief           Get pool which owns packet buffer memory
+ * \param[in]       p: Packet buffer
+ * \return          Pointer to pool or `NULL` if packet buffer was allocated from heap
+ */
+static pbuf_pool_t *
+pbuf_pool_get(esp_pbuf_p p) {
+    pbuf_pool_t* pool;
+
+    for (size_t i = 0; i < ESP_ARRAYSIZE(pbuf_pools); ++i) {
+        pool = &pbuf_pools[i];
+        if (p >= pool->mem && p < &pool->mem[pool->stats.num * pool->units]) {
+            return pool;
+        }
+    }
+    return NULL;
+}
+
+#endif /* ESP_CFG_PBUF_POOL || __DOXYGEN__ */
+
+/**
+ * \brief           Allocate memory for packet buffer structure and its payload
+ * \param[in]       len: Length of payload memory
+ * \return          Pointer to memory on success, `NULL` otherwise
+ */
+static esp_pbuf_p
+pbuf_mem_alloc(size_t len) {
+#if ESP_CFG_PBUF_POOL
+    pbuf_pool_t* pool;
+    esp_pbuf_p p = NULL;
+
+    esp_core_lock();
+    if (!pbuf_pools_init) {
+        pbuf_pool_init();
+    }
+    for (size_t i = 0; i < ESP_ARRAYSIZE(pbuf_pools); ++i) {
+        pool = &pbuf_pools[i];
+        if (pool->stats.num == 0 || pool->stats.size < len) {
+            continue;
+        }
+        if (pool->free != NULL) {
+            p = pool->free;                     /* Take first free entry */
+            pool->free = p->next;
+            ++pool->stats.used;
+            ++pool->stats.alloc_cnt;
+            if (pool->stats.used > pool->stats.max_used) {
+                pool->stats.max_used = pool->stats.used;
+            }
+            break;
+        }
+        ++pool->stats.fail_cnt;                 /* Pool is large enough but empty */
+    }
+    esp_core_unlock();
+    if (p != NULL) {
+        ESP_MEMSET(p, 0x00, SIZEOF_PBUF_STRUCT);/* Heap memory is cleared too */
+        return p;
+    }
+#endif /* ESP_CFG_PBUF_POOL */
+#if ESP_CFG_MEM_STATIC
+    return NULL;                                /* No heap fallback in static mode */
+#else /* ESP_CFG_MEM_STATIC */
+    return esp_mem_malloc_tag(SIZEOF_PBUF_STRUCT + sizeof(uint8_t) * len, ESP_MEM_TAG_PBUF);
+#endif /* !ESP_CFG_MEM_STATIC */
+}
+
+/**
+ * \brief           Free memory previously allocated with \ref pbuf_mem_alloc
+ * \param[in]       p: Packet buffer to free
+ */
+static void
+pbuf_mem_free(esp_pbuf_p p) {
+#if ESP_CFG_PBUF_POOL
+    pbuf_pool_t* pool;
+
+    if ((pool = pbuf_pool_get(p)) != NULL) {
+        esp_core_lock();
+        p->next = pool->free;                   /* Put entry back to free list */
+        pool->free = p;
+        --pool->stats.used;
+        esp_core_unlock();
+        return;
+    }
+#endif /* ESP_CFG_PBUF_POOL */
+    esp_mem_free(p);
+}
+
 /**
  * \brief           Skip pbufs for desired offset
  * \param[in]       p: Source pbuf to skip
@@ -71,7 +210,25 @@ esp_pbuf_p
 esp_pbuf_new(size_t len) {
     esp_pbuf_p p;
 
-    p = esp_mem_malloc(SIZEOF_PBUF_STRUCT + sizeof(*p->payload) * len);
+#if ESP_CFG_PBUF_EXT_PAYLOAD
+    if (len > 0) {
+        esp_pbuf_alloc_fn alloc_fn;
+        esp_pbuf_free_fn free_fn;
+        void* mem = NULL;
+
+        esp_core_lock();
+        alloc_fn = pbuf_payload_alloc_fn;
+        free_fn = pbuf_payload_free_fn;
+        esp_core_unlock();
+        if (alloc_fn != NULL && (mem = alloc_fn(len)) != NULL) {
+            if ((p = esp_pbuf_new_ext(mem, len, free_fn)) == NULL && free_fn != NULL) {
+                free_fn(mem);
+            }
+            return p;
+        }
+    }
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD */
+    p = pbuf_mem_alloc(len);
     ESP_DEBUGW(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE, p == NULL,
         "[PBUF] Failed to allocate %d bytes\r\n", (int)len);
     ESP_DEBUGW(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE, p != NULL,
@@ -81,11 +238,147 @@ esp_pbuf_new(size_t len) {
         p->tot_len = len;                       /* Set total length of pbuf chain */
         p->len = len;                           /* Set payload length */
         p->payload = (void *)(((char *)p) + SIZEOF_PBUF_STRUCT);/* Set pointer to payload data */
+        p->parent = NULL;                       /* Payload is owned by pbuf */
+        p->ref = 1;                             /* Single reference is used on this pbuf */
+#if ESP_CFG_IPD_ZERO_COPY
+        p->payload_ref = 0;
+        p->payload_owned = NULL;
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+#if ESP_CFG_PBUF_EXT_PAYLOAD
+        p->payload_mem = NULL;                  /* Payload follows structure */
+        p->free_fn = NULL;
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD */
+    }
+    return p;
+}
+
+#if ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__
+
+/**
+ * \brief           Allocate packet buffer on top of payload memory provided by application
+ *
+ * Only packet buffer structure is allocated, payload is used by library directly.
+ * When last reference to packet buffer is released, `free_fn` is called with payload memory
+ *
+ * \param[in]       payload: Payload memory, must stay valid until `free_fn` is called
+ * \param[in]       len: Length of payload memory in units of bytes
+ * \param[in]       free_fn: Function to release payload memory.
+ *                      Set to `NULL` when memory is not released by library
+ * \return          Pointer to allocated packet buffer, `NULL` otherwise.
+ *                      Payload is not released on failure
+ */
+esp_pbuf_p
+esp_pbuf_new_ext(void* payload, size_t len, esp_pbuf_free_fn free_fn) {
+    esp_pbuf_p p;
+
+    if (payload == NULL && len > 0) {
+        return NULL;
+    }
+    p = pbuf_mem_alloc(0);
+    ESP_DEBUGW(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE, p == NULL,
+        "[PBUF] Failed to allocate pbuf for external payload of %d bytes\r\n", (int)len);
+    if (p != NULL) {
+        ESP_MEMSET(p, 0x00, SIZEOF_PBUF_STRUCT);
+        p->tot_len = len;                       /* Set total length of pbuf chain */
+        p->len = len;                           /* Set payload length */
+        p->payload = payload;                   /* Use application memory */
+        p->payload_mem = payload;
+        p->free_fn = free_fn;
         p->ref = 1;                             /* Single reference is used on this pbuf */
     }
     return p;
 }
 
+/**
+ * \brief           Set functions to allocate payload of new packet buffers apart from structure
+ *
+ * Every \ref esp_pbuf_new call, including packet buffers for received network data,
+ * allocates payload with `alloc_fn` first. When it returns `NULL`,
+ * payload is allocated together with structure as usual
+ *
+ * \note            Functions may be called from any thread, with core locked or not
+ * \param[in]       alloc_fn: Payload allocation function. Set to `NULL` to disable separate payload
+ * \param[in]       free_fn: Function to release memory returned by `alloc_fn`
+ */
+void
+esp_pbuf_set_payload_alloc_fn(esp_pbuf_alloc_fn alloc_fn, esp_pbuf_free_fn free_fn) {
+    esp_core_lock();
+    pbuf_payload_alloc_fn = alloc_fn;
+    pbuf_payload_free_fn = free_fn;
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__ */
+
+#if ESP_CFG_IPD_ZERO_COPY || __DOXYGEN__
+
+/**
+ * \brief           Allocate packet buffer which references existing payload memory
+ * \note            Payload memory is not copied and must stay valid
+ *                  until \ref espi_pbuf_release_payload is called
+ * \param[in]       data: Pointer to payload memory to reference
+ * \param[in]       len: Length of payload memory in units of bytes
+ * \return          Pointer to allocated packet buffer, `NULL` otherwise
+ */
+esp_pbuf_p
+espi_pbuf_new_ref(const void* data, size_t len) {
+    esp_pbuf_p p;
+
+    p = pbuf_mem_alloc(0);
+    ESP_DEBUGW(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE, p == NULL,
+        "[PBUF] Failed to allocate reference pbuf for %d bytes\r\n", (int)len);
+    if (p != NULL) {
+        ESP_MEMSET(p, 0x00, SIZEOF_PBUF_STRUCT);
+        p->tot_len = len;                       /* Set total length of pbuf chain */
+        p->len = len;                           /* Set payload length */
+        p->payload = (void *)data;              /* Reference input memory */
+        p->payload_ref = 1;                     /* Payload is not owned by pbuf */
+        p->ref = 1;                             /* Single reference is used on this pbuf */
+    }
+    return p;
+}
+
+/**
+ * \brief           Release referenced payload memory from packet buffer
+ *
+ * In case packet buffer is still referenced by someone else,
+ * payload is copied to newly allocated memory and packet buffer stays valid
+ *
+ * \note            Function must be called before referenced memory gets invalid
+ * \param[in]       pbuf: Packet buffer created with \ref espi_pbuf_new_ref
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+espi_pbuf_release_payload(esp_pbuf_p pbuf) {
+    uint8_t* mem;
+
+    ESP_ASSERT("pbuf != NULL", pbuf != NULL);
+
+    if (!pbuf->payload_ref) {                   /* Payload already owned? */
+        return espOK;
+    }
+    pbuf->payload_ref = 0;
+    if (pbuf->ref > 1) {                        /* Is pbuf used after release? */
+        mem = esp_mem_malloc_tag(sizeof(*mem) * pbuf->len, ESP_MEM_TAG_PBUF);
+        if (mem == NULL) {
+            ESP_DEBUGF(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_WARNING,
+                "[PBUF] Failed to allocate %d bytes for referenced payload, data is lost\r\n", (int)pbuf->len);
+            pbuf->tot_len -= pbuf->len;         /* Payload cannot be kept */
+            pbuf->len = 0;
+            pbuf->payload = NULL;
+            return espERRMEM;
+        }
+        ESP_MEMCPY(mem, pbuf->payload, pbuf->len);
+        pbuf->payload = mem;                    /* Payload is allocated separately from now */
+        pbuf->payload_owned = mem;              /* Keep start of memory, payload may be advanced later */
+    } else {
+        pbuf->payload = NULL;                   /* Payload is not used anymore */
+    }
+    return espOK;
+}
+
+#endif /* ESP_CFG_IPD_ZERO_COPY || __DOXYGEN__ */
+
 /**
  * \brief           Free previously allocated packet buffer
  * \param[in]       pbuf: Packet buffer to free
@@ -93,7 +386,7 @@ esp_pbuf_new(size_t len) {
  */
 size_t
 esp_pbuf_free(esp_pbuf_p pbuf) {
-    esp_pbuf_p p, pn;
+    esp_pbuf_p p, pn, parent;
     size_t ref, cnt;
 
     ESP_ASSERT("pbuf != NULL", pbuf != NULL);
@@ -111,7 +404,22 @@ esp_pbuf_free(esp_pbuf_p pbuf) {
             ESP_DEBUGF(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE,
                 "[PBUF] Deallocating %p with len/tot_len: %d/%d\r\n", p, (int)p->len, (int)p->tot_len);
             pn = p->next;                       /* Save next entry */
-            esp_mem_free_s((void **)&p);         /* Free memory for pbuf */
+            parent = p->parent;                 /* Save referenced chain of slice */
+#if ESP_CFG_PBUF_EXT_PAYLOAD
+            if (parent == NULL && p->payload_mem != NULL && p->free_fn != NULL) {
+                p->free_fn(p->payload_mem);     /* Release payload given to packet buffer */
+            }
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD */
+#if ESP_CFG_IPD_ZERO_COPY
+            /* Payload may be allocated separately after reference was released */
+            if (parent == NULL && p->payload_owned != NULL) {
+                esp_mem_free(p->payload_owned);
+            }
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+            pbuf_mem_free(p);                   /* Free memory for pbuf */
+            if (parent != NULL) {
+                esp_pbuf_free(parent);          /* Release slice reference to parent chain */
+            }
             p = pn;                             /* Restore with next entry */
             ++cnt;                              /* Increase number of freed pbufs */
         } else {
@@ -121,6 +429,43 @@ esp_pbuf_free(esp_pbuf_p pbuf) {
     return cnt;
 }
 
+#if ESP_CFG_PBUF_POOL || __DOXYGEN__
+
+/**
+ * \brief           Get statistics of packet buffer pool
+ * \param[in]       pool: Pool index, from `0` (smallest) to `2` (largest)
+ * \param[out]      stats: Pointer to output structure to fill
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_pbuf_pool_get_stats(size_t pool, esp_pbuf_pool_stats_t* stats) {
+    ESP_ASSERT("pool < 3", pool < ESP_ARRAYSIZE(pbuf_pools));
+    ESP_ASSERT("stats != NULL", stats != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(stats, &pbuf_pools[pool].stats, sizeof(*stats));
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Clear allocation counters of all packet buffer pools
+ *
+ * Maximal usage restarts from number of currently used entries
+ */
+void
+esp_pbuf_pool_reset_stats(void) {
+    esp_core_lock();
+    for (size_t i = 0; i < ESP_ARRAYSIZE(pbuf_pools); ++i) {
+        pbuf_pools[i].stats.max_used = pbuf_pools[i].stats.used;
+        pbuf_pools[i].stats.alloc_cnt = 0;
+        pbuf_pools[i].stats.fail_cnt = 0;
+    }
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_PBUF_POOL || __DOXYGEN__ */
+
 /**
  * \brief           Concatenate `2` packet buffers together to one big packet
  * \note            After `tail` pbuf has been added to `head` pbuf chain,
@@ -195,6 +540,144 @@ esp_pbuf_unchain(esp_pbuf_p head) {
     return r;
 }
 
+/**
+ * \brief           Create slice of pbuf chain without copying payload
+ *
+ * New pbuf headers point to payload memory of `pbuf` chain.
+ * Every pbuf with slice data is referenced by slice and stays valid until slice is freed,
+ * even if original owner frees it with \ref esp_pbuf_free before.
+ *
+ * \note            Payload must not be modified while slice is used
+ *                  as memory is shared with original chain
+ * \param[in]       pbuf: Pbuf chain to slice
+ * \param[in]       off: Offset of slice start in units of bytes
+ * \param[in]       len: Length of slice in units of bytes
+ * \return          New pbuf (chain) on success, `NULL` otherwise
+ */
+esp_pbuf_p
+esp_pbuf_slice(const esp_pbuf_p pbuf, size_t off, size_t len) {
+    esp_pbuf_p p, s, head = NULL, last = NULL;
+    size_t k, n, rem;
+
+    if (pbuf == NULL || len == 0 || pbuf->tot_len < (off + len)) {
+        return NULL;
+    }
+    p = pbuf_skip(pbuf, off, &k);               /* Find first pbuf with slice data */
+    for (rem = len; p != NULL && rem > 0; p = p->next, k = 0) {
+        if ((n = ESP_MIN(rem, p->len - k)) == 0) {
+            continue;
+        }
+#if ESP_CFG_IPD_ZERO_COPY
+        if (p->payload_ref) {                   /* Referenced payload becomes invalid later */
+            break;
+        }
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+        if ((s = pbuf_mem_alloc(0)) == NULL) {
+            break;
+        }
+        ESP_MEMSET(s, 0x00, SIZEOF_PBUF_STRUCT);
+        s->payload = &p->payload[k];            /* Share payload memory */
+        s->len = n;
+        s->ref = 1;
+        s->parent = p;                          /* Keep payload owner alive */
+        esp_core_lock();
+        ++p->ref;
+        esp_core_unlock();
+        ESP_MEMCPY(&s->ip, &p->ip, sizeof(s->ip));
+        s->port = p->port;
+        if (last != NULL) {
+            last->next = s;
+        } else {
+            head = s;
+        }
+        last = s;
+        rem -= n;
+    }
+    if (rem > 0) {                              /* Slice could not be created */
+        ESP_DEBUGF(ESP_CFG_DBG_PBUF | ESP_DBG_TYPE_TRACE,
+            "[PBUF] Failed to create slice of %d bytes\r\n", (int)len);
+        if (head != NULL) {
+            esp_pbuf_free(head);
+        }
+        return NULL;
+    }
+    for (s = head, rem = len; s != NULL; s = s->next) {
+        s->tot_len = rem;
+        rem -= s->len;
+    }
+    return head;
+}
+
+/**
+ * \brief           Merge small packet buffers in chain into fewer larger ones
+ *
+ * Consecutive pbufs, referenced only by their predecessor in chain (reference count is `1`),
+ * are copied to newly allocated pbuf of up to `max_len` bytes and original pbufs are freed.
+ * Pbufs referenced from elsewhere stay in chain as they are.
+ * When allocation fails, pbufs stay in chain uncompacted, chain remains valid at any time.
+ *
+ * \note            Returned pbuf replaces `pbuf` and must be used by caller from now on
+ * \param[in]       pbuf: Head of pbuf chain to compact
+ * \param[in]       max_len: Maximal payload length of merged pbuf.
+ *                      Set to `0` to merge everything into single pbuf if possible
+ * \return          New head of pbuf chain, `NULL` if `pbuf` is `NULL`
+ */
+esp_pbuf_p
+esp_pbuf_compact(esp_pbuf_p pbuf, size_t max_len) {
+    esp_pbuf_p p, q, qn, end, first, tail, head = NULL, last = NULL;
+    size_t len, tot_len;
+
+    if (pbuf == NULL || pbuf->next == NULL) {   /* Nothing to merge */
+        return pbuf;
+    }
+    if (max_len == 0) {
+        max_len = pbuf->tot_len;
+    }
+    tot_len = pbuf->tot_len;
+    for (p = pbuf; p != NULL; p = end) {
+        /* Find run of pbufs which may be merged together */
+        len = p->len;
+        end = p->next;
+        if (p->ref == 1) {
+            for (; end != NULL && end->ref == 1 && len + end->len <= max_len; end = end->next) {
+                len += end->len;
+            }
+        }
+        if (end != p->next && (first = esp_pbuf_new(len)) != NULL) {
+            ESP_MEMCPY(&first->ip, &p->ip, sizeof(first->ip));
+            first->port = p->port;
+            len = 0;
+            for (q = p; q != end; q = qn) {     /* Copy and free merged pbufs */
+                ESP_MEMCPY(&first->payload[len], q->payload, q->len);
+                len += q->len;
+                qn = q->next;
+                q->next = NULL;
+                esp_pbuf_free(q);
+            }
+            tail = first;
+        } else {                                /* Keep pbufs as they are */
+            first = p;
+            for (tail = p; tail->next != end; tail = tail->next) {}
+        }
+
+        /* Link merged or kept pbufs to new chain */
+        if (last != NULL) {
+            last->next = first;
+        } else {
+            head = first;
+        }
+        last = tail;
+        last->next = end;
+    }
+
+    /* Set total lengths of new chain */
+    for (p = head; p != NULL; p = p->next) {
+        p->tot_len = tot_len;
+        tot_len -= p->len;
+    }
+    return head;
+}
+
 /**
  * \brief           Increment reference count on pbuf
  * \param[in]       pbuf: pbuf to increase reference
@@ -322,6 +805,29 @@ esp_pbuf_get_at(const esp_pbuf_p pbuf, size_t pos, uint8_t* el) {
     return 0;                                   /* Invalid character */
 }
 
+/**
+ * \brief           Compare memory with pbuf chain contents at specific pbuf and offset
+ * \param[in]       p: Pbuf where comparison starts
+ * \param[in]       off: Offset in `p` payload
+ * \param[in]       d: Data to compare
+ * \param[in]       len: Length of data in units of bytes
+ * \return          `1` if chain has equal data, `0` otherwise
+ */
+static uint8_t
+pbuf_match(esp_pbuf_p p, size_t off, const uint8_t* d, size_t len) {
+    size_t n;
+
+    for (; p != NULL && len > 0; p = p->next, off = 0) {
+        n = ESP_MIN(len, p->len - off);
+        if (memcmp(&p->payload[off], d, n)) {
+            return 0;
+        }
+        d += n;
+        len -= n;
+    }
+    return len == 0;
+}
+
 /**
  * \brief           Find desired needle in a haystack
  * \param[in]       pbuf: Pbuf used as haystack
@@ -333,14 +839,31 @@ esp_pbuf_get_at(const esp_pbuf_p pbuf, size_t pos, uint8_t* el) {
  */
 size_t
 esp_pbuf_memfind(const esp_pbuf_p pbuf, const void* needle, size_t len, size_t off) {
-    if (pbuf != NULL && needle != NULL && pbuf->tot_len >= (len + off)) {   /* Check if valid entries */
+    const uint8_t* d = needle;
+    const uint8_t* s;
+    esp_pbuf_p p;
+    size_t pos, end, k;
+
+    if (pbuf != NULL && needle != NULL && len > 0 && pbuf->tot_len >= (len + off)) {   /* Check if valid entries */
+        end = pbuf->tot_len - len;              /* Last position where match may start */
+        p = pbuf_skip(pbuf, off, &k);
+        pos = off - k;                          /* Offset of current pbuf in chain */
+
         /*
-         * Try entire buffer element by element
-         * and in case we have a match, report it
+         * Find candidates for first needle byte segment by segment
+         * and compare remaining bytes, which may continue in next pbufs
          */
-        for (size_t i = off; i <= pbuf->tot_len - len; ++i) {
-            if (!esp_pbuf_memcmp(pbuf, needle, len, i)) {   /* Check if identical */
-                return i;                       /* We have a match! */
+        for (; p != NULL && pos <= end; pos += p->len, p = p->next, k = 0) {
+            while (k < p->len && pos + k <= end) {
+                s = memchr(&p->payload[k], d[0], ESP_MIN(p->len - k, end - (pos + k) + 1));
+                if (s == NULL) {
+                    break;
+                }
+                k = (size_t)(s - p->payload);
+                if (pbuf_match(p, k, d, len)) {
+                    return pos + k;             /* We have a match! */
+                }
+                ++k;
             }
         }
     }
@@ -373,7 +896,6 @@ esp_pbuf_strfind(const esp_pbuf_p pbuf, const char* str, size_t off) {
 size_t
 esp_pbuf_memcmp(const esp_pbuf_p pbuf, const void* data, size_t len, size_t offset) {
     esp_pbuf_p p;
-    uint8_t el;
     const uint8_t* d = data;
 
     if (pbuf == NULL || data == NULL || len == 0 || /* Input parameters check */
@@ -391,14 +913,10 @@ esp_pbuf_memcmp(const esp_pbuf_p pbuf, const void* data, size_t len, size_t offs
 
     /*
      * We have known starting pbuf.
-     * Now it is time to check byte by byte from pbuf and memory
-     *
-     * Use byte by byte read function to inspect bytes separatelly
+     * Now compare memory segment by segment
      */
-    for (size_t i = 0; i < len; ++i) {
-        if (!esp_pbuf_get_at(p, offset + i, &el) || el != d[i]) {   /* Get value from pbuf at specific offset */
-            return offset + 1;                  /* Return value from offset where it failed */
-        }
+    if (!pbuf_match(p, offset, d, len)) {
+        return offset + 1;                      /* Return non-zero value when not equal */
     }
     return 0;                                   /* Memory matches at this point */
 }
@@ -502,6 +1020,27 @@ esp_pbuf_set_ip(esp_pbuf_p pbuf, const esp_ip_t* ip, esp_port_t port) {
     }
 }
 
+/**
+ * \brief           Get IP address and port number of remote side for received data
+ * \param[in]       pbuf: Packet buffer
+ * \param[out]      ip: Output variable to save IP address to. Set to `NULL` if not used
+ * \param[out]      port: Output variable to save port number to. Set to `NULL` if not used
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_pbuf_get_ip(const esp_pbuf_p pbuf, esp_ip_t* ip, esp_port_t* port) {
+    if (pbuf == NULL) {
+        return 0;
+    }
+    if (ip != NULL) {
+        ESP_MEMCPY(ip, &pbuf->ip, sizeof(*ip));
+    }
+    if (port != NULL) {
+        *port = pbuf->port;
+    }
+    return 1;
+}
+
 /**
  * \brief           Advance pbuf payload pointer by number of len bytes.
  *                  It can only advance single pbuf in a chain
@@ -525,8 +1064,22 @@ esp_pbuf_advance(esp_pbuf_p pbuf, int len) {
             process = 1;
         }
     } else {
-        /* Is current payload + new len still higher than pbuf structure? */
-        if (((uint8_t *)pbuf + SIZEOF_PBUF_STRUCT) < (pbuf->payload + len)) {
+        uint8_t* start = (uint8_t *)pbuf + SIZEOF_PBUF_STRUCT;
+
+#if ESP_CFG_IPD_ZERO_COPY
+        if (pbuf->payload_ref) {
+            start = pbuf->payload;              /* Referenced memory before payload is not ours */
+        } else if (pbuf->payload_owned != NULL) {
+            start = pbuf->payload_owned;        /* Payload was copied to separate memory */
+        }
+#endif /* ESP_CFG_IPD_ZERO_COPY */
+#if ESP_CFG_PBUF_EXT_PAYLOAD
+        if (pbuf->payload_mem != NULL) {
+            start = pbuf->payload_mem;          /* Payload memory is apart from structure */
+        }
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD */
+        /* Is current payload + new len still higher than payload memory start? */
+        if (start < (pbuf->payload + len)) {
             process = 1;
         }
     }
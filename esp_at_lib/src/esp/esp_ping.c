@@ -62,4 +62,72 @@ esp_ping(const char* host, uint32_t* time,
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 30000);
 }
 
+/**
+ * \brief           Ping list of hosts multiple times and collect statistics
+ *
+ * Every ping is sent as separate low priority command, hosts are pinged in turns.
+ * Next ping is queued only when previous finishes, so commands queued by application
+ * meanwhile are never delayed by more than one ping.
+ * With \ref ESP_CFG_THREAD_PRODUCER_PRIO enabled, they are also executed before remaining pings.
+ *
+ * Statistics are updated as pings finish. Pings which could not be started count as lost
+ *
+ * \param[in,out]   stats: Array of `cnt` statistics. Application sets `host` member,
+ *                      other members are reset by this function.
+ *                      Array must stay valid until probe finishes
+ * \param[in]       cnt: Number of hosts
+ * \param[in]       count: Number of pings to every host
+ * \param[in]       evt_fn: Callback function called when probe has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ping_probe(esp_ping_stats_t* stats, size_t cnt, uint16_t count,
+                const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    size_t total = cnt * count, i = 0;
+    espr_t res;
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("stats != NULL", stats != NULL);
+    ESP_ASSERT("cnt > 0", cnt > 0);
+    ESP_ASSERT("count > 0", count > 0);
+
+    for (size_t h = 0; h < cnt; ++h) {
+        const char* host = stats[h].host;
+
+        ESP_ASSERT("stats[h].host != NULL", host != NULL);
+        ESP_MEMSET(&stats[h], 0x00, sizeof(stats[h]));
+        stats[h].host = host;
+    }
+
+    do {
+        ESP_MSG_VAR_ALLOC(msg, blocking);
+        ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_PING;
+        ESP_MSG_VAR_REF(msg).msg.tcpip_ping.host = stats[i % cnt].host;
+        ESP_MSG_VAR_REF(msg).msg.tcpip_ping.stats = stats;
+        ESP_MSG_VAR_REF(msg).msg.tcpip_ping.cnt = cnt;
+        ESP_MSG_VAR_REF(msg).msg.tcpip_ping.idx = i;
+
+        /*
+         * Blocking probe waits for every ping from calling thread,
+         * otherwise every finished ping queues next one
+         */
+        if (blocking) {
+            ESP_MSG_VAR_REF(msg).msg.tcpip_ping.total = i + 1;
+            if (i + 1 == total) {
+                ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+            }
+        } else {
+            ESP_MSG_VAR_REF(msg).msg.tcpip_ping.total = total;
+            ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+        }
+        res = espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 30000);
+        if (res == espTIMEOUT || res == espERR) {
+            res = espOK;                        /* Host did not reply, ping was counted as lost */
+        }
+    } while (blocking && res == espOK && ++i < total);
+    return res;
+}
+
 #endif /* ESP_CFG_PING || __DOXYGEN__ */
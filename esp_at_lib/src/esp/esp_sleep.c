@@ -0,0 +1,118 @@
+/**
+ * \file            esp_sleep.c
+ * \brief           Sleep API
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_sleep.h"
+#include "esp/esp_mem.h"
+
+#if ESP_CFG_SLEEP || __DOXYGEN__
+
+/**
+ * \brief           Set sleep mode of device
+ *
+ * In light-sleep mode, device does not receive AT commands until woken up.
+ * Configure wakeup GPIO with \ref esp_set_wakeup_gpio and set \ref esp_ll_t.wakeup_fn
+ * in low-level driver, then stack wakes up device before commands automatically.
+ *
+ * \note            Mode is not kept over device reset
+ * \param[in]       mode: Sleep mode
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_set_sleep_mode(esp_sleep_mode_t mode,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("mode <= ESP_SLEEP_MODE_LIGHT", mode <= ESP_SLEEP_MODE_LIGHT);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_SLEEP;
+    ESP_MSG_VAR_REF(msg).msg.sleep.mode = mode;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 1000);
+}
+
+/**
+ * \brief           Configure GPIO to wake up device from light-sleep
+ * \note            Command is supported by ESP8266 AT firmware
+ * \param[in]       enable: Set to `1` to enable wakeup from GPIO, `0` to disable it
+ * \param[in]       gpio: Trigger GPIO number on device
+ * \param[in]       level: Trigger level, `0` for low, `1` for high
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_set_wakeup_gpio(uint8_t enable, uint8_t gpio, uint8_t level,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WAKEUPGPIO;
+    ESP_MSG_VAR_REF(msg).msg.wakeup_gpio.enable = enable > 0;
+    ESP_MSG_VAR_REF(msg).msg.wakeup_gpio.gpio = gpio;
+    ESP_MSG_VAR_REF(msg).msg.wakeup_gpio.level = level > 0;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 1000);
+}
+
+/**
+ * \brief           Wake up device from light-sleep before command is started
+ * \note            Called from producer thread with core locked
+ * \param[in]       msg: Command about to be started
+ * \return          Time in units of milliseconds to wait before command is sent
+ */
+uint32_t
+espi_sleep_wakeup(esp_msg_t* msg) {
+    if (esp.m.sleep_mode != ESP_SLEEP_MODE_LIGHT || esp.ll.wakeup_fn == NULL
+        || msg->cmd_def == ESP_CMD_RESET) {     /* Reset wakes up device anyway */
+        return 0;
+    }
+#if ESP_CFG_SLEEP_IDLE_TIME > 0
+    if ((uint32_t)(esp_sys_now() - esp.sleep_active_time) < ESP_CFG_SLEEP_IDLE_TIME) {
+        return 0;                               /* Device did not go to sleep yet */
+    }
+#endif /* ESP_CFG_SLEEP_IDLE_TIME > 0 */
+    if (!esp.ll.wakeup_fn()) {
+        return 0;
+    }
+    return ESP_CFG_SLEEP_WAKE_TIME;
+}
+
+#endif /* ESP_CFG_SLEEP || __DOXYGEN__ */
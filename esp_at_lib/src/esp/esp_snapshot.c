@@ -0,0 +1,87 @@
+/**
+ * \file            esp_snapshot.c
+ * \brief           Configuration snapshot API
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "esp/esp_private.h"
+#include "esp/esp_snapshot.h"
+
+#if ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__
+
+/**
+ * \brief           Get settings recorded since last \ref esp_snapshot_set call
+ *
+ * Save snapshot to non-volatile memory after configuration changes
+ * and give it back with \ref esp_snapshot_set on next boot
+ *
+ * \param[out]      snap: Output variable to save snapshot to
+ * \return          \ref espOK when at least one setting is recorded, \ref espERR otherwise
+ */
+espr_t
+esp_snapshot_get(esp_snapshot_t* snap) {
+    espr_t res;
+
+    ESP_ASSERT("snap != NULL", snap != NULL);
+
+    esp_core_lock();
+    ESP_MEMCPY(snap, &esp.snapshot, sizeof(*snap));
+    res = esp.snapshot.flags ? espOK : espERR;
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Set configuration snapshot to verify after next reset or restore sequence
+ *
+ * Call it after \ref esp_init with \ref ESP_CFG_RESET_ON_INIT disabled and before \ref esp_reset,
+ * or from \ref ESP_EVT_INIT_FINISH event when reset runs on init
+ * and \ref ESP_CFG_INIT_FINISH_AFTER_RESET is disabled.
+ * Only settings that differ from device are applied again when sequence finishes
+ *
+ * \param[in]       snap: Snapshot saved with \ref esp_snapshot_get.
+ *                      Set to `NULL` to forget all recorded settings
+ */
+void
+esp_snapshot_set(const esp_snapshot_t* snap) {
+    esp_core_lock();
+    if (snap != NULL) {
+        ESP_MEMCPY(&esp.snapshot, snap, sizeof(esp.snapshot));
+        esp.snapshot.hostname[sizeof(esp.snapshot.hostname) - 1] = '\0';
+    } else {
+        ESP_MEMSET(&esp.snapshot, 0x00, sizeof(esp.snapshot));
+    }
+#if ESP_CFG_RESET_WARM_BOOT
+    esp.warm_boot.valid = 0;                    /* Mode may differ from the one set with last reset */
+#endif /* ESP_CFG_RESET_WARM_BOOT */
+    esp_core_unlock();
+}
+
+#endif /* ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__ */
@@ -34,9 +34,120 @@
 #include "esp/esp_private.h"
 #include "esp/esp_sntp.h"
 #include "esp/esp_mem.h"
+#include "esp/esp_timeout.h"
 
 #if ESP_CFG_SNTP || __DOXYGEN__
 
+#if ESP_CFG_SNTP_SYNC_INTERVAL > 0 || __DOXYGEN__
+
+static uint32_t sntp_cache_epoch;               /*!< Device time at last synchronization in seconds since `1970-01-01` */
+static uint32_t sntp_cache_time;                /*!< Local time of last synchronization in units of milliseconds */
+static uint8_t sntp_cache_valid;                /*!< Set to `1` when cache holds synchronized time */
+
+/**
+ * \brief           Get number of days since `1970-01-01` for date
+ * \param[in]       y: Year
+ * \param[in]       m: Month in a year, from `1` to `12`
+ * \param[in]       d: Day in a month, from `1` to `31`
+ * \return          Number of days
+ */
+static uint32_t
+sntp_days_from_date(uint32_t y, uint32_t m, uint32_t d) {
+    uint32_t era, yoe, doy;
+
+    y -= m <= 2;                                /* Year starts in March */
+    era = y / 400;
+    yoe = y - era * 400;
+    doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+/**
+ * \brief           Convert number of seconds since `1970-01-01` to date and time
+ * \param[in]       epoch: Number of seconds
+ * \param[out]      dt: Date and time output
+ */
+static void
+sntp_epoch_to_datetime(uint32_t epoch, esp_datetime_t* dt) {
+    uint32_t days = epoch / 86400, secs = epoch % 86400;
+    uint32_t z, era, doe, yoe, doy, mp;
+
+    dt->hours = secs / 3600;
+    dt->minutes = (secs / 60) % 60;
+    dt->seconds = secs % 60;
+    dt->day = (days + 3) % 7 + 1;               /* 1970-01-01 was Thursday */
+
+    z = days + 719468;
+    era = z / 146097;
+    doe = z - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    dt->date = doy - (153 * mp + 2) / 5 + 1;
+    dt->month = mp < 10 ? mp + 3 : mp - 9;
+    dt->year = yoe + era * 400 + (dt->month <= 2);
+}
+
+/**
+ * \brief           Periodic time synchronization
+ * \param[in]       arg: Timeout callback custom argument
+ */
+static void
+sntp_sync_cb(void* arg) {
+    if (esp.status.f.dev_present) {
+        esp_msg_t* msg = ESP_MSG_VAR_MALLOC();
+
+        if (msg != NULL) {
+            ESP_MEMSET(msg, 0x00, sizeof(*msg));
+            msg->cmd_def = ESP_CMD_TCPIP_CIPSNTPTIME;
+            espi_send_msg_to_producer_mbox(msg, espi_initiate_cmd, 10000);  /* Cache is updated by response parser */
+        }
+    }
+    esp_timeout_add(ESP_CFG_SNTP_SYNC_INTERVAL, sntp_sync_cb, arg);
+}
+
+/**
+ * \brief           Save time read from device to cache
+ *
+ * Time before year `2000` is not cached, device did not synchronize with server yet
+ *
+ * \note            Core must be locked before calling this function
+ * \param[in]       dt: Date and time reported by device
+ */
+void
+espi_sntp_cache_put(const esp_datetime_t* dt) {
+    if (dt->year < 2000 || dt->month < 1 || dt->month > 12) {
+        return;
+    }
+    sntp_cache_epoch = sntp_days_from_date(dt->year, dt->month, dt->date) * 86400
+                        + dt->hours * 3600 + dt->minutes * 60 + dt->seconds;
+    sntp_cache_time = esp_sys_now();
+    sntp_cache_valid = 1;
+
+    /* Next synchronization is counted from this one */
+    esp_timeout_remove(sntp_sync_cb);
+    esp_timeout_add(ESP_CFG_SNTP_SYNC_INTERVAL, sntp_sync_cb, NULL);
+}
+
+/**
+ * \brief           Get time from cache
+ * \note            Core must be locked before calling this function
+ * \param[out]      dt: Date and time output
+ * \return          `1` when cache is valid, `0` otherwise
+ */
+static uint8_t
+sntp_cache_get(esp_datetime_t* dt) {
+    uint32_t age = esp_sys_now() - sntp_cache_time;
+
+    if (!sntp_cache_valid || age >= 2 * ESP_CFG_SNTP_SYNC_INTERVAL) {
+        return 0;
+    }
+    sntp_epoch_to_datetime(sntp_cache_epoch + age / 1000, dt);
+    return 1;
+}
+
+#endif /* ESP_CFG_SNTP_SYNC_INTERVAL > 0 || __DOXYGEN__ */
+
 /**
  * \brief           Configure SNTP mode parameters
  * \param[in]       en: Status whether SNTP mode is enabled or disabled on ESP device
@@ -68,6 +179,10 @@ esp_sntp_configure(uint8_t en, int8_t tz, const char* h1, const char* h2, const
 
 /**
  * \brief           Get time from SNTP servers
+ *
+ * When \ref ESP_CFG_SNTP_SYNC_INTERVAL is enabled and time was synchronized recently,
+ * cached time is returned without AT command
+ *
  * \param[out]      dt: Pointer to \ref esp_datetime_t structure to fill with date and time values
  * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
  * \param[in]       evt_arg: Custom argument for event callback function
@@ -79,6 +194,20 @@ esp_sntp_gettime(esp_datetime_t* dt,
                     const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
     ESP_MSG_VAR_DEFINE(msg);
 
+    ESP_ASSERT("dt != NULL", dt != NULL);
+
+#if ESP_CFG_SNTP_SYNC_INTERVAL > 0
+    esp_core_lock();
+    if (sntp_cache_get(dt)) {                   /* Serve from cache without AT command */
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_SNTP_SYNC_INTERVAL > 0 */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_TCPIP_CIPSNTPTIME;
@@ -87,4 +216,30 @@ esp_sntp_gettime(esp_datetime_t* dt,
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 10000);
 }
 
+/**
+ * \brief           Get time since cached time was last synchronized with device
+ *
+ * Cached time has resolution of `1` second. Its error is bounded by age
+ * multiplied with accuracy of \ref esp_sys_now clock, plus `1` second
+ *
+ * \param[out]      age: Time since last synchronization in units of milliseconds
+ * \return          \ref espOK on success, \ref espERR when cache is not used or time was not synchronized yet
+ */
+espr_t
+esp_sntp_get_sync_age(uint32_t* age) {
+    espr_t res = espERR;
+
+    ESP_ASSERT("age != NULL", age != NULL);
+
+#if ESP_CFG_SNTP_SYNC_INTERVAL > 0
+    esp_core_lock();
+    if (sntp_cache_valid) {
+        *age = esp_sys_now() - sntp_cache_time;
+        res = espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_SNTP_SYNC_INTERVAL > 0 */
+    return res;
+}
+
 #endif /* ESP_CFG_SNTP || __DOXYGEN__ */
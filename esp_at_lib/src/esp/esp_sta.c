@@ -152,6 +152,27 @@ esp_sta_getip(esp_ip_t* ip, esp_ip_t* gw, esp_ip_t* nm,
                 const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
     ESP_MSG_VAR_DEFINE(msg);
 
+#if ESP_CFG_GETTER_CACHE
+    esp_core_lock();
+    if (esp.m.cache_valid & ESP_CACHE_STA_IP) {
+        if (ip != NULL) {
+            ESP_MEMCPY(ip, &esp.m.sta.ip, sizeof(*ip));
+        }
+        if (gw != NULL) {
+            ESP_MEMCPY(gw, &esp.m.sta.gw, sizeof(*gw));
+        }
+        if (nm != NULL) {
+            ESP_MEMCPY(nm, &esp.m.sta.nm, sizeof(*nm));
+        }
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_GETTER_CACHE */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CIPSTA_GET;
@@ -213,6 +234,21 @@ esp_sta_getmac(esp_mac_t* mac,
                 const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
     ESP_MSG_VAR_DEFINE(msg);
 
+#if ESP_CFG_GETTER_CACHE
+    esp_core_lock();
+    if (esp.m.cache_valid & ESP_CACHE_STA_MAC) {
+        if (mac != NULL) {
+            ESP_MEMCPY(mac, &esp.m.sta.mac, sizeof(*mac));
+        }
+        esp_core_unlock();
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+    esp_core_unlock();
+#endif /* ESP_CFG_GETTER_CACHE */
+
     ESP_MSG_VAR_ALLOC(msg, blocking);
     ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
     ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CIPSTAMAC_GET;
@@ -254,9 +290,9 @@ esp_sta_setmac(const esp_mac_t* mac,
 uint8_t
 esp_sta_has_ip(void) {
     uint8_t res;
-    esp_core_lock();
+    ESP_CORE_READ_LOCK();
     res = ESP_U8(esp.m.sta.has_ip);
-    esp_core_unlock();
+    ESP_CORE_READ_UNLOCK();
     return res;
 }
 
@@ -282,25 +318,27 @@ espr_t
 esp_sta_copy_ip(esp_ip_t* ip, esp_ip_t* gw, esp_ip_t* nm, uint8_t* is_dhcp) {
     espr_t res = espERR;
     if ((ip != NULL || gw != NULL || nm != NULL) && esp_sta_has_ip()) { /* Do we have a valid IP address? */
-        esp_core_lock();
-        if (ip != NULL) {
-            ESP_MEMCPY(ip, &esp.m.sta.ip, sizeof(esp.m.sta.ip));/* Copy IP address */
-        }
-        if (gw != NULL) {
-            ESP_MEMCPY(gw, &esp.m.sta.gw, sizeof(esp.m.sta.gw));/* Copy gateway address */
-        }
-        if (nm != NULL) {
-            ESP_MEMCPY(nm, &esp.m.sta.nm, sizeof(esp.m.sta.nm));/* Copy netmask address */
-        }
-        if (is_dhcp != NULL) {
-            *is_dhcp = esp.m.sta.dhcp;
-        }
+        ESP_CORE_SEQ_READ({
+            if (ip != NULL) {
+                ESP_MEMCPY(ip, &esp.m.sta.ip, sizeof(esp.m.sta.ip));/* Copy IP address */
+            }
+            if (gw != NULL) {
+                ESP_MEMCPY(gw, &esp.m.sta.gw, sizeof(esp.m.sta.gw));/* Copy gateway address */
+            }
+            if (nm != NULL) {
+                ESP_MEMCPY(nm, &esp.m.sta.nm, sizeof(esp.m.sta.nm));/* Copy netmask address */
+            }
+            if (is_dhcp != NULL) {
+                *is_dhcp = esp.m.sta.dhcp;
+            }
+        });
         res = espOK;
-        esp_core_unlock();
     }
     return res;
 }
 
+#if ESP_CFG_STA_LIST_AP || __DOXYGEN__
+
 /**
  * \brief           List for available access points ESP can connect to
  * \param[in]       ssid: Optional SSID name to search for. Set to `NULL` to disable filter
@@ -332,6 +370,216 @@ esp_sta_list_ap(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf,
     return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 30000);
 }
 
+/**
+ * \brief           List available access points with reduced set of reported fields
+ *
+ * Options are sent with `AT+CWLAPOPT` before scan and default options
+ * are restored after scan, so other scans are not affected.
+ * Fields not requested are set to `0` in result array
+ *
+ * \note            RSSI threshold requires AT firmware supporting third `AT+CWLAPOPT` parameter
+ * \param[in]       ssid: Optional SSID name to search for. Set to `NULL` to disable filter
+ * \param[in]       aps: Pointer to array of available access point parameters
+ * \param[in]       apsl: Length of aps array
+ * \param[out]      apf: Pointer to output variable to save number of access points found
+ * \param[in]       fields: Bit mask of fields to report, combination of \ref ESP_STA_LIST_AP_FIELD values
+ * \param[in]       sort: Set to `1` to sort list by RSSI, `0` otherwise
+ * \param[in]       min_rssi: Device does not report access points with weaker signal.
+ *                      Set to `-128` to disable filter
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_sta_list_ap_ex(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf, uint8_t fields, uint8_t sort, int16_t min_rssi,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_ASSERT("fields > 0", (fields & ESP_STA_LIST_AP_FIELD_ALL) > 0);
+
+    if (apf != NULL) {
+        *apf = 0;
+    }
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CWLAP;
+    ESP_MSG_VAR_REF(msg).cmd = ESP_CMD_WIFI_CWLAPOPT;   /* Set options first */
+    ESP_MSG_VAR_REF(msg).msg.ap_list.ssid = ssid;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.aps = aps;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.apsl = apsl;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.apf = apf;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.fields = fields & ESP_STA_LIST_AP_FIELD_ALL;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.sort = sort;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.opt_rssi = min_rssi;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 32000);
+}
+
+/**
+ * \brief           List available access points and report every one as soon as it is found
+ *
+ * Every access point matching filters is sent as \ref ESP_EVT_STA_LIST_AP_ENTRY event
+ * while scan is still in progress. Scan finishes with \ref ESP_EVT_STA_LIST_AP event,
+ * where length is number of reported access points and array pointer is `NULL`
+ *
+ * \note            Device always completes the scan, `stop_on_match` only stops reporting
+ * \param[in]       ssid: Optional SSID name access point must match, compared on host side. Set to `NULL` to disable filter
+ * \param[in]       min_rssi: Minimal RSSI of reported access points. Set to `-128` to disable filter
+ * \param[in]       stop_on_match: Set to `1` to ignore remaining access points after first match
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_sta_list_ap_stream(const char* ssid, int16_t min_rssi, uint8_t stop_on_match,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CWLAP;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.stream = 1;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.filter_ssid = ssid;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.min_rssi = min_rssi;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.stop_on_match = stop_on_match;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 30000);
+}
+
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__
+
+/**
+ * \brief           Add access point found by scan to local table
+ *
+ * When table is full, it does not hold complete scan result
+ * and \ref esp_sta_list_ap_cached starts new scan until table is filled again
+ *
+ * \note            Core must be locked before calling this function
+ * \param[in]       ap: Access point just parsed from response
+ */
+void
+espi_sta_list_ap_cache_add(const esp_ap_t* ap) {
+    if (esp.m.sta_aps_cnt >= ESP_ARRAYSIZE(esp.m.sta_aps)) {
+        esp.m.sta_aps_overflow = 1;
+        return;
+    }
+    ESP_MEMCPY(&esp.m.sta_aps[esp.m.sta_aps_cnt++], ap, sizeof(*ap));
+}
+
+/**
+ * \brief           Copy access points from local table if result is recent enough
+ * \note            Core must be locked before calling this function
+ * \param[in]       ssid: Optional SSID name access point must match. Set to `NULL` to disable filter
+ * \param[in]       aps: Pointer to array of available access point parameters
+ * \param[in]       apsl: Length of aps array
+ * \param[out]      apf: Pointer to output variable to save number of access points found
+ * \param[in]       max_age: Result must be younger than this value, in units of milliseconds
+ * \return          `1` if copied from table, `0` if new scan is required
+ */
+static uint8_t
+sta_list_ap_cache_get(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf, uint32_t max_age) {
+    size_t cnt = 0;
+
+    if (!esp.m.sta_aps_valid || (uint32_t)(esp_sys_now() - esp.m.sta_aps_time) >= max_age) {
+        return 0;
+    }
+    for (size_t i = 0; i < esp.m.sta_aps_cnt && cnt < apsl; ++i) {
+        if (ssid == NULL || !strcmp(esp.m.sta_aps[i].ssid, ssid)) {
+            ESP_MEMCPY(&aps[cnt++], &esp.m.sta_aps[i], sizeof(*aps));
+        }
+    }
+    if (apf != NULL) {
+        *apf = cnt;
+    }
+
+    esp.evt.evt.sta_list_ap.res = espOK;
+    esp.evt.evt.sta_list_ap.aps = aps;
+    esp.evt.evt.sta_list_ap.len = cnt;
+    espi_send_cb(ESP_EVT_STA_LIST_AP);
+    return 1;
+}
+
+/**
+ * \brief           Answer scan request from local table when it was refreshed while request was queued
+ *
+ * Requests of \ref esp_sta_list_ap_cached queued behind running scan
+ * are finished with its result instead of starting another scan
+ *
+ * \note            Called from producing thread with core locked
+ * \param[in]       msg: Message taken from queue
+ */
+void
+espi_sta_list_ap_cache_dequeued(esp_msg_t* msg) {
+    if (msg->cmd_def == ESP_CMD_WIFI_CWLAP && msg->msg.ap_list.cached
+        && sta_list_ap_cache_get(msg->msg.ap_list.filter_ssid, msg->msg.ap_list.aps,
+                                msg->msg.ap_list.apsl, msg->msg.ap_list.apf, msg->msg.ap_list.max_age)) {
+        msg->fn = NULL;                         /* Finished, AT command is not sent */
+    }
+}
+
+/**
+ * \brief           List available access points, reuse result of recent scan when possible
+ *
+ * Result of last scan with default fields and without SSID filter on device side is kept
+ * in table of \ref ESP_CFG_STA_LIST_AP_CACHE_SIZE entries. When it is not older than `max_age`,
+ * access points are copied from table without AT command. Otherwise complete scan is started
+ * and table is refreshed. Requests waiting in queue behind that scan get its result
+ * when their turn comes, so several callers share single scan.
+ *
+ * \param[in]       ssid: Optional SSID name access point must match, compared on host side. Set to `NULL` to disable filter
+ * \param[in]       aps: Pointer to array of available access point parameters
+ * \param[in]       apsl: Length of aps array
+ * \param[out]      apf: Pointer to output variable to save number of access points found
+ * \param[in]       max_age: Maximal accepted age of last scan result in units of milliseconds.
+ *                      Set to `0` to always scan
+ * \param[in]       evt_fn: Callback function called when command has finished. Set to `NULL` when not used
+ * \param[in]       evt_arg: Custom argument for event callback function
+ * \param[in]       blocking: Status whether command should be blocking or not
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_sta_list_ap_cached(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf, uint32_t max_age,
+                    const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking) {
+    ESP_MSG_VAR_DEFINE(msg);
+    uint8_t found;
+
+    ESP_ASSERT("aps != NULL", aps != NULL);
+    ESP_ASSERT("apsl > 0", apsl > 0);
+
+    if (apf != NULL) {
+        *apf = 0;
+    }
+
+    esp_core_lock();
+    found = sta_list_ap_cache_get(ssid, aps, apsl, apf, max_age);
+    esp_core_unlock();
+    if (found) {                                /* Listed from table without AT command */
+        if (evt_fn != NULL) {
+            evt_fn(espOK, evt_arg);
+        }
+        return espOK;
+    }
+
+    ESP_MSG_VAR_ALLOC(msg, blocking);
+    ESP_MSG_VAR_SET_EVT(msg, evt_fn, evt_arg);
+    ESP_MSG_VAR_REF(msg).cmd_def = ESP_CMD_WIFI_CWLAP;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.filter_ssid = ssid;    /* Scan everything to refresh table */
+    ESP_MSG_VAR_REF(msg).msg.ap_list.aps = aps;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.apsl = apsl;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.apf = apf;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.cached = 1;
+    ESP_MSG_VAR_REF(msg).msg.ap_list.max_age = max_age;
+
+    return espi_send_msg_to_producer_mbox(&ESP_MSG_VAR_REF(msg), espi_initiate_cmd, 30000);
+}
+
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__ */
+
+#endif /* ESP_CFG_STA_LIST_AP || __DOXYGEN__ */
+
 /**
  * \brief           Check if access point is `802.11b` compatible
  * \param[in]       ap: Access point detailes acquired by \ref esp_sta_list_ap
@@ -40,6 +40,286 @@
 #include "esp/esp_mem.h"
 #include "system/esp_sys.h"
 
+#if ESP_CFG_THREAD_STATS
+#define THREAD_STATS_WAIT(thread, wait)     espi_thread_stats_wait((thread), (wait))
+#else /* ESP_CFG_THREAD_STATS */
+#define THREAD_STATS_WAIT(thread, wait)
+#endif /* !ESP_CFG_THREAD_STATS */
+
+#if ESP_CFG_CMD_STATS || __DOXYGEN__
+
+/**
+ * \brief           Add command execution to statistics
+ * \param[in]       stats: Statistics of command type
+ * \param[in]       latency: Time from command start until finish in units of milliseconds
+ * \param[in]       timeout: Set to `1` when command did not finish in time
+ */
+static void
+cmd_stats_add(esp_cmd_stats_t* stats, uint32_t latency, uint8_t timeout) {
+    size_t bucket = 0;
+
+    ++stats->count;
+    if (timeout) {
+        ++stats->timeouts;
+        return;
+    }
+    while (latency > 0 && bucket < ESP_ARRAYSIZE(stats->hist) - 1) {
+        latency >>= 1;
+        ++bucket;
+    }
+    ++stats->hist[bucket];
+}
+
+#endif /* ESP_CFG_CMD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_ADAPTIVE_TIMEOUT || __DOXYGEN__
+
+/**
+ * \brief           Add command latency to learned timeout histogram
+ *
+ * Histogram is halved when counter is about to overflow,
+ * older samples therefore slowly lose their weight
+ *
+ * \param[in]       t: Learned latency of command type
+ * \param[in]       latency: Time from command start until finish or timeout in units of milliseconds
+ */
+static void
+cmd_timeout_add(esp_cmd_timeout_t* t, uint32_t latency) {
+    size_t bucket = 0;
+
+    if (t->count == 0xFFFF) {
+        t->count = 0;
+        for (size_t i = 0; i < ESP_ARRAYSIZE(t->hist); ++i) {
+            t->hist[i] >>= 1;
+            t->count += t->hist[i];
+        }
+    }
+    while (latency > 0 && bucket < ESP_ARRAYSIZE(t->hist) - 1) {
+        latency >>= 1;
+        ++bucket;
+    }
+    ++t->hist[bucket];
+    ++t->count;
+}
+
+/**
+ * \brief           Get timeout for command from its observed latency
+ * \param[in]       msg: Command about to be started
+ * \return          Timeout in units of milliseconds, never longer than requested by application
+ */
+static uint32_t
+cmd_timeout_get(esp_msg_t* msg) {
+    esp_cmd_timeout_t* t;
+    uint32_t sum = 0, limit, timeout;
+    size_t bucket;
+
+    if (msg->block_time == 0 || msg->cmd_def >= ESP_CMD_END) {
+        return msg->block_time;
+    }
+    t = &esp.cmd_timeout[msg->cmd_def];
+    if (t->count < ESP_CFG_CMD_ADAPTIVE_TIMEOUT_SAMPLES) {
+        return msg->block_time;
+    }
+
+    /* Find first bucket where at least 99% of samples are covered */
+    limit = ((uint32_t)t->count * 99 + 99) / 100;
+    for (bucket = 0; bucket < ESP_ARRAYSIZE(t->hist) - 1; ++bucket) {
+        sum += t->hist[bucket];
+        if (sum >= limit) {
+            break;
+        }
+    }
+    if (bucket == ESP_ARRAYSIZE(t->hist) - 1) {
+        return msg->block_time;                 /* Longest bucket has no upper bound */
+    }
+    timeout = ESP_U32(1) << bucket;             /* Upper bound of bucket */
+    timeout *= ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR;
+    timeout = ESP_MAX(timeout, ESP_U32(ESP_CFG_CMD_ADAPTIVE_TIMEOUT_MIN));
+    return ESP_MIN(timeout, msg->block_time);
+}
+
+#endif /* ESP_CFG_CMD_ADAPTIVE_TIMEOUT || __DOXYGEN__ */
+
+#if ESP_CFG_EVT_DEFERRED || __DOXYGEN__
+
+/**
+ * \brief           Thread to deliver deferred events to user callback functions
+ *
+ * Core is released after every event, so processing thread
+ * can continue with input data between callbacks
+ *
+ * \param[in]       arg: User argument. Semaphore to release when thread starts
+ * \sa              ESP_CFG_EVT_DEFERRED
+ */
+void
+esp_thread_evt(void* const arg) {
+    esp_sys_sem_t* sem = arg;
+    uint8_t delivered;
+
+    /* Thread is running, unlock semaphore */
+    if (esp_sys_sem_isvalid(sem)) {
+        esp_sys_sem_release(sem);               /* Release semaphore */
+    }
+
+    while (1) {
+        esp_sys_sem_wait(&esp.evt_sem, 0);      /* Wait for new events */
+        do {
+            esp_core_lock();
+            delivered = espi_evt_deferred_process();
+            esp_core_unlock();
+        } while (delivered);
+    }
+}
+
+#endif /* ESP_CFG_EVT_DEFERRED || __DOXYGEN__ */
+
+/**
+ * \brief           Take message for execution
+ * \param[in]       msg: Message received from producer queue
+ * \return          \ref espOK when command can be started, member of \ref espr_t enumeration otherwise
+ */
+static espr_t
+produce_start(esp_msg_t* msg) {
+    espr_t res = espOK;                         /* Start with OK */
+
+#if ESP_CFG_CMD_COALESCE
+    espi_cmd_coalesce_dequeued(msg);            /* Allow new status command to be queued */
+#endif /* ESP_CFG_CMD_COALESCE */
+#if ESP_CFG_CMD_BATCH
+    if (msg->fn == NULL && msg->res != espOK) { /* Skipped after previous command in batch failed */
+        res = msg->res;
+    }
+#endif /* ESP_CFG_CMD_BATCH */
+#if ESP_CFG_CMD_CANCEL
+    espi_cmd_cancel_dequeued(msg);
+    if (msg->cancelled) {                       /* Cancelled while waiting in queue */
+        res = espABORTED;
+    }
+#endif /* ESP_CFG_CMD_CANCEL */
+    esp.msg = msg;                              /* Set message handle */
+#if ESP_CFG_LATENCY_TRACE
+    espi_trace_add(ESP_TRACE_MSG_QUEUE, esp_sys_now() - msg->trace_time);
+#endif /* ESP_CFG_LATENCY_TRACE */
+#if ESP_CFG_CMD_ADAPTIVE_TIMEOUT
+    msg->block_time = cmd_timeout_get(msg);     /* Do not wait longer than command usually needs */
+#endif /* ESP_CFG_CMD_ADAPTIVE_TIMEOUT */
+
+    /*
+     * This check is performed when adding command to queue
+     * Do it again here to prevent long timeouts,
+     * if device present flag changes
+     */
+    if (!esp.status.f.dev_present) {
+        res = espERRNODEVICE;
+    }
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0
+    if (res == espOK) {
+        espi_sta_list_ap_cache_dequeued(msg);   /* Scan finished while request was waiting in queue */
+    }
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 */
+#if ESP_CFG_UPDATE_ASYNC
+    if (res == espOK && !espi_update_cmd_allowed(msg)) {
+        res = espINPROG;                        /* Device is busy with background update */
+    }
+#endif /* ESP_CFG_UPDATE_ASYNC */
+    return res;
+}
+
+/**
+ * \brief           Finish message execution and notify application
+ * \param[in]       msg: Message being executed
+ * \param[in]       res: Result of command execution
+ * \param[in]       started: Set to `1` when processing function was called
+ * \param[in]       start: Time when processing function was called, used for statistics
+ * \return          Next message in command batch to execute, `NULL` if none
+ */
+static esp_msg_t*
+produce_finish(esp_msg_t* msg, espr_t res, uint8_t started, uint32_t start) {
+    esp_msg_t* next = NULL;
+
+    if (started) {
+#if ESP_CFG_CMD_STATS
+        if ((res == espOK || res == espTIMEOUT) && msg->cmd_def < ESP_CMD_END) {
+            cmd_stats_add(&esp.cmd_stats[msg->cmd_def], esp_sys_now() - start, res == espTIMEOUT);
+        }
+#endif /* ESP_CFG_CMD_STATS */
+#if ESP_CFG_CMD_ADAPTIVE_TIMEOUT
+        if ((res == espOK || res == espTIMEOUT) && msg->cmd_def < ESP_CMD_END) {
+            cmd_timeout_add(&esp.cmd_timeout[msg->cmd_def], esp_sys_now() - start);
+        }
+#endif /* ESP_CFG_CMD_ADAPTIVE_TIMEOUT */
+#if ESP_CFG_LATENCY_TRACE
+        if (res == espOK && msg->cmd_def == ESP_CMD_TCPIP_CIPSEND) {
+            espi_trace_add(ESP_TRACE_TX_SEND, esp_sys_now() - msg->trace_time);
+        }
+#endif /* ESP_CFG_LATENCY_TRACE */
+        ESP_UNUSED(start);
+#if ESP_CFG_SLEEP
+        esp.sleep_active_time = esp_sys_now();  /* Device communicated until now */
+#endif /* ESP_CFG_SLEEP */
+
+        /* Notify application on command timeout */
+        if (res == espTIMEOUT) {
+            espi_send_cb(ESP_EVT_CMD_TIMEOUT);
+        }
+
+        ESP_DEBUGW(ESP_CFG_DBG_THREAD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_SEVERE,
+            res == espTIMEOUT,
+            "[THREAD] Timeout in produce thread waiting for command to finish in process thread\r\n");
+        ESP_DEBUGW(ESP_CFG_DBG_THREAD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_SEVERE,
+            res != espOK && res != espTIMEOUT,
+            "[THREAD] Could not start execution for command %d\r\n", (int)msg->cmd);
+    } else if (res == espOK && msg->fn != NULL) {
+        /* Message without processing function was already finished without AT command */
+        res = espERR;                           /* Simply set error message */
+    }
+    if (res != espOK) {
+        /* Process global callbacks */
+        espi_process_events_for_timeout_or_error(msg, res);
+
+        msg->res = res;                         /* Save response */
+    }
+
+#if ESP_CFG_USE_API_FUNC_EVT
+    /* Send event function to user */
+    if (msg->evt_fn != NULL) {
+        msg->evt_fn(msg->res, msg->evt_arg);    /* Send event with user argument */
+    }
+#endif /* ESP_CFG_USE_API_FUNC_EVT */
+
+#if ESP_CFG_CMD_BATCH
+    /*
+     * Get next command in batch before message is released.
+     * On failure, mark remaining commands to be skipped with the same result
+     */
+    next = msg->next;
+    if (msg->res != espOK) {
+        for (esp_msg_t* m = next; m != NULL; m = m->next) {
+            m->fn = NULL;
+            m->res = msg->res;
+        }
+    }
+#endif /* ESP_CFG_CMD_BATCH */
+
+    /*
+     * In case message is blocking,
+     * release semaphore and notify finished with processing
+     * otherwise directly free memory of message structure
+     */
+#if ESP_CFG_OS
+    if (msg->is_blocking) {
+        esp_sys_sem_release(&msg->sem);
+    } else
+#endif /* ESP_CFG_OS */
+    {
+        ESP_MSG_VAR_FREE(msg);
+    }
+    esp.msg = NULL;
+    return next;
+}
+
+#if ESP_CFG_OS || __DOXYGEN__
+
 /**
  * \brief           User thread to process input packets from API functions
  * \param[in]       arg: User argument. Semaphore to release when thread starts
@@ -47,10 +327,11 @@
 void
 esp_thread_produce(void* const arg) {
     esp_sys_sem_t* sem = arg;
-    esp_t* e = &esp;
     esp_msg_t* msg;
+    esp_msg_t* batch_next = NULL;
     espr_t res;
-    uint32_t time;
+    uint32_t time, start = 0;
+    uint8_t started;
 
     /* Thread is running, unlock semaphore */
     if (esp_sys_sem_isvalid(sem)) {
@@ -58,30 +339,40 @@ esp_thread_produce(void* const arg) {
     }
 
     esp_core_lock();
+#if ESP_CFG_THREAD_STATS
+    esp.thread_stats_time[ESP_THREAD_PRODUCE] = esp_sys_now();
+#endif /* ESP_CFG_THREAD_STATS */
     while (1) {
+        THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 1);
         esp_core_unlock();
-        do {
-            time = esp_sys_mbox_get(&e->mbox_producer, (void **)&msg, 0);   /* Get message from queue */
-        } while (time == ESP_SYS_TIMEOUT || msg == NULL);
+        if (batch_next != NULL) {               /* Continue with next command in batch */
+            msg = batch_next;
+        } else {
+            msg = espi_get_msg_from_producer_mbox();/* Get message from queue */
+        }
         ESP_THREAD_PRODUCER_HOOK();             /* Execute producer thread hook */
         esp_core_lock();
+        THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 0);
 
-        res = espOK;                            /* Start with OK */
-        e->msg = msg;                           /* Set message handle */
+        res = produce_start(msg);
 
-        /*
-         * This check is performed when adding command to queue
-         * Do it again here to prevent long timeouts,
-         * if device present flag changes
-         */
-        if (!e->status.f.dev_present) {
-            res = espERRNODEVICE;
+#if ESP_CFG_SLEEP
+        /* Wake up device from light-sleep and wait until it accepts commands */
+        if (res == espOK && (time = espi_sleep_wakeup(msg)) > 0) {
+            THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 1);
+            esp_core_unlock();
+            esp_delay(time);
+            esp_core_lock();
+            THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 0);
         }
+#endif /* ESP_CFG_SLEEP */
 
         /* For reset message, we can have delay! */
         if (res == espOK && msg->cmd_def == ESP_CMD_RESET) {
             if (msg->msg.reset.delay > 0) {
+                THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 1);
                 esp_delay(msg->msg.reset.delay);
+                THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 0);
             }
             espi_reset_everything(1);           /* Reset stack before trying to reset */
         }
@@ -90,7 +381,29 @@ esp_thread_produce(void* const arg) {
          * Try to call function to process this message
          * Usually it should be function to transmit data to AT port
          */
-        if (res == espOK && msg->fn != NULL) {  /* Check for callback processing function */
+        started = res == espOK && msg->fn != NULL;
+        if (started) {                          /* Check for callback processing function */
+#if ESP_CFG_SYS_THREAD_NOTIFY
+            /*
+             * Clear notification, possibly left by
+             * previous command finished after timeout
+             */
+            esp_sys_thread_notify_clear();
+#if ESP_CFG_CMD_STATS || ESP_CFG_CMD_ADAPTIVE_TIMEOUT
+            start = esp_sys_now();
+#endif /* ESP_CFG_CMD_STATS || ESP_CFG_CMD_ADAPTIVE_TIMEOUT */
+            res = msg->fn(msg);                 /* Process this message, check if command started at least */
+            if (res == espOK) {                 /* We have valid data and data were sent */
+                THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 1);
+                esp_core_unlock();
+                time = esp_sys_thread_notify_wait(msg->block_time); /* Wait for notification from processing thread or timeout */
+                esp_core_lock();
+                THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 0);
+                if (time == ESP_SYS_TIMEOUT) {  /* Sync timeout occurred? */
+                    res = espTIMEOUT;           /* Timeout on command */
+                }
+            }
+#else /* ESP_CFG_SYS_THREAD_NOTIFY */
             /* 
              * Obtain semaphore 
              * This code should not block at any point.
@@ -98,31 +411,24 @@ esp_thread_produce(void* const arg) {
              * immediate terminate
              */
             esp_core_unlock();
-            esp_sys_sem_wait(&e->sem_sync, 0);  /* First call */
+            esp_sys_sem_wait(&esp.sem_sync, 0);  /* First call */
             esp_core_lock();
+#if ESP_CFG_CMD_STATS || ESP_CFG_CMD_ADAPTIVE_TIMEOUT
+            start = esp_sys_now();
+#endif /* ESP_CFG_CMD_STATS || ESP_CFG_CMD_ADAPTIVE_TIMEOUT */
             res = msg->fn(msg);                 /* Process this message, check if command started at least */
             time = ~ESP_SYS_TIMEOUT;            /* Reset time */
             if (res == espOK) {                 /* We have valid data and data were sent */
+                THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 1);
                 esp_core_unlock();
-                time = esp_sys_sem_wait(&e->sem_sync, msg->block_time); /* Second call; Wait for synchronization semaphore from processing thread or timeout */
+                time = esp_sys_sem_wait(&esp.sem_sync, msg->block_time); /* Second call; Wait for synchronization semaphore from processing thread or timeout */
                 esp_core_lock();
+                THREAD_STATS_WAIT(ESP_THREAD_PRODUCE, 0);
                 if (time == ESP_SYS_TIMEOUT) {  /* Sync timeout occurred? */
                     res = espTIMEOUT;           /* Timeout on command */
                 }
             }
 
-            /* Notify application on command timeout */
-            if (res == espTIMEOUT) {
-                espi_send_cb(ESP_EVT_CMD_TIMEOUT);
-            }
-
-            ESP_DEBUGW(ESP_CFG_DBG_THREAD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_SEVERE,
-                res == espTIMEOUT,
-                "[THREAD] Timeout in produce thread waiting for command to finish in process thread\r\n");
-            ESP_DEBUGW(ESP_CFG_DBG_THREAD | ESP_DBG_TYPE_TRACE | ESP_DBG_LVL_SEVERE,
-                res != espOK && res != espTIMEOUT,
-                "[THREAD] Could not start execution for command %d\r\n", (int)msg->cmd);
-
             /*
              * Manually release semaphore in all cases:
              *
@@ -139,37 +445,10 @@ esp_thread_produce(void* const arg) {
              * it would not be possible to start a new command after,
              * because semaphore would be still locked
              */
-            esp_sys_sem_release(&e->sem_sync);
-        } else {
-            if (res == espOK) {
-                res = espERR;                   /* Simply set error message */
-            }
-        }
-        if (res != espOK) {
-            /* Process global callbacks */
-            espi_process_events_for_timeout_or_error(msg, res);
-
-            msg->res = res;                     /* Save response */
+            esp_sys_sem_release(&esp.sem_sync);
+#endif /* !ESP_CFG_SYS_THREAD_NOTIFY */
         }
-
-#if ESP_CFG_USE_API_FUNC_EVT
-        /* Send event function to user */
-        if (msg->evt_fn != NULL) {
-            msg->evt_fn(msg->res, msg->evt_arg);/* Send event with user argument */
-        }
-#endif /* ESP_CFG_USE_API_FUNC_EVT */
-
-        /*
-         * In case message is blocking,
-         * release semaphore and notify finished with processing
-         * otherwise directly free memory of message structure
-         */
-        if (msg->is_blocking) {
-            esp_sys_sem_release(&msg->sem);
-        } else {
-            ESP_MSG_VAR_FREE(msg);
-        }
-        e->msg = NULL;
+        batch_next = produce_finish(msg, res, started, start);
     }
 }
 
@@ -194,17 +473,27 @@ esp_thread_process(void* const arg) {
         esp_sys_sem_release(sem);               /* Release semaphore */
     }
 
+#if ESP_CFG_THREAD_STATS
+    esp.thread_stats_time[ESP_THREAD_PROCESS] = esp_sys_now();
+#endif /* ESP_CFG_THREAD_STATS */
 #if !ESP_CFG_INPUT_USE_PROCESS
     esp_core_lock();
     while (1) {
+        THREAD_STATS_WAIT(ESP_THREAD_PROCESS, 1);
         esp_core_unlock();
-        time = espi_get_from_mbox_with_timeout_checks(&e->mbox_process, (void **)&msg, 10);
+        time = espi_get_from_mbox_with_timeout_checks(&e->mbox_process, (void **)&msg, ESP_CFG_THREAD_PROCESS_POLL_TIME);
         ESP_THREAD_PROCESS_HOOK();              /* Execute process thread hook */
         esp_core_lock();
+        THREAD_STATS_WAIT(ESP_THREAD_PROCESS, 0);
 
         if (time == ESP_SYS_TIMEOUT || msg == NULL) {
             ESP_UNUSED(time);                   /* Unused variable */
         }
+        /*
+         * Clear pending flag before draining the buffer,
+         * data written afterwards will signal new wakeup
+         */
+        e->input_wakeup_pending = 0;
         espi_process_buffer();                  /* Process input data */
 #else /* ESP_CFG_INPUT_USE_PROCESS */
     while (1) {
@@ -214,9 +503,120 @@ esp_thread_process(void* const arg) {
          * If there are no timeouts to process, we can wait unlimited time.
          * In case new timeout occurs, thread will wake up by writing new element to mbox process queue
          */
+        THREAD_STATS_WAIT(ESP_THREAD_PROCESS, 1);
         time = espi_get_from_mbox_with_timeout_checks(&e->mbox_process, (void **)&msg, 0);
         ESP_THREAD_PROCESS_HOOK();              /* Execute process thread hook */
+        THREAD_STATS_WAIT(ESP_THREAD_PROCESS, 0);
         ESP_UNUSED(time);
 #endif /* !ESP_CFG_INPUT_USE_PROCESS */
     }
 }
+
+#endif /* ESP_CFG_OS || __DOXYGEN__ */
+
+#if !ESP_CFG_OS || __DOXYGEN__
+
+/**
+ * \brief           Call processing function of message and start waiting for response
+ * \param[in]       msg: Message to start, already taken with \ref produce_start
+ */
+static void
+poll_cmd_start(esp_msg_t* msg) {
+    espr_t res;
+
+    if (msg->cmd_def == ESP_CMD_RESET) {
+        espi_reset_everything(1);               /* Reset stack before trying to reset */
+    }
+    if (msg->fn == NULL) {
+        esp.poll_next = produce_finish(msg, espOK, 0, 0);
+        return;
+    }
+    esp.poll_cmd_done = 0;
+    esp.poll_time = esp_sys_now();
+    res = msg->fn(msg);                         /* Process this message, check if command started at least */
+    if (res == espOK) {
+        esp.poll_state = ESP_POLL_STATE_CMD;    /* Wait for response in next calls */
+    } else {
+        esp.poll_next = produce_finish(msg, res, 1, esp.poll_time);
+    }
+}
+
+/**
+ * \brief           Get time to wait before command is started
+ * \param[in]       msg: Command about to be started
+ * \return          Delay in units of milliseconds, `0` to start immediately
+ */
+static uint32_t
+poll_cmd_delay(esp_msg_t* msg) {
+    if (msg->cmd_def == ESP_CMD_RESET) {
+        return msg->msg.reset.delay;            /* For reset message, we can have delay! */
+    }
+#if ESP_CFG_SLEEP
+    return espi_sleep_wakeup(msg);              /* Wait for device to wake up from light-sleep */
+#else /* ESP_CFG_SLEEP */
+    return 0;
+#endif /* !ESP_CFG_SLEEP */
+}
+
+/**
+ * \brief           Run stack without operating system
+ *
+ *                  Function processes received data, expired timeouts
+ *                  and starts next command from producer queue. It never blocks.
+ *
+ *                  Application must call it periodically from main loop,
+ *                  command responses are reported with callback functions
+ *
+ * \note            Available only when \ref ESP_CFG_OS is disabled
+ */
+void
+esp_poll(void) {
+    esp_msg_t* msg;
+
+    esp_core_lock();
+    espi_process_buffer();                      /* Process input data */
+    espi_timeout_poll();                        /* Process expired timeouts */
+
+    /* Check active command */
+    msg = esp.msg;
+    if (esp.poll_state == ESP_POLL_STATE_DELAY) {
+        if ((uint32_t)(esp_sys_now() - esp.poll_time) >= esp.poll_delay) {
+            esp.poll_state = ESP_POLL_STATE_IDLE;
+            poll_cmd_start(msg);
+        }
+    } else if (esp.poll_state == ESP_POLL_STATE_CMD) {
+        if (esp.poll_cmd_done) {                /* Command finished in processing part */
+            esp.poll_state = ESP_POLL_STATE_IDLE;
+            esp.poll_next = produce_finish(msg, espOK, 1, esp.poll_time);
+        } else if (msg->block_time > 0 && (uint32_t)(esp_sys_now() - esp.poll_time) >= msg->block_time) {
+            esp.poll_state = ESP_POLL_STATE_IDLE;
+            esp.poll_next = produce_finish(msg, espTIMEOUT, 1, esp.poll_time);
+        }
+    }
+
+    /* Start new commands until one of them waits for device */
+    while (esp.poll_state == ESP_POLL_STATE_IDLE) {
+        espr_t res;
+
+        if (esp.poll_next != NULL) {            /* Continue with next command in batch */
+            msg = esp.poll_next;
+            esp.poll_next = NULL;
+        } else if ((msg = espi_get_msg_from_producer_mbox()) == NULL) {
+            break;
+        }
+        ESP_THREAD_PRODUCER_HOOK();             /* Execute producer thread hook */
+
+        res = produce_start(msg);
+        if (res != espOK) {
+            esp.poll_next = produce_finish(msg, res, 0, 0);
+        } else if ((esp.poll_delay = poll_cmd_delay(msg)) > 0) {
+            esp.poll_state = ESP_POLL_STATE_DELAY;
+            esp.poll_time = esp_sys_now();
+        } else {
+            poll_cmd_start(msg);
+        }
+    }
+    esp_core_unlock();
+}
+
+#endif /* !ESP_CFG_OS || __DOXYGEN__ */
@@ -35,6 +35,397 @@
 #include "esp/esp_timeout.h"
 #include "esp/esp_mem.h"
 
+#if ESP_CFG_MEM_STATIC
+ESP_MEM_POOL_DEFINE(timeout_pool, sizeof(esp_timeout_t), ESP_CFG_MEM_STATIC_TIMEOUTS);
+#endif /* ESP_CFG_MEM_STATIC */
+
+/**
+ * \brief           Allocate cleared timeout structure
+ * \return          Pointer to timeout on success, `NULL` otherwise
+ */
+static esp_timeout_t*
+timeout_alloc(void) {
+#if ESP_CFG_MEM_STATIC
+    esp_timeout_t* to;
+
+    if ((to = espi_mem_pool_alloc(&timeout_pool)) != NULL) {
+        ESP_MEMSET(to, 0x00, sizeof(*to));
+    }
+    return to;
+#else /* ESP_CFG_MEM_STATIC */
+    return esp_mem_calloc(1, sizeof(esp_timeout_t));
+#endif /* !ESP_CFG_MEM_STATIC */
+}
+
+/**
+ * \brief           Free timeout structure allocated with \ref timeout_alloc
+ * \param[in]       to: Timeout to free
+ */
+static void
+timeout_free(esp_timeout_t* to) {
+#if ESP_CFG_MEM_STATIC
+    espi_mem_pool_free(&timeout_pool, to);
+#else /* ESP_CFG_MEM_STATIC */
+    esp_mem_free(to);
+#endif /* !ESP_CFG_MEM_STATIC */
+}
+
+#if ESP_CFG_TIMEOUT_WHEEL
+
+#define WHEEL_BITS                  6
+#define WHEEL_SLOTS                 (1U << WHEEL_BITS)
+#define WHEEL_MASK                  (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS                4
+#define WHEEL_MAX_TICKS             ((uint32_t)((1ULL << (WHEEL_BITS * WHEEL_LEVELS)) - 1))
+
+static esp_timeout_t* wheel[WHEEL_LEVELS][WHEEL_SLOTS]; /*!< Slots with timeout lists */
+static uint64_t wheel_level0_map;               /*!< Bitmap of non-empty slots on first level */
+static uint32_t wheel_tick;                     /*!< Last processed tick */
+static uint32_t wheel_tick_time;                /*!< System time of last processed tick */
+static size_t wheel_cnt;                        /*!< Number of armed timeouts */
+
+/**
+ * \brief           Insert armed timeout to its wheel slot
+ * \param[in]       to: Timeout with `expires` tick set
+ */
+static void
+wheel_insert(esp_timeout_t* to) {
+    uint32_t delta = to->expires - wheel_tick;
+    uint32_t level, slot;
+
+    for (level = 0; level < WHEEL_LEVELS - 1; ++level) {
+        if (delta < (1UL << (WHEEL_BITS * (level + 1)))) {
+            break;
+        }
+    }
+    slot = (to->expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+    to->prev = NULL;
+    to->next = wheel[level][slot];
+    if (to->next != NULL) {
+        to->next->prev = to;
+    }
+    wheel[level][slot] = to;
+    if (level == 0) {
+        wheel_level0_map |= (uint64_t)1 << slot;
+    }
+}
+
+/**
+ * \brief           Remove timeout from its wheel slot
+ * \param[in]       to: Armed timeout
+ */
+static void
+wheel_unlink(esp_timeout_t* to) {
+    uint32_t level, slot;
+
+    if (to->prev != NULL) {
+        to->prev->next = to->next;
+    } else {
+        /* Head of the list, find slot it belongs to */
+        for (level = 0; level < WHEEL_LEVELS; ++level) {
+            slot = (to->expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+            if (wheel[level][slot] == to) {
+                wheel[level][slot] = to->next;
+                if (level == 0 && to->next == NULL) {
+                    wheel_level0_map &= ~((uint64_t)1 << slot);
+                }
+                break;
+            }
+        }
+    }
+    if (to->next != NULL) {
+        to->next->prev = to->prev;
+    }
+    to->next = to->prev = NULL;
+}
+
+/**
+ * \brief           Move timeouts from higher level slot to lower levels
+ * \param[in]       level: Level to cascade
+ * \param[in]       slot: Slot index in level
+ */
+static void
+wheel_cascade(uint32_t level, uint32_t slot) {
+    esp_timeout_t *to, *next;
+
+    to = wheel[level][slot];
+    wheel[level][slot] = NULL;
+    for (; to != NULL; to = next) {
+        next = to->next;
+        wheel_insert(to);
+    }
+}
+
+/**
+ * \brief           Advance wheel to current time and call expired timeouts
+ * \note            Core must be locked when calling this function
+ */
+static void
+wheel_process(void) {
+    uint32_t now = esp_sys_now();
+    esp_timeout_t* to;
+    uint32_t slot;
+
+    while ((uint32_t)(now - wheel_tick_time) >= ESP_CFG_TIMEOUT_WHEEL_TICK) {
+        if (wheel_cnt == 0) {                   /* Nothing to process, jump to current time */
+            uint32_t ticks = (now - wheel_tick_time) / ESP_CFG_TIMEOUT_WHEEL_TICK;
+            wheel_tick += ticks;
+            wheel_tick_time += ticks * ESP_CFG_TIMEOUT_WHEEL_TICK;
+            break;
+        }
+        ++wheel_tick;
+        wheel_tick_time += ESP_CFG_TIMEOUT_WHEEL_TICK;
+
+        /* Cascade higher levels when lower level wraps */
+        for (uint32_t level = 1; level < WHEEL_LEVELS; ++level) {
+            if ((wheel_tick & ((1UL << (WHEEL_BITS * level)) - 1)) != 0) {
+                break;
+            }
+            wheel_cascade(level, (wheel_tick >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        }
+
+        /*
+         * Call expired timeouts
+         *
+         * Timeout is removed before callback is called,
+         * so callback may start it again or stop other timeouts
+         */
+        slot = wheel_tick & WHEEL_MASK;
+        while ((to = wheel[0][slot]) != NULL) {
+            wheel_unlink(to);
+            to->armed = 0;
+            --wheel_cnt;
+            to->fn(to->arg);
+            if (to->allocated && !to->armed) {
+                timeout_free(to);
+            }
+        }
+    }
+}
+
+/**
+ * \brief           Get time we have to wait before we can process next timeout
+ * \return          Time in units of milliseconds to wait
+ */
+static uint32_t
+get_next_timeout_diff(void) {
+    uint32_t ticks, elapsed;
+    uint64_t map;
+    uint32_t slot;
+
+    if (wheel_cnt == 0) {
+        return 0xFFFFFFFF;
+    }
+
+    /* Find next non-empty slot on first level, otherwise wait until first level wraps */
+    slot = (wheel_tick + 1) & WHEEL_MASK;
+    map = (wheel_level0_map >> slot) | (slot > 0 ? (wheel_level0_map << (WHEEL_SLOTS - slot)) : 0);
+    ticks = 1;
+    if (map != 0) {
+        for (; !(map & 0x01); map >>= 1, ++ticks) {}
+    } else {
+        ticks = WHEEL_SLOTS - (wheel_tick & WHEEL_MASK);
+    }
+
+    elapsed = esp_sys_now() - wheel_tick_time;
+    if (elapsed >= ticks * ESP_CFG_TIMEOUT_WHEEL_TICK) {
+        return 0;
+    }
+    return ticks * ESP_CFG_TIMEOUT_WHEEL_TICK - elapsed;
+}
+
+#if ESP_CFG_OS || __DOXYGEN__
+
+/**
+ * \brief           Get next entry from message queue
+ * \param[in]       b: Pointer to message queue to get element
+ * \param[out]      m: Pointer to pointer to output variable
+ * \param[in]       timeout: Maximal time to wait for message (0 = wait until message received)
+ * \return          Time in milliseconds required for next message
+ */
+uint32_t
+espi_get_from_mbox_with_timeout_checks(esp_sys_mbox_t* b, void** m, uint32_t timeout) {
+    uint32_t wait_time;
+
+    esp_core_lock();
+    wait_time = get_next_timeout_diff();
+    esp_core_unlock();
+    if (wait_time == 0xFFFFFFFF) {              /* We have no timeouts ready? */
+        return esp_sys_mbox_get(b, m, timeout); /* Get entry from message queue */
+    }
+    if (!wait_time || esp_sys_mbox_get(b, m, wait_time) == ESP_SYS_TIMEOUT) {
+        ESP_THREAD_PROCESS_HOOK();              /* Process thread hook */
+        esp_core_lock();
+        wheel_process();                        /* Process expired timeouts */
+        esp_core_unlock();
+    }
+    return wait_time;
+}
+
+#else /* ESP_CFG_OS || __DOXYGEN__ */
+
+/**
+ * \brief           Process expired timeouts without waiting
+ * \note            Core must be locked before calling this function
+ * \sa              esp_poll
+ */
+void
+espi_timeout_poll(void) {
+    wheel_process();                            /* Process expired timeouts */
+}
+
+#endif /* !(ESP_CFG_OS || __DOXYGEN__) */
+
+/**
+ * \brief           Start timeout with user provided handle
+ * \note            When handle is already running, it is restarted with new parameters
+ * \note            Handle memory must be initialized to zero before first use
+ *                  and must stay valid while timeout is active
+ * \param[in]       to: Timeout handle
+ * \param[in]       time: Time in units of milliseconds for timeout execution
+ * \param[in]       fn: Callback function to call when timeout expires
+ * \param[in]       arg: Pointer to user specific argument to call when timeout callback function is executed
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_timeout_start(esp_timeout_t* to, uint32_t time, esp_timeout_fn fn, void* arg) {
+    uint32_t ticks;
+
+    ESP_ASSERT("to != NULL", to != NULL);
+    ESP_ASSERT("fn != NULL", fn != NULL);
+
+    esp_core_lock();
+    if (wheel_cnt == 0) {                       /* Align wheel with current time when idle */
+        wheel_process();
+    }
+    if (to->armed) {
+        wheel_unlink(to);
+        --wheel_cnt;
+    }
+
+    /* Count time since last processed tick too, timeout must not expire early */
+    ticks = ((esp_sys_now() - wheel_tick_time) + time + ESP_CFG_TIMEOUT_WHEEL_TICK - 1) / ESP_CFG_TIMEOUT_WHEEL_TICK;
+    if (ticks == 0) {
+        ticks = 1;
+    } else if (ticks > WHEEL_MAX_TICKS) {
+        ticks = WHEEL_MAX_TICKS;
+    }
+    to->expires = wheel_tick + ticks;
+    to->fn = fn;
+    to->arg = arg;
+    to->armed = 1;
+    wheel_insert(to);
+    ++wheel_cnt;
+    esp_core_unlock();
+#if ESP_CFG_OS
+    esp_sys_mbox_putnow(&esp.mbox_process, NULL);   /* Write message to process queue to wakeup process thread and to start */
+#endif /* ESP_CFG_OS */
+    return espOK;
+}
+
+/**
+ * \brief           Stop timeout started with \ref esp_timeout_start
+ * \param[in]       to: Timeout handle
+ * \return          \ref espOK on success, \ref espERR if timeout was not active
+ */
+espr_t
+esp_timeout_stop(esp_timeout_t* to) {
+    uint8_t success = 0;
+
+    ESP_ASSERT("to != NULL", to != NULL);
+
+    esp_core_lock();
+    if (to->armed) {
+        wheel_unlink(to);
+        to->armed = 0;
+        --wheel_cnt;
+        success = 1;
+    }
+    esp_core_unlock();
+    return success ? espOK : espERR;
+}
+
+/**
+ * \brief           Check if timeout is active
+ * \param[in]       to: Timeout handle
+ * \return          `1` if active, `0` otherwise
+ */
+uint8_t
+esp_timeout_is_active(const esp_timeout_t* to) {
+    uint8_t res;
+
+    esp_core_lock();
+    res = to != NULL && to->armed;
+    esp_core_unlock();
+    return res;
+}
+
+/**
+ * \brief           Add new timeout to processing list
+ * \param[in]       time: Time in units of milliseconds for timeout execution
+ * \param[in]       fn: Callback function to call when timeout expires
+ * \param[in]       arg: Pointer to user specific argument to call when timeout callback function is executed
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_timeout_add(uint32_t time, esp_timeout_fn fn, void* arg) {
+    esp_timeout_t* to;
+
+    ESP_ASSERT("fn != NULL", fn != NULL);
+
+    to = timeout_alloc();                       /* Allocate memory for timeout structure */
+    if (to == NULL) {
+        return espERRMEM;
+    }
+    to->allocated = 1;                          /* Free memory after callback */
+    return esp_timeout_start(to, time, fn, arg);
+}
+
+/**
+ * \brief           Remove callback from timeout list
+ * \note            Only first timeout with matching function, started with \ref esp_timeout_add, is removed
+ * \param[in]       fn: Callback function to identify timeout to remove
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_timeout_remove(esp_timeout_fn fn) {
+    uint8_t success = 0;
+
+    esp_core_lock();
+    for (size_t level = 0; level < WHEEL_LEVELS && !success; ++level) {
+        for (size_t slot = 0; slot < WHEEL_SLOTS && !success; ++slot) {
+            for (esp_timeout_t* t = wheel[level][slot]; t != NULL; t = t->next) {
+                if (t->fn == fn && t->allocated) {
+                    wheel_unlink(t);
+                    --wheel_cnt;
+                    timeout_free(t);
+                    success = 1;
+                    break;
+                }
+            }
+        }
+    }
+    esp_core_unlock();
+    return success ? espOK : espERR;
+}
+
+/**
+ * \brief           Get number of pending timeouts
+ * \return          Number of armed timeouts
+ */
+size_t
+esp_timeout_get_count(void) {
+    size_t cnt;
+
+    esp_core_lock();
+    cnt = wheel_cnt;
+    esp_core_unlock();
+    return cnt;
+}
+
+#else /* ESP_CFG_TIMEOUT_WHEEL */
+
 static esp_timeout_t* first_timeout;
 static uint32_t last_timeout_time;
 
@@ -81,10 +472,12 @@ process_next_timeout(void) {
          */
         first_timeout = first_timeout->next;    /* Set next timeout on a list as first timeout */
         to->fn(to->arg);                        /* Call user callback function */
-        esp_mem_free_s((void **)&to);
+        timeout_free(to);
     }
 }
 
+#if ESP_CFG_OS || __DOXYGEN__
+
 /**
  * \brief           Get next entry from message queue
  * \param[in]       b: Pointer to message queue to get element
@@ -111,6 +504,22 @@ espi_get_from_mbox_with_timeout_checks(esp_sys_mbox_t* b, void** m, uint32_t tim
     return wait_time;
 }
 
+#else /* ESP_CFG_OS || __DOXYGEN__ */
+
+/**
+ * \brief           Process expired timeouts without waiting
+ * \note            Core must be locked before calling this function
+ * \sa              esp_poll
+ */
+void
+espi_timeout_poll(void) {
+    while (get_next_timeout_diff() == 0) {      /* Process all timeouts already expired */
+        process_next_timeout();
+    }
+}
+
+#endif /* !(ESP_CFG_OS || __DOXYGEN__) */
+
 /**
  * \brief           Add new timeout to processing list
  * \param[in]       time: Time in units of milliseconds for timeout execution
@@ -125,9 +534,9 @@ esp_timeout_add(uint32_t time, esp_timeout_fn fn, void* arg) {
 
     ESP_ASSERT("fn != NULL", fn != NULL);
 
-    to = esp_mem_calloc(1, sizeof(*to));        /* Allocate memory for timeout structure */
+    to = timeout_alloc();                       /* Allocate memory for timeout structure */
     if (to == NULL) {
-        return espERR;
+        return espERRMEM;
     }
 
     esp_core_lock();
@@ -184,7 +593,9 @@ esp_timeout_add(uint32_t time, esp_timeout_fn fn, void* arg) {
         }
     }
     esp_core_unlock();
+#if ESP_CFG_OS
     esp_sys_mbox_putnow(&esp.mbox_process, NULL);   /* Write message to process queue to wakeup process thread and to start */
+#endif /* ESP_CFG_OS */
     return espOK;
 }
 
@@ -222,7 +633,7 @@ esp_timeout_remove(esp_timeout_fn fn) {
             } else {
                 first_timeout = t->next;
             }
-            esp_mem_free_s((void **)&t);
+            timeout_free(t);
             success = 1;
             break;
         }
@@ -230,3 +641,21 @@ esp_timeout_remove(esp_timeout_fn fn) {
     esp_core_unlock();
     return success ? espOK : espERR;
 }
+
+/**
+ * \brief           Get number of pending timeouts
+ * \return          Number of timeouts in list
+ */
+size_t
+esp_timeout_get_count(void) {
+    size_t cnt = 0;
+
+    esp_core_lock();
+    for (esp_timeout_t* t = first_timeout; t != NULL; t = t->next) {
+        ++cnt;
+    }
+    esp_core_unlock();
+    return cnt;
+}
+
+#endif /* !ESP_CFG_TIMEOUT_WHEEL */
@@ -73,3 +73,38 @@ espi_unicode_decode(esp_unicode_t* s, uint8_t c) {
     }
     return espERR;                              /* An error, unknown UTF-8 character entered */
 }
+
+/**
+ * \brief           Get length of complete multi-byte UTF-8 sequence at the beginning of buffer
+ *
+ * Sequence is validated with the same rules as \ref espi_unicode_decode,
+ * allowing caller to copy it at once instead of decoding byte by byte
+ *
+ * \param[in]       d: Pointer to data starting with UTF-8 lead byte
+ * \param[in]       len: Number of bytes available in buffer
+ * \return          Number of bytes in sequence, `0` if sequence is invalid,
+ *                      not multi-byte or not completely in buffer
+ */
+size_t
+espi_unicode_seq_len(const uint8_t* d, size_t len) {
+    size_t t;
+
+    if ((d[0] & 0xE0) == 0xC0) {                /* 110x xxxx */
+        t = 2;
+    } else if ((d[0] & 0xF0) == 0xE0) {         /* 1110 xxxx */
+        t = 3;
+    } else if ((d[0] & 0xF8) == 0xF0) {         /* 1111 0xxx */
+        t = 4;
+    } else {
+        return 0;
+    }
+    if (t > len) {                              /* Sequence continues in next buffer */
+        return 0;
+    }
+    for (size_t i = 1; i < t; ++i) {
+        if ((d[i] & 0xC0) != 0x80) {            /* Every next byte must be 10xx xxxx */
+            return 0;
+        }
+    }
+    return t;
+}
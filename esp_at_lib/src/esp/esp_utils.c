@@ -35,6 +35,136 @@
 #include "esp/esp_utils.h"
 #include <stdint.h>
 
+/* Two-digit decimal lookup table, "00" to "99" */
+static const char dec_lut[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+/* Hex digits lookup table */
+static const char hex_lut[16] = {
+    '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
+};
+
+/**
+ * \brief           Convert `unsigned 32-bit` number to decimal string
+ * \note            Digits are produced in pairs from lookup table, halving number of divisions
+ * \param[in]       num: Number to convert
+ * \param[out]      out: Output buffer, at least `11` bytes long
+ * \return          Number of characters written, excluding `NULL` termination
+ */
+size_t
+espi_u32_to_dec_str(uint32_t num, char* out) {
+    char tmp[10], *p = &tmp[sizeof(tmp)];
+    size_t len;
+
+    while (num >= 100) {
+        const char* d = &dec_lut[(num % 100) << 1];
+        num /= 100;
+        *--p = d[1];
+        *--p = d[0];
+    }
+    if (num >= 10) {
+        *--p = dec_lut[(num << 1) + 1];
+        *--p = dec_lut[num << 1];
+    } else {
+        *--p = (char)('0' + num);
+    }
+    len = (size_t)(&tmp[sizeof(tmp)] - p);
+    ESP_MEMCPY(out, p, len);
+    out[len] = 0;
+    return len;
+}
+
+/**
+ * \brief           Format IP or MAC address to string in one pass
+ * \param[in]       d: Pointer to \ref esp_ip_t or \ref esp_mac_t
+ * \param[in]       is_ip: Set to `1` for IP (decimal, `.` delimited), `0` for MAC (hex, `:` delimited)
+ * \param[out]      out: Output buffer, at least `18` bytes long
+ * \return          Number of characters written, excluding `NULL` termination
+ */
+size_t
+espi_ip_mac_to_str(const void* d, uint8_t is_ip, char* out) {
+    const uint8_t* b = d;
+    char* p = out;
+
+    if (is_ip) {
+        for (uint8_t i = 0; i < 4; ++i) {
+            uint8_t v = b[i];
+            if (i > 0) {
+                *p++ = '.';
+            }
+            if (v >= 100) {
+                *p++ = (char)('0' + (v >= 200 ? 2 : 1));
+                v = v >= 200 ? v - 200 : v - 100;
+                *p++ = dec_lut[v << 1];
+                *p++ = dec_lut[(v << 1) + 1];
+            } else if (v >= 10) {
+                *p++ = dec_lut[v << 1];
+                *p++ = dec_lut[(v << 1) + 1];
+            } else {
+                *p++ = (char)('0' + v);
+            }
+        }
+    } else {
+        for (uint8_t i = 0; i < 6; ++i) {
+            if (i > 0) {
+                *p++ = ':';
+            }
+            *p++ = hex_lut[b[i] >> 4];
+            *p++ = hex_lut[b[i] & 0x0F];
+        }
+    }
+    *p = 0;
+    return (size_t)(p - out);
+}
+
+/**
+ * \brief           Get index of lowest set bit
+ * \param[in]       v: Value, must not be `0`
+ * \return          Bit index
+ */
+uint8_t
+espi_bit_ffs(uint32_t v) {
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_ctz(v);
+#else /* defined(__GNUC__) */
+    uint8_t i = 0;
+    while (!(v & 0x01)) {                       /* Bounded to `32` steps */
+        v >>= 1;
+        ++i;
+    }
+    return i;
+#endif /* !defined(__GNUC__) */
+}
+
+/**
+ * \brief           Get index of highest set bit
+ * \param[in]       v: Value, must not be `0`
+ * \return          Bit index
+ */
+uint8_t
+espi_bit_fls(uint32_t v) {
+#if defined(__GNUC__)
+    return (uint8_t)(31 - __builtin_clz(v));
+#else /* defined(__GNUC__) */
+    uint8_t i = 31;
+    while (!(v & 0x80000000UL)) {               /* Bounded to `32` steps */
+        v <<= 1;
+        --i;
+    }
+    return i;
+#endif /* !defined(__GNUC__) */
+}
+
 /**
  * \brief           Convert `unsigned 32-bit` number to string
  * \param[in]       num: Number to convert
@@ -47,50 +177,25 @@
  */
 char *
 esp_u32_to_gen_str(uint32_t num, char* out, uint8_t is_hex, uint8_t width) {
-    char* tmp = out;
-    uint8_t i, y;
+    uint8_t i, digits;
 
-    /* Convert number to string */
-    i = 0;
-    tmp[0] = '0';
-    if (num == 0) {
-        ++i;
-    } else {
-        if (is_hex) {
-            uint8_t mod;
-            while (num > 0) {
-                mod = num & 0x0F;
-                if (mod < 10) {
-                    tmp[i] = mod + '0';
-                } else {
-                    tmp[i] = mod - 10 + 'A';
-                }
-                num >>= 4;
-                ++i;
-            }
-        } else {
-            while (num > 0) {
-                tmp[i] = (num % 10) + '0';
-                num /= 10;
-                ++i;
-            }
-        }
+    if (!is_hex) {
+        espi_u32_to_dec_str(num, out);
+        return out;
     }
-    if (is_hex) {
-        while (i < width) {
-            tmp[i] = '0';
-            ++i;
+
+    /* Count hex digits, then write them from most significant down */
+    for (digits = 1; digits < 8 && (num >> (digits << 2)) > 0; ++digits) {}
+    if (width > digits) {
+        for (i = 0; i < width - digits; ++i) {
+            out[i] = '0';
         }
+    } else {
+        i = 0;
     }
-    tmp[i] = 0;
-
-    /* Rotate string */
-    y = 0;
-    while (y < ((i + 1) / 2)) {
-        char t = out[i - y - 1];
-        out[i - y - 1] = tmp[y];
-        tmp[y] = t;
-        ++y;
+    while (digits > 0) {
+        --digits;
+        out[i++] = hex_lut[(num >> (digits << 2)) & 0x0F];
     }
     out[i] = 0;
     return out;
@@ -88,6 +88,26 @@ extern "C" {
 #define CLI_MAX_MODULES             16
 #endif
 
+/**
+ * \brief           Max commands of all modules together
+ *
+ * Commands are kept in sorted index for lookup and auto-complete
+ */
+#ifndef CLI_MAX_COMMANDS
+#define CLI_MAX_COMMANDS            128
+#endif
+
+/**
+ * \brief           Size of session output buffer, `0` to disable output buffering
+ *
+ * When enabled, output formatted with \ref cli_session_vprintf is collected
+ * and passed to session write function once after received input is processed,
+ * or earlier when buffer is full. Longer single outputs are truncated to buffer size
+ */
+#ifndef CLI_OUT_BUFF_SIZE
+#define CLI_OUT_BUFF_SIZE           0
+#endif
+
 /**
  * \}
  */
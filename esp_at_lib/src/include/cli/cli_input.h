@@ -36,6 +36,12 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "cli/cli.h"
+#include "cli/cli_config.h"
+
 /**
  * \ingroup         CLI
  * \defgroup        CLI_INPUT Input
@@ -45,6 +51,42 @@ extern "C" {
  * Functions to parse incoming data for command line interface (CLI).
  */
 
+/**
+ * \brief           Write function for buffered session output
+ * \param[in]       arg: User argument set with \ref cli_session_set_output
+ * \param[in]       data: Output data
+ * \param[in]       len: Number of bytes to write
+ */
+typedef void cli_write_fn(void* arg, const void* data, size_t len);
+
+/**
+ * \brief           CLI session with own input and history state
+ */
+typedef struct {
+    cli_printf* cliprintf;                      /*!< Output function of session */
+    char cmd_buffer[CLI_MAX_CMD_LENGTH];        /*!< Command being typed */
+    uint32_t cmd_pos;                           /*!< Cursor position in command buffer */
+    char cmd_history_buffer[CLI_CMD_HISTORY][CLI_MAX_CMD_LENGTH];   /*!< Previous commands */
+    uint32_t cmd_history_pos;                   /*!< Current history position */
+    uint32_t cmd_history_full;                  /*!< Number of commands in history */
+    uint32_t key_sequence;                      /*!< Special key sequence state */
+    char last_ch;                               /*!< Last received character */
+#if CLI_OUT_BUFF_SIZE > 0 || __DOXYGEN__
+    cli_write_fn* out_write;                    /*!< Write function for buffered output, `NULL` when not used */
+    void* out_arg;                              /*!< User argument for write function */
+    char out_buff[CLI_OUT_BUFF_SIZE];           /*!< Output waiting to be written */
+    size_t out_len;                             /*!< Number of bytes waiting in output buffer */
+#endif /* CLI_OUT_BUFF_SIZE > 0 || __DOXYGEN__ */
+} cli_session_t;
+
+void cli_session_init(cli_session_t* s, cli_printf cliprintf);
+void cli_session_in_data(cli_session_t* s, char ch);
+void cli_session_in_buff(cli_session_t* s, const void* data, size_t len);
+#if CLI_OUT_BUFF_SIZE > 0 || __DOXYGEN__
+void cli_session_set_output(cli_session_t* s, cli_write_fn* write_fn, void* arg);
+void cli_session_vprintf(cli_session_t* s, const char* fmt, va_list argptr);
+void cli_session_flush(cli_session_t* s);
+#endif /* CLI_OUT_BUFF_SIZE > 0 || __DOXYGEN__ */
 void cli_in_data(cli_printf cliprintf, char ch);
 
 /**
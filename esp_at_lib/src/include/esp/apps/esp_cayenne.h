@@ -69,6 +69,91 @@ extern "C" {
 #define ESP_CAYENNE_PORT                        1883
 #endif
 
+/**
+ * \brief           Maximal length of topic prefix, including `NULL` termination
+ *
+ * Prefix is made of API version, username and client ID
+ * and is built once when Cayenne handle is created
+ */
+#ifndef ESP_CAYENNE_TOPIC_PREFIX_LEN
+#define ESP_CAYENNE_TOPIC_PREFIX_LEN            96
+#endif
+
+/**
+ * \brief           Number of cached full topic strings per Cayenne handle
+ *
+ * Each used combination of topic and channel is built only once
+ * and reused on next publish or subscribe. Set to `0` to disable cache
+ */
+#ifndef ESP_CAYENNE_TOPIC_CACHE_SIZE
+#define ESP_CAYENNE_TOPIC_CACHE_SIZE            8
+#endif
+
+/**
+ * \brief           Number of decimal digits when formatting float values
+ */
+#ifndef ESP_CAYENNE_FLOAT_DECIMALS
+#define ESP_CAYENNE_FLOAT_DECIMALS              3
+#endif
+
+/**
+ * \brief           Length of MQTT client TX buffer in units of bytes
+ */
+#ifndef ESP_CAYENNE_TX_BUFF_LEN
+#define ESP_CAYENNE_TX_BUFF_LEN                 256
+#endif
+
+/**
+ * \brief           Length of MQTT client RX buffer in units of bytes
+ */
+#ifndef ESP_CAYENNE_RX_BUFF_LEN
+#define ESP_CAYENNE_RX_BUFF_LEN                 256
+#endif
+
+/**
+ * \brief           Maximal payload length of single batch publish packet
+ *
+ * Batch which does not fit into one packet is split to multiple packets.
+ * Topic and payload must fit into \ref ESP_CAYENNE_TX_BUFF_LEN
+ */
+#ifndef ESP_CAYENNE_BATCH_PAYLOAD_LEN
+#define ESP_CAYENNE_BATCH_PAYLOAD_LEN           128
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` Cayenne on top of callback based MQTT client
+ *
+ * When enabled, Cayenne handle does not create its own thread.
+ * Connection, reconnection and received commands are processed
+ * from stack callbacks and event function is called from processing thread,
+ * hence it must not block.
+ *
+ * When disabled, each handle creates new thread on top of MQTT client API
+ */
+#ifndef ESP_CAYENNE_USE_EVT_CLIENT
+#define ESP_CAYENNE_USE_EVT_CLIENT              0
+#endif
+
+/**
+ * \brief           Delay in units of milliseconds before new connection attempt
+ * \note            Used only when \ref ESP_CAYENNE_USE_EVT_CLIENT is enabled
+ */
+#ifndef ESP_CAYENNE_RECONNECT_DELAY
+#define ESP_CAYENNE_RECONNECT_DELAY             1000
+#endif
+
+/**
+ * \brief           Number of topic and channel pairs with publish filter per Cayenne handle
+ *
+ * Filter aggregates and suppresses values published with \ref esp_cayenne_publish_float.
+ * Set to `0` to disable filtering
+ *
+ * \sa              esp_cayenne_set_filter
+ */
+#ifndef ESP_CAYENNE_FILTER_CNT
+#define ESP_CAYENNE_FILTER_CNT                  0
+#endif
+
 #define ESP_CAYENNE_NO_CHANNEL                  0xFFFE  /*!< No channel macro */
 #define ESP_CAYENNE_ALL_CHANNELS                0xFFFF  /*!< All channels macro */
 
@@ -118,6 +203,68 @@ typedef struct {
     const char* value;                          /*!< Value string */
 } esp_cayenne_key_value_t;
 
+/**
+ * \brief           Channel value for batch publish
+ */
+typedef struct {
+    uint16_t channel;                           /*!< Channel number */
+    const char* type;                           /*!< Optional data type, set to `NULL` if not used */
+    const char* unit;                           /*!< Optional data unit, set to `NULL` if not used */
+    float value;                                /*!< Channel value */
+} esp_cayenne_data_t;
+
+#if ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__
+
+/**
+ * \brief           Aggregation of values published in single filter window
+ */
+typedef enum {
+    ESP_CAYENNE_AGGR_LAST,                      /*!< Last value in window */
+    ESP_CAYENNE_AGGR_MIN,                       /*!< Minimal value in window */
+    ESP_CAYENNE_AGGR_MAX,                       /*!< Maximal value in window */
+    ESP_CAYENNE_AGGR_AVG,                       /*!< Average of all values in window */
+} esp_cayenne_aggr_t;
+
+/**
+ * \brief           Publish filter policy for single topic and channel
+ */
+typedef struct {
+    esp_cayenne_aggr_t aggr;                    /*!< Aggregation of values in window */
+    uint32_t window;                            /*!< Window length in units of milliseconds.
+                                                    At most one value is published per window */
+    float deadband;                             /*!< Aggregated value is published only when it differs
+                                                    from last published for at least this amount. Set to `0` to disable */
+    uint32_t max_interval;                      /*!< Maximal time in units of milliseconds when value
+                                                    is published regardless of deadband. Set to `0` to disable */
+} esp_cayenne_filter_t;
+
+/**
+ * \brief           Publish filter state
+ */
+typedef struct {
+    uint8_t in_use;                             /*!< Set to `1` when entry is used */
+    esp_cayenne_topic_t topic;                  /*!< Filtered topic */
+    uint16_t channel;                           /*!< Filtered channel */
+    esp_cayenne_filter_t policy;                /*!< Filter policy */
+    uint32_t window_start;                      /*!< Time when current window started */
+    uint32_t cnt;                               /*!< Number of values in current window */
+    float acc;                                  /*!< Aggregated value of current window */
+    uint8_t published;                          /*!< Set to `1` when at least one value was published */
+    float last_value;                           /*!< Last published value */
+    uint32_t last_time;                         /*!< Time of last publish */
+} esp_cayenne_filter_entry_t;
+
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__ */
+
+/**
+ * \brief           Cached topic string
+ */
+typedef struct {
+    esp_cayenne_topic_t topic;                  /*!< Topic type */
+    uint16_t channel;                           /*!< Topic channel */
+    char* str;                                  /*!< Full topic string or `NULL` when entry not used */
+} esp_cayenne_topic_cache_t;
+
 /**
  * \brief           Cayenne message
  */
@@ -158,22 +305,42 @@ typedef espr_t (*esp_cayenne_evt_fn)(struct esp_cayenne* c, esp_cayenne_evt_t* e
  * \brief           Cayenne handle
  */
 typedef struct esp_cayenne {
+#if ESP_CAYENNE_USE_EVT_CLIENT || __DOXYGEN__
+    esp_mqtt_client_p mqtt_c;                   /*!< Callback based MQTT client */
+#endif /* ESP_CAYENNE_USE_EVT_CLIENT || __DOXYGEN__ */
+#if !ESP_CAYENNE_USE_EVT_CLIENT || __DOXYGEN__
     esp_mqtt_client_api_p api_c;                /*!< MQTT API client */
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT || __DOXYGEN__ */
     const esp_mqtt_client_info_t* info_c;       /*!< MQTT Client info structure */
+    char topic_prefix[ESP_CAYENNE_TOPIC_PREFIX_LEN];    /*!< Cached topic prefix */
+    size_t topic_prefix_len;                    /*!< Length of topic prefix */
+#if ESP_CAYENNE_TOPIC_CACHE_SIZE > 0 || __DOXYGEN__
+    esp_cayenne_topic_cache_t topic_cache[ESP_CAYENNE_TOPIC_CACHE_SIZE];    /*!< Cached topic strings */
+#endif /* ESP_CAYENNE_TOPIC_CACHE_SIZE > 0 || __DOXYGEN__ */
+
+#if ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__
+    esp_cayenne_filter_entry_t filters[ESP_CAYENNE_FILTER_CNT]; /*!< Publish filters */
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__ */
 
     esp_cayenne_msg_t msg;                      /*!< Received data message */
 
     esp_cayenne_evt_t evt;                      /*!< Event handle */
     esp_cayenne_evt_fn evt_fn;                  /*!< Event callback function */
 
+#if !ESP_CAYENNE_USE_EVT_CLIENT || __DOXYGEN__
     esp_sys_thread_t thread;                    /*!< Cayenne thread handle */
     esp_sys_sem_t sem;                          /*!< Sync semaphore handle */
+#endif /* !ESP_CAYENNE_USE_EVT_CLIENT || __DOXYGEN__ */
 } esp_cayenne_t;
 
 espr_t      esp_cayenne_create(esp_cayenne_t* c, const esp_mqtt_client_info_t* client_info, esp_cayenne_evt_fn evt_fn);
 espr_t      esp_cayenne_subscribe(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel);
 espr_t      esp_cayenne_publish_data(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel, const char* type, const char* unit, const char* data);
 espr_t      esp_cayenne_publish_float(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel, const char* type, const char* unit, float f);
+espr_t      esp_cayenne_publish_data_batch(esp_cayenne_t* c, const esp_cayenne_data_t* data, size_t count);
+#if ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__
+espr_t      esp_cayenne_set_filter(esp_cayenne_t* c, esp_cayenne_topic_t topic, uint16_t channel, const esp_cayenne_filter_t* policy);
+#endif /* ESP_CAYENNE_FILTER_CNT > 0 || __DOXYGEN__ */
 
 espr_t      esp_cayenne_publish_response(esp_cayenne_t* c, esp_cayenne_msg_t* msg, esp_cayenne_resp_t resp, const char* message);
 
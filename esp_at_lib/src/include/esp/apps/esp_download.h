@@ -0,0 +1,79 @@
+/**
+ * \file            esp_download.h
+ * \brief           Streaming download from connection to storage
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_APP_DOWNLOAD_H
+#define ESP_HDR_APP_DOWNLOAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp/esp.h"
+#include "esp/esp_netconn.h"
+
+/**
+ * \ingroup         ESP_APPS
+ * \defgroup        ESP_APP_DOWNLOAD Streaming download
+ * \brief           Stream received connection data to storage writer
+ *
+ * Data received on netconn are copied to one of \ref ESP_CFG_DOWNLOAD_BLOCK_CNT blocks,
+ * while blocks filled before are passed to writer callback from separate thread.
+ * Network receive therefore continues while writer waits for flash erase or program to finish.
+ *
+ * New data are read from connection only when free block is available.
+ * With \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE enabled, data stay in device buffer
+ * until then and TCP window keeps server from sending more than host can store
+ *
+ * \{
+ */
+
+/**
+ * \brief           Download writer callback function
+ * \param[in]       arg: Custom user argument
+ * \param[in]       data: Block of downloaded data
+ * \param[in]       len: Length of data in units of bytes
+ * \return          \ref espOK to continue, member of \ref espr_t enumeration to abort download
+ */
+typedef espr_t  (*esp_download_write_fn)(void* arg, const void* data, size_t len);
+
+espr_t  esp_download_netconn(esp_netconn_p nc, size_t block_len, esp_download_write_fn write_fn, void* arg, size_t* total);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HDR_APP_DOWNLOAD_H */
@@ -0,0 +1,138 @@
+/**
+ * \file            esp_http_client.h
+ * \brief           HTTP/1.1 client
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_APP_HTTP_CLIENT_H
+#define ESP_HDR_APP_HTTP_CLIENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP_APPS
+ * \defgroup        ESP_APP_HTTP_CLIENT HTTP client
+ * \brief           HTTP/1.1 client
+ *
+ * Client sends request over netconn, body can be given as memory block
+ * or streamed from callback function with chunked transfer encoding.
+ * Response status, headers and body are parsed incrementally from received packet buffers
+ * and passed to application as they arrive, response is never buffered as a whole.
+ *
+ * Connection stays open after response when server allows it
+ * and is used for next request to the same host and port.
+ *
+ * When \ref ESP_CFG_HTTP_CLIENT_AT is enabled, requests are executed by ESP32 device with `AT+HTTPCLIENT` command
+ *
+ * \note            Client handle may only be used from one thread at a time
+ * \{
+ */
+
+/**
+ * \brief           Request method
+ */
+typedef enum {
+    ESP_HTTP_CLIENT_METHOD_GET = 0x00,          /*!< GET request */
+    ESP_HTTP_CLIENT_METHOD_HEAD,                /*!< HEAD request */
+    ESP_HTTP_CLIENT_METHOD_POST,                /*!< POST request */
+    ESP_HTTP_CLIENT_METHOD_PUT,                 /*!< PUT request */
+    ESP_HTTP_CLIENT_METHOD_DELETE,              /*!< DELETE request */
+} esp_http_client_method_t;
+
+/**
+ * \brief           Request body callback function
+ * \param[in]       arg: Custom user argument
+ * \param[out]      buff: Buffer to write body data to
+ * \param[in]       btw: Maximal number of bytes to write
+ * \return          Number of bytes written to buffer, `0` when body has ended
+ */
+typedef size_t  (*esp_http_client_body_fn)(void* arg, void* buff, size_t btw);
+
+/**
+ * \brief           Response header callback function
+ * \param[in]       arg: Custom user argument
+ * \param[in]       name: Header name
+ * \param[in]       value: Header value, leading whitespace removed
+ */
+typedef void    (*esp_http_client_header_fn)(void* arg, const char* name, const char* value);
+
+/**
+ * \brief           Response body callback function
+ * \param[in]       arg: Custom user argument
+ * \param[in]       data: Part of response body
+ * \param[in]       len: Length of data in units of bytes
+ * \return          \ref espOK to continue, member of \ref espr_t enumeration to abort request
+ */
+typedef espr_t  (*esp_http_client_data_fn)(void* arg, const void* data, size_t len);
+
+/**
+ * \brief           HTTP request description
+ */
+typedef struct {
+    esp_http_client_method_t method;            /*!< Request method */
+    const char* host;                           /*!< Server host name or IP address */
+    esp_port_t port;                            /*!< Server port, set to `0` for default port */
+    const char* path;                           /*!< Request path with query, `/` when set to `NULL` */
+    uint8_t ssl;                                /*!< Set to `1` to use SSL connection */
+    const char* content_type;                   /*!< Value of `Content-Type` header or `NULL` */
+    const char* headers;                        /*!< Additional header lines, each terminated with `\r\n`, or `NULL` */
+    const void* body;                           /*!< Request body or `NULL` */
+    size_t body_len;                            /*!< Length of request body. When `body_fn` is used,
+                                                        body length or `0` to send body with chunked transfer encoding */
+    esp_http_client_body_fn body_fn;            /*!< Request body callback, used when `body` is `NULL` */
+    esp_http_client_header_fn header_fn;        /*!< Response header callback or `NULL` */
+    esp_http_client_data_fn data_fn;            /*!< Response body callback or `NULL` */
+    void* arg;                                  /*!< Custom argument for callback functions */
+} esp_http_client_req_t;
+
+struct esp_http_client;
+
+/**
+ * \brief           Pointer to HTTP client structure
+ */
+typedef struct esp_http_client* esp_http_client_p;
+
+esp_http_client_p   esp_http_client_new(void);
+void                esp_http_client_delete(esp_http_client_p client);
+espr_t              esp_http_client_request(esp_http_client_p client, const esp_http_client_req_t* req, uint16_t* status);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HDR_APP_HTTP_CLIENT_H */
@@ -77,6 +77,19 @@ extern "C" {
 #define HTTP_SSI_TAG_MAX_LEN                10
 #endif
 
+/**
+ * \brief           Size of SSI tag hash index. Set to `0` to disable SSI tag table
+ *
+ *                  Tags of \ref http_init_t.ssi table are indexed by name hash in \ref esp_http_server_init,
+ *                  so handler is found without comparing tag name against every entry.
+ *                  Tags without table entry are passed to \ref http_init_t.ssi_fn
+ *
+ * \note            Value must be a power of `2` and bigger than number of table entries
+ */
+#ifndef HTTP_SSI_HASH_SIZE
+#define HTTP_SSI_HASH_SIZE                  0
+#endif
+
 /**
  * \brief           Enables `1` or disables `0` support for POST request
  */
@@ -84,6 +97,22 @@ extern "C" {
 #define HTTP_SUPPORT_POST                   1
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` flow control for POST request data
+ *
+ *                  When \ref http_post_data_fn returns \ref espINPROG, received data
+ *                  are not acknowledged to stack until application calls \ref esp_http_server_post_data_consumed.
+ *                  Stack stops reading more data from device when receive window is full,
+ *                  keeping memory usage constant during large uploads
+ *
+ * \note            In order to use this, \ref HTTP_SUPPORT_POST and
+ *                  \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE must be enabled
+ * \sa              ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW
+ */
+#ifndef HTTP_POST_FLOW_CONTROL
+#define HTTP_POST_FLOW_CONTROL              0
+#endif
+
 /**
  * \brief           Maximal length of allowed uri length including parameters in format `/uri/sub/path?param=value`
  */
@@ -124,6 +153,18 @@ extern "C" {
 #define HTTP_USE_DEFAULT_STATIC_FILES       1
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` binary search for CGI and static file URIs
+ *
+ *                  When enabled, CGI array in \ref http_init_t and static files table
+ *                  must be sorted by URI in ascending `strcmp` order.
+ *                  Lookup then takes logarithmic instead of linear time,
+ *                  which matters with large number of embedded files
+ */
+#ifndef HTTP_SORTED_URI_TABLES
+#define HTTP_SORTED_URI_TABLES              0
+#endif
+
 /**
  * \brief           Enables `1` or disables `0` dynamic headers support
  *
@@ -150,6 +191,197 @@ extern "C" {
 #define HTTP_DYNAMIC_HEADERS_CONTENT_LEN    1
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` persistent HTTP/1.1 connections
+ *
+ *                  Connection stays opened after response with known content length
+ *                  and pipelined requests are processed in order of reception.
+ *                  Responses with unknown length, such as SSI files, still close the connection
+ *
+ * \note            In order to use this, \ref HTTP_DYNAMIC_HEADERS and
+ *                  \ref HTTP_DYNAMIC_HEADERS_CONTENT_LEN must be enabled
+ * \sa              HTTP_KEEP_ALIVE_TIMEOUT
+ */
+#ifndef HTTP_KEEP_ALIVE
+#define HTTP_KEEP_ALIVE                     0
+#endif
+
+/**
+ * \brief           Time in units of milliseconds to keep idle persistent connection opened
+ *
+ *                  Idle time is measured with connection poll events
+ */
+#ifndef HTTP_KEEP_ALIVE_TIMEOUT
+#define HTTP_KEEP_ALIVE_TIMEOUT             5000
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` chunked transfer encoding for responses with unknown length
+ *
+ *                  SSI responses on persistent connections are sent with `Transfer-Encoding: chunked`
+ *                  header instead of closing connection to mark end of response.
+ *                  Chunk framing is written to connection write buffer together with data
+ *
+ * \note            In order to use this, \ref HTTP_KEEP_ALIVE must be enabled
+ */
+#ifndef HTTP_CHUNKED_ENCODING
+#define HTTP_CHUNKED_ENCODING               0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` precompressed gzip files
+ *
+ *                  When client accepts gzip encoding, server first tries to open
+ *                  file with `.gz` suffix added to requested path, for example `/js/app.js.gz`
+ *                  for `/js/app.js` request, and responds with `Content-Encoding: gzip` header.
+ *                  Content type is still detected from original path
+ *
+ * \note            Compressed files are never processed for SSI tags
+ */
+#ifndef HTTP_GZIP_STATIC_FILES
+#define HTTP_GZIP_STATIC_FILES              0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` ETag validation for files
+ *
+ *                  Files with entity tag set in \ref http_fs_file_table_t or by user
+ *                  file system open function are sent with `ETag` and `Cache-Control` headers.
+ *                  GET request with matching `If-None-Match` header is answered
+ *                  with `304 Not Modified` without sending file content
+ *
+ * \note            In order to use this, \ref HTTP_DYNAMIC_HEADERS must be enabled
+ * \sa              HTTP_ETAG_MAX_LEN, HTTP_CACHE_CONTROL
+ */
+#ifndef HTTP_ETAG
+#define HTTP_ETAG                           0
+#endif
+
+/**
+ * \brief           Maximal length of entity tag including quotes, such as `"5d41402a"`
+ */
+#ifndef HTTP_ETAG_MAX_LEN
+#define HTTP_ETAG_MAX_LEN                   34
+#endif
+
+/**
+ * \brief           Value of `Cache-Control` header sent together with `ETag` header
+ */
+#ifndef HTTP_CACHE_CONTROL
+#define HTTP_CACHE_CONTROL                  "no-cache"
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` byte range requests
+ *
+ *                  GET request with single `Range: bytes=x-y` header is answered with
+ *                  `206 Partial Content` and only requested part of file is sent.
+ *                  Files opened with user file system must support \ref http_init_t.fs_seek callback.
+ *                  Requests with multiple ranges or with `If-Range` header not matching entity tag
+ *                  are answered with entire file
+ *
+ * \note            In order to use this, \ref HTTP_DYNAMIC_HEADERS and
+ *                  \ref HTTP_DYNAMIC_HEADERS_CONTENT_LEN must be enabled
+ */
+#ifndef HTTP_RANGE_REQUESTS
+#define HTTP_RANGE_REQUESTS                 0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` read-ahead of non-static response files
+ *
+ *                  Next block of file opened with user file system is read
+ *                  while previous block is still being sent to device,
+ *                  so that storage access and network transmission overlap.
+ *                  Up to `2` blocks of \ref ESP_CFG_CONN_MAX_DATA_LEN bytes are allocated per connection
+ *
+ * \note            Read-ahead is used for responses without SSI processing
+ */
+#ifndef HTTP_FS_READ_AHEAD
+#define HTTP_FS_READ_AHEAD                  0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` packed read-only file image
+ *
+ *                  Files are looked up by path hash in image set with \ref http_init_t.fs_image,
+ *                  placed for example in memory-mapped external flash.
+ *                  Found files are static and sent directly from image memory, without RAM copies
+ *
+ * \sa              ESP_APP_HTTP_SERVER_FS_IMAGE
+ */
+#ifndef HTTP_FS_IMAGE
+#define HTTP_FS_IMAGE                       0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` WebSocket endpoints
+ *
+ *                  GET request with `Upgrade: websocket` header, accepted by
+ *                  \ref http_init_t.ws_connect_fn callback, is answered with `101 Switching Protocols`
+ *                  and connection stays opened for framed messages in both directions.
+ *                  Server pushes messages with \ref esp_http_server_ws_write function
+ *
+ * \sa              HTTP_WS_MAX_FRAME_LEN
+ */
+#ifndef HTTP_WEBSOCKET
+#define HTTP_WEBSOCKET                      0
+#endif
+
+/**
+ * \brief           Maximal payload length of received WebSocket frame in units of bytes
+ *
+ *                  Connection is closed when client sends longer frame
+ */
+#ifndef HTTP_WS_MAX_FRAME_LEN
+#define HTTP_WS_MAX_FRAME_LEN               256
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` preallocated HTTP states
+ *
+ *                  When enabled, \ref ESP_CFG_MAX_CONNS HTTP states are allocated statically,
+ *                  indexed by connection number, and reset in place on new connection.
+ *                  Request setup then does not allocate memory from heap
+ *
+ * \note            Static memory usage is `ESP_CFG_MAX_CONNS * sizeof(http_state_t)` bytes
+ */
+#ifndef HTTP_STATE_POOL
+#define HTTP_STATE_POOL                     0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` cache of rendered SSI responses
+ *
+ *                  Output of SSI file requested with URI listed in \ref http_init_t.cache table
+ *                  is stored in memory after first response and repeat requests with the same URI,
+ *                  including parameters, are served from memory as static file
+ *                  until entry time-to-live expires or \ref esp_http_server_cache_invalidate is called.
+ *                  CGI handler and SSI callback are not called for cached response
+ *
+ * \sa              HTTP_RESP_CACHE_ENTRIES, HTTP_RESP_CACHE_MAX_LEN
+ */
+#ifndef HTTP_RESP_CACHE
+#define HTTP_RESP_CACHE                     0
+#endif
+
+/**
+ * \brief           Maximal number of cached responses
+ */
+#ifndef HTTP_RESP_CACHE_ENTRIES
+#define HTTP_RESP_CACHE_ENTRIES             4
+#endif
+
+/**
+ * \brief           Maximal length of single cached response in units of bytes,
+ *                  including request URI and file path
+ *
+ *                  Longer responses are sent normally and not stored
+ */
+#ifndef HTTP_RESP_CACHE_MAX_LEN
+#define HTTP_RESP_CACHE_MAX_LEN             2048
+#endif
+
 /**
  * \brief           Default server name for `Server: x` response dynamic header
  */
@@ -164,10 +396,11 @@ extern "C" {
 /**
  * \brief           Maximal number of headers we can control
  */
-#define HTTP_MAX_HEADERS                    4
+#define HTTP_MAX_HEADERS                    (4 + (HTTP_KEEP_ALIVE ? 1 : 0) + (HTTP_RANGE_REQUESTS ? 1 : 0) + (HTTP_GZIP_STATIC_FILES ? 1 : 0) + (HTTP_ETAG ? 1 : 0))
 
 struct http_state;
 struct http_fs_file;
+struct http_cache_entry;
 
 /**
  * \brief           HTTP parameters on http URI in format `?param1=value1&param2=value2&...`
@@ -194,6 +427,15 @@ typedef struct {
     http_cgi_fn fn;                             /*!< Callback function to call when we have a CGI match */
 } http_cgi_t;
 
+/**
+ * \brief           Cacheable response URI entry
+ */
+typedef struct {
+    const char* uri;                            /*!< Request URI without parameters, ex. "/status.shtml" */
+    uint32_t ttl;                               /*!< Time in units of milliseconds to serve response from cache,
+                                                    `0` to keep it until invalidated by application */
+} http_cache_t;
+
 /**
  * \brief           Post request started with non-zero content length function prototype
  * \param[in]       hs: HTTP state
@@ -208,7 +450,9 @@ typedef espr_t  (*http_post_start_fn)(struct http_state* hs, const char* uri, ui
  * \note            This function may be called multiple time until content_length from \ref http_post_start_fn callback is not reached
  * \param[in]       hs: HTTP state
  * \param[in]       pbuf: Packet buffer wit reciveed data
- * \return          \ref espOK on success, member of \ref espr_t otherwise
+ * \return          \ref espOK on success, member of \ref espr_t otherwise.
+ *                  When \ref HTTP_POST_FLOW_CONTROL is enabled, return \ref espINPROG
+ *                  to delay reception of more data until \ref esp_http_server_post_data_consumed is called
  */
 typedef espr_t  (*http_post_data_fn)(struct http_state* hs, esp_pbuf_p pbuf);
 
@@ -231,6 +475,14 @@ typedef espr_t  (*http_post_end_fn)(struct http_state* hs);
  */
 typedef size_t  (*http_ssi_fn)(struct http_state* hs, const char* tag_name, size_t tag_len);
 
+/**
+ * \brief           SSI structure to register handlers on tag names
+ */
+typedef struct {
+    const char* tag;                            /*!< Tag name without start and end strings, such as `title` */
+    http_ssi_fn fn;                             /*!< Callback function to call for this tag */
+} http_ssi_t;
+
 /**
  * \brief           File system open file function
  *                  Function is called when user file system (FAT or similar) should be invoked to open a file from specific path
@@ -257,6 +509,55 @@ typedef uint32_t    (*http_fs_read_fn)(struct http_fs_file* file, void* buff, si
  */
 typedef uint8_t (*http_fs_close_fn)(struct http_fs_file* file);
 
+/**
+ * \brief           Set file read position callback function
+ * \param[in]       file: File to set position for
+ * \param[in]       pos: Absolute position from beginning of file in units of bytes
+ * \return          `1` on success, `0` otherwise
+ */
+typedef uint8_t (*http_fs_seek_fn)(struct http_fs_file* file, uint32_t pos);
+
+/**
+ * \brief           WebSocket frame opcode
+ */
+typedef enum {
+    HTTP_WS_OPCODE_CONT = 0x00,                 /*!< Continuation of fragmented message */
+    HTTP_WS_OPCODE_TEXT = 0x01,                 /*!< Text message */
+    HTTP_WS_OPCODE_BINARY = 0x02,               /*!< Binary message */
+    HTTP_WS_OPCODE_CLOSE = 0x08,                /*!< Connection close control frame */
+    HTTP_WS_OPCODE_PING = 0x09,                 /*!< Ping control frame */
+    HTTP_WS_OPCODE_PONG = 0x0A,                 /*!< Pong control frame */
+} http_ws_opcode_t;
+
+/**
+ * \brief           WebSocket upgrade request function prototype
+ * \param[in]       hs: HTTP state
+ * \param[in]       uri: Request URI without parameters
+ * \return          \ref espOK to accept connection as WebSocket,
+ *                  member of \ref espr_t otherwise to process request as normal GET request
+ */
+typedef espr_t  (*http_ws_connect_fn)(struct http_state* hs, const char* uri);
+
+/**
+ * \brief           WebSocket data frame received function prototype
+ * \note            Fragmented messages are passed frame by frame,
+ *                  continuation frames have \ref HTTP_WS_OPCODE_CONT opcode
+ * \param[in]       hs: HTTP state
+ * \param[in]       opcode: Frame opcode, \ref HTTP_WS_OPCODE_TEXT, \ref HTTP_WS_OPCODE_BINARY or \ref HTTP_WS_OPCODE_CONT
+ * \param[in]       data: Unmasked frame payload
+ * \param[in]       len: Length of payload in units of bytes
+ * \param[in]       fin: Set to `1` when frame is last frame of message
+ * \return          \ref espOK on success, member of \ref espr_t otherwise to close connection
+ */
+typedef espr_t  (*http_ws_data_fn)(struct http_state* hs, http_ws_opcode_t opcode, const void* data, size_t len, uint8_t fin);
+
+/**
+ * \brief           WebSocket connection closed function prototype
+ * \note            HTTP state must not be used anymore after this callback
+ * \param[in]       hs: HTTP state
+ */
+typedef void    (*http_ws_close_fn)(struct http_state* hs);
+
 /**
  * \brief           HTTP server initialization structure
  */
@@ -269,16 +570,39 @@ typedef struct {
 #endif /* HTTP_SUPPORT_POST || __DOXYGEN__ */
 
     /* CGI related */
-    const http_cgi_t* cgi;                      /*!< Pointer to array of CGI entries. Set to NULL if not used */
+    const http_cgi_t* cgi;                      /*!< Pointer to array of CGI entries. Set to NULL if not used.
+                                                    Must be sorted by URI when \ref HTTP_SORTED_URI_TABLES is enabled */
     size_t cgi_count;                           /*!< Length of CGI array. Set to 0 if not used */
 
     /* SSI related */
     http_ssi_fn ssi_fn;                         /*!< SSI callback function */
+#if HTTP_SSI_HASH_SIZE > 0 || __DOXYGEN__
+    const http_ssi_t* ssi;                      /*!< Pointer to array of SSI tag handlers. Set to NULL if not used */
+    size_t ssi_count;                           /*!< Length of SSI array. Set to 0 if not used */
+#endif /* HTTP_SSI_HASH_SIZE > 0 || __DOXYGEN__ */
+#if HTTP_RESP_CACHE || __DOXYGEN__
+    const http_cache_t* cache;                  /*!< Pointer to array of URIs with cacheable response. Set to NULL if not used */
+    size_t cache_count;                         /*!< Length of cache array. Set to 0 if not used */
+#endif /* HTTP_RESP_CACHE || __DOXYGEN__ */
 
     /* File system related */
     http_fs_open_fn fs_open;                    /*!< Open file function callback */
     http_fs_read_fn fs_read;                    /*!< Read file function callback */
     http_fs_close_fn fs_close;                  /*!< Close file function callback */
+#if HTTP_RANGE_REQUESTS || __DOXYGEN__
+    http_fs_seek_fn fs_seek;                    /*!< Set file position function callback. Set to NULL if not used */
+#endif /* HTTP_RANGE_REQUESTS || __DOXYGEN__ */
+#if HTTP_FS_IMAGE || __DOXYGEN__
+    const void* fs_image;                       /*!< Packed file image, checked after user file system
+                                                    and before built-in static files. Set to NULL if not used */
+#endif /* HTTP_FS_IMAGE || __DOXYGEN__ */
+
+    /* WebSocket related */
+#if HTTP_WEBSOCKET || __DOXYGEN__
+    http_ws_connect_fn ws_connect_fn;           /*!< WebSocket upgrade request callback function */
+    http_ws_data_fn ws_data_fn;                 /*!< WebSocket data frame callback function */
+    http_ws_close_fn ws_close_fn;               /*!< WebSocket connection closed callback function. Set to NULL if not used */
+#endif /* HTTP_WEBSOCKET || __DOXYGEN__ */
 } http_init_t;
 
 /**
@@ -302,13 +626,36 @@ typedef enum {
     HTTP_SSI_STATE_END = 0x03,                  /*!< Parsing end of TAG */
 } http_ssi_state_t;
 
+/**
+ * \brief           Content type of response file
+ */
+typedef enum {
+    HTTP_CONTENT_TYPE_AUTO = 0x00,              /*!< Detect content type from file extension */
+    HTTP_CONTENT_TYPE_HTML,                     /*!< `text/html` */
+    HTTP_CONTENT_TYPE_PNG,                      /*!< `image/png` */
+    HTTP_CONTENT_TYPE_JPG,                      /*!< `image/jpeg` */
+    HTTP_CONTENT_TYPE_GIF,                      /*!< `image/gif` */
+    HTTP_CONTENT_TYPE_CSS,                      /*!< `text/css` */
+    HTTP_CONTENT_TYPE_JS,                       /*!< `text/javascript` */
+    HTTP_CONTENT_TYPE_ICO,                      /*!< `text/x-icon` */
+    HTTP_CONTENT_TYPE_XML,                      /*!< `text/xml` */
+    HTTP_CONTENT_TYPE_PLAIN,                    /*!< `text/plain` */
+} http_content_type_t;
+
 /**
  * \brief           HTTP file system table structure of static files in device memory
  */
 typedef struct {
     const char* path;                           /*!< File path, ex. "/index.html" */
     const void* data;                           /*!< Pointer to file data */
-    uint32_t size;                              /*!< Size of file in units of bytes */
+    uint32_t size;                              /*!< Size of file in units of bytes, including embedded headers */
+    uint32_t body_offset;                       /*!< Length of response headers embedded at the beginning of data,
+                                                    `0` if file has none. Headers are skipped when \ref HTTP_DYNAMIC_HEADERS is enabled */
+    http_content_type_t content_type;           /*!< Content type of file */
+#if HTTP_ETAG || __DOXYGEN__
+    const char* etag;                           /*!< Quoted entity tag of file content, such as `"5d41402a"`.
+                                                    Set to `NULL` if not used */
+#endif /* HTTP_ETAG || __DOXYGEN__ */
 } http_fs_file_table_t;
 
 /**
@@ -320,6 +667,14 @@ typedef struct http_fs_file {
 
     uint32_t size;                              /*!< Total length of file */
     uint32_t fptr;                              /*!< File pointer to indicate next read position */
+    http_content_type_t content_type;           /*!< Content type of file. File system may set it on open,
+                                                    otherwise it is detected from file extension */
+#if HTTP_RANGE_REQUESTS || __DOXYGEN__
+    uint32_t range_end;                         /*!< Position after last byte of requested range, `0` when reading to end of file */
+#endif /* HTTP_RANGE_REQUESTS || __DOXYGEN__ */
+#if HTTP_ETAG || __DOXYGEN__
+    const char* etag;                           /*!< Quoted entity tag of file content or `NULL` if not used */
+#endif /* HTTP_ETAG || __DOXYGEN__ */
 
     const uint16_t* rem_open_files;             /*!< Pointer to number of remaining open files.
                                                         User can use value on this pointer to get number of other opened files */
@@ -339,11 +694,15 @@ typedef struct http_state {
 
     http_req_method_t req_method;               /*!< Used request method */
     uint8_t headers_received;                   /*!< Did we fully received a headers? */
+    size_t headers_scan_pos;                    /*!< Position in `p` chain to continue search for end of headers */
     uint8_t process_resp;                       /*!< Process with response flag */
 
 #if HTTP_SUPPORT_POST || __DOXYGEN__
     uint32_t content_length;                    /*!< Total expected content length for request (on POST) (without headers) */
     uint32_t content_received;                  /*!< Content length received so far (POST request, without headers) */
+#if HTTP_POST_FLOW_CONTROL || __DOXYGEN__
+    esp_pbuf_p p_post;                          /*!< POST data not yet consumed by application and not acknowledged to stack */
+#endif /* HTTP_POST_FLOW_CONTROL || __DOXYGEN__ */
 #endif /* HTTP_SUPPORT_POST || __DOXYGEN__ */
 
     http_fs_file_t resp_file;                   /*!< Response file structure */
@@ -351,6 +710,10 @@ typedef struct http_state {
     const uint8_t* buff;                        /*!< Buffer pointer with data */
     uint32_t buff_len;                          /*!< Total length of buffer */
     uint32_t buff_ptr;                          /*!< Current buffer pointer */
+#if HTTP_FS_READ_AHEAD || __DOXYGEN__
+    const uint8_t* buff_next;                   /*!< Next block of file, read while current one is sent */
+    uint32_t buff_next_len;                     /*!< Length of next block */
+#endif /* HTTP_FS_READ_AHEAD || __DOXYGEN__ */
 
     void* arg;                                  /*!< User optional argument */
 
@@ -361,6 +724,13 @@ typedef struct http_state {
 #if HTTP_DYNAMIC_HEADERS_CONTENT_LEN || __DOXYGEN__
     char dyn_hdr_cnt_len[30];                   /*!< Content length header response: "Content-Length: 0123456789\r\n" */
 #endif /* HTTP_DYNAMIC_HEADERS_CONTENT_LEN || __DOXYGEN__ */
+#if HTTP_ETAG || __DOXYGEN__
+    char dyn_hdr_etag[HTTP_ETAG_MAX_LEN + sizeof("ETag: \r\nCache-Control: " HTTP_CACHE_CONTROL "\r\n")]; /*!< ETag and cache control headers */
+    uint8_t not_modified;                       /*!< Set to `1` when response is `304 Not Modified` without content */
+#endif /* HTTP_ETAG || __DOXYGEN__ */
+#if HTTP_RANGE_REQUESTS || __DOXYGEN__
+    char dyn_hdr_range[sizeof("Content-Range: bytes 4294967295-4294967295/4294967295\r\n")]; /*!< Content range header response */
+#endif /* HTTP_RANGE_REQUESTS || __DOXYGEN__ */
 #endif /* HTTP_DYNAMIC_HEADERS || __DOXYGEN__ */
 
     /* SSI tag parsing */
@@ -371,6 +741,40 @@ typedef struct http_state {
     size_t ssi_tag_buff_written;                /*!< Number of bytes written so far to output buffer in case tag is not valid */
     size_t ssi_tag_len;                         /*!< Length of SSI tag */
     size_t ssi_tag_process_more;                /*!< Set to `1` when we have to process tag multiple times */
+#if HTTP_SSI_HASH_SIZE > 0 || __DOXYGEN__
+    uint32_t ssi_tag_hash;                      /*!< Hash of tag name, calculated while tag is received */
+#endif /* HTTP_SSI_HASH_SIZE > 0 || __DOXYGEN__ */
+
+#if HTTP_KEEP_ALIVE || __DOXYGEN__
+    uint8_t keep_alive;                         /*!< Set to `1` when connection stays opened after response */
+    size_t req_len;                             /*!< Length of current request in `p` chain */
+    esp_pbuf_p p_next;                          /*!< Pipelined data received during current response */
+    uint32_t idle_time;                         /*!< Time in units of milliseconds without active request */
+#endif /* HTTP_KEEP_ALIVE || __DOXYGEN__ */
+
+#if HTTP_CHUNKED_ENCODING || __DOXYGEN__
+    uint8_t chunked;                            /*!< Set to `1` when response is sent with chunked transfer encoding */
+    uint8_t chunked_end;                        /*!< Set to `1` when last chunk was written */
+#endif /* HTTP_CHUNKED_ENCODING || __DOXYGEN__ */
+
+#if HTTP_GZIP_STATIC_FILES || __DOXYGEN__
+    uint8_t accept_gzip;                        /*!< Set to `1` when client accepts gzip encoding */
+    uint8_t is_gzip;                            /*!< Set to `1` when response file is gzip compressed */
+#endif /* HTTP_GZIP_STATIC_FILES || __DOXYGEN__ */
+
+#if HTTP_RESP_CACHE || __DOXYGEN__
+    struct http_cache_entry* cache_entry;       /*!< Cache entry response is served from or `NULL` */
+    uint8_t* cache_buff;                        /*!< Response being captured for cache or `NULL` */
+    size_t cache_buff_len;                      /*!< Number of bytes used in capture buffer */
+    size_t cache_buff_size;                     /*!< Size of capture buffer */
+    uint32_t cache_ttl;                         /*!< Time-to-live of captured response */
+    uint8_t cache_epoch;                        /*!< Invalidation counter when capture started */
+#endif /* HTTP_RESP_CACHE || __DOXYGEN__ */
+
+#if HTTP_WEBSOCKET || __DOXYGEN__
+    uint8_t ws;                                 /*!< Set to `1` when connection was upgraded to WebSocket */
+    uint8_t ws_closing;                         /*!< Set to `1` when close frame was sent */
+#endif /* HTTP_WEBSOCKET || __DOXYGEN__ */
 } http_state_t;
 
 /**
@@ -385,6 +789,16 @@ typedef struct http_state {
 
 espr_t      esp_http_server_init(const http_init_t* init, esp_port_t port);
 size_t      esp_http_server_write(http_state_t* hs, const void* data, size_t len);
+#if HTTP_POST_FLOW_CONTROL || __DOXYGEN__
+espr_t      esp_http_server_post_data_consumed(http_state_t* hs);
+#endif /* HTTP_POST_FLOW_CONTROL || __DOXYGEN__ */
+#if HTTP_RESP_CACHE || __DOXYGEN__
+espr_t      esp_http_server_cache_invalidate(const char* uri);
+#endif /* HTTP_RESP_CACHE || __DOXYGEN__ */
+#if HTTP_WEBSOCKET || __DOXYGEN__
+espr_t      esp_http_server_ws_write(http_state_t* hs, const void* data, size_t len, uint8_t binary);
+espr_t      esp_http_server_ws_close(http_state_t* hs);
+#endif /* HTTP_WEBSOCKET || __DOXYGEN__ */
 
 /**
  * \}
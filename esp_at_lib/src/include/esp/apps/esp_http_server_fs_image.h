@@ -0,0 +1,97 @@
+/**
+ * \file            esp_http_server_fs_image.h
+ * \brief           Packed read-only file image for HTTP server
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_HTTP_SERVER_FS_IMAGE_H
+#define ESP_HDR_HTTP_SERVER_FS_IMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "esp/apps/esp_http_server.h"
+
+/**
+ * \ingroup         ESP_APP_HTTP_SERVER
+ * \defgroup        ESP_APP_HTTP_SERVER_FS_IMAGE Packed file image
+ * \brief           Read-only file image in memory-mapped flash
+ *
+ * Image starts with \ref http_fs_image_hdr_t header, followed by `count` entries
+ * of \ref http_fs_image_entry_t type, sorted by ascending path hash.
+ * Paths, entity tags and file data may be placed anywhere after the index.
+ *
+ * All fields are little-endian, image must be aligned to `4` bytes.
+ * Offsets are relative to beginning of image.
+ *
+ * \{
+ */
+
+#define HTTP_FS_IMAGE_MAGIC                 0x49534645UL/*!< Image magic number, `EFSI` in memory */
+#define HTTP_FS_IMAGE_VERSION               1           /*!< Image format version */
+
+/**
+ * \brief           Packed file image header
+ */
+typedef struct {
+    uint32_t magic;                             /*!< Magic number, set to \ref HTTP_FS_IMAGE_MAGIC */
+    uint16_t version;                           /*!< Format version, set to \ref HTTP_FS_IMAGE_VERSION */
+    uint16_t count;                             /*!< Number of entries in index */
+    uint32_t size;                              /*!< Total size of image in units of bytes, including header */
+} http_fs_image_hdr_t;
+
+/**
+ * \brief           Packed file image index entry
+ */
+typedef struct {
+    uint32_t hash;                              /*!< Path hash, calculated with \ref http_fs_image_hash */
+    uint32_t path_offset;                       /*!< Offset of `NULL` terminated file path, ex. `/index.html` */
+    uint32_t data_offset;                       /*!< Offset of file data */
+    uint32_t size;                              /*!< Size of file in units of bytes, including embedded headers */
+    uint32_t body_offset;                       /*!< Length of response headers embedded at the beginning of data, `0` if file has none */
+    uint32_t etag_offset;                       /*!< Offset of `NULL` terminated quoted entity tag, `0` if not used */
+    uint8_t content_type;                       /*!< Content type of file, member of \ref http_content_type_t */
+    uint8_t reserved[3];                        /*!< Reserved, set to `0` */
+} http_fs_image_entry_t;
+
+uint32_t    http_fs_image_hash(const char* path);
+uint8_t     http_fs_image_check(const void* image);
+const http_fs_image_entry_t*    http_fs_image_find(const void* image, const char* path);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+};
+#endif /* __cplusplus */
+
+#endif /* ESP_HDR_HTTP_SERVER_FS_IMAGE_H */
@@ -160,6 +160,10 @@ typedef struct {
             size_t topic_len;                   /*!< Length of topic */
             const void* payload;                /*!< Topic payload */
             size_t payload_len;                 /*!< Length of topic payload */
+#if ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__
+            size_t payload_offset;              /*!< Offset of current payload chunk in entire packet payload */
+            size_t payload_total_len;           /*!< Total length of packet payload */
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__ */
             uint8_t dup;                        /*!< Duplicate flag if message was sent again */
             esp_mqtt_qos_t qos;                 /*!< Received packet quality of service */
         } publish_recv;                         /*!< Publish received event */
@@ -173,6 +177,47 @@ typedef struct {
  */
 typedef void        (*esp_mqtt_evt_fn)(esp_mqtt_client_p client, esp_mqtt_evt_t* evt);
 
+/**
+ * \brief           MQTT topic handler callback function
+ * \param[in]       client: MQTT client
+ * \param[in]       evt: \ref ESP_MQTT_EVT_PUBLISH_RECV event with received packet
+ * \param[in]       arg: User argument set when handler was added
+ */
+typedef void        (*esp_mqtt_topic_fn)(esp_mqtt_client_p client, esp_mqtt_evt_t* evt, void* arg);
+
+#if ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__
+
+/**
+ * \brief           User storage for MQTT offline queue
+ *
+ * Storage keeps records in first-in first-out order.
+ * Record content is created by MQTT client and must be returned unmodified
+ */
+typedef struct {
+    uint8_t (*push)(void* arg, const void* data, size_t len);   /*!< Add record to the end of storage.
+                                                                    Return `1` on success or `0` if storage is full */
+    size_t  (*peek)(void* arg, void* data, size_t len);         /*!< Copy oldest record to `data` if `len` is big enough.
+                                                                    Return record length or `0` if storage is empty */
+    void    (*pop)(void* arg);                                  /*!< Remove oldest record from storage */
+    void* arg;                                                  /*!< User argument for storage functions */
+} esp_mqtt_offline_store_t;
+
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_STATS || __DOXYGEN__
+
+/**
+ * \brief           MQTT client keep-alive statistics
+ */
+typedef struct {
+    uint32_t pingreq_sent;                      /*!< Number of `PINGREQ` packets sent to server */
+    uint32_t pingresp_recv;                     /*!< Number of `PINGRESP` packets received from server */
+    uint32_t pingreq_suppressed;                /*!< Number of times keep-alive expired while other packet was being sent,
+                                                    where `PINGREQ` was not needed */
+} esp_mqtt_client_stats_t;
+
+#endif /* ESP_CFG_MQTT_STATS || __DOXYGEN__ */
+
 esp_mqtt_client_p   esp_mqtt_client_new(size_t tx_buff_len, size_t rx_buff_len);
 void                esp_mqtt_client_delete(esp_mqtt_client_p client);
 
@@ -184,10 +229,30 @@ espr_t              esp_mqtt_client_subscribe(esp_mqtt_client_p client, const ch
 espr_t              esp_mqtt_client_unsubscribe(esp_mqtt_client_p client, const char* topic, void* arg);
 
 espr_t              esp_mqtt_client_publish(esp_mqtt_client_p client, const char* topic, const void* payload, uint16_t len, esp_mqtt_qos_t qos, uint8_t retain, void* arg);
+#if ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__
+espr_t              esp_mqtt_client_publish_ref(esp_mqtt_client_p client, const char* topic, const void* payload, uint16_t len, esp_mqtt_qos_t qos, uint8_t retain, esp_conn_release_fn release_fn, void* arg);
+#endif /* ESP_CFG_MQTT_PUBLISH_REF || __DOXYGEN__ */
 
 void*               esp_mqtt_client_get_arg(esp_mqtt_client_p client);
 void                esp_mqtt_client_set_arg(esp_mqtt_client_p client, void* arg);
 
+#if ESP_CFG_MQTT_QOS0_FAST || __DOXYGEN__
+espr_t              esp_mqtt_client_set_qos0_fast(esp_mqtt_client_p client, uint8_t en);
+#endif /* ESP_CFG_MQTT_QOS0_FAST || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__
+espr_t              esp_mqtt_client_set_offline_queue(esp_mqtt_client_p client, uint8_t en, const esp_mqtt_offline_store_t* store);
+#endif /* ESP_CFG_MQTT_OFFLINE_QUEUE || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_STATS || __DOXYGEN__
+espr_t              esp_mqtt_client_get_stats(esp_mqtt_client_p client, esp_mqtt_client_stats_t* stats);
+#endif /* ESP_CFG_MQTT_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__
+espr_t              esp_mqtt_client_topic_handler_add(esp_mqtt_client_p client, const char* filter, esp_mqtt_topic_fn fn, void* arg);
+espr_t              esp_mqtt_client_topic_handler_remove(esp_mqtt_client_p client, const char* filter);
+#endif /* ESP_CFG_MQTT_TOPIC_TRIE || __DOXYGEN__ */
+
 /**
  * \}
  */
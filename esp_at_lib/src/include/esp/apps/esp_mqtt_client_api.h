@@ -62,6 +62,13 @@ typedef struct esp_mqtt_client_api_buf {
     uint8_t* payload;                           /*!< Payload data */
     size_t payload_len;                         /*!< Payload length */
     esp_mqtt_qos_t qos;                         /*!< Quality of service */
+#if ESP_CFG_MQTT_API_RX_SLOTS > 0 || __DOXYGEN__
+    uint8_t is_slot;                            /*!< Private use. Set to `1` when buffer is part of preallocated receive slots */
+    volatile uint8_t in_use;                    /*!< Private use. Set to `1` when receive slot is in use */
+#endif /* ESP_CFG_MQTT_API_RX_SLOTS > 0 || __DOXYGEN__ */
+#if ESP_CFG_MQTT_API_GROUP || __DOXYGEN__
+    struct esp_mqtt_client_api* client;         /*!< Client which received the packet */
+#endif /* ESP_CFG_MQTT_API_GROUP || __DOXYGEN__ */
 } esp_mqtt_client_api_buf_t;
 
 /**
@@ -74,6 +81,15 @@ typedef struct esp_mqtt_client_api* esp_mqtt_client_api_p;
  */
 typedef struct esp_mqtt_client_api_buf* esp_mqtt_client_api_buf_p;
 
+#if ESP_CFG_MQTT_API_GROUP || __DOXYGEN__
+
+/**
+ * \brief           Pointer to \ref esp_mqtt_client_api_group structure
+ */
+typedef struct esp_mqtt_client_api_group* esp_mqtt_client_api_group_p;
+
+#endif /* ESP_CFG_MQTT_API_GROUP || __DOXYGEN__ */
+
 esp_mqtt_client_api_p   esp_mqtt_client_api_new(size_t tx_buff_len, size_t rx_buff_len);
 void                    esp_mqtt_client_api_delete(esp_mqtt_client_api_p client);
 esp_mqtt_conn_status_t  esp_mqtt_client_api_connect(esp_mqtt_client_api_p client, const char* host, esp_port_t port, const esp_mqtt_client_info_t* info);
@@ -85,6 +101,13 @@ uint8_t                 esp_mqtt_client_api_is_connected(esp_mqtt_client_api_p c
 espr_t                  esp_mqtt_client_api_receive(esp_mqtt_client_api_p client, esp_mqtt_client_api_buf_p* p, uint32_t timeout);
 void                    esp_mqtt_client_api_buf_free(esp_mqtt_client_api_buf_p p);
 
+#if ESP_CFG_MQTT_API_GROUP || __DOXYGEN__
+esp_mqtt_client_api_group_p esp_mqtt_client_api_group_new(size_t queue_len);
+void                    esp_mqtt_client_api_group_delete(esp_mqtt_client_api_group_p grp);
+espr_t                  esp_mqtt_client_api_set_group(esp_mqtt_client_api_p client, esp_mqtt_client_api_group_p grp);
+espr_t                  esp_mqtt_client_api_receive_any(esp_mqtt_client_api_group_p grp, esp_mqtt_client_api_p* client, esp_mqtt_client_api_buf_p* p, uint32_t timeout);
+#endif /* ESP_CFG_MQTT_API_GROUP || __DOXYGEN__ */
+
 /**
  * \}
  */
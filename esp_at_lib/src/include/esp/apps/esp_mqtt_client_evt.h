@@ -190,6 +190,37 @@ extern "C" {
  */
 #define esp_mqtt_client_evt_publish_recv_get_payload_len(client, evt)   (ESP_SZ((evt)->evt.publish_recv.payload_len))
 
+#if ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__
+
+/**
+ * \brief           Get offset of current payload chunk in entire packet payload
+ * \param[in]       client: MQTT client
+ * \param[in]       evt: Event handle
+ * \return          Payload chunk offset
+ * \hideinitializer
+ */
+#define esp_mqtt_client_evt_publish_recv_get_payload_offset(client, evt)    (ESP_SZ((evt)->evt.publish_recv.payload_offset))
+
+/**
+ * \brief           Get total payload length of received publish packet
+ * \param[in]       client: MQTT client
+ * \param[in]       evt: Event handle
+ * \return          Total payload length
+ * \hideinitializer
+ */
+#define esp_mqtt_client_evt_publish_recv_get_payload_total_len(client, evt) (ESP_SZ((evt)->evt.publish_recv.payload_total_len))
+
+/**
+ * \brief           Check if current payload chunk is last for packet
+ * \param[in]       client: MQTT client
+ * \param[in]       evt: Event handle
+ * \return          `1` if last chunk, `0` otherwise
+ * \hideinitializer
+ */
+#define esp_mqtt_client_evt_publish_recv_is_last(client, evt)       (ESP_U8(((evt)->evt.publish_recv.payload_offset + (evt)->evt.publish_recv.payload_len) == (evt)->evt.publish_recv.payload_total_len))
+
+#endif /* ESP_CFG_MQTT_PUBLISH_STREAM || __DOXYGEN__ */
+
 /**
  * \brief           Check if packet is duplicated
  * \param[in]       client: MQTT client
@@ -62,9 +62,55 @@ espr_t      esp_update_sw(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg,
 espr_t      esp_core_lock(void);
 espr_t      esp_core_unlock(void);
 
+#if !ESP_CFG_OS || __DOXYGEN__
+void        esp_poll(void);
+#endif /* !ESP_CFG_OS || __DOXYGEN__ */
+
 espr_t      esp_device_set_present(uint8_t present, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 uint8_t     esp_device_is_present(void);
 
+#if ESP_CFG_CMD_BATCH || __DOXYGEN__
+espr_t      esp_cmd_batch_begin(esp_cmd_batch_t* batch);
+espr_t      esp_cmd_batch_commit(esp_cmd_batch_t* batch, const uint32_t blocking);
+#endif /* ESP_CFG_CMD_BATCH || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_CANCEL || __DOXYGEN__
+espr_t      esp_cmd_cancel(const void* const evt_arg);
+#endif /* ESP_CFG_CMD_CANCEL || __DOXYGEN__ */
+
+espr_t      esp_io_stats_get(esp_io_stats_t* stats);
+void        esp_io_stats_reset(void);
+
+#if ESP_CFG_CMD_STATS || __DOXYGEN__
+size_t      esp_cmd_stats_get_count(void);
+espr_t      esp_cmd_stats_get(size_t cmd, esp_cmd_stats_t* stats);
+void        esp_cmd_stats_reset(void);
+#endif /* ESP_CFG_CMD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+espr_t      esp_trace_get(esp_trace_stage_t stage, esp_trace_stats_t* stats);
+void        esp_trace_reset(void);
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+espr_t      esp_thread_stats_get(esp_thread_type_t thread, esp_thread_stats_t* stats);
+void        esp_thread_stats_reset(void);
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_TELEMETRY_INTERVAL > 0 || __DOXYGEN__
+espr_t      esp_telemetry_get(esp_telemetry_t* telemetry);
+void        esp_telemetry_reset(void);
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__
+espr_t      esp_recv_line_register(const char* prefix, esp_recv_line_fn fn, void* arg);
+espr_t      esp_recv_line_unregister(esp_recv_line_fn fn);
+#endif /* ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__
+espr_t      esp_set_ipd_alloc_fn(esp_ipd_alloc_fn fn);
+#endif /* ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__ */
+
 uint8_t     esp_device_is_esp8266(void);
 uint8_t     esp_device_is_esp32(void);
 
@@ -0,0 +1,86 @@
+/**
+ * \file            esp_async.h
+ * \brief           Completion tokens for asynchronous API calls
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_ASYNC_H
+#define ESP_HDR_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP
+ * \defgroup        ESP_ASYNC Completion tokens
+ * \brief           Completion tokens for asynchronous API calls
+ *
+ * Token replaces callback, argument and blocking parameters of any API function.
+ * Command is started non-blocking and token is later checked for completion,
+ * which fits coroutines, protothreads and super-loop state machines.
+ *
+ * \code{c}
+esp_async_t tok;
+
+esp_async_submit(&tok, esp_sta_join("ssid", "pass", NULL, 0, ESP_ASYNC(&tok)));
+while (!esp_async_is_done(&tok)) {
+    yield();
+}
+res = esp_async_get_result(&tok);
+\endcode
+ * \{
+ */
+
+/**
+ * \brief           Expand to callback, argument and blocking parameters of API function
+ * \param[in]       tok: Pointer to \ref esp_async_t token, reset before command is sent
+ * \hideinitializer
+ */
+#define ESP_ASYNC(tok)                      esp_async_evt_fn, esp_async_start(tok), 0
+
+void        esp_async_init(esp_async_t* tok, esp_api_cmd_evt_fn fn, void* arg);
+void*       esp_async_start(esp_async_t* tok);
+void        esp_async_evt_fn(espr_t res, void* arg);
+espr_t      esp_async_submit(esp_async_t* tok, espr_t res);
+uint8_t     esp_async_is_done(const esp_async_t* tok);
+espr_t      esp_async_get_result(const esp_async_t* tok);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HDR_ASYNC_H */
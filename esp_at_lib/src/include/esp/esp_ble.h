@@ -0,0 +1,73 @@
+/**
+ * \file            esp_ble.h
+ * \brief           BLE data channel of ESP32 AT firmware
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_BLE_H
+#define ESP_HDR_BLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP
+ * \defgroup        ESP_BLE BLE data channel
+ * \brief           Data exchange with BLE client over GATT server of ESP32 device
+ *
+ * Client writes data to any characteristic of \ref ESP_CFG_BLE_SRV_INDEX service,
+ * they are reported with \ref ESP_EVT_BLE_RECV event in packet buffer.
+ * Data to client are sent as notifications of \ref ESP_CFG_BLE_NTFY_CHAR_INDEX characteristic.
+ * Client connection changes are reported with \ref ESP_EVT_BLE_CONN event.
+ *
+ * Device does not advertise after client disconnects,
+ * use \ref esp_ble_adv_start to accept next client
+ *
+ * \{
+ */
+
+espr_t      esp_ble_start(const char* name, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_ble_stop(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_ble_adv_start(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_ble_send(uint8_t conn, const void* data, size_t len, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+uint8_t     esp_ble_is_connected(uint8_t conn);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HDR_BLE_H */
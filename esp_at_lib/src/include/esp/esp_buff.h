@@ -76,12 +76,17 @@ size_t      BUF_PREF(buff_get_full)(BUF_PREF(buff_t)* buff);
 void *      BUF_PREF(buff_get_linear_block_read_address)(BUF_PREF(buff_t)* buff);
 size_t      BUF_PREF(buff_get_linear_block_read_length)(BUF_PREF(buff_t)* buff);
 size_t      BUF_PREF(buff_skip)(BUF_PREF(buff_t)* buff, size_t len);
+size_t      BUF_PREF(buff_get_read_blocks)(BUF_PREF(buff_t)* buff, BUF_PREF(buff_block_t)* blocks);
 
 /* Write data block management */
 void *      BUF_PREF(buff_get_linear_block_write_address)(BUF_PREF(buff_t)* buff);
 size_t      BUF_PREF(buff_get_linear_block_write_length)(BUF_PREF(buff_t)* buff);
 size_t      BUF_PREF(buff_advance)(BUF_PREF(buff_t)* buff, size_t len);
 
+/* Batch write management */
+void *      BUF_PREF(buff_write_reserve)(BUF_PREF(buff_t)* buff, size_t* len);
+size_t      BUF_PREF(buff_write_commit)(BUF_PREF(buff_t)* buff, size_t len);
+
 #undef BUF_PREF         /* Prefix not needed anymore */
 
 /**
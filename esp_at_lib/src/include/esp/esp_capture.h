@@ -0,0 +1,85 @@
+/**
+ * \file            esp_capture.h
+ * \brief           AT stream capture
+ */
+
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_CAPTURE_H
+#define ESP_HDR_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP
+ * \defgroup        ESP_CAPTURE AT stream capture
+ * \brief           Timestamped record of data exchanged with device
+ *
+ * Data received from and sent to device are written to RAM ring buffer.
+ * When buffer is full, oldest records are overwritten,
+ * buffer therefore always keeps latest traffic before a problem.
+ *
+ * Every record starts with \ref ESP_CAPTURE_HDR_LEN bytes long header:
+ *
+ *  - `4` bytes: Time of record from \ref esp_sys_now, little endian
+ *  - `2` bytes: Length of data, little endian, at most \ref ESP_CAPTURE_REC_MAX_LEN
+ *  - `1` byte: Direction, \ref ESP_CAPTURE_DIR_RX or \ref ESP_CAPTURE_DIR_TX
+ *  - `1` byte: Reserved, set to `0`
+ *
+ * Data bytes follow the header. Records read with \ref esp_capture_read
+ * can be written to file and replayed later with \ref ESP_LL_REPLAY backend.
+ *
+ * \note            Received data are recorded when processing thread takes them from input buffer
+ * \{
+ */
+
+#define ESP_CAPTURE_HDR_LEN                 8   /*!< Length of record header in units of bytes */
+#define ESP_CAPTURE_REC_MAX_LEN             256 /*!< Maximal data length of single record, longer data are split */
+#define ESP_CAPTURE_DIR_RX                  0x01/*!< Record of data received from device */
+#define ESP_CAPTURE_DIR_TX                  0x02/*!< Record of data sent to device */
+
+void        esp_capture_enable(uint8_t en);
+size_t      esp_capture_read(void* data, size_t len);
+void        esp_capture_clear(void);
+uint32_t    esp_capture_get_lost(void);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* ESP_HDR_CAPTURE_H */
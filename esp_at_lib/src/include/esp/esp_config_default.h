@@ -60,7 +60,13 @@
 /**
  * \brief           Enables `1` or disables `0` operating system support for ESP library
  *
- * \note            Value must be set to `1` in the current revision
+ * When disabled, library does not create any threads.
+ * Application must periodically call \ref esp_poll from main loop,
+ * which processes received data, timeouts and commands without blocking.
+ * All API functions must be called in non-blocking mode, with callbacks to get results.
+ *
+ * \note            Without operating system, system port only needs to provide
+ *                  time, protection and non-blocking message queue functions
  *
  * \note            Check \ref ESP_CONFIG_OS group for more configuration related to operating system
  *
@@ -69,6 +75,90 @@
 #define ESP_CFG_OS                          1
 #endif
 
+#define ESP_CFG_PROFILE_NONE                0   /*!< No profile, every parameter uses its own default */
+#define ESP_CFG_PROFILE_THROUGHPUT          1   /*!< Large receive buffers and queues for bulk transfers */
+#define ESP_CFG_PROFILE_LOW_MEMORY          2   /*!< Small data chunks, buffers and queues */
+#define ESP_CFG_PROFILE_LOW_POWER           3   /*!< Light-sleep support and rare periodic activity */
+
+/**
+ * \brief           Configuration profile with coordinated buffer, queue and timing parameters
+ *
+ * Profile only changes default values, every parameter set in `esp_config.h` keeps its value.
+ * With profile selected, combinations known to overflow receive buffer
+ * or to keep device awake are rejected at compile time.
+ *
+ * Set to one of `ESP_CFG_PROFILE_*` values
+ */
+#ifndef ESP_CFG_PROFILE
+#define ESP_CFG_PROFILE                     ESP_CFG_PROFILE_NONE
+#endif
+
+#if !__DOXYGEN__
+#if ESP_CFG_PROFILE == ESP_CFG_PROFILE_THROUGHPUT
+#ifndef ESP_CFG_CONN_MAX_DATA_LEN
+#define ESP_CFG_CONN_MAX_DATA_LEN           2048
+#endif
+#ifndef ESP_CFG_IPD_MAX_BUFF_SIZE
+#define ESP_CFG_IPD_MAX_BUFF_SIZE           1460
+#endif
+#ifndef ESP_CFG_RCV_BUFF_SIZE
+#define ESP_CFG_RCV_BUFF_SIZE               0x1000
+#endif
+#ifndef ESP_CFG_RCV_BUFF_COMMIT_LEN
+#define ESP_CFG_RCV_BUFF_COMMIT_LEN         0x200
+#endif
+#ifndef ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN
+#define ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN   16
+#endif
+#elif ESP_CFG_PROFILE == ESP_CFG_PROFILE_LOW_MEMORY
+#ifndef ESP_CFG_CONN_MAX_DATA_LEN
+#define ESP_CFG_CONN_MAX_DATA_LEN           512
+#endif
+#ifndef ESP_CFG_IPD_MAX_BUFF_SIZE
+#define ESP_CFG_IPD_MAX_BUFF_SIZE           536
+#endif
+#ifndef ESP_CFG_RCV_BUFF_SIZE
+#define ESP_CFG_RCV_BUFF_SIZE               0x300
+#endif
+#ifndef ESP_CFG_RCV_BUFF_COMMIT_LEN
+#define ESP_CFG_RCV_BUFF_COMMIT_LEN         0x80
+#endif
+#ifndef ESP_CFG_THREAD_PRODUCER_MBOX_SIZE
+#define ESP_CFG_THREAD_PRODUCER_MBOX_SIZE   4
+#endif
+#ifndef ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE
+#define ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE   2
+#endif
+#ifndef ESP_CFG_THREAD_PROCESS_MBOX_SIZE
+#define ESP_CFG_THREAD_PROCESS_MBOX_SIZE    4
+#endif
+#ifndef ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN
+#define ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN   4
+#endif
+#ifndef ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN
+#define ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN    2
+#endif
+#ifndef ESP_CFG_CONN_SEND_QUEUE_LEN
+#define ESP_CFG_CONN_SEND_QUEUE_LEN         2
+#endif
+#elif ESP_CFG_PROFILE == ESP_CFG_PROFILE_LOW_POWER
+#ifndef ESP_CFG_SLEEP
+#define ESP_CFG_SLEEP                       1
+#endif
+#ifndef ESP_CFG_SLEEP_IDLE_TIME
+#define ESP_CFG_SLEEP_IDLE_TIME             100
+#endif
+#ifndef ESP_CFG_CONN_POLL_INTERVAL
+#define ESP_CFG_CONN_POLL_INTERVAL          2000
+#endif
+#ifndef ESP_CFG_RCV_BUFF_SIZE
+#define ESP_CFG_RCV_BUFF_SIZE               0xC00
+#endif
+#elif ESP_CFG_PROFILE != ESP_CFG_PROFILE_NONE
+#error "ESP_CFG_PROFILE must be one of ESP_CFG_PROFILE_* values!"
+#endif /* ESP_CFG_PROFILE == ESP_CFG_PROFILE_THROUGHPUT */
+#endif /* !__DOXYGEN__ */
+
 /**
  * \brief           Default system port implementation
  *
@@ -98,6 +188,94 @@
 #define ESP_CFG_MEM_CUSTOM                  0
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` two-level segregated fit (TLSF) memory allocator
+ *
+ * When enabled, built-in memory manager uses segregated free lists
+ * with bitmaps instead of single first-fit list.
+ * Allocation and free operations are done in constant time
+ * regardless of number of free blocks and fragmentation.
+ *
+ * \note            Has no effect when \ref ESP_CFG_MEM_CUSTOM is enabled
+ * \note            Memory is assigned with \ref esp_mem_assignmemory in both cases
+ */
+#ifndef ESP_CFG_MEM_TLSF
+#define ESP_CFG_MEM_TLSF                    0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` memory manager statistics
+ *
+ * When enabled, \ref esp_mem_get_stats reports free memory, its minimum since startup,
+ * largest free block and number of bytes allocated per subsystem
+ *
+ * \note            Has no effect when \ref ESP_CFG_MEM_CUSTOM is enabled
+ */
+#ifndef ESP_CFG_MEM_STATS
+#define ESP_CFG_MEM_STATS                   0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` allocation profiler with call-site attribution
+ *
+ * When enabled, allocation functions record file and line of caller,
+ * allocated size and lifetime of every block.
+ * Top allocators by number of allocations or bytes are available with \ref esp_mem_profile_get_sites
+ * and distribution of free block sizes with \ref esp_mem_profile_get_frag
+ *
+ * \note            Intended for debug builds, every block header is extended with site index and timestamp
+ * \note            Requires \ref ESP_CFG_MEM_STATS, has no effect when \ref ESP_CFG_MEM_CUSTOM is enabled
+ * \sa              ESP_CFG_MEM_PROFILE_SITES, ESP_CFG_MEM_PROFILE_SHORT_LIVED
+ */
+#ifndef ESP_CFG_MEM_PROFILE
+#define ESP_CFG_MEM_PROFILE                 0
+#endif
+
+/**
+ * \brief           Maximal number of distinct call sites tracked by allocation profiler
+ *
+ * Allocations from sites not fitting in table are accounted to last entry without file name
+ *
+ * \note            Used only when \ref ESP_CFG_MEM_PROFILE is enabled
+ */
+#ifndef ESP_CFG_MEM_PROFILE_SITES
+#define ESP_CFG_MEM_PROFILE_SITES           32
+#endif
+
+/**
+ * \brief           Lifetime in units of milliseconds under which freed block is counted as short-lived
+ *
+ * \note            Used only when \ref ESP_CFG_MEM_PROFILE is enabled
+ */
+#ifndef ESP_CFG_MEM_PROFILE_SHORT_LIVED
+#define ESP_CFG_MEM_PROFILE_SHORT_LIVED     100
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` placement classes of memory regions
+ *
+ * When enabled, every region assigned with \ref esp_mem_assignmemory has placement class,
+ * fast (internal SRAM or DTCM, default) or bulk (external SDRAM).
+ * Command messages and small blocks are allocated from fast regions,
+ * connection, HTTP and MQTT buffers and other large blocks from bulk regions.
+ * When preferred class has no suitable free block, any other region is used.
+ *
+ * \note            Has no effect when \ref ESP_CFG_MEM_CUSTOM is enabled
+ * \sa              ESP_CFG_MEM_CLASS_FAST_MAX_SIZE
+ */
+#ifndef ESP_CFG_MEM_REGION_CLASS
+#define ESP_CFG_MEM_REGION_CLASS            0
+#endif
+
+/**
+ * \brief           Largest packet buffer or untagged allocation, in units of bytes, placed in fast memory
+ *
+ * \note            Used only when \ref ESP_CFG_MEM_REGION_CLASS is enabled
+ */
+#ifndef ESP_CFG_MEM_CLASS_FAST_MAX_SIZE
+#define ESP_CFG_MEM_CLASS_FAST_MAX_SIZE     256
+#endif
+
 /**
  * \brief           Memory alignment for dynamic memory allocations
  *
@@ -123,12 +301,45 @@
 #define ESP_CFG_USE_API_FUNC_EVT            1
 #endif
 
+/**
+ * \brief           Enables `1` or disables `0` completion tokens for API functions
+ *
+ * When enabled, \ref esp_async_t token can be passed to any API function with \ref ESP_ASYNC macro
+ * in place of callback, argument and blocking parameters.
+ * Token is later polled for result, which is useful for coroutines and state machines.
+ *
+ * \note            Requires \ref ESP_CFG_USE_API_FUNC_EVT to be enabled
+ */
+#ifndef ESP_CFG_ASYNC
+#define ESP_CFG_ASYNC                       0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` single connection build
+ *
+ * When enabled, device is operated with `AT+CIPMUX=0` and stack supports only one connection.
+ * Link ID is neither sent in `AT+CIPSTART`, `AT+CIPSEND` and `AT+CIPCLOSE` commands,
+ * nor parsed from `+IPD` and connection status lines, which shortens command framing.
+ *
+ * \note            Server mode is not available, as it requires multiple connections on device
+ * \note            \ref ESP_CFG_MAX_CONNS defaults to `1` and must not be changed
+ */
+#ifndef ESP_CFG_SINGLE_CONN
+#define ESP_CFG_SINGLE_CONN                 0
+#endif
+
 /**
  * \brief           Maximal number of connections AT software can support on ESP device
- * \note            In case of official AT software, leave this on default value (`5`)
+ * \note            In case of official AT software, leave this on default value (`5`).
+ *                  Value up to `32` is supported, for AT software built with more links
+ * \note            Defaults to `1` when \ref ESP_CFG_SINGLE_CONN is enabled
  */
 #ifndef ESP_CFG_MAX_CONNS
+#if ESP_CFG_SINGLE_CONN
+#define ESP_CFG_MAX_CONNS                   1
+#else /* ESP_CFG_SINGLE_CONN */
 #define ESP_CFG_MAX_CONNS                   5
+#endif /* !ESP_CFG_SINGLE_CONN */
 #endif
 
 /**
@@ -156,248 +367,1759 @@
 #endif
 
 /**
- * \brief           Maximum single buffer size for network receive data (TCP/UDP connections)
+ * \brief           Enables `1` or disables `0` pipelined send of network data
  *
- * \note            When ESP sends buffer buffer than maximal, multiple buffers are created
+ * When enabled and data are longer than \ref ESP_CFG_CONN_MAX_DATA_LEN,
+ * `AT+CIPSEND` command for next segment is sent as soon as device reports `Recv x bytes`
+ * for current segment, without waiting for `SEND OK`.
+ *
+ * \note            Feature requires AT firmware which accepts new command
+ *                  while previous data are still being sent (ESP32 AT firmware).
+ *                  If command is rejected with `busy` response, segment is sent normally.
+ *
+ * \note            When sending fails while next segment is already in progress,
+ *                  send operation finishes with error and retries are not used.
+ *                  Already started segment is completed first to keep device in sync
  */
-#ifndef ESP_CFG_IPD_MAX_BUFF_SIZE
-#define ESP_CFG_IPD_MAX_BUFF_SIZE           1460
+#ifndef ESP_CFG_CONN_SEND_PIPELINE
+#define ESP_CFG_CONN_SEND_PIPELINE          0
 #endif
 
 /**
- * \brief           Default baudrate used for AT port
+ * \brief           Enables `1` or disables `0` adaptive send pacing per connection
  *
- * \note            User may call API function to change to desired baudrate if necessary
+ * When device reports `SEND FAIL` or `busy` while sending, segment is sent again
+ * only after retry delay, which doubles on every consecutive failure.
+ * Segment length of TCP and SSL connections is halved on failure
+ * and grows by \ref ESP_CFG_CONN_SEND_PACING_INC bytes on every successful segment.
+ *
+ * Current segment length and retry delay are reported by \ref esp_conn_get_stats
+ *
+ * \sa              ESP_CFG_CONN_SEND_PACING_MIN_LEN, ESP_CFG_CONN_SEND_PACING_BACKOFF, ESP_CFG_CONN_SEND_PACING_BACKOFF_MAX
  */
-#ifndef ESP_CFG_AT_PORT_BAUDRATE
-#define ESP_CFG_AT_PORT_BAUDRATE            115200
+#ifndef ESP_CFG_CONN_SEND_PACING
+#define ESP_CFG_CONN_SEND_PACING            0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` ESP acting as station
+ * \brief           Minimal segment length in units of bytes for send pacing
+ */
+#ifndef ESP_CFG_CONN_SEND_PACING_MIN_LEN
+#define ESP_CFG_CONN_SEND_PACING_MIN_LEN    128
+#endif
+
+/**
+ * \brief           Segment length increase in units of bytes after successful segment
+ */
+#ifndef ESP_CFG_CONN_SEND_PACING_INC
+#define ESP_CFG_CONN_SEND_PACING_INC        256
+#endif
+
+/**
+ * \brief           Retry delay in units of milliseconds after first failed segment
+ */
+#ifndef ESP_CFG_CONN_SEND_PACING_BACKOFF
+#define ESP_CFG_CONN_SEND_PACING_BACKOFF    10
+#endif
+
+/**
+ * \brief           Maximal retry delay in units of milliseconds for send pacing
+ */
+#ifndef ESP_CFG_CONN_SEND_PACING_BACKOFF_MAX
+#define ESP_CFG_CONN_SEND_PACING_BACKOFF_MAX    1000
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` automatic flush of connection write buffer
  *
- * \note            When device is in station mode, it can connect to other access points
+ * Data written with \ref esp_conn_write without flush flag are sent
+ * once linger time expires after first byte was written to empty buffer,
+ * or earlier when previous send on connection finishes successfully.
+ * Small writes are coalesced to single `AT+CIPSEND` command without waiting forever.
+ *
+ * Linger time is set per connection with \ref esp_conn_set_write_linger
+ *
+ * \sa              ESP_CFG_CONN_WRITE_LINGER_TIME
  */
-#ifndef ESP_CFG_MODE_STATION
-#define ESP_CFG_MODE_STATION                1
+#ifndef ESP_CFG_CONN_WRITE_LINGER
+#define ESP_CFG_CONN_WRITE_LINGER           0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` ESP acting as access point
+ * \brief           Default write buffer linger time in units of milliseconds
  *
- * \note            When device is in access point mode, it can accept connections from other stations
+ * Value is applied every time connection becomes active. Set to `0` to disable
+ * automatic flush until enabled for connection with \ref esp_conn_set_write_linger
+ *
+ * \note            Used only when \ref ESP_CFG_CONN_WRITE_LINGER is enabled
  */
-#ifndef ESP_CFG_MODE_ACCESS_POINT
-#define ESP_CFG_MODE_ACCESS_POINT           1
+#ifndef ESP_CFG_CONN_WRITE_LINGER_TIME
+#define ESP_CFG_CONN_WRITE_LINGER_TIME      20
 #endif
 
 /**
- * \brief           Buffer size for received data waiting to be processed
- * \note            When server mode is active and a lot of connections are in queue
- *                  this should be set high otherwise your buffer may overflow
+ * \brief           Enables `1` or disables `0` per connection send queues
  *
- * \note            Buffer size also depends on TX user driver if it uses DMA or blocking mode.
- *                  In case of DMA (CPU can work other tasks), buffer may be smaller as CPU
- *                  will have more time to process all the incoming bytes
+ * When enabled, send commands do not occupy producer message queue entries.
+ * They are linked to queue of their connection instead, and producing thread
+ * takes them in round-robin order between connections, interleaved with other commands.
+ * Connection may take more commands per turn, set with \ref esp_conn_set_send_weight.
+ * Number of queued send commands is limited only by available memory,
+ * non-blocking send no longer fails when producer message queue is full.
  *
- * \note            This parameter has no meaning when \ref ESP_CFG_INPUT_USE_PROCESS is enabled
+ * When connection has more than \ref ESP_CFG_CONN_SEND_QUEUE_LEN commands queued,
+ * writing thread waits until producing thread takes one of them
+ *
+ * \sa              ESP_CFG_CONN_SEND_QUEUE_LEN
  */
-#ifndef ESP_CFG_RCV_BUFF_SIZE
-#define ESP_CFG_RCV_BUFF_SIZE               0x400
+#ifndef ESP_CFG_CONN_SEND_QUEUE
+#define ESP_CFG_CONN_SEND_QUEUE             0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` reset sequence after \ref esp_init call
+ * \brief           Number of send commands queued on single connection before writing thread has to wait
  *
- * \note            When this functionality is disabled, user must manually call \ref esp_reset to send
- *                  reset sequence to ESP device.
+ * Writers from callback functions or without operating system never wait,
+ * their commands are queued regardless of this value.
+ * Set to `0` to disable waiting
+ *
+ * \note            Used only when \ref ESP_CFG_CONN_SEND_QUEUE is enabled
  */
-#ifndef ESP_CFG_RESET_ON_INIT
-#define ESP_CFG_RESET_ON_INIT               1
+#ifndef ESP_CFG_CONN_SEND_QUEUE_LEN
+#define ESP_CFG_CONN_SEND_QUEUE_LEN         8
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` device restore after \ref esp_init call
+ * \brief           Enables `1` or disables `0` per connection send statistics
  *
- * \note            When this feature is enabled, it will automatically
- *                  restore and clear any settings stored as \em default in ESP device
+ * When enabled, stack counts sent bytes, `AT+CIPSEND` commands, retries and failures
+ * and measures time between `AT+CIPSEND` command and `SEND OK` response.
+ * Statistics are available with \ref esp_conn_get_stats function
  */
-#ifndef ESP_CFG_RESTORE_ON_INIT
-#define ESP_CFG_RESTORE_ON_INIT             1
+#ifndef ESP_CFG_CONN_STATS
+#define ESP_CFG_CONN_STATS                  0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` reset sequence after \ref esp_device_set_present call
+ * \brief           Maximum single buffer size for network receive data (TCP/UDP connections)
  *
- * \note            When this functionality is disabled, user must manually call \ref esp_reset to send
- *                  reset sequence to ESP device.
+ * \note            When ESP sends buffer buffer than maximal, multiple buffers are created
  */
-#ifndef ESP_CFG_RESET_ON_DEVICE_PRESENT
-#define ESP_CFG_RESET_ON_DEVICE_PRESENT     1
+#ifndef ESP_CFG_IPD_MAX_BUFF_SIZE
+#define ESP_CFG_IPD_MAX_BUFF_SIZE           1460
 #endif
 
 /**
- * \brief           Default delay (milliseconds unit) before sending first AT command on reset sequence
+ * \brief           Enables `1` or disables `0` zero-copy receive of network data
+ *
+ * When enabled and entire network data chunk is already available in input memory
+ * (receive buffer or memory passed to \ref esp_input_process),
+ * packet buffer is not allocated with payload memory.
+ * Instead, its payload references input memory directly and no copy is performed.
  *
+ * If application keeps reference to packet buffer after \ref ESP_EVT_CONN_RECV event returns,
+ * library allocates memory and copies data to it before input memory is released.
+ *
+ * \note            Packet buffer is the same object for application in both cases
  */
-#ifndef ESP_CFG_RESET_DELAY_DEFAULT
-#define ESP_CFG_RESET_DELAY_DEFAULT         1000
+#ifndef ESP_CFG_IPD_ZERO_COPY
+#define ESP_CFG_IPD_ZERO_COPY               0
 #endif
 
 /**
- * \brief           Maximum length of SSID for access point scan
+ * \brief           Enables `1` or disables `0` allocation policy for network data buffers
  *
- * \note            This parameter must include trailling zero
+ * When enabled, size of every packet buffer for received network data
+ * is selected by function set with \ref esp_set_ipd_alloc_fn,
+ * based on length announced by `+IPD` statement and free memory.
+ * Function may also request entire `+IPD` statement to be delivered
+ * as single packet buffer chain in one \ref ESP_EVT_CONN_RECV event.
+ *
+ * When no function is set, default policy limits buffers to largest
+ * packet buffer pool class (\ref ESP_CFG_PBUF_POOL) and to largest free memory block.
+ *
+ * \note            Buffers of whole `+IPD` statement are always copied, also when \ref ESP_CFG_IPD_ZERO_COPY is enabled
  */
-#ifndef ESP_CFG_MAX_SSID_LENGTH
-#define ESP_CFG_MAX_SSID_LENGTH             21
+#ifndef ESP_CFG_IPD_ALLOC_POLICY
+#define ESP_CFG_IPD_ALLOC_POLICY            0
 #endif
 
 /**
- * \defgroup        ESP_CONFIG_DBG Debugging
- * \brief           Debugging configurations
- * \{
+ * \brief           Enables `1` or disables `0` incremental `+IPD` header recognizer
+ *
+ * When enabled, `+IPD,<n>,<len>[,<ip>,<port>]:` header at the beginning of line
+ * is decoded byte by byte as it arrives, without ASCII/unicode checks
+ * and without string parsing once `:` is received.
+ *
+ * Bytes which turn out not to be data header (such as `+IPD` notification in manual receive mode)
+ * are processed by regular line parser, as if feature was disabled
  */
+#ifndef ESP_CFG_IPD_HDR_FAST
+#define ESP_CFG_IPD_HDR_FAST                0
+#endif
 
 /**
- * \brief           Set global debug support
+ * \brief           Enables `1` or disables `0` packet buffer pools
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * When enabled, packet buffers are allocated from `3` static pools
+ * with different payload sizes. Smallest pool with free entry,
+ * large enough for requested length, is used.
+ * Allocation and free operations are done in constant time
+ * and heap is used only when no pool entry is available,
+ * unless \ref ESP_CFG_MEM_STATIC is enabled.
  *
- * \note            Set to \ref ESP_DBG_OFF to globally disable all debugs
+ * \note            Pool with number of entries set to `0` is not used
+ * \sa              ESP_CFG_PBUF_POOL_0_SIZE, ESP_CFG_PBUF_POOL_0_NUM
  */
-#ifndef ESP_CFG_DBG
-#define ESP_CFG_DBG                         ESP_DBG_OFF
+#ifndef ESP_CFG_PBUF_POOL
+#define ESP_CFG_PBUF_POOL                   0
 #endif
 
 /**
- * \brief           Debugging output function
+ * \brief           Payload size of entries in first (smallest) packet buffer pool
+ */
+#ifndef ESP_CFG_PBUF_POOL_0_SIZE
+#define ESP_CFG_PBUF_POOL_0_SIZE            128
+#endif
+
+/**
+ * \brief           Number of entries in first packet buffer pool
+ */
+#ifndef ESP_CFG_PBUF_POOL_0_NUM
+#define ESP_CFG_PBUF_POOL_0_NUM             8
+#endif
+
+/**
+ * \brief           Payload size of entries in second packet buffer pool
+ */
+#ifndef ESP_CFG_PBUF_POOL_1_SIZE
+#define ESP_CFG_PBUF_POOL_1_SIZE            512
+#endif
+
+/**
+ * \brief           Number of entries in second packet buffer pool
+ */
+#ifndef ESP_CFG_PBUF_POOL_1_NUM
+#define ESP_CFG_PBUF_POOL_1_NUM             4
+#endif
+
+/**
+ * \brief           Payload size of entries in third (largest) packet buffer pool
+ */
+#ifndef ESP_CFG_PBUF_POOL_2_SIZE
+#define ESP_CFG_PBUF_POOL_2_SIZE            ESP_CFG_IPD_MAX_BUFF_SIZE
+#endif
+
+/**
+ * \brief           Number of entries in third packet buffer pool
+ */
+#ifndef ESP_CFG_PBUF_POOL_2_NUM
+#define ESP_CFG_PBUF_POOL_2_NUM             4
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` packet buffers with payload memory apart from structure
  *
- * Called with format and optional parameters for printf-like debug
+ * When enabled, \ref esp_pbuf_new_ext creates packet buffer on top of memory provided by application,
+ * and \ref esp_pbuf_set_payload_alloc_fn sets functions used by \ref esp_pbuf_new
+ * to allocate payload separately, such as in DMA capable or external memory.
+ * Packet buffer structure itself is still allocated from heap or packet buffer pool
  */
-#ifndef ESP_CFG_DBG_OUT
-#define ESP_CFG_DBG_OUT(fmt, ...)           do { extern int printf( const char * format, ... ); printf(fmt, ## __VA_ARGS__); } while (0)
+#ifndef ESP_CFG_PBUF_EXT_PAYLOAD
+#define ESP_CFG_PBUF_EXT_PAYLOAD            0
 #endif
 
 /**
- * \brief           Minimal debug level
+ * \brief           Default baudrate used for AT port
  *
- * Check \ref ESP_DBG_LVL for possible values
+ * \note            User may call API function to change to desired baudrate if necessary
  */
-#ifndef ESP_CFG_DBG_LVL_MIN
-#define ESP_CFG_DBG_LVL_MIN                 ESP_DBG_LVL_ALL
+#ifndef ESP_CFG_AT_PORT_BAUDRATE
+#define ESP_CFG_AT_PORT_BAUDRATE            115200
 #endif
 
 /**
- * \brief           Enabled debug types
+ * \brief           Enables `1` or disables `0` automatic AT port baudrate negotiation
  *
- * When debug is globally enabled with \ref ESP_CFG_DBG parameter,
- * user must enable debug types such as TRACE or STATE messages.
+ * When enabled, reset sequence probes baudrates from \ref ESP_CFG_AT_PORT_BAUDRATE_AUTO_LIST,
+ * up to maximal baudrate supported by low-level driver (`max_baudrate` in \ref esp_ll_t).
+ * Each rate must pass \ref ESP_CFG_AT_PORT_BAUDRATE_AUTO_TESTS link tests,
+ * otherwise device and host roll back to last stable rate.
  *
- * Check \ref ESP_DBG_TYPE for possible options. Separate values with `bitwise OR` operator
+ * Highest stable rate is remembered and used directly on next reset.
+ *
+ * \note            Baudrate is set with `AT+UART_CUR` and is not saved to device flash
  */
-#ifndef ESP_CFG_DBG_TYPES_ON
-#define ESP_CFG_DBG_TYPES_ON                0
+#ifndef ESP_CFG_AT_PORT_BAUDRATE_AUTO
+#define ESP_CFG_AT_PORT_BAUDRATE_AUTO       0
 #endif
 
 /**
- * \brief           Set debug level for init function
+ * \brief           Comma separated list of baudrates to probe, in ascending order
+ * \note            Used only when \ref ESP_CFG_AT_PORT_BAUDRATE_AUTO is enabled
+ */
+#ifndef ESP_CFG_AT_PORT_BAUDRATE_AUTO_LIST
+#define ESP_CFG_AT_PORT_BAUDRATE_AUTO_LIST  921600, 2000000, 3000000
+#endif
+
+/**
+ * \brief           Number of successful `AT` tests required to consider baudrate stable
+ * \note            Used only when \ref ESP_CFG_AT_PORT_BAUDRATE_AUTO is enabled
+ */
+#ifndef ESP_CFG_AT_PORT_BAUDRATE_AUTO_TESTS
+#define ESP_CFG_AT_PORT_BAUDRATE_AUTO_TESTS 3
+#endif
+
+/**
+ * \brief           Timeout in units of milliseconds for single `UART` or `AT` probe command
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * Garbled link may produce neither `OK` nor `ERROR`.
+ * Probe without response in this time is considered failed,
+ * device and host roll back to last stable rate and rate is not probed again.
+ *
+ * \note            Used only when \ref ESP_CFG_AT_PORT_BAUDRATE_AUTO is enabled
  */
-#ifndef ESP_CFG_DBG_INIT
-#define ESP_CFG_DBG_INIT                    ESP_DBG_OFF
+#ifndef ESP_CFG_AT_PORT_BAUDRATE_AUTO_TIMEOUT
+#define ESP_CFG_AT_PORT_BAUDRATE_AUTO_TIMEOUT   200
 #endif
 
 /**
- * \brief           Set debug level for memory manager
+ * \brief           Enables `1` or disables `0` ESP acting as station
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * \note            When device is in station mode, it can connect to other access points
  */
-#ifndef ESP_CFG_DBG_MEM
-#define ESP_CFG_DBG_MEM                     ESP_DBG_OFF
+#ifndef ESP_CFG_MODE_STATION
+#define ESP_CFG_MODE_STATION                1
 #endif
 
 /**
- * \brief           Set debug level for input module
+ * \brief           Enables `1` or disables `0` ESP acting as access point
+ *
+ * \note            When device is in access point mode, it can accept connections from other stations
+ */
+#ifndef ESP_CFG_MODE_ACCESS_POINT
+#define ESP_CFG_MODE_ACCESS_POINT           1
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` access point scan support in station mode
+ *
+ * When disabled, \ref esp_sta_list_ap and related functions,
+ * `+CWLAP` parser and `AT+CWLAPOPT` setup during reset are excluded from build
+ *
+ * \note            Used only when \ref ESP_CFG_MODE_STATION is enabled
+ */
+#ifndef ESP_CFG_STA_LIST_AP
+#define ESP_CFG_STA_LIST_AP                 1
+#endif
+
+/**
+ * \brief           Number of access points kept from last scan for \ref esp_sta_list_ap_cached
+ *
+ * Table is filled by every scan with default fields and without SSID filter on device side.
+ * \ref esp_sta_list_ap_cached answers from table without new scan when result is not older
+ * than requested, and requests queued while scan is in progress are answered from its result.
+ *
+ * Set to `0` to disable table and scan with AT command on every call
+ *
+ * \note            Requires \ref ESP_CFG_STA_LIST_AP to be enabled
+ */
+#ifndef ESP_CFG_STA_LIST_AP_CACHE_SIZE
+#define ESP_CFG_STA_LIST_AP_CACHE_SIZE      0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` listing of stations connected to soft access point
+ *
+ * When disabled, \ref esp_ap_list_sta and `+CWLIF` parser are excluded from build
+ *
+ * \note            Used only when \ref ESP_CFG_MODE_ACCESS_POINT is enabled
+ */
+#ifndef ESP_CFG_AP_LIST_STA
+#define ESP_CFG_AP_LIST_STA                 1
+#endif
+
+/**
+ * \brief           Number of stations kept in local table of stations connected to soft access point
+ *
+ * Table is filled by first \ref esp_ap_list_sta call after reset and kept up to date
+ * with `+STA_CONNECTED`, `+STA_DISCONNECTED` and `+DIST_STA_IP` notifications.
+ * Later \ref esp_ap_list_sta calls are answered from table without AT command,
+ * until more stations are connected than table can hold.
+ *
+ * Set to `0` to disable table and list stations with AT command on every call
+ *
+ * \note            Requires \ref ESP_CFG_AP_LIST_STA to be enabled
+ */
+#ifndef ESP_CFG_AP_STA_CACHE_SIZE
+#define ESP_CFG_AP_STA_CACHE_SIZE           0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` answering getters from values already known to the stack
+ *
+ * MAC and IP addresses of station and access point and hostname are remembered
+ * once read from device (MAC addresses are read during reset sequence already).
+ * \ref esp_sta_getmac, \ref esp_sta_getip, \ref esp_ap_getmac, \ref esp_ap_getip
+ * and \ref esp_hostname_get then return remembered value without AT command.
+ *
+ * Value is forgotten when it is changed by the stack (`set` functions, DHCP or WiFi mode change),
+ * station IP also on `WIFI DISCONNECT` and `WIFI GOT IP` notifications, and all values on reset.
+ */
+#ifndef ESP_CFG_GETTER_CACHE
+#define ESP_CFG_GETTER_CACHE                0
+#endif
+
+/**
+ * \brief           Size of buffer to collect AT command before it is sent to low-level driver
+ *
+ * When enabled, command fragments (`AT`, parameters, quotes, commas, `CRLF`)
+ * are copied to internal buffer and passed to \ref esp_ll_send_fn with single call
+ * when command is finished, instead of calling it for every few bytes.
+ *
+ * \note            Set to `0` to disable buffering and send every fragment directly
+ */
+#ifndef ESP_CFG_AT_PORT_TX_BUFF_SIZE
+#define ESP_CFG_AT_PORT_TX_BUFF_SIZE        0
+#endif
+
+/**
+ * \brief           Buffer size for received data waiting to be processed
+ * \note            When server mode is active and a lot of connections are in queue
+ *                  this should be set high otherwise your buffer may overflow
+ *
+ * \note            Buffer size also depends on TX user driver if it uses DMA or blocking mode.
+ *                  In case of DMA (CPU can work other tasks), buffer may be smaller as CPU
+ *                  will have more time to process all the incoming bytes
+ *
+ * \note            This parameter has no meaning when \ref ESP_CFG_INPUT_USE_PROCESS is enabled
+ */
+#ifndef ESP_CFG_RCV_BUFF_SIZE
+#define ESP_CFG_RCV_BUFF_SIZE               0x400
+#endif
+
+/**
+ * \brief           Maximal number of bytes processed from receive buffer before they are released
+ *
+ * Processing thread marks data as read after every chunk of this size,
+ * so producer (\ref esp_input) can reuse memory sooner during long bursts.
+ * This allows smaller \ref ESP_CFG_RCV_BUFF_SIZE without overflow.
+ *
+ * Set to `0` to release memory only after entire contiguous block is processed
+ *
+ * \note            This parameter has no meaning when \ref ESP_CFG_INPUT_USE_PROCESS is enabled
+ */
+#ifndef ESP_CFG_RCV_BUFF_COMMIT_LEN
+#define ESP_CFG_RCV_BUFF_COMMIT_LEN         0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` receive flow control driven by receive buffer fill level
+ *
+ * When buffer fill reaches \ref ESP_CFG_INPUT_FLOW_HIGH bytes, \ref esp_input
+ * calls `flow_fn` of low-level driver to deassert RTS line.
+ * Processing thread reasserts it once fill drops to \ref ESP_CFG_INPUT_FLOW_LOW bytes.
+ *
+ * \note            \ref ESP_CFG_INPUT_USE_PROCESS must be disabled to use this feature.
+ *                  In process mode, low-level driver shall apply flow control to its own buffer
+ */
+#ifndef ESP_CFG_INPUT_FLOW_CTRL
+#define ESP_CFG_INPUT_FLOW_CTRL             0
+#endif
+
+/**
+ * \brief           Receive buffer fill level in units of bytes to pause device transmission
+ * \note            Leave room for data device sends after RTS is deasserted (UART FIFO on device side)
+ */
+#ifndef ESP_CFG_INPUT_FLOW_HIGH
+#define ESP_CFG_INPUT_FLOW_HIGH             (ESP_CFG_RCV_BUFF_SIZE * 3 / 4)
+#endif
+
+/**
+ * \brief           Receive buffer fill level in units of bytes to resume device transmission
+ */
+#ifndef ESP_CFG_INPUT_FLOW_LOW
+#define ESP_CFG_INPUT_FLOW_LOW              (ESP_CFG_RCV_BUFF_SIZE / 4)
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` lock-free single-producer single-consumer ring buffer mode
+ *
+ * When enabled, read and write pointers are accessed as volatile and
+ * \ref ESP_CFG_BUFF_MEMORY_BARRIER is issued between data copy and pointer update.
+ * This makes it safe to call \ref esp_input from interrupt or separate thread
+ * while processing thread reads from the same buffer.
+ *
+ * \note            Each buffer must have at most one writer and one reader
+ */
+#ifndef ESP_CFG_BUFF_SPSC
+#define ESP_CFG_BUFF_SPSC                   0
+#endif
+
+/**
+ * \brief           Memory barrier used by ring buffer when \ref ESP_CFG_BUFF_SPSC is enabled
+ *
+ * Default implementation uses compiler builtin on GCC compatible compilers.
+ * Define it to architecture specific instruction (for example `__DMB()` on Cortex-M) if needed
+ */
+#ifndef ESP_CFG_BUFF_MEMORY_BARRIER
+#if defined(__GNUC__) || defined(__clang__)
+#define ESP_CFG_BUFF_MEMORY_BARRIER()       __sync_synchronize()
+#else
+#define ESP_CFG_BUFF_MEMORY_BARRIER()
+#endif
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` reset sequence after \ref esp_init call
+ *
+ * \note            When this functionality is disabled, user must manually call \ref esp_reset to send
+ *                  reset sequence to ESP device.
+ */
+#ifndef ESP_CFG_RESET_ON_INIT
+#define ESP_CFG_RESET_ON_INIT               1
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` sending \ref ESP_EVT_INIT_FINISH after init reset sequence
+ *
+ * By default, \ref ESP_EVT_INIT_FINISH event is sent as soon as threads are running,
+ * before device is reset. When enabled and \ref ESP_CFG_RESET_ON_INIT is enabled,
+ * event is sent when reset sequence finished instead.
+ *
+ * Combined with non-blocking \ref esp_init call, application may continue
+ * its own startup while device boots and wait for event before using the stack
+ */
+#ifndef ESP_CFG_INIT_FINISH_AFTER_RESET
+#define ESP_CFG_INIT_FINISH_AFTER_RESET     0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` device restore after \ref esp_init call
+ *
+ * \note            When this feature is enabled, it will automatically
+ *                  restore and clear any settings stored as \em default in ESP device
+ */
+#ifndef ESP_CFG_RESTORE_ON_INIT
+#define ESP_CFG_RESTORE_ON_INIT             1
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` warm boot in reset sequence
+ *
+ * After reset sequence completes, library remembers AT and SDK version as module fingerprint,
+ * together with Wi-Fi mode and access point IP/MAC settings.
+ * On next reset, when `AT+GMR` reports the same fingerprint and settings were not changed
+ * in the meantime, `AT+CWMODE`, `AT+CIPAP?` and `AT+CIPAPMAC?` steps are skipped
+ * and remembered values are used instead.
+ *
+ * \note            Fingerprint is kept in RAM only. First reset after \ref esp_init always runs full sequence.
+ *                  With \ref ESP_CFG_RESTORE_ON_INIT enabled, restore sequence itself always runs full sequence
+ */
+#ifndef ESP_CFG_RESET_WARM_BOOT
+#define ESP_CFG_RESET_WARM_BOOT             0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` automatic recovery after unexpected device reset
+ *
+ * Library remembers last successful access point join and server configuration.
+ * When device resets without request from host, reset sequence starts immediately,
+ * without sending `AT+RST` to already restarted device,
+ * and is followed by server enable and access point join with remembered settings.
+ *
+ * Use \ref ESP_CFG_CONN_SSL_CFG_CACHE to replay SSL configuration as part of the same sequence.
+ * Connections are not reopened, application gets close event for each of them and
+ * is responsible to start them again
+ *
+ * \note            Remembered settings are cleared with successful \ref esp_sta_quit,
+ *                  server disable and \ref esp_restore
+ */
+#ifndef ESP_CFG_RESET_RECOVERY
+#define ESP_CFG_RESET_RECOVERY              0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` configuration snapshot verified after reset sequence
+ *
+ * Library records Wi-Fi mode, DHCP, station and access point IP and hostname settings
+ * when they are applied successfully. Application reads snapshot with \ref esp_snapshot_get,
+ * keeps it in non-volatile memory and gives it back with \ref esp_snapshot_set on next boot,
+ * instead of sending all configuration commands again.
+ *
+ * Recorded mode is used by `AT+CWMODE` step of reset sequence.
+ * Other settings are compared with values read from device during reset and restore sequence,
+ * `AT+CIPSTA?` and `AT+CWHOSTNAME?` queries are added only when such settings are recorded.
+ * Commands are queued after the sequence only for settings that differ
+ */
+#ifndef ESP_CFG_CONFIG_SNAPSHOT
+#define ESP_CFG_CONFIG_SNAPSHOT             0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` reset sequence after \ref esp_device_set_present call
+ *
+ * \note            When this functionality is disabled, user must manually call \ref esp_reset to send
+ *                  reset sequence to ESP device.
+ */
+#ifndef ESP_CFG_RESET_ON_DEVICE_PRESENT
+#define ESP_CFG_RESET_ON_DEVICE_PRESENT     1
+#endif
+
+/**
+ * \brief           Default delay (milliseconds unit) before sending first AT command on reset sequence
+ *
+ */
+#ifndef ESP_CFG_RESET_DELAY_DEFAULT
+#define ESP_CFG_RESET_DELAY_DEFAULT         1000
+#endif
+
+/**
+ * \brief           Maximum length of SSID for access point scan
+ *
+ * \note            This parameter must include trailling zero
+ */
+#ifndef ESP_CFG_MAX_SSID_LENGTH
+#define ESP_CFG_MAX_SSID_LENGTH             21
+#endif
+
+/**
+ * \defgroup        ESP_CONFIG_DBG Debugging
+ * \brief           Debugging configurations
+ * \{
+ */
+
+/**
+ * \brief           Set global debug support
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ *
+ * \note            Set to \ref ESP_DBG_OFF to globally disable all debugs
+ */
+#ifndef ESP_CFG_DBG
+#define ESP_CFG_DBG                         ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Debugging output function
+ *
+ * Called with format and optional parameters for printf-like debug
+ */
+#ifndef ESP_CFG_DBG_OUT
+#define ESP_CFG_DBG_OUT(fmt, ...)           do { extern int printf( const char * format, ... ); printf(fmt, ## __VA_ARGS__); } while (0)
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` binary debug trace mode
+ *
+ * When enabled, \ref ESP_DEBUGF does not format messages with \ref ESP_CFG_DBG_OUT.
+ * It only stores timestamp, format string address and arguments to RAM ring
+ * of \ref ESP_CFG_DBG_TRACE_LEN records, oldest are overwritten.
+ * Ring can be sent to host with \ref esp_dbg_trace_dump (or read by debugger)
+ * and decoded offline using format strings from firmware image.
+ *
+ * \note            String arguments are recorded as pointer values only
+ */
+#ifndef ESP_CFG_DBG_TRACE
+#define ESP_CFG_DBG_TRACE                   0
+#endif
+
+/**
+ * \brief           Number of records in debug trace ring
+ * \note            Value must be power of `2`
+ */
+#ifndef ESP_CFG_DBG_TRACE_LEN
+#define ESP_CFG_DBG_TRACE_LEN               64
+#endif
+
+/**
+ * \brief           Timestamp source for debug trace records
+ *
+ * Default uses system time in milliseconds.
+ * Define it to cycle counter (for example `DWT->CYCCNT` on Cortex-M) for finer resolution
+ */
+#ifndef ESP_CFG_DBG_TRACE_TIME
+#define ESP_CFG_DBG_TRACE_TIME()            esp_sys_now()
+#endif
+
+/**
+ * \brief           Minimal debug level
+ *
+ * Check \ref ESP_DBG_LVL for possible values
+ */
+#ifndef ESP_CFG_DBG_LVL_MIN
+#define ESP_CFG_DBG_LVL_MIN                 ESP_DBG_LVL_ALL
+#endif
+
+/**
+ * \brief           Enabled debug types
+ *
+ * When debug is globally enabled with \ref ESP_CFG_DBG parameter,
+ * user must enable debug types such as TRACE or STATE messages.
+ *
+ * Check \ref ESP_DBG_TYPE for possible options. Separate values with `bitwise OR` operator
+ */
+#ifndef ESP_CFG_DBG_TYPES_ON
+#define ESP_CFG_DBG_TYPES_ON                0
+#endif
+
+/**
+ * \brief           Set debug level for init function
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_INIT
+#define ESP_CFG_DBG_INIT                    ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for memory manager
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_MEM
+#define ESP_CFG_DBG_MEM                     ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for input module
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_INPUT
+#define ESP_CFG_DBG_INPUT                   ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for ESP threads
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_THREAD
+#define ESP_CFG_DBG_THREAD                  ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for asserting of input variables
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_ASSERT
+#define ESP_CFG_DBG_ASSERT                  ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for incoming data received from device
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_IPD
+#define ESP_CFG_DBG_IPD                     ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for netconn sequential API
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_NETCONN
+#define ESP_CFG_DBG_NETCONN                 ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for packet buffer manager
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_PBUF
+#define ESP_CFG_DBG_PBUF                    ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for connections
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_CONN
+#define ESP_CFG_DBG_CONN                    ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for dynamic variable allocations
+ *
+ *                  Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_VAR
+#define ESP_CFG_DBG_VAR                     ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` echo mode on AT commands
+ *                  sent to ESP device.
+ *
+ * \note            This mode is useful when debugging ESP communication
+ */
+#ifndef ESP_CFG_AT_ECHO
+#define ESP_CFG_AT_ECHO                     0
+#endif
+
+/**
+ * \}
+ */
+
+/**
+ * \defgroup        ESP_CONFIG_OS OS configuration
+ * \brief           Operating system dependant configuration
+ * \{
+ */
+
+/**
+ * \brief           Set number of message queue entries for procuder thread
+ *
+ * Message queue is used for storing memory address to command data
+ */
+#ifndef ESP_CFG_THREAD_PRODUCER_MBOX_SIZE
+#define ESP_CFG_THREAD_PRODUCER_MBOX_SIZE   16
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` priority lanes for producer thread
+ *
+ * When enabled, slow management commands (access point scan and join, ping, DNS, update, ...)
+ * are queued to separate low priority message queue. Producing thread
+ * always executes commands from high priority queue (data and control) first.
+ *
+ * \note            Commands from different lanes may be executed in different order than started
+ */
+#ifndef ESP_CFG_THREAD_PRODUCER_PRIO
+#define ESP_CFG_THREAD_PRODUCER_PRIO        0
+#endif
+
+/**
+ * \brief           Set number of message queue entries for low priority lane of producer thread
+ * \note            Used only when \ref ESP_CFG_THREAD_PRODUCER_PRIO is enabled.
+ *                  High priority lane uses \ref ESP_CFG_THREAD_PRODUCER_MBOX_SIZE entries
+ */
+#ifndef ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE
+#define ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE   8
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` static allocation mode for core
+ *
+ * When enabled, objects allocated by core and netconn API are taken
+ * from fixed-size static pools only and heap is never used for them.
+ * Pool exhaustion is reported as \ref espERRMEM in constant time.
+ *
+ * Covered objects are command messages (\ref ESP_CFG_MSG_POOL),
+ * packet buffers (\ref ESP_CFG_PBUF_POOL), timeouts, event callback entries,
+ * connection and netconn write buffers, netconn structures and receive buffer.
+ *
+ * \note            Operating system objects (threads, message queues, semaphores)
+ *                  are created by system port and applications use heap as before
+ * \sa              ESP_CFG_MEM_STATIC_TIMEOUTS, ESP_CFG_MEM_STATIC_EVT_FUNCS, ESP_CFG_MEM_STATIC_CONN_BUFFS,
+ *                  ESP_CFG_MEM_STATIC_NETCONNS, ESP_CFG_MEM_STATIC_NETCONN_BUFFS
+ */
+#ifndef ESP_CFG_MEM_STATIC
+#define ESP_CFG_MEM_STATIC                  0
+#endif
+
+/**
+ * \brief           Number of timeout entries available for \ref esp_timeout_add in static allocation mode
+ */
+#ifndef ESP_CFG_MEM_STATIC_TIMEOUTS
+#define ESP_CFG_MEM_STATIC_TIMEOUTS         16
+#endif
+
+/**
+ * \brief           Number of callbacks available for \ref esp_evt_register in static allocation mode
+ */
+#ifndef ESP_CFG_MEM_STATIC_EVT_FUNCS
+#define ESP_CFG_MEM_STATIC_EVT_FUNCS        4
+#endif
+
+/**
+ * \brief           Number of \ref ESP_CFG_CONN_MAX_DATA_LEN bytes long buffers
+ *                  available for \ref esp_conn_write in static allocation mode
+ */
+#ifndef ESP_CFG_MEM_STATIC_CONN_BUFFS
+#define ESP_CFG_MEM_STATIC_CONN_BUFFS       ESP_CFG_MAX_CONNS
+#endif
+
+/**
+ * \brief           Number of netconn structures available in static allocation mode
+ */
+#ifndef ESP_CFG_MEM_STATIC_NETCONNS
+#define ESP_CFG_MEM_STATIC_NETCONNS         ESP_CFG_MAX_CONNS
+#endif
+
+/**
+ * \brief           Number of netconn write buffers available in static allocation mode
+ */
+#ifndef ESP_CFG_MEM_STATIC_NETCONN_BUFFS
+#define ESP_CFG_MEM_STATIC_NETCONN_BUFFS    ESP_CFG_MAX_CONNS
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` fixed-size pool for command messages
+ *
+ * When enabled, command messages are taken from static pool
+ * of \ref ESP_CFG_THREAD_PRODUCER_MBOX_SIZE entries in constant time,
+ * instead of allocating them from heap for every API call.
+ * Heap is used only when all pool entries are in use,
+ * unless \ref ESP_CFG_MEM_STATIC is enabled.
+ */
+#ifndef ESP_CFG_MSG_POOL
+#define ESP_CFG_MSG_POOL                    0
+#endif
+
+/**
+ * \brief           Number of semaphores kept for reuse by blocking API calls
+ *
+ * Blocking command needs semaphore to wait for its completion.
+ * When set to non-zero value, semaphore is returned to cache after command has finished
+ * and is reused by next blocking call, instead of being created and deleted every time.
+ * Cache is filled on demand and semaphores are never deleted once cached.
+ *
+ * Set to `0` to create new semaphore for every blocking call.
+ *
+ * \note            Used only when \ref ESP_CFG_OS is enabled
+ */
+#ifndef ESP_CFG_SEM_POOL_SIZE
+#define ESP_CFG_SEM_POOL_SIZE               0
+#endif
+
+/**
+ * \brief           Set number of message queue entries for processing thread
+ *
+ * Message queue is used to notify processing thread about new received data on AT port
+ */
+#ifndef ESP_CFG_THREAD_PROCESS_MBOX_SIZE
+#define ESP_CFG_THREAD_PROCESS_MBOX_SIZE    16
+#endif
+
+/**
+ * \brief           Maximal time in units of milliseconds processing thread sleeps
+ *                  before it checks input buffer without being notified
+ *
+ * When set to `0`, thread is purely event driven and only wakes up
+ * on \ref esp_input notification or when next timeout expires.
+ * This allows RTOS tickless idle modes to stay in low-power state while link is idle.
+ *
+ * Set it to non-zero value only when low-level driver writes to input buffer
+ * without calling \ref esp_input
+ *
+ * \note            Used only when \ref ESP_CFG_INPUT_USE_PROCESS is disabled
+ */
+#ifndef ESP_CFG_THREAD_PROCESS_POLL_TIME
+#define ESP_CFG_THREAD_PROCESS_POLL_TIME    0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` direct support for processing input data
+ *
+ * When this mode is enabled, no overhead is included for copying data
+ * to receive buffer because bytes are processed directly by \ref esp_input_process function
+ *
+ * If this mode is not enabled, then user have to send every received byte via \ref esp_input
+ * function to the internal buffer for future processing. This may introduce additional overhead
+ * with data copy and may decrease library performance
+ *
+ * \note            This mode can only be used when \ref ESP_CFG_OS is enabled
+ *
+ * \note            When using this mode, separate thread must be dedicated only
+ *                  for reading data on AT port. It is usually implemented in LL driver
+ *
+ * \note            Best case for using this mode is if DMA receive is supported by host device
+ */
+#ifndef ESP_CFG_INPUT_USE_PROCESS
+#define ESP_CFG_INPUT_USE_PROCESS           0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` framed input with typed fragments
+ *
+ * Framed transports (SPI, SDIO) already know which payload bytes are command text
+ * and which are connection data. With \ref esp_input_process_frag, data fragments
+ * are delivered to connection directly, without passing through AT parser
+ *
+ * \note            \ref ESP_CFG_INPUT_USE_PROCESS must be enabled to use this feature
+ */
+#ifndef ESP_CFG_INPUT_FRAMED
+#define ESP_CFG_INPUT_FRAMED                0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` deferred event delivery
+ *
+ * When enabled, processing thread does not call user callbacks directly.
+ * Events are copied to queue of \ref ESP_CFG_EVT_DEFERRED_QUEUE_LEN entries
+ * and delivered from separate event thread, one event per core lock.
+ * Received packet buffers are referenced until event is delivered.
+ *
+ * \note            Return value of connection callback is ignored,
+ *                  \ref espOKIGNOREMORE on \ref ESP_EVT_CONN_RECV has no effect
+ * \note            When queue is full, pending events are delivered by processing thread
+ */
+#ifndef ESP_CFG_EVT_DEFERRED
+#define ESP_CFG_EVT_DEFERRED                0
+#endif
+
+/**
+ * \brief           Number of entries in deferred event queue
+ * \note            Used only when \ref ESP_CFG_EVT_DEFERRED is enabled
+ */
+#ifndef ESP_CFG_EVT_DEFERRED_QUEUE_LEN
+#define ESP_CFG_EVT_DEFERRED_QUEUE_LEN      16
+#endif
+
+/**
+ * \brief           Maximal number of handlers for oversized received lines
+ *
+ * Received line longer than internal line buffer is normally truncated.
+ * Handler registered with \ref esp_recv_line_register for line prefix
+ * instead receives such line in fragments, each time buffer fills up, and last fragment at line end.
+ * Lines which fit into the buffer are parsed as usual.
+ *
+ * Set to `0` to disable the feature
+ */
+#ifndef ESP_CFG_RECV_LINE_HANDLERS
+#define ESP_CFG_RECV_LINE_HANDLERS          0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` lock-free read-only status queries
+ *
+ * Functions such as \ref esp_conn_is_active, \ref esp_device_is_present or \ref esp_sta_has_ip
+ * read single flag or pointer written only by stack thread.
+ * When enabled, they read value directly without \ref esp_core_lock,
+ * so application threads polling status do not block processing of received data.
+ *
+ * Connection addresses (\ref esp_conn_get_remote_ip) and station IP (\ref esp_sta_copy_ip)
+ * are read with sequence counter and fall back to lock only when copy overlaps an update
+ *
+ * \note            Value is a snapshot, it may change immediately after function returns.
+ *                  This is the same as with locking, as lock is released before value is used
+ */
+#ifndef ESP_CFG_CORE_LOCKLESS_READ
+#define ESP_CFG_CORE_LOCKLESS_READ          0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` receive buffer overflow accounting
+ *
+ * When enabled, \ref esp_input counts writes truncated because receive buffer was full
+ * and number of dropped bytes, and tracks high-water mark of buffer usage.
+ * Processing thread reports every new overflow with \ref ESP_EVT_RX_OVERFLOW event,
+ * as AT stream is corrupted at that point.
+ *
+ * Statistics are available with \ref esp_input_get_stats function
+ *
+ * \note            \ref ESP_CFG_INPUT_USE_PROCESS must be disabled to use this feature
+ */
+#ifndef ESP_CFG_RX_STATS
+#define ESP_CFG_RX_STATS                    0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` command latency statistics
+ *
+ * When enabled, producing thread measures time from command start
+ * until processing thread reports command finished, and keeps number of executions,
+ * timeouts and logarithmic latency histogram for every command type.
+ *
+ * Statistics are available with \ref esp_cmd_stats_get function
+ */
+#ifndef ESP_CFG_CMD_STATS
+#define ESP_CFG_CMD_STATS                   0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` command timeouts learned from observed latency
+ *
+ * Producing thread keeps logarithmic latency histogram for every command type.
+ * When enough samples are collected, command waits at most
+ * \ref ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR times 99th percentile of its latency,
+ * but not less than \ref ESP_CFG_CMD_ADAPTIVE_TIMEOUT_MIN.
+ *
+ * Timeout requested by API function stays upper limit and `0` (no timeout) is never changed.
+ * Timed out command is counted with time it waited, so next timeout of the same command type is longer.
+ */
+#ifndef ESP_CFG_CMD_ADAPTIVE_TIMEOUT
+#define ESP_CFG_CMD_ADAPTIVE_TIMEOUT        0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` latency tracing of data path stages
+ *
+ * Received data are timestamped when written to input buffer, when `+IPD` is parsed,
+ * when packet buffer is written to netconn receive queue and when application receives it.
+ * Commands are timestamped when written to producer queue, when started and on `SEND OK`.
+ * Time spent in every stage is collected to logarithmic histogram, see \ref esp_trace_stage_t.
+ *
+ * Statistics are available with \ref esp_trace_get function
+ *
+ * \note            Input buffer stage measures oldest byte written with \ref esp_input,
+ *                  which calls \ref esp_sys_now and may run in interrupt context
+ */
+#ifndef ESP_CFG_LATENCY_TRACE
+#define ESP_CFG_LATENCY_TRACE               0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` capture of AT stream to RAM ring buffer
+ *
+ * Received and sent bytes are written to buffer as timestamped records,
+ * oldest records are overwritten when buffer is full.
+ * Records can be read with \ref esp_capture_read and replayed with `system/esp_ll_replay.c` backend.
+ *
+ * \sa              ESP_CFG_AT_CAPTURE_BUFF_SIZE
+ */
+#ifndef ESP_CFG_AT_CAPTURE
+#define ESP_CFG_AT_CAPTURE                  0
+#endif
+
+/**
+ * \brief           Size of AT stream capture buffer in units of bytes
+ * \note            Buffer is part of static memory of the library
+ */
+#ifndef ESP_CFG_AT_CAPTURE_BUFF_SIZE
+#define ESP_CFG_AT_CAPTURE_BUFF_SIZE        0x1000
+#endif
+
+/**
+ * \brief           Multiplier of 99th percentile latency used as command timeout
+ * \note            Used when \ref ESP_CFG_CMD_ADAPTIVE_TIMEOUT is enabled
+ */
+#ifndef ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR
+#define ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR 4
+#endif
+
+/**
+ * \brief           Minimal learned command timeout in units of milliseconds
+ * \note            Used when \ref ESP_CFG_CMD_ADAPTIVE_TIMEOUT is enabled
+ */
+#ifndef ESP_CFG_CMD_ADAPTIVE_TIMEOUT_MIN
+#define ESP_CFG_CMD_ADAPTIVE_TIMEOUT_MIN    500
+#endif
+
+/**
+ * \brief           Number of executions of command type before its timeout is learned
+ *
+ * Until then, timeout requested by API function is used
+ *
+ * \note            Used when \ref ESP_CFG_CMD_ADAPTIVE_TIMEOUT is enabled
+ */
+#ifndef ESP_CFG_CMD_ADAPTIVE_TIMEOUT_SAMPLES
+#define ESP_CFG_CMD_ADAPTIVE_TIMEOUT_SAMPLES    20
+#endif
+
+/**
+ * \brief           Interval in units of milliseconds for device telemetry sampling
+ *
+ * When non-zero, free RAM of device (`AT+SYSRAM?`) and RSSI of connected access point (`AT+CWJAP?`)
+ * are periodically read in non-blocking mode.
+ * Use it to limit data rate before device runs out of memory.
+ *
+ * Last sample is available with \ref esp_telemetry_get function.
+ * Set to `0` to disable sampling
+ */
+#ifndef ESP_CFG_TELEMETRY_INTERVAL
+#define ESP_CFG_TELEMETRY_INTERVAL          0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` thread notification for command synchronization
+ *
+ * When enabled, processing thread notifies producing thread directly
+ * when command finishes, instead of releasing synchronization semaphore.
+ * On systems with direct-to-task notifications, this reduces command round-trip time.
+ *
+ * \note            System port must implement \ref esp_sys_thread_notify,
+ *                  \ref esp_sys_thread_notify_wait and \ref esp_sys_thread_notify_clear functions
+ */
+#ifndef ESP_CFG_SYS_THREAD_NOTIFY
+#define ESP_CFG_SYS_THREAD_NOTIFY           0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` load and stack statistics of library threads
+ *
+ * Producing and processing threads measure time spent waiting
+ * for messages, command responses and delays versus time spent working.
+ * Unused stack of both threads is read from system port on request.
+ *
+ * Statistics are available with \ref esp_thread_stats_get function
+ *
+ * \note            System port must implement \ref esp_sys_thread_stack_free function
+ * \note            Times are measured with \ref esp_sys_now, short work periods of less than `1` ms are not visible
+ */
+#ifndef ESP_CFG_THREAD_STATS
+#define ESP_CFG_THREAD_STATS                0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` command batching
+ *
+ * When enabled, commands started between \ref esp_cmd_batch_begin
+ * and \ref esp_cmd_batch_commit are sent to producing thread as single message
+ * and executed one after another without returning to message queue.
+ */
+#ifndef ESP_CFG_CMD_BATCH
+#define ESP_CFG_CMD_BATCH                   0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` coalescing of duplicate status commands
+ *
+ * When enabled, non-blocking connection status command without callback
+ * is not queued again while the same command is still waiting in producer queue.
+ * Such call returns \ref espOK as status is refreshed by already queued command.
+ *
+ * \note            Manual TCP receive already keeps at most one read command per connection in queue
+ */
+#ifndef ESP_CFG_CMD_COALESCE
+#define ESP_CFG_CMD_COALESCE                0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` cancellation of commands with \ref esp_cmd_cancel
+ *
+ * Commands are identified by callback argument passed to API function,
+ * such as \ref esp_async_t token. Queued commands are removed without being sent to device.
+ * Data send in progress stops after current segment, other commands in progress
+ * cannot be aborted on device side and finish normally
+ *
+ * \note            Commands in \ref ESP_CFG_CMD_BATCH batch cannot be cancelled
+ * \note            Requires \ref ESP_CFG_USE_API_FUNC_EVT to be enabled
+ */
+#ifndef ESP_CFG_CMD_CANCEL
+#define ESP_CFG_CMD_CANCEL                  0
+#endif
+
+/**
+ * \brief           Producer thread hook, called each time thread wakes-up and does the processing.
+ *
+ * It can be used to check if thread is alive.
+ */
+#ifndef ESP_THREAD_PRODUCER_HOOK
+#define ESP_THREAD_PRODUCER_HOOK()
+#endif
+
+/**
+ * \brief           Process thread hook, called each time thread wakes-up and does the processing.
+ *
+ * It can be used to check if thread is alive.
+ */
+#ifndef ESP_THREAD_PROCESS_HOOK
+#define ESP_THREAD_PROCESS_HOOK()
+#endif
+
+/**
+ * \}
+ */
+
+/**
+ * \defgroup        ESP_CONFIG_MODULES Modules
+ * \brief           Configuration of specific modules
+ * \{
+ */
+
+/**
+ * \defgroup        ESP_CONFIG_MODULES_NETCONN Netconn module
+ * \brief           Configuration of netconn API module
+ * \{
+ */
+
+/**
+ * \brief           Enables `1` or disables `0` NETCONN sequential API support for OS systems
+ *
+ * \note            To use this feature, OS support is mandatory.
+ * \sa              ESP_CFG_OS
+ */
+#ifndef ESP_CFG_NETCONN
+#define ESP_CFG_NETCONN                     0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` receive timeout feature
+ *
+ * When this option is enabled, user will get an option
+ * to set timeout value for receive data on netconn,
+ * before function returns timeout error.
+ *
+ * \note            Even if this option is enabled, user must still manually set timeout,
+ *                  by default time will be set to 0 which means no timeout.
+ */
+#ifndef ESP_CFG_NETCONN_RECEIVE_TIMEOUT
+#define ESP_CFG_NETCONN_RECEIVE_TIMEOUT     1
+#endif
+
+/**
+ * \brief           Accept queue length for new client when netconn server is used
+ *
+ * Defines number of maximal clients waiting in accept queue of server connection.
+ * Server connection may use different length with \ref esp_netconn_set_accept_backlog
+ */
+#ifndef ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN
+#define ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN    5
+#endif
+
+/**
+ * \brief           Receive queue length for pbuf entries
+ *
+ * Defines maximal number of pbuf data packet references for receive
+ */
+#ifndef ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN
+#define ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN   8
+#endif
+
+/**
+ * \brief           Receive queue length for datagrams of UDP netconn
+ *
+ * Every datagram uses one queue entry. Set it higher than
+ * \ref ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN for high-rate datagram streams,
+ * to prevent dropping datagrams when application is late with receive
+ */
+#ifndef ESP_CFG_NETCONN_UDP_RECEIVE_QUEUE_LEN
+#define ESP_CFG_NETCONN_UDP_RECEIVE_QUEUE_LEN   ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN
+#endif
+
+/**
+ * \brief           Default send window in units of bytes for netconn TCP/SSL connections
+ *
+ * Write buffers are queued to stack without waiting for `SEND OK`,
+ * until number of queued but not yet sent bytes reaches send window.
+ * Only then \ref esp_netconn_write blocks, until stack sends some data.
+ *
+ * Window may be changed per connection with \ref esp_netconn_set_send_window
+ *
+ * \note            Set to `0` to disable send window accounting
+ */
+#ifndef ESP_CFG_NETCONN_SEND_WINDOW
+#define ESP_CFG_NETCONN_SEND_WINDOW         0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` \ref esp_netconn_poll function
+ *
+ * When enabled, single thread may wait for new connection, received data
+ * or close event on multiple netconns at the same time
+ */
+#ifndef ESP_CFG_NETCONN_POLL
+#define ESP_CFG_NETCONN_POLL                0
+#endif
+
+/**
+ * \brief           Number of idle client connections kept open for reuse by netconn
+ *
+ * Connection returned with \ref esp_netconn_release stays open and
+ * next \ref esp_netconn_connect to the same host, port and type takes it
+ * instead of starting new connection on device.
+ *
+ * Idle connections are closed when there is no free connection on device for new one,
+ * when they receive data, or when they are idle for \ref ESP_CFG_NETCONN_CONN_POOL_IDLE_TIME,
+ * checked on every \ref ESP_EVT_CONN_POLL event
+ *
+ * \note            Set to `0` to disable connection pool
+ */
+#ifndef ESP_CFG_NETCONN_CONN_POOL_SIZE
+#define ESP_CFG_NETCONN_CONN_POOL_SIZE      0
+#endif
+
+/**
+ * \brief           Maximal time in units of milliseconds idle connection is kept in pool
+ * \note            Used only when \ref ESP_CFG_NETCONN_CONN_POOL_SIZE is greater than `0`
+ */
+#ifndef ESP_CFG_NETCONN_CONN_POOL_IDLE_TIME
+#define ESP_CFG_NETCONN_CONN_POOL_IDLE_TIME 30000
+#endif
+
+/**
+ * \brief           Maximal host name length, including `NULL` termination, for pooled connections
+ *
+ * Connections to hosts with longer names are closed instead of pooled
+ *
+ * \note            Used only when \ref ESP_CFG_NETCONN_CONN_POOL_SIZE is greater than `0`
+ */
+#ifndef ESP_CFG_NETCONN_CONN_POOL_HOST_LEN
+#define ESP_CFG_NETCONN_CONN_POOL_HOST_LEN  64
+#endif
+
+/**
+ * \}
+ */
+
+/**
+ * \defgroup        ESP_CONFIG_MODULES_MQTT MQTT client module
+ * \brief           Configuration of MQTT and MQTT API client modules
+ * \{
+ */
+
+/**
+ * \brief           Enables `1` or disables `0` MQTT protocol version 5
+ *
+ * When enabled, MQTT client connects with protocol version `5`,
+ * announces maximum packet size it can receive and
+ * uses topic aliases for repeated PUBLISH packets on the same topic,
+ * if server allows them in CONNACK packet.
+ *
+ * When disabled, MQTT protocol version `3.1.1` is used
+ */
+#ifndef ESP_CFG_MQTT_V5
+#define ESP_CFG_MQTT_V5                     0
+#endif
+
+/**
+ * \brief           Maximal number of topic aliases MQTT client uses for PUBLISH packets
+ *
+ * Each alias keeps copy of topic in memory until connection is closed.
+ * Actual number of aliases is limited by server with `Topic Alias Maximum` property
+ *
+ * \note            Used only when \ref ESP_CFG_MQTT_V5 is enabled
+ */
+#ifndef ESP_CFG_MQTT_V5_TOPIC_ALIASES
+#define ESP_CFG_MQTT_V5_TOPIC_ALIASES       4
+#endif
+
+/**
+ * \brief           Maximal number of open MQTT requests at a time
+ *
+ */
+#ifndef ESP_CFG_MQTT_MAX_REQUESTS
+#define ESP_CFG_MQTT_MAX_REQUESTS           8
+#endif
+
+/**
+ * \brief           MQTT in-flight window for requests with packet ID
+ *
+ * When greater than `0`, pending requests with packet ID (QoS `1` and `2` publish, subscribe, unsubscribe)
+ * are indexed by packet ID and acknowledge from server finds request in constant time.
+ * At most this number of consecutive packet IDs can wait for acknowledge at the same time,
+ * new request is rejected when it would collide with the oldest unacknowledged one.
+ *
+ * Set to `0` to find requests with linear search over all \ref ESP_CFG_MQTT_MAX_REQUESTS requests
+ *
+ * \note            Value must be power of `2` and not greater than \ref ESP_CFG_MQTT_MAX_REQUESTS
+ */
+#ifndef ESP_CFG_MQTT_INFLIGHT_WINDOW
+#define ESP_CFG_MQTT_INFLIGHT_WINDOW        0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` streaming delivery of received PUBLISH packets
+ *
+ * When enabled, PUBLISH packet which does not fit into single received pbuf
+ * is not reassembled in RX buffer. Topic (and packet ID) are collected in RX buffer
+ * and payload is reported in chunks directly from received pbufs,
+ * with multiple \ref ESP_MQTT_EVT_PUBLISH_RECV events per packet.
+ *
+ * Only topic must fit into RX buffer, payload length is not limited by it.
+ *
+ * \note            Use \ref esp_mqtt_client_evt_publish_recv_get_payload_offset and
+ *                  \ref esp_mqtt_client_evt_publish_recv_get_payload_total_len
+ *                  to reconstruct payload in application
+ */
+#ifndef ESP_CFG_MQTT_PUBLISH_STREAM
+#define ESP_CFG_MQTT_PUBLISH_STREAM         0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` publishing payload directly from user memory
+ *
+ * When enabled, \ref esp_mqtt_client_publish_ref writes only packet header and topic
+ * to client output buffer and sends payload from user memory,
+ * so output buffer does not need to be as big as largest published message
+ */
+#ifndef ESP_CFG_MQTT_PUBLISH_REF
+#define ESP_CFG_MQTT_PUBLISH_REF            0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` QoS 0 publish without request tracking
+ *
+ * When enabled and turned on for client with \ref esp_mqtt_client_set_qos0_fast,
+ * QoS 0 packets are written to output buffer without request entry,
+ * so number of queued QoS 0 packets is not limited by \ref ESP_CFG_MQTT_MAX_REQUESTS.
+ * \ref ESP_MQTT_EVT_PUBLISH event is not sent for such packets
+ */
+#ifndef ESP_CFG_MQTT_QOS0_FAST
+#define ESP_CFG_MQTT_QOS0_FAST              0
+#endif
+
+/**
+ * \brief           Number of preallocated receive slots in MQTT API client
+ *
+ * When set to value greater than `0`, MQTT API client allocates fixed number
+ * of receive buffers at creation, each big enough for RX buffer length
+ * (topic and payload), and uses them for incoming PUBLISH packets
+ * instead of allocating new memory for every packet.
+ *
+ * Set to `0` to allocate memory from heap for every received packet
+ *
+ * \note            Packet which does not fit into single slot is discarded
+ */
+/**
+ * \brief           MQTT publish linger time in units of milliseconds
+ *
+ * When greater than `0`, PUBLISH packet is not sent immediately if connection is idle.
+ * Client waits up to this time for more packets, to send all of them
+ * with single TCP send command.
+ *
+ * Set to `0` to send every packet as soon as possible
+ *
+ * \sa              ESP_CFG_MQTT_TX_LINGER_LEN
+ */
+#ifndef ESP_CFG_MQTT_TX_LINGER_TIME
+#define ESP_CFG_MQTT_TX_LINGER_TIME         0
+#endif
+
+/**
+ * \brief           Number of bytes in MQTT output buffer to send data before linger time expires
+ *
+ * When set to `0`, data are sent only when \ref ESP_CFG_MQTT_TX_LINGER_TIME expires
+ *
+ * \note            Used only when \ref ESP_CFG_MQTT_TX_LINGER_TIME is greater than `0`
+ */
+#ifndef ESP_CFG_MQTT_TX_LINGER_LEN
+#define ESP_CFG_MQTT_TX_LINGER_LEN          0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` topic handlers in MQTT client
+ *
+ * When enabled, callback function can be assigned to topic filter
+ * with \ref esp_mqtt_client_topic_handler_add.
+ * Filters (including `+` and `#` wildcards) are kept in a trie, one node per topic level,
+ * and received PUBLISH packet is dispatched to all matching handlers
+ * in time proportional to topic depth.
+ *
+ * Packets without matching handler are reported with \ref ESP_MQTT_EVT_PUBLISH_RECV event
+ */
+#ifndef ESP_CFG_MQTT_TOPIC_TRIE
+#define ESP_CFG_MQTT_TOPIC_TRIE             0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` keep-alive statistics of MQTT client
+ *
+ * When enabled, client counts sent `PINGREQ` and received `PINGRESP` packets
+ * and keep-alive periods where `PINGREQ` was not needed because other packet was being sent.
+ * Statistics are available with \ref esp_mqtt_client_get_stats function
+ */
+#ifndef ESP_CFG_MQTT_STATS
+#define ESP_CFG_MQTT_STATS                  0
+#endif
+
+/**
+ * \brief           Number of subscriptions remembered by MQTT client and sent again on new connection
+ *
+ * Successful \ref esp_mqtt_client_subscribe calls are remembered until \ref esp_mqtt_client_unsubscribe.
+ * When server accepts next connection, remembered topics are subscribed again
+ * before \ref ESP_MQTT_EVT_CONNECT event, which reports them with `NULL` argument.
+ * Application reconnecting after device reset therefore does not need to subscribe again.
+ *
+ * Set to `0` to disable feature
+ */
+#ifndef ESP_CFG_MQTT_RESUBSCRIBE
+#define ESP_CFG_MQTT_RESUBSCRIBE            0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` MQTT client on top of ESP32 AT MQTT commands
+ *
+ * When enabled, \ref ESP_APP_MQTT_CLIENT functions are implemented with
+ * `AT+MQTTUSERCFG`, `AT+MQTTCONN`, `AT+MQTTPUBRAW`, `AT+MQTTSUB` and related commands.
+ * MQTT protocol runs on ESP device and no connection or output buffer is used on host side.
+ *
+ * Only one client can be active at a time.
+ * Options extending packet based client (such as \ref ESP_CFG_MQTT_V5) cannot be used
+ *
+ * \note            Requires \ref ESP_CFG_ESP32 and \ref ESP_CFG_USE_API_FUNC_EVT to be enabled
+ */
+#ifndef ESP_CFG_MQTT_AT
+#define ESP_CFG_MQTT_AT                     0
+#endif
+
+#ifndef ESP_CFG_MQTT_API_RX_SLOTS
+#define ESP_CFG_MQTT_API_RX_SLOTS           0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` dropping oldest queued packet when all receive slots are in use
+ *
+ * When disabled, newly received packet is discarded if there is no free slot.
+ * When enabled, oldest packet not yet read by \ref esp_mqtt_client_api_receive is discarded
+ * and its slot is used for new packet
+ *
+ * \note            Used only when \ref ESP_CFG_MQTT_API_RX_SLOTS is greater than `0`
+ */
+#ifndef ESP_CFG_MQTT_API_RX_SLOTS_DROP_OLDEST
+#define ESP_CFG_MQTT_API_RX_SLOTS_DROP_OLDEST   0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` receive groups for MQTT API clients
+ *
+ * Clients added to the same group with \ref esp_mqtt_client_api_set_group
+ * deliver received packets and closed events to one shared queue,
+ * read with \ref esp_mqtt_client_api_receive_any,
+ * so single thread can handle receive path of multiple clients
+ */
+#ifndef ESP_CFG_MQTT_API_GROUP
+#define ESP_CFG_MQTT_API_GROUP              0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` offline queue for MQTT PUBLISH packets
+ *
+ * When enabled with \ref esp_mqtt_client_set_offline_queue, packets published
+ * while client is not connected are stored to queue and sent in bulk after
+ * connection with server is accepted.
+ * Queue is kept in RAM or in user storage (such as flash) and survives reconnects
+ *
+ * \sa              ESP_CFG_MQTT_OFFLINE_QUEUE_SIZE
+ */
+#ifndef ESP_CFG_MQTT_OFFLINE_QUEUE
+#define ESP_CFG_MQTT_OFFLINE_QUEUE          0
+#endif
+
+/**
+ * \brief           Size of RAM offline queue in units of bytes
+ *
+ * Each queued packet uses its topic and payload length and additional header
+ *
+ * \note            Used only when \ref ESP_CFG_MQTT_OFFLINE_QUEUE is enabled
+ *                  and user storage is not set for client
+ */
+#ifndef ESP_CFG_MQTT_OFFLINE_QUEUE_SIZE
+#define ESP_CFG_MQTT_OFFLINE_QUEUE_SIZE     1024
+#endif
+
+/**
+ * \brief           Set debug level for MQTT client module
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_MQTT
+#define ESP_CFG_DBG_MQTT                    ESP_DBG_OFF
+#endif
+
+/**
+ * \brief           Set debug level for MQTT API client module
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_MQTT_API
+#define ESP_CFG_DBG_MQTT_API                ESP_DBG_OFF
+#endif
+
+/**
+ * \}
+ */
+
+/**
+ * \defgroup        ESP_CONFIG_MODULES_CAYENNE Cayenne MQTT client
+ * \brief           Configuration of Cayenne MQTT client
+ * \{
+ */
+
+/**
+ * \brief           Set debug level for Cayenne MQTT client module
+ *
+ * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ */
+#ifndef ESP_CFG_DBG_CAYENNE
+#define ESP_CFG_DBG_CAYENNE                 ESP_DBG_OFF
+#endif
+
+/**
+ * \}
+ */
+
+/**
+ * \defgroup        ESP_CONFIG_MODULES_HTTP_CLIENT HTTP client
+ * \brief           Configuration of HTTP client
+ * \{
+ */
+
+/**
+ * \brief           Enables `1` or disables `0` HTTP client on top of ESP32 `AT+HTTPCLIENT` command
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * When enabled, \ref ESP_APP_HTTP_CLIENT requests are executed by device
+ * and only response body is transferred to host. No connection is used on host side.
+ *
+ * Device does not report response status and headers, request body is sent as string
+ * and cannot be streamed from callback
+ *
+ * \note            Requires \ref ESP_CFG_ESP32 to be enabled
  */
-#ifndef ESP_CFG_DBG_INPUT
-#define ESP_CFG_DBG_INPUT                   ESP_DBG_OFF
+#ifndef ESP_CFG_HTTP_CLIENT_AT
+#define ESP_CFG_HTTP_CLIENT_AT              0
 #endif
 
 /**
- * \brief           Set debug level for ESP threads
+ * \brief           Maximal length of response status or header line in units of bytes
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * Longer header lines are truncated before they are passed to application
  */
-#ifndef ESP_CFG_DBG_THREAD
-#define ESP_CFG_DBG_THREAD                  ESP_DBG_OFF
+#ifndef ESP_CFG_HTTP_CLIENT_LINE_LEN
+#define ESP_CFG_HTTP_CLIENT_LINE_LEN        128
 #endif
 
 /**
- * \brief           Set debug level for asserting of input variables
- *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * \brief           Size of buffer for request body read from callback in units of bytes
  */
-#ifndef ESP_CFG_DBG_ASSERT
-#define ESP_CFG_DBG_ASSERT                  ESP_DBG_OFF
+#ifndef ESP_CFG_HTTP_CLIENT_BODY_BUFF_LEN
+#define ESP_CFG_HTTP_CLIENT_BODY_BUFF_LEN   256
 #endif
 
 /**
- * \brief           Set debug level for incoming data received from device
+ * \brief           Time in units of milliseconds to wait for response data
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * \note            Used only when \ref ESP_CFG_NETCONN_RECEIVE_TIMEOUT is enabled
  */
-#ifndef ESP_CFG_DBG_IPD
-#define ESP_CFG_DBG_IPD                     ESP_DBG_OFF
+#ifndef ESP_CFG_HTTP_CLIENT_TIMEOUT
+#define ESP_CFG_HTTP_CLIENT_TIMEOUT         10000
 #endif
 
 /**
- * \brief           Set debug level for netconn sequential API
+ * \brief           Set debug level for HTTP client module
  *
  * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
  */
-#ifndef ESP_CFG_DBG_NETCONN
-#define ESP_CFG_DBG_NETCONN                 ESP_DBG_OFF
+#ifndef ESP_CFG_DBG_HTTP_CLIENT
+#define ESP_CFG_DBG_HTTP_CLIENT             ESP_DBG_OFF
 #endif
 
 /**
- * \brief           Set debug level for packet buffer manager
- *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * \}
  */
-#ifndef ESP_CFG_DBG_PBUF
-#define ESP_CFG_DBG_PBUF                    ESP_DBG_OFF
-#endif
 
 /**
- * \brief           Set debug level for connections
- *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * \defgroup        ESP_CONFIG_MODULES_DOWNLOAD Streaming download
+ * \brief           Configuration of streaming download to storage
+ * \{
  */
-#ifndef ESP_CFG_DBG_CONN
-#define ESP_CFG_DBG_CONN                    ESP_DBG_OFF
-#endif
 
 /**
- * \brief           Set debug level for dynamic variable allocations
+ * \brief           Default size of one download block in units of bytes
  *
- *                  Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * Writer callback receives data in blocks of this size, except for the last one.
+ * Set it to flash page or sector size to program storage in aligned chunks
  */
-#ifndef ESP_CFG_DBG_VAR
-#define ESP_CFG_DBG_VAR                     ESP_DBG_OFF
+#ifndef ESP_CFG_DOWNLOAD_BLOCK_LEN
+#define ESP_CFG_DOWNLOAD_BLOCK_LEN          1024
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` echo mode on AT commands
- *                  sent to ESP device.
+ * \brief           Number of download blocks cycled between network and writer
  *
- * \note            This mode is useful when debugging ESP communication
+ * With `2` blocks, one is filled from network while the other one is written to storage.
+ * More blocks absorb longer writer stalls, such as sector erase
  */
-#ifndef ESP_CFG_AT_ECHO
-#define ESP_CFG_AT_ECHO                     0
+#ifndef ESP_CFG_DOWNLOAD_BLOCK_CNT
+#define ESP_CFG_DOWNLOAD_BLOCK_CNT          2
 #endif
 
 /**
@@ -405,179 +2127,221 @@
  */
 
 /**
- * \defgroup        ESP_CONFIG_OS OS configuration
- * \brief           Operating system dependant configuration
- * \{
+ * \brief           Enables `1` or disables `0` support for DNS functions
+ *
  */
+#ifndef ESP_CFG_DNS
+#define ESP_CFG_DNS                         0
+#endif
 
 /**
- * \brief           Set number of message queue entries for procuder thread
+ * \brief           Number of host names kept in local DNS cache
  *
- * Message queue is used for storing memory address to command data
+ * When set to value greater than `0`, resolved addresses are cached
+ * and \ref esp_dns_gethostbyname returns immediately on hit.
+ * Addresses of successful TCP and UDP connections started by host name are cached too
+ * and used with next `AT+CIPSTART` to the same host.
+ * Least recently used entry is replaced when cache is full.
+ *
+ * \note            Requires \ref ESP_CFG_DNS to be enabled
  */
-#ifndef ESP_CFG_THREAD_PRODUCER_MBOX_SIZE
-#define ESP_CFG_THREAD_PRODUCER_MBOX_SIZE   16
+#ifndef ESP_CFG_DNS_CACHE_SIZE
+#define ESP_CFG_DNS_CACHE_SIZE              0
 #endif
 
 /**
- * \brief           Set number of message queue entries for processing thread
- *
- * Message queue is used to notify processing thread about new received data on AT port
+ * \brief           Time in units of milliseconds how long DNS cache entry is valid
+ * \note            Used only when \ref ESP_CFG_DNS_CACHE_SIZE is greater than `0`
  */
-#ifndef ESP_CFG_THREAD_PROCESS_MBOX_SIZE
-#define ESP_CFG_THREAD_PROCESS_MBOX_SIZE    16
+#ifndef ESP_CFG_DNS_CACHE_TTL
+#define ESP_CFG_DNS_CACHE_TTL               300000
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` direct support for processing input data
- *
- * When this mode is enabled, no overhead is included for copying data
- * to receive buffer because bytes are processed directly by \ref esp_input_process function
- *
- * If this mode is not enabled, then user have to send every received byte via \ref esp_input
- * function to the internal buffer for future processing. This may introduce additional overhead
- * with data copy and may decrease library performance
- *
- * \note            This mode can only be used when \ref ESP_CFG_OS is enabled
+ * \brief           Maximal length of host name in DNS cache, including `NULL` termination
  *
- * \note            When using this mode, separate thread must be dedicated only
- *                  for reading data on AT port. It is usually implemented in LL driver
+ * Longer host names are not cached
  *
- * \note            Best case for using this mode is if DMA receive is supported by host device
+ * \note            Used only when \ref ESP_CFG_DNS_CACHE_SIZE is greater than `0`
  */
-#ifndef ESP_CFG_INPUT_USE_PROCESS
-#define ESP_CFG_INPUT_USE_PROCESS           0
+#ifndef ESP_CFG_DNS_CACHE_HOST_LEN
+#define ESP_CFG_DNS_CACHE_HOST_LEN          64
 #endif
 
 /**
- * \brief           Producer thread hook, called each time thread wakes-up and does the processing.
+ * \brief           Enables `1` or disables `0` support for WPS functions
  *
- * It can be used to check if thread is alive.
  */
-#ifndef ESP_THREAD_PRODUCER_HOOK
-#define ESP_THREAD_PRODUCER_HOOK()
+#ifndef ESP_CFG_WPS
+#define ESP_CFG_WPS                         0
 #endif
 
 /**
- * \brief           Process thread hook, called each time thread wakes-up and does the processing.
+ * \brief           Enables `1` or disables `0` support for SNTP protocol with AT commands
  *
- * It can be used to check if thread is alive.
  */
-#ifndef ESP_THREAD_PROCESS_HOOK
-#define ESP_THREAD_PROCESS_HOOK()
+#ifndef ESP_CFG_SNTP
+#define ESP_CFG_SNTP                        0
 #endif
 
 /**
- * \}
+ * \brief           Interval in units of milliseconds to synchronize local SNTP time cache
+ *
+ * After first successful \ref esp_sntp_gettime call, time is read from device periodically
+ * and \ref esp_sntp_gettime returns cached time extrapolated with \ref esp_sys_now without AT command.
+ * Cached time is used until it is older than `2` intervals, allowing one failed synchronization.
+ *
+ * Set to `0` to disable cache and read time from device on every call
+ *
+ * \note            Requires \ref ESP_CFG_SNTP to be enabled
+ * \sa              esp_sntp_get_sync_age
  */
+#ifndef ESP_CFG_SNTP_SYNC_INTERVAL
+#define ESP_CFG_SNTP_SYNC_INTERVAL          0
+#endif
 
 /**
- * \defgroup        ESP_CONFIG_MODULES Modules
- * \brief           Configuration of specific modules
- * \{
+ * \brief           Enables `1` or disables `0` support for hostname with AT commands
+ *
  */
+#ifndef ESP_CFG_HOSTNAME
+#define ESP_CFG_HOSTNAME                    0
+#endif
 
 /**
- * \defgroup        ESP_CONFIG_MODULES_NETCONN Netconn module
- * \brief           Configuration of netconn API module
- * \{
+ * \brief           Enables `1` or disables `0` support for sleep modes with AT commands
+ *
+ * When light-sleep is active and low-level driver sets \ref esp_ll_t.wakeup_fn,
+ * device is woken up before every command sent after idle period
+ *
+ * \sa              ESP_CFG_SLEEP_WAKE_TIME, ESP_CFG_SLEEP_IDLE_TIME
  */
+#ifndef ESP_CFG_SLEEP
+#define ESP_CFG_SLEEP                       0
+#endif
 
 /**
- * \brief           Enables `1` or disables `0` NETCONN sequential API support for OS systems
+ * \brief           Time in units of milliseconds device needs after wakeup pulse
+ *                  before it accepts AT commands in light-sleep mode
  *
- * \note            To use this feature, OS support is mandatory.
- * \sa              ESP_CFG_OS
+ * \note            Used only when \ref ESP_CFG_SLEEP is enabled
  */
-#ifndef ESP_CFG_NETCONN
-#define ESP_CFG_NETCONN                     0
+#ifndef ESP_CFG_SLEEP_WAKE_TIME
+#define ESP_CFG_SLEEP_WAKE_TIME             5
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` receive timeout feature
+ * \brief           Time in units of milliseconds device is considered awake
+ *                  after last communication in light-sleep mode
  *
- * When this option is enabled, user will get an option
- * to set timeout value for receive data on netconn,
- * before function returns timeout error.
+ * Commands started within this time after last received data or finished command
+ * are sent without wakeup pulse and delay.
+ * Set to `0` to wake up device before every command.
  *
- * \note            Even if this option is enabled, user must still manually set timeout,
- *                  by default time will be set to 0 which means no timeout.
+ * \note            Used only when \ref ESP_CFG_SLEEP is enabled
  */
-#ifndef ESP_CFG_NETCONN_RECEIVE_TIMEOUT
-#define ESP_CFG_NETCONN_RECEIVE_TIMEOUT     1
+#ifndef ESP_CFG_SLEEP_IDLE_TIME
+#define ESP_CFG_SLEEP_IDLE_TIME             0
 #endif
 
 /**
- * \brief           Accept queue length for new client when netconn server is used
+ * \brief           Maximal time in units of milliseconds for remote software update
  *
- * Defines number of maximal clients waiting in accept queue of server connection
+ * Used as command block time of \ref esp_update_sw or as time limit
+ * of background update when \ref ESP_CFG_UPDATE_ASYNC is enabled
  */
-#ifndef ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN
-#define ESP_CFG_NETCONN_ACCEPT_QUEUE_LEN    5
+#ifndef ESP_CFG_UPDATE_TIMEOUT
+#define ESP_CFG_UPDATE_TIMEOUT              180000
 #endif
 
 /**
- * \brief           Receive queue length for pbuf entries
+ * \brief           Enables `1` or disables `0` background remote software update
  *
- * Defines maximal number of pbuf data packet references for receive
+ * \ref esp_update_sw finishes as soon as device reports first update stage
+ * and update continues in background. Stages are reported with \ref ESP_EVT_UPDATE_PROGRESS
+ * and final result with \ref ESP_EVT_UPDATE event.
+ *
+ * While update is in progress, only commands accepted by \ref ESP_CFG_UPDATE_CMD_ALLOWED
+ * are sent to device, others finish immediately with \ref espINPROG result
+ *
+ * \note            Station mode must be enabled to use this feature
  */
-#ifndef ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN
-#define ESP_CFG_NETCONN_RECEIVE_QUEUE_LEN   8
+#ifndef ESP_CFG_UPDATE_ASYNC
+#define ESP_CFG_UPDATE_ASYNC                0
 #endif
 
 /**
- * \}
- */
-
-/**
- * \defgroup        ESP_CONFIG_MODULES_MQTT MQTT client module
- * \brief           Configuration of MQTT and MQTT API client modules
- * \{
+ * \brief           Check if command can be executed during background software update
+ *
+ * Default value rejects all commands. To keep status polling running, set it for example to
+ * `((cmd) == ESP_CMD_SYSRAM || (cmd) == ESP_CMD_TCPIP_CIPSTATUS)`.
+ * Commands device answers with `busy` finish with error.
+ * No command is sent after last update stage, when device only waits to report final result
+ *
+ * \note            Used only when \ref ESP_CFG_UPDATE_ASYNC is enabled
+ * \param[in]       cmd: Command type of \ref esp_cmd_t enumeration
  */
+#ifndef ESP_CFG_UPDATE_CMD_ALLOWED
+#define ESP_CFG_UPDATE_CMD_ALLOWED(cmd)     0
+#endif
 
 /**
- * \brief           Maximal number of open MQTT requests at a time
+ * \brief           Enables `1` or disables `0` support for ping functions
  *
  */
-#ifndef ESP_CFG_MQTT_MAX_REQUESTS
-#define ESP_CFG_MQTT_MAX_REQUESTS           8
+#ifndef ESP_CFG_PING
+#define ESP_CFG_PING                        0
 #endif
 
 /**
- * \brief           Set debug level for MQTT client module
+ * \brief           Enables `1` or disables `0` support for mDNS
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
  */
-#ifndef ESP_CFG_DBG_MQTT
-#define ESP_CFG_DBG_MQTT                    ESP_DBG_OFF
+#ifndef ESP_CFG_MDNS
+#define ESP_CFG_MDNS                        0
 #endif
 
 /**
- * \brief           Set debug level for MQTT API client module
+ * \brief           Enables `1` or disables `0` BLE data channel on ESP32 GATT server
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * Device runs default GATT server of AT firmware. Data written by BLE client
+ * are reported with \ref ESP_EVT_BLE_RECV event and data are sent back as notifications,
+ * without entering transparent mode, so WiFi commands can run at the same time
+ *
+ * \note            Requires \ref ESP_CFG_ESP32 to be enabled
  */
-#ifndef ESP_CFG_DBG_MQTT_API
-#define ESP_CFG_DBG_MQTT_API                ESP_DBG_OFF
+#ifndef ESP_CFG_BLE
+#define ESP_CFG_BLE                         0
 #endif
 
 /**
- * \}
+ * \brief           Index of GATT service used for BLE data channel
+ *
+ * \note            Used only when \ref ESP_CFG_BLE is enabled
  */
+#ifndef ESP_CFG_BLE_SRV_INDEX
+#define ESP_CFG_BLE_SRV_INDEX               1
+#endif
 
 /**
- * \defgroup        ESP_CONFIG_MODULES_CAYENNE Cayenne MQTT client
- * \brief           Configuration of Cayenne MQTT client
- * \{
+ * \brief           Index of characteristic in \ref ESP_CFG_BLE_SRV_INDEX service used to notify client
+ *
+ * \note            Used only when \ref ESP_CFG_BLE is enabled
  */
+#ifndef ESP_CFG_BLE_NTFY_CHAR_INDEX
+#define ESP_CFG_BLE_NTFY_CHAR_INDEX         6
+#endif
 
 /**
- * \brief           Set debug level for Cayenne MQTT client module
+ * \brief           Maximal number of bytes sent with single notification
  *
- * Possible values are \ref ESP_DBG_ON or \ref ESP_DBG_OFF
+ * Set to `MTU - 3` of connection. Default value matches default BLE MTU of `23` bytes.
+ * Longer data are split to multiple notifications by \ref esp_ble_send
+ *
+ * \note            Used only when \ref ESP_CFG_BLE is enabled
  */
-#ifndef ESP_CFG_DBG_CAYENNE
-#define ESP_CFG_DBG_CAYENNE                 ESP_DBG_OFF
+#ifndef ESP_CFG_BLE_NTFY_LEN
+#define ESP_CFG_BLE_NTFY_LEN                20
 #endif
 
 /**
@@ -585,66 +2349,107 @@
  */
 
 /**
- * \brief           Enables `1` or disables `0` support for DNS functions
+ * \brief           Enables `1` or disables `0` caching of SSL configuration
  *
+ * When enabled, successful \ref esp_conn_set_ssl_buffersize and \ref esp_conn_ssl_configure
+ * settings are remembered by the library and replayed as part of reset sequence,
+ * so application does not need to send them again after every device reset
  */
-#ifndef ESP_CFG_DNS
-#define ESP_CFG_DNS                         0
+#ifndef ESP_CFG_CONN_SSL_CFG_CACHE
+#define ESP_CFG_CONN_SSL_CFG_CACHE          0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` support for WPS functions
+ * \brief           Enables `1` or disables `0` trusting `+LINK_CONN` and `CLOSED` messages for connection state
+ *
+ * By default, \ref esp_conn_start sends `AT+CIPSTATUS` before and after `AT+CIPSTART`
+ * to synchronize connection table with device. When enabled, connection table is kept
+ * from system messages only and `AT+CIPSTATUS` is sent after `AT+CIPSTART`
+ * only when device did not report `+LINK_CONN` for new connection
  *
+ * \sa              ESP_CFG_CONN_STATUS_CHECK_INTERVAL
  */
-#ifndef ESP_CFG_WPS
-#define ESP_CFG_WPS                         0
+#ifndef ESP_CFG_CONN_STATUS_TRUST_EVENTS
+#define ESP_CFG_CONN_STATUS_TRUST_EVENTS    0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` support for SNTP protocol with AT commands
+ * \brief           Remote IP and port reporting in `+IPD` headers (`AT+CIPDINFO`)
+ *
+ * Possible values:
  *
+ *  - `0`: Disabled. Remote IP and port are taken from `+LINK_CONN` message
+ *          and are not updated per received packet
+ *  - `1`: Enabled. Every received packet carries remote IP and port
+ *  - `2`: Automatic. Enabled only while UDP connections are active.
+ *          Setting is switched before `AT+CIPSTART` when required
+ *
+ * Disabling saves about `20` bytes and address parsing on every received packet.
+ * TCP peer never changes during connection, while UDP peer may change
+ * for connections started in UDP mode `1` or `2`.
  */
-#ifndef ESP_CFG_SNTP
-#define ESP_CFG_SNTP                        0
+#ifndef ESP_CFG_CONN_IPD_INFO
+#define ESP_CFG_CONN_IPD_INFO               1
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` support for hostname with AT commands
+ * \brief           Interval in units of milliseconds for background connection table consistency check
  *
+ * When non-zero, \ref esp_get_conns_status is periodically called in non-blocking mode.
+ * Set to `0` to disable periodic check.
+ *
+ * \note            Intended to be used with \ref ESP_CFG_CONN_STATUS_TRUST_EVENTS and long interval
  */
-#ifndef ESP_CFG_HOSTNAME
-#define ESP_CFG_HOSTNAME                    0
+#ifndef ESP_CFG_CONN_STATUS_CHECK_INTERVAL
+#define ESP_CFG_CONN_STATUS_CHECK_INTERVAL  0
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` support for ping functions
+ * \brief           Poll interval for connections in units of milliseconds
+ *
+ * Value indicates interval time to call poll event on active connections.
  *
+ * \note            Single poll interval applies for all connections
  */
-#ifndef ESP_CFG_PING
-#define ESP_CFG_PING                        0
+#ifndef ESP_CFG_CONN_POLL_INTERVAL
+#define ESP_CFG_CONN_POLL_INTERVAL          500
 #endif
 
 /**
- * \brief           Enables `1` or disables `0` support for mDNS
+ * \brief           Enables `1` or disables `0` opt-in connection poll events
+ *
+ * When enabled, new connections do not receive \ref ESP_EVT_CONN_POLL events
+ * until interval is set with \ref esp_conn_set_poll_interval.
+ * When disabled, every new connection is polled with \ref ESP_CFG_CONN_POLL_INTERVAL.
  *
+ * \note            All connections are served by single timer in both cases
  */
-#ifndef ESP_CFG_MDNS
-#define ESP_CFG_MDNS                        0
+#ifndef ESP_CFG_CONN_POLL_OPT_IN
+#define ESP_CFG_CONN_POLL_OPT_IN            0
 #endif
 
 /**
- * \}
+ * \brief           Enables `1` or disables `0` hierarchical timer wheel for timeout manager
+ *
+ * When enabled, timeouts are kept in `4` levels of `64` slots instead of
+ * single sorted linked list. Starting and stopping timeout is done in constant time
+ * and timeouts may use user provided \ref esp_timeout_t handles,
+ * started with \ref esp_timeout_start and stopped with \ref esp_timeout_stop.
+ *
+ * Connection poll timeouts use preallocated handles in this mode.
  */
+#ifndef ESP_CFG_TIMEOUT_WHEEL
+#define ESP_CFG_TIMEOUT_WHEEL               0
+#endif
 
 /**
- * \brief           Poll interval for connections in units of milliseconds
- *
- * Value indicates interval time to call poll event on active connections.
+ * \brief           Timer wheel tick in units of milliseconds
  *
- * \note            Single poll interval applies for all connections
+ * Timeouts are rounded up to this resolution.
+ * Maximal timeout is `64^4` ticks
  */
-#ifndef ESP_CFG_CONN_POLL_INTERVAL
-#define ESP_CFG_CONN_POLL_INTERVAL          500
+#ifndef ESP_CFG_TIMEOUT_WHEEL_TICK
+#define ESP_CFG_TIMEOUT_WHEEL_TICK          10
 #endif
 
 /**
@@ -663,6 +2468,88 @@
 #define ESP_CFG_CONN_MANUAL_TCP_RECEIVE     0
 #endif
 
+/**
+ * \brief           Maximal number of bytes read from device with single read command
+ *                  when \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE is enabled
+ *
+ * Actual read length adapts to number of bytes available on device
+ * and to largest free memory block, when \ref ESP_CFG_MEM_STATS is enabled.
+ * Larger reads lower command overhead per byte.
+ *
+ * \note            Maximal value supported by device depends on AT firmware
+ */
+#ifndef ESP_CFG_CONN_MANUAL_TCP_RECEIVE_MAX_LEN
+#define ESP_CFG_CONN_MANUAL_TCP_RECEIVE_MAX_LEN ESP_CFG_CONN_MAX_DATA_LEN
+#endif
+
+/**
+ * \brief           Maximal number of bytes read from device but not yet acknowledged
+ *                  by application with \ref esp_conn_recved, per connection
+ *
+ * When limit is reached, stack stops reading data from device
+ * until application acknowledges received data. Set to `0` to disable limit
+ *
+ * \note            Used only when \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE is enabled
+ */
+#ifndef ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW
+#define ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW  0
+#endif
+
+/**
+ * \brief           Number of bytes acknowledged with \ref esp_conn_recved before next read command is started
+ *
+ * Acknowledgements accumulate until at least this many bytes are acknowledged
+ * or until all read data are acknowledged. Reads are then fewer and larger,
+ * receive window still limits data not acknowledged by application.
+ * Connection poll still starts reads periodically. Set to `0` to start read on every acknowledgement
+ *
+ * \note            Used only when \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE is enabled
+ */
+#ifndef ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH
+#define ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH   0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` prioritized manual `TCP` receive scheduling
+ *
+ * When enabled, only one read command is queued at a time for all connections.
+ * Next connection to read from is chosen by receive priority, set with \ref esp_conn_set_recv_priority,
+ * connections with same priority are served in round-robin order.
+ * Each connection may also have own receive window, set with \ref esp_conn_set_recv_window,
+ * instead of \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW
+ *
+ * \note            Used only when \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE is enabled
+ */
+#ifndef ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO
+#define ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO    0
+#endif
+
+/**
+ * \brief           Enables `1` or disables `0` transparent (passthrough) connection mode
+ *
+ * In transparent mode, single client connection is started with `AT+CIPMODE=1`
+ * and all data on AT port are raw connection data without `+IPD` or `AT+CIPSEND` framing.
+ *
+ * \note            Transparent mode requires single connection mode (`AT+CIPMUX=0`),
+ *                  therefore no other connection or server may be active when it is started.
+ *                  While connection is in transparent mode, other AT commands are rejected.
+ *
+ * \sa              esp_conn_start_transparent, esp_conn_stop_transparent
+ */
+#ifndef ESP_CFG_CONN_TRANSPARENT
+#define ESP_CFG_CONN_TRANSPARENT            0
+#endif
+
+/**
+ * \brief           Guard time in units of milliseconds before and after `+++` sequence
+ *                  used to exit transparent mode
+ *
+ * \note            AT firmware requires at least `1` second of silence before and after sequence
+ */
+#ifndef ESP_CFG_CONN_TRANSPARENT_GUARD_TIME
+#define ESP_CFG_CONN_TRANSPARENT_GUARD_TIME 1000
+#endif
+
 /**
  * \defgroup        ESP_CONFIG_STD_LIB Standard library
  * \brief           Standard C library configuration
@@ -741,6 +2628,9 @@ void *  my_memset(void* dst, int b, size_t len);
     #if ESP_CFG_INPUT_USE_PROCESS
     #error "ESP_CFG_INPUT_USE_PROCESS may only be enabled when OS is used!"
     #endif /* ESP_CFG_INPUT_USE_PROCESS */
+    #if ESP_CFG_EVT_DEFERRED
+    #error "ESP_CFG_EVT_DEFERRED may only be enabled when OS is used!"
+    #endif /* ESP_CFG_EVT_DEFERRED */
 #endif /* !ESP_CFG_OS */
 
 /* Device config */
@@ -753,6 +2643,186 @@ void *  my_memset(void* dst, int b, size_t len);
 #error "WPS function may only be used when station mode is enabled!"
 #endif /* ESP_CFG_WPS && !ESP_CFG_MODE_STATION */
 
+/* Transparent mode config */
+#if ESP_CFG_CONN_TRANSPARENT && !ESP_CFG_MODE_STATION
+#error "Transparent connection mode may only be used when station mode is enabled!"
+#endif /* ESP_CFG_CONN_TRANSPARENT && !ESP_CFG_MODE_STATION */
+
+/* DNS cache config */
+#if ESP_CFG_MAX_CONNS < 1 || ESP_CFG_MAX_CONNS > 32
+#error "ESP_CFG_MAX_CONNS must be between 1 and 32!"
+#endif /* ESP_CFG_MAX_CONNS < 1 || ESP_CFG_MAX_CONNS > 32 */
+
+/* Single connection config */
+#if ESP_CFG_SINGLE_CONN
+#if ESP_CFG_MAX_CONNS != 1
+    #error "ESP_CFG_SINGLE_CONN requires ESP_CFG_MAX_CONNS to be set to 1!"
+#endif /* ESP_CFG_MAX_CONNS != 1 */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+    #error "ESP_CFG_SINGLE_CONN cannot be used with ESP_CFG_CONN_MANUAL_TCP_RECEIVE!"
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+#endif /* ESP_CFG_SINGLE_CONN */
+
+#if ESP_CFG_DNS_CACHE_SIZE > 0 && !ESP_CFG_DNS
+#error "ESP_CFG_DNS_CACHE_SIZE requires ESP_CFG_DNS to be enabled!"
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 && !ESP_CFG_DNS */
+
+#if ESP_CFG_SNTP_SYNC_INTERVAL > 0 && !ESP_CFG_SNTP
+#error "ESP_CFG_SNTP_SYNC_INTERVAL requires ESP_CFG_SNTP to be enabled!"
+#endif /* ESP_CFG_SNTP_SYNC_INTERVAL > 0 && !ESP_CFG_SNTP */
+
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 && !(ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP)
+#error "ESP_CFG_STA_LIST_AP_CACHE_SIZE requires ESP_CFG_MODE_STATION and ESP_CFG_STA_LIST_AP to be enabled!"
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 && !(ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP) */
+
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0 && !(ESP_CFG_MODE_ACCESS_POINT && ESP_CFG_AP_LIST_STA)
+#error "ESP_CFG_AP_STA_CACHE_SIZE requires ESP_CFG_MODE_ACCESS_POINT and ESP_CFG_AP_LIST_STA to be enabled!"
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 && !(ESP_CFG_MODE_ACCESS_POINT && ESP_CFG_AP_LIST_STA) */
+
+/* TLSF allocator config */
+#if ESP_CFG_MEM_TLSF && ESP_CFG_MEM_ALIGNMENT < 4
+#error "TLSF memory allocator requires ESP_CFG_MEM_ALIGNMENT of at least 4 bytes!"
+#endif /* ESP_CFG_MEM_TLSF && ESP_CFG_MEM_ALIGNMENT < 4 */
+
+#if ESP_CFG_MEM_PROFILE
+    #if !ESP_CFG_MEM_STATS
+    #error "ESP_CFG_MEM_PROFILE requires ESP_CFG_MEM_STATS to be enabled!"
+    #endif
+    #if ESP_CFG_MEM_PROFILE_SITES < 2 || ESP_CFG_MEM_PROFILE_SITES > 0xFFFF
+    #error "ESP_CFG_MEM_PROFILE_SITES must be between 2 and 65535!"
+    #endif
+#endif /* ESP_CFG_MEM_PROFILE */
+
+/* Static allocation mode config */
+#if ESP_CFG_MEM_STATIC
+    #if !ESP_CFG_MSG_POOL || !ESP_CFG_PBUF_POOL
+    #error "ESP_CFG_MEM_STATIC requires ESP_CFG_MSG_POOL and ESP_CFG_PBUF_POOL to be enabled!"
+    #endif
+    #if ESP_CFG_IPD_ZERO_COPY
+    #error "ESP_CFG_MEM_STATIC cannot be used with ESP_CFG_IPD_ZERO_COPY!"
+    #endif
+#endif /* ESP_CFG_MEM_STATIC */
+
+#if ESP_CFG_RX_STATS && ESP_CFG_INPUT_USE_PROCESS
+#error "ESP_CFG_RX_STATS cannot be used with ESP_CFG_INPUT_USE_PROCESS!"
+#endif /* ESP_CFG_RX_STATS && ESP_CFG_INPUT_USE_PROCESS */
+
+#if ESP_CFG_INPUT_FRAMED && !ESP_CFG_INPUT_USE_PROCESS
+#error "ESP_CFG_INPUT_FRAMED requires ESP_CFG_INPUT_USE_PROCESS to be enabled!"
+#endif /* ESP_CFG_INPUT_FRAMED && !ESP_CFG_INPUT_USE_PROCESS */
+
+#if ESP_CFG_INPUT_FLOW_CTRL
+    #if ESP_CFG_INPUT_USE_PROCESS
+    #error "ESP_CFG_INPUT_FLOW_CTRL cannot be used with ESP_CFG_INPUT_USE_PROCESS!"
+    #endif
+    #if ESP_CFG_INPUT_FLOW_LOW >= ESP_CFG_INPUT_FLOW_HIGH || ESP_CFG_INPUT_FLOW_HIGH >= ESP_CFG_RCV_BUFF_SIZE
+    #error "ESP_CFG_INPUT_FLOW_LOW must be lower than ESP_CFG_INPUT_FLOW_HIGH, which must be lower than ESP_CFG_RCV_BUFF_SIZE!"
+    #endif
+#endif /* ESP_CFG_INPUT_FLOW_CTRL */
+
+#if ESP_CFG_DBG_TRACE && (ESP_CFG_DBG_TRACE_LEN & (ESP_CFG_DBG_TRACE_LEN - 1)) != 0
+#error "ESP_CFG_DBG_TRACE_LEN must be power of 2!"
+#endif /* ESP_CFG_DBG_TRACE && (ESP_CFG_DBG_TRACE_LEN & (ESP_CFG_DBG_TRACE_LEN - 1)) != 0 */
+
+#if !ESP_CFG_OS
+    #if ESP_CFG_NETCONN || ESP_CFG_EVT_DEFERRED || ESP_CFG_SYS_THREAD_NOTIFY
+    #error "ESP_CFG_NETCONN, ESP_CFG_EVT_DEFERRED and ESP_CFG_SYS_THREAD_NOTIFY require ESP_CFG_OS to be enabled!"
+    #endif
+    #if ESP_CFG_THREAD_STATS
+    #error "ESP_CFG_THREAD_STATS requires ESP_CFG_OS to be enabled!"
+    #endif
+    #if ESP_CFG_INPUT_USE_PROCESS
+    #error "ESP_CFG_INPUT_USE_PROCESS requires ESP_CFG_OS to be enabled!"
+    #endif
+#endif /* !ESP_CFG_OS */
+
+#if ESP_CFG_CONN_SEND_PACING && ESP_CFG_CONN_SEND_PACING_MIN_LEN > ESP_CFG_CONN_MAX_DATA_LEN
+#error "ESP_CFG_CONN_SEND_PACING_MIN_LEN must not be greater than ESP_CFG_CONN_MAX_DATA_LEN!"
+#endif /* ESP_CFG_CONN_SEND_PACING && ESP_CFG_CONN_SEND_PACING_MIN_LEN > ESP_CFG_CONN_MAX_DATA_LEN */
+
+#if ESP_CFG_UPDATE_ASYNC && !ESP_CFG_MODE_STATION
+#error "ESP_CFG_UPDATE_ASYNC requires ESP_CFG_MODE_STATION to be enabled!"
+#endif /* ESP_CFG_UPDATE_ASYNC && !ESP_CFG_MODE_STATION */
+
+#if ESP_CFG_ASYNC && !ESP_CFG_USE_API_FUNC_EVT
+#error "ESP_CFG_ASYNC requires ESP_CFG_USE_API_FUNC_EVT to be enabled!"
+#endif /* ESP_CFG_ASYNC && !ESP_CFG_USE_API_FUNC_EVT */
+
+#if ESP_CFG_CMD_CANCEL && !ESP_CFG_USE_API_FUNC_EVT
+#error "ESP_CFG_CMD_CANCEL requires ESP_CFG_USE_API_FUNC_EVT to be enabled!"
+#endif /* ESP_CFG_CMD_CANCEL && !ESP_CFG_USE_API_FUNC_EVT */
+
+/* MQTT in-flight window config */
+#if ESP_CFG_MQTT_INFLIGHT_WINDOW > 0
+    #if (ESP_CFG_MQTT_INFLIGHT_WINDOW & (ESP_CFG_MQTT_INFLIGHT_WINDOW - 1)) != 0
+    #error "ESP_CFG_MQTT_INFLIGHT_WINDOW must be power of 2!"
+    #endif
+    #if ESP_CFG_MQTT_INFLIGHT_WINDOW > ESP_CFG_MQTT_MAX_REQUESTS
+    #error "ESP_CFG_MQTT_INFLIGHT_WINDOW must not be greater than ESP_CFG_MQTT_MAX_REQUESTS!"
+    #endif
+#endif /* ESP_CFG_MQTT_INFLIGHT_WINDOW > 0 */
+
+/* MQTT on AT commands config */
+#if ESP_CFG_MQTT_AT
+    #if !ESP_CFG_ESP32 || !ESP_CFG_USE_API_FUNC_EVT
+    #error "ESP_CFG_MQTT_AT requires ESP_CFG_ESP32 and ESP_CFG_USE_API_FUNC_EVT to be enabled!"
+    #endif
+    #if ESP_CFG_MQTT_V5 || ESP_CFG_MQTT_PUBLISH_STREAM || ESP_CFG_MQTT_PUBLISH_REF || ESP_CFG_MQTT_TOPIC_TRIE || ESP_CFG_MQTT_STATS || ESP_CFG_MQTT_OFFLINE_QUEUE || ESP_CFG_MQTT_RESUBSCRIBE || ESP_CFG_MQTT_QOS0_FAST
+    #error "ESP_CFG_MQTT_AT cannot be used with options of packet based MQTT client!"
+    #endif
+#endif /* ESP_CFG_MQTT_AT */
+
+/* BLE data channel config */
+#if ESP_CFG_BLE
+    #if !ESP_CFG_ESP32
+    #error "ESP_CFG_BLE requires ESP_CFG_ESP32 to be enabled!"
+    #endif
+    #if ESP_CFG_BLE_NTFY_LEN < 1 || ESP_CFG_BLE_NTFY_LEN > 512
+    #error "ESP_CFG_BLE_NTFY_LEN must be between 1 and 512!"
+    #endif
+#endif /* ESP_CFG_BLE */
+
+/* Streaming download config */
+#if ESP_CFG_DOWNLOAD_BLOCK_CNT < 2
+#error "ESP_CFG_DOWNLOAD_BLOCK_CNT must be at least 2!"
+#endif /* ESP_CFG_DOWNLOAD_BLOCK_CNT < 2 */
+
+/* HTTP client on AT commands config */
+#if ESP_CFG_HTTP_CLIENT_AT && !ESP_CFG_ESP32
+#error "ESP_CFG_HTTP_CLIENT_AT requires ESP_CFG_ESP32 to be enabled!"
+#endif /* ESP_CFG_HTTP_CLIENT_AT && !ESP_CFG_ESP32 */
+
+/* AT stream capture config, header and maximal record must fit with one byte of ring buffer reserve */
+#if ESP_CFG_AT_CAPTURE && ESP_CFG_AT_CAPTURE_BUFF_SIZE < 8 + 256 + 1
+#error "ESP_CFG_AT_CAPTURE_BUFF_SIZE must be at least 265 bytes!"
+#endif /* ESP_CFG_AT_CAPTURE && ESP_CFG_AT_CAPTURE_BUFF_SIZE < 8 + 256 + 1 */
+
+/* Configuration profile checks, reject combinations which overflow receive buffer or stall */
+#if ESP_CFG_PROFILE != ESP_CFG_PROFILE_NONE
+    #if !ESP_CFG_INPUT_USE_PROCESS && ESP_CFG_RCV_BUFF_SIZE <= ESP_CFG_IPD_MAX_BUFF_SIZE
+    #error "ESP_CFG_RCV_BUFF_SIZE must be larger than ESP_CFG_IPD_MAX_BUFF_SIZE!"
+    #endif
+    #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE && !ESP_CFG_INPUT_USE_PROCESS && ESP_CFG_RCV_BUFF_SIZE <= ESP_CFG_CONN_MANUAL_TCP_RECEIVE_MAX_LEN
+    #error "ESP_CFG_RCV_BUFF_SIZE must be larger than ESP_CFG_CONN_MANUAL_TCP_RECEIVE_MAX_LEN!"
+    #endif
+    #if ESP_CFG_RCV_BUFF_COMMIT_LEN >= ESP_CFG_RCV_BUFF_SIZE
+    #error "ESP_CFG_RCV_BUFF_COMMIT_LEN must be lower than ESP_CFG_RCV_BUFF_SIZE!"
+    #endif
+    #if ESP_CFG_PROFILE == ESP_CFG_PROFILE_LOW_POWER
+        #if !ESP_CFG_SLEEP
+        #error "ESP_CFG_PROFILE_LOW_POWER requires ESP_CFG_SLEEP to be enabled!"
+        #endif
+        #if ESP_CFG_CONN_STATUS_CHECK_INTERVAL > 0 && ESP_CFG_CONN_STATUS_CHECK_INTERVAL <= ESP_CFG_SLEEP_IDLE_TIME
+        #error "ESP_CFG_CONN_STATUS_CHECK_INTERVAL must be larger than ESP_CFG_SLEEP_IDLE_TIME or device never sleeps!"
+        #endif
+    #endif /* ESP_CFG_PROFILE == ESP_CFG_PROFILE_LOW_POWER */
+#endif /* ESP_CFG_PROFILE != ESP_CFG_PROFILE_NONE */
+
+/* Adaptive command timeout config */
+#if ESP_CFG_CMD_ADAPTIVE_TIMEOUT && ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR < 1
+#error "ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR must be at least 1!"
+#endif /* ESP_CFG_CMD_ADAPTIVE_TIMEOUT && ESP_CFG_CMD_ADAPTIVE_TIMEOUT_FACTOR < 1 */
+
 #endif /* !__DOXYGEN__ */
 
 #endif /* ESP_HDR_DEFAULT_CONFIG_H */
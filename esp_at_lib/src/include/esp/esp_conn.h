@@ -49,23 +49,49 @@ extern "C" {
     
 espr_t      esp_conn_start(esp_conn_p* conn, esp_conn_type_t type, const char* const remote_host, esp_port_t remote_port, void* const arg, esp_evt_fn conn_evt_fn, const uint32_t blocking);
 espr_t      esp_conn_startex(esp_conn_p* conn, esp_conn_start_t* start_struct, void* const arg, esp_evt_fn conn_evt_fn, const uint32_t blocking);
+espr_t      esp_conn_start_multi(esp_conn_p* conns, esp_conn_start_t* start_structs, size_t count, void* const arg, esp_evt_fn conn_evt_fn);
+
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+espr_t      esp_conn_start_transparent(esp_conn_p* conn, esp_conn_type_t type, const char* const remote_host, esp_port_t remote_port, void* const arg, esp_evt_fn conn_evt_fn, const uint32_t blocking);
+espr_t      esp_conn_stop_transparent(const uint32_t blocking);
+uint8_t     esp_conn_is_transparent(esp_conn_p conn);
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
 
 espr_t      esp_conn_close(esp_conn_p conn, const uint32_t blocking);
+espr_t      esp_conn_close_all(const uint32_t blocking);
 espr_t      esp_conn_send(esp_conn_p conn, const void* data, size_t btw, size_t* const bw, const uint32_t blocking);
+espr_t      esp_conn_send_ref(esp_conn_p conn, const void* data, size_t btw, esp_conn_release_fn release_fn, void* const release_arg, const uint32_t blocking);
 espr_t      esp_conn_sendto(esp_conn_p conn, const esp_ip_t* const ip, esp_port_t port, const void* data, size_t btw, size_t* bw, const uint32_t blocking);
 espr_t      esp_conn_set_arg(esp_conn_p conn, void* const arg);
+espr_t      esp_conn_set_poll_interval(esp_conn_p conn, uint32_t interval);
+#if ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__
+espr_t      esp_conn_set_write_linger(esp_conn_p conn, uint32_t linger);
+#endif /* ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__ */
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+espr_t      esp_conn_set_send_weight(esp_conn_p conn, uint8_t weight);
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+#if (ESP_CFG_CONN_MANUAL_TCP_RECEIVE && ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO) || __DOXYGEN__
+espr_t      esp_conn_set_recv_priority(esp_conn_p conn, uint8_t prio);
+espr_t      esp_conn_set_recv_window(esp_conn_p conn, size_t window);
+#endif /* (ESP_CFG_CONN_MANUAL_TCP_RECEIVE && ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO) || __DOXYGEN__ */
 void *      esp_conn_get_arg(esp_conn_p conn);
 uint8_t     esp_conn_is_client(esp_conn_p conn);
 uint8_t     esp_conn_is_server(esp_conn_p conn);
 uint8_t     esp_conn_is_active(esp_conn_p conn);
 uint8_t     esp_conn_is_closed(esp_conn_p conn);
 int8_t      esp_conn_getnum(esp_conn_p conn);
+esp_conn_p  esp_conn_get_by_num(uint8_t num);
 espr_t      esp_conn_set_ssl_buffersize(size_t size, const uint32_t blocking);
 espr_t      esp_get_conns_status(const uint32_t blocking);
 esp_conn_p  esp_conn_get_from_evt(esp_evt_t* evt);
 espr_t      esp_conn_write(esp_conn_p conn, const void* data, size_t btw, uint8_t flush, size_t* const mem_available);
+espr_t      esp_conn_writev(esp_conn_p conn, const esp_iovec_t* iov, size_t iovcnt, uint8_t flush, size_t* const mem_available);
 espr_t      esp_conn_recved(esp_conn_p conn, esp_pbuf_p pbuf);
 size_t      esp_conn_get_total_recved_count(esp_conn_p conn);
+#if ESP_CFG_CONN_STATS || __DOXYGEN__
+espr_t      esp_conn_get_stats(esp_conn_p conn, esp_conn_stats_t* stats);
+espr_t      esp_conn_reset_stats(esp_conn_p conn);
+#endif /* ESP_CFG_CONN_STATS || __DOXYGEN__ */
 
 uint8_t     esp_conn_get_remote_ip(esp_conn_p conn, esp_ip_t* ip);
 esp_port_t  esp_conn_get_remote_port(esp_conn_p conn);
@@ -39,6 +39,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 
 /**
@@ -83,11 +84,65 @@ extern "C" {
  * \}
  */
 
-#if ESP_CFG_DBG && !defined(ESP_CFG_DBG_OUT)
+#if ESP_CFG_DBG && !ESP_CFG_DBG_TRACE && !defined(ESP_CFG_DBG_OUT)
 #warning "ESP_CFG_DBG_OUT is not defined but debugging is enabled!"
 #endif
 
-#if (ESP_CFG_DBG && defined(ESP_CFG_DBG_OUT)) || __DOXYGEN__
+#if (ESP_CFG_DBG && ESP_CFG_DBG_TRACE) || __DOXYGEN__
+
+#define ESP_DBG_TRACE_MAX_ARGS      6       /*!< Maximal number of arguments stored in trace record */
+
+/**
+ * \brief           Debug trace record
+ */
+typedef struct {
+    uint32_t seq;                           /*!< Sequence number starting with `1`, written last.
+                                                Record is incomplete (being written) if it does not match its slot */
+    uint32_t time;                          /*!< Timestamp from \ref ESP_CFG_DBG_TRACE_TIME */
+    const char* fmt;                        /*!< Address of format string in firmware image */
+    uint32_t nargs;                         /*!< Number of valid arguments */
+    uint32_t args[ESP_DBG_TRACE_MAX_ARGS];  /*!< Arguments cast to `32-bit` integer */
+} esp_dbg_trace_rec_t;
+
+/**
+ * \brief           Function prototype to output raw trace data
+ * \param[in]       data: Data to output
+ * \param[in]       len: Length of data in units of bytes
+ */
+typedef void (*esp_dbg_trace_out_fn)(const void* data, size_t len);
+
+void    espi_dbg_trace(const char* fmt, const uint32_t* args, size_t nargs);
+void    esp_dbg_trace_dump(esp_dbg_trace_out_fn out_fn);
+void    esp_dbg_trace_reset(void);
+
+/* Count and convert up to ESP_DBG_TRACE_MAX_ARGS arguments, used by ESP_DEBUGF */
+#define ESP_DBG_NARGS(...)          ESP_DBG_NARGS_(0, ## __VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define ESP_DBG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...)  n
+#define ESP_DBG_CAT(a, b)           ESP_DBG_CAT_(a, b)
+#define ESP_DBG_CAT_(a, b)          a ## b
+#define ESP_DBG_ARG(a)              , (uint32_t)(uintptr_t)(a)
+#define ESP_DBG_ARGS_0()
+#define ESP_DBG_ARGS_1(a)           ESP_DBG_ARG(a)
+#define ESP_DBG_ARGS_2(a, ...)      ESP_DBG_ARG(a) ESP_DBG_ARGS_1(__VA_ARGS__)
+#define ESP_DBG_ARGS_3(a, ...)      ESP_DBG_ARG(a) ESP_DBG_ARGS_2(__VA_ARGS__)
+#define ESP_DBG_ARGS_4(a, ...)      ESP_DBG_ARG(a) ESP_DBG_ARGS_3(__VA_ARGS__)
+#define ESP_DBG_ARGS_5(a, ...)      ESP_DBG_ARG(a) ESP_DBG_ARGS_4(__VA_ARGS__)
+#define ESP_DBG_ARGS_6(a, ...)      ESP_DBG_ARG(a) ESP_DBG_ARGS_5(__VA_ARGS__)
+
+/**
+ * \brief           Store message to debug trace ring if enabled
+ * \param[in]       c: Condition if debug of specific type is enabled
+ * \param[in]       fmt: Formatted string for debug, only its address is stored
+ * \param[in]       ...: Variable parameters for formatted string
+ */
+#define ESP_DEBUGF(c, fmt, ...)         do {\
+    if (((c) & (ESP_DBG_ON)) && ((c) & (ESP_CFG_DBG_TYPES_ON)) && ((c) & ESP_DBG_LVL_MASK) >= (ESP_CFG_DBG_LVL_MIN)) {    \
+        const uint32_t esp_dbg_args[] = { 0 ESP_DBG_CAT(ESP_DBG_ARGS_, ESP_DBG_NARGS(__VA_ARGS__))(__VA_ARGS__) };  \
+        espi_dbg_trace((fmt), &esp_dbg_args[1], ESP_DBG_NARGS(__VA_ARGS__));    \
+    }                                       \
+} while (0)
+
+#elif (ESP_CFG_DBG && defined(ESP_CFG_DBG_OUT)) || __DOXYGEN__
 /**
  * \brief           Print message to the debug "window" if enabled
  * \param[in]       c: Condition if debug of specific type is enabled
@@ -99,6 +154,9 @@ extern "C" {
         ESP_CFG_DBG_OUT(fmt, ## __VA_ARGS__);   \
     }                                       \
 } while (0)
+#endif /* ESP_CFG_DBG_TRACE */
+
+#if (ESP_CFG_DBG && (ESP_CFG_DBG_TRACE || defined(ESP_CFG_DBG_OUT))) || __DOXYGEN__
 
 /**
  * \brief           Print message to the debug "window" if enabled when specific condition is met
@@ -117,7 +175,7 @@ extern "C" {
 #define ESP_CFG_DBG                 ESP_DBG_OFF
 #define ESP_DEBUGF(c, fmt, ...)
 #define ESP_DEBUGW(c, cond, fmt, ...)
-#endif /* (ESP_CFG_DBG && defined(ESP_CFG_DBG_OUT)) || __DOXYGEN__ */
+#endif /* (ESP_CFG_DBG && (ESP_CFG_DBG_TRACE || defined(ESP_CFG_DBG_OUT))) || __DOXYGEN__ */
 
 /**
  * \}
@@ -48,7 +48,11 @@ extern "C" {
  */
 
 espr_t      esp_dns_gethostbyname(const char* host, esp_ip_t* const ip, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_dns_gethostbyname_multi(const char* const* hosts, esp_ip_t* ips, espr_t* res, size_t cnt, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 espr_t      esp_dns_set_config(uint8_t en, const char* s1, const char* s2, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+#if ESP_CFG_DNS_CACHE_SIZE > 0 || __DOXYGEN__
+espr_t      esp_dns_cache_flush(void);
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 || __DOXYGEN__ */
 
 /**
  * \}
@@ -47,7 +47,21 @@ extern "C" {
  * \{
  */
 
+/**
+ * \brief           Get event mask bit for event type
+ * \note            Mask is 32-bit, \ref esp_evt_type_t must not have more than `32` entries
+ * \param[in]       type: Event type, member of \ref esp_evt_type_t enumeration
+ * \hideinitializer
+ */
+#define ESP_EVT_MASK(type)          ((uint32_t)1 << (uint32_t)(type))
+
+/**
+ * \brief           Event mask to receive all events
+ */
+#define ESP_EVT_MASK_ALL            ((uint32_t)0xFFFFFFFF)
+
 espr_t          esp_evt_register(esp_evt_fn fn);
+espr_t          esp_evt_register_ex(esp_evt_fn fn, uint32_t mask);
 espr_t          esp_evt_unregister(esp_evt_fn fn);
 esp_evt_type_t  esp_evt_get_type(esp_evt_t* cc);
 
@@ -83,6 +97,19 @@ espr_t      esp_evt_reset_get_result(esp_evt_t* cc);
 
 espr_t      esp_evt_restore_get_result(esp_evt_t* cc);
 
+/**
+ * \}
+ */
+
+/**
+ * \anchor          ESP_EVT_RX_OVERFLOW
+ * \name            Receive buffer overflow
+ * \brief           Event helper functions for \ref ESP_EVT_RX_OVERFLOW event
+ */
+
+uint32_t    esp_evt_rx_overflow_get_count(esp_evt_t* cc);
+uint32_t    esp_evt_rx_overflow_get_dropped(esp_evt_t* cc);
+
 /**
  * \}
  */
@@ -213,9 +240,12 @@ void*               esp_evt_conn_error_get_arg(esp_evt_t* cc);
  * \brief           Event helper functions for \ref ESP_EVT_STA_LIST_AP event
  */
 
+#if ESP_CFG_STA_LIST_AP || __DOXYGEN__
 espr_t      esp_evt_sta_list_ap_get_result(esp_evt_t* cc);
 esp_ap_t*   esp_evt_sta_list_ap_get_aps(esp_evt_t* cc);
 size_t      esp_evt_sta_list_ap_get_length(esp_evt_t* cc);
+esp_ap_t*   esp_evt_sta_list_ap_entry_get_ap(esp_evt_t* cc);
+#endif /* ESP_CFG_STA_LIST_AP || __DOXYGEN__ */
 
 /**
  * \}
@@ -274,6 +304,51 @@ const char* esp_evt_ping_get_host(esp_evt_t* cc);
 uint32_t    esp_evt_ping_get_time(esp_evt_t* cc);
 
 
+/**
+ * \}
+ */
+
+/**
+ * \anchor          ESP_EVT_UPDATE
+ * \name            Software update
+ * \brief           Event helper functions for \ref ESP_EVT_UPDATE_PROGRESS and \ref ESP_EVT_UPDATE events
+ */
+
+int32_t     esp_evt_update_progress_get_stage(esp_evt_t* cc);
+espr_t      esp_evt_update_get_result(esp_evt_t* cc);
+
+/**
+ * \}
+ */
+
+/**
+ * \anchor          ESP_EVT_MQTT_AT
+ * \name            MQTT on AT commands
+ * \brief           Event helper functions for \ref ESP_EVT_MQTT_AT_CONN and \ref ESP_EVT_MQTT_AT_RECV events
+ */
+
+uint8_t     esp_evt_mqtt_at_conn_is_connected(esp_evt_t* cc);
+const char* esp_evt_mqtt_at_recv_get_topic(esp_evt_t* cc);
+size_t      esp_evt_mqtt_at_recv_get_topic_len(esp_evt_t* cc);
+const void* esp_evt_mqtt_at_recv_get_data(esp_evt_t* cc);
+size_t      esp_evt_mqtt_at_recv_get_len(esp_evt_t* cc);
+
+/**
+ * \}
+ */
+
+/**
+ * \anchor          ESP_EVT_BLE
+ * \name            BLE data channel
+ * \brief           Event helper functions for \ref ESP_EVT_BLE_CONN and \ref ESP_EVT_BLE_RECV events
+ */
+
+uint8_t     esp_evt_ble_conn_get_conn(esp_evt_t* cc);
+const esp_mac_t* esp_evt_ble_conn_get_mac(esp_evt_t* cc);
+uint8_t     esp_evt_ble_conn_is_connected(esp_evt_t* cc);
+uint8_t     esp_evt_ble_recv_get_conn(esp_evt_t* cc);
+esp_pbuf_p  esp_evt_ble_recv_get_buff(esp_evt_t* cc);
+
 /**
  * \}
  */
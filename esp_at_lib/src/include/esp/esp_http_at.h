@@ -0,0 +1,66 @@
+/**
+ * \file            esp_http_at.h
+ * \brief           HTTP client command of ESP32 AT firmware
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_HTTP_AT_H
+#define ESP_HDR_HTTP_AT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP
+ * \defgroup        ESP_HTTP_AT HTTP client on AT commands
+ * \brief           HTTP request executed by ESP32 device
+ *
+ * Device opens connection, sends request and closes connection on its own.
+ * Only response body is transferred back to host
+ *
+ * \{
+ */
+
+espr_t      esp_http_at_request(esp_http_at_method_t method, esp_http_at_content_type_t content_type, const char* url, const char* data,
+                                const char* headers, size_t headers_cnt, esp_http_at_data_fn data_fn, void* const data_arg,
+                                const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HDR_HTTP_AT_H */
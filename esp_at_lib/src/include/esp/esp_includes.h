@@ -73,7 +73,28 @@ extern "C" {
 #if ESP_CFG_DNS || __DOXYGEN__
 #include "esp/esp_dns.h"
 #endif /* ESP_CFG_DNS || __DOXYGEN__ */
+#if ESP_CFG_SLEEP || __DOXYGEN__
+#include "esp/esp_sleep.h"
+#endif /* ESP_CFG_SLEEP || __DOXYGEN__ */
 #include "esp/esp_dhcp.h"
+#if ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__
+#include "esp/esp_snapshot.h"
+#endif /* ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__ */
+#if ESP_CFG_ASYNC || __DOXYGEN__
+#include "esp/esp_async.h"
+#endif /* ESP_CFG_ASYNC || __DOXYGEN__ */
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+#include "esp/esp_mqtt_at.h"
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+#if ESP_CFG_BLE || __DOXYGEN__
+#include "esp/esp_ble.h"
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+#include "esp/esp_http_at.h"
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
+#if ESP_CFG_AT_CAPTURE || __DOXYGEN__
+#include "esp/esp_capture.h"
+#endif /* ESP_CFG_AT_CAPTURE || __DOXYGEN__ */
 
 #ifdef __cplusplus
 }
@@ -51,6 +51,15 @@ extern "C" {
 espr_t      esp_input(const void* data, size_t len);
 espr_t      esp_input_process(const void* data, size_t len);
 
+#if ESP_CFG_INPUT_FRAMED || __DOXYGEN__
+espr_t      esp_input_process_frag(const esp_input_frag_t* frags, size_t cnt);
+#endif /* ESP_CFG_INPUT_FRAMED || __DOXYGEN__ */
+
+#if ESP_CFG_RX_STATS || __DOXYGEN__
+espr_t      esp_input_get_stats(esp_rx_stats_t* stats);
+void        esp_input_reset_stats(void);
+#endif /* ESP_CFG_RX_STATS || __DOXYGEN__ */
+
 /**
  * \}
  */
@@ -49,24 +49,146 @@ extern "C" {
 
 #if !ESP_CFG_MEM_CUSTOM || __DOXYGEN__
 
+#if ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__
+
+/**
+ * \brief           Placement class of memory region
+ * \sa              ESP_CFG_MEM_REGION_CLASS
+ */
+typedef enum {
+    ESP_MEM_CLASS_FAST = 0x00,                  /*!< Small and fast memory, such as internal SRAM or DTCM */
+    ESP_MEM_CLASS_BULK,                         /*!< Large and slow memory, such as external SDRAM */
+    ESP_MEM_CLASS_END,                          /*!< Last entry, number of classes */
+} esp_mem_class_t;
+
+#endif /* ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__ */
+
 /**
  * \brief           Single memory region descriptor
  */
 typedef struct {
     void* start_addr;                           /*!< Start address of region */
     size_t size;                                /*!< Size in units of bytes of region */
+#if ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__
+    esp_mem_class_t mem_class;                  /*!< Placement class of region, fast memory when not set */
+#endif /* ESP_CFG_MEM_REGION_CLASS || __DOXYGEN__ */
 } esp_mem_region_t;
 
 uint8_t esp_mem_assignmemory(const esp_mem_region_t* regions, size_t size);
 
 #endif /* !ESP_CFG_MEM_CUSTOM || __DOXYGEN__ */
 
+/**
+ * \brief           Subsystem owning allocated memory, used for statistics
+ */
+typedef enum {
+    ESP_MEM_TAG_OTHER = 0x00,                   /*!< Memory not assigned to any subsystem */
+    ESP_MEM_TAG_PBUF,                           /*!< Packet buffers */
+    ESP_MEM_TAG_MSG,                            /*!< Command messages */
+    ESP_MEM_TAG_CONN,                           /*!< Connection write buffers */
+    ESP_MEM_TAG_MQTT,                           /*!< MQTT client */
+    ESP_MEM_TAG_HTTP,                           /*!< HTTP server and client */
+    ESP_MEM_TAG_END,                            /*!< Last entry, number of tags */
+} esp_mem_tag_t;
+
+#if (ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__
+
+/**
+ * \brief           Memory manager statistics
+ */
+typedef struct {
+    size_t free_bytes;                          /*!< Number of currently free bytes */
+    size_t min_free_bytes;                      /*!< Minimal number of free bytes since memory has been assigned */
+    size_t max_free_block;                      /*!< Size of largest free block */
+    size_t alloc_cnt;                           /*!< Number of currently allocated blocks */
+    size_t alloc_total;                         /*!< Number of successful allocations since start */
+    uint8_t fragmentation;                      /*!< Free memory not in largest block, in percent */
+    size_t tag_bytes[ESP_MEM_TAG_END];          /*!< Number of allocated bytes per subsystem */
+} esp_mem_stats_t;
+
+uint8_t esp_mem_get_stats(esp_mem_stats_t* stats);
+void    esp_mem_reset_stats(void);
+
+#endif /* (ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__ */
+
+#if (ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__
+
+/**
+ * \brief           Allocation call site statistics
+ * \sa              ESP_CFG_MEM_PROFILE
+ */
+typedef struct {
+    const char* file;                           /*!< Source file of caller, `NULL` for unknown sites or sites not fitting in table */
+    uint16_t line;                              /*!< Source line of caller */
+    esp_mem_tag_t tag;                          /*!< Subsystem tag of last allocation */
+    size_t alloc_cnt;                           /*!< Number of successful allocations */
+    size_t alloc_bytes;                         /*!< Number of allocated bytes, sum of all allocations */
+    size_t max_size;                            /*!< Largest single allocation in units of bytes */
+    size_t live_cnt;                            /*!< Number of currently allocated blocks */
+    size_t live_bytes;                          /*!< Number of currently allocated bytes */
+    size_t free_cnt;                            /*!< Number of freed blocks */
+    size_t short_lived_cnt;                     /*!< Number of blocks freed within \ref ESP_CFG_MEM_PROFILE_SHORT_LIVED */
+    uint32_t lifetime_total;                    /*!< Sum of lifetimes of freed blocks in units of milliseconds */
+    uint32_t lifetime_max;                      /*!< Longest lifetime of freed block in units of milliseconds */
+} esp_mem_site_t;
+
+/**
+ * \brief           Sort order of call sites
+ */
+typedef enum {
+    ESP_MEM_PROFILE_SORT_COUNT = 0x00,          /*!< Sort by number of allocations */
+    ESP_MEM_PROFILE_SORT_BYTES,                 /*!< Sort by number of allocated bytes */
+    ESP_MEM_PROFILE_SORT_LIVE,                  /*!< Sort by number of currently allocated bytes */
+} esp_mem_profile_sort_t;
+
+#define ESP_MEM_FRAG_HIST_LEN               12  /*!< Number of free block size classes in fragmentation snapshot */
+
+/**
+ * \brief           Fragmentation snapshot of free memory
+ */
+typedef struct {
+    size_t free_bytes;                          /*!< Number of free bytes, including block headers */
+    size_t free_blocks;                         /*!< Number of free blocks */
+    size_t max_free_block;                      /*!< Size of largest free block */
+    size_t hist[ESP_MEM_FRAG_HIST_LEN];         /*!< Number of free blocks of size `16 * 2^i` to `16 * 2^(i + 1) - 1` bytes,
+                                                    first entry includes smaller and last entry larger blocks */
+} esp_mem_frag_t;
+
+void*   esp_mem_calloc_site(size_t num, size_t size, esp_mem_tag_t tag, const char* file, uint16_t line);
+void*   esp_mem_realloc_site(void* ptr, size_t size, const char* file, uint16_t line);
+size_t  esp_mem_profile_get_sites(esp_mem_site_t* sites, size_t len, esp_mem_profile_sort_t sort);
+uint8_t esp_mem_profile_get_frag(esp_mem_frag_t* frag);
+void    esp_mem_profile_reset(void);
+
+#endif /* (ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__ */
+
+#if ((ESP_CFG_MEM_STATS || ESP_CFG_MEM_REGION_CLASS) && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__
+
+void*   esp_mem_malloc_tag(size_t size, esp_mem_tag_t tag);
+void*   esp_mem_calloc_tag(size_t num, size_t size, esp_mem_tag_t tag);
+
+#else /* ((ESP_CFG_MEM_STATS || ESP_CFG_MEM_REGION_CLASS) && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__ */
+
+#define esp_mem_malloc_tag(size, tag)       esp_mem_malloc(size)
+#define esp_mem_calloc_tag(num, size, tag)  esp_mem_calloc((num), (size))
+
+#endif /* !(((ESP_CFG_MEM_STATS || ESP_CFG_MEM_REGION_CLASS) && !ESP_CFG_MEM_CUSTOM) || __DOXYGEN__) */
+
 void*   esp_mem_malloc(size_t size);
 void*   esp_mem_realloc(void* ptr, size_t size);
 void*   esp_mem_calloc(size_t num, size_t size);
 void    esp_mem_free(void* ptr);
 uint8_t esp_mem_free_s(void** ptr);
 
+#if ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM && !__DOXYGEN__
+/* Record caller of every allocation */
+#define esp_mem_malloc(size)                esp_mem_calloc_site(1, (size), ESP_MEM_TAG_OTHER, __FILE__, __LINE__)
+#define esp_mem_calloc(num, size)           esp_mem_calloc_site((num), (size), ESP_MEM_TAG_OTHER, __FILE__, __LINE__)
+#define esp_mem_realloc(ptr, size)          esp_mem_realloc_site((ptr), (size), __FILE__, __LINE__)
+#define esp_mem_malloc_tag(size, tag)       esp_mem_calloc_site(1, (size), (tag), __FILE__, __LINE__)
+#define esp_mem_calloc_tag(num, size, tag)  esp_mem_calloc_site((num), (size), (tag), __FILE__, __LINE__)
+#endif /* ESP_CFG_MEM_PROFILE && !ESP_CFG_MEM_CUSTOM && !__DOXYGEN__ */
+
 /**
  * \}
  */
@@ -0,0 +1,70 @@
+/**
+ * \file            esp_mqtt_at.h
+ * \brief           MQTT commands of ESP32 AT firmware
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_MQTT_AT_H
+#define ESP_HDR_MQTT_AT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP
+ * \defgroup        ESP_MQTT_AT MQTT on AT commands
+ * \brief           MQTT client running on ESP32 device
+ *
+ * Device supports single MQTT connection, link ID `0` is always used.
+ * Connection status changes are reported with \ref ESP_EVT_MQTT_AT_CONN event
+ * and messages on subscribed topics with \ref ESP_EVT_MQTT_AT_RECV event
+ *
+ * \{
+ */
+
+espr_t      esp_mqtt_at_connect(const esp_mqtt_at_info_t* info, const char* host, esp_port_t port, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_mqtt_at_close(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_mqtt_at_subscribe(const char* topic, uint8_t qos, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_mqtt_at_unsubscribe(const char* topic, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_mqtt_at_publish(const char* topic, const void* data, size_t len, uint8_t qos, uint8_t retain, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+uint8_t     esp_mqtt_at_is_connected(void);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_HDR_MQTT_AT_H */
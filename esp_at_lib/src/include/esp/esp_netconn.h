@@ -63,27 +63,62 @@ typedef enum {
     ESP_NETCONN_TYPE_UDP = ESP_CONN_TYPE_UDP,   /*!< UDP connection */
 } esp_netconn_type_t;
 
+#if ESP_CFG_NETCONN_POLL || __DOXYGEN__
+
+#define ESP_NETCONN_POLL_RECEIVE        0x01    /*!< Received data or close event are ready for \ref esp_netconn_receive */
+#define ESP_NETCONN_POLL_ACCEPT         0x02    /*!< New connection or error is ready for \ref esp_netconn_accept */
+
+/**
+ * \brief           Netconn poll entry
+ */
+typedef struct {
+    esp_netconn_p nc;                           /*!< Netconn handle to check */
+    uint8_t events;                             /*!< Events to wait for, bitwise OR of `ESP_NETCONN_POLL_*` values */
+    uint8_t revents;                            /*!< Ready events, set by \ref esp_netconn_poll */
+} esp_netconn_poll_t;
+
+#endif /* ESP_CFG_NETCONN_POLL || __DOXYGEN__ */
+
 esp_netconn_p   esp_netconn_new(esp_netconn_type_t type);
 espr_t          esp_netconn_delete(esp_netconn_p nc);
 espr_t          esp_netconn_bind(esp_netconn_p nc, esp_port_t port);
 espr_t          esp_netconn_connect(esp_netconn_p nc, const char* host, esp_port_t port);
+espr_t          esp_netconn_connect_udp_any(esp_netconn_p nc, esp_port_t local_port);
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+espr_t          esp_netconn_connect_transparent(esp_netconn_p nc, const char* host, esp_port_t port);
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
 espr_t          esp_netconn_receive(esp_netconn_p nc, esp_pbuf_p* pbuf);
+espr_t          esp_netconn_receive_bulk(esp_netconn_p nc, esp_pbuf_p* pbuf, size_t max_len);
 espr_t          esp_netconn_close(esp_netconn_p nc);
+#if ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__
+espr_t          esp_netconn_release(esp_netconn_p nc);
+#endif /* ESP_CFG_NETCONN_CONN_POOL_SIZE > 0 || __DOXYGEN__ */
 int8_t          esp_netconn_getconnnum(esp_netconn_p nc);
 void            esp_netconn_set_receive_timeout(esp_netconn_p nc, uint32_t timeout);
 uint32_t        esp_netconn_get_receive_timeout(esp_netconn_p nc);
+#if ESP_CFG_NETCONN_POLL || __DOXYGEN__
+espr_t          esp_netconn_poll(esp_netconn_poll_t* fds, size_t cnt, uint32_t timeout, size_t* ready);
+#endif /* ESP_CFG_NETCONN_POLL || __DOXYGEN__ */
 
 /* TCP only */
 espr_t          esp_netconn_listen(esp_netconn_p nc);
 espr_t          esp_netconn_listen_with_max_conn(esp_netconn_p nc, uint16_t max_connections);
 espr_t          esp_netconn_set_listen_conn_timeout(esp_netconn_p nc, uint16_t timeout);
+espr_t          esp_netconn_set_accept_backlog(esp_netconn_p nc, size_t backlog);
 espr_t          esp_netconn_accept(esp_netconn_p nc, esp_netconn_p* client);
+espr_t          esp_netconn_accept_many(esp_netconn_p nc, esp_netconn_p* clients, size_t max_cnt, size_t* cnt);
 espr_t          esp_netconn_write(esp_netconn_p nc, const void* data, size_t btw);
+espr_t          esp_netconn_writev(esp_netconn_p nc, const esp_iovec_t* iov, size_t iovcnt);
 espr_t          esp_netconn_flush(esp_netconn_p nc);
+#if ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__
+void            esp_netconn_set_send_window(esp_netconn_p nc, size_t window);
+size_t          esp_netconn_get_send_window(esp_netconn_p nc);
+#endif /* ESP_CFG_NETCONN_SEND_WINDOW || __DOXYGEN__ */
 
 /* UDP only */
 espr_t          esp_netconn_send(esp_netconn_p nc, const void* data, size_t btw);
 espr_t          esp_netconn_sendto(esp_netconn_p nc, const esp_ip_t* ip, esp_port_t port, const void* data, size_t btw);
+espr_t          esp_netconn_receive_batch(esp_netconn_p nc, esp_pbuf_p* pbufs, size_t max_cnt, size_t* cnt);
 
 /**
  * \}
@@ -50,9 +50,13 @@ espr_t      espi_parse_ipd(const char* str);
 espr_t      espi_parse_ciprecvdata(const char* str);
 espr_t      espi_parse_ciprecvlen(const char* str);
 
+#if ESP_CFG_STA_LIST_AP
 uint8_t     espi_parse_cwlap(const char* str, esp_msg_t* msg);
+#endif /* ESP_CFG_STA_LIST_AP */
 uint8_t     espi_parse_cwjap(const char* str, esp_msg_t* msg);
+#if ESP_CFG_AP_LIST_STA
 uint8_t     espi_parse_cwlif(const char* str, esp_msg_t* msg);
+#endif /* ESP_CFG_AP_LIST_STA */
 uint8_t     espi_parse_cipdomain(const char* src, esp_msg_t* msg);
 uint8_t     espi_parse_cipsntptime(const char* str, esp_msg_t* msg);
 uint8_t     espi_parse_ping_time(const char* str, esp_msg_t* msg);
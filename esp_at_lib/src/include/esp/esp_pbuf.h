@@ -58,6 +58,8 @@ size_t          esp_pbuf_copy(esp_pbuf_p pbuf, void* data, size_t len, size_t of
 espr_t          esp_pbuf_cat(esp_pbuf_p head, const esp_pbuf_p tail);
 espr_t          esp_pbuf_chain(esp_pbuf_p head, esp_pbuf_p tail);
 esp_pbuf_p      esp_pbuf_unchain(esp_pbuf_p head);
+esp_pbuf_p      esp_pbuf_compact(esp_pbuf_p pbuf, size_t max_len);
+esp_pbuf_p      esp_pbuf_slice(const esp_pbuf_p pbuf, size_t off, size_t len);
 espr_t          esp_pbuf_ref(esp_pbuf_p pbuf);
 
 uint8_t         esp_pbuf_get_at(const esp_pbuf_p pbuf, size_t pos, uint8_t* el);
@@ -72,9 +74,20 @@ esp_pbuf_p      esp_pbuf_skip(esp_pbuf_p pbuf, size_t offset, size_t* new_offset
 void *          esp_pbuf_get_linear_addr(const esp_pbuf_p pbuf, size_t offset, size_t* new_len);
 
 void            esp_pbuf_set_ip(esp_pbuf_p pbuf, const esp_ip_t* ip, esp_port_t port);
+uint8_t         esp_pbuf_get_ip(const esp_pbuf_p pbuf, esp_ip_t* ip, esp_port_t* port);
 
 void            esp_pbuf_dump(esp_pbuf_p p, uint8_t seq);
 
+#if ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__
+esp_pbuf_p      esp_pbuf_new_ext(void* payload, size_t len, esp_pbuf_free_fn free_fn);
+void            esp_pbuf_set_payload_alloc_fn(esp_pbuf_alloc_fn alloc_fn, esp_pbuf_free_fn free_fn);
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__ */
+
+#if ESP_CFG_PBUF_POOL || __DOXYGEN__
+espr_t          esp_pbuf_pool_get_stats(size_t pool, esp_pbuf_pool_stats_t* stats);
+void            esp_pbuf_pool_reset_stats(void);
+#endif /* ESP_CFG_PBUF_POOL || __DOXYGEN__ */
+
 /**
  * \}
  */
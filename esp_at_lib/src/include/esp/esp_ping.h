@@ -48,6 +48,7 @@ extern "C" {
  */
 
 espr_t      esp_ping(const char* host, uint32_t* time, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_ping_probe(esp_ping_stats_t* stats, size_t cnt, uint16_t count, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 
 /**
  * \}
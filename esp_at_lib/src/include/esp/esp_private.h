@@ -55,6 +55,9 @@ typedef enum {
 
     /* Basic AT commands */
     ESP_CMD_RESET,                              /*!< Reset device */
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__
+    ESP_CMD_AT,                                 /*!< Test AT startup, used to check link quality */
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__ */
     ESP_CMD_ATE0,                               /*!< Disable ECHO mode on AT commands */
     ESP_CMD_ATE1,                               /*!< Enable ECHO mode on AT commands */
     ESP_CMD_GMR,                                /*!< Get AT commands version */
@@ -127,6 +130,10 @@ typedef enum {
     ESP_CMD_TCPIP_CIPSERVER,                    /*!< Enables/Disables server mode */
     ESP_CMD_TCPIP_CIPSERVERMAXCONN,             /*!< Sets maximal number of connections allowed for server population */
     ESP_CMD_TCPIP_CIPMODE,                      /*!< Transmission mode, either transparent or normal one */
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+    ESP_CMD_TCPIP_CIPSEND_TRANSPARENT,          /*!< Start data transmission in transparent mode */
+    ESP_CMD_TCPIP_TRANSPARENT_EXIT,             /*!< Exit transparent data transmission with `+++` sequence */
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
     ESP_CMD_TCPIP_CIPSTO,                       /*!< Sets connection timeout */
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE || __DOXYGEN__
     ESP_CMD_TCPIP_CIPRECVMODE,                  /*!< Sets mode for TCP data receive (manual or automatic) */
@@ -147,6 +154,32 @@ typedef enum {
 #if ESP_CFG_ESP32 || __DOXYGEN__
     ESP_CMD_BLEINIT_GET,                        /*!< Get BLE status */
 #endif /* ESP_CFG_ESP32 || __DOXYGEN__ */
+#if ESP_CFG_BLE || __DOXYGEN__
+    ESP_CMD_BLEINIT,                            /*!< Initialize or deinitialize BLE */
+    ESP_CMD_BLENAME,                            /*!< Set BLE device name */
+    ESP_CMD_BLEGATTSSRVCRE,                     /*!< Create GATT services */
+    ESP_CMD_BLEGATTSSRVSTART,                   /*!< Start GATT services */
+    ESP_CMD_BLEADVSTART,                        /*!< Start advertising */
+    ESP_CMD_BLEGATTSNTFY,                       /*!< Notify client with characteristic value */
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+
+    /* MQTT commands, ESP32 only */
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+    ESP_CMD_MQTT_USERCFG,                       /*!< Set MQTT user configuration */
+    ESP_CMD_MQTT_CONNCFG,                       /*!< Set MQTT connection configuration */
+    ESP_CMD_MQTT_CONN,                          /*!< Connect to MQTT broker */
+    ESP_CMD_MQTT_PUBRAW,                        /*!< Publish binary MQTT message */
+    ESP_CMD_MQTT_SUB,                           /*!< Subscribe to MQTT topic */
+    ESP_CMD_MQTT_UNSUB,                         /*!< Unsubscribe from MQTT topic */
+    ESP_CMD_MQTT_CLEAN,                         /*!< Close MQTT connection and release resources */
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+
+    /* HTTP client commands, ESP32 only */
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+    ESP_CMD_HTTPCLIENT,                         /*!< Send HTTP request from device */
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
+
+    ESP_CMD_END,                                /*!< Last entry, number of command types */
 } esp_cmd_t;
 
 /**
@@ -168,12 +201,38 @@ typedef struct esp_conn {
     esp_linbuff_t   buff;                       /*!< Linear buffer structure */
 
     size_t          total_recved;               /*!< Total number of bytes received */
+#if ESP_CFG_CONN_STATS || __DOXYGEN__
+    esp_conn_stats_t stats;                     /*!< Send statistics, average latency is not used */
+    uint32_t        latency_sum;                /*!< Sum of all measured send latencies */
+#endif /* ESP_CFG_CONN_STATS || __DOXYGEN__ */
+#if ESP_CFG_CONN_SEND_PACING || __DOXYGEN__
+    size_t          send_seg_len;               /*!< Current maximal segment length, `0` until first send result */
+    uint32_t        send_backoff;               /*!< Retry delay in units of milliseconds, `0` when not congested */
+#endif /* ESP_CFG_CONN_SEND_PACING || __DOXYGEN__ */
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+    uint8_t         send_weight;                /*!< Number of send commands taken from send queue in one round-robin turn,
+                                                    `0` is used as `1` */
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+
+    uint32_t        poll_interval;              /*!< Poll event interval in units of milliseconds, `0` when disabled */
+    uint32_t        poll_next;                  /*!< System time of next poll */
+#if ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__
+    uint32_t        write_linger;               /*!< Write buffer linger time in units of milliseconds, `0` when disabled */
+    uint32_t        write_flush_time;           /*!< System time when write buffer is flushed */
+#endif /* ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__ */
 
 #if ESP_CFG_CONN_MANUAL_TCP_RECEIVE || __DOXYGEN__
     size_t          tcp_available_bytes;        /*!< Number of bytes in ESP ready to be read on connection.
                                                         This variable always holds last known info from ESP device and is not decremented (or incremented) by application */
     size_t          tcp_not_ack_bytes;          /*!< Number of bytes not acknowledge by application done with processing
                                                         This variable is increased everytime new packet is read to be sent to application and decreased when application acknowledges it */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH > 0 || __DOXYGEN__
+    size_t          tcp_ack_pending;            /*!< Number of bytes acknowledged since last read attempt */
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_ACK_BATCH > 0 || __DOXYGEN__ */
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO || __DOXYGEN__
+    size_t          recv_window;                /*!< Receive window in units of bytes, `0` to use \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE_WINDOW */
+    uint8_t         recv_prio;                  /*!< Receive priority, connection with higher value is read first */
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO || __DOXYGEN__ */
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE || __DOXYGEN__ */
 
     union {
@@ -187,6 +246,9 @@ typedef struct esp_conn {
             uint8_t receive_blocked:1;          /*!< Status whether we should block manual receive for some time */
             uint8_t receive_is_command_queued:1;/*!< Status whether manual read command is in the queue already */
 #endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE || __DOXYGEN__ */
+#if ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__
+            uint8_t write_linger_armed:1;       /*!< Status whether write buffer waits for automatic flush */
+#endif /* ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__ */
         } f;                                    /*!< Connection flags */
     } status;                                   /*!< Connection status union with flag bits */
 } esp_conn_t;
@@ -201,8 +263,22 @@ typedef struct esp_pbuf {
     size_t len;                                 /*!< Length of payload */
     size_t ref;                                 /*!< Number of references to this structure */
     uint8_t* payload;                           /*!< Pointer to payload memory */
+    struct esp_pbuf* parent;                    /*!< Pbuf chain referenced by slice, owning payload memory.
+                                                    Set to `NULL` when pbuf is not a slice */
     esp_ip_t ip;                                /*!< Remote address for received IPD data */
     esp_port_t port;                            /*!< Remote port for received IPD data */
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+    uint32_t trace_in;                          /*!< Time when data arrived to input buffer */
+    uint32_t trace_time;                        /*!< Time when current trace stage started */
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+#if ESP_CFG_IPD_ZERO_COPY || __DOXYGEN__
+    uint8_t payload_ref;                        /*!< Set to `1` when payload references memory not owned by pbuf */
+    uint8_t* payload_owned;                     /*!< Payload copy allocated by \ref espi_pbuf_release_payload, `NULL` otherwise */
+#endif /* ESP_CFG_IPD_ZERO_COPY || __DOXYGEN__ */
+#if ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__
+    uint8_t* payload_mem;                       /*!< Start of payload memory apart from structure, `NULL` when payload follows structure */
+    esp_pbuf_free_fn free_fn;                   /*!< Function to release `payload_mem` or `NULL` */
+#endif /* ESP_CFG_PBUF_EXT_PAYLOAD || __DOXYGEN__ */
 } esp_pbuf_t;
 
 /**
@@ -219,8 +295,73 @@ typedef struct {
     size_t              buff_ptr;               /*!< Buffer pointer to save data to.
                                                      When set to `NULL` while `read = 1`, reading should ignore incoming data */
     esp_pbuf_p          buff;                   /*!< Pointer to data buffer used for receiving data */
+#if ESP_CFG_IPD_ZERO_COPY || __DOXYGEN__
+    size_t              buff_deferred_len;      /*!< Length of next data buffer, which is allocated once data are available */
+#endif /* ESP_CFG_IPD_ZERO_COPY || __DOXYGEN__ */
+#if ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__
+    uint8_t             whole;                  /*!< Set to `1` when entire `+IPD` statement is delivered as one chain */
+    esp_pbuf_p          buff_head;              /*!< First buffer of chain when `whole` is set */
+#endif /* ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__ */
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+    uint32_t            trace_in;               /*!< Time when `+IPD` header arrived to input buffer */
+    uint32_t            trace_start;            /*!< Time when current data buffer was started */
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
 } esp_ipd_t;
 
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+
+/**
+ * \brief           Incoming `+MQTTSUBRECV` message read structure
+ */
+typedef struct {
+    uint8_t             read;                   /*!< Set to 1 when we should process input data as message data */
+    char*               buff;                   /*!< Topic with `NULL` termination, followed by message data.
+                                                     When set to `NULL` while `read = 1`, reading should ignore incoming data */
+    size_t              topic_len;              /*!< Length of topic in units of bytes */
+    size_t              len;                    /*!< Length of message data in units of bytes */
+    size_t              pos;                    /*!< Number of message data bytes already read */
+} esp_mqtt_at_recv_t;
+
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+
+#if ESP_CFG_BLE || __DOXYGEN__
+
+/**
+ * \brief           Incoming `+WRITE` data read structure
+ */
+typedef struct {
+    uint8_t             read;                   /*!< Set to 1 when we should process input data as written value */
+    esp_pbuf_p          buff;                   /*!< Buffer for written value.
+                                                     When set to `NULL` while `read = 1`, reading should ignore incoming data */
+    uint8_t             conn;                   /*!< BLE connection index of client */
+    size_t              len;                    /*!< Length of written value in units of bytes */
+    size_t              pos;                    /*!< Number of bytes already read */
+} esp_ble_recv_t;
+
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+
+/**
+ * \brief           Incoming `+HTTPCLIENT` response data read structure
+ */
+typedef struct {
+    uint8_t             read;                   /*!< Set to 1 when we should process input data as response data */
+    size_t              len;                    /*!< Length of response data part in units of bytes */
+    size_t              pos;                    /*!< Number of data bytes already read */
+} esp_http_at_recv_t;
+
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
+
+/**
+ * \brief           Message priority lane in producer thread
+ */
+typedef enum {
+    ESP_MSG_PRIO_HIGH = 0x00,                   /*!< Data and control commands */
+    ESP_MSG_PRIO_LOW,                           /*!< Slow management commands */
+    ESP_MSG_PRIO_END,                           /*!< Number of priority lanes */
+} esp_msg_prio_t;
+
 /**
  * \brief           Message queue structure to share between threads
  */
@@ -230,9 +371,25 @@ typedef struct esp_msg {
     uint8_t         i;                          /*!< Variable to indicate order number of subcommands */
     esp_sys_sem_t   sem;                        /*!< Semaphore for the message */
     uint8_t         is_blocking;                /*!< Status if command is blocking */
+#if ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__
+    esp_msg_prio_t  prio;                       /*!< Priority lane of message */
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__ */
     uint32_t        block_time;                 /*!< Maximal blocking time in units of milliseconds. Use 0 to for non-blocking call */
     espr_t          res;                        /*!< Result of message operation */
     espr_t          (*fn)(struct esp_msg *);    /*!< Processing callback function to process packet */
+#if ESP_CFG_CMD_BATCH || __DOXYGEN__
+    struct esp_msg* next;                       /*!< Next message in command batch */
+#endif /* ESP_CFG_CMD_BATCH || __DOXYGEN__ */
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+    struct esp_msg* send_q_next;                /*!< Next message in connection send queue */
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+#if ESP_CFG_CMD_CANCEL || __DOXYGEN__
+    struct esp_msg* queued_next;                /*!< Next message waiting for producing thread */
+    uint8_t         cancelled;                  /*!< Set to `1` when command was cancelled by application */
+#endif /* ESP_CFG_CMD_CANCEL || __DOXYGEN__ */
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+    uint32_t        trace_time;                 /*!< Time when message was written to producer queue */
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
 
 #if ESP_CFG_USE_API_FUNC_EVT
     esp_api_cmd_evt_fn evt_fn;                  /*!< Command callback API function */
@@ -242,6 +399,15 @@ typedef struct esp_msg {
     union {
         struct {
             uint32_t delay;                     /*!< Delay in units of milliseconds before executing first RESET command */
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__
+            uint32_t baudrate;                  /*!< Baudrate currently being probed */
+            uint32_t baudrate_prev;             /*!< Last stable baudrate, used for rollback */
+            uint8_t baudrate_tests;             /*!< Number of successful link tests on probed baudrate */
+            uint8_t baudrate_timeout;           /*!< Set to `1` when last probe command timed out */
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__ */
+#if ESP_CFG_RESET_RECOVERY || __DOXYGEN__
+            uint8_t recovery;                   /*!< Set to `1` when reset sequence recovers from unexpected reset */
+#endif /* ESP_CFG_RESET_RECOVERY || __DOXYGEN__ */
         } reset;                                /*!< Reset device */
         struct {
             uint32_t baudrate;                  /*!< Baudrate for AT port */
@@ -268,6 +434,19 @@ typedef struct esp_msg {
             size_t apsl;                        /*!< Length of input array of access points */
             size_t apsi;                        /*!< Current access point array */
             size_t* apf;                        /*!< Pointer to output variable holding number of access points found */
+            uint8_t stream;                     /*!< Set to `1` to send every access point as event instead of saving to array */
+            const char* filter_ssid;            /*!< Host-side SSID filter for streaming scan, `NULL` if not used */
+            int16_t min_rssi;                   /*!< Minimal RSSI for streaming scan */
+            uint8_t stop_on_match;              /*!< Set to `1` to stop reporting after first matching access point */
+            esp_ap_t ap;                        /*!< Access point currently parsed in streaming scan */
+            uint8_t fields;                     /*!< Fields requested with `AT+CWLAPOPT`, `0` for default fields */
+            uint8_t sort;                       /*!< Set to `1` to sort list by RSSI */
+            int16_t opt_rssi;                   /*!< RSSI threshold for `AT+CWLAPOPT`, `-128` if not used */
+            espr_t res;                         /*!< Result of scan, kept while default options are restored */
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__
+            uint8_t cached;                     /*!< Set to `1` when request may be answered from scan table */
+            uint32_t max_age;                   /*!< Maximal age of scan table result in units of milliseconds */
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__ */
         } ap_list;                              /*!< List for available access points to connect to */
 #endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
 #if ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__
@@ -318,6 +497,16 @@ typedef struct esp_msg {
             size_t length;                      /*!< Length of buffer when reading hostname */
         } wifi_hostname;                        /*!< Set or get hostname structure */
 #endif /* ESP_CFG_HOSTNAME || __DOXYGEN__ */
+#if ESP_CFG_SLEEP || __DOXYGEN__
+        struct {
+            esp_sleep_mode_t mode;              /*!< Sleep mode to set */
+        } sleep;                                /*!< Sleep mode structure */
+        struct {
+            uint8_t enable;                     /*!< Set to `1` to enable wakeup from GPIO */
+            uint8_t gpio;                       /*!< Wakeup trigger GPIO number */
+            uint8_t level;                      /*!< Wakeup trigger level, `0` for low, `1` for high */
+        } wakeup_gpio;                          /*!< Wakeup GPIO configuration structure */
+#endif /* ESP_CFG_SLEEP || __DOXYGEN__ */
 
         /* Connection based commands */
         struct {
@@ -333,6 +522,13 @@ typedef struct esp_msg {
             esp_evt_fn evt_func;                /*!< Callback function to use on connection */
             uint8_t num;                        /*!< Connection number used for start */
             uint8_t success;                    /*!< Status if connection AT+CIPSTART succedded */
+#if ESP_CFG_CONN_IPD_INFO == 2 || __DOXYGEN__
+            uint8_t ipd_info_set;               /*!< Set to `1` after `AT+CIPDINFO` was sent before start */
+#endif /* ESP_CFG_CONN_IPD_INFO == 2 || __DOXYGEN__ */
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+            uint8_t transparent;                /*!< Set to `1` to enter transparent mode or `0` to exit it */
+            uint8_t transparent_failed;         /*!< Set to `1` when enter failed and normal mode is being restored */
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
         } conn_start;                           /*!< Structure for starting new connection */
         struct {
             esp_conn_t* conn;                   /*!< Pointer to connection to close */
@@ -347,9 +543,23 @@ typedef struct esp_msg {
             size_t sent_all;                    /*!< Number of bytes sent all together */
             uint8_t tries;                      /*!< Number of tries used for last packet */
             uint8_t wait_send_ok_err;           /*!< Set to 1 when we wait for SEND OK or SEND ERROR */
+#if ESP_CFG_CONN_SEND_PACING || __DOXYGEN__
+            uint8_t backoff;                    /*!< Set to `1` while waiting for retry delay */
+#endif /* ESP_CFG_CONN_SEND_PACING || __DOXYGEN__ */
+#if ESP_CFG_CONN_SEND_PIPELINE || __DOXYGEN__
+            size_t pipe_len;                    /*!< Length of next segment for which command was already sent */
+            uint8_t pipe_data_sent;             /*!< Set to `1` when data of next segment were already sent */
+            uint8_t pipe_failed;                /*!< Set to `1` when segment failed while next one was in progress */
+#endif /* ESP_CFG_CONN_SEND_PIPELINE || __DOXYGEN__ */
+#if ESP_CFG_CONN_STATS || __DOXYGEN__
+            uint32_t start_time;                /*!< Time when command for last packet was sent */
+            uint32_t pipe_start_time;           /*!< Time when command for next segment was sent */
+#endif /* ESP_CFG_CONN_STATS || __DOXYGEN__ */
             const esp_ip_t* remote_ip;          /*!< Remote IP address for UDP connection */
             esp_port_t remote_port;             /*!< Remote port address for UDP connection */
             uint8_t fau;                        /*!< Free after use flag to free memory after data are sent (or not) */
+            esp_conn_release_fn release_fn;     /*!< Function to release caller owned data after they are sent */
+            void* release_arg;                  /*!< Custom argument for release function */
             size_t* bw;                         /*!< Number of bytes written so far */
             uint8_t val_id;                     /*!< Connection current validation ID when command was sent to queue */
         } conn_send;                            /*!< Structure to send data on connection */
@@ -380,6 +590,11 @@ typedef struct esp_msg {
         struct {
             const char* host;                   /*!< Hostname to resolve IP address for */
             esp_ip_t* ip;                       /*!< Pointer to IP address to save result */
+            const char* const* hosts;           /*!< Array of host names when resolving multiple names */
+            esp_ip_t* ips;                      /*!< Array of IP addresses for multiple names */
+            espr_t* res;                        /*!< Array of results for multiple names */
+            size_t cnt;                         /*!< Number of names in arrays, `0` when resolving single name */
+            size_t idx;                         /*!< Index of name currently being resolved */
         } dns_getbyhostname;                    /*!< DNS function */
         struct {
             uint8_t en;                         /*!< Enable/Disable status */
@@ -392,6 +607,10 @@ typedef struct esp_msg {
             const char* host;                   /*!< Hostname to ping */
             uint32_t time;                      /*!< Time used for ping */
             uint32_t* time_out;                 /*!< Pointer to time output variable */
+            esp_ping_stats_t* stats;            /*!< Probe statistics of all hosts, `NULL` if not used */
+            size_t cnt;                         /*!< Number of hosts in probe */
+            size_t idx;                         /*!< Index of this ping in probe */
+            size_t total;                       /*!< Index after last ping queued by this probe */
         } tcpip_ping;                           /*!< Pinging structure */
 #endif /* ESP_CFG_PING || __DOXYGEN__ */
 #if ESP_CFG_SNTP || __DOXYGEN__
@@ -425,6 +644,43 @@ typedef struct esp_msg {
             uint8_t pki_number;                 /*!< The index of cert and private key, if only one cert and private key, the value should be 0. */
             uint8_t ca_number;                  /*!< The index of CA, if only one CA, the value should be 0. */
         } tcpip_ssl_cfg;                        /*!< SSl configuration for connection */
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+        struct {
+            const esp_mqtt_at_info_t* info;     /*!< Client information for connect command */
+            const char* host;                   /*!< Broker host for connect command */
+            esp_port_t port;                    /*!< Broker port for connect command */
+            const char* topic;                  /*!< Topic name */
+            const void* data;                   /*!< Data to publish */
+            size_t len;                         /*!< Length of data to publish */
+            uint8_t qos;                        /*!< Quality of service */
+            uint8_t retain;                     /*!< Retain flag for publish */
+            uint8_t wait_result;                /*!< Set to `1` when data were sent and `+MQTTPUB` result is expected */
+        } mqtt_at;                              /*!< MQTT commands on ESP device */
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+#if ESP_CFG_BLE || __DOXYGEN__
+        struct {
+            uint8_t en;                         /*!< Set to `1` to initialize BLE as server, `0` to deinitialize */
+            const char* name;                   /*!< Device name, `NULL` to keep current name */
+            uint8_t conn;                       /*!< BLE connection index to notify */
+            const uint8_t* data;                /*!< Data to send */
+            size_t len;                         /*!< Length of data to send */
+            size_t ptr;                         /*!< Number of bytes already sent */
+            size_t sent;                        /*!< Number of bytes sent with current notification */
+            uint8_t wait_result;                /*!< Set to `1` when data were sent and `OK` is expected */
+        } ble;                                  /*!< BLE data channel */
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+        struct {
+            uint8_t method;                     /*!< Request method, value of \ref esp_http_at_method_t */
+            uint8_t content_type;               /*!< Request body content type, value of \ref esp_http_at_content_type_t */
+            const char* url;                    /*!< Request URL */
+            const char* data;                   /*!< Request body string or `NULL` */
+            const char* headers;                /*!< Request headers as list of `NULL`-terminated strings */
+            size_t headers_cnt;                 /*!< Number of request headers */
+            esp_http_at_data_fn data_fn;        /*!< Response data callback function */
+            void* data_arg;                     /*!< Custom argument for data callback */
+        } http_at;                              /*!< HTTP request on ESP device */
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
     } msg;                                      /*!< Group of different message contents */
 } esp_msg_t;
 
@@ -460,8 +716,150 @@ typedef struct {
 typedef struct esp_evt_func {
     struct esp_evt_func* next;                  /*!< Next function in the list */
     esp_evt_fn fn;                              /*!< Function pointer itself */
+    uint32_t mask;                              /*!< Mask of events function is subscribed to */
 } esp_evt_func_t;
 
+#if ESP_CFG_EVT_DEFERRED || __DOXYGEN__
+
+/**
+ * \brief           Deferred event queue entry
+ */
+typedef struct {
+    esp_evt_t evt;                              /*!< Copy of event structure */
+    esp_conn_p conn;                            /*!< Connection for connection event, `NULL` for global event */
+    esp_evt_fn fn;                              /*!< Callback function, `NULL` to call all global event functions */
+    esp_mac_t mac;                              /*!< Copy of MAC address event points to */
+    esp_ip_t ip;                                /*!< Copy of IP address event points to */
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+    esp_ap_t ap;                                /*!< Copy of access point event points to */
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+} esp_evt_deferred_t;
+
+#endif /* ESP_CFG_EVT_DEFERRED || __DOXYGEN__ */
+
+#if ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__
+
+/**
+ * \brief           Handler for oversized received lines
+ */
+typedef struct {
+    const char* prefix;                         /*!< Line prefix handler is registered for */
+    size_t prefix_len;                          /*!< Length of prefix */
+    esp_recv_line_fn fn;                        /*!< Callback function, `NULL` when entry is free */
+    void* arg;                                  /*!< Custom user argument */
+} esp_recv_line_handler_t;
+
+#endif /* ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_MEM_STATIC || __DOXYGEN__
+
+/**
+ * \brief           Memory unit of fixed-size pool, used to align entries
+ */
+typedef union {
+    void* ptr;                                  /*!< Pointer alignment */
+    uint64_t u64;                               /*!< 64-bit integer alignment */
+} esp_mem_pool_unit_t;
+
+/**
+ * \brief           Fixed-size memory pool with constant time allocation
+ */
+typedef struct {
+    esp_mem_pool_unit_t* mem;                   /*!< Pool memory */
+    size_t units;                               /*!< Size of one entry in units of \ref esp_mem_pool_unit_t */
+    size_t num;                                 /*!< Number of entries */
+    void* free;                                 /*!< First free entry, free entries are linked through first unit */
+    uint8_t init;                               /*!< Set to `1` when free list is built */
+} esp_mem_pool_t;
+
+/**
+ * \brief           Get number of pool units for entry of specific size
+ * \param[in]       size: Entry size in units of bytes
+ */
+#define ESP_MEM_POOL_UNITS(size)                (((size) + sizeof(esp_mem_pool_unit_t) - 1) / sizeof(esp_mem_pool_unit_t))
+
+/**
+ * \brief           Define static fixed-size memory pool
+ * \param[in]       name: Pool variable name
+ * \param[in]       size: Entry size in units of bytes
+ * \param[in]       num: Number of entries
+ */
+#define ESP_MEM_POOL_DEFINE(name, size, num)                                    \
+    static esp_mem_pool_unit_t name ## _mem[ESP_MEM_POOL_UNITS(size) * (num)];  \
+    static esp_mem_pool_t name = { name ## _mem, ESP_MEM_POOL_UNITS(size), (num), NULL, 0 }
+
+#endif /* ESP_CFG_MEM_STATIC || __DOXYGEN__ */
+
+#if ESP_CFG_CONN_SSL_CFG_CACHE || __DOXYGEN__
+
+/**
+ * \brief           SSL configuration remembered for replay after reset
+ */
+typedef struct {
+    size_t size;                                /*!< SSL buffer size, `0` when not set by user */
+    struct {
+        uint8_t set;                            /*!< Set to `1` when configuration for link is valid */
+        uint8_t auth_mode;                      /*!< Authentication mode */
+        uint8_t pki_number;                     /*!< Index of cert and private key */
+        uint8_t ca_number;                      /*!< Index of CA */
+    } cfg[ESP_CFG_MAX_CONNS + 1];               /*!< Configuration per link ID, last entry is for `link_id = ESP_CFG_MAX_CONNS` */
+    uint8_t idx;                                /*!< Link ID to continue replay search from */
+    uint8_t cur;                                /*!< Link ID of entry currently being replayed */
+} esp_ssl_cfg_cache_t;
+
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE || __DOXYGEN__ */
+
+#if ESP_CFG_RESET_WARM_BOOT || __DOXYGEN__
+
+/**
+ * \brief           Module state remembered for warm boot
+ */
+typedef struct {
+    uint8_t valid;                              /*!< Set to `1` when full reset sequence completed and settings were not changed since */
+    uint8_t warm;                               /*!< Set to `1` during reset sequence when fingerprint matched */
+    esp_sw_version_t version_at;                /*!< AT software version fingerprint */
+    esp_sw_version_t version_sdk;               /*!< SDK version fingerprint */
+#if ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__
+    esp_ip_mac_t ap;                            /*!< Access point IP and MAC addresses */
+#endif /* ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__ */
+} esp_warm_boot_t;
+
+#endif /* ESP_CFG_RESET_WARM_BOOT || __DOXYGEN__ */
+
+#if ESP_CFG_RESET_RECOVERY || __DOXYGEN__
+
+/**
+ * \brief           Settings replayed after unexpected device reset
+ */
+typedef struct {
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+    uint8_t sta_valid;                          /*!< Set to `1` when access point join is remembered */
+    uint8_t sta_has_mac;                        /*!< Set to `1` when join used specific access point MAC */
+    char sta_name[33];                          /*!< Access point name */
+    char sta_pass[65];                          /*!< Access point password */
+    esp_mac_t sta_mac;                          /*!< Access point MAC address */
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+    uint8_t server_en;                          /*!< Set to `1` when server configuration is remembered */
+    esp_port_t server_port;                     /*!< Server port */
+    uint16_t server_max_conn;                   /*!< Maximal number of server connections */
+    uint16_t server_timeout;                    /*!< Server connection timeout */
+    esp_evt_fn server_cb;                       /*!< Server event callback */
+} esp_recovery_t;
+
+#endif /* ESP_CFG_RESET_RECOVERY || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_ADAPTIVE_TIMEOUT || __DOXYGEN__
+
+/**
+ * \brief           Observed latency of command type, used to learn its timeout
+ */
+typedef struct {
+    uint16_t count;                             /*!< Number of samples in histogram */
+    uint16_t hist[ESP_CMD_STATS_HIST_LEN];      /*!< Latency histogram, same buckets as \ref esp_cmd_stats_t */
+} esp_cmd_timeout_t;
+
+#endif /* ESP_CFG_CMD_ADAPTIVE_TIMEOUT || __DOXYGEN__ */
+
 /**
  * \brief           ESP modules structure
  */
@@ -471,11 +869,27 @@ typedef struct {
     esp_sw_version_t    version_at;             /*!< Version of AT command software on ESP device */
     esp_sw_version_t    version_sdk;            /*!< Version of SDK used to build AT software */
 
-    uint32_t            active_conns;           /*!< Bit field of currently active connections, @todo: In case user has more than 32 connections, single variable is not enough */
+    uint32_t            active_conns;           /*!< Bit field of active connections reported by last `AT+CIPSTATUS` */
     uint32_t            active_conns_last;      /*!< The same as previous but status before last check */
+    uint32_t            conns_active_mask;      /*!< Bit field mirroring `status.f.active` of every connection,
+                                                    updated by \ref ESP_CONN_SET_ACTIVE */
 
     esp_link_conn_t     link_conn;              /*!< Link connection handle */
     esp_ipd_t           ipd;                    /*!< Connection incoming data structure */
+#if ESP_CFG_CONN_IPD_INFO == 2 || __DOXYGEN__
+    uint8_t             ipd_info;               /*!< Set to `1` when `+IPD` carries remote IP and port */
+#endif /* ESP_CFG_CONN_IPD_INFO == 2 || __DOXYGEN__ */
+#if ESP_CFG_SLEEP || __DOXYGEN__
+    esp_sleep_mode_t    sleep_mode;             /*!< Sleep mode last set on device */
+#endif /* ESP_CFG_SLEEP || __DOXYGEN__ */
+#if ESP_CFG_UPDATE_ASYNC || __DOXYGEN__
+    uint8_t             update_active;          /*!< Set to `1` while background software update is in progress */
+    int32_t             update_stage;           /*!< Last update stage reported by device */
+#endif /* ESP_CFG_UPDATE_ASYNC || __DOXYGEN__ */
+#if ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__
+    esp_conn_p          transparent_conn;       /*!< Connection in transparent mode, `NULL` when not active */
+    uint8_t             transparent_prompt;     /*!< Set to `1` while waiting for `>` before raw data */
+#endif /* ESP_CFG_CONN_TRANSPARENT || __DOXYGEN__ */
     esp_conn_t          conns[ESP_CFG_MAX_CONNS];   /*!< Array of all connection structures */
 
 #if ESP_CFG_MODE_STATION || __DOXYGEN__
@@ -484,53 +898,283 @@ typedef struct {
 #if ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__
     esp_ip_mac_t        ap;                     /*!< Access point IP and MAC addressed */
 #endif /* ESP_CFG_MODE_ACCESS_POINT || __DOXYGEN__ */
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__
+    esp_ap_t            sta_aps[ESP_CFG_STA_LIST_AP_CACHE_SIZE];    /*!< Access points found by last scan */
+    size_t              sta_aps_cnt;            /*!< Number of valid entries in \ref esp_modules_t.sta_aps */
+    uint32_t            sta_aps_time;           /*!< Time when last scan finished */
+    uint8_t             sta_aps_valid;          /*!< Set to `1` when table holds complete result of last scan */
+    uint8_t             sta_aps_filling;        /*!< Set to `1` when scan in progress fills the table */
+    uint8_t             sta_aps_overflow;       /*!< Set to `1` when access point did not fit to table */
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__ */
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0 || __DOXYGEN__
+    esp_sta_t           ap_stas[ESP_CFG_AP_STA_CACHE_SIZE]; /*!< Stations connected to soft access point */
+    size_t              ap_stas_cnt;            /*!< Number of valid entries in \ref esp_modules_t.ap_stas */
+    uint8_t             ap_stas_valid;          /*!< Set to `1` when table holds all connected stations */
+    uint8_t             ap_stas_overflow;       /*!< Set to `1` when station did not fit to table */
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 || __DOXYGEN__ */
+#if ESP_CFG_GETTER_CACHE || __DOXYGEN__
+    uint8_t             cache_valid;            /*!< List of `ESP_CACHE_*` flags for values with valid local copy */
+#if ESP_CFG_HOSTNAME || __DOXYGEN__
+    char                hostname[33];           /*!< Last hostname read from device */
+#endif /* ESP_CFG_HOSTNAME || __DOXYGEN__ */
+#endif /* ESP_CFG_GETTER_CACHE || __DOXYGEN__ */
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+    uint8_t             mqtt_at_connected;      /*!< Set to `1` when MQTT connection on device is connected to broker */
+    esp_mqtt_at_recv_t  mqtt_at_recv;           /*!< Incoming MQTT message structure */
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+#if ESP_CFG_BLE || __DOXYGEN__
+    uint8_t             ble_conns;              /*!< Bit mask of connected BLE clients */
+    esp_ble_recv_t      ble_recv;               /*!< Incoming BLE data structure */
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
+#if ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__
+    esp_http_at_recv_t  http_at_recv;           /*!< Incoming HTTP response data structure */
+#endif /* ESP_CFG_HTTP_CLIENT_AT || __DOXYGEN__ */
 } esp_modules_t;
 
+/**
+ * \ingroup         ESP_UNICODE
+ * \brief           Unicode support structure
+ */
+typedef struct {
+    uint8_t ch[4];                              /*!< UTF-8 max characters */
+    uint8_t t;                                  /*!< Total expected length in UTF-8 sequence */
+    uint8_t r;                                  /*!< Remaining bytes in UTF-8 sequence */
+    espr_t res;                                 /*!< Current result of processing */
+} esp_unicode_t;
+
+/**
+ * \brief           Receive character structure to handle full line terminated with `\n` character
+ */
+typedef struct {
+    char data[128];                             /*!< Received characters */
+    size_t len;                                 /*!< Length of valid characters */
+} esp_recv_t;
+
+#if ESP_CFG_IPD_HDR_FAST || __DOXYGEN__
+/**
+ * \brief           Incremental `+IPD` header recognizer state
+ */
+typedef struct {
+    uint8_t state;                              /*!< `0` when idle, `1`-`4` while matching prefix, then field index */
+    uint8_t conn;                               /*!< Connection number */
+    uint32_t len;                               /*!< Packet length */
+    uint32_t num;                               /*!< Currently parsed IP octet or port */
+    uint8_t ip_idx;                             /*!< Index of IP octet being parsed */
+    uint8_t has_ip;                             /*!< Set to `1` when remote IP and port are part of header */
+    esp_ip_t ip;                                /*!< Remote IP */
+} esp_ipd_hdr_t;
+#endif /* ESP_CFG_IPD_HDR_FAST || __DOXYGEN__ */
+
+#if !ESP_CFG_OS || __DOXYGEN__
+/**
+ * \brief           Command execution state when running without operating system
+ * \sa              esp_poll
+ */
+typedef enum {
+    ESP_POLL_STATE_IDLE = 0,                    /*!< No command is active */
+    ESP_POLL_STATE_DELAY,                       /*!< Waiting for reset delay or device wakeup before command is started */
+    ESP_POLL_STATE_CMD,                         /*!< Command sent, waiting for response from device */
+} esp_poll_state_t;
+#endif /* !ESP_CFG_OS || __DOXYGEN__ */
+
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+
+/**
+ * \brief           Queue of commands for single connection, waiting for producing thread
+ */
+typedef struct {
+    esp_msg_t*          first;                  /*!< First message in queue, taken next */
+    esp_msg_t*          last;                   /*!< Last message in queue */
+    size_t              len;                    /*!< Number of messages in queue */
+} esp_conn_send_q_t;
+
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+
 /**
  * \brief           ESP global structure
  */
 typedef struct {
     size_t              locked_cnt;             /*!< Counter how many times (recursive) stack is currently locked */
 
+#if ESP_CFG_OS || __DOXYGEN__
     esp_sys_sem_t       sem_sync;               /*!< Synchronization semaphore between threads */
+#else /* ESP_CFG_OS || __DOXYGEN__ */
+    esp_poll_state_t    poll_state;             /*!< Command execution state in \ref esp_poll */
+    uint32_t            poll_time;              /*!< Time when current state started */
+    uint32_t            poll_delay;             /*!< Time to wait in \ref ESP_POLL_STATE_DELAY state */
+    uint8_t             poll_cmd_done;          /*!< Set to `1` when current command finished */
+    esp_msg_t*          poll_next;              /*!< Next command in batch to execute, `NULL` if none */
+#endif /* !(ESP_CFG_OS || __DOXYGEN__) */
     esp_sys_mbox_t      mbox_producer;          /*!< Producer message queue handle */
+#if ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__
+    esp_sys_mbox_t      mbox_producer_lane[ESP_MSG_PRIO_END];   /*!< Producer priority lanes. Messages are put here,
+                                                                    \ref mbox_producer receives one wake-up token per message */
+    size_t              producer_lane_tokens;   /*!< Number of lane wake-up tokens which did not fit to full \ref mbox_producer */
+#endif /* ESP_CFG_THREAD_PRODUCER_PRIO || __DOXYGEN__ */
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+    esp_conn_send_q_t   conn_send_q[ESP_CFG_MAX_CONNS]; /*!< Send queues of connections, kept outside connection structure
+                                                    as they outlive connection reset */
+    uint32_t            conn_send_q_mask;       /*!< Bit field of connections with non-empty send queue */
+    uint8_t             conn_send_q_next;       /*!< Connection number to start round-robin search from */
+    uint8_t             conn_send_q_burst;      /*!< Number of commands taken from \ref conn_send_q_next in current turn */
+    uint8_t             conn_send_q_token;      /*!< Set to `1` when wake-up token for send queues is in \ref mbox_producer */
+#if ESP_CFG_OS || __DOXYGEN__
+    esp_sys_sem_t       conn_send_q_sem;        /*!< Semaphore released when message is taken from send queue */
+    size_t              conn_send_q_waiters;    /*!< Number of threads waiting for space in send queue */
+#endif /* ESP_CFG_OS || __DOXYGEN__ */
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+#if ESP_CFG_OS || __DOXYGEN__
     esp_sys_mbox_t      mbox_process;           /*!< Consumer message queue handle */
     esp_sys_thread_t    thread_produce;         /*!< Producer thread handle */
     esp_sys_thread_t    thread_process;         /*!< Processing thread handle */
+#endif /* ESP_CFG_OS || __DOXYGEN__ */
+#if ESP_CFG_CORE_LOCKLESS_READ || __DOXYGEN__
+    volatile uint32_t   status_seq;             /*!< Sequence counter for lock-free reads of connection addresses
+                                                    and station IP. Odd value means update is in progress */
+#endif /* ESP_CFG_CORE_LOCKLESS_READ || __DOXYGEN__ */
 #if !ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__
     esp_buff_t          buff;                   /*!< Input processing buffer */
+    volatile uint8_t    input_wakeup_pending;   /*!< Set when process thread was already notified about new input data
+                                                    and did not yet start draining the buffer */
+#if ESP_CFG_INPUT_FLOW_CTRL || __DOXYGEN__
+    volatile uint8_t    input_paused;           /*!< Set when device transmission is paused with flow control */
+#endif /* ESP_CFG_INPUT_FLOW_CTRL || __DOXYGEN__ */
+#if ESP_CFG_MEM_STATIC || __DOXYGEN__
+    uint8_t             rcv_buff_mem[ESP_CFG_RCV_BUFF_SIZE];    /*!< Input buffer memory in static allocation mode */
+#endif /* ESP_CFG_MEM_STATIC || __DOXYGEN__ */
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+    volatile uint32_t   trace_rx_time;          /*!< Time when oldest unprocessed data were written to input buffer */
+    volatile uint8_t    trace_rx_pending;       /*!< Set by \ref esp_input when `trace_rx_time` is valid */
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
 #endif /* !ESP_CFG_INPUT_USE_PROCESS || __DOXYGEN__ */
+    uint32_t            recv_total_len;         /*!< Total number of bytes received from AT port */
+    uint32_t            recv_calls;             /*!< Number of input function calls */
+    uint32_t            send_total_len;         /*!< Total number of bytes sent to AT port */
+    uint32_t            send_calls;             /*!< Number of low-level send function calls with data */
     esp_ll_t            ll;                     /*!< Low level functions */
+#if ESP_CFG_AT_PORT_TX_BUFF_SIZE || __DOXYGEN__
+    uint8_t             at_tx_buff[ESP_CFG_AT_PORT_TX_BUFF_SIZE];   /*!< Data collected for single AT port write */
+    size_t              at_tx_buff_len;         /*!< Number of bytes waiting in AT port TX buffer */
+#endif /* ESP_CFG_AT_PORT_TX_BUFF_SIZE || __DOXYGEN__ */
+
+    esp_recv_t          recv_buff;              /*!< Line currently received from AT port */
+    uint8_t             recv_ch_prev1;          /*!< Previously received character */
+    uint8_t             recv_ch_prev2;          /*!< Character received before previous one */
+    esp_unicode_t       recv_unicode;           /*!< UTF-8 decoder state of received stream */
+#if ESP_CFG_IPD_HDR_FAST || __DOXYGEN__
+    esp_ipd_hdr_t       ipd_hdr;                /*!< Incremental `+IPD` header recognizer state */
+#endif /* ESP_CFG_IPD_HDR_FAST || __DOXYGEN__ */
 
     esp_msg_t*          msg;                    /*!< Pointer to current user message being executed */
+#if ESP_CFG_CMD_CANCEL || __DOXYGEN__
+    esp_msg_t*          cmd_queued;             /*!< List of messages waiting for producing thread, used for cancellation */
+#endif /* ESP_CFG_CMD_CANCEL || __DOXYGEN__ */
+#if ESP_CFG_CMD_BATCH || __DOXYGEN__
+    esp_cmd_batch_t*    batch;                  /*!< Command batch currently open, core is locked while set */
+#endif /* ESP_CFG_CMD_BATCH || __DOXYGEN__ */
 
     esp_evt_t           evt;                    /*!< Callback processing structure */
     esp_evt_func_t*     evt_func;               /*!< Callback function linked list */
     esp_evt_fn          evt_server;             /*!< Default callback function for server connections */
+#if ESP_CFG_EVT_DEFERRED || __DOXYGEN__
+    esp_evt_deferred_t  evt_queue[ESP_CFG_EVT_DEFERRED_QUEUE_LEN];  /*!< Deferred events waiting for delivery */
+    size_t              evt_queue_r;            /*!< Read index of deferred event queue */
+    size_t              evt_queue_cnt;          /*!< Number of events in deferred event queue */
+    esp_sys_sem_t       evt_sem;                /*!< Semaphore to wake event thread */
+    esp_sys_thread_t    thread_evt;             /*!< Event delivery thread handle */
+#endif /* ESP_CFG_EVT_DEFERRED || __DOXYGEN__ */
 
     esp_modules_t       m;                      /*!< All modules. When resetting, reset structure */
+#if ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__
+    esp_timeout_t       conn_poll_timeout;      /*!< Poll timeout handle, shared by all connections */
+#endif /* ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__ */
+    uint8_t             conn_poll_scheduled;    /*!< Set to `1` when poll timeout is scheduled */
+#if (ESP_CFG_CONN_MANUAL_TCP_RECEIVE && ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO) || __DOXYGEN__
+    uint8_t             conn_recv_queued;       /*!< Set to `1` when manual read command is queued for any connection */
+    uint8_t             conn_recv_next;         /*!< Connection number to start round-robin search from */
+#endif /* (ESP_CFG_CONN_MANUAL_TCP_RECEIVE && ESP_CFG_CONN_MANUAL_TCP_RECEIVE_PRIO) || __DOXYGEN__ */
+#if ESP_CFG_SLEEP || __DOXYGEN__
+    uint32_t            sleep_active_time;      /*!< Time of last communication with device, used for light-sleep wakeup */
+#endif /* ESP_CFG_SLEEP || __DOXYGEN__ */
+#if ESP_CFG_CONN_SSL_CFG_CACHE || __DOXYGEN__
+    esp_ssl_cfg_cache_t ssl_cache;              /*!< SSL configuration kept over reset */
+#endif /* ESP_CFG_CONN_SSL_CFG_CACHE || __DOXYGEN__ */
+#if ESP_CFG_RESET_WARM_BOOT || __DOXYGEN__
+    esp_warm_boot_t     warm_boot;              /*!< Module state kept over reset */
+#endif /* ESP_CFG_RESET_WARM_BOOT || __DOXYGEN__ */
+#if ESP_CFG_RESET_RECOVERY || __DOXYGEN__
+    esp_recovery_t      recovery;               /*!< Settings replayed after unexpected reset */
+#endif /* ESP_CFG_RESET_RECOVERY || __DOXYGEN__ */
+#if ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__
+    esp_snapshot_t      snapshot;               /*!< Applied configuration, verified after reset sequence */
+    uint8_t             snapshot_hostname_ok;   /*!< Set to `1` when device reported recorded hostname during reset sequence */
+#endif /* ESP_CFG_CONFIG_SNAPSHOT || __DOXYGEN__ */
 
     union {
         struct {
             uint8_t     initialized:1;          /*!< Flag indicating ESP library is initialized */
             uint8_t     dev_present:1;          /*!< Flag indicating if physical device is connected to host device */
+#if ESP_CFG_CMD_COALESCE || __DOXYGEN__
+            uint8_t     cipstatus_queued:1;     /*!< Flag indicating connection status command is waiting in producer queue */
+#endif /* ESP_CFG_CMD_COALESCE || __DOXYGEN__ */
         } f;                                    /*!< Flags structure */
     } status;                                   /*!< Status structure */
 
     uint8_t conn_val_id;                        /*!< Validation ID increased each time device connects to wifi network or on reset.
                                                     It is used for connections */
-} esp_t;
 
-/**
- * \ingroup         ESP_UNICODE
- * \brief           Unicode support structure
- */
-typedef struct {
-    uint8_t ch[4];                              /*!< UTF-8 max characters */
-    uint8_t t;                                  /*!< Total expected length in UTF-8 sequence */
-    uint8_t r;                                  /*!< Remaining bytes in UTF-8 sequence */
-    espr_t res;                                 /*!< Current result of processing */
-} esp_unicode_t;
+#if ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__
+    uint32_t baudrate_auto;                     /*!< Highest stable baudrate found by negotiation, `0` if none */
+    uint8_t baudrate_auto_done;                 /*!< Set to `1` when negotiation finished, only remembered rate is used after */
+#endif /* ESP_CFG_AT_PORT_BAUDRATE_AUTO || __DOXYGEN__ */
+
+#if ESP_CFG_RX_STATS || __DOXYGEN__
+    esp_rx_stats_t rx_stats;                    /*!< Receive buffer statistics, written by \ref esp_input */
+    uint32_t rx_overflows_reported;             /*!< Number of overflows already reported with \ref ESP_EVT_RX_OVERFLOW */
+#endif /* ESP_CFG_RX_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_STATS || __DOXYGEN__
+    esp_cmd_stats_t cmd_stats[ESP_CMD_END];     /*!< Latency statistics for every command type */
+#endif /* ESP_CFG_CMD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_CMD_ADAPTIVE_TIMEOUT || __DOXYGEN__
+    esp_cmd_timeout_t cmd_timeout[ESP_CMD_END]; /*!< Learned latency for every command type */
+#endif /* ESP_CFG_CMD_ADAPTIVE_TIMEOUT || __DOXYGEN__ */
+
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+    uint32_t            trace_rx_cur;           /*!< Arrival time of input data currently being processed */
+    esp_trace_stats_t   trace[ESP_TRACE_END];   /*!< Latency statistics for every data path stage */
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+
+#if ESP_CFG_AT_CAPTURE || __DOXYGEN__
+    esp_buff_t          capture_buff;           /*!< AT stream capture records */
+    uint8_t             capture_mem[ESP_CFG_AT_CAPTURE_BUFF_SIZE];  /*!< Memory of capture buffer */
+    uint8_t             capture_en;             /*!< Set to `1` when new records are written */
+    uint32_t            capture_lost;           /*!< Number of records overwritten when buffer was full */
+#endif /* ESP_CFG_AT_CAPTURE || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+    esp_thread_stats_t  thread_stats[ESP_THREAD_END];   /*!< Load statistics of library threads */
+    uint32_t            thread_stats_time[ESP_THREAD_END];  /*!< Time when thread started or stopped waiting */
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
+
+#if ESP_CFG_TELEMETRY_INTERVAL > 0 || __DOXYGEN__
+    esp_telemetry_t telemetry;                  /*!< Device telemetry */
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+    esp_sta_info_ap_t telemetry_ap;             /*!< Access point information of sample in progress */
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+#endif /* ESP_CFG_TELEMETRY_INTERVAL > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__
+    esp_recv_line_handler_t recv_line_handlers[ESP_CFG_RECV_LINE_HANDLERS]; /*!< Oversized line handlers */
+    esp_recv_line_handler_t* recv_line_stream;  /*!< Handler receiving fragments of current line, `NULL` if none */
+    uint8_t recv_line_first;                    /*!< Set to `1` until first fragment of current line is delivered */
+#endif /* ESP_CFG_RECV_LINE_HANDLERS > 0 || __DOXYGEN__ */
+
+#if ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__
+    esp_ipd_alloc_fn ipd_alloc_fn;              /*!< Network data buffer allocation policy, `NULL` for default */
+#endif /* ESP_CFG_IPD_ALLOC_POLICY || __DOXYGEN__ */
+} esp_t;
 
 /**
  * \}
@@ -547,9 +1191,47 @@ typedef struct {
 
 extern esp_t esp;
 
+/*
+ * Protection for read-only status queries
+ *
+ * Single flags are read directly. Multi-byte values are protected with sequence counter:
+ * writer (always holding core lock) makes it odd during update,
+ * reader retries under core lock if counter was odd or changed during copy
+ */
+#if ESP_CFG_CORE_LOCKLESS_READ
+#define ESP_CORE_READ_LOCK()
+#define ESP_CORE_READ_UNLOCK()
+#define ESP_CORE_SEQ_WRITE_BEGIN()              do { ++esp.status_seq; ESP_CFG_BUFF_MEMORY_BARRIER(); } while (0)
+#define ESP_CORE_SEQ_WRITE_END()                do { ESP_CFG_BUFF_MEMORY_BARRIER(); ++esp.status_seq; } while (0)
+#define ESP_CORE_SEQ_READ(read)                 do {\
+    uint32_t esp_seq = esp.status_seq;              \
+    ESP_CFG_BUFF_MEMORY_BARRIER();                  \
+    read;                                           \
+    ESP_CFG_BUFF_MEMORY_BARRIER();                  \
+    if ((esp_seq & 0x01) || esp_seq != esp.status_seq) {    \
+        esp_core_lock();                            \
+        read;                                       \
+        esp_core_unlock();                          \
+    }                                               \
+} while (0)
+#else /* ESP_CFG_CORE_LOCKLESS_READ */
+#define ESP_CORE_READ_LOCK()                    esp_core_lock()
+#define ESP_CORE_READ_UNLOCK()                  esp_core_unlock()
+#define ESP_CORE_SEQ_WRITE_BEGIN()
+#define ESP_CORE_SEQ_WRITE_END()
+#define ESP_CORE_SEQ_READ(read)                 do { esp_core_lock(); read; esp_core_unlock(); } while (0)
+#endif /* !ESP_CFG_CORE_LOCKLESS_READ */
+
 #define ESP_MSG_VAR_DEFINE(name)                esp_msg_t* name
+#if ESP_CFG_MSG_POOL
+#define ESP_MSG_VAR_MALLOC()                    espi_msg_pool_alloc()
+#define ESP_MSG_VAR_MFREE(name)                 do { espi_msg_pool_free(name); (name) = NULL; } while (0)
+#else /* ESP_CFG_MSG_POOL */
+#define ESP_MSG_VAR_MALLOC()                    esp_mem_malloc_tag(sizeof(esp_msg_t), ESP_MEM_TAG_MSG)
+#define ESP_MSG_VAR_MFREE(name)                 esp_mem_free_s((void **)&(name))
+#endif /* !ESP_CFG_MSG_POOL */
 #define ESP_MSG_VAR_ALLOC(name, blocking)       do {\
-    (name) = esp_mem_malloc(sizeof(*(name)));       \
+    (name) = ESP_MSG_VAR_MALLOC();                  \
     ESP_DEBUGW(ESP_CFG_DBG_VAR | ESP_DBG_TYPE_TRACE, (name) != NULL, "[MSG VAR] Allocated %d bytes at %p\r\n", sizeof(*(name)), (name)); \
     ESP_DEBUGW(ESP_CFG_DBG_VAR | ESP_DBG_TYPE_TRACE, (name) == NULL, "[MSG VAR] Error allocating %d bytes\r\n", sizeof(*(name))); \
     if ((name) == NULL) {                           \
@@ -559,13 +1241,19 @@ extern esp_t esp;
     (name)->is_blocking = ESP_U8((blocking) > 0);   \
 } while (0)
 #define ESP_MSG_VAR_REF(name)                   (*(name))
-#define ESP_MSG_VAR_FREE(name)                  do {\
-    ESP_DEBUGF(ESP_CFG_DBG_VAR | ESP_DBG_TYPE_TRACE, "[MSG VAR] Free memory: %p\r\n", (name)); \
+#if ESP_CFG_OS
+#define ESP_MSG_VAR_SEM_FREE(name)              do {\
     if (esp_sys_sem_isvalid(&((name)->sem))) {      \
-        esp_sys_sem_delete(&((name)->sem));         \
-        esp_sys_sem_invalid(&((name)->sem));        \
+        espi_sem_put(&((name)->sem));               \
     }                                               \
-    esp_mem_free_s((void **)&(name));               \
+} while (0)
+#else /* ESP_CFG_OS */
+#define ESP_MSG_VAR_SEM_FREE(name)              do {} while (0)
+#endif /* !ESP_CFG_OS */
+#define ESP_MSG_VAR_FREE(name)                  do {\
+    ESP_DEBUGF(ESP_CFG_DBG_VAR | ESP_DBG_TYPE_TRACE, "[MSG VAR] Free memory: %p\r\n", (name)); \
+    ESP_MSG_VAR_SEM_FREE(name);                     \
+    ESP_MSG_VAR_MFREE(name);                        \
 } while (0)
 #if ESP_CFG_USE_API_FUNC_EVT
 #define ESP_MSG_VAR_SET_EVT(name, e_fn, e_arg)  do {\
@@ -592,21 +1280,124 @@ extern esp_t esp;
 
 #define ESP_PORT2NUM(port)                  ((uint32_t)(port))
 
+#define ESP_CONN_BIT(num)                   (ESP_U32(1) << (num))
+#define ESP_CONN_ALL_BITS                   (ESP_U32(0xFFFFFFFF) >> (32 - ESP_CFG_MAX_CONNS))
+
+#define ESP_CACHE_STA_MAC                   0x01 /*!< Station MAC address in \ref esp_modules_t.sta is valid */
+#define ESP_CACHE_STA_IP                    0x02 /*!< Station IP, gateway and netmask in \ref esp_modules_t.sta are valid */
+#define ESP_CACHE_AP_MAC                    0x04 /*!< Access point MAC address in \ref esp_modules_t.ap is valid */
+#define ESP_CACHE_AP_IP                     0x08 /*!< Access point IP, gateway and netmask in \ref esp_modules_t.ap are valid */
+#define ESP_CACHE_HOSTNAME                  0x10 /*!< Hostname in \ref esp_modules_t.hostname is valid */
+
+/* Set connection active flag and keep active connections bit field in sync */
+#define ESP_CONN_SET_ACTIVE(c, a)           do {    \
+    size_t idx_ = (size_t)((c) - esp.m.conns);      \
+    (c)->status.f.active = !!(a);                   \
+    if ((c)->status.f.active) {                     \
+        esp.m.conns_active_mask |= ESP_CONN_BIT(idx_);  \
+    } else {                                        \
+        esp.m.conns_active_mask &= ~ESP_CONN_BIT(idx_); \
+    }                                               \
+} while (0)
+
 const char * espi_dbg_msg_to_string(esp_cmd_t cmd);
 espr_t      espi_process(const void* data, size_t len);
 espr_t      espi_process_buffer(void);
+#if ESP_CFG_INPUT_FRAMED || __DOXYGEN__
+espr_t      espi_process_conn_data(uint8_t conn_num, const void* data, size_t len);
+#endif /* ESP_CFG_INPUT_FRAMED || __DOXYGEN__ */
 espr_t      espi_initiate_cmd(esp_msg_t* msg);
 uint8_t     espi_is_valid_conn_ptr(esp_conn_p conn);
 espr_t      espi_send_cb(esp_evt_type_t type);
 espr_t      espi_send_conn_cb(esp_conn_t* conn, esp_evt_fn cb);
+size_t      espi_u32_to_dec_str(uint32_t num, char* out);
+uint8_t     espi_bit_ffs(uint32_t v);
+uint8_t     espi_bit_fls(uint32_t v);
+size_t      espi_ip_mac_to_str(const void* d, uint8_t is_ip, char* out);
+#if ESP_CFG_DNS_CACHE_SIZE > 0 || __DOXYGEN__
+uint8_t     espi_dns_cache_get(const char* host, esp_ip_t* ip);
+void        espi_dns_cache_put(const char* host, const esp_ip_t* ip);
+#endif /* ESP_CFG_DNS_CACHE_SIZE > 0 || __DOXYGEN__ */
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__
+void        espi_sta_list_ap_cache_add(const esp_ap_t* ap);
+void        espi_sta_list_ap_cache_dequeued(esp_msg_t* msg);
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__ */
+#if ESP_CFG_AP_STA_CACHE_SIZE > 0 || __DOXYGEN__
+void        espi_ap_sta_cache_set(const esp_mac_t* mac, const esp_ip_t* ip);
+void        espi_ap_sta_cache_remove(const esp_mac_t* mac);
+#endif /* ESP_CFG_AP_STA_CACHE_SIZE > 0 || __DOXYGEN__ */
+#if ESP_CFG_SNTP_SYNC_INTERVAL > 0 || __DOXYGEN__
+void        espi_sntp_cache_put(const esp_datetime_t* dt);
+#endif /* ESP_CFG_SNTP_SYNC_INTERVAL > 0 || __DOXYGEN__ */
+#if ESP_CFG_EVT_DEFERRED || __DOXYGEN__
+uint8_t     espi_evt_deferred_process(void);
+void        espi_evt_deferred_flush(void);
+#endif /* ESP_CFG_EVT_DEFERRED || __DOXYGEN__ */
 void        espi_conn_init(void);
 void        espi_conn_start_timeout(esp_conn_p conn);
+#if ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__
+void        espi_conn_write_idle(esp_conn_p conn);
+#endif /* ESP_CFG_CONN_WRITE_LINGER || __DOXYGEN__ */
 espr_t      espi_conn_manual_tcp_try_read_data(esp_conn_p conn);
+size_t      espi_conn_manual_tcp_get_read_len(esp_conn_p conn);
+#if ESP_CFG_MSG_POOL
+esp_msg_t*  espi_msg_pool_alloc(void);
+void        espi_msg_pool_free(esp_msg_t* msg);
+#endif /* ESP_CFG_MSG_POOL */
+#if ESP_CFG_SLEEP || __DOXYGEN__
+uint32_t    espi_sleep_wakeup(esp_msg_t* msg);
+#endif /* ESP_CFG_SLEEP || __DOXYGEN__ */
+#if ESP_CFG_OS
+uint8_t     espi_sem_get(esp_sys_sem_t* sem);
+void        espi_sem_put(esp_sys_sem_t* sem);
+#endif /* ESP_CFG_OS */
+#if ESP_CFG_MEM_STATIC || __DOXYGEN__
+void*       espi_mem_pool_alloc(esp_mem_pool_t* pool);
+uint8_t     espi_mem_pool_free(esp_mem_pool_t* pool, void* ptr);
+#endif /* ESP_CFG_MEM_STATIC || __DOXYGEN__ */
+void*       espi_conn_buff_alloc(void);
+void        espi_conn_buff_free(void* buff);
 espr_t      espi_send_msg_to_producer_mbox(esp_msg_t* msg, espr_t (*process_fn)(esp_msg_t *), uint32_t max_block_time);
+esp_msg_t*  espi_get_msg_from_producer_mbox(void);
+#if ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__
+void        espi_conn_send_q_wait(esp_conn_p conn);
+#endif /* ESP_CFG_CONN_SEND_QUEUE || __DOXYGEN__ */
+#if ESP_CFG_CMD_COALESCE || __DOXYGEN__
+void        espi_cmd_coalesce_dequeued(esp_msg_t* msg);
+#endif /* ESP_CFG_CMD_COALESCE || __DOXYGEN__ */
+#if ESP_CFG_CMD_CANCEL || __DOXYGEN__
+void        espi_cmd_cancel_dequeued(esp_msg_t* msg);
+#endif /* ESP_CFG_CMD_CANCEL || __DOXYGEN__ */
+#if ESP_CFG_CMD_BATCH || __DOXYGEN__
+espr_t      espi_send_batch_to_producer_mbox(esp_cmd_batch_t* batch, uint32_t blocking);
+#endif /* ESP_CFG_CMD_BATCH || __DOXYGEN__ */
+#if ESP_CFG_OS || __DOXYGEN__
 uint32_t    espi_get_from_mbox_with_timeout_checks(esp_sys_mbox_t* b, void** m, uint32_t timeout);
+#else /* ESP_CFG_OS || __DOXYGEN__ */
+void        espi_timeout_poll(void);
+#endif /* !(ESP_CFG_OS || __DOXYGEN__) */
+
+#if ESP_CFG_IPD_ZERO_COPY
+esp_pbuf_p  espi_pbuf_new_ref(const void* data, size_t len);
+espr_t      espi_pbuf_release_payload(esp_pbuf_p pbuf);
+#endif /* ESP_CFG_IPD_ZERO_COPY */
 
 void        espi_reset_everything(uint8_t forced);
 void        espi_process_events_for_timeout_or_error(esp_msg_t* msg, espr_t err);
+#if ESP_CFG_UPDATE_ASYNC || __DOXYGEN__
+uint8_t     espi_update_cmd_allowed(esp_msg_t* msg);
+#endif /* ESP_CFG_UPDATE_ASYNC || __DOXYGEN__ */
+#if ESP_CFG_LATENCY_TRACE || __DOXYGEN__
+void        espi_trace_add(esp_trace_stage_t stage, uint32_t latency);
+#endif /* ESP_CFG_LATENCY_TRACE || __DOXYGEN__ */
+#if ESP_CFG_AT_CAPTURE || __DOXYGEN__
+void        espi_capture_write(uint8_t dir, const void* data, size_t len);
+void        espi_capture_ll_hook(esp_ll_t* ll);
+#endif /* ESP_CFG_AT_CAPTURE || __DOXYGEN__ */
+espr_t      espi_ll_init(void);
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+void        espi_thread_stats_wait(esp_thread_type_t thread, uint8_t wait);
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
 
 /**
  * \}
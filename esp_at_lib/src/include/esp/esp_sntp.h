@@ -49,6 +49,7 @@ extern "C" {
 
 espr_t      esp_sntp_configure(uint8_t en, int8_t tz, const char* h1, const char* h2, const char* h3, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 espr_t      esp_sntp_gettime(esp_datetime_t* dt, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_sntp_get_sync_age(uint32_t* age);
 
 /**
  * \}
@@ -47,6 +47,24 @@ extern "C" {
  * \{
  */
 
+/**
+ * \anchor          ESP_STA_LIST_AP_FIELD
+ * \name            Scan fields
+ * \brief           Fields of \ref esp_ap_t reported by device, used with \ref esp_sta_list_ap_ex
+ * \{
+ */
+
+#define ESP_STA_LIST_AP_FIELD_ECN       0x01    /*!< Encryption mode */
+#define ESP_STA_LIST_AP_FIELD_SSID      0x02    /*!< Access point name */
+#define ESP_STA_LIST_AP_FIELD_RSSI      0x04    /*!< Signal strength */
+#define ESP_STA_LIST_AP_FIELD_MAC       0x08    /*!< MAC address */
+#define ESP_STA_LIST_AP_FIELD_CH        0x10    /*!< Channel */
+#define ESP_STA_LIST_AP_FIELD_ALL       0x1F    /*!< All fields supported by library */
+
+/**
+ * \}
+ */
+
 espr_t      esp_sta_join(const char* name, const char* pass, const esp_mac_t* mac, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 espr_t      esp_sta_quit(const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 espr_t      esp_sta_autojoin(uint8_t en, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
@@ -57,7 +75,14 @@ espr_t      esp_sta_setmac(const esp_mac_t* mac, const esp_api_cmd_evt_fn evt_fn
 uint8_t     esp_sta_has_ip(void);
 uint8_t     esp_sta_is_joined(void);
 espr_t      esp_sta_copy_ip(esp_ip_t* ip, esp_ip_t* gw, esp_ip_t* nm, uint8_t* is_dhcp);
+#if ESP_CFG_STA_LIST_AP || __DOXYGEN__
 espr_t      esp_sta_list_ap(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_sta_list_ap_ex(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf, uint8_t fields, uint8_t sort, int16_t min_rssi, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+espr_t      esp_sta_list_ap_stream(const char* ssid, int16_t min_rssi, uint8_t stop_on_match, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+#if ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__
+espr_t      esp_sta_list_ap_cached(const char* ssid, esp_ap_t* aps, size_t apsl, size_t* apf, uint32_t max_age, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
+#endif /* ESP_CFG_STA_LIST_AP_CACHE_SIZE > 0 || __DOXYGEN__ */
+#endif /* ESP_CFG_STA_LIST_AP || __DOXYGEN__ */
 espr_t      esp_sta_get_ap_info(esp_sta_info_ap_t* info, const esp_api_cmd_evt_fn evt_fn, void* const evt_arg, const uint32_t blocking);
 uint8_t     esp_sta_is_ap_802_11b(esp_ap_t* ap);
 uint8_t     esp_sta_is_ap_802_11g(esp_ap_t* ap);
@@ -42,6 +42,9 @@ extern "C" {
 
 void    esp_thread_produce(void* const arg);
 void    esp_thread_process(void* const arg);
+#if ESP_CFG_EVT_DEFERRED || __DOXYGEN__
+void    esp_thread_evt(void* const arg);
+#endif /* ESP_CFG_EVT_DEFERRED || __DOXYGEN__ */
 
 #ifdef __cplusplus
 }
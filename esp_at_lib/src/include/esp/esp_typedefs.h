@@ -78,6 +78,7 @@ typedef enum {
     espERRWIFINOTCONNECTED,                     /*!< Wifi not connected to access point */
     espERRNODEVICE,                             /*!< Device is not present */
     espERRBLOCKING,                             /*!< Blocking mode command is not allowed */
+    espABORTED,                                 /*!< Command was cancelled before it finished */
 } espr_t;
 
 /**
@@ -215,6 +216,16 @@ typedef enum {
 #endif /* (ESP_CFG_MODE_STATION_ACCESS_POINT) || __DOXYGEN__ */
 } esp_mode_t;
 
+/**
+ * \ingroup         ESP_SLEEP
+ * \brief           List of possible sleep modes
+ */
+typedef enum {
+    ESP_SLEEP_MODE_DISABLED = 0,                /*!< Sleep disabled */
+    ESP_SLEEP_MODE_MODEM,                       /*!< Modem-sleep, RF is turned off between DTIM beacons */
+    ESP_SLEEP_MODE_LIGHT,                       /*!< Light-sleep, device must be woken up by GPIO before command */
+} esp_sleep_mode_t;
+
 /**
  * \ingroup         ESP_TYPEDEFS
  * \brief           List of possible HTTP methods
@@ -241,6 +252,16 @@ typedef enum {
     ESP_CONN_TYPE_SSL,                          /*!< Connection type is SSL */
 } esp_conn_type_t;
 
+/**
+ * \ingroup         ESP_CONN
+ * \brief           List of UDP modes, used with `AT+CIPSTART` command
+ */
+typedef enum {
+    ESP_CONN_UDP_MODE_FIXED = 0,                /*!< Remote IP and port stay as set on connection start */
+    ESP_CONN_UDP_MODE_CHANGE_ONCE = 1,          /*!< Remote IP and port change once, to first received datagram sender */
+    ESP_CONN_UDP_MODE_ANY_PEER = 2,             /*!< Remote IP and port change to sender of each received datagram */
+} esp_conn_udp_mode_t;
+
 /* Forward declarations */
 struct esp_evt;
 struct esp_conn;
@@ -285,6 +306,10 @@ typedef enum esp_evt_type_t {
 
     ESP_EVT_AT_VERSION_NOT_SUPPORTED,           /*!< Library does not support firmware version on ESP device. */
 
+#if ESP_CFG_RX_STATS || __DOXYGEN__
+    ESP_EVT_RX_OVERFLOW,                        /*!< Receive buffer was full and received data were dropped */
+#endif /* ESP_CFG_RX_STATS || __DOXYGEN__ */
+
     ESP_EVT_CONN_RECV,                          /*!< Connection data received */
     ESP_EVT_CONN_SEND,                          /*!< Connection data send */
     ESP_EVT_CONN_ACTIVE,                        /*!< Connection just became active */
@@ -305,6 +330,7 @@ typedef enum esp_evt_type_t {
                                                     Application may use \ref esp_sta_copy_ip function to read it */
 
     ESP_EVT_STA_LIST_AP,                        /*!< Station listed APs event */
+    ESP_EVT_STA_LIST_AP_ENTRY,                  /*!< Single access point found during streaming scan */
     ESP_EVT_STA_JOIN_AP,                        /*!< Join to access point */
     ESP_EVT_STA_INFO_AP,                        /*!< Station AP info (name, mac, channel, rssi) */
 #endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
@@ -319,6 +345,20 @@ typedef enum esp_evt_type_t {
 #if ESP_CFG_PING || __DOXYGEN__
     ESP_EVT_PING,                               /*!< PING service finished */
 #endif /* ESP_CFG_PING || __DOXYGEN__ */
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+    ESP_EVT_UPDATE_PROGRESS,                    /*!< Remote software update reached new stage */
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+#if ESP_CFG_UPDATE_ASYNC || __DOXYGEN__
+    ESP_EVT_UPDATE,                             /*!< Background software update finished */
+#endif /* ESP_CFG_UPDATE_ASYNC || __DOXYGEN__ */
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+    ESP_EVT_MQTT_AT_CONN,                       /*!< MQTT connection on ESP device connected or disconnected */
+    ESP_EVT_MQTT_AT_RECV,                       /*!< MQTT message received on subscribed topic on ESP device */
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+#if ESP_CFG_BLE || __DOXYGEN__
+    ESP_EVT_BLE_CONN,                           /*!< BLE client connected or disconnected */
+    ESP_EVT_BLE_RECV,                           /*!< BLE client wrote data */
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
 } esp_evt_type_t;
 
 /**
@@ -335,6 +375,12 @@ typedef struct esp_evt {
         struct {
             espr_t res;                         /*!< Reset operation result */
         } reset;                                /*!< Reset sequence finish. Use with \ref ESP_EVT_RESET event */
+#if ESP_CFG_RX_STATS || __DOXYGEN__
+        struct {
+            uint32_t overflows;                 /*!< Total number of truncated writes so far */
+            uint32_t dropped;                   /*!< Total number of dropped bytes so far */
+        } rx_overflow;                          /*!< Receive buffer overflow. Use with \ref ESP_EVT_RX_OVERFLOW event */
+#endif /* ESP_CFG_RX_STATS || __DOXYGEN__ */
         struct {
             espr_t res;                         /*!< Restore operation result */
         } restore;                              /*!< Restore sequence finish. Use with \ref ESP_EVT_RESTORE event */
@@ -376,6 +422,9 @@ typedef struct esp_evt {
             esp_ap_t* aps;                      /*!< Pointer to access points */
             size_t len;                         /*!< Number of access points found */
         } sta_list_ap;                          /*!< Station list access points. Use with \ref ESP_EVT_STA_LIST_AP event */
+        struct {
+            esp_ap_t* ap;                       /*!< Access point just found */
+        } sta_list_ap_entry;                    /*!< Streaming scan access point. Use with \ref ESP_EVT_STA_LIST_AP_ENTRY event */
         struct {
             espr_t res;                         /*!< Result of command */
         } sta_join_ap;                          /*!< Join to access point. Use with \ref ESP_EVT_STA_JOIN_AP event */
@@ -407,6 +456,39 @@ typedef struct esp_evt {
             uint32_t time;                      /*!< Time required for ping. Valid only if operation succedded */
         } ping;                                 /*!< Ping finished. Use with \ref ESP_EVT_PING event */
 #endif /* ESP_CFG_PING || __DOXYGEN__ */
+#if ESP_CFG_MODE_STATION || __DOXYGEN__
+        struct {
+            int32_t stage;                      /*!< Update stage reported by device with `+CIPUPDATE` */
+        } update_progress;                      /*!< Software update progress. Use with \ref ESP_EVT_UPDATE_PROGRESS event */
+#endif /* ESP_CFG_MODE_STATION || __DOXYGEN__ */
+#if ESP_CFG_UPDATE_ASYNC || __DOXYGEN__
+        struct {
+            espr_t res;                         /*!< Result of update */
+        } update;                               /*!< Background software update finished. Use with \ref ESP_EVT_UPDATE event */
+#endif /* ESP_CFG_UPDATE_ASYNC || __DOXYGEN__ */
+#if ESP_CFG_MQTT_AT || __DOXYGEN__
+        struct {
+            uint8_t connected;                  /*!< Set to `1` when connected to broker, `0` otherwise */
+        } mqtt_at_conn;                         /*!< MQTT connection status changed. Use with \ref ESP_EVT_MQTT_AT_CONN event */
+        struct {
+            const char* topic;                  /*!< Topic of received message, `NULL`-terminated */
+            size_t topic_len;                   /*!< Length of topic in units of bytes */
+            const void* data;                   /*!< Message data */
+            size_t len;                         /*!< Length of message data in units of bytes */
+        } mqtt_at_recv;                         /*!< MQTT message received. Use with \ref ESP_EVT_MQTT_AT_RECV event */
+#endif /* ESP_CFG_MQTT_AT || __DOXYGEN__ */
+#if ESP_CFG_BLE || __DOXYGEN__
+        struct {
+            uint8_t conn;                       /*!< BLE connection index */
+            esp_mac_t mac;                      /*!< Address of BLE client */
+            uint8_t connected;                  /*!< Set to `1` when client connected, `0` when disconnected */
+        } ble_conn;                             /*!< BLE client connection status changed. Use with \ref ESP_EVT_BLE_CONN event */
+        struct {
+            uint8_t conn;                       /*!< BLE connection index */
+            esp_pbuf_p buff;                    /*!< Buffer with written data, freed by stack after event.
+                                                     Use \ref esp_pbuf_ref to keep it */
+        } ble_recv;                             /*!< BLE client wrote data. Use with \ref ESP_EVT_BLE_RECV event */
+#endif /* ESP_CFG_BLE || __DOXYGEN__ */
     } evt;                                      /*!< Callback event union */
 } esp_evt_t;
 
@@ -415,6 +497,11 @@ typedef struct esp_evt {
 /**
  * \ingroup         ESP_LL
  * \brief           Function prototype for AT output data
+ *
+ * \note            Data buffer may be reused by caller once function returns.
+ *                  Implementation which transmits asynchronously (DMA) must copy data
+ *                  and may finish transmission after return, latest after flush request
+ *
  * \param[in]       data: Pointer to data to send. This parameter can be set to `NULL`
  * \param[in]       len: Number of bytes to send. This parameter can be set to `0`
  *                      to indicate that internal buffer can be flushed to stream.
@@ -432,6 +519,25 @@ typedef size_t (*esp_ll_send_fn)(const void* data, size_t len);
  */
 typedef uint8_t (*esp_ll_reset_fn)(uint8_t state);
 
+/**
+ * \ingroup         ESP_LL
+ * \brief           Function prototype for receive flow control (RTS line) of AT port
+ * \param[in]       pause: Set to `1` to ask device to stop transmitting (deassert RTS),
+ *                      or `0` when stack is ready to receive again (assert RTS)
+ * \return          `1` on successful action, `0` otherwise
+ */
+typedef uint8_t (*esp_ll_flow_fn)(uint8_t pause);
+
+/**
+ * \ingroup         ESP_LL
+ * \brief           Function prototype for wakeup of device from light-sleep
+ *
+ * Function generates pulse on wakeup GPIO configured with \ref esp_set_wakeup_gpio
+ *
+ * \return          `1` on successful action, `0` otherwise
+ */
+typedef uint8_t (*esp_ll_wakeup_fn)(void);
+
 /**
  * \ingroup         ESP_LL
  * \brief           Low level user specific functions
@@ -439,8 +545,12 @@ typedef uint8_t (*esp_ll_reset_fn)(uint8_t state);
 typedef struct {
     esp_ll_send_fn send_fn;                     /*!< Callback function to transmit data */
     esp_ll_reset_fn reset_fn;                   /*!< Reset callback function */
+    esp_ll_flow_fn flow_fn;                     /*!< Optional receive flow control function, used by \ref ESP_CFG_INPUT_FLOW_CTRL */
+    esp_ll_wakeup_fn wakeup_fn;                 /*!< Optional wakeup function for light-sleep, used by \ref ESP_CFG_SLEEP */
     struct {
         uint32_t baudrate;                      /*!< UART baudrate value */
+        uint32_t max_baudrate;                  /*!< Maximal UART baudrate supported by board, set by low-level driver.
+                                                    Used by \ref ESP_CFG_AT_PORT_BAUDRATE_AUTO, `0` for no limit */
     } uart;                                     /*!< UART communication parameters */
 } esp_ll_t;
 
@@ -457,7 +567,14 @@ typedef void (*esp_timeout_fn)(void* arg);
  */
 typedef struct esp_timeout {
     struct esp_timeout* next;                   /*!< Pointer to next timeout entry */
+#if ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__
+    struct esp_timeout* prev;                   /*!< Pointer to previous timeout entry in wheel slot */
+    uint32_t expires;                           /*!< Wheel tick when timeout expires */
+    uint8_t armed;                              /*!< Set to `1` when timeout is in the wheel */
+    uint8_t allocated;                          /*!< Set to `1` when handle was allocated by \ref esp_timeout_add */
+#else /* ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__ */
     uint32_t time;                              /*!< Time difference from previous entry */
+#endif /* !(ESP_CFG_TIMEOUT_WHEEL || __DOXYGEN__) */
     void* arg;                                  /*!< Argument to pass to callback function */
     esp_timeout_fn fn;                          /*!< Callback function for timeout */
 } esp_timeout_t;
@@ -474,6 +591,26 @@ typedef struct {
     size_t w;                                   /*!< Next write pointer. Buffer is considered empty when `r == w` and full when `w == r - 1` */
 } esp_buff_t;
 
+/**
+ * \ingroup         ESP_BUFF
+ * \brief           Contiguous block of data in ring buffer
+ */
+typedef struct {
+    void* data;                                 /*!< Block start address */
+    size_t len;                                 /*!< Block length in units of bytes */
+} esp_buff_block_t;
+
+/**
+ * \ingroup         ESP
+ * \brief           Command batch structure
+ * \sa              esp_cmd_batch_begin
+ */
+typedef struct {
+    struct esp_msg* first;                      /*!< First command in batch */
+    struct esp_msg* last;                       /*!< Last command in batch */
+    size_t cnt;                                 /*!< Number of commands in batch */
+} esp_cmd_batch_t;
+
 /**
  * \ingroup         ESP_TYPEDEFS
  * \brief           Linear buffer structure
@@ -484,6 +621,273 @@ typedef struct {
     size_t ptr;                                 /*!< Current buffer pointer */
 } esp_linbuff_t;
 
+/**
+ * \ingroup         ESP_PBUF
+ * \brief           Packet buffer pool statistics
+ */
+typedef struct {
+    size_t size;                                /*!< Payload size of pool entry */
+    size_t num;                                 /*!< Number of entries in pool */
+    size_t used;                                /*!< Number of currently used entries */
+    size_t max_used;                            /*!< Maximal number of entries used at the same time */
+    size_t alloc_cnt;                           /*!< Number of successful allocations from pool */
+    size_t fail_cnt;                            /*!< Number of allocations which had to fall back to heap */
+} esp_pbuf_pool_stats_t;
+
+/**
+ * \ingroup         ESP_PBUF
+ * \brief           Function declaration to allocate packet buffer payload memory
+ * \param[in]       len: Length of payload in units of bytes
+ * \return          Pointer to payload memory or `NULL` to use default allocation
+ * \sa              ESP_CFG_PBUF_EXT_PAYLOAD
+ */
+typedef void *  (*esp_pbuf_alloc_fn) (size_t len);
+
+/**
+ * \ingroup         ESP_PBUF
+ * \brief           Function declaration to release packet buffer payload memory
+ * \param[in]       payload: Payload memory given to packet buffer
+ * \sa              ESP_CFG_PBUF_EXT_PAYLOAD
+ */
+typedef void    (*esp_pbuf_free_fn) (void* payload);
+
+#define ESP_CMD_STATS_HIST_LEN                  16  /*!< Number of latency histogram buckets */
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Receive buffer statistics
+ */
+typedef struct {
+    uint32_t overflows;                         /*!< Number of writes truncated because buffer was full */
+    uint32_t dropped;                           /*!< Number of bytes dropped because buffer was full */
+    size_t high_water;                          /*!< Maximal number of bytes waiting in buffer */
+    size_t size;                                /*!< Usable buffer size in units of bytes */
+} esp_rx_stats_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Type of input fragment for framed transports
+ */
+typedef enum {
+    ESP_INPUT_FRAG_CMD = 0x00,                  /*!< AT command text, processed by parser */
+    ESP_INPUT_FRAG_DATA,                        /*!< Data for connection, delivered without parsing */
+} esp_input_frag_type_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Input fragment for framed transports
+ */
+typedef struct {
+    esp_input_frag_type_t type;                 /*!< Fragment type */
+    uint8_t conn_num;                           /*!< Connection number for \ref ESP_INPUT_FRAG_DATA */
+    const void* data;                           /*!< Pointer to fragment payload */
+    size_t len;                                 /*!< Length of payload in units of bytes */
+} esp_input_frag_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           AT port traffic counters
+ */
+typedef struct {
+    uint32_t recv_bytes;                        /*!< Number of bytes received from AT port */
+    uint32_t recv_calls;                        /*!< Number of input function calls */
+    uint32_t send_bytes;                        /*!< Number of bytes sent to AT port */
+    uint32_t send_calls;                        /*!< Number of low-level send function calls with data */
+} esp_io_stats_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Command latency statistics
+ */
+typedef struct {
+    uint32_t count;                             /*!< Number of started commands */
+    uint32_t timeouts;                          /*!< Number of commands which did not finish in time */
+    uint32_t hist[ESP_CMD_STATS_HIST_LEN];      /*!< Latency histogram. Bucket `0` counts commands finished in `0` ms,
+                                                    bucket `i` commands finished in `[2^(i-1), 2^i)` ms,
+                                                    last bucket all longer commands. Timeouts are not included */
+} esp_cmd_stats_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Data path stage measured by \ref ESP_CFG_LATENCY_TRACE
+ */
+typedef enum {
+    ESP_TRACE_RX_INPUT = 0,                     /*!< Data waiting in input buffer from \ref esp_input until processing starts */
+    ESP_TRACE_RX_IPD,                           /*!< From `+IPD` header until packet buffer is complete and sent to connection callback */
+    ESP_TRACE_RX_MBOX,                          /*!< Packet buffer waiting in netconn receive queue until application reads it */
+    ESP_TRACE_RX_TOTAL,                         /*!< From data arrival to input buffer until netconn returns packet buffer */
+    ESP_TRACE_MSG_QUEUE,                        /*!< Command waiting in producer queue until it is started */
+    ESP_TRACE_TX_SEND,                          /*!< From \ref esp_conn_send call until `SEND OK` */
+    ESP_TRACE_END,                              /*!< Last entry, number of stages */
+} esp_trace_stage_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Latency statistics of data path stage
+ */
+typedef struct {
+    uint32_t count;                             /*!< Number of samples */
+    uint32_t max;                               /*!< Maximal latency in units of milliseconds */
+    uint32_t hist[ESP_CMD_STATS_HIST_LEN];      /*!< Latency histogram, same buckets as \ref esp_cmd_stats_t */
+} esp_trace_stats_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Library thread measured by \ref ESP_CFG_THREAD_STATS
+ */
+typedef enum {
+    ESP_THREAD_PRODUCE = 0,                     /*!< Producing thread, sending commands to device */
+    ESP_THREAD_PROCESS,                         /*!< Processing thread, parsing data received from device */
+    ESP_THREAD_END,                             /*!< Last entry, number of threads */
+} esp_thread_type_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Load and stack statistics of library thread
+ */
+typedef struct {
+    uint32_t busy_time;                         /*!< Time spent working in units of milliseconds */
+    uint32_t idle_time;                         /*!< Time spent waiting in units of milliseconds */
+    uint32_t wakeups;                           /*!< Number of times thread woke up from waiting */
+    size_t stack_free;                          /*!< Stack never used since thread start in units of bytes,
+                                                    `0` when not supported by system port */
+} esp_thread_stats_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Device telemetry sampled every \ref ESP_CFG_TELEMETRY_INTERVAL
+ */
+typedef struct {
+    uint32_t ram_free;                          /*!< Free RAM on device in units of bytes at last sample */
+    uint32_t ram_free_min;                      /*!< Lowest free RAM seen since sampling started or last reset of statistics */
+    int16_t rssi;                               /*!< RSSI of connected access point at last sample, `0` when not connected */
+    uint32_t samples;                           /*!< Number of successful samples */
+    uint32_t time;                              /*!< System time of last successful sample in units of milliseconds */
+} esp_telemetry_t;
+
+#define ESP_SNAPSHOT_MODE                   0x01 /*!< Wi-Fi mode in \ref esp_snapshot_t is recorded */
+#define ESP_SNAPSHOT_DHCP_STA               0x02 /*!< Station DHCP state in \ref esp_snapshot_t is recorded */
+#define ESP_SNAPSHOT_DHCP_AP                0x04 /*!< Access point DHCP state in \ref esp_snapshot_t is recorded */
+#define ESP_SNAPSHOT_STA_IP                 0x08 /*!< Station static IP in \ref esp_snapshot_t is recorded */
+#define ESP_SNAPSHOT_AP_IP                  0x10 /*!< Access point IP in \ref esp_snapshot_t is recorded */
+#define ESP_SNAPSHOT_HOSTNAME               0x20 /*!< Hostname in \ref esp_snapshot_t is recorded */
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Configuration snapshot, see \ref ESP_CFG_CONFIG_SNAPSHOT
+ *
+ * Structure contains no pointers and may be saved to non-volatile memory as it is
+ */
+typedef struct {
+    uint32_t flags;                             /*!< Bit field of recorded settings, `ESP_SNAPSHOT_*` values */
+    uint8_t mode;                               /*!< Wi-Fi mode, member of \ref esp_mode_t enumeration */
+    uint8_t dhcp_sta;                           /*!< Set to `1` when station DHCP is enabled */
+    uint8_t dhcp_ap;                            /*!< Set to `1` when access point DHCP is enabled */
+    esp_ip_t sta_ip;                            /*!< Station IP address */
+    esp_ip_t sta_gw;                            /*!< Station gateway address, zero when not set */
+    esp_ip_t sta_nm;                            /*!< Station netmask address, zero when not set */
+    esp_ip_t ap_ip;                             /*!< Access point IP address */
+    esp_ip_t ap_gw;                             /*!< Access point gateway address, zero when not set */
+    esp_ip_t ap_nm;                             /*!< Access point netmask address, zero when not set */
+    char hostname[33];                          /*!< Station hostname */
+} esp_snapshot_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Ping statistics of single host, used by \ref esp_ping_probe
+ */
+typedef struct {
+    const char* host;                           /*!< Host name or IP address to ping, set by application */
+    uint16_t sent;                              /*!< Number of finished pings */
+    uint16_t received;                          /*!< Number of successful pings, loss is `sent - received` */
+    uint32_t time_min;                          /*!< Minimal ping time in units of milliseconds */
+    uint32_t time_max;                          /*!< Maximal ping time in units of milliseconds */
+    uint32_t time_avg;                          /*!< Average ping time in units of milliseconds */
+    uint32_t time_sum;                          /*!< Sum of all successful ping times in units of milliseconds */
+} esp_ping_stats_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           MQTT client configuration for `AT+MQTTUSERCFG` and `AT+MQTTCONNCFG` commands
+ */
+typedef struct {
+    const char* id;                             /*!< Client identifier */
+    const char* user;                           /*!< Username, set to `NULL` when not used */
+    const char* pass;                           /*!< Password, set to `NULL` when not used */
+    uint16_t keep_alive;                        /*!< Keep-alive time in units of seconds */
+    const char* will_topic;                     /*!< Will topic, set to `NULL` when not used */
+    const char* will_message;                   /*!< Will message, `NULL`-terminated string */
+    uint8_t will_qos;                           /*!< Will quality of service */
+} esp_mqtt_at_info_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Request method for `AT+HTTPCLIENT` command
+ */
+typedef enum {
+    ESP_HTTP_AT_METHOD_HEAD = 1,                /*!< HEAD request */
+    ESP_HTTP_AT_METHOD_GET,                     /*!< GET request */
+    ESP_HTTP_AT_METHOD_POST,                    /*!< POST request */
+    ESP_HTTP_AT_METHOD_PUT,                     /*!< PUT request */
+    ESP_HTTP_AT_METHOD_DELETE,                  /*!< DELETE request */
+} esp_http_at_method_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Request body content type for `AT+HTTPCLIENT` command
+ */
+typedef enum {
+    ESP_HTTP_AT_CONTENT_TYPE_FORM = 0,          /*!< `application/x-www-form-urlencoded` */
+    ESP_HTTP_AT_CONTENT_TYPE_JSON,              /*!< `application/json` */
+    ESP_HTTP_AT_CONTENT_TYPE_MULTIPART,         /*!< `multipart/form-data` */
+    ESP_HTTP_AT_CONTENT_TYPE_XML,               /*!< `text/xml` */
+} esp_http_at_content_type_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Response data received with `AT+HTTPCLIENT` command callback function
+ * \note            Function is called from processing thread, while response is received from device
+ * \param[in]       data: Part of response body
+ * \param[in]       len: Length of data in units of bytes
+ * \param[in]       arg: Custom user argument
+ */
+typedef void (*esp_http_at_data_fn)(const void* data, size_t len, void* arg);
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Data fragment descriptor for scatter-gather write functions
+ */
+typedef struct {
+    const void* data;                           /*!< Pointer to fragment data */
+    size_t len;                                 /*!< Length of fragment in units of bytes */
+} esp_iovec_t;
+
+/**
+ * \ingroup         ESP_CONN
+ * \brief           Connection statistics
+ */
+typedef struct {
+    size_t bytes_sent;                          /*!< Number of bytes confirmed with `SEND OK` */
+    size_t bytes_recved;                        /*!< Number of bytes received */
+    uint32_t cipsend_cnt;                       /*!< Number of `AT+CIPSEND` commands sent */
+    uint32_t send_ok_cnt;                       /*!< Number of segments confirmed with `SEND OK` */
+    uint32_t send_fail_cnt;                     /*!< Number of segments which failed to send */
+    uint32_t retries;                           /*!< Number of segments sent again after failure */
+    uint32_t latency_min;                       /*!< Minimal time from `AT+CIPSEND` to `SEND OK` in units of milliseconds */
+    uint32_t latency_avg;                       /*!< Average time from `AT+CIPSEND` to `SEND OK` in units of milliseconds */
+    uint32_t latency_max;                       /*!< Maximal time from `AT+CIPSEND` to `SEND OK` in units of milliseconds */
+    size_t seg_len;                             /*!< Current segment length of send pacing, used by \ref ESP_CFG_CONN_SEND_PACING */
+    uint32_t backoff;                           /*!< Current retry delay of send pacing in units of milliseconds */
+} esp_conn_stats_t;
+
+/**
+ * \ingroup         ESP_CONN
+ * \brief           Function declaration for releasing caller owned memory after data are sent
+ * \param[in]       data: Pointer to data as passed to \ref esp_conn_send_ref
+ * \param[in]       arg: Custom user argument
+ */
+typedef void (*esp_conn_release_fn) (const void* data, void* arg);
+
 /**
  * \ingroup         ESP_TYPEDEFS
  * \brief           Function declaration for API function command event callback function
@@ -492,6 +896,53 @@ typedef struct {
  */
 typedef void (*esp_api_cmd_evt_fn) (espr_t res, void* arg);
 
+/**
+ * \ingroup         ESP_ASYNC
+ * \brief           Completion token for asynchronous API call
+ * \note            Token must stay valid until command has finished
+ */
+typedef struct {
+    volatile uint8_t done;                      /*!< Set to `1` when command has finished */
+    espr_t res;                                 /*!< Command result, valid when `done` is set */
+    esp_api_cmd_evt_fn fn;                      /*!< Optional function called on completion, for example to resume a coroutine */
+    void* arg;                                  /*!< Custom argument for completion function */
+} esp_async_t;
+
+/**
+ * \ingroup         ESP_TYPEDEFS
+ * \brief           Function declaration for fragments of oversized received line
+ * \param[in]       data: Fragment data. It is not `NULL` terminated
+ * \param[in]       len: Fragment length in units of bytes
+ * \param[in]       is_first: Set to `1` for first fragment, which starts with registered prefix
+ * \param[in]       is_last: Set to `1` for last fragment, which ends with `\n` character
+ * \param[in]       arg: Custom user argument
+ * \sa              ESP_CFG_RECV_LINE_HANDLERS
+ */
+typedef void (*esp_recv_line_fn) (const char* data, size_t len, uint8_t is_first, uint8_t is_last, void* arg);
+
+/**
+ * \ingroup         ESP_CONN
+ * \brief           Packet buffer allocation request for received network data
+ * \sa              ESP_CFG_IPD_ALLOC_POLICY
+ */
+typedef struct {
+    esp_conn_p conn;                            /*!< Connection data are received on */
+    size_t ipd_len;                             /*!< Total length announced by `+IPD` statement */
+    size_t rem_len;                             /*!< Bytes of `+IPD` statement not yet in any buffer */
+    size_t mem_free;                            /*!< Size of largest free memory block, `SIZE_MAX` when not known */
+    uint8_t is_first;                           /*!< Set to `1` for first buffer of `+IPD` statement */
+    uint8_t whole;                              /*!< Set to `1` by function on first buffer to deliver entire `+IPD` statement in one event */
+} esp_ipd_alloc_t;
+
+/**
+ * \ingroup         ESP_CONN
+ * \brief           Function declaration for network data buffer allocation policy
+ * \param[in,out]   req: Allocation request
+ * \return          Buffer size in units of bytes, limited to `rem_len`. Use `0` to apply default policy
+ * \sa              ESP_CFG_IPD_ALLOC_POLICY
+ */
+typedef size_t (*esp_ipd_alloc_fn) (esp_ipd_alloc_t* req);
+
 /**
  * \ingroup         ESP_CONN
  * \brief           Connection start structure, used to start the connection in extended mode
@@ -508,7 +959,7 @@ typedef struct {
         } tcp_ssl;                              /*!< TCP/SSL specific features */
         struct {
             esp_port_t local_port;              /*!< Custom local port for UDP */
-            uint8_t mode;                       /*!< UDP mode. Set to `0` by default. Check ESP AT commands instruction set for more info when needed */
+            uint8_t mode;                       /*!< UDP mode, member of \ref esp_conn_udp_mode_t. Set to `0` by default */
         } udp;                                  /*!< UPD specific features */
     } ext;                                      /*!< Extended support union */
 } esp_conn_start_t;
@@ -48,6 +48,7 @@ extern "C" {
  */
 
 espr_t          espi_unicode_decode(esp_unicode_t* uni, uint8_t ch);
+size_t          espi_unicode_seq_len(const uint8_t* d, size_t len);
 
 /**
  * \}
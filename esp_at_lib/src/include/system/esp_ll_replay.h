@@ -0,0 +1,86 @@
+/**
+ * \file            esp_ll_replay.h
+ * \brief           Low-level replay of captured AT stream
+ */
+
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_LL_REPLAY_H
+#define ESP_HDR_LL_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP_LL
+ * \defgroup        ESP_LL_REPLAY Replay of captured traffic
+ * \brief           Low-level implementation feeding recorded device output back to stack
+ *
+ * Compile `system/esp_ll_replay.c` instead of hardware low-level file.
+ * Trace uses record format of \ref ESP_CAPTURE, as written by \ref esp_capture_read.
+ *
+ * Received records are fed to stack with original time distance, divided by speed factor.
+ * Before every received record, replay waits until stack has sent
+ * at least as many bytes as were sent before it in original trace,
+ * so responses follow commands in the same order as on real device.
+ *
+ * \{
+ */
+
+#define ESP_LL_REPLAY_SYNC_TIMEOUT          2000/*!< Maximal time in milliseconds to wait for stack to send expected data */
+
+/**
+ * \brief           Replay statistics
+ */
+typedef struct {
+    size_t records;                             /*!< Number of records processed from trace */
+    size_t rx_bytes;                            /*!< Number of bytes fed to stack */
+    size_t tx_bytes;                            /*!< Number of bytes stack sent */
+    size_t tx_expected;                         /*!< Number of bytes sent in trace until current record */
+    size_t sync_timeouts;                       /*!< Number of times stack did not send expected data in time */
+    uint32_t process_time;                      /*!< Time spent in stack input function in units of milliseconds */
+    uint8_t done;                               /*!< Set to `1` when complete trace was fed to stack */
+} esp_ll_replay_stats_t;
+
+espr_t      esp_ll_replay_start(const void* trace, size_t len, uint32_t speed);
+void        esp_ll_replay_get_stats(esp_ll_replay_stats_t* stats);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* ESP_HDR_LL_REPLAY_H */
@@ -0,0 +1,95 @@
+/**
+ * \file            esp_ll_sim.h
+ * \brief           Simulated ESP AT device for host testing and benchmarks
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_LL_SIM_H
+#define ESP_HDR_LL_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP_LL
+ * \defgroup        ESP_LL_SIM Simulated device
+ * \brief           Low-level implementation with simulated AT device
+ *
+ * Compile `system/esp_ll_sim.c` instead of hardware low-level file.
+ * Simulated device answers basic, `AT+CWJAP`, `AT+CIPSTART`, `AT+CIPSEND`, `AT+CIPCLOSE`
+ * and `AT+CIPSTATUS` commands and emulates device as ESP8266 with AT version 2.1.0.
+ * Network data are generated with \ref esp_ll_sim_inject_ipd.
+ * Remote side of connections can be emulated with \ref esp_ll_sim_set_peer,
+ * such as echo server or broker for end-to-end benchmarks.
+ *
+ * \note            Automatic TCP receive must be used, \ref ESP_CFG_CONN_MANUAL_TCP_RECEIVE is not supported
+ * \{
+ */
+
+/**
+ * \brief           Simulated device statistics
+ */
+typedef struct {
+    size_t bytes_to_device;                     /*!< Number of bytes stack sent to device */
+    size_t bytes_from_device;                   /*!< Number of bytes device sent to stack */
+    size_t cmd_cnt;                             /*!< Number of received AT commands */
+    size_t send_cnt;                            /*!< Number of `AT+CIPSEND` data packets */
+    size_t send_bytes;                          /*!< Number of network data bytes received with `AT+CIPSEND` */
+    size_t peer_drop_cnt;                       /*!< Number of data packets dropped because remote peer was too slow */
+} esp_ll_sim_stats_t;
+
+/**
+ * \brief           Remote peer callback, called from simulator thread without core lock
+ * \param[in]       conn: Connection number
+ * \param[in]       data: Data stack sent to remote side, `NULL` when stack closed connection
+ * \param[in]       len: Length of data in units of bytes
+ */
+typedef void (*esp_ll_sim_peer_fn)(uint8_t conn, const void* data, size_t len);
+
+void        esp_ll_sim_set_timing(uint32_t baudrate, uint32_t latency);
+espr_t      esp_ll_sim_inject(const void* data, size_t len);
+espr_t      esp_ll_sim_inject_ipd(uint8_t conn, const void* data, size_t len);
+espr_t      esp_ll_sim_close(uint8_t conn);
+void        esp_ll_sim_set_peer(esp_ll_sim_peer_fn fn);
+espr_t      esp_ll_sim_accept(uint8_t conn, esp_port_t local_port);
+void        esp_ll_sim_get_stats(esp_ll_sim_stats_t* stats);
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* ESP_HDR_LL_SIM_H */
@@ -0,0 +1,126 @@
+/**
+ * \file            esp_ll_spi.h
+ * \brief           Low-level communication with ESP device over SPI
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#ifndef ESP_HDR_LL_SPI_H
+#define ESP_HDR_LL_SPI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "esp/esp.h"
+
+/**
+ * \ingroup         ESP_LL
+ * \defgroup        ESP_LL_SPI SPI transport
+ * \brief           Low-level implementation with framed SPI transfers to ESP32 SPI AT firmware
+ *
+ * Compile `system/esp_ll_spi.c` instead of UART low-level file and implement
+ * `esp_ll_spi_board_*` functions for the board.
+ * Data are exchanged in frames of up to `ESP_LL_SPI_MAX_FRAME_LEN` bytes,
+ * device signals with handshake GPIO when it has data or is ready to receive.
+ *
+ * \note            OS must be used, \ref ESP_CFG_OS must be enabled
+ * \{
+ */
+
+/**
+ * \brief           SPI transport statistics
+ */
+typedef struct {
+    size_t rx_frames;                           /*!< Number of frames received from device */
+    size_t rx_bytes;                            /*!< Number of bytes received from device */
+    size_t tx_frames;                           /*!< Number of frames sent to device */
+    size_t tx_bytes;                            /*!< Number of bytes sent to device */
+    size_t tx_errors;                           /*!< Number of frames device did not accept in time */
+} esp_ll_spi_stats_t;
+
+void        esp_ll_spi_get_stats(esp_ll_spi_stats_t* stats);
+
+/**
+ * \name            Board functions
+ * \brief           Functions implemented by application for specific board
+ * \{
+ */
+
+/**
+ * \brief           Configure SPI peripheral, DMA, handshake and reset GPIOs
+ * \note            Called once on first \ref esp_ll_init
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t     esp_ll_spi_board_init(void);
+
+/**
+ * \brief           Execute single half-duplex SPI transaction with DMA
+ *
+ * Transaction consists of `8-bit` command, `8-bit` address and `8` dummy bits,
+ * followed by data phase where `len` bytes are sent from `tx` or received to `rx`.
+ * Function returns when transaction is complete, calling thread may sleep meanwhile.
+ *
+ * \param[in]       cmd: Command value
+ * \param[in]       addr: Address value
+ * \param[in]       tx: Data to send or `NULL` for receive transaction
+ * \param[out]      rx: Memory to receive data to or `NULL` for send transaction
+ * \param[in]       len: Length of data phase in units of bytes, `0` for command only
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t     esp_ll_spi_board_transfer(uint8_t cmd, uint8_t addr, const void* tx, void* rx, size_t len);
+
+/**
+ * \brief           Wait until handshake GPIO is active
+ *
+ * Function returns immediately if line is already active,
+ * otherwise calling thread sleeps until interrupt on rising edge
+ */
+void        esp_ll_spi_board_wait_handshake(void);
+
+/**
+ * \brief           Set reset GPIO state
+ * \param[in]       state: Set to `1` to put device to reset, `0` to release it
+ * \return          `1` on success, `0` if reset is not supported
+ */
+uint8_t     esp_ll_spi_board_reset(uint8_t state);
+
+/**
+ * \}
+ */
+
+/**
+ * \}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* ESP_HDR_LL_SPI_H */
@@ -63,6 +63,7 @@ typedef void (*esp_sys_thread_fn)(void *);
 
 #define ESP_SYS_PORT_WIN32                  1   /*!< WIN32 based port to use ESP library with Windows applications */
 #define ESP_SYS_PORT_CMSIS_OS               2   /*!< CMSIS-OS based port for OS systems capable of ARM CMSIS standard */
+#define ESP_SYS_PORT_POSIX                  3   /*!< POSIX based port to use ESP library with Linux and other pthreads systems */
 #define ESP_SYS_PORT_USER                   99  /*!< User custom implementation.
                                                     When port is selected to user mode, user must provide "esp_sys_user.h" file,
                                                     which is not provided with library. Refer to `system/esp_sys_template.h` file for more information
@@ -77,6 +78,8 @@ typedef void (*esp_sys_thread_fn)(void *);
 #include "system/esp_sys_win32.h"
 #elif ESP_CFG_SYS_PORT == ESP_SYS_PORT_CMSIS_OS
 #include "system/esp_sys_cmsis_os.h"
+#elif ESP_CFG_SYS_PORT == ESP_SYS_PORT_POSIX
+#include "system/esp_sys_posix.h"
 #elif ESP_CFG_SYS_PORT == ESP_SYS_PORT_USER
 #include "esp_sys_user.h"
 #endif /* GSM_CFG_SYS_PORT check */
@@ -114,6 +117,16 @@ uint8_t     esp_sys_thread_create(esp_sys_thread_t* t, const char* name, esp_sys
 uint8_t     esp_sys_thread_terminate(esp_sys_thread_t* t);
 uint8_t     esp_sys_thread_yield(void);
 
+#if ESP_CFG_SYS_THREAD_NOTIFY || __DOXYGEN__
+uint8_t     esp_sys_thread_notify(esp_sys_thread_t* t);
+uint32_t    esp_sys_thread_notify_wait(uint32_t timeout);
+uint8_t     esp_sys_thread_notify_clear(void);
+#endif /* ESP_CFG_SYS_THREAD_NOTIFY || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+size_t      esp_sys_thread_stack_free(esp_sys_thread_t* t);
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
+
 /**
  * \}
  */
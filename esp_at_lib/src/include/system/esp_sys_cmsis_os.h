@@ -47,9 +47,22 @@ extern "C" {
 
 #include "cmsis_os.h"
 
+/*
+ * Set to `1` to use library native message boxes instead of OS message queues.
+ * Native mbox is static ring of pointers with counting semaphores,
+ * pointer is stored directly without copy through kernel queue
+ */
+#if !defined(ESP_SYS_MBOX_NATIVE)
+#define ESP_SYS_MBOX_NATIVE         0
+#endif /* !defined(ESP_SYS_MBOX_NATIVE) */
+
 typedef osMutexId_t                 esp_sys_mutex_t;
 typedef osSemaphoreId_t             esp_sys_sem_t;
+#if ESP_SYS_MBOX_NATIVE
+typedef struct esp_sys_mbox*        esp_sys_mbox_t;
+#else /* ESP_SYS_MBOX_NATIVE */
 typedef osMessageQueueId_t          esp_sys_mbox_t;
+#endif /* !ESP_SYS_MBOX_NATIVE */
 typedef osThreadId_t                esp_sys_thread_t;
 typedef osPriority_t                esp_sys_thread_prio_t;
 #define ESP_SYS_MBOX_NULL           ((esp_sys_mbox_t)0)
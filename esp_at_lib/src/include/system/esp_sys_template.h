@@ -118,7 +118,26 @@ typedef osPriority_t        esp_sys_thread_prio_t;
  * \note            Keep as is in case of CMSIS based OS, otherwise change for your OS
  */
 #define ESP_SYS_THREAD_SS           (1024)
-#endif /* ESP_OS || __DOXYGEN__ */
+#else /* ESP_CFG_OS || __DOXYGEN__ */
+
+/*
+ * Without operating system, stack only uses message queues
+ * with non-blocking functions and protection functions.
+ * Other types are required for function prototypes only
+ */
+typedef struct esp_sys_mbox* esp_sys_mbox_t;
+typedef void*               esp_sys_mutex_t;
+typedef void*               esp_sys_sem_t;
+typedef void*               esp_sys_thread_t;
+typedef int                 esp_sys_thread_prio_t;
+
+#define ESP_SYS_MBOX_NULL           (esp_sys_mbox_t)0
+#define ESP_SYS_SEM_NULL            (esp_sys_sem_t)0
+#define ESP_SYS_MUTEX_NULL          (esp_sys_mutex_t)0
+#define ESP_SYS_TIMEOUT             (0xFFFFFFFF)
+#define ESP_SYS_THREAD_PRIO         (0)
+#define ESP_SYS_THREAD_SS           (0)
+#endif /* !(ESP_CFG_OS || __DOXYGEN__) */
 
 /**
  * \}
@@ -0,0 +1,377 @@
+/**
+ * \file            esp_ll_posix.c
+ * \brief           Low-level communication with ESP device for POSIX systems (termios)
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "system/esp_ll.h"
+#include "esp/esp.h"
+#include "esp/esp_mem.h"
+#include "esp/esp_input.h"
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+
+#if !__DOXYGEN__
+
+/* Serial device connected to ESP, override in compiler options */
+#if !defined(ESP_LL_POSIX_DEV)
+#define ESP_LL_POSIX_DEV                    "/dev/ttyUSB0"
+#endif
+
+/* Set to 1 when ESP reset pin is driven from RTS line of USB to UART converter */
+#if !defined(ESP_LL_POSIX_RESET_RTS)
+#define ESP_LL_POSIX_RESET_RTS              0
+#endif
+
+static uint8_t initialized = 0;
+static pthread_t thread_handle;
+static volatile int com_port = -1;              /*!< Serial port file descriptor */
+static int epoll_fd = -1;                       /*!< Epoll instance waiting for RX data */
+static uint8_t data_buffer[0x1000];             /*!< Received data array */
+static uint8_t tx_buffer[0x1000];               /*!< Data array for batched transmit */
+static size_t tx_buffer_len;                    /*!< Number of bytes waiting in TX buffer */
+
+static void* uart_thread(void* param);
+
+/**
+ * \brief           Write all vectors to serial port, retry on partial writes
+ * \param[in,out]   iov: Array of vectors, modified during write
+ * \param[in]       iovcnt: Number of vectors
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+write_vectors(struct iovec* iov, int iovcnt) {
+    ssize_t written;
+
+    while (iovcnt > 0) {
+        written = writev(com_port, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return 0;
+        }
+        /* Skip fully written vectors and advance partial one */
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Write TX buffer and optional extra data with single system call
+ * \param[in]       data: Additional data to write after buffer or `NULL`
+ * \param[in]       len: Length of additional data
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+send_data_flush(const void* data, size_t len) {
+    struct iovec iov[2];
+    int iovcnt = 0;
+    uint8_t res;
+
+    if (tx_buffer_len > 0) {
+        iov[iovcnt].iov_base = tx_buffer;
+        iov[iovcnt].iov_len = tx_buffer_len;
+        ++iovcnt;
+    }
+    if (data != NULL && len > 0) {
+        iov[iovcnt].iov_base = (void *)data;
+        iov[iovcnt].iov_len = len;
+        ++iovcnt;
+    }
+    if (iovcnt == 0) {
+        return 1;
+    }
+    res = write_vectors(iov, iovcnt);
+    tx_buffer_len = 0;
+    return res;
+}
+
+/**
+ * \brief           Send data to ESP device, function called from ESP stack when we have data to send
+ *
+ *                  Small writes are collected to TX buffer.
+ *                  Data that do not fit to buffer are written directly
+ *                  together with buffered data, without extra copy
+ *
+ * \param[in]       data: Pointer to data to send. Set to `NULL` to flush buffer
+ * \param[in]       len: Number of bytes to send. Set to `0` to flush buffer
+ * \return          Number of bytes sent
+ */
+static size_t
+send_data(const void* data, size_t len) {
+    if (com_port < 0) {
+        return 0;
+    }
+    if (data == NULL || len == 0) {
+        send_data_flush(NULL, 0);
+        return 0;
+    }
+    if (len > sizeof(tx_buffer) - tx_buffer_len) {
+        return send_data_flush(data, len) ? len : 0;
+    }
+    ESP_MEMCPY(&tx_buffer[tx_buffer_len], data, len);
+    tx_buffer_len += len;
+    return len;
+}
+
+/**
+ * \brief           Get termios speed constant from baudrate
+ * \param[in]       baudrate: Baudrate in units of bits per second
+ * \return          Speed constant or `B0` if not supported
+ */
+static speed_t
+get_speed(uint32_t baudrate) {
+    static const struct {
+        uint32_t baudrate;
+        speed_t speed;
+    } speeds[] = {
+        { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 },
+        { 57600, B57600 }, { 115200, B115200 }, { 230400, B230400 },
+#if defined(B460800)
+        { 460800, B460800 }, { 921600, B921600 }, { 1000000, B1000000 },
+        { 1500000, B1500000 }, { 2000000, B2000000 }, { 3000000, B3000000 },
+        { 4000000, B4000000 },
+#endif /* defined(B460800) */
+    };
+
+    for (size_t i = 0; i < ESP_ARRAYSIZE(speeds); ++i) {
+        if (speeds[i].baudrate == baudrate) {
+            return speeds[i].speed;
+        }
+    }
+    return B0;
+}
+
+/**
+ * \brief           Configure UART (USB to UART)
+ */
+static void
+configure_uart(uint32_t baudrate) {
+    struct termios tio;
+    speed_t speed;
+
+    /* On first call, open serial port and prepare epoll for RX events */
+    if (!initialized) {
+        struct epoll_event ev = { 0 };
+
+        com_port = open(ESP_LL_POSIX_DEV, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (com_port < 0) {
+            printf("Cannot open %s\r\n", ESP_LL_POSIX_DEV);
+            return;
+        }
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        ev.events = EPOLLIN;
+        ev.data.fd = com_port;
+        if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, com_port, &ev) < 0) {
+            printf("Cannot create epoll for serial port\r\n");
+        }
+    }
+    if (com_port < 0) {
+        return;
+    }
+
+    /* Configure serial port parameters: raw mode, 8N1, non-blocking reads */
+    if (tcgetattr(com_port, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+
+        speed = get_speed(baudrate);
+        if (speed == B0) {
+            printf("Unsupported baudrate %u\r\n", (unsigned)baudrate);
+        } else {
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+        }
+        if (tcsetattr(com_port, TCSANOW, &tio) != 0) {
+            printf("Cannot set serial port info\r\n");
+        }
+    } else {
+        printf("Cannot get serial port info\r\n");
+    }
+
+    /* On first function call, create a thread to read data from serial port */
+    if (!initialized) {
+        pthread_create(&thread_handle, NULL, uart_thread, NULL);
+    }
+}
+
+/**
+ * \brief           UART thread
+ *
+ *                  Thread sleeps in epoll until serial port reports received data
+ *                  and then reads all available data
+ */
+static void*
+uart_thread(void* param) {
+    struct epoll_event ev;
+    ssize_t bytes_read;
+
+    ESP_UNUSED(param);
+    while (1) {
+        /* Wait for new data without polling */
+        if (epoll_wait(epoll_fd, &ev, 1, -1) <= 0) {
+            if (errno != EINTR) {
+                usleep(1000);                   /* Delay on error to allow other tasks processing */
+            }
+            continue;
+        }
+
+        /*
+         * Read all data from serial port
+         * and send it to upper layer for processing
+         */
+        do {
+            bytes_read = read(com_port, data_buffer, sizeof(data_buffer));
+            if (bytes_read > 0) {
+                /* Send received data to input processing module */
+#if ESP_CFG_INPUT_USE_PROCESS
+                esp_input_process(data_buffer, (size_t)bytes_read);
+#else /* ESP_CFG_INPUT_USE_PROCESS */
+                esp_input(data_buffer, (size_t)bytes_read);
+#endif /* !ESP_CFG_INPUT_USE_PROCESS */
+            }
+        } while (bytes_read == (ssize_t)sizeof(data_buffer));
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Reset device GPIO management
+ * \note            Reset is available only when \ref ESP_LL_POSIX_RESET_RTS is enabled
+ *                  and ESP reset pin is connected to RTS line
+ */
+static uint8_t
+reset_device(uint8_t state) {
+#if ESP_LL_POSIX_RESET_RTS
+    int flag = TIOCM_RTS;
+
+    /* RTS is active low, asserted line holds ESP in reset */
+    return ioctl(com_port, state ? TIOCMBIS : TIOCMBIC, &flag) == 0;
+#else /* ESP_LL_POSIX_RESET_RTS */
+    ESP_UNUSED(state);
+    return 0;                                   /* Hardware reset was not successful */
+#endif /* !ESP_LL_POSIX_RESET_RTS */
+}
+
+/**
+ * \brief           Callback function called from initialization process
+ *
+ * \note            This function may be called multiple times if AT baudrate is changed from application.
+ *                  It is important that every configuration except AT baudrate is configured only once!
+ *
+ * \note            This function may be called from different threads in ESP stack when using OS.
+ *                  When \ref ESP_CFG_INPUT_USE_PROCESS is set to 1, this function may be called from user UART thread.
+ *
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_init(esp_ll_t* ll) {
+#if !ESP_CFG_MEM_CUSTOM
+    /* Step 1: Configure memory for dynamic allocations */
+    static uint8_t memory[0x10000];             /* Create memory for dynamic allocations with specific size */
+
+    /*
+     * Create memory region(s) of memory.
+     * If device has internal/external memory available,
+     * multiple memories may be used
+     */
+    esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
+        { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
+    };
+    if (!initialized) {
+        esp_mem_assignmemory(mem_regions, ESP_ARRAYSIZE(mem_regions));  /* Assign memory for allocations to ESP library */
+    }
+#endif /* !ESP_CFG_MEM_CUSTOM */
+
+    /* Step 2: Set AT port send function to use when we have data to transmit */
+    if (!initialized) {
+        ll->send_fn = send_data;                /* Set callback function to send data */
+        ll->reset_fn = reset_device;
+    }
+
+    /* Step 3: Configure AT port to be able to send/receive data to/from ESP device */
+    configure_uart(ll->uart.baudrate);          /* Initialize UART for communication */
+    if (com_port < 0) {
+        return espERR;
+    }
+    initialized = 1;
+    return espOK;
+}
+
+/**
+ * \brief           Callback function to de-init low-level communication part
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_deinit(esp_ll_t* ll) {
+    ESP_UNUSED(ll);
+    if (initialized) {
+        pthread_cancel(thread_handle);
+        pthread_join(thread_handle, NULL);
+    }
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    if (com_port >= 0) {
+        close(com_port);
+        com_port = -1;
+    }
+    tx_buffer_len = 0;
+    initialized = 0;                            /* Clear initialized flag */
+    return espOK;
+}
+
+#endif /* !__DOXYGEN__ */
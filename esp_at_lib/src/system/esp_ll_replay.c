@@ -0,0 +1,264 @@
+/**
+ * \file            esp_ll_replay.c
+ * \brief           Low-level replay of captured AT stream
+ */
+
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "system/esp_ll.h"
+#include "system/esp_ll_replay.h"
+#include "system/esp_sys.h"
+#include "esp/esp.h"
+#include "esp/esp_mem.h"
+#include "esp/esp_input.h"
+#include "esp/esp_capture.h"
+
+#if !__DOXYGEN__
+
+static uint8_t initialized = 0;
+static esp_sys_sem_t replay_sem;                /*!< Semaphore released when replay is started */
+static esp_sys_thread_t replay_thread;          /*!< Thread feeding trace to stack */
+
+static const uint8_t* replay_trace;             /*!< Trace to replay */
+static size_t replay_len;                       /*!< Length of trace in units of bytes */
+static uint32_t replay_speed;                   /*!< Replay speed in percent, `0` for no delays */
+static esp_ll_replay_stats_t replay_stats;      /*!< Replay statistics */
+
+/**
+ * \brief           Send data to device
+ *
+ *                  Data are only counted to synchronize received records with stack commands
+ *
+ * \param[in]       data: Data to send
+ * \param[in]       len: Number of bytes to send
+ * \return          Number of bytes sent
+ */
+static size_t
+send_data(const void* data, size_t len) {
+    if (data == NULL || len == 0) {
+        return 0;
+    }
+    esp_core_lock();
+    replay_stats.tx_bytes += len;
+    esp_core_unlock();
+    return len;
+}
+
+/**
+ * \brief           Wait until stack has sent data expected by trace
+ * \return          `1` when stack is in sync, `0` on timeout
+ */
+static uint8_t
+replay_wait_tx(void) {
+    uint32_t start = esp_sys_now();
+    uint8_t sync;
+
+    while (1) {
+        esp_core_lock();
+        sync = replay_stats.tx_bytes >= replay_stats.tx_expected;
+        esp_core_unlock();
+        if (sync) {
+            return 1;
+        }
+        if ((uint32_t)(esp_sys_now() - start) >= ESP_LL_REPLAY_SYNC_TIMEOUT) {
+            return 0;
+        }
+        esp_delay(1);
+    }
+}
+
+/**
+ * \brief           Thread feeding received records of trace to stack
+ * \param[in]       param: Unused parameter
+ */
+static void
+replay_thread_fn(void* param) {
+    const uint8_t* rec;
+    uint32_t rec_time, first_time = 0, start_time = 0, target, now, t;
+    size_t pos, rec_len;
+
+    ESP_UNUSED(param);
+    while (1) {
+        esp_sys_sem_wait(&replay_sem, 0);       /* Wait for start */
+        for (pos = 0; pos + ESP_CAPTURE_HDR_LEN <= replay_len; pos += ESP_CAPTURE_HDR_LEN + rec_len) {
+            rec = &replay_trace[pos];
+            rec_time = (uint32_t)rec[0] | ((uint32_t)rec[1] << 8) | ((uint32_t)rec[2] << 16) | ((uint32_t)rec[3] << 24);
+            rec_len = (size_t)rec[4] | ((size_t)rec[5] << 8);
+            if (pos + ESP_CAPTURE_HDR_LEN + rec_len > replay_len) {
+                break;                          /* Truncated record */
+            }
+            if (pos == 0) {
+                first_time = rec_time;
+                start_time = esp_sys_now();
+            }
+
+            esp_core_lock();
+            ++replay_stats.records;
+            if (rec[6] == ESP_CAPTURE_DIR_TX) {
+                replay_stats.tx_expected += rec_len;
+            }
+            esp_core_unlock();
+            if (rec[6] != ESP_CAPTURE_DIR_RX) {
+                continue;
+            }
+
+            if (!replay_wait_tx()) {
+                esp_core_lock();
+                ++replay_stats.sync_timeouts;
+                esp_core_unlock();
+            }
+            if (replay_speed > 0) {             /* Keep original distance of records */
+                target = start_time + (uint32_t)((uint64_t)(rec_time - first_time) * 100 / replay_speed);
+                now = esp_sys_now();
+                if ((int32_t)(target - now) > 0) {
+                    esp_delay(target - now);
+                }
+            }
+
+            t = esp_sys_now();
+#if ESP_CFG_INPUT_USE_PROCESS
+            esp_input_process(&rec[ESP_CAPTURE_HDR_LEN], rec_len);
+#else /* ESP_CFG_INPUT_USE_PROCESS */
+            esp_input(&rec[ESP_CAPTURE_HDR_LEN], rec_len);
+#endif /* !ESP_CFG_INPUT_USE_PROCESS */
+            t = esp_sys_now() - t;
+
+            esp_core_lock();
+            replay_stats.rx_bytes += rec_len;
+            replay_stats.process_time += t;
+            esp_core_unlock();
+        }
+        esp_core_lock();
+        replay_stats.done = 1;
+        esp_core_unlock();
+    }
+}
+
+/**
+ * \brief           Callback function called from initialization process
+ *
+ * \note            This function may be called multiple times if AT baudrate is changed from application.
+ *                  It is important that every configuration except AT baudrate is configured only once!
+ *
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_init(esp_ll_t* ll) {
+#if !ESP_CFG_MEM_CUSTOM
+    /* Step 1: Configure memory for dynamic allocations */
+    static uint8_t memory[0x10000];             /* Create memory for dynamic allocations with specific size */
+
+    esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
+        { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
+    };
+    if (!initialized) {
+        esp_mem_assignmemory(mem_regions, ESP_ARRAYSIZE(mem_regions));  /* Assign memory for allocations to ESP library */
+    }
+#endif /* !ESP_CFG_MEM_CUSTOM */
+
+    /* Step 2: Set AT port send function and start replay thread */
+    if (!initialized) {
+        ll->send_fn = send_data;                /* Set callback function to send data */
+        if (!esp_sys_sem_create(&replay_sem, 0)
+            || !esp_sys_thread_create(&replay_thread, "esp_ll_replay", replay_thread_fn, NULL, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+            return espERRMEM;
+        }
+    }
+    initialized = 1;
+    return espOK;
+}
+
+/**
+ * \brief           Callback function to de-init low-level communication part
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_deinit(esp_ll_t* ll) {
+    ESP_UNUSED(ll);
+    initialized = 0;                            /* Clear initialized flag */
+    return espOK;
+}
+
+#endif /* !__DOXYGEN__ */
+
+/**
+ * \brief           Start feeding captured trace to stack
+ *
+ * Counting of sent bytes starts from stack initialization,
+ * start replay right after \ref esp_init to replay trace captured from the beginning
+ *
+ * \param[in]       trace: Records in \ref ESP_CAPTURE format. Memory must stay valid until replay is done
+ * \param[in]       len: Length of trace in units of bytes
+ * \param[in]       speed: Replay speed in percent of original speed, `100` for original timing.
+ *                      Set to `0` to feed records without delays
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_replay_start(const void* trace, size_t len, uint32_t speed) {
+    size_t tx_bytes;
+
+    ESP_ASSERT("trace != NULL", trace != NULL);
+    ESP_ASSERT("len > 0", len > 0);
+
+    if (!initialized) {
+        return espERR;
+    }
+    esp_core_lock();
+    if (replay_trace != NULL && !replay_stats.done) {
+        esp_core_unlock();
+        return espINPROG;                       /* Previous replay still running */
+    }
+    tx_bytes = replay_stats.tx_bytes;
+    ESP_MEMSET(&replay_stats, 0x00, sizeof(replay_stats));
+    replay_stats.tx_bytes = tx_bytes;          /* Stack output is counted since initialization */
+    replay_trace = trace;
+    replay_len = len;
+    replay_speed = speed;
+    esp_core_unlock();
+    esp_sys_sem_release(&replay_sem);
+    return espOK;
+}
+
+/**
+ * \brief           Get replay statistics
+ * \param[out]      stats: Output variable to save statistics to
+ */
+void
+esp_ll_replay_get_stats(esp_ll_replay_stats_t* stats) {
+    esp_core_lock();
+    ESP_MEMCPY(stats, &replay_stats, sizeof(*stats));
+    esp_core_unlock();
+}
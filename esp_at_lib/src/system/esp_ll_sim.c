@@ -0,0 +1,632 @@
+/**
+ * \file            esp_ll_sim.c
+ * \brief           Low-level communication with simulated ESP device
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include <stdlib.h>
+#include "system/esp_ll.h"
+#include "system/esp_ll_sim.h"
+#include "system/esp_sys.h"
+#include "esp/esp.h"
+#include "esp/esp_mem.h"
+#include "esp/esp_input.h"
+#include "esp/esp_buff.h"
+#include "esp/esp_private.h"
+
+#if !__DOXYGEN__
+
+#if ESP_CFG_CONN_MANUAL_TCP_RECEIVE
+#error "Simulated device does not support ESP_CFG_CONN_MANUAL_TCP_RECEIVE"
+#endif /* ESP_CFG_CONN_MANUAL_TCP_RECEIVE */
+
+/* Remote side of simulated connections */
+#define SIM_REMOTE_IP                   "192.168.0.100"
+#define SIM_REMOTE_PORT                 80
+
+/* Local port of first client connection, connection number is added */
+#define SIM_LOCAL_PORT                  50000
+
+/* Length of record header in peer queue: connection number and data length */
+#define SIM_PEER_HDR_LEN                3
+
+/* Write constant string to stack input */
+#define SIM_OUT_CONST_STR(str)          sim_out((str), sizeof(str) - 1)
+
+static uint8_t initialized = 0;
+static esp_buff_t sim_out_buff;                 /*!< Data from simulated device waiting for stack */
+static esp_sys_sem_t sim_sem;                   /*!< Semaphore released when new data are written for stack */
+static esp_sys_thread_t sim_thread;             /*!< Thread passing device data to stack */
+
+static char sim_cmd[0x100];                     /*!< Currently received command line */
+static size_t sim_cmd_len;                      /*!< Length of received command line */
+static size_t sim_data_rem;                     /*!< Number of remaining `AT+CIPSEND` data bytes */
+static size_t sim_data_len;                     /*!< Length of current `AT+CIPSEND` data */
+static uint8_t sim_data_conn;                   /*!< Connection number of current `AT+CIPSEND` data */
+static uint8_t sim_data[ESP_CFG_CONN_MAX_DATA_LEN]; /*!< Current `AT+CIPSEND` data, collected for remote peer */
+static uint8_t sim_conn_active[ESP_CFG_MAX_CONNS];  /*!< Status of simulated connections */
+static uint8_t sim_mux = 1;                     /*!< Multiple connections mode, set with `AT+CIPMUX` */
+
+static esp_ll_sim_peer_fn sim_peer_fn;          /*!< Remote peer callback, `NULL` if not used */
+static esp_buff_t sim_peer_buff;                /*!< Records waiting for remote peer */
+static esp_sys_sem_t sim_peer_sem;              /*!< Semaphore released when new record is written for peer */
+static esp_sys_thread_t sim_peer_thread;        /*!< Thread calling remote peer callback */
+
+static uint32_t sim_baudrate;                   /*!< Emulated wire speed in bits per second, `0` for no delay */
+static uint32_t sim_latency;                    /*!< Device response latency in units of milliseconds */
+static esp_ll_sim_stats_t sim_stats;            /*!< Simulated device statistics */
+
+/**
+ * \brief           Write data from simulated device for stack
+ * \note            Core lock must be active when calling this function
+ * \param[in]       data: Data to write
+ * \param[in]       len: Length of data in units of bytes
+ * \return          `1` on success, `0` if there is no space in buffer
+ */
+static uint8_t
+sim_out(const void* data, size_t len) {
+    if (esp_buff_get_free(&sim_out_buff) < len) {
+        return 0;
+    }
+    esp_buff_write(&sim_out_buff, data, len);
+    esp_sys_sem_release(&sim_sem);
+    return 1;
+}
+
+/**
+ * \brief           Write connection event line, such as `0,CLOSED`
+ * \param[in]       conn: Connection number
+ * \param[in]       str: Event text with leading comma
+ */
+static void
+sim_out_conn_evt(uint8_t conn, const char* str) {
+    char num[11];
+
+    esp_u32_to_str(conn, num);
+    sim_out(num, strlen(num));
+    sim_out(str, strlen(str));
+}
+
+/**
+ * \brief           Write connection close line, `0,CLOSED` or `CLOSED` in single connection mode
+ * \param[in]       conn: Connection number
+ */
+static void
+sim_out_closed(uint8_t conn) {
+    if (sim_mux) {
+        sim_out_conn_evt(conn, ",CLOSED\r\n");
+    } else {
+        SIM_OUT_CONST_STR("CLOSED\r\n");
+    }
+}
+
+/**
+ * \brief           Write `+LINK_CONN` line for new connection
+ * \note            Device reports it instead of `0,CONNECT` line once system messages are enabled
+ * \note            Core lock must be active when calling this function
+ * \param[in]       conn: Connection number
+ * \param[in]       is_server: Set to `1` if connection was started by remote side
+ * \param[in]       remote_port: Port on remote side
+ * \param[in]       local_port: Port on device side
+ */
+static void
+sim_out_link_conn(uint8_t conn, uint8_t is_server, uint32_t remote_port, uint32_t local_port) {
+    char num[11];
+
+    SIM_OUT_CONST_STR("+LINK_CONN:0,");
+    esp_u32_to_str(conn, num);
+    sim_out(num, strlen(num));
+    if (is_server) {
+        SIM_OUT_CONST_STR(",\"TCP\",1,\"" SIM_REMOTE_IP "\",");
+    } else {
+        SIM_OUT_CONST_STR(",\"TCP\",0,\"" SIM_REMOTE_IP "\",");
+    }
+    esp_u32_to_str(remote_port, num);
+    sim_out(num, strlen(num));
+    SIM_OUT_CONST_STR(",");
+    esp_u32_to_str(local_port, num);
+    sim_out(num, strlen(num));
+    SIM_OUT_CONST_STR("\r\n");
+}
+
+/**
+ * \brief           Write record for remote peer
+ * \note            Core lock must be active when calling this function
+ * \param[in]       conn: Connection number
+ * \param[in]       data: Data sent by stack, `NULL` when connection was closed by stack
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+sim_peer_write(uint8_t conn, const void* data, size_t len) {
+    uint8_t hdr[SIM_PEER_HDR_LEN];
+
+    if (sim_peer_fn == NULL) {
+        return;
+    }
+    if (esp_buff_get_free(&sim_peer_buff) < sizeof(hdr) + len) {
+        ++sim_stats.peer_drop_cnt;              /* Peer is too slow */
+        return;
+    }
+    hdr[0] = conn;
+    hdr[1] = (uint8_t)len;
+    hdr[2] = (uint8_t)(len >> 8);
+    esp_buff_write(&sim_peer_buff, hdr, sizeof(hdr));
+    if (len > 0) {
+        esp_buff_write(&sim_peer_buff, data, len);
+    }
+    esp_sys_sem_release(&sim_peer_sem);
+}
+
+/**
+ * \brief           Find number after first occurrence of character
+ * \param[in]       str: String to search in
+ * \param[in]       ch: Character after which number is located
+ * \return          Parsed number, `0` if not found
+ */
+static uint32_t
+sim_num_after(const char* str, char ch) {
+    const char* s = strchr(str, ch);
+    return s != NULL ? (uint32_t)strtoul(s + 1, NULL, 10) : 0;
+}
+
+/**
+ * \brief           Process complete command line received by simulated device
+ */
+static void
+sim_process_cmd(void) {
+    const char* c = sim_cmd;
+    uint32_t n;
+
+    ++sim_stats.cmd_cnt;
+    if (!strncmp(c, "AT+RST", 6) || !strncmp(c, "AT+RESTORE", 10)) {
+        ESP_MEMSET(sim_conn_active, 0x00, sizeof(sim_conn_active));
+        SIM_OUT_CONST_STR("\r\nOK\r\n");
+        SIM_OUT_CONST_STR("ready\r\n");
+    } else if (!strncmp(c, "AT+GMR", 6)) {
+        SIM_OUT_CONST_STR("AT version:2.1.0.0(sim)\r\nSDK version:v3.2.0(sim)\r\n\r\nOK\r\n");
+    } else if (!strncmp(c, "AT+CWJAP=", 9)) {
+        SIM_OUT_CONST_STR("WIFI CONNECTED\r\nWIFI GOT IP\r\n\r\nOK\r\n");
+    } else if (!strncmp(c, "AT+BLEINIT", 10)) {
+        SIM_OUT_CONST_STR("\r\nERROR\r\n");     /* Behave as ESP8266 */
+    } else if (!strncmp(c, "AT+CIPMUX=", 10)) {
+        sim_mux = (uint8_t)sim_num_after(c, '=');
+        SIM_OUT_CONST_STR("\r\nOK\r\n");
+    } else if (!strncmp(c, "AT+CIPSTART=", 12)) {
+        n = sim_mux ? sim_num_after(c, '=') : 0;
+        if (n < ESP_CFG_MAX_CONNS && !sim_conn_active[n]) {
+            const char* s = strrchr(c, '"');    /* Remote port follows host */
+
+            sim_conn_active[n] = 1;
+            sim_out_link_conn(n, 0, s != NULL ? sim_num_after(s, ',') : SIM_REMOTE_PORT, SIM_LOCAL_PORT + n);
+            SIM_OUT_CONST_STR("\r\nOK\r\n");
+        } else {
+            SIM_OUT_CONST_STR("ALREADY CONNECTED\r\n\r\nERROR\r\n");
+        }
+    } else if (!strncmp(c, "AT+CIPCLOSE", 11)) {
+        n = sim_mux ? sim_num_after(c, '=') : 0;
+        if (n == ESP_CFG_MAX_CONNS) {           /* Close all connections, reported only with OK */
+            for (size_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {
+                if (sim_conn_active[i]) {
+                    sim_conn_active[i] = 0;
+                    sim_peer_write((uint8_t)i, NULL, 0);
+                }
+            }
+            SIM_OUT_CONST_STR("\r\nOK\r\n");
+        } else if (n < ESP_CFG_MAX_CONNS && sim_conn_active[n]) {
+            sim_conn_active[n] = 0;
+            sim_peer_write(n, NULL, 0);
+            sim_out_closed(n);
+            SIM_OUT_CONST_STR("\r\nOK\r\n");
+        } else {
+            SIM_OUT_CONST_STR("\r\nERROR\r\n");
+        }
+    } else if (!strncmp(c, "AT+CIPSEND=", 11)) {
+        if (sim_mux) {
+            n = sim_num_after(c, '=');
+            sim_data_len = sim_num_after(c, ',');
+        } else {
+            n = 0;
+            sim_data_len = sim_num_after(c, '=');
+        }
+        if (n < ESP_CFG_MAX_CONNS && sim_conn_active[n] && sim_data_len > 0 && sim_data_len <= sizeof(sim_data)) {
+            sim_data_conn = (uint8_t)n;
+            sim_data_rem = sim_data_len;
+            SIM_OUT_CONST_STR("\r\nOK\r\n> ");
+        } else {
+            SIM_OUT_CONST_STR("link is not valid\r\n\r\nERROR\r\n");
+        }
+    } else if (!strncmp(c, "AT+CIPSTATUS", 12)) {
+        SIM_OUT_CONST_STR("STATUS:3\r\n");
+        for (size_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {
+            if (sim_conn_active[i]) {
+                SIM_OUT_CONST_STR("+CIPSTATUS:");
+                sim_out_conn_evt(i, ",\"TCP\",\"" SIM_REMOTE_IP "\",80,1024,0\r\n");
+            }
+        }
+        SIM_OUT_CONST_STR("\r\nOK\r\n");
+    } else {
+        SIM_OUT_CONST_STR("\r\nOK\r\n");        /* Accept all other commands */
+    }
+}
+
+/**
+ * \brief           Receive data from stack, function called from ESP stack when we have data to send
+ * \param[in]       data: Pointer to data to send
+ * \param[in]       len: Number of bytes to send
+ * \return          Number of bytes sent
+ */
+static size_t
+send_data(const void* data, size_t len) {
+    const char* d = data;
+    size_t to_skip;
+
+    if (data == NULL || len == 0) {
+        return 0;
+    }
+    esp_core_lock();
+    sim_stats.bytes_to_device += len;
+    while (len > 0) {
+        if (sim_data_rem > 0) {                 /* Network data after AT+CIPSEND */
+            to_skip = ESP_MIN(len, sim_data_rem);
+            if (sim_peer_fn != NULL) {
+                ESP_MEMCPY(&sim_data[sim_data_len - sim_data_rem], d, to_skip);
+            }
+            sim_data_rem -= to_skip;
+            d += to_skip;
+            len -= to_skip;
+            if (sim_data_rem == 0) {
+                char num[11];
+
+                ++sim_stats.send_cnt;
+                sim_stats.send_bytes += sim_data_len;
+                sim_peer_write(sim_data_conn, sim_data, sim_data_len);
+                esp_u32_to_str(sim_data_len, num);
+                SIM_OUT_CONST_STR("\r\nRecv ");
+                sim_out(num, strlen(num));
+                SIM_OUT_CONST_STR(" bytes\r\n\r\nSEND OK\r\n");
+            }
+            continue;
+        }
+        if (*d == '\n') {                       /* End of command */
+            if (sim_cmd_len > 0 && sim_cmd[sim_cmd_len - 1] == '\r') {
+                --sim_cmd_len;
+            }
+            sim_cmd[sim_cmd_len] = 0;
+            if (sim_cmd_len > 0) {
+                sim_process_cmd();
+            }
+            sim_cmd_len = 0;
+        } else if (sim_cmd_len < sizeof(sim_cmd) - 1) {
+            sim_cmd[sim_cmd_len++] = *d;
+        }
+        ++d;
+        --len;
+    }
+    esp_core_unlock();
+    return (size_t)(d - (const char *)data);
+}
+
+/**
+ * \brief           Thread passing simulated device output to stack
+ *
+ *                  Response latency is applied once per burst of data,
+ *                  wire speed is emulated from configured baudrate
+ */
+static void
+sim_thread_fn(void* param) {
+    uint8_t chunk[0x40];
+    uint32_t wire_us = 0;
+    size_t len;
+
+    ESP_UNUSED(param);
+    while (1) {
+        esp_sys_sem_wait(&sim_sem, 0);          /* Wait for new data */
+        if (sim_latency > 0) {
+            esp_delay(sim_latency);
+        }
+        while (1) {
+            esp_core_lock();
+            len = esp_buff_read(&sim_out_buff, chunk, sizeof(chunk));
+            sim_stats.bytes_from_device += len;
+            esp_core_unlock();
+            if (len == 0) {
+                break;
+            }
+            if (sim_baudrate > 0) {             /* 10 bits per byte on wire */
+                wire_us += (uint32_t)(((uint64_t)len * 10 * 1000000) / sim_baudrate);
+                if (wire_us >= 1000) {
+                    esp_delay(wire_us / 1000);
+                    wire_us %= 1000;
+                }
+            }
+#if ESP_CFG_INPUT_USE_PROCESS
+            esp_input_process(chunk, len);
+#else /* ESP_CFG_INPUT_USE_PROCESS */
+            while (esp_buff_get_free(&esp.buff) < len) {
+                esp_delay(1);                   /* Emulate hardware flow control, input buffer must not overflow */
+            }
+            esp_input(chunk, len);
+#endif /* !ESP_CFG_INPUT_USE_PROCESS */
+        }
+    }
+}
+
+/**
+ * \brief           Thread calling remote peer with data sent by stack
+ *
+ *                  Callback runs without core lock, so that it may inject response data
+ */
+static void
+sim_peer_thread_fn(void* param) {
+    static uint8_t data[ESP_CFG_CONN_MAX_DATA_LEN];
+    uint8_t hdr[SIM_PEER_HDR_LEN];
+    esp_ll_sim_peer_fn fn;
+    size_t len;
+
+    ESP_UNUSED(param);
+    while (1) {
+        esp_sys_sem_wait(&sim_peer_sem, 0);     /* Wait for new record */
+        while (1) {
+            esp_core_lock();
+            if (esp_buff_read(&sim_peer_buff, hdr, sizeof(hdr)) != sizeof(hdr)) {
+                esp_core_unlock();
+                break;
+            }
+            len = (size_t)hdr[1] | ((size_t)hdr[2] << 8);
+            esp_buff_read(&sim_peer_buff, data, len);
+            fn = sim_peer_fn;
+            esp_core_unlock();
+            if (fn != NULL) {
+                fn(hdr[0], len > 0 ? data : NULL, len);
+            }
+        }
+    }
+}
+
+/**
+ * \brief           Callback function called from initialization process
+ *
+ * \note            This function may be called multiple times if AT baudrate is changed from application.
+ *                  It is important that every configuration except AT baudrate is configured only once!
+ *
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_init(esp_ll_t* ll) {
+#if !ESP_CFG_MEM_CUSTOM
+    /* Step 1: Configure memory for dynamic allocations */
+    static uint8_t memory[0x10000];             /* Create memory for dynamic allocations with specific size */
+
+    esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
+        { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
+    };
+    if (!initialized) {
+        esp_mem_assignmemory(mem_regions, ESP_ARRAYSIZE(mem_regions));  /* Assign memory for allocations to ESP library */
+    }
+#endif /* !ESP_CFG_MEM_CUSTOM */
+
+    /* Step 2: Set AT port send function and start simulated device */
+    if (!initialized) {
+        ll->send_fn = send_data;                /* Set callback function to send data */
+        if (!esp_buff_init(&sim_out_buff, 0x2000)
+            || !esp_buff_init(&sim_peer_buff, 4 * (ESP_CFG_CONN_MAX_DATA_LEN + SIM_PEER_HDR_LEN))
+            || !esp_sys_sem_create(&sim_sem, 0)
+            || !esp_sys_sem_create(&sim_peer_sem, 0)
+            || !esp_sys_thread_create(&sim_thread, "esp_ll_sim", sim_thread_fn, NULL, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)
+            || !esp_sys_thread_create(&sim_peer_thread, "esp_ll_sim_peer", sim_peer_thread_fn, NULL, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+            return espERRMEM;
+        }
+    }
+    initialized = 1;
+    return espOK;
+}
+
+/**
+ * \brief           Callback function to de-init low-level communication part
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_deinit(esp_ll_t* ll) {
+    ESP_UNUSED(ll);
+    initialized = 0;                            /* Clear initialized flag */
+    return espOK;
+}
+
+#endif /* !__DOXYGEN__ */
+
+/**
+ * \brief           Set timing of simulated device
+ * \param[in]       baudrate: Emulated wire speed in bits per second. Set to `0` to send data without delay
+ * \param[in]       latency: Delay before device starts responding, in units of milliseconds
+ */
+void
+esp_ll_sim_set_timing(uint32_t baudrate, uint32_t latency) {
+    esp_core_lock();
+    sim_baudrate = baudrate;
+    sim_latency = latency;
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Send raw data from simulated device to stack
+ * \note            Function waits until there is enough space in device output buffer
+ * \param[in]       data: Data to send, such as unsolicited message lines
+ * \param[in]       len: Length of data in units of bytes
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_sim_inject(const void* data, size_t len) {
+    if (!initialized) {
+        return espERR;
+    }
+    while (1) {
+        esp_core_lock();
+        if (len > sim_out_buff.size - 1) {
+            esp_core_unlock();
+            return espERRMEM;                   /* Data never fit buffer */
+        }
+        if (sim_out(data, len)) {
+            esp_core_unlock();
+            return espOK;
+        }
+        esp_core_unlock();
+        esp_delay(1);                           /* Wait for stack to process data */
+    }
+}
+
+/**
+ * \brief           Send network data packet from simulated device to stack
+ * \note            Data are sent as `+IPD` with remote IP and port, as enabled with `AT+CIPDINFO=1`
+ * \param[in]       conn: Connection number. Connection must be active
+ * \param[in]       data: Packet data
+ * \param[in]       len: Length of packet in units of bytes
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_sim_inject_ipd(uint8_t conn, const void* data, size_t len) {
+    char hdr[48], num[11];
+    size_t hdr_len;
+
+    if (conn >= ESP_CFG_MAX_CONNS || !sim_conn_active[conn] || len == 0) {
+        return espPARERR;
+    }
+
+    /* Build header "\r\n+IPD,conn,len,ip,port:", as device starts it on new line */
+    strcpy(hdr, "\r\n+IPD,");
+    if (sim_mux) {                              /* Link ID is omitted in single connection mode */
+        esp_u32_to_str(conn, num);
+        strcat(hdr, num);
+        strcat(hdr, ",");
+    }
+    esp_u32_to_str(len, num);
+    strcat(hdr, num);
+    strcat(hdr, "," SIM_REMOTE_IP ",");
+    esp_u32_to_str(SIM_REMOTE_PORT, num);
+    strcat(hdr, num);
+    strcat(hdr, ":");
+    hdr_len = strlen(hdr);
+
+    /*
+     * Packet must be written at once, it may be injected from multiple threads.
+     * No memory is allocated, to not affect memory statistics of the stack
+     */
+    while (1) {
+        esp_core_lock();
+        if (hdr_len + len > sim_out_buff.size - 1) {
+            esp_core_unlock();
+            return espERRMEM;                   /* Packet never fits buffer */
+        }
+        if (esp_buff_get_free(&sim_out_buff) >= hdr_len + len) {
+            sim_out(hdr, hdr_len);
+            sim_out(data, len);
+            esp_core_unlock();
+            return espOK;
+        }
+        esp_core_unlock();
+        esp_delay(1);                           /* Wait for stack to process data */
+    }
+}
+
+/**
+ * \brief           Set remote peer of simulated connections
+ *
+ *                  Peer receives data stack sent with `AT+CIPSEND` and close events,
+ *                  and may answer with \ref esp_ll_sim_inject_ipd from callback
+ *
+ * \param[in]       fn: Peer callback function, set to `NULL` to disable
+ */
+void
+esp_ll_sim_set_peer(esp_ll_sim_peer_fn fn) {
+    esp_core_lock();
+    sim_peer_fn = fn;
+    esp_core_unlock();
+}
+
+/**
+ * \brief           Open connection from remote side, as client connecting to device server
+ * \param[in]       conn: Connection number. Connection must not be active
+ * \param[in]       local_port: Server port on device side
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_sim_accept(uint8_t conn, esp_port_t local_port) {
+    if (!initialized) {
+        return espERR;
+    }
+    esp_core_lock();
+    if (conn >= ESP_CFG_MAX_CONNS || sim_conn_active[conn]
+        || esp_buff_get_free(&sim_out_buff) < 64) {
+        esp_core_unlock();
+        return espERR;
+    }
+    sim_conn_active[conn] = 1;
+    sim_out_link_conn(conn, 1, SIM_LOCAL_PORT + conn, local_port);
+    esp_core_unlock();
+    return espOK;
+}
+
+/**
+ * \brief           Close connection from remote side
+ * \param[in]       conn: Connection number
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_sim_close(uint8_t conn) {
+    char line[16];
+
+    if (conn >= ESP_CFG_MAX_CONNS || !sim_conn_active[conn]) {
+        return espPARERR;
+    }
+    sim_conn_active[conn] = 0;
+    if (sim_mux) {
+        esp_u32_to_str(conn, line);
+        strcat(line, ",CLOSED\r\n");
+    } else {
+        strcpy(line, "CLOSED\r\n");
+    }
+    return esp_ll_sim_inject(line, strlen(line));
+}
+
+/**
+ * \brief           Get simulated device statistics
+ * \param[out]      stats: Output variable to save statistics to
+ */
+void
+esp_ll_sim_get_stats(esp_ll_sim_stats_t* stats) {
+    esp_core_lock();
+    ESP_MEMCPY(stats, &sim_stats, sizeof(*stats));
+    esp_core_unlock();
+}
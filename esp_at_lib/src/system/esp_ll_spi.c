@@ -0,0 +1,380 @@
+/**
+ * \file            esp_ll_spi.c
+ * \brief           Low-level communication with ESP device over SPI
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+
+/*
+ * Transport for ESP32 SPI AT firmware, using half-duplex SPI slave protocol.
+ *
+ * Every transaction starts with command and address byte, followed by 8 dummy bits.
+ * Device activates handshake GPIO when it has data for host or when it is ready
+ * to receive data from host. Host then reads status register to find out which one.
+ *
+ * Data are exchanged in complete frames with DMA, without any per-byte processing
+ * and without interrupt per character as with UART.
+ */
+#include "system/esp_ll.h"
+#include "system/esp_ll_spi.h"
+#include "system/esp_sys.h"
+#include "esp/esp.h"
+#include "esp/esp_mem.h"
+#include "esp/esp_input.h"
+#include "esp/esp_buff.h"
+
+#if !__DOXYGEN__
+
+#if !ESP_CFG_OS
+#error "SPI low-level driver requires ESP_CFG_OS enabled"
+#endif /* !ESP_CFG_OS */
+
+/* Maximal length of single data frame, limited by device DMA buffer */
+#if !defined(ESP_LL_SPI_MAX_FRAME_LEN)
+#define ESP_LL_SPI_MAX_FRAME_LEN        4092
+#endif /* !defined(ESP_LL_SPI_MAX_FRAME_LEN) */
+
+/* Size of buffer for received data waiting for processing */
+#if !defined(ESP_LL_SPI_RX_BUFF_SIZE)
+#define ESP_LL_SPI_RX_BUFF_SIZE         0x4000
+#endif /* !defined(ESP_LL_SPI_RX_BUFF_SIZE) */
+
+/* Time in milliseconds device has to accept frame from host */
+#if !defined(ESP_LL_SPI_TX_TIMEOUT)
+#define ESP_LL_SPI_TX_TIMEOUT           1000
+#endif /* !defined(ESP_LL_SPI_TX_TIMEOUT) */
+
+/* Commands of half-duplex SPI slave */
+#define SPI_CMD_WRBUF                   0x01    /* Write shared register */
+#define SPI_CMD_RDBUF                   0x02    /* Read shared register */
+#define SPI_CMD_WRDMA                   0x03    /* Write data with DMA */
+#define SPI_CMD_RDDMA                   0x04    /* Read data with DMA */
+#define SPI_CMD_WR_END                  0x07    /* End of DMA write */
+#define SPI_CMD_INT0                    0x08    /* End of DMA read */
+
+/* Shared register addresses */
+#define SPI_ADDR_SEND_REQ               0x00    /* Host send request */
+#define SPI_ADDR_STATUS                 0x04    /* Device status */
+
+/* Transfer direction in device status */
+#define SPI_DIRECT_READ                 0x01    /* Device has data for host */
+#define SPI_DIRECT_WRITE                0x02    /* Device is ready to receive data */
+
+/* Magic value of host send request */
+#define SPI_SEND_REQ_MAGIC              0xFE
+
+static uint8_t initialized = 0;
+static esp_sys_thread_t spi_thread;             /*!< Thread handling handshake and bus transfers */
+static esp_sys_mutex_t spi_mutex;               /*!< Mutex protecting bus and TX state */
+static esp_sys_sem_t spi_tx_sem;                /*!< Semaphore released when device accepted TX frame */
+static esp_ll_spi_stats_t spi_stats;            /*!< Transport statistics */
+
+static uint8_t spi_tx_frame[ESP_LL_SPI_MAX_FRAME_LEN];  /*!< Frame being prepared by stack */
+static size_t spi_tx_len;                       /*!< Number of bytes in TX frame */
+static uint8_t spi_tx_seq;                      /*!< Sequence number of host send requests */
+static uint8_t spi_tx_pending;                  /*!< Set to `1` when TX frame waits for device */
+
+#if ESP_CFG_INPUT_USE_PROCESS
+static esp_buff_t spi_rx_buff;                  /*!< Received data waiting for processing thread */
+static esp_sys_sem_t spi_rx_sem;                /*!< Semaphore released when new data are received */
+static esp_sys_sem_t spi_rx_free_sem;           /*!< Semaphore released when data were processed */
+static esp_sys_thread_t spi_input_thread;       /*!< Thread passing received data to stack */
+#endif /* ESP_CFG_INPUT_USE_PROCESS */
+static uint8_t spi_rx_frame[ESP_LL_SPI_MAX_FRAME_LEN];  /*!< Frame received from device */
+
+/**
+ * \brief           Send frame prepared by stack and wait until device accepts it
+ * \note            Frame is sent from SPI thread when device activates handshake line
+ * \return          `1` on success, `0` on timeout
+ */
+static uint8_t
+spi_tx_flush(void) {
+    uint8_t req[4];
+
+    if (spi_tx_len == 0) {
+        return 1;
+    }
+
+    esp_sys_mutex_lock(&spi_mutex);
+    req[0] = SPI_SEND_REQ_MAGIC;
+    req[1] = spi_tx_seq++;
+    req[2] = ESP_U8(spi_tx_len);
+    req[3] = ESP_U8(spi_tx_len >> 8);
+    spi_tx_pending = 1;
+    esp_ll_spi_board_transfer(SPI_CMD_WRBUF, SPI_ADDR_SEND_REQ, req, NULL, sizeof(req));
+    esp_sys_mutex_unlock(&spi_mutex);
+
+    if (esp_sys_sem_wait(&spi_tx_sem, ESP_LL_SPI_TX_TIMEOUT) == ESP_SYS_TIMEOUT) {
+        uint8_t done;
+
+        esp_sys_mutex_lock(&spi_mutex);
+        done = !spi_tx_pending;
+        spi_tx_pending = 0;
+        esp_sys_mutex_unlock(&spi_mutex);
+        if (done) {                             /* Frame was sent just after timeout */
+            esp_sys_sem_wait(&spi_tx_sem, 0);
+        } else {
+            ++spi_stats.tx_errors;
+            spi_tx_len = 0;
+            return 0;
+        }
+    }
+    spi_tx_len = 0;
+    return 1;
+}
+
+/**
+ * \brief           Send data to ESP device, function called from ESP stack when we have data to send
+ * \note            Data are collected to frame, which is sent when full or on flush request
+ * \param[in]       data: Pointer to data to send or `NULL` to flush frame
+ * \param[in]       len: Number of bytes to send or `0` to flush frame
+ * \return          Number of bytes sent
+ */
+static size_t
+send_data(const void* data, size_t len) {
+    const uint8_t* d = data;
+    size_t to_copy, sent = 0;
+
+    if (data == NULL || len == 0) {
+        spi_tx_flush();
+        return 0;
+    }
+    while (len > 0) {
+        to_copy = ESP_MIN(len, sizeof(spi_tx_frame) - spi_tx_len);
+        ESP_MEMCPY(&spi_tx_frame[spi_tx_len], d, to_copy);
+        spi_tx_len += to_copy;
+        d += to_copy;
+        len -= to_copy;
+        if (spi_tx_len == sizeof(spi_tx_frame) && !spi_tx_flush()) {
+            break;                              /* Device does not accept data */
+        }
+        sent += to_copy;
+    }
+    return sent;
+}
+
+/**
+ * \brief           Pass received frame to stack
+ * \param[in]       rx: Frame data, `NULL` if data were received directly to RX buffer
+ * \param[in]       len: Length of frame in units of bytes
+ */
+static void
+spi_rx_deliver(const void* rx, size_t len) {
+    spi_stats.rx_bytes += len;
+    ++spi_stats.rx_frames;
+#if ESP_CFG_INPUT_USE_PROCESS
+    if (rx == NULL) {
+        esp_buff_write_commit(&spi_rx_buff, len);
+    } else {
+        esp_buff_write(&spi_rx_buff, rx, len);
+    }
+    esp_sys_sem_release(&spi_rx_sem);
+#else /* ESP_CFG_INPUT_USE_PROCESS */
+    esp_input(rx, len);
+#endif /* !ESP_CFG_INPUT_USE_PROCESS */
+}
+
+/**
+ * \brief           Read frame announced by device
+ * \note            Bus mutex must be locked when calling this function
+ * \param[in]       len: Length of frame in units of bytes
+ */
+static void
+spi_rx_frame_read(size_t len) {
+#if ESP_CFG_INPUT_USE_PROCESS
+    size_t lin_len;
+    void* addr;
+
+    /*
+     * Wait for stack to make space for complete frame.
+     * Device does not accept host data until frame is read,
+     * pending TX eventually times out if stack is blocked meanwhile
+     */
+    while (esp_buff_get_free(&spi_rx_buff) < len) {
+        esp_sys_mutex_unlock(&spi_mutex);
+        esp_sys_sem_wait(&spi_rx_free_sem, 10);
+        esp_sys_mutex_lock(&spi_mutex);
+    }
+
+    /* Receive directly to buffer if there is enough linear memory */
+    lin_len = len;
+    addr = esp_buff_write_reserve(&spi_rx_buff, &lin_len);
+    if (addr != NULL && lin_len == len) {
+        if (esp_ll_spi_board_transfer(SPI_CMD_RDDMA, 0, NULL, addr, len)) {
+            esp_ll_spi_board_transfer(SPI_CMD_INT0, 0, NULL, NULL, 0);
+            spi_rx_deliver(NULL, len);
+        }
+        return;
+    }
+#endif /* ESP_CFG_INPUT_USE_PROCESS */
+    if (esp_ll_spi_board_transfer(SPI_CMD_RDDMA, 0, NULL, spi_rx_frame, len)) {
+        esp_ll_spi_board_transfer(SPI_CMD_INT0, 0, NULL, NULL, 0);
+        spi_rx_deliver(spi_rx_frame, len);
+    }
+}
+
+/**
+ * \brief           Thread handling device handshake requests
+ * \note            Thread never locks core, stack may wait for TX frame with core locked
+ */
+static void
+spi_thread_fn(void* param) {
+    uint8_t status[4];
+    size_t len;
+
+    ESP_UNUSED(param);
+    while (1) {
+        esp_ll_spi_board_wait_handshake();
+
+        esp_sys_mutex_lock(&spi_mutex);
+        if (!esp_ll_spi_board_transfer(SPI_CMD_RDBUF, SPI_ADDR_STATUS, NULL, status, sizeof(status))) {
+            esp_sys_mutex_unlock(&spi_mutex);
+            continue;
+        }
+        len = (size_t)status[2] | ((size_t)status[3] << 8);
+        if (status[0] == SPI_DIRECT_READ) {
+            if (len > 0 && len <= ESP_LL_SPI_MAX_FRAME_LEN) {
+                spi_rx_frame_read(len);
+            }
+        } else if (status[0] == SPI_DIRECT_WRITE && spi_tx_pending) {
+            if (esp_ll_spi_board_transfer(SPI_CMD_WRDMA, 0, spi_tx_frame, NULL, spi_tx_len)) {
+                esp_ll_spi_board_transfer(SPI_CMD_WR_END, 0, NULL, NULL, 0);
+                spi_stats.tx_bytes += spi_tx_len;
+                ++spi_stats.tx_frames;
+                spi_tx_pending = 0;
+                esp_sys_sem_release(&spi_tx_sem);
+            }
+        }
+        esp_sys_mutex_unlock(&spi_mutex);
+    }
+}
+
+#if ESP_CFG_INPUT_USE_PROCESS
+
+/**
+ * \brief           Thread passing received data to stack
+ */
+static void
+spi_input_thread_fn(void* param) {
+    size_t len;
+
+    ESP_UNUSED(param);
+    while (1) {
+        esp_sys_sem_wait(&spi_rx_sem, 0);       /* Wait for new data */
+        while ((len = esp_buff_get_linear_block_read_length(&spi_rx_buff)) > 0) {
+            esp_input_process(esp_buff_get_linear_block_read_address(&spi_rx_buff), len);
+            esp_buff_skip(&spi_rx_buff, len);
+            esp_sys_sem_release(&spi_rx_free_sem);
+        }
+    }
+}
+
+#endif /* ESP_CFG_INPUT_USE_PROCESS */
+
+/**
+ * \brief           Callback function called from initialization process
+ *
+ * \note            This function may be called multiple times if AT baudrate is changed from application.
+ *                  It is important that every configuration except AT baudrate is configured only once!
+ *
+ * \note            Baudrate is not used with SPI transport, bus clock is configured in \ref esp_ll_spi_board_init
+ *
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_init(esp_ll_t* ll) {
+#if !ESP_CFG_MEM_CUSTOM
+    /* Step 1: Configure memory for dynamic allocations */
+    static uint8_t memory[0x10000];             /* Create memory for dynamic allocations with specific size */
+
+    esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
+        { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
+    };
+    if (!initialized) {
+        esp_mem_assignmemory(mem_regions, ESP_ARRAYSIZE(mem_regions));  /* Assign memory for allocations to ESP library */
+    }
+#endif /* !ESP_CFG_MEM_CUSTOM */
+
+    /* Step 2: Set AT port functions and start transport threads */
+    if (!initialized) {
+        ll->send_fn = send_data;                /* Set callback function to send data */
+        ll->reset_fn = esp_ll_spi_board_reset;  /* Set callback for hardware reset */
+        if (!esp_ll_spi_board_init()) {
+            return espERR;
+        }
+        if (!esp_sys_mutex_create(&spi_mutex)
+            || !esp_sys_sem_create(&spi_tx_sem, 0)
+#if ESP_CFG_INPUT_USE_PROCESS
+            || !esp_buff_init(&spi_rx_buff, ESP_LL_SPI_RX_BUFF_SIZE)
+            || !esp_sys_sem_create(&spi_rx_sem, 0)
+            || !esp_sys_sem_create(&spi_rx_free_sem, 0)
+            || !esp_sys_thread_create(&spi_input_thread, "esp_ll_spi_input", spi_input_thread_fn, NULL, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)
+#endif /* ESP_CFG_INPUT_USE_PROCESS */
+            || !esp_sys_thread_create(&spi_thread, "esp_ll_spi", spi_thread_fn, NULL, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+            return espERRMEM;
+        }
+    }
+    initialized = 1;
+    return espOK;
+}
+
+/**
+ * \brief           Callback function to de-init low-level communication part
+ * \param[in,out]   ll: Pointer to \ref esp_ll_t structure to fill data for communication functions
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+esp_ll_deinit(esp_ll_t* ll) {
+    ESP_UNUSED(ll);
+    initialized = 0;                            /* Clear initialized flag */
+    return espOK;
+}
+
+#endif /* !__DOXYGEN__ */
+
+/**
+ * \brief           Get SPI transport statistics
+ * \param[out]      stats: Pointer to structure to fill with statistics
+ */
+void
+esp_ll_spi_get_stats(esp_ll_spi_stats_t* stats) {
+    if (!initialized) {
+        ESP_MEMSET(stats, 0x00, sizeof(*stats));
+        return;
+    }
+    esp_sys_mutex_lock(&spi_mutex);
+    *stats = spi_stats;
+    esp_sys_mutex_unlock(&spi_mutex);
+}
@@ -41,6 +41,21 @@
  *
  * More about UART + RX DMA: https://github.com/MaJerle/STM32_USART_DMA_RX
  *
+ * When board defines TX DMA stream or channel, data to send are copied to one of two TX buffers.
+ * Buffer is sent with DMA on flush or when full, while next data are copied to second buffer.
+ * Sending thread only waits (without using CPU) when both buffers are in use.
+ *
+ * When board defines `ESP_USART_RTS_PIN`, pin is driven as RTS output (active low).
+ * It is deasserted once `ESP_USART_RTS_HIGH` bytes wait in RX DMA buffer to be processed
+ * and reasserted when backlog drops to `ESP_USART_RTS_LOW` bytes,
+ * so ESP device pauses transmission instead of overrunning the buffer.
+ * When board defines `ESP_USART_CTS_PIN`, USART hardware CTS is enabled for transmission.
+ *
+ * On devices with data cache (STM32F7), DMA buffers are aligned to cache lines.
+ * TX buffer is cleaned before transfer starts and newly received RX bytes
+ * are invalidated before processing, so application may run with D-cache enabled.
+ * Set `ESP_USART_DCACHE` to `0` if buffers are placed in non-cacheable memory region instead.
+ *
  * \ref ESP_CFG_INPUT_USE_PROCESS must be enabled in `esp_config.h` to use this driver.
  */
 #include "esp/esp.h"
@@ -62,15 +77,65 @@
 #define ESP_MEM_SIZE                    0x1000
 #endif /* !defined(ESP_MEM_SIZE) */
 
+#if !defined(ESP_USART_MAX_BAUDRATE)
+#define ESP_USART_MAX_BAUDRATE          0
+#endif /* !defined(ESP_USART_MAX_BAUDRATE) */
+
 #if !defined(ESP_USART_RDR_NAME)
 #define ESP_USART_RDR_NAME              RDR
 #endif /* !defined(ESP_USART_RDR_NAME) */
 
+#if !defined(ESP_USART_TDR_NAME)
+#define ESP_USART_TDR_NAME              TDR
+#endif /* !defined(ESP_USART_TDR_NAME) */
+
+#if !defined(ESP_USART_DMA_TX_BUFF_SIZE)
+#define ESP_USART_DMA_TX_BUFF_SIZE      0x200
+#endif /* !defined(ESP_USART_DMA_TX_BUFF_SIZE) */
+
+#if !defined(ESP_USART_RTS_HIGH)
+#define ESP_USART_RTS_HIGH              (ESP_USART_DMA_RX_BUFF_SIZE * 3 / 4)
+#endif /* !defined(ESP_USART_RTS_HIGH) */
+
+#if !defined(ESP_USART_RTS_LOW)
+#define ESP_USART_RTS_LOW               (ESP_USART_DMA_RX_BUFF_SIZE / 4)
+#endif /* !defined(ESP_USART_RTS_LOW) */
+
+#if !defined(ESP_USART_DCACHE)
+#if defined(__DCACHE_PRESENT) && __DCACHE_PRESENT
+#define ESP_USART_DCACHE                1
+#else
+#define ESP_USART_DCACHE                0
+#endif /* defined(__DCACHE_PRESENT) && __DCACHE_PRESENT */
+#endif /* !defined(ESP_USART_DCACHE) */
+
+/* DMA buffers must occupy complete cache lines to not share them with other variables */
+#if ESP_USART_DCACHE
+#define ESP_USART_CACHE_LINE            32
+#define ESP_USART_MEM_ALIGN             __ALIGNED(ESP_USART_CACHE_LINE)
+#if (ESP_USART_DMA_RX_BUFF_SIZE % ESP_USART_CACHE_LINE) || (ESP_USART_DMA_TX_BUFF_SIZE % ESP_USART_CACHE_LINE)
+#error "ESP_USART_DMA_RX_BUFF_SIZE and ESP_USART_DMA_TX_BUFF_SIZE must be multiple of cache line size"
+#endif /* Buffer size check */
+#else
+#define ESP_USART_MEM_ALIGN
+#endif /* ESP_USART_DCACHE */
+
+/* TX DMA is used when board defines its stream or channel */
+#if defined(ESP_USART_DMA_TX_IRQ)
+#define ESP_USART_USE_DMA_TX            1
+#else
+#define ESP_USART_USE_DMA_TX            0
+#endif /* defined(ESP_USART_DMA_TX_IRQ) */
+
 /* USART memory */
-static uint8_t      usart_mem[ESP_USART_DMA_RX_BUFF_SIZE];
+static uint8_t      usart_mem[ESP_USART_DMA_RX_BUFF_SIZE] ESP_USART_MEM_ALIGN;
 static uint8_t      is_running, initialized;
 static size_t       old_pos;
 
+#if defined(ESP_USART_RTS_PIN)
+static uint8_t      rts_paused;
+#endif /* defined(ESP_USART_RTS_PIN) */
+
 /* USART thread */
 static void usart_ll_thread(void* arg);
 static osThreadId_t usart_ll_thread_id;
@@ -78,6 +143,68 @@ static osThreadId_t usart_ll_thread_id;
 /* Message queue */
 static osMessageQueueId_t usart_ll_mbox_id;
 
+#if ESP_USART_USE_DMA_TX
+/* USART TX memory, one buffer is filled while other is sent */
+static uint8_t      usart_tx_mem[2][ESP_USART_DMA_TX_BUFF_SIZE] ESP_USART_MEM_ALIGN;
+static uint8_t      usart_tx_idx;
+static size_t       usart_tx_len;
+
+/* Semaphore is available when TX DMA is not active */
+static osSemaphoreId_t usart_tx_sem_id;
+#endif /* ESP_USART_USE_DMA_TX */
+
+/**
+ * \brief           Get current RX DMA write position in memory
+ * \return          Position in units of bytes
+ */
+static size_t
+usart_rx_pos(void) {
+#if defined(ESP_USART_DMA_RX_STREAM)
+    return sizeof(usart_mem) - LL_DMA_GetDataLength(ESP_USART_DMA, ESP_USART_DMA_RX_STREAM);
+#else
+    return sizeof(usart_mem) - LL_DMA_GetDataLength(ESP_USART_DMA, ESP_USART_DMA_RX_CH);
+#endif /* defined(ESP_USART_DMA_RX_STREAM) */
+}
+
+#if ESP_USART_DCACHE
+
+/**
+ * \brief           Invalidate D-cache for RX bytes written by DMA
+ * \note            CPU never writes to RX memory, no data are lost by invalidating complete lines
+ * \param[in]       from: Position of first byte
+ * \param[in]       to: Position after last byte
+ */
+static void
+usart_rx_invalidate(size_t from, size_t to) {
+    from &= ~(size_t)(ESP_USART_CACHE_LINE - 1);
+    to = (to + ESP_USART_CACHE_LINE - 1) & ~(size_t)(ESP_USART_CACHE_LINE - 1);
+    SCB_InvalidateDCache_by_Addr((uint32_t *)&usart_mem[from], (int32_t)(to - from));
+}
+
+#endif /* ESP_USART_DCACHE */
+
+#if defined(ESP_USART_RTS_PIN)
+
+/**
+ * \brief           Update RTS line from number of bytes not yet processed
+ * \param[in]       pos: RX DMA write position
+ * \param[in]       rd_pos: Position of first unprocessed byte
+ */
+static void
+usart_rts_update(size_t pos, size_t rd_pos) {
+    size_t pending = pos >= rd_pos ? pos - rd_pos : sizeof(usart_mem) - rd_pos + pos;
+
+    if (!rts_paused && pending >= ESP_USART_RTS_HIGH) {
+        LL_GPIO_SetOutputPin(ESP_USART_RTS_PORT, ESP_USART_RTS_PIN);
+        rts_paused = 1;
+    } else if (rts_paused && pending <= ESP_USART_RTS_LOW) {
+        LL_GPIO_ResetOutputPin(ESP_USART_RTS_PORT, ESP_USART_RTS_PIN);
+        rts_paused = 0;
+    }
+}
+
+#endif /* defined(ESP_USART_RTS_PIN) */
+
 /**
  * \brief           USART data processing
  */
@@ -94,17 +221,25 @@ usart_ll_thread(void* arg) {
         osMessageQueueGet(usart_ll_mbox_id, &d, NULL, osWaitForever);
 
         /* Read data */
-#if defined(ESP_USART_DMA_RX_STREAM)
-        pos = sizeof(usart_mem) - LL_DMA_GetDataLength(ESP_USART_DMA, ESP_USART_DMA_RX_STREAM);
-#else
-        pos = sizeof(usart_mem) - LL_DMA_GetDataLength(ESP_USART_DMA, ESP_USART_DMA_RX_CH);
-#endif /* defined(ESP_USART_DMA_RX_STREAM) */
+        pos = usart_rx_pos();
         if (pos != old_pos && is_running) {
+#if defined(ESP_USART_RTS_PIN)
+            usart_rts_update(pos, old_pos);     /* Pause device while large backlog is processed */
+#endif /* defined(ESP_USART_RTS_PIN) */
             if (pos > old_pos) {
+#if ESP_USART_DCACHE
+                usart_rx_invalidate(old_pos, pos);
+#endif /* ESP_USART_DCACHE */
                 esp_input_process(&usart_mem[old_pos], pos - old_pos);
             } else {
+#if ESP_USART_DCACHE
+                usart_rx_invalidate(old_pos, sizeof(usart_mem));
+#endif /* ESP_USART_DCACHE */
                 esp_input_process(&usart_mem[old_pos], sizeof(usart_mem) - old_pos);
                 if (pos > 0) {
+#if ESP_USART_DCACHE
+                    usart_rx_invalidate(0, pos);
+#endif /* ESP_USART_DCACHE */
                     esp_input_process(&usart_mem[0], pos);
                 }
             }
@@ -112,6 +247,9 @@ usart_ll_thread(void* arg) {
             if (old_pos == sizeof(usart_mem)) {
                 old_pos = 0;
             }
+#if defined(ESP_USART_RTS_PIN)
+            usart_rts_update(usart_rx_pos(), old_pos);  /* Resume once backlog is low */
+#endif /* defined(ESP_USART_RTS_PIN) */
         }
     }
 }
@@ -148,6 +286,14 @@ configure_uart(uint32_t baudrate) {
         ESP_CH_PD_PORT_CLK;
 #endif /* defined(ESP_CH_PD_PIN) */
 
+#if defined(ESP_USART_RTS_PIN)
+        ESP_USART_RTS_PORT_CLK;
+#endif /* defined(ESP_USART_RTS_PIN) */
+
+#if defined(ESP_USART_CTS_PIN)
+        ESP_USART_CTS_PORT_CLK;
+#endif /* defined(ESP_USART_CTS_PIN) */
+
         /* Global pin configuration */
         LL_GPIO_StructInit(&gpio_init);
         gpio_init.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
@@ -182,6 +328,14 @@ configure_uart(uint32_t baudrate) {
         LL_GPIO_SetOutputPin(ESP_CH_PD_PORT, ESP_CH_PD_PIN);
 #endif /* defined(ESP_CH_PD_PIN) */
 
+#if defined(ESP_USART_RTS_PIN)
+        /* Configure RTS pin, active low means ready to receive */
+        gpio_init.Pin = ESP_USART_RTS_PIN;
+        LL_GPIO_Init(ESP_USART_RTS_PORT, &gpio_init);
+        LL_GPIO_ResetOutputPin(ESP_USART_RTS_PORT, ESP_USART_RTS_PIN);
+        rts_paused = 0;
+#endif /* defined(ESP_USART_RTS_PIN) */
+
         /* Configure USART pins */
         gpio_init.Mode = LL_GPIO_MODE_ALTERNATE;
 
@@ -195,12 +349,23 @@ configure_uart(uint32_t baudrate) {
         gpio_init.Pin = ESP_USART_RX_PIN;
         LL_GPIO_Init(ESP_USART_RX_PORT, &gpio_init);
 
+#if defined(ESP_USART_CTS_PIN)
+        /* CTS PIN */
+        gpio_init.Alternate = ESP_USART_CTS_PIN_AF;
+        gpio_init.Pin = ESP_USART_CTS_PIN;
+        LL_GPIO_Init(ESP_USART_CTS_PORT, &gpio_init);
+#endif /* defined(ESP_USART_CTS_PIN) */
+
         /* Configure UART */
         LL_USART_DeInit(ESP_USART);
         LL_USART_StructInit(&usart_init);
         usart_init.BaudRate = baudrate;
         usart_init.DataWidth = LL_USART_DATAWIDTH_8B;
+#if defined(ESP_USART_CTS_PIN)
+        usart_init.HardwareFlowControl = LL_USART_HWCONTROL_CTS;
+#else
         usart_init.HardwareFlowControl = LL_USART_HWCONTROL_NONE;
+#endif /* defined(ESP_USART_CTS_PIN) */
         usart_init.OverSampling = LL_USART_OVERSAMPLING_16;
         usart_init.Parity = LL_USART_PARITY_NONE;
         usart_init.StopBits = LL_USART_STOPBITS_1;
@@ -212,6 +377,9 @@ configure_uart(uint32_t baudrate) {
         LL_USART_EnableIT_PE(ESP_USART);
         LL_USART_EnableIT_ERROR(ESP_USART);
         LL_USART_EnableDMAReq_RX(ESP_USART);
+#if ESP_USART_USE_DMA_TX
+        LL_USART_EnableDMAReq_TX(ESP_USART);
+#endif /* ESP_USART_USE_DMA_TX */
 
         /* Enable USART interrupts */
         NVIC_SetPriority(ESP_USART_IRQ, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0x07, 0x00));
@@ -259,6 +427,39 @@ configure_uart(uint32_t baudrate) {
         NVIC_SetPriority(ESP_USART_DMA_RX_IRQ, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0x07, 0x00));
         NVIC_EnableIRQ(ESP_USART_DMA_RX_IRQ);
 
+#if ESP_USART_USE_DMA_TX
+        /* Configure TX DMA, memory address and length are set for every transfer */
+#if defined(ESP_USART_DMA_TX_STREAM)
+        LL_DMA_DeInit(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM);
+        dma_init.Channel = ESP_USART_DMA_TX_CH;
+#else
+        LL_DMA_DeInit(ESP_USART_DMA, ESP_USART_DMA_TX_CH);
+        dma_init.PeriphRequest = ESP_USART_DMA_TX_REQ_NUM;
+#endif /* defined(ESP_USART_DMA_TX_STREAM) */
+        dma_init.PeriphOrM2MSrcAddress = (uint32_t)&ESP_USART->ESP_USART_TDR_NAME;
+        dma_init.MemoryOrM2MDstAddress = (uint32_t)usart_tx_mem[0];
+        dma_init.Direction = LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+        dma_init.Mode = LL_DMA_MODE_NORMAL;
+        dma_init.NbData = 0;
+#if defined(ESP_USART_DMA_TX_STREAM)
+        LL_DMA_Init(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM, &dma_init);
+        LL_DMA_EnableIT_TC(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM);
+        LL_DMA_EnableIT_TE(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM);
+#else
+        LL_DMA_Init(ESP_USART_DMA, ESP_USART_DMA_TX_CH, &dma_init);
+        LL_DMA_EnableIT_TC(ESP_USART_DMA, ESP_USART_DMA_TX_CH);
+        LL_DMA_EnableIT_TE(ESP_USART_DMA, ESP_USART_DMA_TX_CH);
+#endif /* defined(ESP_USART_DMA_TX_STREAM) */
+        NVIC_SetPriority(ESP_USART_DMA_TX_IRQ, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0x07, 0x00));
+        NVIC_EnableIRQ(ESP_USART_DMA_TX_IRQ);
+
+        usart_tx_idx = 0;
+        usart_tx_len = 0;
+        if (usart_tx_sem_id == NULL) {
+            usart_tx_sem_id = osSemaphoreNew(1, 1, NULL);
+        }
+#endif /* ESP_USART_USE_DMA_TX */
+
         old_pos = 0;
         is_running = 1;
 
@@ -270,6 +471,11 @@ configure_uart(uint32_t baudrate) {
 #endif /* defined(ESP_USART_DMA_RX_STREAM) */
         LL_USART_Enable(ESP_USART);
     } else {
+#if ESP_USART_USE_DMA_TX
+        /* Wait for last transfer to finish before baudrate change */
+        osSemaphoreAcquire(usart_tx_sem_id, osWaitForever);
+        osSemaphoreRelease(usart_tx_sem_id);
+#endif /* ESP_USART_USE_DMA_TX */
         osDelay(10);
         LL_USART_Disable(ESP_USART);
         usart_init.BaudRate = baudrate;
@@ -304,8 +510,72 @@ reset_device(uint8_t state) {
 }
 #endif /* defined(ESP_RESET_PIN) */
 
+#if ESP_USART_USE_DMA_TX
+
 /**
- * \brief           Send data to GSM device
+ * \brief           Start DMA transfer of current TX buffer and switch to other buffer
+ * \note            Function waits for previous transfer to finish
+ */
+static void
+send_data_flush(void) {
+    if (usart_tx_len == 0) {
+        return;
+    }
+    osSemaphoreAcquire(usart_tx_sem_id, osWaitForever); /* Wait for previous transfer */
+#if ESP_USART_DCACHE
+    /* Write data to memory before DMA reads it, buffer size is multiple of cache line */
+    SCB_CleanDCache_by_Addr((uint32_t *)usart_tx_mem[usart_tx_idx],
+        (int32_t)((usart_tx_len + ESP_USART_CACHE_LINE - 1) & ~(size_t)(ESP_USART_CACHE_LINE - 1)));
+#endif /* ESP_USART_DCACHE */
+#if defined(ESP_USART_DMA_TX_STREAM)
+    LL_DMA_SetMemoryAddress(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM, (uint32_t)usart_tx_mem[usart_tx_idx]);
+    LL_DMA_SetDataLength(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM, usart_tx_len);
+    LL_DMA_EnableStream(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM);
+#else
+    LL_DMA_SetMemoryAddress(ESP_USART_DMA, ESP_USART_DMA_TX_CH, (uint32_t)usart_tx_mem[usart_tx_idx]);
+    LL_DMA_SetDataLength(ESP_USART_DMA, ESP_USART_DMA_TX_CH, usart_tx_len);
+    LL_DMA_EnableChannel(ESP_USART_DMA, ESP_USART_DMA_TX_CH);
+#endif /* defined(ESP_USART_DMA_TX_STREAM) */
+    usart_tx_idx = !usart_tx_idx;               /* Fill other buffer now */
+    usart_tx_len = 0;
+}
+
+/**
+ * \brief           Send data to ESP device
+ *
+ *                  Data are copied to TX buffer and sent with DMA when buffer is full
+ *                  or when flush is requested. Function returns before data are physically sent
+ *
+ * \param[in]       data: Pointer to data to send. Set to `NULL` to flush buffer
+ * \param[in]       len: Number of bytes to send. Set to `0` to flush buffer
+ * \return          Number of bytes sent
+ */
+static size_t
+send_data(const void* data, size_t len) {
+    const uint8_t* d = data;
+    size_t to_copy, rem = len;
+
+    if (data == NULL || len == 0) {
+        send_data_flush();
+        return 0;
+    }
+    while (rem > 0) {
+        to_copy = ESP_MIN(rem, sizeof(usart_tx_mem[0]) - usart_tx_len);
+        ESP_MEMCPY(&usart_tx_mem[usart_tx_idx][usart_tx_len], d, to_copy);
+        usart_tx_len += to_copy;
+        d += to_copy;
+        rem -= to_copy;
+        if (usart_tx_len == sizeof(usart_tx_mem[0])) {
+            send_data_flush();
+        }
+    }
+    return len;
+}
+
+#else /* ESP_USART_USE_DMA_TX */
+
+/**
+ * \brief           Send data to ESP device
  * \param[in]       data: Pointer to data to send
  * \param[in]       len: Number of bytes to send
  * \return          Number of bytes sent
@@ -321,6 +591,8 @@ send_data(const void* data, size_t len) {
     return len;
 }
 
+#endif /* !ESP_USART_USE_DMA_TX */
+
 /**
  * \brief           Callback function called from initialization process
  * \note            This function may be called multiple times if AT baudrate is changed from application
@@ -333,7 +605,11 @@ esp_ll_init(esp_ll_t* ll) {
 #if !ESP_CFG_MEM_CUSTOM
     static uint8_t memory[ESP_MEM_SIZE];
     esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
         { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
     };
 
     if (!initialized) {
@@ -348,6 +624,7 @@ esp_ll_init(esp_ll_t* ll) {
 #endif /* defined(ESP_RESET_PIN) */
     }
 
+    ll->uart.max_baudrate = ESP_USART_MAX_BAUDRATE; /* Highest baudrate board can handle */
     configure_uart(ll->uart.baudrate);          /* Initialize UART for communication */
     initialized = 1;
     return espOK;
@@ -406,4 +683,21 @@ ESP_USART_DMA_RX_IRQHANDLER(void) {
     }
 }
 
+#if ESP_USART_USE_DMA_TX
+/**
+ * \brief           UART TX DMA stream/channel handler
+ */
+void
+ESP_USART_DMA_TX_IRQHANDLER(void) {
+    ESP_USART_DMA_TX_CLEAR_TC;
+    ESP_USART_DMA_TX_CLEAR_TE;
+#if defined(ESP_USART_DMA_TX_STREAM)
+    LL_DMA_DisableStream(ESP_USART_DMA, ESP_USART_DMA_TX_STREAM);
+#else
+    LL_DMA_DisableChannel(ESP_USART_DMA, ESP_USART_DMA_TX_CH);
+#endif /* defined(ESP_USART_DMA_TX_STREAM) */
+    osSemaphoreRelease(usart_tx_sem_id);        /* Transfer finished, buffer may be used again */
+}
+#endif /* ESP_USART_USE_DMA_TX */
+
 #endif /* !__DOXYGEN__ */
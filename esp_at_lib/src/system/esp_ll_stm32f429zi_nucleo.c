@@ -59,9 +59,11 @@
 /* USART */
 #define ESP_USART                           USART2
 #define ESP_USART_CLK                       LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_USART2)
+#define ESP_USART_MAX_BAUDRATE              2000000 /* USART2 on 45 MHz APB1, oversampling 16 */
 #define ESP_USART_IRQ                       USART2_IRQn
 #define ESP_USART_IRQHANDLER                USART2_IRQHandler
 #define ESP_USART_RDR_NAME                  DR
+#define ESP_USART_TDR_NAME                  DR
 
 /* DMA settings */
 #define ESP_USART_DMA                       DMA1
@@ -70,12 +72,18 @@
 #define ESP_USART_DMA_RX_CH                 LL_DMA_CHANNEL_4
 #define ESP_USART_DMA_RX_IRQ                DMA1_Stream5_IRQn
 #define ESP_USART_DMA_RX_IRQHANDLER         DMA1_Stream5_IRQHandler
+#define ESP_USART_DMA_TX_STREAM             LL_DMA_STREAM_6
+#define ESP_USART_DMA_TX_CH                 LL_DMA_CHANNEL_4
+#define ESP_USART_DMA_TX_IRQ                DMA1_Stream6_IRQn
+#define ESP_USART_DMA_TX_IRQHANDLER         DMA1_Stream6_IRQHandler
 
 /* DMA flags management */
 #define ESP_USART_DMA_RX_IS_TC              LL_DMA_IsActiveFlag_TC5(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_IS_HT              LL_DMA_IsActiveFlag_HT5(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_CLEAR_TC           LL_DMA_ClearFlag_TC5(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_CLEAR_HT           LL_DMA_ClearFlag_HT5(ESP_USART_DMA)
+#define ESP_USART_DMA_TX_CLEAR_TC           LL_DMA_ClearFlag_TC6(ESP_USART_DMA)
+#define ESP_USART_DMA_TX_CLEAR_TE           LL_DMA_ClearFlag_TE6(ESP_USART_DMA)
 
 /* USART TX PIN */
 #define ESP_USART_TX_PORT_CLK               LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOD)
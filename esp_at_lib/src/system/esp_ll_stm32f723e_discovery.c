@@ -58,6 +58,7 @@
 /* USART */
 #define ESP_USART                           UART5
 #define ESP_USART_CLK                       LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_UART5)
+#define ESP_USART_MAX_BAUDRATE              3000000 /* UART5 on 54 MHz APB1, oversampling 16 */
 #define ESP_USART_IRQ                       UART5_IRQn
 #define ESP_USART_IRQHANDLER                UART5_IRQHandler
 
@@ -68,12 +69,18 @@
 #define ESP_USART_DMA_RX_CH                 LL_DMA_CHANNEL_4
 #define ESP_USART_DMA_RX_IRQ                DMA1_Stream0_IRQn
 #define ESP_USART_DMA_RX_IRQHANDLER         DMA1_Stream0_IRQHandler
+#define ESP_USART_DMA_TX_STREAM             LL_DMA_STREAM_7
+#define ESP_USART_DMA_TX_CH                 LL_DMA_CHANNEL_4
+#define ESP_USART_DMA_TX_IRQ                DMA1_Stream7_IRQn
+#define ESP_USART_DMA_TX_IRQHANDLER         DMA1_Stream7_IRQHandler
 
 /* DMA flags management */
 #define ESP_USART_DMA_RX_IS_TC              LL_DMA_IsActiveFlag_TC0(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_IS_HT              LL_DMA_IsActiveFlag_HT0(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_CLEAR_TC           LL_DMA_ClearFlag_TC0(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_CLEAR_HT           LL_DMA_ClearFlag_HT0(ESP_USART_DMA)
+#define ESP_USART_DMA_TX_CLEAR_TC           LL_DMA_ClearFlag_TC7(ESP_USART_DMA)
+#define ESP_USART_DMA_TX_CLEAR_TE           LL_DMA_ClearFlag_TE7(ESP_USART_DMA)
 
 /* USART TX PIN */
 #define ESP_USART_TX_PORT_CLK               LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOC)
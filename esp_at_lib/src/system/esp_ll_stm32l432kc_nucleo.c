@@ -61,6 +61,7 @@
 /* USART */
 #define ESP_USART                           USART1
 #define ESP_USART_CLK                       LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_USART1)
+#define ESP_USART_MAX_BAUDRATE              3000000 /* USART1 on 80 MHz APB2, oversampling 16 */
 #define ESP_USART_IRQ                       USART1_IRQn
 #define ESP_USART_IRQHANDLER                USART1_IRQHandler
 
@@ -71,12 +72,18 @@
 #define ESP_USART_DMA_RX_REQ_NUM            LL_DMA_REQUEST_2
 #define ESP_USART_DMA_RX_IRQ                DMA1_Channel5_IRQn
 #define ESP_USART_DMA_RX_IRQHANDLER         DMA1_Channel5_IRQHandler
+#define ESP_USART_DMA_TX_CH                 LL_DMA_CHANNEL_4
+#define ESP_USART_DMA_TX_REQ_NUM            LL_DMA_REQUEST_2
+#define ESP_USART_DMA_TX_IRQ                DMA1_Channel4_IRQn
+#define ESP_USART_DMA_TX_IRQHANDLER         DMA1_Channel4_IRQHandler
 
 /* DMA flags management */
 #define ESP_USART_DMA_RX_IS_TC              LL_DMA_IsActiveFlag_TC5(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_IS_HT              LL_DMA_IsActiveFlag_HT5(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_CLEAR_TC           LL_DMA_ClearFlag_TC5(ESP_USART_DMA)
 #define ESP_USART_DMA_RX_CLEAR_HT           LL_DMA_ClearFlag_HT5(ESP_USART_DMA)
+#define ESP_USART_DMA_TX_CLEAR_TC           LL_DMA_ClearFlag_TC4(ESP_USART_DMA)
+#define ESP_USART_DMA_TX_CLEAR_TE           LL_DMA_ClearFlag_TE4(ESP_USART_DMA)
 
 /* USART TX PIN */
 #define ESP_USART_TX_PORT_CLK               LL_AHB2_GRP1_EnableClock(LL_AHB2_GRP1_PERIPH_GPIOA)
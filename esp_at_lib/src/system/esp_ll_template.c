@@ -76,7 +76,11 @@ esp_ll_init(esp_ll_t* ll) {
      * multiple memories may be used
      */
     esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
         { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
     };
     if (!initialized) {
         esp_mem_assignmemory(mem_regions, ESP_ARRAYSIZE(mem_regions));  /* Assign memory for allocations to ESP library */
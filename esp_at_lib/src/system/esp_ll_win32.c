@@ -43,21 +43,55 @@ static uint8_t initialized = 0;
 static HANDLE thread_handle;
 static volatile HANDLE com_port;                /*!< COM port handle */
 static uint8_t data_buffer[0x1000];             /*!< Received data array */
+static uint8_t tx_buffer[0x1000];               /*!< Data array for batched transmit */
+static size_t tx_buffer_len;                    /*!< Number of bytes waiting in TX buffer */
+static OVERLAPPED tx_overlapped;                /*!< Overlapped structure for write operation */
 
 static void uart_thread(void* param);
 
+/**
+ * \brief           Write all data in TX buffer with single write operation
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+send_data_flush(void) {
+    DWORD written = 0;
+    uint8_t res = 1;
+
+    if (tx_buffer_len == 0) {
+        return 1;
+    }
+    if (!WriteFile(com_port, tx_buffer, (DWORD)tx_buffer_len, &written, &tx_overlapped)) {
+        if (GetLastError() != ERROR_IO_PENDING
+            || !GetOverlappedResult(com_port, &tx_overlapped, &written, TRUE)) {
+            res = 0;
+        }
+    }
+    tx_buffer_len = 0;
+    return res && written > 0;
+}
+
 /**
  * \brief           Send data to ESP device, function called from ESP stack when we have data to send
- * \param[in]       data: Pointer to data to send
- * \param[in]       len: Number of bytes to send
+ *
+ *                  Data are collected to TX buffer and written to COM port
+ *                  when buffer is full or when stack requests flush
+ *
+ * \param[in]       data: Pointer to data to send. Set to `NULL` to flush buffer
+ * \param[in]       len: Number of bytes to send. Set to `0` to flush buffer
  * \return          Number of bytes sent
  */
 static size_t
 send_data(const void* data, size_t len) {
-    DWORD written;
     if (com_port != NULL) {
-#if !ESP_CFG_AT_ECHO
         const uint8_t* d = data;
+        size_t to_copy, rem = len;
+
+        if (data == NULL || len == 0) {
+            send_data_flush();
+            return 0;
+        }
+#if !ESP_CFG_AT_ECHO
         HANDLE hConsole;
 
         hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -68,9 +102,17 @@ send_data(const void* data, size_t len) {
         SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 #endif /* !ESP_CFG_AT_ECHO */
 
-        WriteFile(com_port, data, len, &written, NULL);
-        FlushFileBuffers(com_port);
-        return written;
+        while (rem > 0) {
+            to_copy = ESP_MIN(rem, sizeof(tx_buffer) - tx_buffer_len);
+            ESP_MEMCPY(&tx_buffer[tx_buffer_len], d, to_copy);
+            tx_buffer_len += to_copy;
+            d += to_copy;
+            rem -= to_copy;
+            if (tx_buffer_len == sizeof(tx_buffer) && !send_data_flush()) {
+                return 0;                       /* Write failed, buffered data are lost */
+            }
+        }
+        return len;
     }
     return 0;
 }
@@ -94,9 +136,10 @@ configure_uart(uint32_t baudrate) {
             0,
             0,
             OPEN_EXISTING,
-            0,
+            FILE_FLAG_OVERLAPPED,
             NULL
         );
+        tx_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
     }
 
     /* Configure COM port parameters */
@@ -111,6 +154,9 @@ configure_uart(uint32_t baudrate) {
         if (!SetCommState(com_port, &dcb)) {
             printf("Cannot set COM PORT info\r\n");
         }
+        if (!SetCommMask(com_port, EV_RXCHAR)) {
+            printf("Cannot set COM PORT event mask\r\n");
+        }
         if (GetCommTimeouts(com_port, &timeouts)) {
             /* Set timeout to return immediatelly from ReadFile function */
             timeouts.ReadIntervalTimeout = MAXDWORD;
@@ -133,12 +179,35 @@ configure_uart(uint32_t baudrate) {
     }
 }
 
+/**
+ * \brief           Read available data from COM port
+ * \param[in]       ov: Overlapped structure for read operation
+ * \return          Number of bytes read
+ */
+static DWORD
+read_data(OVERLAPPED* ov) {
+    DWORD bytes_read = 0;
+
+    /* Timeouts are set to return immediately with data already received */
+    if (!ReadFile(com_port, data_buffer, sizeof(data_buffer), &bytes_read, ov)) {
+        if (GetLastError() != ERROR_IO_PENDING
+            || !GetOverlappedResult(com_port, ov, &bytes_read, TRUE)) {
+            bytes_read = 0;
+        }
+    }
+    return bytes_read;
+}
+
 /**
  * \brief           UART thread
+ *
+ *                  Thread sleeps until COM port reports received character
+ *                  and then reads all available data
  */
 static void
 uart_thread(void* param) {
-    DWORD bytes_read;
+    DWORD bytes_read, ev_mask, dummy;
+    OVERLAPPED rx_overlapped = { 0 }, ev_overlapped = { 0 };
     esp_sys_sem_t sem;
     FILE* file = NULL;
 
@@ -147,6 +216,8 @@ uart_thread(void* param) {
     while (com_port == NULL) {
         esp_sys_sem_wait(&sem, 1);              /* Add some delay with yield */
     }
+    rx_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    ev_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
 
     fopen_s(&file, "log_file.txt", "w+");       /* Open debug file in write mode */
     while (1) {
@@ -155,7 +226,7 @@ uart_thread(void* param) {
          * and send it to upper layer for processing
          */
         do {
-            ReadFile(com_port, data_buffer, sizeof(data_buffer), &bytes_read, NULL);
+            bytes_read = read_data(&rx_overlapped);
             if (bytes_read > 0) {
                 HANDLE hConsole;
                 hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -185,8 +256,14 @@ uart_thread(void* param) {
             }
         } while (bytes_read == (DWORD)sizeof(data_buffer));
 
-        /* Implement delay to allow other tasks processing */
-        esp_sys_sem_wait(&sem, 1);
+        /* Wait for new character without polling */
+        ev_mask = 0;
+        if (!WaitCommEvent(com_port, &ev_mask, &ev_overlapped)) {
+            if (GetLastError() != ERROR_IO_PENDING
+                || !GetOverlappedResult(com_port, &ev_overlapped, &dummy, TRUE)) {
+                esp_sys_sem_wait(&sem, 1);      /* Delay on error to allow other tasks processing */
+            }
+        }
     }
 }
 
@@ -223,7 +300,11 @@ esp_ll_init(esp_ll_t* ll) {
      * multiple memories may be used
      */
     esp_mem_region_t mem_regions[] = {
+#if ESP_CFG_MEM_REGION_CLASS
+        { memory, sizeof(memory), ESP_MEM_CLASS_FAST }
+#else /* ESP_CFG_MEM_REGION_CLASS */
         { memory, sizeof(memory) }
+#endif /* !ESP_CFG_MEM_REGION_CLASS */
     };
     if (!initialized) {
         esp_mem_assignmemory(mem_regions, ESP_ARRAYSIZE(mem_regions));  /* Assign memory for allocations to ESP library */
@@ -38,6 +38,63 @@
 
 static osMutexId_t sys_mutex;
 
+#if ESP_SYS_MBOX_NATIVE
+#include "cmsis_compiler.h"
+
+/* Number of native mboxes, library uses up to 4 */
+#if !defined(ESP_SYS_MBOX_NATIVE_COUNT)
+#define ESP_SYS_MBOX_NATIVE_COUNT       4
+#endif /* !defined(ESP_SYS_MBOX_NATIVE_COUNT) */
+
+/* Number of entries for all native mboxes, defaults to sizes requested by library */
+#if !defined(ESP_SYS_MBOX_NATIVE_ENTRIES)
+#define ESP_SYS_MBOX_NATIVE_ENTRIES     (2 * (ESP_CFG_THREAD_PRODUCER_MBOX_SIZE + ESP_CFG_THREAD_PRODUCER_LOW_MBOX_SIZE) + ESP_CFG_THREAD_PROCESS_MBOX_SIZE + ESP_CFG_CONN_SEND_QUEUE)
+#endif /* !defined(ESP_SYS_MBOX_NATIVE_ENTRIES) */
+
+/* Critical section for ring indexes, mbox may be written from interrupt */
+#define MBOX_CRITICAL_ENTER()           uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define MBOX_CRITICAL_EXIT()            __set_PRIMASK(primask)
+
+/* Native message box */
+struct esp_sys_mbox {
+    osSemaphoreId_t items;                      /* Number of entries in ring */
+    osSemaphoreId_t spaces;                     /* Number of free slots in ring */
+    void** entries;                             /* Memory for entries */
+    size_t size;                                /* Number of slots */
+    size_t r;                                   /* Read index */
+    size_t w;                                   /* Write index */
+};
+
+static struct esp_sys_mbox mboxes[ESP_SYS_MBOX_NATIVE_COUNT];
+static void* mbox_entries[ESP_SYS_MBOX_NATIVE_ENTRIES];
+static size_t mbox_entries_used, mbox_used;
+
+/* Store entry to ring, free slot must be reserved with spaces semaphore */
+static void
+mbox_write(esp_sys_mbox_t b, void* m) {
+    MBOX_CRITICAL_ENTER();
+    b->entries[b->w] = m;
+    if (++b->w >= b->size) {
+        b->w = 0;
+    }
+    MBOX_CRITICAL_EXIT();
+    osSemaphoreRelease(b->items);
+}
+
+/* Read entry from ring, entry must be reserved with items semaphore */
+static void
+mbox_read(esp_sys_mbox_t b, void** m) {
+    MBOX_CRITICAL_ENTER();
+    *m = b->entries[b->r];
+    if (++b->r >= b->size) {
+        b->r = 0;
+    }
+    MBOX_CRITICAL_EXIT();
+    osSemaphoreRelease(b->spaces);
+}
+
+#endif /* ESP_SYS_MBOX_NATIVE */
+
 uint8_t
 esp_sys_init(void) {
     esp_sys_mutex_create(&sys_mutex);
@@ -128,6 +185,101 @@ esp_sys_sem_invalid(esp_sys_sem_t* p) {
     return 1;
 }
 
+#if ESP_SYS_MBOX_NATIVE
+
+uint8_t
+esp_sys_mbox_create(esp_sys_mbox_t* b, size_t size) {
+    esp_sys_mbox_t mb = NULL;
+
+    *b = NULL;
+    if (size == 0 || mbox_entries_used + size > ESP_SYS_MBOX_NATIVE_ENTRIES) {
+        return 0;
+    }
+    for (size_t i = 0; i < ESP_SYS_MBOX_NATIVE_COUNT; ++i) {
+        if (mboxes[i].entries == NULL) {
+            mb = &mboxes[i];
+            break;
+        }
+    }
+    if (mb == NULL) {
+        return 0;
+    }
+    mb->items = osSemaphoreNew(size, 0, NULL);
+    mb->spaces = osSemaphoreNew(size, size, NULL);
+    if (mb->items == NULL || mb->spaces == NULL) {
+        if (mb->items != NULL) {
+            osSemaphoreDelete(mb->items);
+        }
+        if (mb->spaces != NULL) {
+            osSemaphoreDelete(mb->spaces);
+        }
+        return 0;
+    }
+    mb->entries = &mbox_entries[mbox_entries_used];
+    mb->size = size;
+    mb->r = mb->w = 0;
+    mbox_entries_used += size;
+    ++mbox_used;
+    *b = mb;
+    return 1;
+}
+
+uint8_t
+esp_sys_mbox_delete(esp_sys_mbox_t* b) {
+    esp_sys_mbox_t mb = *b;
+
+    if (osSemaphoreGetCount(mb->items) > 0) {
+        return 0;
+    }
+    osSemaphoreDelete(mb->items);
+    osSemaphoreDelete(mb->spaces);
+    mb->entries = NULL;
+    if (--mbox_used == 0) {                     /* Entries memory is reused once all mboxes are deleted */
+        mbox_entries_used = 0;
+    }
+    return 1;
+}
+
+uint32_t
+esp_sys_mbox_put(esp_sys_mbox_t* b, void* m) {
+    uint32_t tick = osKernelSysTick();
+    if (osSemaphoreAcquire((*b)->spaces, osWaitForever) != osOK) {
+        return ESP_SYS_TIMEOUT;
+    }
+    mbox_write(*b, m);
+    return osKernelSysTick() - tick;
+}
+
+uint32_t
+esp_sys_mbox_get(esp_sys_mbox_t* b, void** m, uint32_t timeout) {
+    uint32_t tick = osKernelSysTick();
+    if (osSemaphoreAcquire((*b)->items, timeout == 0 ? osWaitForever : timeout) != osOK) {
+        return ESP_SYS_TIMEOUT;
+    }
+    mbox_read(*b, m);
+    return osKernelSysTick() - tick;
+}
+
+uint8_t
+esp_sys_mbox_putnow(esp_sys_mbox_t* b, void* m) {
+    if (osSemaphoreAcquire((*b)->spaces, 0) != osOK) {
+        return 0;
+    }
+    mbox_write(*b, m);
+    return 1;
+}
+
+uint8_t
+esp_sys_mbox_getnow(esp_sys_mbox_t* b, void** m) {
+    if (osSemaphoreAcquire((*b)->items, 0) != osOK) {
+        return 0;
+    }
+    mbox_read(*b, m);
+    return 1;
+}
+
+#else /* ESP_SYS_MBOX_NATIVE */
+
 uint8_t
 esp_sys_mbox_create(esp_sys_mbox_t* b, size_t size) {
     return (*b = osMessageQueueNew(size, sizeof(void *), NULL)) != NULL;
@@ -163,6 +315,8 @@ esp_sys_mbox_getnow(esp_sys_mbox_t* b, void** m) {
     return osMessageQueueGet(*b, m, NULL, 0) == osOK;
 }
 
+#endif /* !ESP_SYS_MBOX_NATIVE */
+
 uint8_t
 esp_sys_mbox_isvalid(esp_sys_mbox_t* b) {
     return b != NULL && *b != NULL;
@@ -206,4 +360,36 @@ esp_sys_thread_yield(void) {
     return 1;
 }
 
+#if ESP_CFG_SYS_THREAD_NOTIFY
+
+#define ESP_SYS_THREAD_NOTIFY_FLAG      0x00000001U
+
+uint8_t
+esp_sys_thread_notify(esp_sys_thread_t* t) {
+    return (osThreadFlagsSet(*t, ESP_SYS_THREAD_NOTIFY_FLAG) & osFlagsError) == 0;
+}
+
+uint32_t
+esp_sys_thread_notify_wait(uint32_t timeout) {
+    uint32_t tick = osKernelSysTick();
+    return (osThreadFlagsWait(ESP_SYS_THREAD_NOTIFY_FLAG, osFlagsWaitAny, timeout == 0 ? osWaitForever : timeout) & osFlagsError) == 0 ? (osKernelSysTick() - tick) : ESP_SYS_TIMEOUT;
+}
+
+uint8_t
+esp_sys_thread_notify_clear(void) {
+    osThreadFlagsClear(ESP_SYS_THREAD_NOTIFY_FLAG);
+    return 1;
+}
+
+#endif /* ESP_CFG_SYS_THREAD_NOTIFY */
+
+#if ESP_CFG_THREAD_STATS
+
+size_t
+esp_sys_thread_stack_free(esp_sys_thread_t* t) {
+    return (size_t)osThreadGetStackSpace(*t);
+}
+
+#endif /* ESP_CFG_THREAD_STATS */
+
 #endif /* !__DOXYGEN__ */
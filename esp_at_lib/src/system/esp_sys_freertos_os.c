@@ -37,6 +37,15 @@
 #include "semphr.h"
 
 #if !__DOXYGEN__
+
+/*
+ * Check if code runs in interrupt context.
+ * Define to port specific check if port does not provide xPortIsInsideInterrupt
+ */
+#if !defined(ESP_SYS_FREERTOS_IN_ISR)
+#define ESP_SYS_FREERTOS_IN_ISR()       (xPortIsInsideInterrupt() == pdTRUE)
+#endif /* !defined(ESP_SYS_FREERTOS_IN_ISR) */
+
 /* Mutex ID for main protection */
 static SemaphoreHandle_t sys_mutex;
 
@@ -181,7 +190,16 @@ esp_sys_mbox_putnow(esp_sys_mbox_t* b, void* m) {
     freertos_mbox mb;
 
     mb.d = m;
-    return xQueueSendFromISR(*b, &mb, 0) == pdPASS;
+    if (ESP_SYS_FREERTOS_IN_ISR()) {
+        BaseType_t woken = pdFALSE;
+        BaseType_t res;
+
+        /* Switch to woken thread (processing thread) directly on interrupt exit */
+        res = xQueueSendFromISR(*b, &mb, &woken);
+        portYIELD_FROM_ISR(woken);
+        return res == pdPASS;
+    }
+    return xQueueSend(*b, &mb, 0) == pdPASS;
 }
 
 uint8_t
@@ -223,4 +241,35 @@ esp_sys_thread_yield(void) {
     return 1;
 }
 
+#if ESP_CFG_SYS_THREAD_NOTIFY
+
+uint8_t
+esp_sys_thread_notify(esp_sys_thread_t* t) {
+    xTaskNotifyGive(*t);
+    return 1;
+}
+
+uint32_t
+esp_sys_thread_notify_wait(uint32_t timeout) {
+    uint32_t t = xTaskGetTickCount();
+    return ulTaskNotifyTake(pdTRUE, !timeout ? portMAX_DELAY : timeout) > 0 ? (xTaskGetTickCount() - t) : ESP_SYS_TIMEOUT;
+}
+
+uint8_t
+esp_sys_thread_notify_clear(void) {
+    ulTaskNotifyTake(pdTRUE, 0);
+    return 1;
+}
+
+#endif /* ESP_CFG_SYS_THREAD_NOTIFY */
+
+#if ESP_CFG_THREAD_STATS
+
+size_t
+esp_sys_thread_stack_free(esp_sys_thread_t* t) {
+    return (size_t)uxTaskGetStackHighWaterMark(*t) * sizeof(StackType_t);
+}
+
+#endif /* ESP_CFG_THREAD_STATS */
+
 #endif /* !__DOXYGEN__ */
@@ -0,0 +1,508 @@
+/**
+ * \file            esp_sys_posix.c
+ * \brief           System dependant functions for POSIX systems (Linux)
+ */
+
+/*
+ * Copyright (c) 2019 Tilen MAJERLE
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ESP-AT library.
+ *
+ * Author:          Tilen MAJERLE <tilen@majerle.eu>
+ * Version:         $_version_$
+ */
+#include "system/esp_sys.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#if !__DOXYGEN__
+
+#if ESP_CFG_OS
+
+/**
+ * \brief           Counting semaphore built on mutex and condition variable
+ */
+struct esp_sys_posix_sem {
+    pthread_mutex_t mutex;                      /*!< Mutex protecting count */
+    pthread_cond_t cond;                        /*!< Signaled when count is increased */
+    uint32_t count;                             /*!< Semaphore count */
+    uint32_t max;                               /*!< Maximal count */
+};
+
+#endif /* ESP_CFG_OS */
+
+/**
+ * \brief           Message queue of pointers
+ */
+struct esp_sys_posix_mbox {
+    pthread_mutex_t mutex;                      /*!< Mutex protecting queue */
+    pthread_cond_t not_empty;                   /*!< Signaled when entry is written */
+    pthread_cond_t not_full;                    /*!< Signaled when entry is read */
+    size_t in, out, cnt, size;
+    void* entries[];                            /*!< Queue entries */
+};
+
+static pthread_mutex_t sys_mutex_obj;
+static esp_sys_mutex_t sys_mutex;               /* Mutex ID for main protection */
+
+/**
+ * \brief           Initialize condition variable using monotonic clock for timeouts
+ * \param[out]      cond: Condition variable to initialize
+ */
+static void
+cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+#if ESP_CFG_OS
+
+/**
+ * \brief           Get absolute time in the future for timed waits
+ * \param[out]      ts: Output time
+ * \param[in]       timeout: Timeout in units of milliseconds
+ */
+static void
+timeout_to_abstime(struct timespec* ts, uint32_t timeout) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += timeout / 1000;
+    ts->tv_nsec += (long)(timeout % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ++ts->tv_sec;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * \brief           Wait for condition variable, `0` timeout waits forever
+ * \param[in]       cond: Condition variable
+ * \param[in]       mutex: Locked mutex
+ * \param[in]       ts: Absolute timeout or `NULL` to wait forever
+ * \return          `1` if signaled, `0` on timeout
+ */
+static uint8_t
+cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* ts) {
+    if (ts == NULL) {
+        pthread_cond_wait(cond, mutex);
+        return 1;
+    }
+    return pthread_cond_timedwait(cond, mutex, ts) != ETIMEDOUT;
+}
+
+#endif /* ESP_CFG_OS */
+
+uint8_t
+esp_sys_init(void) {
+    sys_mutex = &sys_mutex_obj;
+    return esp_sys_mutex_create(&sys_mutex);
+}
+
+uint32_t
+esp_sys_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+uint8_t
+esp_sys_protect(void) {
+    esp_sys_mutex_lock(&sys_mutex);
+    return 1;
+}
+
+uint8_t
+esp_sys_unprotect(void) {
+    esp_sys_mutex_unlock(&sys_mutex);
+    return 1;
+}
+
+uint8_t
+esp_sys_mutex_create(esp_sys_mutex_t* p) {
+    pthread_mutexattr_t attr;
+    pthread_mutex_t* m = *p == &sys_mutex_obj ? *p : malloc(sizeof(*m));
+
+    if (m == NULL) {
+        return 0;
+    }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+    *p = m;
+    return 1;
+}
+
+uint8_t
+esp_sys_mutex_delete(esp_sys_mutex_t* p) {
+    pthread_mutex_destroy(*p);
+    if (*p != &sys_mutex_obj) {
+        free(*p);
+    }
+    return 1;
+}
+
+uint8_t
+esp_sys_mutex_lock(esp_sys_mutex_t* p) {
+    return pthread_mutex_lock(*p) == 0;
+}
+
+uint8_t
+esp_sys_mutex_unlock(esp_sys_mutex_t* p) {
+    return pthread_mutex_unlock(*p) == 0;
+}
+
+uint8_t
+esp_sys_mutex_isvalid(esp_sys_mutex_t* p) {
+    return p != NULL && *p != NULL;
+}
+
+uint8_t
+esp_sys_mutex_invalid(esp_sys_mutex_t* p) {
+    *p = ESP_SYS_MUTEX_NULL;
+    return 1;
+}
+
+#if ESP_CFG_OS
+
+uint8_t
+esp_sys_sem_create(esp_sys_sem_t* p, uint8_t cnt) {
+    esp_sys_sem_t s = malloc(sizeof(*s));
+
+    *p = s;
+    if (s == NULL) {
+        return 0;
+    }
+    pthread_mutex_init(&s->mutex, NULL);
+    cond_init(&s->cond);
+    s->max = 1;                                 /* Binary semaphore, same as other ports */
+    s->count = cnt > 0 ? 1 : 0;
+    return 1;
+}
+
+uint8_t
+esp_sys_sem_delete(esp_sys_sem_t* p) {
+    pthread_cond_destroy(&(*p)->cond);
+    pthread_mutex_destroy(&(*p)->mutex);
+    free(*p);
+    return 1;
+}
+
+uint32_t
+esp_sys_sem_wait(esp_sys_sem_t* p, uint32_t timeout) {
+    esp_sys_sem_t s = *p;
+    struct timespec ts;
+    uint32_t tick = esp_sys_now();
+    uint8_t ok = 1;
+
+    if (timeout > 0) {
+        timeout_to_abstime(&ts, timeout);
+    }
+    pthread_mutex_lock(&s->mutex);
+    while (s->count == 0 && ok) {
+        ok = cond_wait(&s->cond, &s->mutex, timeout > 0 ? &ts : NULL);
+    }
+    if (s->count > 0) {
+        --s->count;
+        ok = 1;
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return ok ? (esp_sys_now() - tick) : ESP_SYS_TIMEOUT;
+}
+
+uint8_t
+esp_sys_sem_release(esp_sys_sem_t* p) {
+    esp_sys_sem_t s = *p;
+
+    pthread_mutex_lock(&s->mutex);
+    if (s->count < s->max) {
+        ++s->count;
+    }
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+    return 1;
+}
+
+uint8_t
+esp_sys_sem_isvalid(esp_sys_sem_t* p) {
+    return p != NULL && *p != NULL;
+}
+
+uint8_t
+esp_sys_sem_invalid(esp_sys_sem_t* p) {
+    *p = ESP_SYS_SEM_NULL;
+    return 1;
+}
+
+#endif /* ESP_CFG_OS */
+
+uint8_t
+esp_sys_mbox_create(esp_sys_mbox_t* b, size_t size) {
+    esp_sys_mbox_t mbox;
+
+    *b = NULL;
+    if (size == 0) {
+        return 0;
+    }
+    mbox = malloc(sizeof(*mbox) + size * sizeof(void *));
+    if (mbox != NULL) {
+        memset(mbox, 0x00, sizeof(*mbox));
+        pthread_mutex_init(&mbox->mutex, NULL);
+        cond_init(&mbox->not_empty);
+        cond_init(&mbox->not_full);
+        mbox->size = size;
+        *b = mbox;
+    }
+    return *b != NULL;
+}
+
+uint8_t
+esp_sys_mbox_delete(esp_sys_mbox_t* b) {
+    esp_sys_mbox_t mbox = *b;
+
+    if (mbox->cnt > 0) {
+        return 0;
+    }
+    pthread_cond_destroy(&mbox->not_full);
+    pthread_cond_destroy(&mbox->not_empty);
+    pthread_mutex_destroy(&mbox->mutex);
+    free(mbox);
+    return 1;
+}
+
+/**
+ * \brief           Write entry to queue, mutex must be locked and queue not full
+ * \param[in]       mbox: Message box
+ * \param[in]       m: Entry to write
+ */
+static void
+mbox_write(esp_sys_mbox_t mbox, void* m) {
+    mbox->entries[mbox->in] = m;
+    if (++mbox->in >= mbox->size) {
+        mbox->in = 0;
+    }
+    ++mbox->cnt;
+    pthread_cond_signal(&mbox->not_empty);
+}
+
+/**
+ * \brief           Read entry from queue, mutex must be locked and queue not empty
+ * \param[in]       mbox: Message box
+ * \param[out]      m: Output entry
+ */
+static void
+mbox_read(esp_sys_mbox_t mbox, void** m) {
+    *m = mbox->entries[mbox->out];
+    if (++mbox->out >= mbox->size) {
+        mbox->out = 0;
+    }
+    --mbox->cnt;
+    pthread_cond_signal(&mbox->not_full);
+}
+
+#if ESP_CFG_OS
+
+uint32_t
+esp_sys_mbox_put(esp_sys_mbox_t* b, void* m) {
+    esp_sys_mbox_t mbox = *b;
+    uint32_t tick = esp_sys_now();
+
+    pthread_mutex_lock(&mbox->mutex);
+    while (mbox->cnt == mbox->size) {
+        pthread_cond_wait(&mbox->not_full, &mbox->mutex);
+    }
+    mbox_write(mbox, m);
+    pthread_mutex_unlock(&mbox->mutex);
+    return esp_sys_now() - tick;
+}
+
+uint32_t
+esp_sys_mbox_get(esp_sys_mbox_t* b, void** m, uint32_t timeout) {
+    esp_sys_mbox_t mbox = *b;
+    struct timespec ts;
+    uint32_t tick = esp_sys_now();
+    uint8_t ok = 1;
+
+    if (timeout > 0) {
+        timeout_to_abstime(&ts, timeout);
+    }
+    pthread_mutex_lock(&mbox->mutex);
+    while (mbox->cnt == 0 && ok) {
+        ok = cond_wait(&mbox->not_empty, &mbox->mutex, timeout > 0 ? &ts : NULL);
+    }
+    ok = mbox->cnt > 0;
+    if (ok) {
+        mbox_read(mbox, m);
+    }
+    pthread_mutex_unlock(&mbox->mutex);
+    return ok ? (esp_sys_now() - tick) : ESP_SYS_TIMEOUT;
+}
+
+#endif /* ESP_CFG_OS */
+
+uint8_t
+esp_sys_mbox_putnow(esp_sys_mbox_t* b, void* m) {
+    esp_sys_mbox_t mbox = *b;
+    uint8_t res = 0;
+
+    pthread_mutex_lock(&mbox->mutex);
+    if (mbox->cnt < mbox->size) {
+        mbox_write(mbox, m);
+        res = 1;
+    }
+    pthread_mutex_unlock(&mbox->mutex);
+    return res;
+}
+
+uint8_t
+esp_sys_mbox_getnow(esp_sys_mbox_t* b, void** m) {
+    esp_sys_mbox_t mbox = *b;
+    uint8_t res = 0;
+
+    pthread_mutex_lock(&mbox->mutex);
+    if (mbox->cnt > 0) {
+        mbox_read(mbox, m);
+        res = 1;
+    }
+    pthread_mutex_unlock(&mbox->mutex);
+    return res;
+}
+
+uint8_t
+esp_sys_mbox_isvalid(esp_sys_mbox_t* b) {
+    return b != NULL && *b != NULL;
+}
+
+uint8_t
+esp_sys_mbox_invalid(esp_sys_mbox_t* b) {
+    *b = ESP_SYS_MBOX_NULL;
+    return 1;
+}
+
+#if ESP_CFG_OS
+
+/**
+ * \brief           Thread start information
+ */
+typedef struct {
+    esp_sys_thread_fn fn;
+    void* arg;
+} posix_thread_start_t;
+
+/**
+ * \brief           Thread entry wrapper, pthreads expect different prototype
+ * \param[in]       param: Pointer to \ref posix_thread_start_t structure
+ */
+static void*
+thread_entry(void* param) {
+    posix_thread_start_t start = *(posix_thread_start_t *)param;
+
+    free(param);
+    start.fn(start.arg);
+    return NULL;
+}
+
+uint8_t
+esp_sys_thread_create(esp_sys_thread_t* t, const char* name, esp_sys_thread_fn thread_func, void* const arg, size_t stack_size, esp_sys_thread_prio_t prio) {
+    pthread_attr_t attr;
+    posix_thread_start_t* start;
+    pthread_t* id;
+    uint8_t res;
+
+    (void)prio;
+    start = malloc(sizeof(*start));
+    id = malloc(sizeof(*id));
+    if (start == NULL || id == NULL) {
+        free(start);
+        free(id);
+        return 0;
+    }
+    start->fn = thread_func;
+    start->arg = arg;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (stack_size > 0) {
+        pthread_attr_setstacksize(&attr, stack_size);
+    }
+    res = pthread_create(id, &attr, thread_entry, start) == 0;
+    pthread_attr_destroy(&attr);
+    if (!res) {
+        free(start);
+        free(id);
+        id = NULL;
+    }
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    else if (name != NULL) {
+        pthread_setname_np(*id, name);
+    }
+#else
+    (void)name;
+#endif /* defined(__linux__) && defined(_GNU_SOURCE) */
+    if (t != NULL) {
+        *t = id;
+    } else {
+        free(id);                               /* Handle not needed */
+    }
+    return res;
+}
+
+uint8_t
+esp_sys_thread_terminate(esp_sys_thread_t* t) {
+    if (t == NULL) {                            /* Shall we terminate ourself? */
+        pthread_exit(NULL);
+    }
+    if (*t != NULL) {
+        pthread_cancel(**t);
+        free(*t);
+        *t = NULL;
+    }
+    return 1;
+}
+
+uint8_t
+esp_sys_thread_yield(void) {
+    sched_yield();
+    return 1;
+}
+
+#if ESP_CFG_THREAD_STATS
+
+size_t
+esp_sys_thread_stack_free(esp_sys_thread_t* t) {
+    (void)t;
+    return 0;                                   /* Not supported by port */
+}
+
+#endif /* ESP_CFG_THREAD_STATS */
+
+#endif /* ESP_CFG_OS */
+#endif /* !__DOXYGEN__ */
@@ -394,3 +394,59 @@ esp_sys_thread_yield(void) {
     osThreadYield();
     return 1;
 }
+
+#if ESP_CFG_SYS_THREAD_NOTIFY || __DOXYGEN__
+
+/**
+ * \brief           Notify thread waiting in \ref esp_sys_thread_notify_wait
+ * \note            This function is required with \ref ESP_CFG_SYS_THREAD_NOTIFY
+ *
+ * \note            Notification must be latched if thread is not waiting at the moment
+ * \param[in]       t: Pointer to thread handle to notify
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_sys_thread_notify(esp_sys_thread_t* t) {
+    return (osSignalSet(*t, 0x01) & 0x80000000U) == 0;
+}
+
+/**
+ * \brief           Wait for notification to current thread
+ * \note            This function is required with \ref ESP_CFG_SYS_THREAD_NOTIFY
+ * \param[in]       timeout: Timeout to wait in milliseconds. When `0` is applied, wait forever
+ * \return          Number of milliseconds waited for notification to arrive or \ref ESP_SYS_TIMEOUT
+ */
+uint32_t
+esp_sys_thread_notify_wait(uint32_t timeout) {
+    uint32_t tick = osKernelSysTick();
+    return osSignalWait(0x01, timeout == 0 ? osWaitForever : timeout).status == osEventSignal ? (osKernelSysTick() - tick) : ESP_SYS_TIMEOUT;
+}
+
+/**
+ * \brief           Clear pending notification of current thread
+ * \note            This function is required with \ref ESP_CFG_SYS_THREAD_NOTIFY
+ * \return          `1` on success, `0` otherwise
+ */
+uint8_t
+esp_sys_thread_notify_clear(void) {
+    osSignalClear(osThreadGetId(), 0x01);
+    return 1;
+}
+
+#endif /* ESP_CFG_SYS_THREAD_NOTIFY || __DOXYGEN__ */
+
+#if ESP_CFG_THREAD_STATS || __DOXYGEN__
+
+/**
+ * \brief           Get minimal amount of unused stack since thread was created
+ * \note            This function is required with \ref ESP_CFG_THREAD_STATS
+ * \param[in]       t: Pointer to thread handle
+ * \return          Stack high-water mark as number of never used bytes, `0` when not supported
+ */
+size_t
+esp_sys_thread_stack_free(esp_sys_thread_t* t) {
+    (void)t;
+    return 0;                                   /* CMSIS-OS v1 cannot report stack usage */
+}
+
+#endif /* ESP_CFG_THREAD_STATS || __DOXYGEN__ */
@@ -365,5 +365,15 @@ esp_sys_thread_yield(void) {
     return 1;
 }
 
+#if ESP_CFG_THREAD_STATS
+
+size_t
+esp_sys_thread_stack_free(esp_sys_thread_t* t) {
+    (void)t;
+    return 0;                                   /* Not supported by port */
+}
+
+#endif /* ESP_CFG_THREAD_STATS */
+
 #endif /* ESP_CFG_OS */
 #endif /* !__DOXYGEN__ */
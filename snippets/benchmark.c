@@ -0,0 +1,177 @@
+#include "benchmark.h"
+#include "esp/esp.h"
+#include "esp/esp_mem.h"
+#include "system/esp_ll_sim.h"
+
+/**
+ * \brief           Benchmark settings
+ * \note            Application must be built with `system/esp_ll_sim.c` as low-level file
+ */
+#define BENCHMARK_HOST          "192.168.0.100"
+#define BENCHMARK_PORT          80
+#define BENCHMARK_PACKET_LEN    1024
+#define BENCHMARK_PACKET_CNT    512
+
+/**
+ * \brief           Packet data to send in both directions
+ */
+static uint8_t
+packet[BENCHMARK_PACKET_LEN];
+
+/**
+ * \brief           Connection number used by injector thread
+ */
+static int8_t
+conn_num;
+
+/**
+ * \brief           Get number of successful allocations since start
+ * \return          Number of allocations or `0` when \ref ESP_CFG_MEM_STATS is disabled
+ */
+static size_t
+get_alloc_total(void) {
+#if ESP_CFG_MEM_STATS
+    esp_mem_stats_t stats;
+    if (esp_mem_get_stats(&stats)) {
+        return stats.alloc_total;
+    }
+#endif /* ESP_CFG_MEM_STATS */
+    return 0;
+}
+
+/**
+ * \brief           Print benchmark result
+ * \param[in]       name: Benchmark name
+ * \param[in]       bytes: Number of transferred bytes
+ * \param[in]       time: Elapsed time in units of milliseconds
+ * \param[in]       allocs: Number of allocations during benchmark
+ */
+static void
+print_result(const char* name, size_t bytes, uint32_t time, size_t allocs) {
+    if (time == 0) {
+        time = 1;
+    }
+    printf("%s: %u bytes in %u ms, %u bytes/s, %u.%03u allocs/kB\r\n", name,
+        (unsigned)bytes, (unsigned)time, (unsigned)((bytes * 1000ULL) / time),
+        (unsigned)((allocs * 1024ULL) / bytes), (unsigned)(((allocs * 1024000ULL) / bytes) % 1000));
+}
+
+/**
+ * \brief           Injector thread, simulates remote side sending data to device
+ * \param[in]       arg: User argument
+ */
+static void
+injector_thread(void* const arg) {
+    ESP_UNUSED(arg);
+    for (size_t i = 0; i < BENCHMARK_PACKET_CNT; ++i) {
+        if (esp_ll_sim_inject_ipd((uint8_t)conn_num, packet, sizeof(packet)) != espOK) {
+            printf("Cannot inject packet %u\r\n", (unsigned)i);
+            break;
+        }
+    }
+    esp_sys_thread_terminate(NULL);             /* Terminate current thread */
+}
+
+/**
+ * \brief           Measure receive path: parser, packet buffers and netconn queue
+ * \param[in]       nc: Connected netconn
+ */
+static void
+benchmark_receive(esp_netconn_p nc) {
+    esp_pbuf_p pbuf;
+    size_t total = 0, allocs;
+    uint32_t time;
+
+    allocs = get_alloc_total();
+    time = esp_sys_now();
+    if (!esp_sys_thread_create(NULL, "bench_inj", injector_thread, NULL, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+        printf("Cannot create injector thread\r\n");
+        return;
+    }
+    while (total < BENCHMARK_PACKET_CNT * BENCHMARK_PACKET_LEN) {
+        if (esp_netconn_receive(nc, &pbuf) != espOK) {
+            printf("Receive failed after %u bytes\r\n", (unsigned)total);
+            return;
+        }
+        total += esp_pbuf_length(pbuf, 1);
+        esp_pbuf_free(pbuf);
+    }
+    time = esp_sys_now() - time;
+    print_result("RX", total, time, get_alloc_total() - allocs);
+}
+
+/**
+ * \brief           Measure send path: netconn write buffer and CIPSEND sequence
+ * \param[in]       nc: Connected netconn
+ */
+static void
+benchmark_send(esp_netconn_p nc) {
+    esp_ll_sim_stats_t stats;
+    size_t total = BENCHMARK_PACKET_CNT * BENCHMARK_PACKET_LEN, start, allocs;
+    uint32_t time;
+
+    esp_ll_sim_get_stats(&stats);
+    start = stats.send_bytes;
+    allocs = get_alloc_total();
+    time = esp_sys_now();
+    for (size_t i = 0; i < BENCHMARK_PACKET_CNT; ++i) {
+        if (esp_netconn_write(nc, packet, sizeof(packet)) != espOK) {
+            printf("Write failed at packet %u\r\n", (unsigned)i);
+            return;
+        }
+    }
+    if (esp_netconn_flush(nc) != espOK) {
+        printf("Flush failed\r\n");
+        return;
+    }
+    do {                                        /* Wait for device to receive all data */
+        esp_ll_sim_get_stats(&stats);
+        if (stats.send_bytes - start >= total) {
+            break;
+        }
+        esp_delay(1);
+    } while (1);
+    time = esp_sys_now() - time;
+    print_result("TX", total, time, get_alloc_total() - allocs);
+}
+
+/**
+ * \brief           Benchmark thread implementation
+ * \param[in]       arg: User argument
+ */
+void
+benchmark_thread(void const* arg) {
+    esp_netconn_p nc;
+
+    ESP_UNUSED(arg);
+
+    /* Fill packet with known pattern */
+    for (size_t i = 0; i < sizeof(packet); ++i) {
+        packet[i] = (uint8_t)('A' + (i % 26));
+    }
+
+    /*
+     * Run without wire delay and latency first
+     * to measure stack overhead only
+     */
+    esp_ll_sim_set_timing(0, 0);
+
+    nc = esp_netconn_new(ESP_NETCONN_TYPE_TCP);
+    if (nc != NULL) {
+        if (esp_netconn_connect(nc, BENCHMARK_HOST, BENCHMARK_PORT) == espOK) {
+            conn_num = esp_netconn_getconnnum(nc);
+            benchmark_receive(nc);
+            benchmark_send(nc);
+
+            /* Repeat with emulated wire speed of 921600 bauds */
+            esp_ll_sim_set_timing(921600, 1);
+            benchmark_receive(nc);
+            benchmark_send(nc);
+            esp_netconn_close(nc);
+        } else {
+            printf("Cannot connect to simulated device\r\n");
+        }
+        esp_netconn_delete(nc);
+    }
+    esp_sys_thread_terminate(NULL);             /* Terminate current thread */
+}
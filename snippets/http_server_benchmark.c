@@ -0,0 +1,239 @@
+#include "http_server_benchmark.h"
+#include "esp/esp.h"
+#include "esp/apps/esp_http_server.h"
+#include "system/esp_ll_sim.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * \brief           HTTP server benchmark settings
+ * \note            Application must be built with `system/esp_ll_sim.c` as low-level file,
+ *                  requests are generated by remote peer of simulated device.
+ *                  Files are served from built-in file table, which contains `www/` assets
+ */
+#define BENCH_PORT              80
+#define BENCH_CONN              0               /* Connection number used for requests */
+#define BENCH_REQ_CNT           100             /* Number of requests per route */
+#define BENCH_POST_LEN          1024            /* Length of POST request body */
+#define BENCH_TIMEOUT           2000            /* Response timeout in units of milliseconds */
+
+/**
+ * \brief           Request and response state shared with remote peer
+ */
+typedef struct {
+    esp_sys_sem_t sem;                          /*!< Semaphore released when server closed connection */
+    size_t resp_bytes;                          /*!< Number of response bytes of current request */
+    size_t total_bytes;                         /*!< Number of response bytes of all requests */
+    uint8_t ok;                                 /*!< Set to `1` when response status is `200` */
+} bench_state_t;
+
+/**
+ * \brief           Benchmark state
+ */
+static bench_state_t
+state;
+
+/**
+ * \brief           Request buffer
+ */
+static char
+req[256 + BENCH_POST_LEN];
+
+/**
+ * \brief           SSI callback, replaces tags in `index.shtml`
+ * \param[in]       hs: HTTP state
+ * \param[in]       tag_name: Name of tag
+ * \param[in]       tag_len: Length of tag
+ * \return          `1` if everything written for specific tag
+ */
+static size_t
+http_ssi_cb(http_state_t* hs, const char* tag_name, size_t tag_len) {
+    if (!strncmp(tag_name, "title", tag_len)) {
+        esp_http_server_write_string(hs, "ESP benchmark");
+    }
+    return 1;
+}
+
+#if HTTP_SUPPORT_POST
+
+/**
+ * \brief           Callback function indicating post request method started
+ * \param[in]       hs: HTTP state
+ * \param[in]       uri: NULL-terminated uri string for POST request
+ * \param[in]       content_len: Total content length received by "Content-Length" header
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+http_post_start_cb(http_state_t* hs, const char* uri, uint32_t content_len) {
+    ESP_UNUSED(hs);
+    ESP_UNUSED(uri);
+    ESP_UNUSED(content_len);
+    return espOK;
+}
+
+/**
+ * \brief           Callback function indicating post request data received
+ * \param[in]       hs: HTTP state
+ * \param[in]       pbuf: New chunk of received data
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+http_post_data_cb(http_state_t* hs, esp_pbuf_p pbuf) {
+    ESP_UNUSED(hs);
+    ESP_UNUSED(pbuf);
+    return espOK;
+}
+
+/**
+ * \brief           Callback function indicating post request finished
+ * \param[in]       hs: HTTP state
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+http_post_end_cb(http_state_t* hs) {
+    ESP_UNUSED(hs);
+    return espOK;
+}
+
+#endif /* HTTP_SUPPORT_POST */
+
+/**
+ * \brief           HTTP init structure
+ */
+static const http_init_t
+http_init = {
+#if HTTP_SUPPORT_POST
+    .post_start_fn = http_post_start_cb,
+    .post_data_fn = http_post_data_cb,
+    .post_end_fn = http_post_end_cb,
+#endif /* HTTP_SUPPORT_POST */
+    .ssi_fn = http_ssi_cb,
+};
+
+/**
+ * \brief           Remote peer of simulated device, HTTP client
+ * \param[in]       conn: Connection number
+ * \param[in]       data: Response data, `NULL` when server closed connection
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+client_peer_fn(uint8_t conn, const void* data, size_t len) {
+    if (conn != BENCH_CONN) {
+        return;
+    }
+    if (data == NULL) {                         /* Response is complete */
+        state.total_bytes += state.resp_bytes;
+        esp_sys_sem_release(&state.sem);
+        return;
+    }
+    if (state.resp_bytes == 0 && len >= 12
+        && (!strncmp(data, "HTTP/1.1 200", 12) || !strncmp(data, "HTTP/1.0 200", 12))) {
+        state.ok = 1;
+    }
+    state.resp_bytes += len;
+}
+
+/**
+ * \brief           Print result as JSON line, with configuration for comparing profiles
+ * \param[in]       route: Route name
+ * \param[in]       cnt: Number of successful requests
+ * \param[in]       failed: Number of failed requests
+ * \param[in]       time: Elapsed time in units of milliseconds
+ */
+static void
+print_result(const char* route, size_t cnt, size_t failed, uint32_t time) {
+    uint32_t t = time > 0 ? time : 1;
+
+    printf("{\"bench\":\"http\",\"route\":\"%s\",\"requests\":%u,\"failed\":%u,\"time_ms\":%u,"
+        "\"req_per_s\":%u,\"resp_bytes_per_s\":%u,\"conn_max_data_len\":%d,\"ipd_max_buff_size\":%d,\"rcv_buff_size\":%d}\r\n",
+        route, (unsigned)cnt, (unsigned)failed, (unsigned)time,
+        (unsigned)((cnt * 1000ULL) / t), (unsigned)((state.total_bytes * 1000ULL) / t),
+        (int)ESP_CFG_CONN_MAX_DATA_LEN, (int)ESP_CFG_IPD_MAX_BUFF_SIZE, (int)ESP_CFG_RCV_BUFF_SIZE);
+}
+
+/**
+ * \brief           Send request on new connection and wait for server to close it
+ * \param[in]       len: Length of request in \ref req buffer
+ * \return          `1` on success, `0` otherwise
+ */
+static uint8_t
+benchmark_request(size_t len) {
+    state.resp_bytes = 0;
+    state.ok = 0;
+    if (esp_ll_sim_accept(BENCH_CONN, BENCH_PORT) != espOK
+        || esp_ll_sim_inject_ipd(BENCH_CONN, req, len) != espOK) {
+        return 0;
+    }
+    if (esp_sys_sem_wait(&state.sem, BENCH_TIMEOUT) == ESP_SYS_TIMEOUT) {
+        esp_ll_sim_close(BENCH_CONN);           /* Close on remote side and wait for stack to process it */
+        esp_delay(100);
+        return 0;
+    }
+    return state.ok;
+}
+
+/**
+ * \brief           Measure requests per second for single route
+ * \param[in]       route: Route name
+ * \param[in]       len: Length of request in \ref req buffer
+ */
+static void
+benchmark_route(const char* route, size_t len) {
+    size_t cnt = 0, failed = 0;
+    uint32_t time;
+
+    state.total_bytes = 0;
+    time = esp_sys_now();
+    for (size_t i = 0; i < BENCH_REQ_CNT; ++i) {
+        if (benchmark_request(len)) {
+            ++cnt;
+        } else {
+            ++failed;
+        }
+    }
+    time = esp_sys_now() - time;
+    print_result(route, cnt, failed, time);
+}
+
+/**
+ * \brief           HTTP server benchmark thread implementation
+ * \param[in]       arg: User argument
+ */
+void
+http_server_benchmark_thread(void const* arg) {
+    esp_ll_sim_stats_t stats;
+    int len;
+
+    ESP_UNUSED(arg);
+
+    if (!esp_sys_sem_create(&state.sem, 0)) {
+        goto terminate;
+    }
+    esp_ll_sim_set_timing(0, 0);                /* Measure stack overhead only */
+    esp_ll_sim_set_peer(client_peer_fn);
+    if (esp_http_server_init(&http_init, BENCH_PORT) != espOK) {
+        printf("Cannot start HTTP server\r\n");
+        goto terminate;
+    }
+
+    len = sprintf(req, "GET /index.html HTTP/1.1\r\nHost: esp\r\nConnection: close\r\n\r\n");
+    benchmark_route("static", (size_t)len);
+
+    len = sprintf(req, "GET /index.shtml HTTP/1.1\r\nHost: esp\r\nConnection: close\r\n\r\n");
+    benchmark_route("ssi", (size_t)len);
+
+#if HTTP_SUPPORT_POST
+    len = sprintf(req, "POST /index.html HTTP/1.1\r\nHost: esp\r\nContent-Type: application/octet-stream\r\n"
+        "Content-Length: %d\r\nConnection: close\r\n\r\n", BENCH_POST_LEN);
+    memset(&req[len], 'A', BENCH_POST_LEN);
+    benchmark_route("post", (size_t)len + BENCH_POST_LEN);
+#endif /* HTTP_SUPPORT_POST */
+
+    esp_ll_sim_get_stats(&stats);
+    printf("{\"bench\":\"sim\",\"cmd_cnt\":%u,\"send_cnt\":%u,\"peer_drop_cnt\":%u}\r\n",
+        (unsigned)stats.cmd_cnt, (unsigned)stats.send_cnt, (unsigned)stats.peer_drop_cnt);
+
+terminate:
+    esp_ll_sim_set_peer(NULL);
+    esp_sys_thread_terminate(NULL);             /* Terminate current thread */
+}
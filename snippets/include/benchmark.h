@@ -0,0 +1,14 @@
+#ifndef __BENCHMARK_H
+#define __BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void benchmark_thread(void const* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
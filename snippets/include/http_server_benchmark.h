@@ -0,0 +1,14 @@
+#ifndef __HTTP_SERVER_BENCHMARK_H
+#define __HTTP_SERVER_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void http_server_benchmark_thread(void const* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
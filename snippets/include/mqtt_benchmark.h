@@ -0,0 +1,14 @@
+#ifndef __MQTT_BENCHMARK_H
+#define __MQTT_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mqtt_benchmark_thread(void const* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
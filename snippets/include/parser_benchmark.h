@@ -0,0 +1,16 @@
+#ifndef __PARSER_BENCHMARK_H
+#define __PARSER_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+void parser_benchmark_run(const void* trace, size_t trace_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,27 @@ extern "C" {
 #include <stdint.h>
 #include "esp/esp.h"
 
+/**
+ * \brief           Roam when RSSI of current access point is weaker than this value
+ */
+#ifndef STATION_MANAGER_ROAM_RSSI
+#define STATION_MANAGER_ROAM_RSSI           -75
+#endif
+
+/**
+ * \brief           Minimal RSSI improvement of new access point, to prevent roaming back and forth
+ */
+#ifndef STATION_MANAGER_ROAM_HYSTERESIS
+#define STATION_MANAGER_ROAM_HYSTERESIS     8
+#endif
+
+/**
+ * \brief           Time between RSSI samples in roaming thread, in units of milliseconds
+ */
+#ifndef STATION_MANAGER_ROAM_INTERVAL
+#define STATION_MANAGER_ROAM_INTERVAL       10000
+#endif
+
 /**
  * \brief           Lookup table for preferred SSIDs with password for auto connect feature
  */
@@ -16,8 +37,29 @@ typedef struct {
     const char* pass;
 } ap_entry_t;
 
+/**
+ * \brief           Last access point station was successfully connected to
+ *
+ * Used as hint for fast reconnect. Application may keep it in retained memory
+ * and restore it after wake-up with \ref station_manager_set_last_ap
+ */
+typedef struct {
+    uint8_t valid;                              /*!< Set to `1` when structure holds valid data */
+    size_t index;                               /*!< Index in preferred access points list */
+    esp_mac_t mac;                              /*!< BSSID of access point */
+    uint8_t ch;                                 /*!< Channel of access point */
+    esp_ip_t ip;                                /*!< Station IP address */
+    esp_ip_t gw;                                /*!< Gateway address */
+    esp_ip_t nm;                                /*!< Netmask */
+} last_ap_t;
+
 espr_t      connect_to_preferred_access_point(uint8_t unlimited);
+espr_t      connect_to_last_access_point(void);
+void        station_manager_get_last_ap(last_ap_t* ap);
+void        station_manager_set_last_ap(const last_ap_t* ap);
 void        start_access_point_scan_and_connect_procedure(void);
+espr_t      station_manager_roam(void);
+void        station_manager_roam_thread(void* arg);
 
 #ifdef __cplusplus
 }
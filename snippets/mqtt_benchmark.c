@@ -0,0 +1,250 @@
+#include "mqtt_benchmark.h"
+#include "esp/esp.h"
+#include "esp/apps/esp_mqtt_client_api.h"
+#include "system/esp_ll_sim.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * \brief           MQTT benchmark settings
+ * \note            Application must be built with `system/esp_ll_sim.c` as low-level file,
+ *                  simulated device is connected to loopback broker implemented below
+ */
+#define BENCH_HOST              "192.168.0.100"
+#define BENCH_PORT              1883
+#define BENCH_TOPIC             "esp/bench"
+#define BENCH_BUFF_LEN          1280            /* Client TX and RX buffer, must fit largest payload */
+#define BENCH_MSG_CNT           200             /* Number of messages per case */
+#define BENCH_TIMEOUT           2000            /* Echo receive timeout in units of milliseconds */
+
+/**
+ * \brief           Payload sizes to measure
+ */
+static const size_t
+payload_sizes[] = { 16, 256, 1024 };
+
+/**
+ * \brief           Payload data
+ */
+static uint8_t
+payload[1024];
+
+/**
+ * \brief           Loopback broker receive buffer, completed packets are removed from it
+ */
+static uint8_t
+broker_rx[BENCH_BUFF_LEN + 16];
+
+/**
+ * \brief           Number of bytes in loopback broker receive buffer
+ */
+static size_t
+broker_rx_len;
+
+/**
+ * \brief           Connection information for MQTT CONNECT packet
+ */
+static const esp_mqtt_client_info_t
+mqtt_client_info = {
+    .id = "esp_benchmark",
+    .keep_alive = 60,
+};
+
+/**
+ * \brief           Send MQTT acknowledge packet with packet identifier from broker
+ * \param[in]       conn: Connection number
+ * \param[in]       hdr: First byte of fixed header
+ * \param[in]       pkt_id: Packet identifier
+ */
+static void
+broker_send_ack(uint8_t conn, uint8_t hdr, uint16_t pkt_id) {
+    uint8_t ack[4] = { hdr, 0x02, (uint8_t)(pkt_id >> 8), (uint8_t)pkt_id };
+    esp_ll_sim_inject_ipd(conn, ack, sizeof(ack));
+}
+
+/**
+ * \brief           Process complete packet in loopback broker
+ *
+ *                  Every publish is acknowledged with flow of its QoS
+ *                  and sent back to client, as it subscribed to the same topic
+ *
+ * \param[in]       conn: Connection number
+ * \param[in]       pkt: Complete packet with fixed header
+ * \param[in]       hdr_len: Length of fixed header
+ * \param[in]       rem_len: Remaining length after fixed header
+ */
+static void
+broker_process(uint8_t conn, uint8_t* pkt, size_t hdr_len, size_t rem_len) {
+    const uint8_t* d = &pkt[hdr_len];
+    uint16_t pkt_id = rem_len >= 2 ? (uint16_t)((d[0] << 8) | d[1]) : 0;
+
+    switch (pkt[0] >> 4) {
+        case 0x01: {                            /* CONNECT */
+            static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+            esp_ll_sim_inject_ipd(conn, connack, sizeof(connack));
+            break;
+        }
+        case 0x03: {                            /* PUBLISH */
+            uint8_t qos = (pkt[0] >> 1) & 0x03;
+            size_t topic_len = rem_len >= 2 ? (size_t)((d[0] << 8) | d[1]) : 0;
+
+            if (qos > 0 && rem_len >= topic_len + 4) {
+                pkt_id = (uint16_t)((d[2 + topic_len] << 8) | d[3 + topic_len]);
+                broker_send_ack(conn, qos == 1 ? 0x40 : 0x50, pkt_id);  /* PUBACK or PUBREC */
+            }
+            pkt[0] &= ~0x08;                    /* Clear DUP flag and deliver to subscriber */
+            esp_ll_sim_inject_ipd(conn, pkt, hdr_len + rem_len);
+            break;
+        }
+        case 0x05:                              /* PUBREC for delivered QoS 2 publish */
+            broker_send_ack(conn, 0x62, pkt_id);/* PUBREL */
+            break;
+        case 0x06:                              /* PUBREL for received QoS 2 publish */
+            broker_send_ack(conn, 0x70, pkt_id);/* PUBCOMP */
+            break;
+        case 0x08: {                            /* SUBSCRIBE, grant requested QoS */
+            uint8_t suback[5] = { 0x90, 0x03, (uint8_t)(pkt_id >> 8), (uint8_t)pkt_id, pkt[hdr_len + rem_len - 1] & 0x03 };
+            esp_ll_sim_inject_ipd(conn, suback, sizeof(suback));
+            break;
+        }
+        case 0x0C: {                            /* PINGREQ */
+            static const uint8_t pingresp[] = { 0xD0, 0x00 };
+            esp_ll_sim_inject_ipd(conn, pingresp, sizeof(pingresp));
+            break;
+        }
+        case 0x0E:                              /* DISCONNECT */
+            esp_ll_sim_close(conn);
+            break;
+        default:                                /* PUBACK, PUBCOMP, ... need no answer */
+            break;
+    }
+}
+
+/**
+ * \brief           Remote peer of simulated device, loopback MQTT broker
+ * \param[in]       conn: Connection number
+ * \param[in]       data: Data sent by client, `NULL` when connection was closed
+ * \param[in]       len: Length of data in units of bytes
+ */
+static void
+broker_peer_fn(uint8_t conn, const void* data, size_t len) {
+    size_t pos = 0, hdr_len, rem_len;
+    uint8_t shift;
+
+    if (data == NULL || len > sizeof(broker_rx) - broker_rx_len) {
+        broker_rx_len = 0;                      /* Connection closed or packet too long */
+        return;
+    }
+    ESP_MEMCPY(&broker_rx[broker_rx_len], data, len);
+    broker_rx_len += len;
+
+    /* Process all complete packets */
+    while (broker_rx_len - pos >= 2) {
+        rem_len = 0;
+        shift = 0;
+        for (hdr_len = 1; hdr_len < 5 && pos + hdr_len < broker_rx_len; ++hdr_len) {
+            rem_len |= (size_t)(broker_rx[pos + hdr_len] & 0x7F) << shift;
+            shift += 7;
+            if (!(broker_rx[pos + hdr_len] & 0x80)) {
+                break;
+            }
+        }
+        ++hdr_len;                              /* Include last length byte */
+        if (pos + hdr_len + rem_len > broker_rx_len) {
+            break;                              /* Wait for more data */
+        }
+        broker_process(conn, &broker_rx[pos], hdr_len, rem_len);
+        pos += hdr_len + rem_len;
+    }
+    if (pos > 0) {
+        memmove(broker_rx, &broker_rx[pos], broker_rx_len - pos);
+        broker_rx_len -= pos;
+    }
+}
+
+/**
+ * \brief           Print result as JSON line, with configuration for comparing profiles
+ * \param[in]       qos: Quality of service
+ * \param[in]       len: Payload length
+ * \param[in]       cnt: Number of completed round trips
+ * \param[in]       time: Elapsed time in units of milliseconds
+ */
+static void
+print_result(esp_mqtt_qos_t qos, size_t len, size_t cnt, uint32_t time) {
+    uint32_t t = time > 0 ? time : 1;
+
+    printf("{\"bench\":\"mqtt\",\"qos\":%d,\"payload\":%u,\"msgs\":%u,\"time_ms\":%u,"
+        "\"msgs_per_s\":%u,\"bytes_per_s\":%u,\"conn_max_data_len\":%d,\"ipd_max_buff_size\":%d,\"rcv_buff_size\":%d}\r\n",
+        (int)qos, (unsigned)len, (unsigned)cnt, (unsigned)time,
+        (unsigned)((cnt * 1000ULL) / t), (unsigned)((cnt * len * 1000ULL) / t),
+        (int)ESP_CFG_CONN_MAX_DATA_LEN, (int)ESP_CFG_IPD_MAX_BUFF_SIZE, (int)ESP_CFG_RCV_BUFF_SIZE);
+}
+
+/**
+ * \brief           Measure publish and echo round trips for single case
+ * \param[in]       client: Connected MQTT API client
+ * \param[in]       qos: Quality of service
+ * \param[in]       len: Payload length
+ */
+static void
+benchmark_case(esp_mqtt_client_api_p client, esp_mqtt_qos_t qos, size_t len) {
+    esp_mqtt_client_api_buf_p buf;
+    uint32_t time;
+    size_t cnt;
+
+    time = esp_sys_now();
+    for (cnt = 0; cnt < BENCH_MSG_CNT; ++cnt) {
+        if (esp_mqtt_client_api_publish(client, BENCH_TOPIC, payload, len, qos, 0) != espOK
+            || esp_mqtt_client_api_receive(client, &buf, BENCH_TIMEOUT) != espOK) {
+            break;
+        }
+        if (buf != NULL) {
+            esp_mqtt_client_api_buf_free(buf);
+        }
+    }
+    time = esp_sys_now() - time;
+    print_result(qos, len, cnt, time);
+}
+
+/**
+ * \brief           MQTT benchmark thread implementation
+ * \param[in]       arg: User argument
+ */
+void
+mqtt_benchmark_thread(void const* arg) {
+    esp_mqtt_client_api_p client;
+    esp_ll_sim_stats_t stats;
+
+    ESP_UNUSED(arg);
+
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = (uint8_t)('A' + (i % 26));
+    }
+    esp_ll_sim_set_timing(0, 0);                /* Measure stack overhead only */
+    esp_ll_sim_set_peer(broker_peer_fn);
+    if (!esp_sta_has_ip()) {
+        esp_sta_join("esp_sim", "esp_sim", NULL, NULL, NULL, 1);
+    }
+
+    client = esp_mqtt_client_api_new(BENCH_BUFF_LEN, BENCH_BUFF_LEN);
+    if (client != NULL) {
+        if (esp_mqtt_client_api_connect(client, BENCH_HOST, BENCH_PORT, &mqtt_client_info) == ESP_MQTT_CONN_STATUS_ACCEPTED
+            && esp_mqtt_client_api_subscribe(client, BENCH_TOPIC, ESP_MQTT_QOS_EXACTLY_ONCE) == espOK) {
+            for (size_t q = 0; q < 3; ++q) {
+                for (size_t i = 0; i < ESP_ARRAYSIZE(payload_sizes); ++i) {
+                    benchmark_case(client, (esp_mqtt_qos_t)q, payload_sizes[i]);
+                }
+            }
+            esp_mqtt_client_api_close(client);
+        } else {
+            printf("Cannot connect to loopback broker\r\n");
+        }
+        esp_mqtt_client_api_delete(client);
+    }
+
+    esp_ll_sim_get_stats(&stats);
+    printf("{\"bench\":\"sim\",\"cmd_cnt\":%u,\"send_cnt\":%u,\"peer_drop_cnt\":%u}\r\n",
+        (unsigned)stats.cmd_cnt, (unsigned)stats.send_cnt, (unsigned)stats.peer_drop_cnt);
+    esp_ll_sim_set_peer(NULL);
+    esp_sys_thread_terminate(NULL);             /* Terminate current thread */
+}
@@ -0,0 +1,345 @@
+#include "parser_benchmark.h"
+#include "esp/esp.h"
+#include "esp/esp_private.h"
+#include "esp/esp_mem.h"
+#include "esp/esp_capture.h"
+#include <stdio.h>
+
+/**
+ * \brief           Parser benchmark settings
+ * \note            Application should be built with `system/esp_ll_sim.c` as low-level file,
+ *                  real device could report data to connection numbers used by benchmark
+ */
+#define BENCH_HOST              "192.168.0.100"
+#define BENCH_PORT              80
+#define BENCH_IPD_CONN          0               /* Connection number receiving `+IPD` data */
+#define BENCH_LINK_CONN         (ESP_CFG_MAX_CONNS - 1) /* Connection number opened and closed repeatedly */
+#define BENCH_CHUNK_LEN         128             /* Bytes passed to parser at once, like UART DMA chunks */
+#define BENCH_IPD_SMALL_LEN     16
+#define BENCH_IPD_SMALL_CNT     2048
+#define BENCH_IPD_SEGMENT_CNT   256
+#define BENCH_CWLAP_APS         20
+#define BENCH_CWLAP_SCANS       64
+#define BENCH_LINK_CONN_CNT     256
+
+/*
+ * Cycle counter of the platform
+ *
+ * DWT CYCCNT on Cortex-M3/M4/M7/M33, time stamp counter on x86
+ * and monotonic clock in nanoseconds everywhere else
+ */
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define BENCH_DEMCR             (*(volatile uint32_t *)0xE000EDFCUL)
+#define BENCH_DWT_CTRL          (*(volatile uint32_t *)0xE0001000UL)
+#define BENCH_DWT_CYCCNT        (*(volatile uint32_t *)0xE0001004UL)
+#define BENCH_UNIT              "cycles"
+
+static void
+bench_cycles_init(void) {
+    BENCH_DEMCR |= 1UL << 24;                   /* Enable trace block */
+    BENCH_DWT_CYCCNT = 0;
+    BENCH_DWT_CTRL |= 1UL;                      /* Enable cycle counter */
+}
+
+static uint32_t
+bench_cycles_since(uint32_t start) {
+    return BENCH_DWT_CYCCNT - start;            /* Counter wraps, measured intervals are short */
+}
+#define bench_cycles()          BENCH_DWT_CYCCNT
+typedef uint32_t bench_cycles_t;
+#elif defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else /* defined(_MSC_VER) */
+#include <x86intrin.h>
+#endif /* !defined(_MSC_VER) */
+#define BENCH_UNIT              "cycles"
+#define bench_cycles_init()
+#define bench_cycles()          __rdtsc()
+#define bench_cycles_since(s)   (__rdtsc() - (s))
+typedef uint64_t bench_cycles_t;
+#else
+#include <time.h>
+#define BENCH_UNIT              "ns"
+#define bench_cycles_init()
+
+static uint64_t
+bench_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#define bench_cycles_since(s)   (bench_cycles() - (s))
+typedef uint64_t bench_cycles_t;
+#endif
+
+/**
+ * \brief           Stream buffer, large enough for one pattern repetition
+ */
+static char
+stream[0x2000];
+
+/**
+ * \brief           Result of single benchmark
+ */
+typedef struct {
+    size_t bytes;                               /*!< Number of bytes passed to parser */
+    size_t segments;                            /*!< Number of segments or lines in stream */
+    uint64_t cycles;                            /*!< Cycles spent in parser */
+    size_t allocs;                              /*!< Number of allocations during benchmark */
+} bench_result_t;
+
+/**
+ * \brief           Get number of successful allocations since start
+ * \return          Number of allocations or `0` when \ref ESP_CFG_MEM_STATS is disabled or custom allocator is used
+ */
+static size_t
+get_alloc_total(void) {
+#if ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM
+    esp_mem_stats_t stats;
+    if (esp_mem_get_stats(&stats)) {
+        return stats.alloc_total;
+    }
+#endif /* ESP_CFG_MEM_STATS && !ESP_CFG_MEM_CUSTOM */
+    return 0;
+}
+
+/**
+ * \brief           Pass data to parser in chunks and measure it
+ * \note            Core must be locked, no other thread can enter parser meanwhile
+ * \param[in]       data: Stream data
+ * \param[in]       len: Length of stream in units of bytes
+ * \param[in,out]   res: Result to add measurement to
+ */
+static void
+bench_feed(const void* data, size_t len, bench_result_t* res) {
+    const uint8_t* d = data;
+    bench_cycles_t start;
+    size_t chunk;
+
+    while (len > 0) {
+        chunk = len > BENCH_CHUNK_LEN ? BENCH_CHUNK_LEN : len;
+        start = bench_cycles();
+        espi_process(d, chunk);
+        res->cycles += bench_cycles_since(start);
+        res->bytes += chunk;
+        d += chunk;
+        len -= chunk;
+    }
+}
+
+/**
+ * \brief           Print benchmark result
+ * \param[in]       name: Benchmark name
+ * \param[in]       res: Benchmark result
+ */
+static void
+print_result(const char* name, const bench_result_t* res) {
+    uint64_t per_byte = res->bytes > 0 ? (res->cycles * 100) / res->bytes : 0;
+    uint64_t per_seg = res->segments > 0 ? ((uint64_t)res->allocs * 100) / res->segments : 0;
+
+    printf("%-12s %8u bytes %6u segments %6u.%02u %s/byte %3u.%02u allocs/segment\r\n", name,
+        (unsigned)res->bytes, (unsigned)res->segments,
+        (unsigned)(per_byte / 100), (unsigned)(per_byte % 100), BENCH_UNIT,
+        (unsigned)(per_seg / 100), (unsigned)(per_seg % 100));
+}
+
+/**
+ * \brief           Build `+IPD` stream for benchmark connection
+ * \param[in]       data_len: Length of data in every `+IPD`
+ * \param[in]       cnt: Number of `+IPD` packets to write
+ * \return          Length of stream, `0` when it does not fit buffer
+ */
+static size_t
+build_ipd(size_t data_len, size_t cnt) {
+    size_t len = 0;
+    int n;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        n = snprintf(&stream[len], sizeof(stream) - len, "\r\n+IPD,%d,%u," BENCH_HOST ",%d:",
+            BENCH_IPD_CONN, (unsigned)data_len, BENCH_PORT);
+        if (n < 0 || len + (size_t)n + data_len > sizeof(stream)) {
+            return 0;
+        }
+        len += (size_t)n;
+        for (size_t j = 0; j < data_len; ++j) {
+            stream[len++] = (char)('A' + (j % 26));
+        }
+    }
+    return len;
+}
+
+/**
+ * \brief           Measure `+IPD` parsing, packet buffer allocation and connection callback
+ * \param[in]       name: Benchmark name
+ * \param[in]       data_len: Length of data in every `+IPD`
+ * \param[in]       total_cnt: Number of `+IPD` packets to parse
+ */
+static void
+bench_ipd(const char* name, size_t data_len, size_t total_cnt) {
+    bench_result_t res = { 0 };
+    size_t per_stream, len, allocs;
+
+    per_stream = (sizeof(stream) - 64) / (data_len + 40);
+    if ((len = build_ipd(data_len, per_stream)) == 0) {
+        return;
+    }
+    allocs = get_alloc_total();
+    for (size_t i = 0; i < total_cnt; i += per_stream) {
+        bench_feed(stream, len, &res);
+        res.segments += per_stream;
+    }
+    res.allocs = get_alloc_total() - allocs;
+    print_result(name, &res);
+}
+
+#if ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP
+
+/**
+ * \brief           Measure access point list parsing
+ *
+ *                  Scan command is emulated by active message,
+ *                  which parser fills the same way as during real `AT+CWLAP`
+ */
+static void
+bench_cwlap(void) {
+    static esp_ap_t aps[BENCH_CWLAP_APS];
+    esp_msg_t msg = { 0 }, *old_msg;
+    bench_result_t res = { 0 };
+    size_t len = 0, apf, allocs;
+
+    for (size_t i = 0; i < BENCH_CWLAP_APS; ++i) {
+        len += (size_t)snprintf(&stream[len], sizeof(stream) - len,
+            "+CWLAP:(3,\"benchmark_network_%02u\",-%u,\"a4:cf:12:34:56:%02x\",%u)\r\n",
+            (unsigned)i, 40 + (unsigned)i, (unsigned)i, 1 + (unsigned)(i % 13));
+    }
+
+    msg.cmd_def = msg.cmd = ESP_CMD_WIFI_CWLAP;
+    msg.msg.ap_list.aps = aps;
+    msg.msg.ap_list.apsl = ESP_ARRAYSIZE(aps);
+    msg.msg.ap_list.apf = &apf;
+    old_msg = esp.msg;
+    esp.msg = &msg;
+
+    allocs = get_alloc_total();
+    for (size_t i = 0; i < BENCH_CWLAP_SCANS; ++i) {
+        msg.msg.ap_list.apsi = 0;
+        bench_feed(stream, len, &res);
+        res.segments += BENCH_CWLAP_APS;
+    }
+    res.allocs = get_alloc_total() - allocs;
+    esp.msg = old_msg;
+    print_result("CWLAP", &res);
+}
+
+#endif /* ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP */
+
+/**
+ * \brief           Measure connection state messages on last connection number
+ *
+ *                  Every `+LINK_CONN` opens server connection, which is closed by next line
+ */
+static void
+bench_link_conn(void) {
+    bench_result_t res = { 0 };
+    size_t len, allocs;
+
+    len = (size_t)snprintf(stream, sizeof(stream),
+        "+LINK_CONN:0,%d,\"TCP\",1,\"192.168.0.14\",57551,80\r\n%d,CLOSED\r\n",
+        BENCH_LINK_CONN, BENCH_LINK_CONN);
+
+    allocs = get_alloc_total();
+    for (size_t i = 0; i < BENCH_LINK_CONN_CNT; ++i) {
+        bench_feed(stream, len, &res);
+        res.segments += 2;
+    }
+    res.allocs = get_alloc_total() - allocs;
+    print_result("LINK_CONN", &res);
+}
+
+/**
+ * \brief           Measure received records of captured AT stream
+ * \param[in]       trace: Records in \ref ESP_CAPTURE format
+ * \param[in]       trace_len: Length of trace in units of bytes
+ */
+static void
+bench_trace(const uint8_t* trace, size_t trace_len) {
+    bench_result_t res = { 0 };
+    size_t pos, rec_len, allocs;
+
+    allocs = get_alloc_total();
+    for (pos = 0; pos + ESP_CAPTURE_HDR_LEN <= trace_len; pos += ESP_CAPTURE_HDR_LEN + rec_len) {
+        rec_len = (size_t)trace[pos + 4] | ((size_t)trace[pos + 5] << 8);
+        if (pos + ESP_CAPTURE_HDR_LEN + rec_len > trace_len) {
+            break;
+        }
+        if (trace[pos + 6] == ESP_CAPTURE_DIR_RX) {
+            bench_feed(&trace[pos + ESP_CAPTURE_HDR_LEN], rec_len, &res);
+            ++res.segments;
+        }
+    }
+    res.allocs = get_alloc_total() - allocs;
+    print_result("Trace", &res);
+}
+
+/**
+ * \brief           Benchmark connection callback, received data are freed by stack after return
+ * \param[in]       evt: Event information
+ * \return          \ref espOK on success, member of \ref espr_t otherwise
+ */
+static espr_t
+bench_conn_evt(esp_evt_t* evt) {
+    ESP_UNUSED(evt);
+    return espOK;
+}
+
+/**
+ * \brief           Run parser benchmarks
+ *
+ *                  Parser is called directly from calling thread while core is locked,
+ *                  library threads do not take part in measurement.
+ *
+ * \param[in]       trace: Optional AT stream captured with \ref ESP_CFG_AT_CAPTURE, set to `NULL` if not used
+ * \param[in]       trace_len: Length of trace in units of bytes
+ */
+void
+parser_benchmark_run(const void* trace, size_t trace_len) {
+    bench_result_t ignore = { 0 };
+    esp_evt_fn evt_server;
+    size_t len;
+
+    esp_core_lock();
+    if (esp.m.conns[BENCH_IPD_CONN].status.f.active || esp.m.conns[BENCH_LINK_CONN].status.f.active) {
+        esp_core_unlock();
+        printf("Benchmark connections are in use\r\n");
+        return;
+    }
+
+    /*
+     * Connections reported by device get server callback,
+     * set it to benchmark callback, otherwise stack closes them
+     */
+    evt_server = esp.evt_server;
+    esp.evt_server = bench_conn_evt;
+
+    /* Open connection for +IPD data the same way as device reports it */
+    len = (size_t)snprintf(stream, sizeof(stream),
+        "+LINK_CONN:0,%d,\"TCP\",0,\"" BENCH_HOST "\",%d,50000\r\n", BENCH_IPD_CONN, BENCH_PORT);
+    bench_feed(stream, len, &ignore);
+
+    bench_cycles_init();
+    bench_ipd("IPD small", BENCH_IPD_SMALL_LEN, BENCH_IPD_SMALL_CNT);
+    bench_ipd("IPD 1460", 1460, BENCH_IPD_SEGMENT_CNT);
+#if ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP
+    bench_cwlap();
+#endif /* ESP_CFG_MODE_STATION && ESP_CFG_STA_LIST_AP */
+    bench_link_conn();
+    if (trace != NULL && trace_len > 0) {
+        bench_trace(trace, trace_len);
+    }
+
+    len = (size_t)snprintf(stream, sizeof(stream), "%d,CLOSED\r\n", BENCH_IPD_CONN);
+    bench_feed(stream, len, &ignore);
+    esp.evt_server = evt_server;
+    esp_core_unlock();
+}
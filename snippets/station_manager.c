@@ -29,6 +29,83 @@ esp_ap_t aps[100];
 static
 size_t apf;
 
+/**
+ * \brief           Last successfully joined access point
+ */
+static
+last_ap_t last_ap;
+
+/**
+ * \brief           Save access point information after successful join
+ * \param[in]       index: Index of access point in \ref ap_list
+ */
+static void
+save_last_ap(size_t index) {
+    esp_sta_info_ap_t info;
+    uint8_t is_dhcp;
+
+    last_ap.valid = 0;
+    if (esp_sta_get_ap_info(&info, NULL, NULL, 1) == espOK
+        && esp_sta_copy_ip(&last_ap.ip, &last_ap.gw, &last_ap.nm, &is_dhcp) == espOK) {
+        last_ap.index = index;
+        last_ap.mac = info.mac;
+        last_ap.ch = info.ch;
+        last_ap.valid = 1;
+        printf("Saved AP %s, CH: %d for fast reconnect\r\n", ap_list[index].ssid, (int)info.ch);
+    }
+}
+
+/**
+ * \brief           Get last successfully joined access point
+ * \param[out]      ap: Structure to copy information to
+ */
+void
+station_manager_get_last_ap(last_ap_t* ap) {
+    *ap = last_ap;
+}
+
+/**
+ * \brief           Restore last successfully joined access point, for example after wake-up
+ * \param[in]       ap: Previously saved information
+ */
+void
+station_manager_set_last_ap(const last_ap_t* ap) {
+    last_ap = *ap;
+    if (last_ap.index >= ESP_ARRAYSIZE(ap_list)) {
+        last_ap.valid = 0;
+    }
+}
+
+/**
+ * \brief           Rejoin last access point without scan
+ *
+ * Station IP configuration is set statically and join is done with known BSSID,
+ * so device does not need to scan for access point and wait for DHCP.
+ * On failure, hint is cleared and DHCP is enabled again
+ *
+ * \note            AT firmware has no channel parameter for join,
+ *                  channel is kept for information only
+ * \return          \ref espOK on success, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+connect_to_last_access_point(void) {
+    espr_t eres;
+
+    if (!last_ap.valid) {
+        return espERR;
+    }
+    printf("Fast reconnect to \"%s\" network...\r\n", ap_list[last_ap.index].ssid);
+    if ((eres = esp_sta_setip(&last_ap.ip, &last_ap.gw, &last_ap.nm, NULL, NULL, 1)) == espOK) {
+        eres = esp_sta_join(ap_list[last_ap.index].ssid, ap_list[last_ap.index].pass, &last_ap.mac, NULL, NULL, 1);
+    }
+    if (eres != espOK) {
+        printf("Fast reconnect failed: %d\r\n", (int)eres);
+        last_ap.valid = 0;
+        esp_dhcp_configure(1, 0, 1, NULL, NULL, 1); /* Use DHCP again for normal join */
+    }
+    return eres;
+}
+
 /**
  * \brief           Connect to preferred access point
  *
@@ -51,6 +128,11 @@ connect_to_preferred_access_point(uint8_t unlimited) {
             return espOK;
         }
 
+        /* Try last known access point first */
+        if (last_ap.valid && connect_to_last_access_point() == espOK) {
+            return espOK;
+        }
+
         /* Scan for access points visible to ESP device */
         printf("Scanning access points...\r\n");
         if ((eres = esp_sta_list_ap(NULL, aps, ESP_ARRAYSIZE(aps), &apf, NULL, NULL, 1)) == espOK) {
@@ -75,6 +157,7 @@ connect_to_preferred_access_point(uint8_t unlimited) {
                             printf("Connected to %s network!\r\n", ap_list[j].ssid);
                             printf("Station IP address: %d.%d.%d.%d; Is DHCP: %d\r\n",
                                 (int)ip.ip[0], (int)ip.ip[1], (int)ip.ip[2], (int)ip.ip[3], (int)is_dhcp);
+                            save_last_ap(j);    /* Remember access point for next connect */
                             return espOK;
                         } else {
                             printf("Connection error: %d\r\n", (int)eres);
@@ -98,6 +181,98 @@ connect_to_preferred_access_point(uint8_t unlimited) {
     return espERR;
 }
 
+/**
+ * \brief           Check if station may reconnect without breaking connections
+ * \return          `1` when no connection is active, `0` otherwise
+ */
+static uint8_t
+station_is_idle(void) {
+    for (uint8_t i = 0; i < ESP_CFG_MAX_CONNS; ++i) {
+        if (esp_conn_is_active(esp_conn_get_by_num(i))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Roam to access point with better signal if current one is weak
+ *
+ * RSSI of current access point is compared with \ref STATION_MANAGER_ROAM_RSSI.
+ * When weaker and no connection is active, scan is started for current SSID only,
+ * reporting access points stronger by at least \ref STATION_MANAGER_ROAM_HYSTERESIS.
+ * Station joins the strongest one by its BSSID and falls back to previous access point on failure
+ *
+ * \note            Call function periodically from low priority thread, see \ref station_manager_roam_thread
+ * \return          \ref espOK when roaming was not needed or succeeded, member of \ref espr_t enumeration otherwise
+ */
+espr_t
+station_manager_roam(void) {
+    esp_sta_info_ap_t info;
+    esp_mac_t mac;
+    const ap_entry_t* entry;
+    espr_t eres;
+    size_t best = 0;
+
+    if (!last_ap.valid || !esp_sta_has_ip()) {
+        return espERR;
+    }
+    if ((eres = esp_sta_get_ap_info(&info, NULL, NULL, 1)) != espOK) {
+        return eres;
+    }
+    if (info.rssi >= STATION_MANAGER_ROAM_RSSI || !station_is_idle()) {
+        return espOK;
+    }
+
+    /* Targeted scan, filtered by device to preferred SSID and better signal */
+    entry = &ap_list[last_ap.index];
+    if ((eres = esp_sta_list_ap_ex(entry->ssid, aps, ESP_ARRAYSIZE(aps), &apf,
+        ESP_STA_LIST_AP_FIELD_SSID | ESP_STA_LIST_AP_FIELD_RSSI | ESP_STA_LIST_AP_FIELD_MAC | ESP_STA_LIST_AP_FIELD_CH,
+        1, info.rssi + STATION_MANAGER_ROAM_HYSTERESIS, NULL, NULL, 1)) != espOK) {
+        return eres;
+    }
+    for (size_t i = 0; i < apf; i++) {
+        if (!memcmp(&aps[i].mac, &info.mac, sizeof(info.mac))) {
+            continue;                           /* Skip current access point */
+        }
+        if (aps[i].rssi < info.rssi + STATION_MANAGER_ROAM_HYSTERESIS) {
+            continue;                           /* Firmware may not support RSSI filter */
+        }
+        if (best == 0 || aps[i].rssi > aps[best - 1].rssi) {
+            best = i + 1;
+        }
+    }
+    if (best == 0) {
+        return espOK;
+    }
+
+    mac = aps[best - 1].mac;
+    printf("Roaming from RSSI %d to RSSI %d, CH: %d\r\n",
+        (int)info.rssi, (int)aps[best - 1].rssi, (int)aps[best - 1].ch);
+    if ((eres = esp_sta_join(entry->ssid, entry->pass, &mac, NULL, NULL, 1)) == espOK) {
+        save_last_ap(last_ap.index);            /* New BSSID is used for next fast reconnect */
+    } else {
+        printf("Roaming failed: %d\r\n", (int)eres);
+        connect_to_last_access_point();         /* Go back to previous access point */
+    }
+    return eres;
+}
+
+/**
+ * \brief           Thread sampling RSSI and roaming to better access point
+ * \note            Create thread with priority lower than application threads
+ * \param[in]       arg: Thread argument, not used
+ */
+void
+station_manager_roam_thread(void* arg) {
+    ESP_UNUSED(arg);
+
+    while (1) {
+        esp_delay(STATION_MANAGER_ROAM_INTERVAL);
+        station_manager_roam();
+    }
+}
+
 static size_t last_index = 0;
 static uint8_t is_listing = 0, is_connected;
 
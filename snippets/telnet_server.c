@@ -2,7 +2,11 @@
  * Telnet server example is based on single "user" thread
  * which listens for new connections and accept it.
  *
- * Only one connection is allowed for Telnet server
+ * Every accepted client is processed in its own thread
+ * with its own CLI session, up to TELNET_MAX_SESSIONS clients at a time
+ *
+ * With CLI_OUT_BUFF_SIZE enabled, echo and command output
+ * are collected by CLI session and written once per received packet
  */
 
 #include <stdbool.h>
@@ -12,10 +16,26 @@
 #include "cli/cli.h"
 #include "cli/cli_input.h"
 
-static esp_netconn_p client;
-static bool close_conn = false;
+/* Maximal number of simultaneously connected telnet clients */
+#define TELNET_MAX_SESSIONS                 3
+
+/**
+ * \brief           Telnet session slot
+ */
+typedef struct {
+    esp_netconn_p nc;                           /*!< Client netconn, `NULL` when slot is free */
+    cli_session_t cli;                          /*!< CLI input state for this client */
+    uint32_t cmd_sequence;                      /*!< Telnet command sequence state */
+    bool close_conn;                            /*!< Set when client requested exit */
+#if !CLI_OUT_BUFF_SIZE
+    char tmp_str[128];                          /*!< Output formatting buffer */
+#endif /* !CLI_OUT_BUFF_SIZE */
+} telnet_session_t;
+
+static telnet_session_t sessions[TELNET_MAX_SESSIONS];
 
 static void telnet_cli_exit(cli_printf cliprintf, int argc, char** argv);
+static void telnet_cli_vprintf(telnet_session_t* ts, const char* fmt, va_list argptr);
 
 static const cli_command_t telnet_commands[] = {
     { "exit",           "Close/Exit the terminal",                  telnet_cli_exit },
@@ -30,29 +50,76 @@ static const cli_command_t telnet_commands[] = {
  */
 static void
 telnet_cli_exit(cli_printf cliprintf, int argc, char** argv) {
-    close_conn = true;
+    /* Printf function identifies the session which executed the command */
+    for (size_t i = 0; i < TELNET_MAX_SESSIONS; ++i) {
+        if (sessions[i].cli.cliprintf == cliprintf) {
+            sessions[i].close_conn = true;
+        }
+    }
 }
 
 /**
- * \brief           Telnet CLI printf, used for CLI commands
+ * \brief           Format and write output to telnet session
+ * \param[in]       ts: Telnet session
  * \param[in]       fmt: Format for the printf
+ * \param[in]       argptr: Format arguments
+ */
+static void
+telnet_cli_vprintf(telnet_session_t* ts, const char* fmt, va_list argptr) {
+#if CLI_OUT_BUFF_SIZE
+    cli_session_vprintf(&ts->cli, fmt, argptr);
+#else /* CLI_OUT_BUFF_SIZE */
+    int len;
+
+    len = vsnprintf(ts->tmp_str, sizeof(ts->tmp_str), fmt, argptr);
+    if (len > 0 && len < (int)sizeof(ts->tmp_str) && ts->nc != NULL) {
+        esp_netconn_write(ts->nc, (uint8_t *)ts->tmp_str, len);
+    }
+#endif /* !CLI_OUT_BUFF_SIZE */
+}
+
+#if CLI_OUT_BUFF_SIZE
+
+/**
+ * \brief           Write collected CLI output to telnet session
+ * \param[in]       arg: Telnet session
+ * \param[in]       data: Output data
+ * \param[in]       len: Number of bytes to write
  */
 static void
-telnet_cli_printf(const char *fmt, ...) {
-    static char tempStr[128];
-    va_list argptr;
-    int len = 1;
-
-    memset(&tempStr, 0x00, sizeof(tempStr) );
-    va_start(argptr, fmt);
-    len = vsprintf(tempStr, fmt, argptr);
-    va_end(argptr);
-
-    if (len && len < 128 ) {
-        esp_netconn_write(client, (uint8_t *)tempStr, len);
+telnet_cli_write(void* arg, const void* data, size_t len) {
+    telnet_session_t* ts = arg;
+
+    if (ts->nc != NULL) {
+        esp_netconn_write(ts->nc, data, len);
     }
 }
 
+#endif /* CLI_OUT_BUFF_SIZE */
+
+/*
+ * CLI printf has no user argument, hence every session
+ * slot gets own printf function, forwarding to its netconn
+ */
+#define TELNET_CLI_PRINTF_DEFINE(idx)                           \
+static void                                                     \
+telnet_cli_printf_ ## idx(const char* fmt, ...) {               \
+    va_list argptr;                                             \
+    va_start(argptr, fmt);                                      \
+    telnet_cli_vprintf(&sessions[idx], fmt, argptr);            \
+    va_end(argptr);                                             \
+}
+
+TELNET_CLI_PRINTF_DEFINE(0)
+TELNET_CLI_PRINTF_DEFINE(1)
+TELNET_CLI_PRINTF_DEFINE(2)
+
+static cli_printf* const telnet_cli_printf_fns[TELNET_MAX_SESSIONS] = {
+    telnet_cli_printf_0,
+    telnet_cli_printf_1,
+    telnet_cli_printf_2,
+};
+
 /**
  * \brief           Telnet client config (disable ECHO and LINEMOD)
  * \param[in]       nc: Netconn handle used to write data to
@@ -90,12 +157,13 @@ telnet_client_config(esp_netconn_p nc) {
 
 /**
  * \brief           Telnet command sequence check
+ * \param[in]       ts: Telnet session
  * \param[in]       ch: input byte from telnet
  * \ref             true when command sequence is active, else false
  */
 static bool
-telnet_command_sequence_check(char ch) {
-    static uint32_t telnet_command_sequence = 0;
+telnet_command_sequence_check(telnet_session_t* ts, uint8_t ch) {
+    uint32_t telnet_command_sequence = ts->cmd_sequence;
     bool command_sequence_found = false;
 
     if (!telnet_command_sequence && ch == 0xff) {
@@ -159,10 +227,64 @@ telnet_command_sequence_check(char ch) {
             default: printf("UNKNOWN 0x%02x-%d \n\r", ch, ch);
         }
     }
+    ts->cmd_sequence = telnet_command_sequence;
 
     return command_sequence_found;
 }
 
+/**
+ * \brief           Telnet client thread, processing single session
+ * \param[in]       arg: Pointer to \ref telnet_session_t slot
+ */
+static void
+telnet_session_thread(void* const arg) {
+    telnet_session_t* ts = arg;
+    const uint8_t* in_data;
+    esp_pbuf_p pbuf;
+    espr_t res;
+
+    /*
+     * Inform telnet client that it should disable LINEMODE
+     * and that we will echo for him.
+     */
+    if (telnet_client_config(ts->nc) == espOK) {
+        while (1) {
+            res = esp_netconn_receive(ts->nc, &pbuf);
+            if (res == espCLOSED) {
+                break;
+            }
+
+            /* Process every pbuf in a chain, not only the first one */
+            for (size_t off = 0, length; (in_data = esp_pbuf_get_linear_addr(pbuf, off, &length)) != NULL; off += length) {
+                size_t start = 0;
+
+                /* Feed runs of non-command bytes to CLI in one call */
+                for (size_t i = 0; i < length; ++i) {
+                    if (ts->cmd_sequence || in_data[i] == 0xff) {
+                        cli_session_in_buff(&ts->cli, &in_data[start], i - start);
+                        telnet_command_sequence_check(ts, in_data[i]);
+                        start = i + 1;
+                    }
+                }
+                cli_session_in_buff(&ts->cli, &in_data[start], length - start);
+            }
+
+            esp_pbuf_free(pbuf);
+            esp_netconn_flush(ts->nc);
+
+            if (ts->close_conn) {
+                esp_netconn_close(ts->nc);      /* Close netconn connection */
+                break;
+            }
+        }
+    }
+    printf("Telnet client disconnected.\r\n");
+
+    esp_netconn_delete(ts->nc);                 /* Delete netconn connection */
+    ts->nc = NULL;                              /* Release session slot */
+    esp_sys_thread_terminate(NULL);             /* Terminate current thread */
+}
+
 /**
  * \brief           Telnet server thread implementation
  * \param[in]       arg: User argument
@@ -170,8 +292,8 @@ telnet_command_sequence_check(char ch) {
 void
 telnet_server_thread(void const* arg) {
     espr_t res;
-    esp_pbuf_p pbuf;
-    esp_netconn_p server;
+    esp_netconn_p server, client;
+    telnet_session_t* ts;
 
     /*
      * First create a new instance of netconn
@@ -204,7 +326,7 @@ telnet_server_thread(void const* arg) {
      * Start listening for incoming connections
      * on previously binded port
      */
-    res = esp_netconn_listen_with_max_conn(server, 1);
+    res = esp_netconn_listen_with_max_conn(server, TELNET_MAX_SESSIONS);
     while (1) {
         /*
          * Wait and accept new client connection
@@ -220,47 +342,35 @@ telnet_server_thread(void const* arg) {
 
         printf("Telnet new client connected.\r\n");
 
-        /*
-         * Inform telnet client that it should disable LINEMODE
-         * and that we will echo for him.
-         */
-        res = telnet_client_config(client);
-        if (res != espOK) {
-            break;
-        }
-
-        while (1) {
-            res = esp_netconn_receive(client, &pbuf);
-            if (res == espCLOSED) {
-                break;
-            }
-
-            const uint8_t * in_data = esp_pbuf_data(pbuf);
-            size_t length = esp_pbuf_length(pbuf, 1); /* Get length of received packet */
-
-            for (int i = 0; i < length; i++) {
-                if (!telnet_command_sequence_check(in_data[i])) {
-                    cli_in_data(telnet_cli_printf, in_data[i]);
-                }
-            }
-
-            esp_pbuf_free(pbuf);
-            esp_netconn_flush(client);
-
-            if (close_conn) {
-                close_conn = false;
-                esp_netconn_close(client);      /* Close netconn connection */
+        /* Find free session slot */
+        ts = NULL;
+        for (size_t i = 0; i < TELNET_MAX_SESSIONS; ++i) {
+            if (sessions[i].nc == NULL) {
+                ts = &sessions[i];
+                cli_session_init(&ts->cli, telnet_cli_printf_fns[i]);
+#if CLI_OUT_BUFF_SIZE
+                cli_session_set_output(&ts->cli, telnet_cli_write, ts);
+#endif /* CLI_OUT_BUFF_SIZE */
                 break;
             }
         }
-        if (client != NULL) {
-            esp_netconn_delete(client);         /* Delete netconn connection */
-            client = NULL;
+        if (ts == NULL) {
+            printf("Telnet no free session!\r\n");
+            esp_netconn_close(client);
+            esp_netconn_delete(client);
+            continue;
+        }
+        ts->cmd_sequence = 0;
+        ts->close_conn = false;
+        ts->nc = client;
+
+        /* Process client in separate thread */
+        if (!esp_sys_thread_create(NULL, "telnet_client", telnet_session_thread, ts, ESP_SYS_THREAD_SS, ESP_SYS_THREAD_PRIO)) {
+            printf("Telnet cannot create client thread!\r\n");
+            esp_netconn_close(client);
+            esp_netconn_delete(client);
+            ts->nc = NULL;
         }
-    }
-    if (client != NULL) {
-        esp_netconn_delete(client);             /* Delete netconn connection */
-        client = NULL;
     }
 
     esp_netconn_delete(server);                 /* Delete netconn structure */